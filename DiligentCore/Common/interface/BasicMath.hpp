@@ -57,7 +57,6 @@
 #    pragma warning(push)
 #    pragma warning(disable : 4201) // nonstandard extension used: nameless struct/union
 #endif
-#include <BasicMath.hpp>
 
 namespace Diligent
 {
@@ -30,11 +30,10 @@
 /// \file
 /// Declaration of Diligent::FixedBlockMemoryAllocator class
 
-#include <unordered_map>
 #include <mutex>
-#include <unordered_set>
 #include <vector>
 #include <cstring>
+#include <cstdint>
 #include <memory>
 #include "../../Primitives/interface/Errors.hpp"
 #include "../../Primitives/interface/MemoryAllocator.h"
@@ -53,6 +52,15 @@ inline void FillWithDebugPattern(void* ptr, Uint8 Pattern, size_t NumBytes)
 #endif
 
 /// Memory allocator that allocates memory in a fixed-size chunks
+
+/// Blocks are allocated from and returned to per-thread block caches. A thread only takes the
+/// mutex of its own cache, so threads do not serialize on one lock. Caches are refilled from
+/// memory pages and flushed back to them in batches under the page mutex.
+/// Pages are aligned by a power of two that is not smaller than the page size, so the page that
+/// owns a block is found by masking the block address. Page memory is allocated with the system
+/// aligned allocator, while other internal data use the raw memory allocator. Pages that have
+/// free blocks are kept in an intrusive list.
+/// Pages are never released until the allocator is destroyed.
 class FixedBlockMemoryAllocator final : public IMemoryAllocator
 {
 public:
@@ -65,6 +73,15 @@ public:
     /// Releases memory
     virtual void Free(void* Ptr) override final;
 
+    /// Returns the number of blocks in one memory page.
+
+    /// \remarks    The number of blocks may be greater than the value passed to the constructor
+    ///             as the page is extended to fill its alignment.
+    Uint32 GetNumBlocksInPage() const { return m_NumBlocksInPage; }
+
+    /// Returns the number of per-thread block caches.
+    Uint32 GetNumThreadCaches() const { return m_NumThreadCaches; }
+
 private:
     // clang-format off
     FixedBlockMemoryAllocator             (const FixedBlockMemoryAllocator&) = delete;
@@ -73,164 +90,65 @@ private:
     FixedBlockMemoryAllocator& operator = (FixedBlockMemoryAllocator&&)      = delete;
     // clang-format on
 
-    void CreateNewPage();
+    static constexpr Uint8 NewPageMemPattern          = 0xAA;
+    static constexpr Uint8 AllocatedBlockMemPattern   = 0xAB;
+    static constexpr Uint8 DeallocatedBlockMemPattern = 0xDE;
+    static constexpr Uint8 InitializedBlockMemPattern = 0xCF;
+
+    // Page header that is located at the beginning of every page
+    struct PageHeader;
 
-    // Memory page class is based on the fixed-size memory pool described in "Fast Efficient Fixed-Size Memory Pool"
-    // by Ben Kenwright
-    class MemoryPage
+    // Cache of free blocks that is used by one or several threads
+    struct ThreadCache;
+
+    // Aligned allocation that contains one or several pages
+    struct PageChunk
     {
-    public:
-        static constexpr Uint8 NewPageMemPattern          = 0xAA;
-        static constexpr Uint8 AllocatedBlockMemPattern   = 0xAB;
-        static constexpr Uint8 DeallocatedBlockMemPattern = 0xDE;
-        static constexpr Uint8 InitializedBlockMemPattern = 0xCF;
-
-        MemoryPage(FixedBlockMemoryAllocator& OwnerAllocator) :
-            // clang-format off
-            m_NumFreeBlocks       {OwnerAllocator.m_NumBlocksInPage},
-            m_NumInitializedBlocks{0},
-            m_pOwnerAllocator     {&OwnerAllocator}
-        // clang-format on
-        {
-            auto PageSize = OwnerAllocator.m_BlockSize * OwnerAllocator.m_NumBlocksInPage;
-            m_pPageStart  = reinterpret_cast<Uint8*>(
-                OwnerAllocator.m_RawMemoryAllocator.Allocate(PageSize, "FixedBlockMemoryAllocator page", __FILE__, __LINE__));
-            m_pNextFreeBlock = m_pPageStart;
-            FillWithDebugPattern(m_pPageStart, NewPageMemPattern, PageSize);
-        }
+        PageHeader* pFirstPage = nullptr;
+        Uint32      NumPages   = 0;
+    };
 
-        MemoryPage(MemoryPage&& Page) noexcept :
-            // clang-format off
-            m_NumFreeBlocks       {Page.m_NumFreeBlocks       },
-            m_NumInitializedBlocks{Page.m_NumInitializedBlocks},
-            m_pPageStart          {Page.m_pPageStart          },
-            m_pNextFreeBlock      {Page.m_pNextFreeBlock      },
-            m_pOwnerAllocator     {Page.m_pOwnerAllocator     }
-        // clang-format on
-        {
-            Page.m_NumFreeBlocks        = 0;
-            Page.m_NumInitializedBlocks = 0;
-            Page.m_pPageStart           = nullptr;
-            Page.m_pNextFreeBlock       = nullptr;
-            Page.m_pOwnerAllocator      = nullptr;
-        }
+    static const size_t PageHeaderSize;
 
-        ~MemoryPage()
-        {
-            if (m_pOwnerAllocator)
-                m_pOwnerAllocator->m_RawMemoryAllocator.Free(m_pPageStart);
-        }
+    static size_t ComputePageAlignment(size_t BlockSize, Uint32 NumBlocksInPage);
+    static Uint32 ComputeNumThreadCaches();
 
-        void* GetBlockStartAddress(Uint32 BlockIndex) const
-        {
-            VERIFY_EXPR(m_pOwnerAllocator != nullptr);
-            VERIFY(BlockIndex >= 0 && BlockIndex < m_pOwnerAllocator->m_NumBlocksInPage, "Invalid block index");
-            return reinterpret_cast<Uint8*>(m_pPageStart) + BlockIndex * m_pOwnerAllocator->m_BlockSize;
-        }
+    PageHeader* GetPage(void* pBlock) const
+    {
+        return reinterpret_cast<PageHeader*>(reinterpret_cast<uintptr_t>(pBlock) & ~(uintptr_t{m_PageAlignment} - 1));
+    }
+    void* GetBlockStartAddress(PageHeader* pPage, Uint32 BlockIndex) const;
+
+    void* AllocateBlock(PageHeader& Page);
+    void  RefillCache(ThreadCache& Cache);
+    void  ReleaseBlocks(void* pFirstBlock);
+    void  CreatePages();
+    void  AddAvailablePage(PageHeader& Page);
+    void  RemoveAvailablePage(PageHeader& Page);
 
 #ifdef DILIGENT_DEBUG
-        void dbgVerifyAddress(const void* pBlockAddr) const
-        {
-            size_t Delta = reinterpret_cast<const Uint8*>(pBlockAddr) - reinterpret_cast<Uint8*>(m_pPageStart);
-            VERIFY(Delta % m_pOwnerAllocator->m_BlockSize == 0, "Invalid address");
-            Uint32 BlockIndex = static_cast<Uint32>(Delta / m_pOwnerAllocator->m_BlockSize);
-            VERIFY(BlockIndex >= 0 && BlockIndex < m_pOwnerAllocator->m_NumBlocksInPage, "Invalid block index");
-        }
+    void dbgVerifyAddress(void* pBlock) const;
 #else
-#    define dbgVerifyAddress(...)
+    void dbgVerifyAddress(void*) const {}
 #endif
 
-        void* Allocate()
-        {
-            VERIFY_EXPR(m_pOwnerAllocator != nullptr);
-
-            if (m_NumFreeBlocks == 0)
-            {
-                VERIFY_EXPR(m_NumInitializedBlocks == m_pOwnerAllocator->m_NumBlocksInPage);
-                return nullptr;
-            }
-
-            // Initialize the next block
-            if (m_NumInitializedBlocks < m_pOwnerAllocator->m_NumBlocksInPage)
-            {
-                // Link next uninitialized block to the end of the list:
-
-                //
-                //                            ___________                      ___________
-                //                           |           |                    |           |
-                //                           | 0xcdcdcd  |                 -->| 0xcdcdcd  |   m_NumInitializedBlocks
-                //                           |-----------|                |   |-----------|
-                //                           |           |                |   |           |
-                //  m_NumInitializedBlocks   | 0xcdcdcd  |      ==>        ---|           |
-                //                           |-----------|                    |-----------|
-                //
-                //                           ~           ~                    ~           ~
-                //                           |           |                    |           |
-                //                       0   |           |                    |           |
-                //                            -----------                      -----------
-                //
-                auto* pUninitializedBlock = GetBlockStartAddress(m_NumInitializedBlocks);
-                FillWithDebugPattern(pUninitializedBlock, InitializedBlockMemPattern, m_pOwnerAllocator->m_BlockSize);
-                void** ppNextBlock = reinterpret_cast<void**>(pUninitializedBlock);
-                ++m_NumInitializedBlocks;
-                if (m_NumInitializedBlocks < m_pOwnerAllocator->m_NumBlocksInPage)
-                    *ppNextBlock = GetBlockStartAddress(m_NumInitializedBlocks);
-                else
-                    *ppNextBlock = nullptr;
-            }
-
-            void* res = m_pNextFreeBlock;
-            dbgVerifyAddress(res);
-            // Move pointer to the next free block
-            m_pNextFreeBlock = *reinterpret_cast<void**>(m_pNextFreeBlock);
-            --m_NumFreeBlocks;
-            if (m_NumFreeBlocks != 0)
-                dbgVerifyAddress(m_pNextFreeBlock);
-            else
-                VERIFY_EXPR(m_pNextFreeBlock == nullptr);
-
-            FillWithDebugPattern(res, AllocatedBlockMemPattern, m_pOwnerAllocator->m_BlockSize);
-            return res;
-        }
-
-        void DeAllocate(void* p)
-        {
-            VERIFY_EXPR(m_pOwnerAllocator != nullptr);
-
-            dbgVerifyAddress(p);
-            FillWithDebugPattern(p, DeallocatedBlockMemPattern, m_pOwnerAllocator->m_BlockSize);
-            // Add block to the beginning of the linked list
-            *reinterpret_cast<void**>(p) = m_pNextFreeBlock;
-            m_pNextFreeBlock             = p;
-            ++m_NumFreeBlocks;
-        }
-
-        bool HasSpace() const { return m_NumFreeBlocks > 0; }
-        bool HasAllocations() const { return m_NumFreeBlocks < m_NumInitializedBlocks; }
-
-    private:
-        MemoryPage(const MemoryPage&) = delete;
-        MemoryPage& operator=(const MemoryPage) = delete;
-        MemoryPage& operator=(MemoryPage&&) = delete;
-
-        Uint32                     m_NumFreeBlocks        = 0;       // Num of remaining blocks
-        Uint32                     m_NumInitializedBlocks = 0;       // Num of initialized blocks
-        void*                      m_pPageStart           = nullptr; // Beginning of memory pool
-        void*                      m_pNextFreeBlock       = nullptr; // Num of next free block
-        FixedBlockMemoryAllocator* m_pOwnerAllocator      = nullptr;
-    };
+    IMemoryAllocator& m_RawMemoryAllocator;
+    const size_t      m_BlockSize;
+    const size_t      m_PageAlignment;
+    const Uint32      m_NumBlocksInPage;
+    const Uint32      m_CacheBatchSize;
+    const Uint32      m_NumThreadCaches;
 
-    std::vector<MemoryPage, STDAllocatorRawMem<MemoryPage>>                                          m_PagePool;
-    std::unordered_set<size_t, std::hash<size_t>, std::equal_to<size_t>, STDAllocatorRawMem<size_t>> m_AvailablePages;
+    ThreadCache* m_pThreadCaches       = nullptr;
+    void*        m_pThreadCachesRawMem = nullptr;
 
-    using AddrToPageIdMapElem = std::pair<void* const, size_t>;
-    std::unordered_map<void*, size_t, std::hash<void*>, std::equal_to<void*>, STDAllocatorRawMem<AddrToPageIdMapElem>> m_AddrToPageId;
+    // Protects all members below as well as the pages
+    std::mutex m_PageMtx;
 
-    std::mutex m_Mutex;
+    PageHeader* m_pAvailablePages     = nullptr;
+    Uint32      m_NumPagesInNextChunk = 1;
 
-    IMemoryAllocator& m_RawMemoryAllocator;
-    const size_t      m_BlockSize;
-    const Uint32      m_NumBlocksInPage;
+    std::vector<PageChunk, STDAllocatorRawMem<PageChunk>> m_Chunks;
 };
 
 IMemoryAllocator& GetRawAllocator();
@@ -0,0 +1,156 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+/// \file
+/// CPU reference implementation of the indirect draw culling kernel
+
+#include "BasicMath.hpp"
+#include "AdvancedMath.hpp"
+#include "../../Platforms/Basic/interface/DebugUtilities.hpp"
+
+namespace Diligent
+{
+
+/// Indexed draw arguments in the layout expected by IDeviceContext::DrawIndexedIndirect().
+struct DrawIndexedIndirectArgs
+{
+    Uint32 NumIndices            = 0;
+    Uint32 NumInstances          = 0;
+    Uint32 FirstIndexLocation    = 0;
+    Uint32 BaseVertex            = 0;
+    Uint32 FirstInstanceLocation = 0;
+};
+static_assert(sizeof(DrawIndexedIndirectArgs) == sizeof(Uint32) * 5, "Unexpected size of DrawIndexedIndirectArgs");
+
+/// Describes a single draw processed by the indirect draw culling kernel.
+
+/// The structure is uploaded to the GPU as is, so the shader version of the kernel
+/// must declare a structure with the same layout.
+struct IndirectDrawRecord
+{
+    /// Bounding box minimum in the space of the draw's transform.
+    float3 BoundBoxMin;
+
+    /// Index of the draw's transform matrix.
+    Uint32 TransformId = 0;
+
+    /// Bounding box maximum in the space of the draw's transform.
+    float3 BoundBoxMax;
+
+    /// Index of the bucket the draw arguments are appended to.
+    Uint32 BucketId = 0;
+
+    Uint32 NumIndices    = 0;
+    Uint32 FirstIndex    = 0;
+    Uint32 BaseVertex    = 0;
+    Uint32 FirstInstance = 0;
+};
+static_assert(sizeof(IndirectDrawRecord) % 16 == 0, "sizeof(IndirectDrawRecord) is not multiple of 16");
+
+
+/// Tests if the bounding box transformed by the matrix is not fully outside of any frustum plane.
+
+/// \remarks    The box is transformed as center and half-extents, which gives the same result
+///             as testing BoundBox::Transform(Transform) with GetBoxVisibility().
+///             Matrices use the row-vector convention (v * Transform).
+inline bool IsTransformedBoxVisible(const ViewFrustum& Frustum,
+                                    const float3&      BoundBoxMin,
+                                    const float3&      BoundBoxMax,
+                                    const float4x4&    Transform)
+{
+    const auto Center  = (BoundBoxMin + BoundBoxMax) * 0.5f;
+    const auto Extents = (BoundBoxMax - BoundBoxMin) * 0.5f;
+
+    const auto WorldCenter = Center * Transform;
+
+    float3 WorldExtents;
+    for (int j = 0; j < 3; ++j)
+    {
+        WorldExtents[j] =
+            std::abs(Transform[0][j]) * Extents.x +
+            std::abs(Transform[1][j]) * Extents.y +
+            std::abs(Transform[2][j]) * Extents.z;
+    }
+
+    for (Uint32 i = 0; i < ViewFrustum::NUM_PLANES; ++i)
+    {
+        const auto& Plane = Frustum.GetPlane(static_cast<ViewFrustum::PLANE_IDX>(i));
+
+        const auto Dist   = dot(WorldCenter, Plane.Normal) + Plane.Distance;
+        const auto Radius = dot(WorldExtents, abs(Plane.Normal));
+        if (Dist + Radius < 0)
+            return false;
+    }
+
+    return true;
+}
+
+
+/// Culls draws against the view frustum and appends the arguments of visible draws
+/// to their buckets.
+
+/// \param [in]      Frustum         - View frustum, in the space the transforms map the boxes to.
+/// \param [in]      pDraws          - Draws to process.
+/// \param [in]      NumDraws        - Number of elements in pDraws array.
+/// \param [in]      pTransforms     - Transform matrices indexed by IndirectDrawRecord::TransformId.
+/// \param [in, out] pBucketCounters - Per-bucket append counters. On input, the index of the first
+///                                    argument slot of every bucket in pArgs. On output, the index
+///                                    one past the last written slot.
+/// \param [out]     pArgs           - Draw arguments. Slots that are not written are left untouched.
+///
+/// \remarks    This is the reference implementation of the compute shader that performs the same
+///             operation on the GPU. The GPU appends draws with atomic operations, so the order
+///             of draws within a bucket is only defined for this implementation.
+///             The caller is responsible for reserving enough slots for every bucket.
+inline void CullIndirectDraws(const ViewFrustum&        Frustum,
+                              const IndirectDrawRecord* pDraws,
+                              Uint32                    NumDraws,
+                              const float4x4*           pTransforms,
+                              Uint32*                   pBucketCounters,
+                              DrawIndexedIndirectArgs*  pArgs)
+{
+    VERIFY_EXPR(NumDraws == 0 || (pDraws != nullptr && pTransforms != nullptr && pBucketCounters != nullptr && pArgs != nullptr));
+
+    for (Uint32 i = 0; i < NumDraws; ++i)
+    {
+        const auto& Draw = pDraws[i];
+        if (!IsTransformedBoxVisible(Frustum, Draw.BoundBoxMin, Draw.BoundBoxMax, pTransforms[Draw.TransformId]))
+            continue;
+
+        auto& Args = pArgs[pBucketCounters[Draw.BucketId]++];
+
+        Args.NumIndices            = Draw.NumIndices;
+        Args.NumInstances          = 1;
+        Args.FirstIndexLocation    = Draw.FirstIndex;
+        Args.BaseVertex            = Draw.BaseVertex;
+        Args.FirstInstanceLocation = Draw.FirstInstance;
+    }
+}
+
+} // namespace Diligent
@@ -0,0 +1,82 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+#pragma once
+
+/// \file
+/// Implementation of the IDataBlob interface that references a memory-mapped file
+
+#include "../../Primitives/interface/BasicTypes.h"
+#include "../../Primitives/interface/DataBlob.h"
+#include "ObjectBase.hpp"
+
+namespace Diligent
+{
+
+/// Data blob that maps the contents of a file into memory instead of reading it.
+
+/// The blob references the pages of the file in the system page cache, so the data is only read
+/// from the disk when it is accessed, and pages that are never accessed are never read. The mapping
+/// is private: writing to the data does not modify the file. The blob can't be resized.
+///
+/// \remarks    Memory mapping is currently implemented on Linux and Android only.
+class MappedFileDataBlob final : public ObjectBase<IDataBlob>
+{
+public:
+    typedef ObjectBase<IDataBlob> TBase;
+
+    /// Maps the file into memory.
+
+    /// \param [in]  FilePath    - Path to the file.
+    /// \param [out] ppDataBlob  - Memory location where the pointer to the blob will be written.
+    ///                            Null is written if the file can't be mapped or if memory mapping
+    ///                            is not supported on this platform, in which case the caller
+    ///                            should read the file instead.
+    static void Create(const Char* FilePath, IDataBlob** ppDataBlob);
+
+    MappedFileDataBlob(IReferenceCounters* pRefCounters, void* pData, size_t Size);
+    ~MappedFileDataBlob();
+
+    virtual void DILIGENT_CALL_TYPE QueryInterface(const INTERFACE_ID& IID, IObject** ppInterface) override;
+
+    /// Memory-mapped blob can't be resized
+    virtual void DILIGENT_CALL_TYPE Resize(size_t NewSize) override;
+
+    /// Returns the size of the file
+    virtual size_t DILIGENT_CALL_TYPE GetSize() const override;
+
+    /// Returns the pointer to the mapped data
+    virtual void* DILIGENT_CALL_TYPE GetDataPtr() override;
+
+    /// Returns const pointer to the mapped data
+    virtual const void* DILIGENT_CALL_TYPE GetConstDataPtr() const override;
+
+private:
+    void* const  m_pData;
+    const size_t m_Size;
+};
+
+} // namespace Diligent
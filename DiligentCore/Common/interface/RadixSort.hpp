@@ -0,0 +1,137 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+/// \file
+/// Radix sort
+
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+#include "../../Primitives/interface/BasicTypes.h"
+#include "../../Platforms/Basic/interface/DebugUtilities.hpp"
+
+namespace Diligent
+{
+
+/// Sorts values by unsigned integer keys in ascending order using the least-significant-digit
+/// radix sort with 8-bit digits.
+
+/// \param [in, out] Keys      - Keys to sort.
+/// \param [in, out] Values    - Values associated with the keys. They are reordered together with the keys.
+/// \param [in]      Count     - Number of elements in Keys and Values arrays.
+/// \param [in]      TmpKeys   - Scratch space for at least Count keys.
+/// \param [in]      TmpValues - Scratch space for at least Count values.
+///
+/// \remarks    The sort is stable: values with equal keys keep their relative order.
+///             Histograms for all digits are computed in a single pass, and passes where
+///             all keys have the same digit are skipped, so e.g. sorting 16-bit quantized keys
+///             stored in 32-bit integers only takes two scatter passes.
+template <typename KeyType, typename ValueType>
+void RadixSort(KeyType* Keys, ValueType* Values, size_t Count, KeyType* TmpKeys, ValueType* TmpValues)
+{
+    static_assert(std::is_integral<KeyType>::value && std::is_unsigned<KeyType>::value, "Keys must be unsigned integers");
+
+    constexpr size_t NumDigits  = sizeof(KeyType);
+    constexpr size_t NumBuckets = 256;
+
+    if (Count <= 1)
+        return;
+
+    VERIFY_EXPR(Keys != nullptr && Values != nullptr && TmpKeys != nullptr && TmpValues != nullptr);
+
+    size_t Histograms[NumDigits][NumBuckets] = {};
+    for (size_t i = 0; i < Count; ++i)
+    {
+        auto Key = Keys[i];
+        for (size_t d = 0; d < NumDigits; ++d)
+        {
+            ++Histograms[d][Key & 0xFF];
+            Key = static_cast<KeyType>(Key >> 8);
+        }
+    }
+
+    KeyType*   pSrcKeys   = Keys;
+    ValueType* pSrcValues = Values;
+    KeyType*   pDstKeys   = TmpKeys;
+    ValueType* pDstValues = TmpValues;
+    for (size_t d = 0; d < NumDigits; ++d)
+    {
+        auto& Histogram = Histograms[d];
+
+        // Skip the pass if all keys have the same digit
+        const size_t Shift = d * 8;
+        if (Histogram[(pSrcKeys[0] >> Shift) & 0xFF] == Count)
+            continue;
+
+        size_t Offsets[NumBuckets];
+        size_t Sum = 0;
+        for (size_t b = 0; b < NumBuckets; ++b)
+        {
+            Offsets[b] = Sum;
+            Sum += Histogram[b];
+        }
+
+        for (size_t i = 0; i < Count; ++i)
+        {
+            const auto Dst  = Offsets[(pSrcKeys[i] >> Shift) & 0xFF]++;
+            pDstKeys[Dst]   = pSrcKeys[i];
+            pDstValues[Dst] = std::move(pSrcValues[i]);
+        }
+
+        std::swap(pSrcKeys, pDstKeys);
+        std::swap(pSrcValues, pDstValues);
+    }
+
+    if (pSrcKeys != Keys)
+    {
+        // Odd number of passes - the sorted data is in the scratch arrays
+        for (size_t i = 0; i < Count; ++i)
+        {
+            Keys[i]   = pSrcKeys[i];
+            Values[i] = std::move(pSrcValues[i]);
+        }
+    }
+}
+
+/// Converts a float to an unsigned integer key that has the same order, so that
+/// floats can be sorted by RadixSort() without quantization.
+
+/// Positive values get the sign bit set, and all bits of negative values are flipped, so that
+/// larger negative values map to smaller keys. NaN values are not supported.
+inline Uint32 FloatToSortKey(float Value)
+{
+    Uint32 Bits;
+    static_assert(sizeof(Bits) == sizeof(Value), "Unexpected float size");
+    memcpy(&Bits, &Value, sizeof(Bits));
+    return (Bits & 0x80000000u) != 0 ? ~Bits : (Bits | 0x80000000u);
+}
+
+} // namespace Diligent
@@ -0,0 +1,125 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+/// \file
+/// Defines a pool of worker threads
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <memory>
+#include <functional>
+
+#include "../../Primitives/interface/BasicTypes.h"
+
+namespace Diligent
+{
+
+/// Pool of worker threads that execute data-parallel loops and asynchronous tasks.
+
+/// Loops started by ParallelFor() and tasks queued by EnqueueTask() share one queue that the
+/// workers serve in FIFO order. The thread that calls ParallelFor() executes tasks of its own
+/// loop along with the workers that pick the loop up. When no tasks of the loop are left to start,
+/// the thread blocks until the workers complete the tasks they are executing; it never executes
+/// tasks of other loops or queued asynchronous tasks. Several threads may run loops on the same
+/// pool simultaneously, but a loop that is queued behind long-running tasks is mostly executed
+/// by its calling thread.
+class ThreadPool
+{
+public:
+    /// Creates the pool with NumWorkerThreads worker threads.
+    explicit ThreadPool(Uint32 NumWorkerThreads);
+    ~ThreadPool();
+
+    // clang-format off
+    ThreadPool           (const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    // clang-format on
+
+    /// Calls Func(i) for every i in [0, NumTasks) and returns when all calls complete.
+
+    /// The calling thread also executes tasks, so the function makes progress even when
+    /// all worker threads are busy. Tasks may be executed in any order.
+    void ParallelFor(Uint32 NumTasks, const std::function<void(Uint32)>& Func);
+
+    /// Queues the task for asynchronous execution by a worker thread and returns immediately.
+
+    /// Tasks are started in the order they are queued, after the loops that are already queued.
+    /// If the pool has no worker threads, the task is executed by the calling thread before the
+    /// function returns. All tasks must complete before the pool is destroyed.
+    void EnqueueTask(std::function<void()> Task);
+
+    Uint32 GetNumWorkerThreads() const { return static_cast<Uint32>(m_WorkerThreads.size()); }
+
+    /// Returns the pool shared by the engine tools. The pool is created on first use and
+    /// has one thread less than the number of hardware threads.
+    static ThreadPool& GetShared();
+
+private:
+    struct Loop
+    {
+        Loop(Uint32 _NumTasks, const std::function<void(Uint32)>& _Func) :
+            NumTasks{_NumTasks},
+            Func{_Func}
+        {}
+
+        // Single-task loop that owns its function, see EnqueueTask()
+        explicit Loop(std::function<void(Uint32)>&& _OwnedFunc) :
+            NumTasks{1},
+            OwnedFunc{std::move(_OwnedFunc)},
+            Func{OwnedFunc}
+        {}
+
+        const Uint32                       NumTasks;
+        std::function<void(Uint32)>        OwnedFunc;
+        const std::function<void(Uint32)>& Func;
+
+        std::atomic<Uint32> NextTask{0};
+        std::atomic<Uint32> NumCompleted{0};
+    };
+
+    // Executes tasks of the loop until there are none left.
+    // Returns true if the last task of the loop was completed by this call.
+    static bool ExecuteTasks(Loop& L);
+
+    void WorkerThreadFunc();
+
+    std::vector<std::thread> m_WorkerThreads;
+
+    std::mutex                        m_Mutex;
+    std::condition_variable           m_WorkCondVar;
+    std::condition_variable           m_DoneCondVar;
+    std::deque<std::shared_ptr<Loop>> m_Loops;
+    bool                              m_Stop = false;
+};
+
+} // namespace Diligent
@@ -24,54 +24,340 @@
  *  all other commercial damages or losses), even if such Contributor has been advised 
  *  of the possibility of such damages.
  */
-
 #include "pch.h"
 #include <algorithm>
+#include <atomic>
+#include <thread>
+#include <new>
+#include <cstdlib>
+#if PLATFORM_WIN32 || PLATFORM_UNIVERSAL_WINDOWS
+#    include <malloc.h>
+#endif
 #include "FixedBlockMemoryAllocator.hpp"
 #include "Align.hpp"
 
 namespace Diligent
 {
 
-static size_t AdjustBlockSize(size_t BlockSize)
+namespace
+{
+
+constexpr size_t CacheLineSize = 64;
+
+// Pages are at least this large so that the page header does not dominate small pages
+constexpr size_t MinPageAlignment = 256;
+
+// The number of pages in a chunk doubles every time a new chunk is allocated until it reaches this value
+constexpr Uint32 MaxPagesInChunk = 8;
+
+constexpr Uint32 MaxCacheBatchSize  = 32;
+constexpr Uint32 MaxNumThreadCaches = 32;
+
+size_t AdjustBlockSize(size_t BlockSize)
 {
     return Align(std::max(BlockSize, size_t{1}), sizeof(void*));
 }
 
+void*& NextBlock(void* pBlock)
+{
+    return *reinterpret_cast<void**>(pBlock);
+}
+
+// IMemoryAllocator can't request alignment, so pages are allocated from the system
+// allocator instead of over-allocating raw memory and aligning the pointer
+void* AllocateAlignedPages(size_t Size, size_t Alignment)
+{
+#if PLATFORM_WIN32 || PLATFORM_UNIVERSAL_WINDOWS
+    void* Ptr = _aligned_malloc(Size, Alignment);
+#else
+    void* Ptr = nullptr;
+    if (posix_memalign(&Ptr, Alignment, Size) != 0)
+        Ptr = nullptr;
+#endif
+    if (Ptr == nullptr)
+        throw std::bad_alloc{};
+    return Ptr;
+}
+
+void FreeAlignedPages(void* Ptr)
+{
+#if PLATFORM_WIN32 || PLATFORM_UNIVERSAL_WINDOWS
+    _aligned_free(Ptr);
+#else
+    free(Ptr);
+#endif
+}
+
+// Returns the index of the calling thread. Threads are numbered in the order
+// in which they first access any fixed block allocator.
+Uint32 GetThreadIndex()
+{
+    static std::atomic<Uint32> NextThreadIndex{0};
+    static thread_local Uint32 ThreadIndex = NextThreadIndex.fetch_add(1);
+    return ThreadIndex;
+}
+
+} // namespace
+
+struct FixedBlockMemoryAllocator::PageHeader
+{
+    FixedBlockMemoryAllocator* const pOwnerAllocator;
+
+    PageHeader* pPrevAvailablePage = nullptr;
+    PageHeader* pNextAvailablePage = nullptr;
+
+    void*  pNextFreeBlock       = nullptr; // Head of the free block list
+    Uint32 NumFreeBlocks        = 0;       // Num of remaining blocks
+    Uint32 NumInitializedBlocks = 0;       // Num of initialized blocks
+
+    explicit PageHeader(FixedBlockMemoryAllocator& OwnerAllocator) :
+        pOwnerAllocator{&OwnerAllocator},
+        NumFreeBlocks{OwnerAllocator.m_NumBlocksInPage}
+    {}
+};
+
+struct alignas(CacheLineSize) FixedBlockMemoryAllocator::ThreadCache
+{
+    std::mutex Mtx;
+    void*      pFirstBlock = nullptr;
+    Uint32     NumBlocks   = 0;
+};
+
+const size_t FixedBlockMemoryAllocator::PageHeaderSize = (sizeof(PageHeader) + 15) & ~size_t{15};
+
+size_t FixedBlockMemoryAllocator::ComputePageAlignment(size_t BlockSize, Uint32 NumBlocksInPage)
+{
+    const size_t MinPageSize   = PageHeaderSize + AdjustBlockSize(BlockSize) * std::max(NumBlocksInPage, 1u);
+    size_t       PageAlignment = MinPageAlignment;
+    while (PageAlignment < MinPageSize)
+        PageAlignment *= 2;
+    return PageAlignment;
+}
+
+Uint32 FixedBlockMemoryAllocator::ComputeNumThreadCaches()
+{
+    const Uint32 NumThreads      = std::max(std::thread::hardware_concurrency(), 1u);
+    Uint32       NumThreadCaches = 1;
+    while (NumThreadCaches < NumThreads && NumThreadCaches < MaxNumThreadCaches)
+        NumThreadCaches *= 2;
+    return NumThreadCaches;
+}
+
 FixedBlockMemoryAllocator::FixedBlockMemoryAllocator(IMemoryAllocator& RawMemoryAllocator,
                                                      size_t            BlockSize,
                                                      Uint32            NumBlocksInPage) :
     // clang-format off
-    m_PagePool          (STD_ALLOCATOR_RAW_MEM(MemoryPage, RawMemoryAllocator, "Allocator for vector<MemoryPage>")),
-    m_AvailablePages    (STD_ALLOCATOR_RAW_MEM(size_t, RawMemoryAllocator, "Allocator for unordered_set<size_t>") ),
-    m_AddrToPageId      (STD_ALLOCATOR_RAW_MEM(AddrToPageIdMapElem, RawMemoryAllocator, "Allocator for unordered_map<void*, size_t>")),
     m_RawMemoryAllocator{RawMemoryAllocator        },
     m_BlockSize         {AdjustBlockSize(BlockSize)},
-    m_NumBlocksInPage   {NumBlocksInPage           }
+    m_PageAlignment     {ComputePageAlignment(BlockSize, NumBlocksInPage)},
+    // Extend the page to fill its alignment
+    m_NumBlocksInPage   {static_cast<Uint32>((m_PageAlignment - PageHeaderSize) / m_BlockSize)},
+    m_CacheBatchSize    {std::min(std::max(m_NumBlocksInPage / 4, 1u), MaxCacheBatchSize)},
+    m_NumThreadCaches   {ComputeNumThreadCaches()},
+    m_Chunks            (STD_ALLOCATOR_RAW_MEM(PageChunk, RawMemoryAllocator, "Allocator for vector<PageChunk>"))
 // clang-format on
 {
     VERIFY_EXPR(BlockSize > 0);
+    VERIFY_EXPR(m_NumBlocksInPage >= NumBlocksInPage);
 
-    // Allocate one page
-    CreateNewPage();
+    m_pThreadCachesRawMem = m_RawMemoryAllocator.Allocate(sizeof(ThreadCache) * m_NumThreadCaches + CacheLineSize - 1,
+                                                          "Raw memory for FixedBlockMemoryAllocator thread caches", __FILE__, __LINE__);
+    m_pThreadCaches       = reinterpret_cast<ThreadCache*>(Align(reinterpret_cast<Uint8*>(m_pThreadCachesRawMem), CacheLineSize));
+    for (Uint32 i = 0; i < m_NumThreadCaches; ++i)
+        new (m_pThreadCaches + i) ThreadCache{};
 }
 
 FixedBlockMemoryAllocator::~FixedBlockMemoryAllocator()
 {
-#ifdef DILIGENT_DEBUG
-    for (size_t p = 0; p < m_PagePool.size(); ++p)
+    for (Uint32 i = 0; i < m_NumThreadCaches; ++i)
     {
-        VERIFY(!m_PagePool[p].HasAllocations(), "Memory leak detected: memory page has allocated block");
-        VERIFY(m_AvailablePages.find(p) != m_AvailablePages.end(), "Memory page is not in the available page pool");
+        auto& Cache = m_pThreadCaches[i];
+        if (Cache.pFirstBlock != nullptr)
+            ReleaseBlocks(Cache.pFirstBlock);
+        Cache.~ThreadCache();
     }
+    m_RawMemoryAllocator.Free(m_pThreadCachesRawMem);
+
+    for (const auto& Chunk : m_Chunks)
+    {
+#ifdef DILIGENT_DEBUG
+        for (Uint32 p = 0; p < Chunk.NumPages; ++p)
+        {
+            const auto* pPage = reinterpret_cast<const PageHeader*>(reinterpret_cast<Uint8*>(Chunk.pFirstPage) + p * m_PageAlignment);
+            VERIFY(pPage->NumFreeBlocks == m_NumBlocksInPage, "Memory leak detected: memory page has allocated block");
+        }
 #endif
+        FreeAlignedPages(Chunk.pFirstPage);
+    }
+}
+
+void* FixedBlockMemoryAllocator::GetBlockStartAddress(PageHeader* pPage, Uint32 BlockIndex) const
+{
+    VERIFY(BlockIndex < m_NumBlocksInPage, "Invalid block index");
+    return reinterpret_cast<Uint8*>(pPage) + PageHeaderSize + BlockIndex * m_BlockSize;
+}
+
+#ifdef DILIGENT_DEBUG
+void FixedBlockMemoryAllocator::dbgVerifyAddress(void* pBlock) const
+{
+    const auto* pPage = GetPage(pBlock);
+    VERIFY(pPage->pOwnerAllocator == this, "The block was not allocated by this allocator");
+    size_t Delta = reinterpret_cast<const Uint8*>(pBlock) - reinterpret_cast<const Uint8*>(pPage);
+    VERIFY(Delta >= PageHeaderSize && (Delta - PageHeaderSize) % m_BlockSize == 0, "Invalid address");
+    VERIFY((Delta - PageHeaderSize) / m_BlockSize < m_NumBlocksInPage, "Invalid block index");
 }
+#endif
 
-void FixedBlockMemoryAllocator::CreateNewPage()
+void FixedBlockMemoryAllocator::AddAvailablePage(PageHeader& Page)
 {
-    m_PagePool.emplace_back(*this);
-    m_AvailablePages.insert(m_PagePool.size() - 1);
-    m_AddrToPageId.reserve(m_PagePool.size() * m_NumBlocksInPage);
+    VERIFY_EXPR(Page.pPrevAvailablePage == nullptr && Page.pNextAvailablePage == nullptr && m_pAvailablePages != &Page);
+    Page.pNextAvailablePage = m_pAvailablePages;
+    if (m_pAvailablePages != nullptr)
+        m_pAvailablePages->pPrevAvailablePage = &Page;
+    m_pAvailablePages = &Page;
+}
+
+void FixedBlockMemoryAllocator::RemoveAvailablePage(PageHeader& Page)
+{
+    if (Page.pPrevAvailablePage != nullptr)
+        Page.pPrevAvailablePage->pNextAvailablePage = Page.pNextAvailablePage;
+    else
+    {
+        VERIFY_EXPR(m_pAvailablePages == &Page);
+        m_pAvailablePages = Page.pNextAvailablePage;
+    }
+    if (Page.pNextAvailablePage != nullptr)
+        Page.pNextAvailablePage->pPrevAvailablePage = Page.pPrevAvailablePage;
+
+    Page.pPrevAvailablePage = nullptr;
+    Page.pNextAvailablePage = nullptr;
+}
+
+void FixedBlockMemoryAllocator::CreatePages()
+{
+    const auto  NumPages   = m_NumPagesInNextChunk;
+    auto* const pFirstPage = reinterpret_cast<Uint8*>(AllocateAlignedPages(size_t{NumPages} * m_PageAlignment, m_PageAlignment));
+    FillWithDebugPattern(pFirstPage, NewPageMemPattern, NumPages * m_PageAlignment);
+
+    // Add pages in reverse order so that the first page is allocated from first
+    for (Uint32 p = NumPages; p > 0; --p)
+    {
+        auto* pPage           = new (pFirstPage + (p - 1) * m_PageAlignment) PageHeader{*this};
+        pPage->pNextFreeBlock = GetBlockStartAddress(pPage, 0);
+        AddAvailablePage(*pPage);
+    }
+
+    PageChunk Chunk;
+    Chunk.pFirstPage = reinterpret_cast<PageHeader*>(pFirstPage);
+    Chunk.NumPages   = NumPages;
+    m_Chunks.emplace_back(Chunk);
+
+    m_NumPagesInNextChunk = std::min(m_NumPagesInNextChunk * 2, MaxPagesInChunk);
+}
+
+// Block allocation within a page is based on the fixed-size memory pool described in
+// "Fast Efficient Fixed-Size Memory Pool" by Ben Kenwright
+void* FixedBlockMemoryAllocator::AllocateBlock(PageHeader& Page)
+{
+    VERIFY_EXPR(Page.NumFreeBlocks > 0);
+
+    // Initialize the next block
+    if (Page.NumInitializedBlocks < m_NumBlocksInPage)
+    {
+        // Link next uninitialized block to the end of the list:
+
+        //
+        //                            ___________                      ___________
+        //                           |           |                    |           |
+        //                           | 0xcdcdcd  |                 -->| 0xcdcdcd  |   m_NumInitializedBlocks
+        //                           |-----------|                |   |-----------|
+        //                           |           |                |   |           |
+        //  m_NumInitializedBlocks   | 0xcdcdcd  |      ==>        ---|           |
+        //                           |-----------|                    |-----------|
+        //
+        //                           ~           ~                    ~           ~
+        //                           |           |                    |           |
+        //                       0   |           |                    |           |
+        //                            -----------                      -----------
+        //
+        auto* pUninitializedBlock = GetBlockStartAddress(&Page, Page.NumInitializedBlocks);
+        FillWithDebugPattern(pUninitializedBlock, InitializedBlockMemPattern, m_BlockSize);
+        ++Page.NumInitializedBlocks;
+        if (Page.NumInitializedBlocks < m_NumBlocksInPage)
+            NextBlock(pUninitializedBlock) = GetBlockStartAddress(&Page, Page.NumInitializedBlocks);
+        else
+            NextBlock(pUninitializedBlock) = nullptr;
+    }
+
+    void* res = Page.pNextFreeBlock;
+    dbgVerifyAddress(res);
+    // Move pointer to the next free block
+    Page.pNextFreeBlock = NextBlock(res);
+    --Page.NumFreeBlocks;
+    if (Page.NumFreeBlocks != 0)
+        dbgVerifyAddress(Page.pNextFreeBlock);
+    else
+        VERIFY_EXPR(Page.pNextFreeBlock == nullptr);
+
+    return res;
+}
+
+void FixedBlockMemoryAllocator::RefillCache(ThreadCache& Cache)
+{
+    VERIFY_EXPR(Cache.pFirstBlock == nullptr && Cache.NumBlocks == 0);
+
+    std::lock_guard<std::mutex> Lock{m_PageMtx};
+
+    // Blocks are added to the end of the list so that they are allocated in the page order
+    void** ppLastBlock = &Cache.pFirstBlock;
+    while (Cache.NumBlocks < m_CacheBatchSize)
+    {
+        if (m_pAvailablePages == nullptr)
+        {
+            // Only create new pages when there are no free blocks at all
+            if (Cache.NumBlocks > 0)
+                break;
+            CreatePages();
+        }
+
+        auto& Page   = *m_pAvailablePages;
+        auto* pBlock = AllocateBlock(Page);
+        if (Page.NumFreeBlocks == 0)
+            RemoveAvailablePage(Page);
+
+        *ppLastBlock = pBlock;
+        ppLastBlock  = &NextBlock(pBlock);
+        ++Cache.NumBlocks;
+    }
+    *ppLastBlock = nullptr;
+}
+
+void FixedBlockMemoryAllocator::ReleaseBlocks(void* pFirstBlock)
+{
+    // Reverse the list so that the first block ends up on top of its page's free list
+    void* pReversed = nullptr;
+    while (pFirstBlock != nullptr)
+    {
+        auto* pNext            = NextBlock(pFirstBlock);
+        NextBlock(pFirstBlock) = pReversed;
+        pReversed              = pFirstBlock;
+        pFirstBlock            = pNext;
+    }
+
+    std::lock_guard<std::mutex> Lock{m_PageMtx};
+    while (pReversed != nullptr)
+    {
+        auto* pBlock = pReversed;
+        pReversed    = NextBlock(pBlock);
+
+        auto& Page = *GetPage(pBlock);
+        VERIFY_EXPR(Page.NumFreeBlocks < m_NumBlocksInPage);
+        // Add block to the beginning of the linked list
+        NextBlock(pBlock)   = Page.pNextFreeBlock;
+        Page.pNextFreeBlock = pBlock;
+        if (Page.NumFreeBlocks++ == 0)
+            AddAvailablePage(Page);
+    }
 }
 
 void* FixedBlockMemoryAllocator::Allocate(size_t Size, const Char* dbgDescription, const char* dbgFileName, const Int32 dbgLineNumber)
@@ -81,49 +367,58 @@ void* FixedBlockMemoryAllocator::Allocate(size_t Size, const Char* dbgDescriptio
     Size = AdjustBlockSize(Size);
     VERIFY(m_BlockSize == Size, "Requested size (", Size, ") does not match the block size (", m_BlockSize, ")");
 
-    std::lock_guard<std::mutex> LockGuard(m_Mutex);
+    auto& Cache = m_pThreadCaches[GetThreadIndex() & (m_NumThreadCaches - 1)];
 
-    if (m_AvailablePages.empty())
+    void* Ptr = nullptr;
     {
-        CreateNewPage();
-    }
+        std::lock_guard<std::mutex> Lock{Cache.Mtx};
+        if (Cache.pFirstBlock == nullptr)
+            RefillCache(Cache);
 
-    auto  PageId = *m_AvailablePages.begin();
-    auto& Page   = m_PagePool[PageId];
-    auto* Ptr    = Page.Allocate();
-    m_AddrToPageId.insert(std::make_pair(Ptr, PageId));
-    if (!Page.HasSpace())
-    {
-        m_AvailablePages.erase(m_AvailablePages.begin());
+        Ptr               = Cache.pFirstBlock;
+        Cache.pFirstBlock = NextBlock(Ptr);
+        --Cache.NumBlocks;
     }
 
+    dbgVerifyAddress(Ptr);
+    FillWithDebugPattern(Ptr, AllocatedBlockMemPattern, m_BlockSize);
     return Ptr;
 }
 
 void FixedBlockMemoryAllocator::Free(void* Ptr)
 {
-    std::lock_guard<std::mutex> LockGuard(m_Mutex);
-    auto                        PageIdIt = m_AddrToPageId.find(Ptr);
-    if (PageIdIt != m_AddrToPageId.end())
+    if (Ptr == nullptr)
     {
-        auto PageId = PageIdIt->second;
-        VERIFY_EXPR(PageId >= 0 && PageId < m_PagePool.size());
-        m_PagePool[PageId].DeAllocate(Ptr);
-        m_AvailablePages.insert(PageId);
-        m_AddrToPageId.erase(PageIdIt);
-        if (m_AvailablePages.size() > 1 && !m_PagePool[PageId].HasAllocations())
-        {
-            // In current implementation pages are never released!
-            // Note that if we delete a page, all indices past it will be invalid
-
-            //m_PagePool.erase(m_PagePool.begin() + PageId);
-            //m_AvailablePages.erase(PageId);
-        }
+        UNEXPECTED("Attempting to free null pointer");
+        return;
     }
-    else
+
+    dbgVerifyAddress(Ptr);
+    FillWithDebugPattern(Ptr, DeallocatedBlockMemPattern, m_BlockSize);
+
+    auto& Cache = m_pThreadCaches[GetThreadIndex() & (m_NumThreadCaches - 1)];
+
+    void* pBlocksToRelease = nullptr;
     {
-        UNEXPECTED("Address not found in the allocations list - double freeing memory?");
+        std::lock_guard<std::mutex> Lock{Cache.Mtx};
+        NextBlock(Ptr)    = Cache.pFirstBlock;
+        Cache.pFirstBlock = Ptr;
+        ++Cache.NumBlocks;
+
+        if (Cache.NumBlocks > m_CacheBatchSize * 2)
+        {
+            // Keep the most recently freed blocks in the cache and release the rest
+            void* pLastBlock = Cache.pFirstBlock;
+            for (Uint32 i = 1; i < m_CacheBatchSize; ++i)
+                pLastBlock = NextBlock(pLastBlock);
+            pBlocksToRelease      = NextBlock(pLastBlock);
+            NextBlock(pLastBlock) = nullptr;
+            Cache.NumBlocks       = m_CacheBatchSize;
+        }
     }
+
+    if (pBlocksToRelease != nullptr)
+        ReleaseBlocks(pBlocksToRelease);
 }
 
 } // namespace Diligent
@@ -0,0 +1,110 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+#include "pch.h"
+
+#include "MappedFileDataBlob.hpp"
+
+#if PLATFORM_LINUX || PLATFORM_ANDROID
+#    include <fcntl.h>
+#    include <unistd.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#endif
+
+#include "RefCntAutoPtr.hpp"
+#include "Errors.hpp"
+#include "DebugUtilities.hpp"
+
+namespace Diligent
+{
+
+void MappedFileDataBlob::Create(const Char* FilePath, IDataBlob** ppDataBlob)
+{
+    DEV_CHECK_ERR(FilePath != nullptr && ppDataBlob != nullptr, "File path and data blob pointer must not be null");
+    DEV_CHECK_ERR(*ppDataBlob == nullptr, "Overwriting reference to existing object may cause memory leaks");
+    *ppDataBlob = nullptr;
+
+#if PLATFORM_LINUX || PLATFORM_ANDROID
+    const auto fd = open(FilePath, O_RDONLY);
+    if (fd < 0)
+        return;
+
+    struct stat FileStat;
+    void*       pData = MAP_FAILED;
+    // Empty files can't be mapped
+    if (fstat(fd, &FileStat) == 0 && FileStat.st_size > 0)
+        pData = mmap(nullptr, static_cast<size_t>(FileStat.st_size), PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    // The mapping keeps its own reference to the file
+    close(fd);
+    if (pData == MAP_FAILED)
+        return;
+
+    // Loaders mostly read the data front to back, so enable aggressive read-ahead
+    madvise(pData, static_cast<size_t>(FileStat.st_size), MADV_SEQUENTIAL);
+
+    RefCntAutoPtr<IDataBlob> pDataBlob{MakeNewRCObj<MappedFileDataBlob>()(pData, static_cast<size_t>(FileStat.st_size))};
+    *ppDataBlob = pDataBlob.Detach();
+#endif
+}
+
+MappedFileDataBlob::MappedFileDataBlob(IReferenceCounters* pRefCounters, void* pData, size_t Size) :
+    TBase{pRefCounters},
+    m_pData{pData},
+    m_Size{Size}
+{}
+
+MappedFileDataBlob::~MappedFileDataBlob()
+{
+#if PLATFORM_LINUX || PLATFORM_ANDROID
+    munmap(m_pData, m_Size);
+#endif
+}
+
+void MappedFileDataBlob::Resize(size_t NewSize)
+{
+    if (NewSize != m_Size)
+        UNEXPECTED("Memory-mapped data blob can't be resized");
+}
+
+size_t MappedFileDataBlob::GetSize() const
+{
+    return m_Size;
+}
+
+void* MappedFileDataBlob::GetDataPtr()
+{
+    return m_pData;
+}
+
+const void* MappedFileDataBlob::GetConstDataPtr() const
+{
+    return m_pData;
+}
+
+IMPLEMENT_QUERY_INTERFACE(MappedFileDataBlob, IID_DataBlob, TBase)
+
+} // namespace Diligent
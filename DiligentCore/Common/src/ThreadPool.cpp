@@ -0,0 +1,144 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+#include "pch.h"
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+
+#include "DebugUtilities.hpp"
+
+namespace Diligent
+{
+
+ThreadPool::ThreadPool(Uint32 NumWorkerThreads)
+{
+    m_WorkerThreads.reserve(NumWorkerThreads);
+    for (Uint32 i = 0; i < NumWorkerThreads; ++i)
+        m_WorkerThreads.emplace_back(&ThreadPool::WorkerThreadFunc, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> Lock{m_Mutex};
+        VERIFY(m_Loops.empty(), "Destroying the thread pool while parallel loops or tasks are pending");
+        m_Stop = true;
+    }
+    m_WorkCondVar.notify_all();
+    for (auto& Thread : m_WorkerThreads)
+        Thread.join();
+}
+
+ThreadPool& ThreadPool::GetShared()
+{
+    static ThreadPool SharedPool{std::max(std::thread::hardware_concurrency(), 1u) - 1u};
+    return SharedPool;
+}
+
+bool ThreadPool::ExecuteTasks(Loop& L)
+{
+    Uint32 NumExecuted = 0;
+    for (auto Task = L.NextTask.fetch_add(1); Task < L.NumTasks; Task = L.NextTask.fetch_add(1))
+    {
+        L.Func(Task);
+        ++NumExecuted;
+    }
+    return NumExecuted > 0 && L.NumCompleted.fetch_add(NumExecuted) + NumExecuted == L.NumTasks;
+}
+
+void ThreadPool::WorkerThreadFunc()
+{
+    for (;;)
+    {
+        std::shared_ptr<Loop> pLoop;
+        {
+            std::unique_lock<std::mutex> Lock{m_Mutex};
+            m_WorkCondVar.wait(Lock, [this]() { return m_Stop || !m_Loops.empty(); });
+            if (m_Stop)
+                return;
+
+            pLoop = m_Loops.front();
+            // All tasks of the loop have been started, no other worker needs to look at it
+            m_Loops.pop_front();
+        }
+
+        if (ExecuteTasks(*pLoop))
+        {
+            // Take the lock so that the waiting thread does not miss the notification
+            std::lock_guard<std::mutex> Lock{m_Mutex};
+            m_DoneCondVar.notify_all();
+        }
+    }
+}
+
+void ThreadPool::ParallelFor(Uint32 NumTasks, const std::function<void(Uint32)>& Func)
+{
+    if (NumTasks == 0)
+        return;
+
+    if (NumTasks == 1 || m_WorkerThreads.empty())
+    {
+        for (Uint32 i = 0; i < NumTasks; ++i)
+            Func(i);
+        return;
+    }
+
+    auto pLoop = std::make_shared<Loop>(NumTasks, Func);
+    {
+        std::lock_guard<std::mutex> Lock{m_Mutex};
+        // Every worker that picks up the loop removes one copy from the queue
+        const auto NumCopies = std::min(NumTasks - 1, GetNumWorkerThreads());
+        m_Loops.insert(m_Loops.end(), NumCopies, pLoop);
+    }
+    m_WorkCondVar.notify_all();
+
+    ExecuteTasks(*pLoop);
+
+    std::unique_lock<std::mutex> Lock{m_Mutex};
+    // Remove the copies that no worker has picked up
+    m_Loops.erase(std::remove(m_Loops.begin(), m_Loops.end(), pLoop), m_Loops.end());
+    m_DoneCondVar.wait(Lock, [&]() { return pLoop->NumCompleted.load() == NumTasks; });
+}
+
+void ThreadPool::EnqueueTask(std::function<void()> Task)
+{
+    if (m_WorkerThreads.empty())
+    {
+        Task();
+        return;
+    }
+
+    auto pLoop = std::make_shared<Loop>(std::function<void(Uint32)>{[Task](Uint32) { Task(); }});
+    {
+        std::lock_guard<std::mutex> Lock{m_Mutex};
+        m_Loops.emplace_back(std::move(pLoop));
+    }
+    m_WorkCondVar.notify_one();
+}
+
+} // namespace Diligent
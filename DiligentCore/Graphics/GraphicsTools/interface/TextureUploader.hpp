@@ -47,10 +47,12 @@ struct UploadBufferDesc
 
     bool operator == (const UploadBufferDesc &rhs) const
     {
-        return Width  == rhs.Width  && 
-                Height == rhs.Height &&
-                Depth  == rhs.Depth  &&
-                Format == rhs.Format;
+        return Width     == rhs.Width     && 
+                Height    == rhs.Height    &&
+                Depth     == rhs.Depth     &&
+                MipLevels == rhs.MipLevels &&
+                ArraySize == rhs.ArraySize &&
+                Format    == rhs.Format;
     }
 };
 // clang-format on
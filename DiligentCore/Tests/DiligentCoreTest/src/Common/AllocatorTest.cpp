@@ -26,6 +26,11 @@
  */
 
 #include <array>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
 
 #include "DefaultRawMemoryAllocator.hpp"
 #include "FixedBlockMemoryAllocator.hpp"
@@ -123,6 +128,123 @@ TEST(Common_FixedBlockMemoryAllocator, UnalignedSize)
     }
 }
 
+TEST(Common_FixedBlockMemoryAllocator, ManyPages)
+{
+    constexpr Uint32 AllocSize             = 48;
+    constexpr Uint32 NumAllocationsPerPage = 8;
+
+    FixedBlockMemoryAllocator TestAllocator(DefaultRawMemoryAllocator::GetAllocator(), AllocSize, NumAllocationsPerPage);
+    EXPECT_GE(TestAllocator.GetNumBlocksInPage(), NumAllocationsPerPage);
+
+    const size_t NumAllocations = size_t{TestAllocator.GetNumBlocksInPage()} * 50 + 3;
+
+    std::vector<Uint8*> Allocations(NumAllocations);
+    for (int iter = 0; iter < 3; ++iter)
+    {
+        for (size_t i = 0; i < NumAllocations; ++i)
+        {
+            Allocations[i] = reinterpret_cast<Uint8*>(TestAllocator.Allocate(AllocSize, "Fixed block allocator test", __FILE__, __LINE__));
+            ASSERT_NE(Allocations[i], nullptr);
+            memset(Allocations[i], static_cast<int>(i & 0xFF), AllocSize);
+        }
+
+        // All blocks must be distinct and must not overlap
+        auto Sorted = Allocations;
+        std::sort(Sorted.begin(), Sorted.end());
+        for (size_t i = 1; i < Sorted.size(); ++i)
+            ASSERT_GE(Sorted[i] - Sorted[i - 1], static_cast<ptrdiff_t>(AllocSize));
+
+        for (size_t i = 0; i < NumAllocations; ++i)
+        {
+            EXPECT_EQ(Allocations[i][0], static_cast<Uint8>(i & 0xFF));
+            EXPECT_EQ(Allocations[i][AllocSize - 1], static_cast<Uint8>(i & 0xFF));
+        }
+
+        // Free every other block first to fragment the pages
+        for (size_t i = 0; i < NumAllocations; i += 2)
+            TestAllocator.Free(Allocations[i]);
+        for (size_t i = 1; i < NumAllocations; i += 2)
+            TestAllocator.Free(Allocations[i]);
+    }
+}
+
+void RunAllocatorThreads(FixedBlockMemoryAllocator& Allocator, size_t BlockSize, Uint32 NumThreads, Uint32 NumIterations, bool CheckContents)
+{
+    std::vector<std::thread> Threads(NumThreads);
+    for (Uint32 t = 0; t < NumThreads; ++t)
+    {
+        Threads[t] = std::thread{
+            [&Allocator, BlockSize, NumIterations, CheckContents](Uint32 ThreadId) {
+                // Every thread keeps a varying number of live blocks to exercise cache refills and flushes
+                std::vector<Uint32*> LiveBlocks;
+                LiveBlocks.reserve(256);
+                Uint32 Seed = ThreadId * 7919 + 1;
+                for (Uint32 i = 0; i < NumIterations; ++i)
+                {
+                    Seed = Seed * 1664525u + 1013904223u;
+                    if (LiveBlocks.size() < 256 && (LiveBlocks.empty() || (Seed >> 16) % 3 != 0))
+                    {
+                        auto* pBlock = reinterpret_cast<Uint32*>(Allocator.Allocate(BlockSize, "Fixed block allocator test", __FILE__, __LINE__));
+                        if (CheckContents)
+                            pBlock[0] = pBlock[BlockSize / sizeof(Uint32) - 1] = ThreadId;
+                        LiveBlocks.push_back(pBlock);
+                    }
+                    else
+                    {
+                        const size_t Idx    = (Seed >> 8) % LiveBlocks.size();
+                        auto*        pBlock = LiveBlocks[Idx];
+                        if (CheckContents)
+                        {
+                            EXPECT_EQ(pBlock[0], ThreadId);
+                            EXPECT_EQ(pBlock[BlockSize / sizeof(Uint32) - 1], ThreadId);
+                        }
+                        LiveBlocks[Idx] = LiveBlocks.back();
+                        LiveBlocks.pop_back();
+                        Allocator.Free(pBlock);
+                    }
+                }
+                for (auto* pBlock : LiveBlocks)
+                    Allocator.Free(pBlock);
+            },
+            t};
+    }
+
+    for (auto& Thread : Threads)
+        Thread.join();
+}
+
+TEST(Common_FixedBlockMemoryAllocator, MultiThreaded)
+{
+    constexpr Uint32 AllocSize = 64;
+
+    FixedBlockMemoryAllocator TestAllocator(DefaultRawMemoryAllocator::GetAllocator(), AllocSize, 32);
+
+    const auto NumThreads = std::max(std::thread::hardware_concurrency(), 4u);
+    RunAllocatorThreads(TestAllocator, AllocSize, NumThreads, 20000, true);
+}
+
+TEST(Common_FixedBlockMemoryAllocator, DISABLED_StressBenchmark)
+{
+    constexpr Uint32 AllocSize     = 256;
+    constexpr Uint32 NumIterations = 2000000;
+
+    const auto MaxThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    double     BaseRate   = 0;
+    for (Uint32 NumThreads = 1; NumThreads <= MaxThreads; NumThreads *= 2)
+    {
+        FixedBlockMemoryAllocator TestAllocator(DefaultRawMemoryAllocator::GetAllocator(), AllocSize, 64);
+
+        const auto Start = std::chrono::high_resolution_clock::now();
+        RunAllocatorThreads(TestAllocator, AllocSize, NumThreads, NumIterations, false);
+        const auto End = std::chrono::high_resolution_clock::now();
+
+        const auto Rate = static_cast<double>(NumIterations) * NumThreads / std::chrono::duration<double>(End - Start).count();
+        if (NumThreads == 1)
+            BaseRate = Rate;
+        LOG_INFO_MESSAGE(NumThreads, " thread(s): ", Rate / 1e6, " M ops/s, scaling ", Rate / BaseRate, "x");
+    }
+}
+
 TEST(Common_LinearAllocator, EmptyAllocator)
 {
     LinearAllocator Allocator{DefaultRawMemoryAllocator::GetAllocator()};
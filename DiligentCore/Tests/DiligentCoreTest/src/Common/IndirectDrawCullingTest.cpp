@@ -0,0 +1,177 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+#include <vector>
+
+#include "IndirectDrawCulling.hpp"
+#include "FastRand.hpp"
+
+#include "gtest/gtest.h"
+
+using namespace Diligent;
+
+namespace
+{
+
+ViewFrustum GetTestFrustum()
+{
+    const auto View     = float4x4::Translation(0, 0, 10);
+    const auto Proj     = float4x4::Projection(PI_F / 3.f, 1.5f, 1.f, 100.f, false);
+    const auto ViewProj = View * Proj;
+
+    ViewFrustum Frustum;
+    ExtractViewFrustumPlanesFromMatrix(ViewProj, Frustum, false);
+    return Frustum;
+}
+
+// Returns the smallest distance from the box to the frustum planes that the box may be culled by.
+// Results of the two visibility tests may differ by rounding when the box touches a plane.
+float GetMinPlaneDistance(const ViewFrustum& Frustum, const BoundBox& Box)
+{
+    float MinDist = FLT_MAX;
+    for (Uint32 i = 0; i < ViewFrustum::NUM_PLANES; ++i)
+    {
+        const auto& Plane    = Frustum.GetPlane(static_cast<ViewFrustum::PLANE_IDX>(i));
+        const auto  Center   = (Box.Min + Box.Max) * 0.5f;
+        const auto  Extents  = (Box.Max - Box.Min) * 0.5f;
+        const auto  Distance = dot(Center, Plane.Normal) + Plane.Distance + dot(Extents, abs(Plane.Normal));
+        MinDist              = std::min(MinDist, std::abs(Distance));
+    }
+    return MinDist;
+}
+
+TEST(Common_IndirectDrawCulling, BoxVisibility)
+{
+    const auto Frustum = GetTestFrustum();
+
+    FastRandFloat Rnd{0, -1, 1};
+
+    Uint32 NumVisible = 0;
+    for (Uint32 i = 0; i < 10000; ++i)
+    {
+        const float3 Center{Rnd() * 60, Rnd() * 60, Rnd() * 60};
+        const float3 Size{Rnd() + 1.f, Rnd() + 1.f, Rnd() + 1.f};
+        const float3 Min = Center - Size;
+        const float3 Max = Center + Size;
+
+        const auto Transform =
+            float4x4::Scale(Rnd() + 2.f, Rnd() + 2.f, Rnd() + 2.f) *
+            float4x4::RotationArbitrary(normalize(float3{Rnd(), Rnd(), Rnd() + 2.f}), Rnd() * PI_F) *
+            float4x4::Translation(Rnd() * 10, Rnd() * 10, Rnd() * 10);
+
+        const auto IsVisible = IsTransformedBoxVisible(Frustum, Min, Max, Transform);
+
+        const auto WorldBox = BoundBox{Min, Max}.Transform(Transform);
+        const auto RefVisible = GetBoxVisibility(Frustum, WorldBox) != BoxVisibility::Invisible;
+        if (IsVisible != RefVisible)
+        {
+            EXPECT_LT(GetMinPlaneDistance(Frustum, WorldBox), 1e-3f) << "i=" << i;
+        }
+
+        if (IsVisible)
+            ++NumVisible;
+    }
+
+    // Make sure that both outcomes are tested
+    EXPECT_GT(NumVisible, 100u);
+    EXPECT_LT(NumVisible, 9900u);
+}
+
+TEST(Common_IndirectDrawCulling, AppendToBuckets)
+{
+    const auto Frustum = GetTestFrustum();
+
+    const float4x4 Transforms[] =
+        {
+            float4x4::Identity(),
+            float4x4::Translation(0, 0, -1000), // Behind the camera
+            float4x4::Scale(2.f),
+        };
+
+    auto MakeDraw = [](Uint32 TransformId, Uint32 BucketId, Uint32 Id) {
+        IndirectDrawRecord Draw;
+        Draw.BoundBoxMin   = float3{-1, -1, -1};
+        Draw.BoundBoxMax   = float3{+1, +1, +1};
+        Draw.TransformId   = TransformId;
+        Draw.BucketId      = BucketId;
+        Draw.NumIndices    = 3 * (Id + 1);
+        Draw.FirstIndex    = 100 * Id;
+        Draw.BaseVertex    = 1000 * Id;
+        Draw.FirstInstance = Id;
+        return Draw;
+    };
+
+    const IndirectDrawRecord Draws[] =
+        {
+            MakeDraw(0, 1, 0),
+            MakeDraw(1, 1, 1), // Culled
+            MakeDraw(2, 0, 2),
+            MakeDraw(0, 0, 3),
+            MakeDraw(1, 0, 4), // Culled
+            MakeDraw(2, 1, 5),
+        };
+
+    // Bucket 0 occupies slots [0, 3), bucket 1 occupies slots [3, 6)
+    Uint32 BucketCounters[] = {0, 3};
+
+    DrawIndexedIndirectArgs Args[6];
+    for (auto& Arg : Args)
+        Arg.NumIndices = ~0u;
+
+    CullIndirectDraws(Frustum, Draws, _countof(Draws), Transforms, BucketCounters, Args);
+
+    EXPECT_EQ(BucketCounters[0], 2u);
+    EXPECT_EQ(BucketCounters[1], 5u);
+
+    auto CheckArgs = [&](Uint32 Slot, Uint32 DrawId) {
+        const auto& Draw = Draws[DrawId];
+        EXPECT_EQ(Args[Slot].NumIndices, Draw.NumIndices) << "Slot=" << Slot;
+        EXPECT_EQ(Args[Slot].NumInstances, 1u) << "Slot=" << Slot;
+        EXPECT_EQ(Args[Slot].FirstIndexLocation, Draw.FirstIndex) << "Slot=" << Slot;
+        EXPECT_EQ(Args[Slot].BaseVertex, Draw.BaseVertex) << "Slot=" << Slot;
+        EXPECT_EQ(Args[Slot].FirstInstanceLocation, Draw.FirstInstance) << "Slot=" << Slot;
+    };
+    CheckArgs(0, 2);
+    CheckArgs(1, 3);
+    CheckArgs(3, 0);
+    CheckArgs(4, 5);
+
+    // Unused slots must not be written
+    EXPECT_EQ(Args[2].NumIndices, ~0u);
+    EXPECT_EQ(Args[5].NumIndices, ~0u);
+}
+
+TEST(Common_IndirectDrawCulling, Empty)
+{
+    const auto Frustum = GetTestFrustum();
+
+    Uint32 BucketCounter = 5;
+    CullIndirectDraws(Frustum, nullptr, 0, nullptr, &BucketCounter, nullptr);
+    EXPECT_EQ(BucketCounter, 5u);
+}
+
+} // namespace
@@ -0,0 +1,83 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+#include <cstring>
+#include <vector>
+
+#include "MappedFileDataBlob.hpp"
+#include "RefCntAutoPtr.hpp"
+#include "FileWrapper.hpp"
+#include "FileSystem.hpp"
+
+#include "gtest/gtest.h"
+
+using namespace Diligent;
+
+namespace
+{
+
+TEST(Common_MappedFileDataBlob, MapFile)
+{
+    static constexpr char FilePath[] = "MappedFileDataBlobTest.bin";
+
+    std::vector<Uint8> Data(100000);
+    for (size_t i = 0; i < Data.size(); ++i)
+        Data[i] = static_cast<Uint8>(i * 7 + (i >> 8));
+    {
+        FileWrapper File{FilePath, EFileAccessMode::Overwrite};
+        ASSERT_FALSE(!File);
+        ASSERT_TRUE(File->Write(Data.data(), Data.size()));
+    }
+
+    {
+        RefCntAutoPtr<IDataBlob> pBlob;
+        MappedFileDataBlob::Create(FilePath, &pBlob);
+#if PLATFORM_LINUX || PLATFORM_ANDROID
+        ASSERT_TRUE(pBlob);
+        ASSERT_EQ(pBlob->GetSize(), Data.size());
+        EXPECT_EQ(memcmp(pBlob->GetConstDataPtr(), Data.data(), Data.size()), 0);
+
+        // The mapping is private, so writes do not change the file
+        static_cast<Uint8*>(pBlob->GetDataPtr())[0] = ~Data[0];
+        {
+            RefCntAutoPtr<IDataBlob> pBlob2;
+            MappedFileDataBlob::Create(FilePath, &pBlob2);
+            ASSERT_TRUE(pBlob2);
+            EXPECT_EQ(static_cast<const Uint8*>(pBlob2->GetConstDataPtr())[0], Data[0]);
+        }
+#else
+        EXPECT_FALSE(pBlob);
+#endif
+    }
+
+    FileSystem::DeleteFile(FilePath);
+
+    RefCntAutoPtr<IDataBlob> pMissingBlob;
+    MappedFileDataBlob::Create("MappedFileDataBlobTest_MissingFile.bin", &pMissingBlob);
+    EXPECT_FALSE(pMissingBlob);
+}
+
+} // namespace
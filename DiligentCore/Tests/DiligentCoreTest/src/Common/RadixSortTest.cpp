@@ -0,0 +1,189 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include "RadixSort.hpp"
+#include "FastRand.hpp"
+
+#include "gtest/gtest.h"
+
+using namespace Diligent;
+
+namespace
+{
+
+template <typename KeyType>
+void TestRadixSort(size_t Count, KeyType KeyMask)
+{
+    FastRandInt Rnd{0, 0, 255};
+
+    std::vector<KeyType> Keys(Count);
+    std::vector<Uint32>  Values(Count);
+    for (size_t i = 0; i < Count; ++i)
+    {
+        KeyType Key = 0;
+        for (size_t b = 0; b < sizeof(KeyType); ++b)
+            Key = static_cast<KeyType>((Key << 8) | Rnd());
+        Keys[i]   = Key & KeyMask;
+        Values[i] = static_cast<Uint32>(i);
+    }
+
+    // Reference: stable sort of (key, original index) pairs
+    std::vector<std::pair<KeyType, Uint32>> Ref(Count);
+    for (size_t i = 0; i < Count; ++i)
+        Ref[i] = std::make_pair(Keys[i], Values[i]);
+    std::stable_sort(Ref.begin(), Ref.end(), [](const std::pair<KeyType, Uint32>& a, const std::pair<KeyType, Uint32>& b) {
+        return a.first < b.first;
+    });
+
+    std::vector<KeyType> TmpKeys(Count);
+    std::vector<Uint32>  TmpValues(Count);
+    RadixSort(Keys.data(), Values.data(), Count, TmpKeys.data(), TmpValues.data());
+
+    for (size_t i = 0; i < Count; ++i)
+    {
+        ASSERT_EQ(Keys[i], Ref[i].first) << "i=" << i;
+        ASSERT_EQ(Values[i], Ref[i].second) << "i=" << i;
+    }
+}
+
+TEST(Common_RadixSort, Keys8)
+{
+    TestRadixSort<Uint8>(1000, 0xFF);
+}
+
+TEST(Common_RadixSort, Keys16)
+{
+    TestRadixSort<Uint16>(10000, 0xFFFF);
+    // Only the low digit varies
+    TestRadixSort<Uint16>(1000, 0x00FF);
+    // Only the high digit varies
+    TestRadixSort<Uint16>(1000, 0xFF00);
+}
+
+TEST(Common_RadixSort, Keys32)
+{
+    TestRadixSort<Uint32>(10000, 0xFFFFFFFFu);
+    // Three passes: the sorted data ends up in the scratch arrays and must be copied back
+    TestRadixSort<Uint32>(1000, 0x00FFFFFFu);
+    // Many equal keys test stability
+    TestRadixSort<Uint32>(1000, 0x7u);
+}
+
+TEST(Common_RadixSort, Keys64)
+{
+    TestRadixSort<Uint64>(1000, ~Uint64{0});
+}
+
+TEST(Common_RadixSort, Trivial)
+{
+    TestRadixSort<Uint32>(0, 0xFFFFFFFFu);
+    TestRadixSort<Uint32>(1, 0xFFFFFFFFu);
+    // All keys are equal
+    TestRadixSort<Uint32>(100, 0);
+
+    Uint16 Keys[]       = {3, 2, 2, 1};
+    Uint16 Values[]     = {0, 1, 2, 3};
+    Uint16 TmpKeys[4]   = {};
+    Uint16 TmpValues[4] = {};
+    RadixSort(Keys, Values, 4, TmpKeys, TmpValues);
+    EXPECT_EQ(Keys[0], 1);
+    EXPECT_EQ(Keys[1], 2);
+    EXPECT_EQ(Keys[2], 2);
+    EXPECT_EQ(Keys[3], 3);
+    EXPECT_EQ(Values[0], 3);
+    EXPECT_EQ(Values[1], 1);
+    EXPECT_EQ(Values[2], 2);
+    EXPECT_EQ(Values[3], 0);
+}
+
+TEST(Common_RadixSort, FloatKeys)
+{
+    const float Values[] = {-1e30f, -100.f, -1.5f, -1e-30f, -0.f, 0.f, 1e-30f, 0.25f, 1.f, 3.5f, 1e30f};
+    for (size_t i = 1; i < sizeof(Values) / sizeof(Values[0]); ++i)
+        EXPECT_LE(FloatToSortKey(Values[i - 1]), FloatToSortKey(Values[i])) << "i=" << i;
+    EXPECT_LT(FloatToSortKey(-1.f), FloatToSortKey(1.f));
+    EXPECT_LT(FloatToSortKey(0.5f), FloatToSortKey(0.75f));
+    EXPECT_LT(FloatToSortKey(-0.75f), FloatToSortKey(-0.5f));
+
+    FastRandFloat Rnd{0, -1000.f, 1000.f};
+
+    std::vector<float>  Depths(1000);
+    std::vector<Uint32> Keys(Depths.size());
+    std::vector<Uint32> Order(Depths.size());
+    for (size_t i = 0; i < Depths.size(); ++i)
+    {
+        Depths[i] = Rnd();
+        Keys[i]   = FloatToSortKey(Depths[i]);
+        Order[i]  = static_cast<Uint32>(i);
+    }
+
+    std::vector<Uint32> TmpKeys(Keys.size());
+    std::vector<Uint32> TmpOrder(Order.size());
+    RadixSort(Keys.data(), Order.data(), Keys.size(), TmpKeys.data(), TmpOrder.data());
+    for (size_t i = 1; i < Order.size(); ++i)
+        ASSERT_LE(Depths[Order[i - 1]], Depths[Order[i]]) << "i=" << i;
+}
+
+// Sorts 10k view-space depths back to front the way the GLTF renderer sorts transparent primitives.
+// The target is less than 0.1 ms per sort.
+TEST(Common_RadixSort, DISABLED_DepthSortBenchmark)
+{
+    constexpr size_t NumPrimitives = 10000;
+    constexpr int    NumIterations = 1000;
+
+    FastRandFloat Rnd{0, 0.1f, 1000.f};
+
+    std::vector<float> Depths(NumPrimitives);
+    for (auto& Depth : Depths)
+        Depth = Rnd();
+
+    std::vector<Uint32> Keys(NumPrimitives);
+    std::vector<Uint32> Order(NumPrimitives);
+    std::vector<Uint32> TmpKeys(NumPrimitives);
+    std::vector<Uint32> TmpOrder(NumPrimitives);
+
+    double TotalTime = 0;
+    for (int it = 0; it < NumIterations; ++it)
+    {
+        const auto Start = std::chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < NumPrimitives; ++i)
+        {
+            Keys[i]  = ~FloatToSortKey(Depths[i]);
+            Order[i] = static_cast<Uint32>(i);
+        }
+        RadixSort(Keys.data(), Order.data(), NumPrimitives, TmpKeys.data(), TmpOrder.data());
+        const auto End = std::chrono::high_resolution_clock::now();
+        TotalTime += std::chrono::duration<double>(End - Start).count();
+    }
+    LOG_INFO_MESSAGE("Depth sort of ", NumPrimitives, " primitives: ", TotalTime / NumIterations * 1000.0, " ms");
+}
+
+} // namespace
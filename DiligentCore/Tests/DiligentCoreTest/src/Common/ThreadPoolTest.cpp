@@ -0,0 +1,128 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+#include <vector>
+#include <atomic>
+#include <thread>
+
+#include "ThreadPool.hpp"
+
+#include "gtest/gtest.h"
+
+using namespace Diligent;
+
+namespace
+{
+
+void TestParallelFor(ThreadPool& Pool, Uint32 NumTasks)
+{
+    std::vector<std::atomic<int>> Counters(NumTasks);
+    for (auto& Counter : Counters)
+        Counter.store(0);
+
+    Pool.ParallelFor(NumTasks, [&](Uint32 Task) { Counters[Task].fetch_add(1); });
+
+    for (Uint32 i = 0; i < NumTasks; ++i)
+        EXPECT_EQ(Counters[i].load(), 1) << "Task " << i;
+}
+
+TEST(Common_ThreadPool, ParallelFor)
+{
+    for (Uint32 NumWorkers : {0u, 1u, 4u})
+    {
+        ThreadPool Pool{NumWorkers};
+        EXPECT_EQ(Pool.GetNumWorkerThreads(), NumWorkers);
+        for (Uint32 NumTasks : {0u, 1u, 2u, 3u, 100u, 10000u})
+            TestParallelFor(Pool, NumTasks);
+    }
+}
+
+TEST(Common_ThreadPool, ConcurrentLoops)
+{
+    ThreadPool Pool{3};
+
+    std::vector<std::thread> Threads;
+    for (int t = 0; t < 4; ++t)
+    {
+        Threads.emplace_back([&Pool]() {
+            for (int i = 0; i < 50; ++i)
+                TestParallelFor(Pool, 64);
+        });
+    }
+    for (auto& Thread : Threads)
+        Thread.join();
+}
+
+TEST(Common_ThreadPool, NestedLoops)
+{
+    ThreadPool Pool{2};
+
+    std::atomic<Uint32> Sum{0};
+    Pool.ParallelFor(8, [&](Uint32 Outer) {
+        Pool.ParallelFor(16, [&](Uint32 Inner) { Sum.fetch_add(Outer * 16 + Inner); });
+    });
+    EXPECT_EQ(Sum.load(), 127u * 128u / 2u);
+}
+
+TEST(Common_ThreadPool, EnqueueTask)
+{
+    for (Uint32 NumWorkers : {0u, 1u, 4u})
+    {
+        ThreadPool Pool{NumWorkers};
+
+        constexpr Uint32              NumTasks = 100;
+        std::vector<std::atomic<int>> Counters(NumTasks);
+        for (auto& Counter : Counters)
+            Counter.store(0);
+
+        std::atomic<Uint32> NumCompleted{0};
+        for (Uint32 i = 0; i < NumTasks; ++i)
+        {
+            Pool.EnqueueTask([&, i]() {
+                Counters[i].fetch_add(1);
+                NumCompleted.fetch_add(1);
+            });
+        }
+        // Loops are executed while the tasks are running
+        TestParallelFor(Pool, 64);
+
+        while (NumCompleted.load() < NumTasks)
+            std::this_thread::yield();
+
+        for (Uint32 i = 0; i < NumTasks; ++i)
+            EXPECT_EQ(Counters[i].load(), 1) << "Task " << i;
+    }
+}
+
+TEST(Common_ThreadPool, Shared)
+{
+    auto& Pool = ThreadPool::GetShared();
+    EXPECT_EQ(&Pool, &ThreadPool::GetShared());
+    TestParallelFor(Pool, 1000);
+}
+
+} // namespace
@@ -0,0 +1,199 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+// Generates the BRDF look-up table embedded into GLTF_PBR_Renderer.
+//
+// The table is computed on the CPU with the same algorithm as PrecomputeGLTF_BRDF.psh.
+// To regenerate the table, compile this file with any C++11 compiler and run it with
+// the output file path:
+//
+//     c++ -O2 -std=c++11 GenerateBRDF_LUT.cpp -o GenerateBRDF_LUT
+//     ./GenerateBRDF_LUT ../../GLTF_PBR_Renderer/src/GLTF_BRDF_LUT.h
+
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+namespace
+{
+
+constexpr std::uint32_t LUTDim     = 128;
+constexpr std::uint32_t NumSamples = 512;
+constexpr float         PI         = 3.1415926536f;
+
+float Saturate(float x)
+{
+    return std::min(std::max(x, 0.f), 1.f);
+}
+
+void Hammersley2D(std::uint32_t i, std::uint32_t N, float& X, float& Y)
+{
+    std::uint32_t bits = (i << 16u) | (i >> 16u);
+    bits               = ((bits & 0x55555555u) << 1u) | ((bits & 0xAAAAAAAAu) >> 1u);
+    bits               = ((bits & 0x33333333u) << 2u) | ((bits & 0xCCCCCCCCu) >> 2u);
+    bits               = ((bits & 0x0F0F0F0Fu) << 4u) | ((bits & 0xF0F0F0F0u) >> 4u);
+    bits               = ((bits & 0x00FF00FFu) << 8u) | ((bits & 0xFF00FF00u) >> 8u);
+
+    X = static_cast<float>(i) / static_cast<float>(N);
+    Y = static_cast<float>(bits) * 2.3283064365386963e-10f;
+}
+
+float SmithGGXVisibilityCorrelated(float NdotL, float NdotV, float AlphaRoughness)
+{
+    const float a2 = AlphaRoughness * AlphaRoughness;
+
+    const float GGXV = NdotL * std::sqrt(std::max(NdotV * NdotV * (1.f - a2) + a2, 1e-7f));
+    const float GGXL = NdotV * std::sqrt(std::max(NdotL * NdotL * (1.f - a2) + a2, 1e-7f));
+
+    return 0.5f / (GGXV + GGXL);
+}
+
+void IntegrateBRDF(float Roughness, float NoV, float& A, float& B)
+{
+    // Tangent space with N = (0, 0, 1)
+    const float Vx = std::sqrt(1.f - NoV * NoV);
+    const float Vz = NoV;
+
+    A = 0;
+    B = 0;
+    for (std::uint32_t i = 0; i < NumSamples; ++i)
+    {
+        float Xi0, Xi1;
+        Hammersley2D(i, NumSamples, Xi0, Xi1);
+
+        // Importance sample GGX
+        const float a        = Roughness * Roughness;
+        const float Phi      = 2.f * PI * Xi0;
+        const float CosTheta = std::sqrt((1.f - Xi1) / (1.f + (a * a - 1.f) * Xi1));
+        const float SinTheta = std::sqrt(1.f - CosTheta * CosTheta);
+        const float Hx       = SinTheta * std::cos(Phi);
+        const float Hz       = CosTheta;
+        // H.y is not needed since V.y is zero
+
+        const float VoH_ = Vx * Hx + Vz * Hz;
+        const float Lz   = 2.f * VoH_ * Hz - Vz;
+
+        const float NoL = Saturate(Lz);
+        const float NoH = Saturate(Hz);
+        const float VoH = Saturate(VoH_);
+        if (NoL > 0)
+        {
+            const float G_Vis = 4.f * SmithGGXVisibilityCorrelated(NoL, NoV, Roughness) * VoH * NoL / NoH;
+            const float Fc    = std::pow(1.f - VoH, 5.f);
+            A += (1.f - Fc) * G_Vis;
+            B += Fc * G_Vis;
+        }
+    }
+    A /= static_cast<float>(NumSamples);
+    B /= static_cast<float>(NumSamples);
+}
+
+std::uint16_t FloatToHalf(float f)
+{
+    std::uint32_t u;
+    std::memcpy(&u, &f, sizeof(u));
+
+    const std::uint32_t Sign = (u >> 16u) & 0x8000u;
+    const std::int32_t  Exp  = static_cast<std::int32_t>((u >> 23u) & 0xFFu) - 127 + 15;
+    std::uint32_t       Mant = u & 0x7FFFFFu;
+    if (Exp <= 0)
+    {
+        if (Exp < -10)
+            return static_cast<std::uint16_t>(Sign);
+        // Denormalized half
+        Mant |= 0x800000u;
+        const std::uint32_t Shift = static_cast<std::uint32_t>(14 - Exp);
+        std::uint32_t       Half  = Mant >> Shift;
+        // Round to nearest even
+        const std::uint32_t Rem = Mant & ((1u << Shift) - 1u);
+        if (Rem > (1u << (Shift - 1u)) || (Rem == (1u << (Shift - 1u)) && (Half & 1u)))
+            ++Half;
+        return static_cast<std::uint16_t>(Sign | Half);
+    }
+    if (Exp >= 31)
+        return static_cast<std::uint16_t>(Sign | 0x7C00u);
+
+    std::uint32_t Half = Sign | (static_cast<std::uint32_t>(Exp) << 10u) | (Mant >> 13u);
+    // Round to nearest even
+    const std::uint32_t Rem = Mant & 0x1FFFu;
+    if (Rem > 0x1000u || (Rem == 0x1000u && (Half & 1u)))
+        ++Half;
+    return static_cast<std::uint16_t>(Half);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    if (argc != 2)
+    {
+        std::printf("Usage: GenerateBRDF_LUT <output file>\n");
+        return -1;
+    }
+
+    // Texel (x, y) contains the scale and the bias to F0 for NdotV = (x + 0.5) / Dim
+    // and linear roughness = (y + 0.5) / Dim, as in PrecomputeGLTF_BRDF.psh.
+    std::vector<std::uint16_t> Data(LUTDim * LUTDim * 2);
+    for (std::uint32_t y = 0; y < LUTDim; ++y)
+    {
+        for (std::uint32_t x = 0; x < LUTDim; ++x)
+        {
+            const float NoV       = (static_cast<float>(x) + 0.5f) / static_cast<float>(LUTDim);
+            const float Roughness = (static_cast<float>(y) + 0.5f) / static_cast<float>(LUTDim);
+
+            float A, B;
+            IntegrateBRDF(Roughness, NoV, A, B);
+            Data[(x + y * LUTDim) * 2 + 0] = FloatToHalf(A);
+            Data[(x + y * LUTDim) * 2 + 1] = FloatToHalf(B);
+        }
+    }
+
+    FILE* pFile = std::fopen(argv[1], "w");
+    if (pFile == nullptr)
+    {
+        std::printf("Failed to open output file %s\n", argv[1]);
+        return -1;
+    }
+
+    std::fprintf(pFile, "// This file is generated by DiligentFX/BuildTools/BRDF_LUT/GenerateBRDF_LUT.cpp. Do not edit.\n\n");
+    std::fprintf(pFile, "static constexpr Uint32 g_BRDF_LUT_Dim = %u;\n\n", LUTDim);
+    std::fprintf(pFile, "// RG16_FLOAT texels, %u samples per texel\n", NumSamples);
+    std::fprintf(pFile, "static const Uint16 g_BRDF_LUT[] =\n{");
+    for (size_t i = 0; i < Data.size(); ++i)
+    {
+        if (i % 16 == 0)
+            std::fprintf(pFile, "\n   ");
+        std::fprintf(pFile, " 0x%04X,", Data[i]);
+    }
+    std::fprintf(pFile, "\n};\n");
+    std::fclose(pFile);
+
+    return 0;
+}
@@ -28,16 +28,21 @@
 #pragma once
 
 #include <unordered_map>
+#include <array>
+#include <string>
 #include <functional>
 
 #include "../../../DiligentCore/Graphics/GraphicsEngine/interface/DeviceContext.h"
 #include "../../../DiligentCore/Graphics/GraphicsEngine/interface/RenderDevice.h"
 #include "../../../DiligentCore/Common/interface/HashUtils.hpp"
+#include "../../../DiligentCore/Common/interface/AdvancedMath.hpp"
 #include "../../../DiligentTools/AssetLoader/interface/GLTFLoader.hpp"
 
 namespace Diligent
 {
 
+class ThreadPool;
+
 #include "Shaders/GLTF_PBR/public/GLTF_PBR_Structures.fxh"
 
 /// Implementation of a GLTF PBR renderer
@@ -68,12 +73,45 @@ public:
         /// Indicates whether to use IBL.
         bool UseIBL = false;
 
+        /// Directory where cube maps computed by PrecomputeCubemaps() are cached between runs.
+        /// When null, the cube maps are computed every time.
+        const char* IBLCacheDirectory = nullptr;
+
         /// Whether to use ambient occlusion texture.
         bool UseAO = true;
 
         /// Whether to use emissive texture.
         bool UseEmissive = true;
 
+        /// Whether the renderer will be used with models that store vertices in the compact
+        /// layout (see GLTF::Model::CreateInfo::UseCompactVertexLayout).
+        bool UseCompactVertexLayout = false;
+
+        /// Whether to upload node transforms, joint matrices and material attributes of the
+        /// whole model into structured buffers once per Render() call instead of updating
+        /// constant buffers for every primitive. Every draw call then only passes an index
+        /// of its draw record through the per-instance vertex stream.
+        /// The device must support structured buffers in vertex and pixel shaders.
+        /// Custom render callbacks are not affected by this option.
+        bool UseStructuredBuffers = false;
+
+        /// Whether to create resources for GPU-driven rendering of static models (see RenderIndirect()).
+        /// Indirect rendering requires UseStructuredBuffers as well as compute shader and indirect
+        /// rendering support.
+        bool AllowIndirectDraws = false;
+
+        /// Whether to blend dual quaternions instead of joint matrices when skinning meshes.
+        /// The joint palette is then half the size, and skinned meshes do not suffer from
+        /// the candy-wrapper artifact, but joint scaling is not supported.
+        /// Dual quaternion skinning requires UseStructuredBuffers.
+        /// Use SKINNING_PALETTE_FORMAT_DUAL_QUATERNION format with SkinningPaletteJob to compute
+        /// dual quaternions on worker threads, otherwise they are computed by Render().
+        bool UseDualQuaternionSkinning = false;
+
+        /// Whether to create pipeline states for instanced rendering (see RenderInstanced()).
+        /// Instancing is not available when UseStructuredBuffers is enabled.
+        bool AllowInstancing = false;
+
         /// When set to true, pipeline state will be compiled with immutable samplers.
         /// When set to false, samplers from the texture views will be used.
         bool UseImmutableSamplers = true;
@@ -169,6 +207,102 @@ public:
 
         /// White point value used by tone mapping
         float WhitePoint = 3.f;
+
+        /// Camera position in world space, used to select mesh levels of detail.
+        float3 CameraPosition;
+
+        /// Normalized world-space direction the camera looks at. Alpha-blended primitives are sorted
+        /// by their view-space depth along this direction. When it is zero, they are sorted by the
+        /// distance to CameraPosition.
+        float3 CameraViewDir;
+
+        /// Vertical scale of the projection matrix (element [1][1]), used to compute
+        /// the screen-space size of meshes. When zero, LOD selection is disabled
+        /// and the full-detail meshes are rendered.
+        float ProjScale = 0;
+
+        /// Maximum screen-space simplification error of the selected LOD, as a fraction
+        /// of the viewport height.
+        float LODErrorThreshold = 1.f / 512.f;
+
+        /// Relative hysteresis of the LOD selection. A coarser LOD is only selected when its
+        /// screen-space error is less than LODErrorThreshold * (1 - LODHysteresis), which
+        /// prevents LODs from flickering when the camera moves near the transition distance.
+        float LODHysteresis = 0.25f;
+
+        /// Application-defined identifier of the view the model is rendered to, e.g. a camera or
+        /// a shadow map. Hysteresis is applied relative to the levels of detail that were last selected
+        /// for the same model and view, so models rendered to different views should use different identifiers.
+        Uint32 ViewId = 0;
+
+        /// Whether to skip primitives that are outside of the view frustum.
+        bool FrustumCulling = false;
+
+        /// View frustum in world space used for frustum culling, see ExtractViewFrustumPlanesFromMatrix().
+        ViewFrustum Frustum;
+
+        /// Viewport height in pixels, used for small-object culling.
+        float ViewportHeight = 0;
+
+        /// Primitives whose projected bounding sphere diameter is smaller than this number
+        /// of pixels are not rendered. Small-object culling requires ProjScale and ViewportHeight
+        /// to be set, and is disabled when this value is zero.
+        float MinPixelSize = 0;
+    };
+
+    /// Culling statistics
+    struct CullingStatistics
+    {
+        /// The number of primitives that were tested
+        Uint32 NumPrimitives = 0;
+
+        /// The number of primitives culled by the view frustum
+        Uint32 NumFrustumCulled = 0;
+
+        /// The number of primitives culled because their projected size is too small
+        Uint32 NumSmallCulled = 0;
+
+        /// The number of nodes whose whole subtree was culled by the view frustum
+        Uint32 NumSubtreesCulled = 0;
+    };
+
+    /// Model rendering request for RenderParallel()
+    struct ParallelRenderItem
+    {
+        /// GLTF model to render
+        GLTF::Model* pModel = nullptr;
+
+        /// Render parameters of the model
+        RenderInfo RenderParams;
+
+        /// Optional application-defined SRB type that was given to CreateMaterialSRB
+        size_t SRBTypeId = 0;
+    };
+
+    /// Attributes of RenderParallel()
+    struct ParallelRenderAttribs
+    {
+        /// Deferred contexts to record commands to. Every context records one chunk of draw calls on a thread pool thread.
+        IDeviceContext* const* ppDeferredContexts = nullptr;
+
+        /// The number of deferred contexts in ppDeferredContexts array.
+        Uint32 NumDeferredContexts = 0;
+
+        /// The number of render targets to bind in every deferred context.
+        Uint32 NumRenderTargets = 0;
+
+        /// Render target views to bind in every deferred context.
+        ITextureView** ppRTVs = nullptr;
+
+        /// Depth-stencil view to bind in every deferred context.
+        ITextureView* pDSV = nullptr;
+
+        /// Minimum number of draw calls recorded by a single context. Fewer deferred contexts are
+        /// used when there are not enough draw calls to keep all of them busy.
+        Uint32 MinDrawsPerChunk = 256;
+
+        /// Thread pool that records the chunks. If null, ThreadPool::GetShared() is used.
+        ThreadPool* pThreadPool = nullptr;
     };
 
     /// GLTF node rendering info passed to the custom render callback
@@ -180,6 +314,10 @@ public:
         /// GLTF node shader transforms
         GLTFNodeShaderTransforms ShaderTransforms;
 
+        /// Position dequantization parameters of the compact vertex layout.
+        /// In the compact layout, they follow ShaderTransforms in the transforms constant buffer.
+        GLTFNodePositionDequantization PositionDequantization;
+
         /// GLTF material shader information
         GLTFMaterialShaderInfo MaterialShaderInfo;
 
@@ -196,6 +334,9 @@ public:
         /// First index for indexed primitives
         Uint32 FirstIndex = 0;
 
+        /// Base vertex for indexed primitives, or the first vertex for non-indexed ones
+        Uint32 BaseVertex = 0;
+
         GLTFNodeRenderInfo() noexcept :
             IndexCount{0}
         {}
@@ -216,6 +357,115 @@ public:
                 std::function<void(const GLTFNodeRenderInfo&)> RenderNodeCallback = nullptr,
                 size_t                                         SRBTypeId          = 0);
 
+    /// Renders multiple instances of the given GLTF model.
+
+    /// \param [in] pCtx                - Device context to record rendering commands to.
+    /// \param [in] GLTFModel           - GLTF model to render.
+    /// \param [in] RenderParams        - Render parameters. RenderParams.ModelTransform is applied
+    ///                                   before the instance transform.
+    /// \param [in] pInstanceTransforms - Array of NumInstances world transform matrices, one for every instance.
+    /// \param [in] NumInstances        - Number of instances to render.
+    /// \param [in] SRBTypeId           - Optional application-defined SRB type that was given to
+    ///                                   CreateMaterialSRB.
+    ///
+    /// \remarks   Every primitive of the model is rendered with a single instanced draw call.
+    ///            Levels of detail are selected for the instance that is closest to the camera.
+    ///            The renderer must be created with CreateInfo::AllowInstancing set to true.
+    void RenderInstanced(IDeviceContext*   pCtx,
+                         GLTF::Model&      GLTFModel,
+                         const RenderInfo& RenderParams,
+                         const float4x4*   pInstanceTransforms,
+                         Uint32            NumInstances,
+                         size_t            SRBTypeId = 0);
+
+    /// Uploads draw data of a static GLTF model to GPU buffers for RenderIndirect().
+
+    /// \param [in] pCtx           - Device context used to initialize the buffers.
+    /// \param [in] GLTFModel      - GLTF model. Resource bindings of the model must be initialized
+    ///                              with InitializeResourceBindings() before the call.
+    /// \param [in] ModelTransform - Model transform matrix. Node transforms are baked into the
+    ///                              buffers, so the model must not be animated after the call.
+    /// \param [in] SRBTypeId      - Optional application-defined SRB type that was given to
+    ///                              CreateMaterialSRB.
+    ///
+    /// \remarks   Only indexed opaque and alpha-masked primitives of meshes without skins are
+    ///            uploaded; render other primitives with Render(). The finest level of detail is used.
+    ///            Primitives that use the same pipeline state and SRB are grouped into buckets.
+    ///            The renderer must be created with CreateInfo::AllowIndirectDraws set to true.
+    void InitializeIndirectDraws(IDeviceContext*   pCtx,
+                                 const GLTF::Model& GLTFModel,
+                                 const float4x4&    ModelTransform,
+                                 size_t             SRBTypeId = 0);
+
+    /// Releases draw data of the model created by InitializeIndirectDraws().
+    void ReleaseIndirectDraws(const GLTF::Model& GLTFModel);
+
+    /// Renders the static GLTF model using GPU-driven indirect draws.
+
+    /// \param [in] pCtx         - Device context to record rendering commands to.
+    /// \param [in] GLTFModel    - GLTF model initialized with InitializeIndirectDraws().
+    /// \param [in] RenderParams - Render parameters. RenderParams.ModelTransform is ignored, the
+    ///                            transform given to InitializeIndirectDraws() is used instead.
+    ///                            When RenderParams.FrustumCulling is true, primitives are culled
+    ///                            against RenderParams.Frustum on the GPU.
+    ///
+    /// \remarks   A compute pass culls all primitives and appends DrawIndexedIndirect arguments of
+    ///            visible ones to their buckets. Every bucket is then rendered with one pipeline state
+    ///            and SRB change. Since multi-draw indirect is not available, one indirect draw command
+    ///            is still issued for every uploaded primitive, and the arguments of the unused slots
+    ///            of the bucket are zero, so the number of draw commands does not depend on visibility.
+    ///            Levels of detail are not selected and small-object culling is not performed.
+    void RenderIndirect(IDeviceContext*    pCtx,
+                        const GLTF::Model& GLTFModel,
+                        const RenderInfo&  RenderParams);
+
+    /// Renders the given GLTF models using multiple threads.
+
+    /// \param [in] pCtx     - Immediate device context.
+    /// \param [in] pItems   - Array of NumItems models to render.
+    /// \param [in] NumItems - Number of models to render.
+    /// \param [in] Attribs  - Parallel rendering attributes.
+    ///
+    /// \remarks   Opaque, masked and back-to-front sorted alpha-blended primitives of all models are
+    ///            split into contiguous chunks that are recorded by the thread pool. The first chunk is
+    ///            recorded into pCtx, and every other chunk is recorded into a deferred context.
+    ///            The call returns when all chunks are recorded.
+    ///            Command lists are then executed in order, so the result is the same as if all models
+    ///            were rendered by Render().
+    ///
+    ///            All resources must be transitioned to the required states before the call, as deferred
+    ///            contexts only verify the states. Executing command lists resets the state of the
+    ///            immediate context, so render targets must be bound again after the call.
+    ///            The application must call IDeviceContext::FinishFrame() for every deferred context
+    ///            once per frame after the command lists have been executed.
+    ///
+    ///            Parallel rendering is not available when CreateInfo::UseStructuredBuffers is enabled.
+    void RenderParallel(IDeviceContext*              pCtx,
+                        const ParallelRenderItem*    pItems,
+                        Uint32                       NumItems,
+                        const ParallelRenderAttribs& Attribs);
+
+    /// Queues alpha-blended primitives of the given model to be rendered by RenderTransparentPrimitives().
+
+    /// \param [in] GLTFModel    - GLTF model whose alpha-blended primitives to queue. The model must
+    ///                            stay alive until RenderTransparentPrimitives() is called.
+    /// \param [in] RenderParams - Render parameters. RenderParams.CameraPosition and RenderParams.CameraViewDir
+    ///                            are used to compute the view-space depth of the primitives.
+    /// \param [in] SRBTypeId    - Optional application-defined SRB type that was given to
+    ///                            CreateMaterialSRB.
+    ///
+    /// \remarks   Render() sorts transparent primitives of a single model only. To render transparent
+    ///            primitives of all models in a frame in the correct order, render opaque and masked
+    ///            primitives with Render(), queue every model with this method and call
+    ///            RenderTransparentPrimitives() after all opaque geometry.
+    ///            Queueing is not available when CreateInfo::UseStructuredBuffers is enabled.
+    void QueueTransparentPrimitives(GLTF::Model&      GLTFModel,
+                                    const RenderInfo& RenderParams,
+                                    size_t            SRBTypeId = 0);
+
+    /// Sorts all queued transparent primitives back to front, renders them and clears the queue.
+    void RenderTransparentPrimitives(IDeviceContext* pCtx);
+
     /// Initializes resource bindings for a given GLTF model
     void InitializeResourceBindings(GLTF::Model&               GLTFModel,
                                     IBuffer*                   pCameraAttribs,
@@ -224,10 +474,27 @@ public:
     /// Releases resource bindings for a given GLTF model and SRB type
     void ReleaseResourceBindings(GLTF::Model& GLTFModel, size_t SRBTypeId = 0);
 
+    /// Returns culling statistics accumulated since the last call to ResetCullingStatistics().
+    const CullingStatistics& GetCullingStatistics() const { return m_CullingStats; }
+
+    /// Resets culling statistics, e.g. at the beginning of the frame.
+    void ResetCullingStatistics() { m_CullingStats = CullingStatistics{}; }
+
     /// Precompute cubemaps used by IBL.
+
+    /// \param [in] pDevice            - Render device.
+    /// \param [in] pCtx               - Device context used to render the cube maps.
+    /// \param [in] pEnvironmentMap    - Environment map.
+    /// \param [in] EnvironmentMapHash - Optional hash of the environment map contents, e.g. the hash
+    ///                                  of the file it was loaded from.
+    ///
+    /// \remarks   When CreateInfo::IBLCacheDirectory is set and EnvironmentMapHash is not zero, the cube
+    ///            maps are loaded from the cache if they were computed for the same environment map, format
+    ///            and sample counts before. Otherwise, the cube maps are computed and written to the cache.
     void PrecomputeCubemaps(IRenderDevice*  pDevice,
                             IDeviceContext* pCtx,
-                            ITextureView*   pEnvironmentMap);
+                            ITextureView*   pEnvironmentMap,
+                            size_t          EnvironmentMapHash = 0);
 
     // clang-format off
     ITextureView* GetIrradianceCubeSRV()    { return m_pIrradianceCubeSRV; }
@@ -250,6 +517,11 @@ public:
     ///                              An application may use this type to differentiate e.g. shadow-pass SRBs
     ///                              from color-pass SRBs.
     /// \return                      Created shader resource binding.
+    ///
+    /// \remarks   Materials that reference the same textures, samplers, buffers and PSO share
+    ///            one SRB, which is released when the last material that uses it is released
+    ///            by ReleaseResourceBindings(). The returned SRB must therefore not be modified
+    ///            for a single material.
     IShaderResourceBinding* CreateMaterialSRB(GLTF::Material& Material,
                                               IBuffer*        pCameraAttribs,
                                               IBuffer*        pLightAttribs,
@@ -264,37 +536,148 @@ public:
     IShaderResourceBinding* GetMaterialSRB(const GLTF::Material* material, size_t TypeId = 0)
     {
         auto it = m_SRBCache.find(SRBCacheKey{material, TypeId});
-        return it != m_SRBCache.end() ? it->second.RawPtr() : nullptr;
+        return it != m_SRBCache.end() ? it->second.pSRB.RawPtr() : nullptr;
     }
 
 private:
     void PrecomputeBRDF(IRenderDevice*  pDevice,
                         IDeviceContext* pCtx);
 
-    void CreatePSO(IRenderDevice* pDevice);
+    void CreatePSO(IRenderDevice* pDevice, bool Instanced);
+
+    std::string GetIBLCachePath(ITextureView* pEnvironmentMap, size_t EnvironmentMapHash, const char* Suffix) const;
+
+    bool CheckVertexLayout(const GLTF::Model& GLTFModel) const;
+
+    void BindModelBuffers(IDeviceContext* pCtx, const GLTF::Model& GLTFModel);
+
+    // Visibility and level of detail of a primitive in one submission of a model.
+    // The model itself is never modified, so it can be submitted several times in a frame.
+    struct PrimitiveSelection
+    {
+        Uint8 LOD       = 0;
+        bool  IsVisible = true;
+    };
+
+    void RenderAlphaModes(IDeviceContext*                                       pCtx,
+                          const GLTF::Model&                                    GLTFModel,
+                          const PrimitiveSelection*                             pSelection,
+                          const RenderInfo&                                     RenderParams,
+                          const std::function<void(const GLTFNodeRenderInfo&)>& RenderNodeCallback,
+                          size_t                                                SRBTypeId,
+                          Uint32                                                NumInstances);
+
+    // Culls primitives of the model and selects their levels of detail. Returns the selection of
+    // every primitive indexed by GLTF::Primitive::Index, which is valid until the next call.
+    const PrimitiveSelection* CullAndSelectLODs(const GLTF::Model& GLTFModel, const RenderInfo& RenderParams);
 
-    void RenderGLTFNode(IDeviceContext*                                pCtx,
-                        const GLTF::Node*                              node,
-                        GLTF::Material::ALPHA_MODE                     AlphaMode,
-                        const float4x4&                                ModelTransform,
-                        std::function<void(const GLTFNodeRenderInfo&)> RenderNodeCallback,
-                        size_t                                         SRBTypeId);
+    void CullNodeSubtree(const GLTF::Node& Node, const ViewFrustum& ModelFrustum, bool IsFullyVisible, PrimitiveSelection* pSelection);
+
+    static void SetSubtreeVisibility(const GLTF::Node& Node, bool IsVisible, PrimitiveSelection* pSelection);
+
+    void RenderWithStructuredBuffers(IDeviceContext*           pCtx,
+                                     const GLTF::Model&        GLTFModel,
+                                     const PrimitiveSelection* pSelection,
+                                     const RenderInfo&         RenderParams,
+                                     size_t                    SRBTypeId);
+
+    void CreateStructuredBuffers(IRenderDevice* pDevice);
+    void CreateIndirectDrawResources(IRenderDevice* pDevice);
+    bool ReserveStructuredBuffer(RefCntAutoPtr<IBuffer>& pBuffer, Uint32 RequiredSize);
+    void BindStructuredBuffers(IShaderResourceBinding* pSRB);
+
+    void WriteRenderParameters(const RenderInfo& Info, GLTFRendererShaderParameters& RenderParams);
+
+    static void WriteMaterialShaderInfo(const GLTF::Material& Material, GLTFMaterialShaderInfo& MaterialInfo);
+
+    struct TransparentPrimitiveQueue
+    {
+        struct Submission
+        {
+            const GLTF::Model* pModel = nullptr;
+            RenderInfo         RenderParams;
+            size_t             SRBTypeId = 0;
+        };
+
+        struct Item
+        {
+            const GLTF::Node*      pNode        = nullptr;
+            const GLTF::Primitive* pPrimitive   = nullptr;
+            Uint32                 SubmissionId = 0;
+
+            // Level of detail selected for the submission
+            Uint32 LOD = 0;
+
+            // Levels of detail do not affect the sort order and are not compared
+            bool operator==(const Item& RHS) const
+            {
+                return pNode == RHS.pNode && pPrimitive == RHS.pPrimitive && SubmissionId == RHS.SubmissionId;
+            }
+        };
+
+        std::vector<Submission> Submissions;
+        std::vector<Item>       Items;
+        // Back-to-front order of the items
+        std::vector<Uint32> Order;
+
+        // Key cache: when the same items are sorted again and the previous order is still
+        // consistent with the new keys, the sort is skipped.
+        std::vector<Item>   PrevItems;
+        std::vector<Uint32> PrevOrder;
+    };
+
+    void AddTransparentPrimitives(TransparentPrimitiveQueue& Queue,
+                                  const GLTF::Model&         GLTFModel,
+                                  const PrimitiveSelection*  pSelection,
+                                  const RenderInfo&          RenderParams,
+                                  size_t                     SRBTypeId);
+
+    void SortTransparentPrimitives(TransparentPrimitiveQueue& Queue);
+
+    void RenderTransparentPrimitives(IDeviceContext*                                       pCtx,
+                                     TransparentPrimitiveQueue&                            Queue,
+                                     const GLTF::Model*                                    pBoundModel,
+                                     const std::function<void(const GLTFNodeRenderInfo&)>& RenderNodeCallback);
+
+    void RenderParallelChunk(IDeviceContext* pCtx, size_t FirstDraw, size_t EndDraw);
+
+    void RenderPrimitive(IDeviceContext*                                       pCtx,
+                         const GLTF::Node*                                     node,
+                         const GLTF::Primitive*                                primitive,
+                         Uint32                                                LOD,
+                         VALUE_TYPE                                            IndexType,
+                         const RenderInfo&                                     RenderParams,
+                         const std::function<void(const GLTFNodeRenderInfo&)>& RenderNodeCallback,
+                         size_t                                                SRBTypeId,
+                         Uint32                                                NumInstances);
+
+    void RenderGLTFNode(IDeviceContext*                                       pCtx,
+                        const GLTF::Node*                                     node,
+                        const PrimitiveSelection*                             pSelection,
+                        GLTF::Material::ALPHA_MODE                            AlphaMode,
+                        VALUE_TYPE                                            IndexType,
+                        const RenderInfo&                                     RenderParams,
+                        const std::function<void(const GLTFNodeRenderInfo&)>& RenderNodeCallback,
+                        size_t                                                SRBTypeId,
+                        Uint32                                                NumInstances);
 
     struct PSOKey
     {
         PSOKey() noexcept {};
-        PSOKey(GLTF::Material::ALPHA_MODE _AlphaMode, bool _DoubleSided) :
+        PSOKey(GLTF::Material::ALPHA_MODE _AlphaMode, bool _DoubleSided, bool _Instanced = false) :
             AlphaMode{_AlphaMode},
-            DoubleSided{_DoubleSided}
+            DoubleSided{_DoubleSided},
+            Instanced{_Instanced}
         {}
 
         GLTF::Material::ALPHA_MODE AlphaMode   = GLTF::Material::ALPHAMODE_OPAQUE;
         bool                       DoubleSided = false;
+        bool                       Instanced   = false;
     };
 
     static size_t GetPSOIdx(const PSOKey& Key)
     {
-        return (Key.AlphaMode == GLTF::Material::ALPHAMODE_BLEND ? 1 : 0) + (Key.DoubleSided ? 2 : 0);
+        return (Key.AlphaMode == GLTF::Material::ALPHAMODE_BLEND ? 1 : 0) + (Key.DoubleSided ? 2 : 0) + (Key.Instanced ? 4 : 0);
     }
 
     void AddPSO(const PSOKey& Key, RefCntAutoPtr<IPipelineState> pPSO)
@@ -315,7 +698,6 @@ private:
 
     const CreateInfo m_Settings;
 
-    static constexpr Uint32     BRDF_LUT_Dim = 512;
     RefCntAutoPtr<ITextureView> m_pBRDF_LUT_SRV;
 
     std::vector<RefCntAutoPtr<IPipelineState>> m_PSOCache;
@@ -351,13 +733,78 @@ private:
             }
         };
     };
-    std::unordered_map<SRBCacheKey, RefCntAutoPtr<IShaderResourceBinding>, SRBCacheKey::Hasher> m_SRBCache;
+
+    // Resources referenced by a material SRB. Materials with equal keys share one SRB.
+    struct SharedSRBKey
+    {
+        enum TEXTURE_ID
+        {
+            TEXTURE_COLOR = 0,
+            TEXTURE_PHYS_DESC,
+            TEXTURE_NORMAL,
+            TEXTURE_AO,
+            TEXTURE_EMISSIVE,
+            TEXTURE_COUNT
+        };
+
+        IPipelineState*                          pPSO           = nullptr;
+        IBuffer*                                 pCameraAttribs = nullptr;
+        IBuffer*                                 pLightAttribs  = nullptr;
+        std::array<ITextureView*, TEXTURE_COUNT> TextureSRVs    = {};
+        std::array<ISampler*, TEXTURE_COUNT>     Samplers       = {};
+        size_t                                   TypeId         = 0;
+
+        bool operator==(const SharedSRBKey& Key) const
+        {
+            return pPSO == Key.pPSO &&
+                pCameraAttribs == Key.pCameraAttribs &&
+                pLightAttribs == Key.pLightAttribs &&
+                TextureSRVs == Key.TextureSRVs &&
+                Samplers == Key.Samplers &&
+                TypeId == Key.TypeId;
+        }
+
+        struct Hasher
+        {
+            size_t operator()(const SharedSRBKey& Key) const
+            {
+                auto Hash = ComputeHash(Key.pPSO, Key.pCameraAttribs, Key.pLightAttribs, Key.TypeId);
+                for (size_t i = 0; i < TEXTURE_COUNT; ++i)
+                    HashCombine(Hash, Key.TextureSRVs[i], Key.Samplers[i]);
+                return Hash;
+            }
+        };
+    };
+
+    struct SharedSRB
+    {
+        RefCntAutoPtr<IShaderResourceBinding> pSRB;
+
+        // The number of materials that use this SRB
+        Uint32 RefCount = 0;
+    };
+    std::unordered_map<SharedSRBKey, SharedSRB, SharedSRBKey::Hasher> m_SharedSRBs;
+
+    struct MaterialSRB
+    {
+        RefCntAutoPtr<IShaderResourceBinding> pSRB;
+        SharedSRBKey                          SharedKey;
+    };
+    std::unordered_map<SRBCacheKey, MaterialSRB, SRBCacheKey::Hasher> m_SRBCache;
+
+    void ReleaseSharedSRB(const SharedSRBKey& SharedKey);
 
     static constexpr TEXTURE_FORMAT IrradianceCubeFmt    = TEX_FORMAT_RGBA32_FLOAT;
     static constexpr TEXTURE_FORMAT PrefilteredEnvMapFmt = TEX_FORMAT_RGBA16_FLOAT;
     static constexpr Uint32         IrradianceCubeDim    = 64;
     static constexpr Uint32         PrefilteredEnvMapDim = 256;
 
+    static constexpr Uint32 IrradianceNumPhiSamples   = 64;
+    static constexpr Uint32 IrradianceNumThetaSamples = 32;
+    static constexpr Uint32 PrefilterNumSamples       = 256;
+
+    const std::string m_IBLCacheDirectory;
+
     RefCntAutoPtr<ITextureView>           m_pIrradianceCubeSRV;
     RefCntAutoPtr<ITextureView>           m_pPrefilteredEnvMapSRV;
     RefCntAutoPtr<IPipelineState>         m_pPrecomputeIrradianceCubePSO;
@@ -365,12 +812,127 @@ private:
     RefCntAutoPtr<IShaderResourceBinding> m_pPrecomputeIrradianceCubeSRB;
     RefCntAutoPtr<IShaderResourceBinding> m_pPrefilterEnvMapSRB;
 
-    RenderInfo                 m_RenderParams;
+    CullingStatistics          m_CullingStats;
+
+    // Selection of every primitive of the model that is currently being submitted
+    std::vector<PrimitiveSelection> m_PrimitiveSelection;
+
+    // Levels of detail last selected for a model and view, used to apply hysteresis
+    struct LODHistoryKey
+    {
+        const GLTF::Model* pModel = nullptr;
+        Uint32             ViewId = 0;
+
+        LODHistoryKey() = default;
+
+        LODHistoryKey(const GLTF::Model* _pModel,
+                      Uint32             _ViewId) :
+            pModel{_pModel},
+            ViewId{_ViewId}
+        {}
+
+        bool operator==(const LODHistoryKey& Key) const
+        {
+            return pModel == Key.pModel && ViewId == Key.ViewId;
+        }
+
+        struct Hasher
+        {
+            size_t operator()(const LODHistoryKey& Key) const
+            {
+                return ComputeHash(Key.pModel, Key.ViewId);
+            }
+        };
+    };
+    std::unordered_map<LODHistoryKey, std::vector<Uint8>, LODHistoryKey::Hasher> m_LODHistory;
+
     RefCntAutoPtr<IRenderPass> m_pRenderPass;
 
     RefCntAutoPtr<IBuffer> m_TransformsCB;
     RefCntAutoPtr<IBuffer> m_GLTFAttribsCB;
     RefCntAutoPtr<IBuffer> m_PrecomputeEnvMapAttribsCB;
+
+    // Per-instance world matrices used by RenderInstanced()
+    RefCntAutoPtr<IBuffer> m_InstanceTransformsBuffer;
+
+    // Resources used when CreateInfo::UseStructuredBuffers is enabled
+    RefCntAutoPtr<IRenderDevice> m_pDevice;
+    RefCntAutoPtr<IBuffer>       m_NodeTransformsBuffer;
+    RefCntAutoPtr<IBuffer>       m_JointMatricesBuffer;
+    RefCntAutoPtr<IBuffer>       m_MaterialsBuffer;
+    RefCntAutoPtr<IBuffer>       m_DrawRecordsBuffer;
+
+    struct DrawItem
+    {
+        const GLTF::Primitive*  pPrimitive  = nullptr;
+        IShaderResourceBinding* pSRB        = nullptr;
+        Uint32                  TransformId = 0;
+        Uint32                  MaterialId  = 0;
+        Uint32                  LOD         = 0;
+    };
+    std::vector<GLTFNodeShaderTransformRecord> m_NodeTransformRecords;
+    std::vector<float4>                        m_JointMatrices; // Joint palette, matrix rows or dual quaternions
+    std::vector<GLTFMaterialShaderInfo>        m_MaterialInfos;
+    std::vector<uint2>                         m_DrawRecords;
+    std::vector<DrawItem>                      m_DrawItems;
+    std::vector<DrawItem>                      m_TmpDrawItems;
+
+    // Contents of the structured buffers as of the last update, used to skip
+    // uploading records that have not changed since the previous Render() call
+    std::vector<Uint8> m_UploadedNodeTransforms;
+    std::vector<Uint8> m_UploadedJointMatrices;
+    std::vector<Uint8> m_UploadedMaterials;
+    std::vector<Uint8> m_UploadedDrawRecords;
+
+    // GPU-resident draw data of a model rendered with RenderIndirect()
+    struct IndirectModelData
+    {
+        // All draws in a bucket use the same pipeline state and SRB
+        struct Bucket
+        {
+            IPipelineState*                       pPSO = nullptr;
+            RefCntAutoPtr<IShaderResourceBinding> pSRB;
+
+            // Range of the bucket's argument slots in the draw arguments buffer
+            Uint32 FirstArg = 0;
+            Uint32 NumArgs  = 0;
+        };
+        std::vector<Bucket> Buckets;
+
+        Uint32 NumDraws = 0;
+
+        RefCntAutoPtr<IBuffer> pNodeTransforms;
+        RefCntAutoPtr<IBuffer> pMaterials;
+        RefCntAutoPtr<IBuffer> pDrawRecords;
+        RefCntAutoPtr<IBuffer> pIndirectDraws;
+        // Initial values of the bucket counters, i.e. the first argument slot of every bucket
+        RefCntAutoPtr<IBuffer> pInitialCounters;
+        RefCntAutoPtr<IBuffer> pBucketCounters;
+        RefCntAutoPtr<IBuffer> pDrawArgs;
+        // Zeroes copied to the draw arguments buffer before culling to clear unused slots
+        RefCntAutoPtr<IBuffer> pZeroArgs;
+
+        RefCntAutoPtr<IShaderResourceBinding> pCullSRB;
+    };
+    std::unordered_map<const GLTF::Model*, IndirectModelData> m_IndirectModels;
+
+    RefCntAutoPtr<IPipelineState> m_pCullIndirectDrawsPSO;
+    RefCntAutoPtr<IBuffer>        m_IndirectCullingAttribsCB;
+
+    TransparentPrimitiveQueue m_TransparentQueue;
+    TransparentPrimitiveQueue m_ModelTransparentQueue;
+    TransparentPrimitiveQueue m_ParallelTransparentQueue;
+
+    // Draw list of RenderParallel(): opaque and masked primitives followed by sorted
+    // alpha-blended primitives. Item.SubmissionId indexes m_ParallelSubmissions.
+    std::vector<TransparentPrimitiveQueue::Submission> m_ParallelSubmissions;
+    std::vector<TransparentPrimitiveQueue::Item>       m_ParallelDraws;
+
+    // Scratch arrays for depth sorting
+    std::vector<float>  m_SortDepths;
+    std::vector<Uint32> m_SortKeys;
+    std::vector<Uint32> m_SortTmpKeys;
+    std::vector<Uint32> m_SortTmpOrder;
 };
 
 DEFINE_FLAG_ENUM_OPERATORS(GLTF_PBR_Renderer::RenderInfo::ALPHA_MODE_FLAGS);
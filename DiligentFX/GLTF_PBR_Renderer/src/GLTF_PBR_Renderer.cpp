@@ -27,8 +27,12 @@
 
 #include <cstring>
 #include <array>
+#include <algorithm>
+#include <sstream>
+#include <iomanip>
 
 #include "GLTF_PBR_Renderer.hpp"
+#include "SkinningPalette.hpp"
 #include "../../../Utilities/include/DiligentFXShaderSourceStreamFactory.hpp"
 #include "CommonlyUsedStates.h"
 #include "HashUtils.hpp"
@@ -37,10 +41,163 @@
 #include "GraphicsUtilities.h"
 #include "MapHelper.hpp"
 #include "GraphicsAccessories.hpp"
+#include "RadixSort.hpp"
+#include "FileWrapper.hpp"
+#include "DataBlobImpl.hpp"
+#include "TextureUtilities.h"
+#include "IndirectDrawCulling.hpp"
+#include "ThreadPool.hpp"
 
 namespace Diligent
 {
 
+#include "GLTF_BRDF_LUT.h"
+
+namespace
+{
+
+// Returns the view-space depth of the center of the primitive's bounding box, or the distance
+// to the camera if the view direction is not known
+float GetPrimitiveViewDepth(const GLTF::Primitive& Primitive, const float4x4& NodeTransform, const float3& CameraPosition, const float3& CameraViewDir)
+{
+    const auto Center = Primitive.IsValidBB ? (Primitive.BB.Min + Primitive.BB.Max) * 0.5f : float3{};
+    const auto Offset = Center * NodeTransform - CameraPosition;
+    return CameraViewDir != float3{} ? dot(Offset, CameraViewDir) : length(Offset);
+}
+
+// Computes 32-bit keys so that ascending key order is back-to-front
+void ComputeBackToFrontSortKeys(const std::vector<float>& Depths, std::vector<Uint32>& Keys)
+{
+    Keys.resize(Depths.size());
+    for (size_t i = 0; i < Depths.size(); ++i)
+        Keys[i] = ~FloatToSortKey(Depths[i]);
+}
+
+// Reads back all subresources of the cube map and writes them to a KTX file
+bool WriteCubemapToFile(IRenderDevice* pDevice, IDeviceContext* pCtx, ITexture* pTexture, const char* FilePath)
+{
+    const auto& Desc = pTexture->GetDesc();
+
+    TextureDesc StagingDesc    = Desc;
+    StagingDesc.Name           = "IBL cache staging texture";
+    StagingDesc.Type           = RESOURCE_DIM_TEX_2D_ARRAY;
+    StagingDesc.Usage          = USAGE_STAGING;
+    StagingDesc.BindFlags      = BIND_NONE;
+    StagingDesc.CPUAccessFlags = CPU_ACCESS_READ;
+    RefCntAutoPtr<ITexture> pStagingTex;
+    pDevice->CreateTexture(StagingDesc, nullptr, &pStagingTex);
+    if (!pStagingTex)
+        return false;
+
+    for (Uint32 mip = 0; mip < Desc.MipLevels; ++mip)
+    {
+        for (Uint32 face = 0; face < Desc.ArraySize; ++face)
+        {
+            CopyTextureAttribs CopyAttribs{pTexture, RESOURCE_STATE_TRANSITION_MODE_TRANSITION, pStagingTex, RESOURCE_STATE_TRANSITION_MODE_TRANSITION};
+            CopyAttribs.SrcMipLevel = mip;
+            CopyAttribs.SrcSlice    = face;
+            CopyAttribs.DstMipLevel = mip;
+            CopyAttribs.DstSlice    = face;
+            pCtx->CopyTexture(CopyAttribs);
+        }
+    }
+    pCtx->WaitForIdle();
+
+    // Subresources are ordered by array slice, then by mip level, as WriteTextureDataToKTX expects
+    std::vector<std::vector<Uint8>> SubresData(size_t{Desc.ArraySize} * Desc.MipLevels);
+    std::vector<TextureSubResData>  Subresources(SubresData.size());
+    for (Uint32 face = 0; face < Desc.ArraySize; ++face)
+    {
+        for (Uint32 mip = 0; mip < Desc.MipLevels; ++mip)
+        {
+            const auto MipInfo = GetMipLevelProperties(Desc, mip);
+            const auto Idx     = mip + face * Desc.MipLevels;
+
+            MappedTextureSubresource MappedData;
+            pCtx->MapTextureSubresource(pStagingTex, mip, face, MAP_READ, MAP_FLAG_DO_NOT_WAIT, nullptr, MappedData);
+            if (MappedData.pData == nullptr)
+                return false;
+
+            auto& Data = SubresData[Idx];
+            Data.resize(size_t{MipInfo.RowSize} * MipInfo.StorageHeight);
+            for (Uint32 row = 0; row < MipInfo.StorageHeight; ++row)
+                memcpy(&Data[size_t{row} * MipInfo.RowSize], reinterpret_cast<const Uint8*>(MappedData.pData) + size_t{row} * MappedData.Stride, MipInfo.RowSize);
+            pCtx->UnmapTextureSubresource(pStagingTex, mip, face);
+
+            Subresources[Idx].pData  = Data.data();
+            Subresources[Idx].Stride = MipInfo.RowSize;
+        }
+    }
+
+    RefCntAutoPtr<IDataBlob> pKTXData{MakeNewRCObj<DataBlobImpl>()(0)};
+    try
+    {
+        WriteTextureDataToKTX(Desc, TextureData{Subresources.data(), static_cast<Uint32>(Subresources.size())}, pKTXData);
+    }
+    catch (const std::exception&)
+    {
+        return false;
+    }
+
+    FileWrapper pFile(FilePath, EFileAccessMode::Overwrite);
+    if (!pFile || !pFile->Write(pKTXData->GetDataPtr(), pKTXData->GetSize()))
+    {
+        LOG_WARNING_MESSAGE("Failed to write IBL cache file '", FilePath, "'");
+        return false;
+    }
+
+    return true;
+}
+
+// Loads the cube map from the KTX file and copies it to the destination texture
+bool ReadCubemapKTX(IRenderDevice* pDevice, IDeviceContext* pCtx, ITexture* pDstTexture, const char* FilePath)
+{
+    if (!FileSystem::FileExists(FilePath))
+        return false;
+
+    RefCntAutoPtr<ITexture> pCachedTex;
+    try
+    {
+        CreateTextureFromFile(FilePath, TextureLoadInfo{"IBL cache texture"}, pDevice, &pCachedTex);
+    }
+    catch (const std::exception&)
+    {
+        pCachedTex.Release();
+    }
+    if (!pCachedTex)
+    {
+        LOG_WARNING_MESSAGE("Failed to load IBL cache file '", FilePath, "'");
+        return false;
+    }
+
+    const auto& CachedDesc = pCachedTex->GetDesc();
+    const auto& DstDesc    = pDstTexture->GetDesc();
+    if (CachedDesc.Type != RESOURCE_DIM_TEX_CUBE || CachedDesc.Format != DstDesc.Format ||
+        CachedDesc.Width != DstDesc.Width || CachedDesc.Height != DstDesc.Height ||
+        CachedDesc.MipLevels != DstDesc.MipLevels || CachedDesc.ArraySize != DstDesc.ArraySize)
+    {
+        LOG_WARNING_MESSAGE("IBL cache file '", FilePath, "' does not match the cube map description and will be ignored");
+        return false;
+    }
+
+    for (Uint32 mip = 0; mip < DstDesc.MipLevels; ++mip)
+    {
+        for (Uint32 face = 0; face < DstDesc.ArraySize; ++face)
+        {
+            CopyTextureAttribs CopyAttribs{pCachedTex, RESOURCE_STATE_TRANSITION_MODE_TRANSITION, pDstTexture, RESOURCE_STATE_TRANSITION_MODE_TRANSITION};
+            CopyAttribs.SrcMipLevel = mip;
+            CopyAttribs.SrcSlice    = face;
+            CopyAttribs.DstMipLevel = mip;
+            CopyAttribs.DstSlice    = face;
+            pCtx->CopyTexture(CopyAttribs);
+        }
+    }
+
+    return true;
+}
+
+} // namespace
+
 const SamplerDesc GLTF_PBR_Renderer::CreateInfo::DefaultSampler = Sam_LinearWrap;
 
 GLTF_PBR_Renderer::GLTF_PBR_Renderer(IRenderDevice*    pDevice,
@@ -48,6 +205,7 @@ GLTF_PBR_Renderer::GLTF_PBR_Renderer(IRenderDevice*    pDevice,
                                      const CreateInfo&           CI,
                                      RefCntAutoPtr<IRenderPass>& pRenderPass) :
     m_Settings{CI},
+    m_IBLCacheDirectory{CI.IBLCacheDirectory != nullptr ? CI.IBLCacheDirectory : ""},
     m_pRenderPass{pRenderPass}
 {
     if (m_Settings.UseIBL)
@@ -128,7 +286,9 @@ GLTF_PBR_Renderer::GLTF_PBR_Renderer(IRenderDevice*    pDevice,
 
     if (CI.RTVFmt != TEX_FORMAT_UNKNOWN || CI.DSVFmt != TEX_FORMAT_UNKNOWN)
     {
-        CreateUniformBuffer(pDevice, sizeof(GLTFNodeShaderTransforms), "GLTF node transforms CB", &m_TransformsCB);
+        // Position dequantization parameters follow the transforms only in the compact vertex layout
+        const Uint32 TransformsCBSize = sizeof(GLTFNodeShaderTransforms) + (CI.UseCompactVertexLayout ? sizeof(GLTFNodePositionDequantization) : 0);
+        CreateUniformBuffer(pDevice, TransformsCBSize, "GLTF node transforms CB", &m_TransformsCB);
         CreateUniformBuffer(pDevice, sizeof(GLTFMaterialShaderInfo) + sizeof(GLTFRendererShaderParameters), "GLTF attribs CB", &m_GLTFAttribsCB);
 
         // clang-format off
@@ -140,79 +300,60 @@ GLTF_PBR_Renderer::GLTF_PBR_Renderer(IRenderDevice*    pDevice,
         // clang-format on
         pCtx->TransitionResourceStates(_countof(Barriers), Barriers);
 
-        CreatePSO(pDevice);
+        if (m_Settings.UseStructuredBuffers || m_Settings.AllowInstancing)
+            m_pDevice = pDevice;
+
+        if (m_Settings.UseDualQuaternionSkinning && !m_Settings.UseStructuredBuffers)
+            LOG_WARNING_MESSAGE("Dual quaternion skinning requires structured buffers and will be disabled");
+
+        if (m_Settings.UseStructuredBuffers)
+            CreateStructuredBuffers(pDevice);
+
+        CreatePSO(pDevice, false);
+
+        if (m_Settings.AllowInstancing)
+        {
+            if (!m_Settings.UseStructuredBuffers)
+                CreatePSO(pDevice, true);
+            else
+                LOG_WARNING_MESSAGE("Instanced rendering is not available when structured buffers are used");
+        }
+
+        if (m_Settings.AllowIndirectDraws)
+        {
+            const auto& Features = pDevice->GetDeviceCaps().Features;
+            if (!m_Settings.UseStructuredBuffers)
+                LOG_WARNING_MESSAGE("Indirect rendering requires structured buffers");
+            else if (!Features.ComputeShaders || !Features.IndirectRendering)
+                LOG_WARNING_MESSAGE("Indirect rendering requires compute shaders and indirect rendering support");
+            else
+                CreateIndirectDrawResources(pDevice);
+        }
     }
 }
 
 void GLTF_PBR_Renderer::PrecomputeBRDF(IRenderDevice*  pDevice,
                                        IDeviceContext* pCtx)
 {
+    // The look-up table is generated offline by DiligentFX/BuildTools/BRDF_LUT/GenerateBRDF_LUT.cpp
+    static_assert(_countof(g_BRDF_LUT) == g_BRDF_LUT_Dim * g_BRDF_LUT_Dim * 2, "Unexpected BRDF LUT size");
+
     TextureDesc TexDesc;
     TexDesc.Name      = "GLTF BRDF Look-up texture";
     TexDesc.Type      = RESOURCE_DIM_TEX_2D;
-    TexDesc.Usage     = USAGE_DEFAULT;
-    TexDesc.BindFlags = BIND_SHADER_RESOURCE | BIND_RENDER_TARGET;
-    TexDesc.Width     = BRDF_LUT_Dim;
-    TexDesc.Height    = BRDF_LUT_Dim;
+    TexDesc.Usage     = USAGE_IMMUTABLE;
+    TexDesc.BindFlags = BIND_SHADER_RESOURCE;
+    TexDesc.Width     = g_BRDF_LUT_Dim;
+    TexDesc.Height    = g_BRDF_LUT_Dim;
     TexDesc.Format    = TEX_FORMAT_RG16_FLOAT;
     TexDesc.MipLevels = 1;
+
+    TextureSubResData       Level0Data{g_BRDF_LUT, g_BRDF_LUT_Dim * 2 * sizeof(g_BRDF_LUT[0])};
+    TextureData             InitData{&Level0Data, 1};
     RefCntAutoPtr<ITexture> pBRDF_LUT;
-    pDevice->CreateTexture(TexDesc, nullptr, &pBRDF_LUT);
+    pDevice->CreateTexture(TexDesc, &InitData, &pBRDF_LUT);
     m_pBRDF_LUT_SRV = pBRDF_LUT->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE);
 
-    RefCntAutoPtr<IPipelineState> PrecomputeBRDF_PSO;
-    {
-        GraphicsPipelineStateCreateInfo PSOCreateInfo;
-        PipelineStateDesc&              PSODesc          = PSOCreateInfo.PSODesc;
-        GraphicsPipelineDesc&           GraphicsPipeline = PSOCreateInfo.GraphicsPipeline;
-
-        PSODesc.Name         = "Precompute GLTF BRDF LUT PSO";
-        PSODesc.PipelineType = PIPELINE_TYPE_GRAPHICS;
-
-        GraphicsPipeline.pRenderPass  = m_pRenderPass;
-        GraphicsPipeline.SubpassIndex = 0; // This PSO will be used within the second subpass
-
-        GraphicsPipeline.NumRenderTargets             = 0;
-        GraphicsPipeline.RTVFormats[0]                = TexDesc.Format;
-        GraphicsPipeline.PrimitiveTopology            = PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
-        GraphicsPipeline.RasterizerDesc.CullMode      = CULL_MODE_NONE;
-        GraphicsPipeline.DepthStencilDesc.DepthEnable = True;
-
-        ShaderCreateInfo ShaderCI;
-        ShaderCI.SourceLanguage             = SHADER_SOURCE_LANGUAGE_HLSL;
-        ShaderCI.UseCombinedTextureSamplers = true;
-        ShaderCI.pShaderSourceStreamFactory = &DiligentFXShaderSourceStreamFactory::GetInstance();
-        RefCntAutoPtr<IShader> pVS;
-        {
-            ShaderCI.Desc.ShaderType = SHADER_TYPE_VERTEX;
-            ShaderCI.EntryPoint      = "FullScreenTriangleVS";
-            ShaderCI.Desc.Name       = "Full screen triangle VS";
-            ShaderCI.FilePath        = "FullScreenTriangleVS.fx";
-            pDevice->CreateShader(ShaderCI, &pVS);
-        }
-
-        // Create pixel shader
-        RefCntAutoPtr<IShader> pPS;
-        {
-            ShaderCI.Desc.ShaderType = SHADER_TYPE_PIXEL;
-            ShaderCI.EntryPoint      = "PrecomputeBRDF_PS";
-            ShaderCI.Desc.Name       = "Precompute GLTF BRDF PS";
-            ShaderCI.FilePath        = "PrecomputeGLTF_BRDF.psh";
-            pDevice->CreateShader(ShaderCI, &pPS);
-        }
-
-        // Finally, create the pipeline state
-        PSOCreateInfo.pVS = pVS;
-        PSOCreateInfo.pPS = pPS;
-        pDevice->CreateGraphicsPipelineState(PSOCreateInfo, &PrecomputeBRDF_PSO);
-    }
-    pCtx->SetPipelineState(PrecomputeBRDF_PSO);
-
-    ITextureView* pRTVs[] = {pBRDF_LUT->GetDefaultView(TEXTURE_VIEW_RENDER_TARGET)};
-    pCtx->SetRenderTargets(1, pRTVs, nullptr, RESOURCE_STATE_TRANSITION_MODE_VERIFY);
-    DrawAttribs attrs(4, DRAW_FLAG_VERIFY_ALL);
-    pCtx->Draw(attrs);
-
     // clang-format off
     StateTransitionDesc Barriers[] =
     {
@@ -222,13 +363,13 @@ void GLTF_PBR_Renderer::PrecomputeBRDF(IRenderDevice*  pDevice,
     pCtx->TransitionResourceStates(_countof(Barriers), Barriers);
 }
 
-void GLTF_PBR_Renderer::CreatePSO(IRenderDevice* pDevice)
+void GLTF_PBR_Renderer::CreatePSO(IRenderDevice* pDevice, bool Instanced)
 {
     GraphicsPipelineStateCreateInfo PSOCreateInfo;
     PipelineStateDesc&              PSODesc          = PSOCreateInfo.PSODesc;
     GraphicsPipelineDesc&           GraphicsPipeline = PSOCreateInfo.GraphicsPipeline;
 
-    PSODesc.Name         = "Render GLTF PBR PSO";
+    PSODesc.Name         = Instanced ? "Render GLTF PBR instanced PSO" : "Render GLTF PBR PSO";
     PSODesc.PipelineType = PIPELINE_TYPE_GRAPHICS;
 
     GraphicsPipeline.pRenderPass  = m_pRenderPass;
@@ -254,6 +395,10 @@ void GLTF_PBR_Renderer::CreatePSO(IRenderDevice* pDevice)
     Macros.AddShaderMacro("GLTF_PBR_USE_IBL", m_Settings.UseIBL);
     Macros.AddShaderMacro("GLTF_PBR_USE_AO", m_Settings.UseAO);
     Macros.AddShaderMacro("GLTF_PBR_USE_EMISSIVE", m_Settings.UseEmissive);
+    Macros.AddShaderMacro("GLTF_PBR_COMPACT_VERTEX_LAYOUT", m_Settings.UseCompactVertexLayout);
+    Macros.AddShaderMacro("GLTF_PBR_USE_STRUCTURED_BUFFERS", m_Settings.UseStructuredBuffers);
+    Macros.AddShaderMacro("GLTF_PBR_USE_DUAL_QUATERNION_SKINNING", m_Settings.UseDualQuaternionSkinning);
+    Macros.AddShaderMacro("GLTF_PBR_USE_INSTANCING", Instanced);
     ShaderCI.Macros = Macros;
     RefCntAutoPtr<IShader> pVS;
     {
@@ -284,18 +429,58 @@ void GLTF_PBR_Renderer::CreatePSO(IRenderDevice* pDevice)
         {4, 1, 4, VT_FLOAT32},   //float4 Joint0  : ATTRIB4;
         {5, 1, 4, VT_FLOAT32}    //float4 Weight0 : ATTRIB5;
     };
+
+    LayoutElement CompactInputs[] =
+    {
+        {0, 0, 4, VT_UINT16,  True },  //float4 Pos     : ATTRIB0;
+        {1, 0, 2, VT_INT16,   True },  //float2 Normal  : ATTRIB1;
+        {2, 0, 2, VT_FLOAT16, False},  //float2 UV0     : ATTRIB2;
+        {3, 0, 2, VT_FLOAT16, False},  //float2 UV1     : ATTRIB3;
+        {4, 1, 4, VT_UINT16,  False},  //uint4  Joint0  : ATTRIB4;
+        {5, 1, 4, VT_UINT8,   True }   //float4 Weight0 : ATTRIB5;
+    };
     // clang-format on
-    PSOCreateInfo.GraphicsPipeline.InputLayout.LayoutElements = Inputs;
-    PSOCreateInfo.GraphicsPipeline.InputLayout.NumElements    = _countof(Inputs);
+    static_assert(_countof(Inputs) == _countof(CompactInputs), "Full and compact layouts are expected to have the same number of elements");
+    std::vector<LayoutElement> LayoutElems;
+    if (m_Settings.UseCompactVertexLayout)
+        LayoutElems.assign(std::begin(CompactInputs), std::end(CompactInputs));
+    else
+        LayoutElems.assign(std::begin(Inputs), std::end(Inputs));
+    if (m_Settings.UseStructuredBuffers)
+    {
+        // uint2 DrawRecord : ATTRIB6;
+        LayoutElems.emplace_back(6, 2, 2, VT_UINT32, False, LAYOUT_ELEMENT_AUTO_OFFSET, LAYOUT_ELEMENT_AUTO_STRIDE, INPUT_ELEMENT_FREQUENCY_PER_INSTANCE);
+    }
+    if (Instanced)
+    {
+        // float4 InstanceRow0..3 : ATTRIB7..ATTRIB10;
+        for (Uint32 row = 0; row < 4; ++row)
+            LayoutElems.emplace_back(7 + row, 3, 4, VT_FLOAT32, False, LAYOUT_ELEMENT_AUTO_OFFSET, LAYOUT_ELEMENT_AUTO_STRIDE, INPUT_ELEMENT_FREQUENCY_PER_INSTANCE);
+    }
+    PSOCreateInfo.GraphicsPipeline.InputLayout.LayoutElements = LayoutElems.data();
+    PSOCreateInfo.GraphicsPipeline.InputLayout.NumElements    = static_cast<Uint32>(LayoutElems.size());
 
     PSODesc.ResourceLayout.DefaultVariableType = SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE;
     // clang-format off
     std::vector<ShaderResourceVariableDesc> Vars = 
     {
-        {SHADER_TYPE_VERTEX, "cbTransforms",  SHADER_RESOURCE_VARIABLE_TYPE_STATIC},
         {SHADER_TYPE_PIXEL,  "cbGLTFAttribs", SHADER_RESOURCE_VARIABLE_TYPE_STATIC}
     };
     // clang-format on
+    if (m_Settings.UseStructuredBuffers)
+    {
+        // Structured buffers are recreated when they need to grow, so they are bound
+        // as dynamic variables that can be updated in existing SRBs.
+        // clang-format off
+        Vars.emplace_back(SHADER_TYPE_VERTEX, "g_NodeTransforms", SHADER_RESOURCE_VARIABLE_TYPE_DYNAMIC);
+        Vars.emplace_back(SHADER_TYPE_VERTEX, "g_JointMatrices",  SHADER_RESOURCE_VARIABLE_TYPE_DYNAMIC);
+        Vars.emplace_back(SHADER_TYPE_PIXEL,  "g_Materials",      SHADER_RESOURCE_VARIABLE_TYPE_DYNAMIC);
+        // clang-format on
+    }
+    else
+    {
+        Vars.emplace_back(SHADER_TYPE_VERTEX, "cbTransforms", SHADER_RESOURCE_VARIABLE_TYPE_STATIC);
+    }
 
     std::vector<ImmutableSamplerDesc> ImtblSamplers;
     // clang-format off
@@ -337,7 +522,7 @@ void GLTF_PBR_Renderer::CreatePSO(IRenderDevice* pDevice)
     PSOCreateInfo.pPS = pPS;
 
     {
-        PSOKey Key{GLTF::Material::ALPHAMODE_OPAQUE, false};
+        PSOKey Key{GLTF::Material::ALPHAMODE_OPAQUE, false, Instanced};
 
         RefCntAutoPtr<IPipelineState> pSingleSidedOpaquePSO;
         pDevice->CreateGraphicsPipelineState(PSOCreateInfo, &pSingleSidedOpaquePSO);
@@ -364,7 +549,7 @@ void GLTF_PBR_Renderer::CreatePSO(IRenderDevice* pDevice)
     RT0.BlendOpAlpha   = BLEND_OPERATION_ADD;
 
     {
-        PSOKey Key{GLTF::Material::ALPHAMODE_BLEND, false};
+        PSOKey Key{GLTF::Material::ALPHAMODE_BLEND, false, Instanced};
 
         RefCntAutoPtr<IPipelineState> pSingleSidedBlendPSO;
         pDevice->CreateGraphicsPipelineState(PSOCreateInfo, &pSingleSidedBlendPSO);
@@ -381,14 +566,17 @@ void GLTF_PBR_Renderer::CreatePSO(IRenderDevice* pDevice)
 
     for (auto& PSO : m_PSOCache)
     {
+        if (!PSO)
+            continue;
         if (m_Settings.UseIBL)
         {
             PSO->GetStaticVariableByName(SHADER_TYPE_PIXEL, "g_BRDF_LUT")->Set(m_pBRDF_LUT_SRV);
         }
-        // clang-format off
-        PSO->GetStaticVariableByName(SHADER_TYPE_VERTEX, "cbTransforms")->Set(m_TransformsCB);
+        if (!m_Settings.UseStructuredBuffers)
+        {
+            PSO->GetStaticVariableByName(SHADER_TYPE_VERTEX, "cbTransforms")->Set(m_TransformsCB);
+        }
         PSO->GetStaticVariableByName(SHADER_TYPE_PIXEL, "cbGLTFAttribs")->Set(m_GLTFAttribsCB);
-        // clang-format on
     }
 }
 
@@ -401,40 +589,6 @@ IShaderResourceBinding* GLTF_PBR_Renderer::CreateMaterialSRB(GLTF::Material& Mat
     if (pPSO == nullptr)
         pPSO = GetPSO(PSOKey{});
 
-    RefCntAutoPtr<IShaderResourceBinding> pSRB;
-    pPSO->CreateShaderResourceBinding(&pSRB, true);
-
-    if (auto* pCameraAttribsVSVar = pSRB->GetVariableByName(SHADER_TYPE_VERTEX, "cbCameraAttribs"))
-        pCameraAttribsVSVar->Set(pCameraAttribs);
-
-    if (pCameraAttribs != nullptr)
-    {
-        if (auto* pCameraAttribsPSVar = pSRB->GetVariableByName(SHADER_TYPE_PIXEL, "cbCameraAttribs"))
-            pCameraAttribsPSVar->Set(pCameraAttribs);
-    }
-
-    if (pLightAttribs != nullptr)
-    {
-        if (auto* pLightAttribsPSVar = pSRB->GetVariableByName(SHADER_TYPE_PIXEL, "cbLightAttribs"))
-            pLightAttribsPSVar->Set(pLightAttribs);
-    }
-
-    if (m_Settings.UseIBL)
-    {
-        if (auto* pIrradianceMapPSVar = pSRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_IrradianceMap"))
-            pIrradianceMapPSVar->Set(m_pIrradianceCubeSRV);
-
-        if (auto* pPrefilteredEnvMap = pSRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_PrefilteredEnvMap"))
-            pPrefilteredEnvMap->Set(m_pPrefilteredEnvMapSRV);
-    }
-
-    auto SetTexture = [&](ITexture* pTexture, ITextureView* pDefaultTexSRV, const char* VarName) //
-    {
-        ITextureView* pTexSRV = pTexture != nullptr ? pTexture->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE) : pDefaultTexSRV;
-        if (auto* pVar = pSRB->GetVariableByName(SHADER_TYPE_PIXEL, VarName))
-            pVar->Set(pTexSRV);
-    };
-
     ITexture* pBaseColorTex = nullptr;
     ITexture* pPhysDescTex  = nullptr;
     if (Material.workflow == GLTF::Material::PbrWorkflow::MetallicRoughness)
@@ -448,40 +602,136 @@ IShaderResourceBinding* GLTF_PBR_Renderer::CreateMaterialSRB(GLTF::Material& Mat
         pPhysDescTex  = Material.extension.pSpecularGlossinessTexture;
     }
 
+    auto GetTextureSRV = [](ITexture* pTexture, ITextureView* pDefaultTexSRV) {
+        return pTexture != nullptr ? pTexture->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE) : pDefaultTexSRV;
+    };
+
+    // Materials that use the same resources share one SRB
+    SharedSRBKey SharedKey;
+    SharedKey.pPSO           = pPSO;
+    SharedKey.pCameraAttribs = pCameraAttribs;
+    SharedKey.pLightAttribs  = pLightAttribs;
+    SharedKey.TypeId         = TypeId;
     // clang-format off
-    SetTexture(pBaseColorTex,           m_pWhiteTexSRV,         "g_ColorMap");
-    SetTexture(pPhysDescTex ,           m_pWhiteTexSRV,         "g_PhysicalDescriptorMap");
-    SetTexture(Material.pNormalTexture, m_pDefaultNormalMapSRV, "g_NormalMap");
+    SharedKey.TextureSRVs[SharedSRBKey::TEXTURE_COLOR]     = GetTextureSRV(pBaseColorTex,              m_pWhiteTexSRV);
+    SharedKey.TextureSRVs[SharedSRBKey::TEXTURE_PHYS_DESC] = GetTextureSRV(pPhysDescTex,               m_pWhiteTexSRV);
+    SharedKey.TextureSRVs[SharedSRBKey::TEXTURE_NORMAL]    = GetTextureSRV(Material.pNormalTexture,    m_pDefaultNormalMapSRV);
+    SharedKey.TextureSRVs[SharedSRBKey::TEXTURE_AO]        = GetTextureSRV(Material.pOcclusionTexture, m_pWhiteTexSRV);
+    SharedKey.TextureSRVs[SharedSRBKey::TEXTURE_EMISSIVE]  = GetTextureSRV(Material.pEmissiveTexture,  m_pBlackTexSRV);
     // clang-format on
-    if (m_Settings.UseAO)
+    for (size_t i = 0; i < SharedKey.TextureSRVs.size(); ++i)
     {
-        SetTexture(Material.pOcclusionTexture, m_pWhiteTexSRV, "g_AOMap");
+        // Samplers are taken from the texture views when immutable samplers are not used
+        SharedKey.Samplers[i] = SharedKey.TextureSRVs[i]->GetSampler();
     }
-    if (m_Settings.UseEmissive)
+
+    const SRBCacheKey SRBKey{&Material, TypeId};
+
+    // Release the SRB that was previously created for this material
+    auto mat_it = m_SRBCache.find(SRBKey);
+    if (mat_it != m_SRBCache.end())
     {
-        SetTexture(Material.pEmissiveTexture, m_pBlackTexSRV, "g_EmissiveMap");
+        ReleaseSharedSRB(mat_it->second.SharedKey);
+        m_SRBCache.erase(mat_it);
     }
 
+    auto shared_it = m_SharedSRBs.find(SharedKey);
+    if (shared_it == m_SharedSRBs.end())
+    {
+        RefCntAutoPtr<IShaderResourceBinding> pSRB;
+        pPSO->CreateShaderResourceBinding(&pSRB, true);
 
-    SRBCacheKey SRBKey{&Material, TypeId};
+        if (auto* pCameraAttribsVSVar = pSRB->GetVariableByName(SHADER_TYPE_VERTEX, "cbCameraAttribs"))
+            pCameraAttribsVSVar->Set(pCameraAttribs);
 
-    auto it = m_SRBCache.find(SRBKey);
-    if (it != m_SRBCache.end())
-    {
-        it->second = std::move(pSRB);
-        return it->second;
+        if (pCameraAttribs != nullptr)
+        {
+            if (auto* pCameraAttribsPSVar = pSRB->GetVariableByName(SHADER_TYPE_PIXEL, "cbCameraAttribs"))
+                pCameraAttribsPSVar->Set(pCameraAttribs);
+        }
+
+        if (pLightAttribs != nullptr)
+        {
+            if (auto* pLightAttribsPSVar = pSRB->GetVariableByName(SHADER_TYPE_PIXEL, "cbLightAttribs"))
+                pLightAttribsPSVar->Set(pLightAttribs);
+        }
+
+        if (m_Settings.UseIBL)
+        {
+            if (auto* pIrradianceMapPSVar = pSRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_IrradianceMap"))
+                pIrradianceMapPSVar->Set(m_pIrradianceCubeSRV);
+
+            if (auto* pPrefilteredEnvMap = pSRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_PrefilteredEnvMap"))
+                pPrefilteredEnvMap->Set(m_pPrefilteredEnvMapSRV);
+        }
+
+        auto SetTexture = [&](SharedSRBKey::TEXTURE_ID TexId, const char* VarName) //
+        {
+            if (auto* pVar = pSRB->GetVariableByName(SHADER_TYPE_PIXEL, VarName))
+                pVar->Set(SharedKey.TextureSRVs[TexId]);
+        };
+
+        SetTexture(SharedSRBKey::TEXTURE_COLOR, "g_ColorMap");
+        SetTexture(SharedSRBKey::TEXTURE_PHYS_DESC, "g_PhysicalDescriptorMap");
+        SetTexture(SharedSRBKey::TEXTURE_NORMAL, "g_NormalMap");
+        if (m_Settings.UseAO)
+        {
+            SetTexture(SharedSRBKey::TEXTURE_AO, "g_AOMap");
+        }
+        if (m_Settings.UseEmissive)
+        {
+            SetTexture(SharedSRBKey::TEXTURE_EMISSIVE, "g_EmissiveMap");
+        }
+
+        if (m_Settings.UseStructuredBuffers)
+        {
+            BindStructuredBuffers(pSRB);
+        }
+
+        shared_it = m_SharedSRBs.emplace(SharedKey, SharedSRB{}).first;
+        shared_it->second.pSRB = std::move(pSRB);
     }
-    else
+    ++shared_it->second.RefCount;
+
+    auto& MatSRB     = m_SRBCache[SRBKey];
+    MatSRB.pSRB      = shared_it->second.pSRB;
+    MatSRB.SharedKey = SharedKey;
+
+    return MatSRB.pSRB;
+}
+
+void GLTF_PBR_Renderer::ReleaseSharedSRB(const SharedSRBKey& SharedKey)
+{
+    auto it = m_SharedSRBs.find(SharedKey);
+    if (it == m_SharedSRBs.end())
     {
-        auto new_it = m_SRBCache.emplace(SRBKey, std::move(pSRB));
-        VERIFY_EXPR(new_it.second);
-        return new_it.first->second;
+        UNEXPECTED("Shared SRB is not found in the cache");
+        return;
     }
+
+    VERIFY_EXPR(it->second.RefCount > 0);
+    if (--it->second.RefCount == 0)
+        m_SharedSRBs.erase(it);
+}
+
+std::string GLTF_PBR_Renderer::GetIBLCachePath(ITextureView* pEnvironmentMap, size_t EnvironmentMapHash, const char* Suffix) const
+{
+    // Cached cube maps are only valid for the same environment map, cube map formats and sample counts
+    const auto& EnvMapDesc = pEnvironmentMap->GetTexture()->GetDesc();
+
+    const auto Hash = ComputeHash(EnvironmentMapHash, EnvMapDesc.Width, EnvMapDesc.Height, EnvMapDesc.MipLevels, static_cast<Uint32>(EnvMapDesc.Format),
+                                  static_cast<Uint32>(IrradianceCubeFmt), Uint32{IrradianceCubeDim}, Uint32{IrradianceNumPhiSamples}, Uint32{IrradianceNumThetaSamples},
+                                  static_cast<Uint32>(PrefilteredEnvMapFmt), Uint32{PrefilteredEnvMapDim}, Uint32{PrefilterNumSamples});
+
+    std::stringstream ss;
+    ss << m_IBLCacheDirectory << FileSystem::GetSlashSymbol() << "GLTF_IBL_" << std::hex << std::setw(16) << std::setfill('0') << Hash << '_' << Suffix << ".ktx";
+    return ss.str();
 }
 
 void GLTF_PBR_Renderer::PrecomputeCubemaps(IRenderDevice*  pDevice,
                                            IDeviceContext* pCtx,
-                                           ITextureView*   pEnvironmentMap)
+                                           ITextureView*   pEnvironmentMap,
+                                           size_t          EnvironmentMapHash)
 {
     if (!m_Settings.UseIBL)
     {
@@ -489,6 +739,35 @@ void GLTF_PBR_Renderer::PrecomputeCubemaps(IRenderDevice*  pDevice,
         return;
     }
 
+    auto* pIrradianceCube    = m_pIrradianceCubeSRV->GetTexture();
+    auto* pPrefilteredEnvMap = m_pPrefilteredEnvMapSRV->GetTexture();
+
+    auto TransitionCubemaps = [&]() {
+        // clang-format off
+        StateTransitionDesc Barriers[] = 
+        {
+            {pPrefilteredEnvMap, RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_SHADER_RESOURCE, true},
+            {pIrradianceCube,    RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_SHADER_RESOURCE, true}
+        };
+        // clang-format on
+        pCtx->TransitionResourceStates(_countof(Barriers), Barriers);
+    };
+
+    const auto UseCache = !m_IBLCacheDirectory.empty() && EnvironmentMapHash != 0;
+
+    std::string IrradianceCachePath, PrefilteredEnvMapCachePath;
+    if (UseCache)
+    {
+        IrradianceCachePath        = GetIBLCachePath(pEnvironmentMap, EnvironmentMapHash, "Irradiance");
+        PrefilteredEnvMapCachePath = GetIBLCachePath(pEnvironmentMap, EnvironmentMapHash, "PrefilteredEnvMap");
+        if (ReadCubemapKTX(pDevice, pCtx, pIrradianceCube, IrradianceCachePath.c_str()) &&
+            ReadCubemapKTX(pDevice, pCtx, pPrefilteredEnvMap, PrefilteredEnvMapCachePath.c_str()))
+        {
+            TransitionCubemaps();
+            return;
+        }
+    }
+
     struct PrecomputeEnvMapAttribs
     {
         float4x4 Rotation;
@@ -512,8 +791,8 @@ void GLTF_PBR_Renderer::PrecomputeCubemaps(IRenderDevice*  pDevice,
         ShaderCI.pShaderSourceStreamFactory = &DiligentFXShaderSourceStreamFactory::GetInstance();
 
         ShaderMacroHelper Macros;
-        Macros.AddShaderMacro("NUM_PHI_SAMPLES", 64);
-        Macros.AddShaderMacro("NUM_THETA_SAMPLES", 32);
+        Macros.AddShaderMacro("NUM_PHI_SAMPLES", static_cast<int>(IrradianceNumPhiSamples));
+        Macros.AddShaderMacro("NUM_THETA_SAMPLES", static_cast<int>(IrradianceNumThetaSamples));
         ShaderCI.Macros = Macros;
         RefCntAutoPtr<IShader> pVS;
         {
@@ -661,7 +940,6 @@ void GLTF_PBR_Renderer::PrecomputeCubemaps(IRenderDevice*  pDevice,
     pCtx->SetPipelineState(m_pPrecomputeIrradianceCubePSO);
     m_pPrecomputeIrradianceCubeSRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_EnvironmentMap")->Set(pEnvironmentMap);
     pCtx->CommitShaderResources(m_pPrecomputeIrradianceCubeSRB, RESOURCE_STATE_TRANSITION_MODE_VERIFY);
-    auto*       pIrradianceCube    = m_pIrradianceCubeSRV->GetTexture();
     const auto& IrradianceCubeDesc = pIrradianceCube->GetDesc();
     for (Uint32 mip = 0; mip < IrradianceCubeDesc.MipLevels; ++mip)
     {
@@ -688,7 +966,6 @@ void GLTF_PBR_Renderer::PrecomputeCubemaps(IRenderDevice*  pDevice,
     pCtx->SetPipelineState(m_pPrefilterEnvMapPSO);
     m_pPrefilterEnvMapSRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_EnvironmentMap")->Set(pEnvironmentMap);
     pCtx->CommitShaderResources(m_pPrefilterEnvMapSRB, RESOURCE_STATE_TRANSITION_MODE_VERIFY);
-    auto*       pPrefilteredEnvMap    = m_pPrefilteredEnvMapSRV->GetTexture();
     const auto& PrefilteredEnvMapDesc = pPrefilteredEnvMap->GetDesc();
     for (Uint32 mip = 0; mip < PrefilteredEnvMapDesc.MipLevels; ++mip)
     {
@@ -709,7 +986,7 @@ void GLTF_PBR_Renderer::PrecomputeCubemaps(IRenderDevice*  pDevice,
                 Attribs->Rotation   = Matrices[face];
                 Attribs->Roughness  = static_cast<float>(mip) / static_cast<float>(PrefilteredEnvMapDesc.MipLevels);
                 Attribs->EnvMapDim  = static_cast<float>(PrefilteredEnvMapDesc.Width);
-                Attribs->NumSamples = 256;
+                Attribs->NumSamples = PrefilterNumSamples;
             }
 
             DrawAttribs drawAttrs(4, DRAW_FLAG_VERIFY_ALL);
@@ -717,14 +994,16 @@ void GLTF_PBR_Renderer::PrecomputeCubemaps(IRenderDevice*  pDevice,
         }
     }
 
-    // clang-format off
-    StateTransitionDesc Barriers[] = 
+    if (UseCache)
     {
-        {m_pPrefilteredEnvMapSRV->GetTexture(), RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_SHADER_RESOURCE, true},
-        {m_pIrradianceCubeSRV->GetTexture(),    RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_SHADER_RESOURCE, true}
-    };
-    // clang-format on
-    pCtx->TransitionResourceStates(_countof(Barriers), Barriers);
+        if (!FileSystem::PathExists(m_IBLCacheDirectory.c_str()))
+            FileSystem::CreateDirectory(m_IBLCacheDirectory.c_str());
+
+        WriteCubemapToFile(pDevice, pCtx, pIrradianceCube, IrradianceCachePath.c_str());
+        WriteCubemapToFile(pDevice, pCtx, pPrefilteredEnvMap, PrefilteredEnvMapCachePath.c_str());
+    }
+
+    TransitionCubemaps();
 }
 
 
@@ -742,214 +1021,738 @@ void GLTF_PBR_Renderer::ReleaseResourceBindings(GLTF::Model& GLTFModel, size_t S
 {
     for (auto& mat : GLTFModel.Materials)
     {
-        m_SRBCache.erase(SRBCacheKey{&mat, SRBTypeId});
+        auto it = m_SRBCache.find(SRBCacheKey{&mat, SRBTypeId});
+        if (it != m_SRBCache.end())
+        {
+            ReleaseSharedSRB(it->second.SharedKey);
+            m_SRBCache.erase(it);
+        }
+    }
+
+    for (auto it = m_LODHistory.begin(); it != m_LODHistory.end();)
+    {
+        if (it->first.pModel == &GLTFModel)
+            it = m_LODHistory.erase(it);
+        else
+            ++it;
     }
 }
 
+void GLTF_PBR_Renderer::SetSubtreeVisibility(const GLTF::Node& Node, bool IsVisible, PrimitiveSelection* pSelection)
+{
+    if (Node._Mesh)
+    {
+        for (const auto& pPrimitive : Node._Mesh->Primitives)
+            pSelection[pPrimitive->Index].IsVisible = IsVisible;
+    }
+
+    for (const auto& pChild : Node.Children)
+        SetSubtreeVisibility(*pChild, IsVisible, pSelection);
+}
 
-void GLTF_PBR_Renderer::RenderGLTFNode(IDeviceContext*                                pCtx,
-                                       const GLTF::Node*                              node,
-                                       GLTF::Material::ALPHA_MODE                     AlphaMode,
-                                       const float4x4&                                ModelTransform,
-                                       std::function<void(const GLTFNodeRenderInfo&)> RenderNodeCallback,
-                                       size_t                                         SRBTypeId)
+void GLTF_PBR_Renderer::CullNodeSubtree(const GLTF::Node& Node, const ViewFrustum& ModelFrustum, bool IsFullyVisible, PrimitiveSelection* pSelection)
 {
-    if (node->_Mesh)
+    if (!IsFullyVisible && Node.IsValidBVH)
     {
-        // Render mesh primitives
-        for (const auto& primitive : node->_Mesh->Primitives)
+        const auto Visibility = GetBoxVisibility(ModelFrustum, Node.BVH);
+        if (Visibility == BoxVisibility::Invisible)
         {
-            if (primitive->material.AlphaMode != AlphaMode)
-                continue;
+            ++m_CullingStats.NumSubtreesCulled;
+            SetSubtreeVisibility(Node, false, pSelection);
+            return;
+        }
+        // All descendants of a fully visible node are visible too
+        IsFullyVisible = Visibility == BoxVisibility::FullyVisible;
+    }
 
-            GLTFNodeRenderInfo NodeRI;
+    if (Node._Mesh)
+    {
+        for (const auto& pPrimitive : Node._Mesh->Primitives)
+            pSelection[pPrimitive->Index].IsVisible = true;
+    }
 
-            IShaderResourceBinding* pSRB = nullptr;
+    for (const auto& pChild : Node.Children)
+        CullNodeSubtree(*pChild, ModelFrustum, IsFullyVisible, pSelection);
+}
 
-            const auto& material = primitive->material;
-            if (RenderNodeCallback == nullptr)
-            {
-                auto* pPSO = GetPSO(PSOKey{AlphaMode, material.DoubleSided});
-                VERIFY_EXPR(pPSO != nullptr);
-                pCtx->SetPipelineState(pPSO);
+const GLTF_PBR_Renderer::PrimitiveSelection* GLTF_PBR_Renderer::CullAndSelectLODs(const GLTF::Model& GLTFModel, const RenderInfo& RenderParams)
+{
+    m_PrimitiveSelection.clear();
+    m_PrimitiveSelection.resize(GLTFModel.NumPrimitives);
+    auto* const pSelection = m_PrimitiveSelection.data();
 
-                pSRB = GetMaterialSRB(&material, SRBTypeId);
-                if (pSRB == nullptr)
-                {
-                    LOG_ERROR_MESSAGE("Unable to find SRB for GLTF material. Please call GLTF_PBR_Renderer::InitializeResourceBindings()");
-                    continue;
-                }
-                pCtx->CommitShaderResources(pSRB, RESOURCE_STATE_TRANSITION_MODE_VERIFY);
-            }
-            else
-            {
-                NodeRI.pMaterial = &material;
-            }
+    // Levels of detail that were selected for the same model and view last time
+    auto& LODHistory = m_LODHistory[LODHistoryKey{&GLTFModel, RenderParams.ViewId}];
+    LODHistory.resize(GLTFModel.NumPrimitives);
 
-            {
-                GLTFNodeShaderTransforms* pTransforms = nullptr;
-                if (RenderNodeCallback == nullptr)
-                {
-                    pCtx->MapBuffer(m_TransformsCB, MAP_WRITE, MAP_FLAG_DISCARD, reinterpret_cast<PVoid&>(pTransforms));
-                }
-                else
-                {
-                    pTransforms = &NodeRI.ShaderTransforms;
-                }
+    // Bounding volume hierarchy is computed for the model's initial pose, so hierarchical
+    // culling is only performed for static models.
+    if (RenderParams.FrustumCulling && GLTFModel.Animations.empty() && GLTFModel.Skins.empty())
+    {
+        // Transform frustum planes to model space
+        auto TransformPlane = [&RenderParams](const Plane3D& Plane) //
+        {
+            const auto ModelPlane = RenderParams.ModelTransform * float4{Plane.Normal, Plane.Distance};
 
-                pTransforms->NodeMatrix = node->_Mesh->Transforms.matrix * ModelTransform;
-                pTransforms->JointCount = node->_Mesh->Transforms.jointcount;
-                if (node->_Mesh->Transforms.jointcount != 0)
-                {
-                    static_assert(sizeof(pTransforms->JointMatrix) == sizeof(node->_Mesh->Transforms.jointMatrix), "Incosistent sizes");
-                    memcpy(pTransforms->JointMatrix, node->_Mesh->Transforms.jointMatrix, sizeof(node->_Mesh->Transforms.jointMatrix));
-                }
+            Plane3D Res;
+            Res.Normal   = float3{ModelPlane.x, ModelPlane.y, ModelPlane.z};
+            Res.Distance = ModelPlane.w;
+            return Res;
+        };
+        ViewFrustum ModelFrustum;
+        ModelFrustum.LeftPlane   = TransformPlane(RenderParams.Frustum.LeftPlane);
+        ModelFrustum.RightPlane  = TransformPlane(RenderParams.Frustum.RightPlane);
+        ModelFrustum.BottomPlane = TransformPlane(RenderParams.Frustum.BottomPlane);
+        ModelFrustum.TopPlane    = TransformPlane(RenderParams.Frustum.TopPlane);
+        ModelFrustum.NearPlane   = TransformPlane(RenderParams.Frustum.NearPlane);
+        ModelFrustum.FarPlane    = TransformPlane(RenderParams.Frustum.FarPlane);
+
+        for (const auto& pNode : GLTFModel.Nodes)
+            CullNodeSubtree(*pNode, ModelFrustum, false, pSelection);
+    }
 
-                if (RenderNodeCallback == nullptr)
-                {
-                    pCtx->UnmapBuffer(m_TransformsCB, MAP_WRITE);
-                }
-            }
+    const auto SmallObjectCulling = RenderParams.MinPixelSize > 0 && RenderParams.ProjScale > 0 && RenderParams.ViewportHeight > 0;
 
-            {
-                GLTFMaterialShaderInfo* pMaterialInfo = nullptr;
-                if (RenderNodeCallback == nullptr)
-                {
-                    struct GLTFAttribs
-                    {
-                        GLTFRendererShaderParameters RenderParameters;
-                        GLTFMaterialShaderInfo       MaterialInfo;
-                    };
-                    GLTFAttribs* pGLTFAttribs = nullptr;
-                    pCtx->MapBuffer(m_GLTFAttribsCB, MAP_WRITE, MAP_FLAG_DISCARD, reinterpret_cast<PVoid&>(pGLTFAttribs));
-                    pMaterialInfo = &pGLTFAttribs->MaterialInfo;
-
-                    auto& RenderParams = pGLTFAttribs->RenderParameters;
-
-                    RenderParams.DebugViewType            = static_cast<int>(m_RenderParams.DebugView);
-                    RenderParams.OcclusionStrength        = m_RenderParams.OcclusionStrength;
-                    RenderParams.EmissionScale            = m_RenderParams.EmissionScale;
-                    RenderParams.AverageLogLum            = m_RenderParams.AverageLogLum;
-                    RenderParams.MiddleGray               = m_RenderParams.MiddleGray;
-                    RenderParams.WhitePoint               = m_RenderParams.WhitePoint;
-                    RenderParams.IBLScale                 = m_RenderParams.IBLScale;
-                    RenderParams.PrefilteredCubeMipLevels = m_Settings.UseIBL ? static_cast<float>(m_pPrefilteredEnvMapSRV->GetTexture()->GetDesc().MipLevels) : 0.f;
-                }
-                else
-                {
-                    pMaterialInfo = &NodeRI.MaterialShaderInfo;
-                }
+    for (auto* pNode : GLTFModel.LinearNodes)
+    {
+        if (!pNode->_Mesh)
+            continue;
 
-                pMaterialInfo->EmissiveFactor = material.EmissiveFactor;
+        const auto& Mesh      = *pNode->_Mesh;
+        const auto  Transform = Mesh.Transforms.matrix * RenderParams.ModelTransform;
 
-                auto GetUVSelector = [](const ITexture* pTexture, Uint8 TexCoordSet) {
-                    return pTexture != nullptr ? static_cast<float>(TexCoordSet) : -1;
-                };
+        // Skinned vertices may leave the bounding box of the mesh, so skinned meshes are not culled
+        const auto IsSkinned = Mesh.Transforms.jointcount > 0;
 
-                pMaterialInfo->BaseColorTextureUVSelector = GetUVSelector(material.pBaseColorTexture, material.TexCoordSets.BaseColor);
-                pMaterialInfo->NormalTextureUVSelector    = GetUVSelector(material.pNormalTexture, material.TexCoordSets.Normal);
-                pMaterialInfo->OcclusionTextureUVSelector = GetUVSelector(material.pOcclusionTexture, material.TexCoordSets.Occlusion);
-                pMaterialInfo->EmissiveTextureUVSelector  = GetUVSelector(material.pEmissiveTexture, material.TexCoordSets.Emissive);
-                pMaterialInfo->UseAlphaMask               = material.AlphaMode == GLTF::Material::ALPHAMODE_MASK ? 1 : 0;
-                pMaterialInfo->AlphaMaskCutoff            = material.AlphaCutoff;
+        // Simplification errors are given in model space and must be scaled by the largest axis scale
+        const auto MaxScale = std::max({length(float3::MakeVector(Transform[0])),
+                                        length(float3::MakeVector(Transform[1])),
+                                        length(float3::MakeVector(Transform[2]))});
 
-                // TODO: glTF specs states that metallic roughness should be preferred, even if specular glosiness is present
-                if (material.workflow == GLTF::Material::PbrWorkflow::MetallicRoughness)
-                {
-                    // Metallic roughness workflow
-                    pMaterialInfo->Workflow                            = PBR_WORKFLOW_METALLIC_ROUGHNESS;
-                    pMaterialInfo->BaseColorFactor                     = material.BaseColorFactor;
-                    pMaterialInfo->MetallicFactor                      = material.MetallicFactor;
-                    pMaterialInfo->RoughnessFactor                     = material.RoughnessFactor;
-                    pMaterialInfo->PhysicalDescriptorTextureUVSelector = GetUVSelector(material.pMetallicRoughnessTexture, material.TexCoordSets.MetallicRoughness);
-                    pMaterialInfo->BaseColorTextureUVSelector          = GetUVSelector(material.pBaseColorTexture, material.TexCoordSets.BaseColor);
-                }
-                else if (material.workflow == GLTF::Material::PbrWorkflow::SpecularGlossiness)
-                {
-                    // Specular glossiness workflow
-                    pMaterialInfo->Workflow                            = PBR_WORKFLOW_SPECULAR_GLOSINESS;
-                    pMaterialInfo->PhysicalDescriptorTextureUVSelector = GetUVSelector(material.extension.pSpecularGlossinessTexture, material.TexCoordSets.SpecularGlossiness);
-                    pMaterialInfo->BaseColorTextureUVSelector          = GetUVSelector(material.extension.pDiffuseTexture, material.TexCoordSets.BaseColor);
-                    pMaterialInfo->BaseColorFactor                     = material.extension.DiffuseFactor;
-                    pMaterialInfo->SpecularFactor                      = float4(material.extension.SpecularFactor, 1.0f);
-                }
+        for (const auto& pPrimitive : Mesh.Primitives)
+        {
+            const auto& Prim = *pPrimitive;
+            VERIFY_EXPR(Prim.Index < GLTFModel.NumPrimitives);
+            auto& Selection = pSelection[Prim.Index];
 
-                if (RenderNodeCallback == nullptr)
-                {
-                    pCtx->UnmapBuffer(m_GLTFAttribsCB, MAP_WRITE);
-                }
+            ++m_CullingStats.NumPrimitives;
+            if (!Selection.IsVisible)
+            {
+                // Culled with the whole subtree
+                ++m_CullingStats.NumFrustumCulled;
+                continue;
             }
 
-            if (primitive->hasIndices)
+            if (!Prim.IsValidBB)
             {
-                if (RenderNodeCallback == nullptr)
-                {
-                    DrawIndexedAttribs drawAttrs(primitive->IndexCount, VT_UINT32, DRAW_FLAG_VERIFY_ALL);
-                    drawAttrs.FirstIndexLocation = primitive->FirstIndex;
-                    pCtx->DrawIndexed(drawAttrs);
-                }
-                else
-                {
-                    NodeRI.IndexType  = VT_UINT32;
-                    NodeRI.IndexCount = primitive->IndexCount;
-                    NodeRI.FirstIndex = primitive->FirstIndex;
-                    RenderNodeCallback(NodeRI);
-                }
+                Selection.LOD = 0;
+                continue;
             }
-            else
+
+            const auto BB = Prim.BB.Transform(Transform);
+            if (RenderParams.FrustumCulling && !IsSkinned && GetBoxVisibility(RenderParams.Frustum, BB) == BoxVisibility::Invisible)
             {
-                if (RenderNodeCallback == nullptr)
-                {
-                    DrawAttribs drawAttrs(primitive->VertexCount, DRAW_FLAG_VERIFY_ALL);
-                    pCtx->Draw(drawAttrs);
-                }
-                else
+                Selection.IsVisible = false;
+                ++m_CullingStats.NumFrustumCulled;
+                continue;
+            }
+
+            const auto Center         = (BB.Min + BB.Max) * 0.5f;
+            const auto Radius         = length(BB.Max - BB.Min) * 0.5f;
+            const auto CenterDistance = length(Center - RenderParams.CameraPosition);
+            const auto Distance       = CenterDistance - Radius;
+            if (SmallObjectCulling && !IsSkinned && Distance > 0)
+            {
+                // Projected diameter of the bounding sphere in pixels (clip space height is 2)
+                const auto PixelSize = Radius * RenderParams.ProjScale * RenderParams.ViewportHeight / CenterDistance;
+                if (PixelSize < RenderParams.MinPixelSize)
                 {
-                    NodeRI.IndexType   = VT_UNDEFINED;
-                    NodeRI.VertexCount = primitive->VertexCount;
-                    NodeRI.FirstIndex  = 0;
-                    RenderNodeCallback(NodeRI);
+                    Selection.IsVisible = false;
+                    ++m_CullingStats.NumSmallCulled;
+                    continue;
                 }
             }
+
+            if (Prim.LODs.size() <= 1 || RenderParams.ProjScale <= 0)
+            {
+                Selection.LOD = 0;
+                continue;
+            }
+
+            if (Distance <= 0)
+            {
+                // The camera is inside the bounding sphere
+                Selection.LOD = 0;
+                continue;
+            }
+
+            // Projected size of a model-space unit at the nearest point of the bounding sphere
+            // as a fraction of the viewport height (clip space height is 2).
+            const auto ErrorToScreen  = MaxScale * RenderParams.ProjScale / (2.f * Distance);
+            const auto GetScreenError = [&](Uint32 lod) {
+                return Prim.LODs[lod].Error * ErrorToScreen;
+            };
+
+            auto LOD = std::min(Uint32{LODHistory[Prim.Index]}, static_cast<Uint32>(Prim.LODs.size() - 1));
+            while (LOD > 0 && GetScreenError(LOD) > RenderParams.LODErrorThreshold)
+                --LOD;
+            while (LOD + 1 < Prim.LODs.size() && GetScreenError(LOD + 1) <= RenderParams.LODErrorThreshold * (1.f - RenderParams.LODHysteresis))
+                ++LOD;
+            Selection.LOD = static_cast<Uint8>(LOD);
         }
     }
 
-    for (const auto& child : node->Children)
+    // Culled primitives keep their previous level of detail
+    for (Uint32 i = 0; i < GLTFModel.NumPrimitives; ++i)
     {
-        RenderGLTFNode(pCtx, child.get(), AlphaMode, ModelTransform, RenderNodeCallback, SRBTypeId);
+        if (pSelection[i].IsVisible)
+            LODHistory[i] = pSelection[i].LOD;
     }
+
+    return pSelection;
 }
 
-void GLTF_PBR_Renderer::Render(IDeviceContext*                                pCtx,
-                               GLTF::Model&                                   GLTFModel,
-                               const RenderInfo&                              RenderParams,
-                               std::function<void(const GLTFNodeRenderInfo&)> RenderNodeCallback,
-                               size_t                                         SRBTypeId)
+void GLTF_PBR_Renderer::WriteRenderParameters(const RenderInfo& Info, GLTFRendererShaderParameters& RenderParams)
 {
-    m_RenderParams = RenderParams;
+    RenderParams.DebugViewType            = static_cast<int>(Info.DebugView);
+    RenderParams.OcclusionStrength        = Info.OcclusionStrength;
+    RenderParams.EmissionScale            = Info.EmissionScale;
+    RenderParams.AverageLogLum            = Info.AverageLogLum;
+    RenderParams.MiddleGray               = Info.MiddleGray;
+    RenderParams.WhitePoint               = Info.WhitePoint;
+    RenderParams.IBLScale                 = Info.IBLScale;
+    RenderParams.PrefilteredCubeMipLevels = m_Settings.UseIBL ? static_cast<float>(m_pPrefilteredEnvMapSRV->GetTexture()->GetDesc().MipLevels) : 0.f;
+}
+
+void GLTF_PBR_Renderer::WriteMaterialShaderInfo(const GLTF::Material& Material, GLTFMaterialShaderInfo& MaterialInfo)
+{
+    MaterialInfo.EmissiveFactor = Material.EmissiveFactor;
 
+    auto GetUVSelector = [](const ITexture* pTexture, Uint8 TexCoordSet) {
+        return pTexture != nullptr ? static_cast<float>(TexCoordSet) : -1;
+    };
+
+    MaterialInfo.BaseColorTextureUVSelector = GetUVSelector(Material.pBaseColorTexture, Material.TexCoordSets.BaseColor);
+    MaterialInfo.NormalTextureUVSelector    = GetUVSelector(Material.pNormalTexture, Material.TexCoordSets.Normal);
+    MaterialInfo.OcclusionTextureUVSelector = GetUVSelector(Material.pOcclusionTexture, Material.TexCoordSets.Occlusion);
+    MaterialInfo.EmissiveTextureUVSelector  = GetUVSelector(Material.pEmissiveTexture, Material.TexCoordSets.Emissive);
+    MaterialInfo.UseAlphaMask               = Material.AlphaMode == GLTF::Material::ALPHAMODE_MASK ? 1 : 0;
+    MaterialInfo.AlphaMaskCutoff            = Material.AlphaCutoff;
+
+    // TODO: glTF specs states that metallic roughness should be preferred, even if specular glosiness is present
+    if (Material.workflow == GLTF::Material::PbrWorkflow::MetallicRoughness)
+    {
+        // Metallic roughness workflow
+        MaterialInfo.Workflow                            = PBR_WORKFLOW_METALLIC_ROUGHNESS;
+        MaterialInfo.BaseColorFactor                     = Material.BaseColorFactor;
+        MaterialInfo.MetallicFactor                      = Material.MetallicFactor;
+        MaterialInfo.RoughnessFactor                     = Material.RoughnessFactor;
+        MaterialInfo.PhysicalDescriptorTextureUVSelector = GetUVSelector(Material.pMetallicRoughnessTexture, Material.TexCoordSets.MetallicRoughness);
+        MaterialInfo.BaseColorTextureUVSelector          = GetUVSelector(Material.pBaseColorTexture, Material.TexCoordSets.BaseColor);
+    }
+    else if (Material.workflow == GLTF::Material::PbrWorkflow::SpecularGlossiness)
+    {
+        // Specular glossiness workflow
+        MaterialInfo.Workflow                            = PBR_WORKFLOW_SPECULAR_GLOSINESS;
+        MaterialInfo.PhysicalDescriptorTextureUVSelector = GetUVSelector(Material.extension.pSpecularGlossinessTexture, Material.TexCoordSets.SpecularGlossiness);
+        MaterialInfo.BaseColorTextureUVSelector          = GetUVSelector(Material.extension.pDiffuseTexture, Material.TexCoordSets.BaseColor);
+        MaterialInfo.BaseColorFactor                     = Material.extension.DiffuseFactor;
+        MaterialInfo.SpecularFactor                      = float4(Material.extension.SpecularFactor, 1.0f);
+    }
+}
+
+void GLTF_PBR_Renderer::RenderPrimitive(IDeviceContext*                                       pCtx,
+                                        const GLTF::Node*                                     node,
+                                        const GLTF::Primitive*                                primitive,
+                                        Uint32                                                LODIndex,
+                                        VALUE_TYPE                                            IndexType,
+                                        const RenderInfo&                                     RenderParams,
+                                        const std::function<void(const GLTFNodeRenderInfo&)>& RenderNodeCallback,
+                                        size_t                                                SRBTypeId,
+                                        Uint32                                                NumInstances)
+{
+    // NumInstances is zero for regular (non-instanced) rendering
+    GLTFNodeRenderInfo NodeRI;
+
+    IShaderResourceBinding* pSRB = nullptr;
+
+    const auto& material = primitive->material;
     if (RenderNodeCallback == nullptr)
     {
-        IBuffer* pVBs[]                  = {GLTFModel.pVertexBuffer[0], GLTFModel.pVertexBuffer[1]};
-        Uint32   Offsets[_countof(pVBs)] = {};
-        pCtx->SetVertexBuffers(0, _countof(pVBs), pVBs, Offsets, RESOURCE_STATE_TRANSITION_MODE_VERIFY, SET_VERTEX_BUFFERS_FLAG_RESET);
-        if (GLTFModel.pIndexBuffer)
+        auto* pPSO = GetPSO(PSOKey{material.AlphaMode, material.DoubleSided, NumInstances > 0});
+        VERIFY_EXPR(pPSO != nullptr);
+        pCtx->SetPipelineState(pPSO);
+
+        pSRB = GetMaterialSRB(&material, SRBTypeId);
+        if (pSRB == nullptr)
         {
-            pCtx->SetIndexBuffer(GLTFModel.pIndexBuffer, 0, RESOURCE_STATE_TRANSITION_MODE_VERIFY);
+            LOG_ERROR_MESSAGE("Unable to find SRB for GLTF material. Please call GLTF_PBR_Renderer::InitializeResourceBindings()");
+            return;
         }
+        pCtx->CommitShaderResources(pSRB, RESOURCE_STATE_TRANSITION_MODE_VERIFY);
     }
     else
     {
-        // An application should bind index buffers and PSOs
+        NodeRI.pMaterial = &material;
+    }
+
+    {
+        GLTFNodeShaderTransforms*       pTransforms  = nullptr;
+        GLTFNodePositionDequantization* pDequantAttr = nullptr;
+        if (RenderNodeCallback == nullptr)
+        {
+            pCtx->MapBuffer(m_TransformsCB, MAP_WRITE, MAP_FLAG_DISCARD, reinterpret_cast<PVoid&>(pTransforms));
+            if (m_Settings.UseCompactVertexLayout)
+                pDequantAttr = reinterpret_cast<GLTFNodePositionDequantization*>(pTransforms + 1);
+        }
+        else
+        {
+            pTransforms  = &NodeRI.ShaderTransforms;
+            pDequantAttr = &NodeRI.PositionDequantization;
+        }
+
+        pTransforms->NodeMatrix = node->_Mesh->Transforms.matrix * RenderParams.ModelTransform;
+        pTransforms->JointCount = node->_Mesh->Transforms.jointcount;
+        if (pDequantAttr != nullptr)
+        {
+            pDequantAttr->PositionScale = float4{node->_Mesh->PositionScale, 0};
+            pDequantAttr->PositionBias  = float4{node->_Mesh->PositionBias, 0};
+        }
+        if (node->_Mesh->Transforms.jointcount != 0)
+        {
+            static_assert(_countof(pTransforms->JointMatrix) == GLTF::Mesh::TransformData::MaxNumJoints, "Incosistent sizes");
+            if (pTransforms->JointCount > static_cast<int>(GLTF::Mesh::TransformData::MaxNumJoints))
+            {
+                LOG_WARNING_MESSAGE_ONCE("Skinned mesh '", node->Name, "' has ", pTransforms->JointCount, " joints, but only ",
+                                         Uint32{GLTF::Mesh::TransformData::MaxNumJoints},
+                                         " joints fit into the constant buffer. Use structured buffers to render meshes with more joints.");
+                pTransforms->JointCount = static_cast<int>(GLTF::Mesh::TransformData::MaxNumJoints);
+            }
+            memcpy(pTransforms->JointMatrix, node->_Mesh->Transforms.jointMatrix.data(), sizeof(float4x4) * pTransforms->JointCount);
+        }
+
+        if (RenderNodeCallback == nullptr)
+        {
+            pCtx->UnmapBuffer(m_TransformsCB, MAP_WRITE);
+        }
+    }
+
+    {
+        GLTFMaterialShaderInfo* pMaterialInfo = nullptr;
+        if (RenderNodeCallback == nullptr)
+        {
+            struct GLTFAttribs
+            {
+                GLTFRendererShaderParameters RenderParameters;
+                GLTFMaterialShaderInfo       MaterialInfo;
+            };
+            GLTFAttribs* pGLTFAttribs = nullptr;
+            pCtx->MapBuffer(m_GLTFAttribsCB, MAP_WRITE, MAP_FLAG_DISCARD, reinterpret_cast<PVoid&>(pGLTFAttribs));
+            pMaterialInfo = &pGLTFAttribs->MaterialInfo;
+
+            WriteRenderParameters(RenderParams, pGLTFAttribs->RenderParameters);
+        }
+        else
+        {
+            pMaterialInfo = &NodeRI.MaterialShaderInfo;
+        }
+
+        WriteMaterialShaderInfo(material, *pMaterialInfo);
+
+        if (RenderNodeCallback == nullptr)
+        {
+            pCtx->UnmapBuffer(m_GLTFAttribsCB, MAP_WRITE);
+        }
+    }
+
+    if (primitive->hasIndices)
+    {
+        VERIFY_EXPR(LODIndex < primitive->LODs.size());
+        const auto& LOD = primitive->LODs[LODIndex];
+        if (RenderNodeCallback == nullptr)
+        {
+            DrawIndexedAttribs drawAttrs(LOD.IndexCount, IndexType, DRAW_FLAG_VERIFY_ALL);
+            drawAttrs.FirstIndexLocation = LOD.FirstIndex;
+            drawAttrs.BaseVertex         = primitive->BaseVertex;
+            drawAttrs.NumInstances       = std::max(NumInstances, 1u);
+            pCtx->DrawIndexed(drawAttrs);
+        }
+        else
+        {
+            NodeRI.IndexType  = IndexType;
+            NodeRI.IndexCount = LOD.IndexCount;
+            NodeRI.FirstIndex = LOD.FirstIndex;
+            NodeRI.BaseVertex = primitive->BaseVertex;
+            RenderNodeCallback(NodeRI);
+        }
+    }
+    else
+    {
+        if (RenderNodeCallback == nullptr)
+        {
+            DrawAttribs drawAttrs(primitive->VertexCount, DRAW_FLAG_VERIFY_ALL);
+            drawAttrs.StartVertexLocation = primitive->BaseVertex;
+            drawAttrs.NumInstances        = std::max(NumInstances, 1u);
+            pCtx->Draw(drawAttrs);
+        }
+        else
+        {
+            NodeRI.IndexType   = VT_UNDEFINED;
+            NodeRI.VertexCount = primitive->VertexCount;
+            NodeRI.FirstIndex  = 0;
+            NodeRI.BaseVertex  = primitive->BaseVertex;
+            RenderNodeCallback(NodeRI);
+        }
+    }
+}
+
+void GLTF_PBR_Renderer::RenderGLTFNode(IDeviceContext*                                       pCtx,
+                                       const GLTF::Node*                                     node,
+                                       const PrimitiveSelection*                             pSelection,
+                                       GLTF::Material::ALPHA_MODE                            AlphaMode,
+                                       VALUE_TYPE                                            IndexType,
+                                       const RenderInfo&                                     RenderParams,
+                                       const std::function<void(const GLTFNodeRenderInfo&)>& RenderNodeCallback,
+                                       size_t                                                SRBTypeId,
+                                       Uint32                                                NumInstances)
+{
+    if (node->_Mesh)
+    {
+        // Render mesh primitives
+        for (const auto& primitive : node->_Mesh->Primitives)
+        {
+            const auto& Selection = pSelection[primitive->Index];
+            if (primitive->material.AlphaMode != AlphaMode || !Selection.IsVisible)
+                continue;
+
+            RenderPrimitive(pCtx, node, primitive.get(), Selection.LOD, IndexType, RenderParams, RenderNodeCallback, SRBTypeId, NumInstances);
+        }
+    }
+
+    for (const auto& child : node->Children)
+    {
+        RenderGLTFNode(pCtx, child.get(), pSelection, AlphaMode, IndexType, RenderParams, RenderNodeCallback, SRBTypeId, NumInstances);
+    }
+}
+
+void GLTF_PBR_Renderer::CreateStructuredBuffers(IRenderDevice* pDevice)
+{
+    // Initial capacities; the buffers grow on demand
+    static constexpr Uint32 InitialNodeCount     = 64;
+    static constexpr Uint32 InitialJointCount    = 256;
+    static constexpr Uint32 InitialMaterialCount = 64;
+    static constexpr Uint32 InitialDrawCount     = 256;
+
+    // Dual quaternion palette stores two float4 values per joint
+    const Uint32 JointPaletteStride = m_Settings.UseDualQuaternionSkinning ? sizeof(float4) : sizeof(float4x4);
+
+    auto CreateBuffer = [pDevice](const char* Name, BIND_FLAGS BindFlags, Uint32 ElementSize, Uint32 NumElements, RefCntAutoPtr<IBuffer>& pBuffer) //
+    {
+        BufferDesc BuffDesc;
+        BuffDesc.Name              = Name;
+        BuffDesc.Usage             = USAGE_DEFAULT;
+        BuffDesc.BindFlags         = BindFlags;
+        BuffDesc.Mode              = (BindFlags & BIND_SHADER_RESOURCE) != 0 ? BUFFER_MODE_STRUCTURED : BUFFER_MODE_UNDEFINED;
+        BuffDesc.ElementByteStride = ElementSize;
+        BuffDesc.uiSizeInBytes     = ElementSize * NumElements;
+        pDevice->CreateBuffer(BuffDesc, nullptr, &pBuffer);
+    };
+    // clang-format off
+    CreateBuffer("GLTF node transforms buffer", BIND_SHADER_RESOURCE, sizeof(GLTFNodeShaderTransformRecord), InitialNodeCount,     m_NodeTransformsBuffer);
+    CreateBuffer("GLTF joint matrices buffer",  BIND_SHADER_RESOURCE, JointPaletteStride,                    InitialJointCount,    m_JointMatricesBuffer);
+    CreateBuffer("GLTF materials buffer",       BIND_SHADER_RESOURCE, sizeof(GLTFMaterialShaderInfo),        InitialMaterialCount, m_MaterialsBuffer);
+    CreateBuffer("GLTF draw records buffer",    BIND_VERTEX_BUFFER,   sizeof(uint2),                         InitialDrawCount,     m_DrawRecordsBuffer);
+    // clang-format on
+}
+
+bool GLTF_PBR_Renderer::ReserveStructuredBuffer(RefCntAutoPtr<IBuffer>& pBuffer, Uint32 RequiredSize)
+{
+    auto BuffDesc = pBuffer->GetDesc();
+    if (BuffDesc.uiSizeInBytes >= RequiredSize)
+        return false;
+
+    const auto ElementCount = (RequiredSize + BuffDesc.ElementByteStride - 1) / BuffDesc.ElementByteStride;
+    BuffDesc.uiSizeInBytes  = std::max(ElementCount * BuffDesc.ElementByteStride, BuffDesc.uiSizeInBytes * 2);
+
+    // BuffDesc.Name points into the old buffer, so the new buffer must be created before the old one is released.
+    // The old buffer is released by the engine when the GPU is done with it.
+    RefCntAutoPtr<IBuffer> pNewBuffer;
+    m_pDevice->CreateBuffer(BuffDesc, nullptr, &pNewBuffer);
+    pBuffer = std::move(pNewBuffer);
+    return true;
+}
+
+void GLTF_PBR_Renderer::BindStructuredBuffers(IShaderResourceBinding* pSRB)
+{
+    if (auto* pVar = pSRB->GetVariableByName(SHADER_TYPE_VERTEX, "g_NodeTransforms"))
+        pVar->Set(m_NodeTransformsBuffer->GetDefaultView(BUFFER_VIEW_SHADER_RESOURCE));
+
+    if (auto* pVar = pSRB->GetVariableByName(SHADER_TYPE_VERTEX, "g_JointMatrices"))
+        pVar->Set(m_JointMatricesBuffer->GetDefaultView(BUFFER_VIEW_SHADER_RESOURCE));
+
+    if (auto* pVar = pSRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_Materials"))
+        pVar->Set(m_MaterialsBuffer->GetDefaultView(BUFFER_VIEW_SHADER_RESOURCE));
+}
+
+void GLTF_PBR_Renderer::RenderWithStructuredBuffers(IDeviceContext*           pCtx,
+                                                    const GLTF::Model&        GLTFModel,
+                                                    const PrimitiveSelection* pSelection,
+                                                    const RenderInfo&         RenderParams,
+                                                    size_t                    SRBTypeId)
+{
+    m_NodeTransformRecords.clear();
+    m_JointMatrices.clear();
+    m_MaterialInfos.clear();
+    m_DrawRecords.clear();
+    m_DrawItems.clear();
+
+    // Material records are indexed by the position of the material in the model's material list
+    m_MaterialInfos.resize(GLTFModel.Materials.size());
+    for (size_t mat = 0; mat < GLTFModel.Materials.size(); ++mat)
+    {
+        WriteMaterialShaderInfo(GLTFModel.Materials[mat], m_MaterialInfos[mat]);
+    }
+
+    for (const auto* pNode : GLTFModel.LinearNodes)
+    {
+        if (!pNode->_Mesh)
+            continue;
+
+        const auto& Mesh        = *pNode->_Mesh;
+        const auto  TransformId = static_cast<Uint32>(m_NodeTransformRecords.size());
+        const auto  JointCount  = static_cast<Uint32>(Mesh.Transforms.jointcount);
+
+        m_NodeTransformRecords.emplace_back();
+        auto& Record         = m_NodeTransformRecords.back();
+        Record.NodeMatrix    = Mesh.Transforms.matrix * RenderParams.ModelTransform;
+        Record.JointCount    = static_cast<int>(JointCount);
+        Record.PositionScale = float4{Mesh.PositionScale, 0};
+        Record.PositionBias  = float4{Mesh.PositionBias, 0};
+        if (m_Settings.UseDualQuaternionSkinning)
+        {
+            // Joint palette is indexed by joints, two float4 elements per joint
+            Record.FirstJoint = static_cast<int>(m_JointMatrices.size() / 2);
+
+            const auto& DualQuats = Mesh.Transforms.jointDualQuats;
+            if (DualQuats.size() == size_t{JointCount} * 2)
+            {
+                m_JointMatrices.insert(m_JointMatrices.end(), DualQuats.begin(), DualQuats.end());
+            }
+            else
+            {
+                // The palette was computed in the matrix format
+                m_JointMatrices.resize(m_JointMatrices.size() + size_t{JointCount} * 2);
+                MatricesToDualQuaternions(Mesh.Transforms.jointMatrix.data(), JointCount, m_JointMatrices.data() + Record.FirstJoint * 2);
+            }
+        }
+        else
+        {
+            // Every matrix occupies four float4 elements
+            Record.FirstJoint = static_cast<int>(m_JointMatrices.size() / 4);
+
+            const auto* pJointData = reinterpret_cast<const float4*>(Mesh.Transforms.jointMatrix.data());
+            m_JointMatrices.insert(m_JointMatrices.end(), pJointData, pJointData + size_t{JointCount} * 4);
+        }
+
+        for (const auto& pPrimitive : Mesh.Primitives)
+        {
+            const auto& Material  = pPrimitive->material;
+            const auto& Selection = pSelection[pPrimitive->Index];
+            if ((RenderParams.AlphaModes & (1u << Material.AlphaMode)) == 0 || !Selection.IsVisible)
+                continue;
+
+            m_DrawItems.emplace_back();
+            auto& Item       = m_DrawItems.back();
+            Item.pPrimitive  = pPrimitive.get();
+            Item.LOD         = Selection.LOD;
+            Item.pSRB        = GetMaterialSRB(&Material, SRBTypeId);
+            Item.TransformId = TransformId;
+            Item.MaterialId  = static_cast<Uint32>(&Material - GLTFModel.Materials.data());
+            VERIFY_EXPR(Item.MaterialId < GLTFModel.Materials.size());
+        }
+    }
+
+    if (m_DrawItems.empty())
+        return;
+
+    // Opaque primitives first, then alpha masked and finally transparent primitives.
+    // Opaque and masked primitives are grouped by pipeline state and SRB to minimize state changes.
+    std::stable_sort(m_DrawItems.begin(), m_DrawItems.end(),
+                     [](const DrawItem& Item0, const DrawItem& Item1) {
+                         const auto& Mat0 = Item0.pPrimitive->material;
+                         const auto& Mat1 = Item1.pPrimitive->material;
+                         if (Mat0.AlphaMode != Mat1.AlphaMode)
+                             return Mat0.AlphaMode < Mat1.AlphaMode;
+                         if (Mat0.AlphaMode == GLTF::Material::ALPHAMODE_BLEND)
+                             return false;
+                         if (Mat0.DoubleSided != Mat1.DoubleSided)
+                             return Mat0.DoubleSided < Mat1.DoubleSided;
+                         return std::less<const IShaderResourceBinding*>{}(Item0.pSRB, Item1.pSRB);
+                     });
+
+    // Sort transparent primitives back to front
+    {
+        const auto FirstBlendItem = std::find_if(m_DrawItems.begin(), m_DrawItems.end(),
+                                                 [](const DrawItem& Item) {
+                                                     return Item.pPrimitive->material.AlphaMode == GLTF::Material::ALPHAMODE_BLEND;
+                                                 });
+        const auto NumBlendItems = static_cast<size_t>(m_DrawItems.end() - FirstBlendItem);
+        if (NumBlendItems > 1)
+        {
+            m_SortDepths.resize(NumBlendItems);
+            for (size_t i = 0; i < NumBlendItems; ++i)
+            {
+                const auto& Item = FirstBlendItem[i];
+                m_SortDepths[i]  = GetPrimitiveViewDepth(*Item.pPrimitive, m_NodeTransformRecords[Item.TransformId].NodeMatrix,
+                                                        RenderParams.CameraPosition, RenderParams.CameraViewDir);
+            }
+            ComputeBackToFrontSortKeys(m_SortDepths, m_SortKeys);
+            m_SortTmpKeys.resize(NumBlendItems);
+            m_TmpDrawItems.resize(NumBlendItems);
+            RadixSort(m_SortKeys.data(), &*FirstBlendItem, NumBlendItems, m_SortTmpKeys.data(), m_TmpDrawItems.data());
+        }
     }
 
+    m_DrawRecords.reserve(m_DrawItems.size());
+    for (const auto& Item : m_DrawItems)
+        m_DrawRecords.emplace_back(Item.TransformId, Item.MaterialId);
 
+    // Upload all data with one update per buffer. Records of a static model are the same
+    // every frame, so a buffer is only updated when its contents differ from the last upload.
+    bool StructuredBuffersRecreated = false;
+
+    auto UploadData = [&](RefCntAutoPtr<IBuffer>& pBuffer, std::vector<Uint8>& UploadedData, const void* pData, size_t DataSize) //
+    {
+        if (DataSize == 0)
+            return false;
+        const auto Recreated = ReserveStructuredBuffer(pBuffer, static_cast<Uint32>(DataSize));
+        if (!Recreated && UploadedData.size() == DataSize && memcmp(UploadedData.data(), pData, DataSize) == 0)
+            return false;
+
+        pCtx->UpdateBuffer(pBuffer, 0, static_cast<Uint32>(DataSize), pData, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+        UploadedData.assign(static_cast<const Uint8*>(pData), static_cast<const Uint8*>(pData) + DataSize);
+        return Recreated;
+    };
+    // clang-format off
+    StructuredBuffersRecreated |= UploadData(m_NodeTransformsBuffer, m_UploadedNodeTransforms, m_NodeTransformRecords.data(), m_NodeTransformRecords.size() * sizeof(m_NodeTransformRecords[0]));
+    StructuredBuffersRecreated |= UploadData(m_JointMatricesBuffer,  m_UploadedJointMatrices,  m_JointMatrices.data(),        m_JointMatrices.size()        * sizeof(m_JointMatrices[0]));
+    StructuredBuffersRecreated |= UploadData(m_MaterialsBuffer,      m_UploadedMaterials,      m_MaterialInfos.data(),        m_MaterialInfos.size()        * sizeof(m_MaterialInfos[0]));
+    UploadData(m_DrawRecordsBuffer, m_UploadedDrawRecords, m_DrawRecords.data(), m_DrawRecords.size() * sizeof(m_DrawRecords[0]));
+    // clang-format on
+
+    if (StructuredBuffersRecreated)
+    {
+        for (auto& it : m_SharedSRBs)
+            BindStructuredBuffers(it.second.pSRB);
+    }
+
+    // clang-format off
+    StateTransitionDesc Barriers[] = 
+    {
+        {m_NodeTransformsBuffer, RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_SHADER_RESOURCE, true},
+        {m_JointMatricesBuffer,  RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_SHADER_RESOURCE, true},
+        {m_MaterialsBuffer,      RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_SHADER_RESOURCE, true},
+        {m_DrawRecordsBuffer,    RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_VERTEX_BUFFER,   true}
+    };
+    // clang-format on
+    pCtx->TransitionResourceStates(_countof(Barriers), Barriers);
+
+    {
+        MapHelper<GLTFRendererShaderParameters> pRenderParams{pCtx, m_GLTFAttribsCB, MAP_WRITE, MAP_FLAG_DISCARD};
+        WriteRenderParameters(RenderParams, *pRenderParams);
+    }
+
+    IBuffer* pDrawRecordsVB[] = {m_DrawRecordsBuffer};
+    Uint32   Offsets[]        = {0};
+    pCtx->SetVertexBuffers(2, _countof(pDrawRecordsVB), pDrawRecordsVB, Offsets, RESOURCE_STATE_TRANSITION_MODE_VERIFY, SET_VERTEX_BUFFERS_FLAG_NONE);
+
+    // Every draw call renders a single instance, and the instance offset selects the
+    // draw record in the per-instance vertex stream.
+    IPipelineState*         pCurrPSO = nullptr;
+    IShaderResourceBinding* pCurrSRB = nullptr;
+    for (Uint32 DrawId = 0; DrawId < m_DrawItems.size(); ++DrawId)
+    {
+        const auto& Primitive = *m_DrawItems[DrawId].pPrimitive;
+        const auto& Material  = Primitive.material;
+
+        auto* pPSO = GetPSO(PSOKey{Material.AlphaMode, Material.DoubleSided});
+        VERIFY_EXPR(pPSO != nullptr);
+        if (pPSO != pCurrPSO)
+        {
+            pCtx->SetPipelineState(pPSO);
+            pCurrPSO = pPSO;
+            pCurrSRB = nullptr;
+        }
+
+        auto* pSRB = m_DrawItems[DrawId].pSRB;
+        if (pSRB == nullptr)
+        {
+            LOG_ERROR_MESSAGE("Unable to find SRB for GLTF material. Please call GLTF_PBR_Renderer::InitializeResourceBindings()");
+            continue;
+        }
+        if (pSRB != pCurrSRB)
+        {
+            pCtx->CommitShaderResources(pSRB, RESOURCE_STATE_TRANSITION_MODE_VERIFY);
+            pCurrSRB = pSRB;
+        }
+
+        if (Primitive.hasIndices)
+        {
+            VERIFY_EXPR(m_DrawItems[DrawId].LOD < Primitive.LODs.size());
+            const auto&        LOD = Primitive.LODs[m_DrawItems[DrawId].LOD];
+            DrawIndexedAttribs drawAttrs(LOD.IndexCount, GLTFModel.IndexType, DRAW_FLAG_VERIFY_ALL);
+            drawAttrs.FirstIndexLocation    = LOD.FirstIndex;
+            drawAttrs.BaseVertex            = Primitive.BaseVertex;
+            drawAttrs.FirstInstanceLocation = DrawId;
+            pCtx->DrawIndexed(drawAttrs);
+        }
+        else
+        {
+            DrawAttribs drawAttrs(Primitive.VertexCount, DRAW_FLAG_VERIFY_ALL);
+            drawAttrs.StartVertexLocation   = Primitive.BaseVertex;
+            drawAttrs.FirstInstanceLocation = DrawId;
+            pCtx->Draw(drawAttrs);
+        }
+    }
+}
+
+bool GLTF_PBR_Renderer::CheckVertexLayout(const GLTF::Model& GLTFModel) const
+{
+    if (GLTFModel.CompactVertexLayout != m_Settings.UseCompactVertexLayout)
+    {
+        LOG_ERROR_MESSAGE("GLTF model uses ", (GLTFModel.CompactVertexLayout ? "compact" : "full"),
+                          " vertex layout, while the renderer was created for ", (m_Settings.UseCompactVertexLayout ? "compact" : "full"),
+                          " layout. Set GLTF_PBR_Renderer::CreateInfo::UseCompactVertexLayout to match the model.");
+        return false;
+    }
+    return true;
+}
+
+void GLTF_PBR_Renderer::BindModelBuffers(IDeviceContext* pCtx, const GLTF::Model& GLTFModel)
+{
+    IBuffer* pVBs[]                  = {GLTFModel.GetVertexBuffer(0), GLTFModel.GetVertexBuffer(1)};
+    Uint32   Offsets[_countof(pVBs)] = {};
+    pCtx->SetVertexBuffers(0, _countof(pVBs), pVBs, Offsets, RESOURCE_STATE_TRANSITION_MODE_VERIFY, SET_VERTEX_BUFFERS_FLAG_RESET);
+    if (auto* pIndexBuffer = GLTFModel.GetIndexBuffer())
+    {
+        pCtx->SetIndexBuffer(pIndexBuffer, 0, RESOURCE_STATE_TRANSITION_MODE_VERIFY);
+    }
+}
+
+void GLTF_PBR_Renderer::RenderAlphaModes(IDeviceContext*                                       pCtx,
+                                         const GLTF::Model&                                    GLTFModel,
+                                         const PrimitiveSelection*                             pSelection,
+                                         const RenderInfo&                                     RenderParams,
+                                         const std::function<void(const GLTFNodeRenderInfo&)>& RenderNodeCallback,
+                                         size_t                                                SRBTypeId,
+                                         Uint32                                                NumInstances)
+{
     // Opaque primitives first
     if (RenderParams.AlphaModes & RenderInfo::ALPHA_MODE_FLAG_OPAQUE)
     {
         for (const auto& node : GLTFModel.Nodes)
         {
-            RenderGLTFNode(pCtx, node.get(), GLTF::Material::ALPHAMODE_OPAQUE, RenderParams.ModelTransform, RenderNodeCallback, SRBTypeId);
+            RenderGLTFNode(pCtx, node.get(), pSelection, GLTF::Material::ALPHAMODE_OPAQUE, GLTFModel.IndexType, RenderParams, RenderNodeCallback, SRBTypeId, NumInstances);
         }
     }
 
@@ -959,18 +1762,756 @@ void GLTF_PBR_Renderer::Render(IDeviceContext*                                pC
     {
         for (const auto& node : GLTFModel.Nodes)
         {
-            RenderGLTFNode(pCtx, node.get(), GLTF::Material::ALPHAMODE_MASK, RenderParams.ModelTransform, RenderNodeCallback, SRBTypeId);
+            RenderGLTFNode(pCtx, node.get(), pSelection, GLTF::Material::ALPHAMODE_MASK, GLTFModel.IndexType, RenderParams, RenderNodeCallback, SRBTypeId, NumInstances);
         }
     }
 
 
     // Transparent primitives
-    // TODO: Correct depth sorting
     if (RenderParams.AlphaModes & RenderInfo::ALPHA_MODE_FLAG_BLEND)
     {
-        for (const auto& node : GLTFModel.Nodes)
+        if (NumInstances == 0)
+        {
+            // Sort primitives of the model back to front
+            AddTransparentPrimitives(m_ModelTransparentQueue, GLTFModel, pSelection, RenderParams, SRBTypeId);
+            RenderTransparentPrimitives(pCtx, m_ModelTransparentQueue, RenderNodeCallback == nullptr ? &GLTFModel : nullptr, RenderNodeCallback);
+        }
+        else
+        {
+            // Instances are not sorted
+            for (const auto& node : GLTFModel.Nodes)
+            {
+                RenderGLTFNode(pCtx, node.get(), pSelection, GLTF::Material::ALPHAMODE_BLEND, GLTFModel.IndexType, RenderParams, RenderNodeCallback, SRBTypeId, NumInstances);
+            }
+        }
+    }
+}
+
+void GLTF_PBR_Renderer::AddTransparentPrimitives(TransparentPrimitiveQueue& Queue,
+                                                 const GLTF::Model&         GLTFModel,
+                                                 const PrimitiveSelection*  pSelection,
+                                                 const RenderInfo&          RenderParams,
+                                                 size_t                     SRBTypeId)
+{
+    const auto SubmissionId = static_cast<Uint32>(Queue.Submissions.size());
+    const auto NumItems     = Queue.Items.size();
+    for (const auto* pNode : GLTFModel.LinearNodes)
+    {
+        if (!pNode->_Mesh)
+            continue;
+
+        for (const auto& pPrimitive : pNode->_Mesh->Primitives)
+        {
+            const auto& Selection = pSelection[pPrimitive->Index];
+            if (pPrimitive->material.AlphaMode != GLTF::Material::ALPHAMODE_BLEND || !Selection.IsVisible)
+                continue;
+
+            Queue.Items.emplace_back();
+            auto& Item        = Queue.Items.back();
+            Item.pNode        = pNode;
+            Item.pPrimitive   = pPrimitive.get();
+            Item.SubmissionId = SubmissionId;
+            Item.LOD          = Selection.LOD;
+        }
+    }
+
+    if (Queue.Items.size() > NumItems)
+    {
+        Queue.Submissions.emplace_back();
+        auto& Submission        = Queue.Submissions.back();
+        Submission.pModel       = &GLTFModel;
+        Submission.RenderParams = RenderParams;
+        Submission.SRBTypeId    = SRBTypeId;
+    }
+}
+
+void GLTF_PBR_Renderer::SortTransparentPrimitives(TransparentPrimitiveQueue& Queue)
+{
+    const auto Count = Queue.Items.size();
+
+    m_SortDepths.resize(Count);
+    for (size_t i = 0; i < Count; ++i)
+    {
+        const auto& Item       = Queue.Items[i];
+        const auto& Submission = Queue.Submissions[Item.SubmissionId];
+        const auto  Transform  = Item.pNode->_Mesh->Transforms.matrix * Submission.RenderParams.ModelTransform;
+        m_SortDepths[i]        = GetPrimitiveViewDepth(*Item.pPrimitive, Transform, Submission.RenderParams.CameraPosition,
+                                                       Submission.RenderParams.CameraViewDir);
+    }
+    ComputeBackToFrontSortKeys(m_SortDepths, m_SortKeys);
+
+    if (Queue.Items == Queue.PrevItems)
+    {
+        // The same primitives were sorted last time. If the camera barely moved, the previous
+        // order is still valid and the sort can be skipped.
+        Queue.Order.swap(Queue.PrevOrder);
+
+        bool IsSorted = true;
+        for (size_t i = 1; i < Count && IsSorted; ++i)
+            IsSorted = m_SortKeys[Queue.Order[i - 1]] <= m_SortKeys[Queue.Order[i]];
+        if (IsSorted)
+        {
+            Queue.PrevOrder = Queue.Order;
+            return;
+        }
+        // Start from the previous order, so that primitives with equal keys keep their relative
+        // order and do not flicker.
+    }
+    else
+    {
+        Queue.Order.resize(Count);
+        for (Uint32 i = 0; i < Count; ++i)
+            Queue.Order[i] = i;
+        Queue.PrevItems = Queue.Items;
+    }
+
+    // Reorder the keys to match the initial order
+    m_SortTmpKeys.resize(Count);
+    for (size_t i = 0; i < Count; ++i)
+        m_SortTmpKeys[i] = m_SortKeys[Queue.Order[i]];
+    m_SortKeys.swap(m_SortTmpKeys);
+
+    m_SortTmpOrder.resize(Count);
+    RadixSort(m_SortKeys.data(), Queue.Order.data(), Count, m_SortTmpKeys.data(), m_SortTmpOrder.data());
+
+    Queue.PrevOrder = Queue.Order;
+}
+
+void GLTF_PBR_Renderer::RenderTransparentPrimitives(IDeviceContext*                                       pCtx,
+                                                    TransparentPrimitiveQueue&                            Queue,
+                                                    const GLTF::Model*                                    pBoundModel,
+                                                    const std::function<void(const GLTFNodeRenderInfo&)>& RenderNodeCallback)
+{
+    SortTransparentPrimitives(Queue);
+
+    Uint32 CurrSubmissionId = ~0u;
+    for (auto ItemIdx : Queue.Order)
+    {
+        const auto& Item       = Queue.Items[ItemIdx];
+        const auto& Submission = Queue.Submissions[Item.SubmissionId];
+        if (Item.SubmissionId != CurrSubmissionId)
+        {
+            CurrSubmissionId = Item.SubmissionId;
+            // Models placed in the same geometry pool share the buffers
+            if (RenderNodeCallback == nullptr && (pBoundModel == nullptr || !Submission.pModel->SharesBuffersWith(*pBoundModel)))
+            {
+                BindModelBuffers(pCtx, *Submission.pModel);
+                pBoundModel = Submission.pModel;
+            }
+        }
+
+        RenderPrimitive(pCtx, Item.pNode, Item.pPrimitive, Item.LOD, Submission.pModel->IndexType, Submission.RenderParams, RenderNodeCallback, Submission.SRBTypeId, 0);
+    }
+
+    Queue.Submissions.clear();
+    Queue.Items.clear();
+}
+
+void GLTF_PBR_Renderer::QueueTransparentPrimitives(GLTF::Model&      GLTFModel,
+                                                   const RenderInfo& RenderParams,
+                                                   size_t            SRBTypeId)
+{
+    if (m_Settings.UseStructuredBuffers)
+    {
+        LOG_ERROR_MESSAGE("Transparent primitive queue is not available when structured buffers are used");
+        return;
+    }
+
+    if (!CheckVertexLayout(GLTFModel))
+        return;
+
+    const auto* pSelection = CullAndSelectLODs(GLTFModel, RenderParams);
+    AddTransparentPrimitives(m_TransparentQueue, GLTFModel, pSelection, RenderParams, SRBTypeId);
+}
+
+void GLTF_PBR_Renderer::RenderTransparentPrimitives(IDeviceContext* pCtx)
+{
+    RenderTransparentPrimitives(pCtx, m_TransparentQueue, nullptr, nullptr);
+}
+
+void GLTF_PBR_Renderer::RenderParallelChunk(IDeviceContext* pCtx, size_t FirstDraw, size_t EndDraw)
+{
+    const GLTF::Model* pBoundModel = nullptr;
+    for (size_t i = FirstDraw; i < EndDraw; ++i)
+    {
+        const auto& Item       = m_ParallelDraws[i];
+        const auto& Submission = m_ParallelSubmissions[Item.SubmissionId];
+        if (pBoundModel == nullptr || !Submission.pModel->SharesBuffersWith(*pBoundModel))
+        {
+            BindModelBuffers(pCtx, *Submission.pModel);
+            pBoundModel = Submission.pModel;
+        }
+
+        RenderPrimitive(pCtx, Item.pNode, Item.pPrimitive, Item.LOD, Submission.pModel->IndexType, Submission.RenderParams, nullptr, Submission.SRBTypeId, 0);
+    }
+}
+
+void GLTF_PBR_Renderer::RenderParallel(IDeviceContext*              pCtx,
+                                       const ParallelRenderItem*    pItems,
+                                       Uint32                       NumItems,
+                                       const ParallelRenderAttribs& Attribs)
+{
+    if (m_Settings.UseStructuredBuffers)
+    {
+        LOG_ERROR_MESSAGE("Parallel rendering is not available when structured buffers are used");
+        return;
+    }
+
+    VERIFY_EXPR(pItems != nullptr || NumItems == 0);
+    VERIFY_EXPR(Attribs.ppDeferredContexts != nullptr || Attribs.NumDeferredContexts == 0);
+
+    // Culling and LOD selection are performed by this thread
+    m_ParallelSubmissions.clear();
+    m_ParallelDraws.clear();
+    for (Uint32 i = 0; i < NumItems; ++i)
+    {
+        const auto& RenderItem = pItems[i];
+        VERIFY_EXPR(RenderItem.pModel != nullptr);
+        auto& GLTFModel = *RenderItem.pModel;
+        if (!CheckVertexLayout(GLTFModel))
+            continue;
+
+        const auto& RenderParams = RenderItem.RenderParams;
+        const auto* pSelection   = CullAndSelectLODs(GLTFModel, RenderParams);
+
+        const auto SubmissionId = static_cast<Uint32>(m_ParallelSubmissions.size());
+        m_ParallelSubmissions.emplace_back();
+        auto& Submission        = m_ParallelSubmissions.back();
+        Submission.pModel       = &GLTFModel;
+        Submission.RenderParams = RenderParams;
+        Submission.SRBTypeId    = RenderItem.SRBTypeId;
+
+        for (const auto* pNode : GLTFModel.LinearNodes)
+        {
+            if (!pNode->_Mesh)
+                continue;
+
+            for (const auto& pPrimitive : pNode->_Mesh->Primitives)
+            {
+                const auto  AlphaMode = pPrimitive->material.AlphaMode;
+                const auto& Selection = pSelection[pPrimitive->Index];
+                if (AlphaMode == GLTF::Material::ALPHAMODE_BLEND || (RenderParams.AlphaModes & (1u << AlphaMode)) == 0 || !Selection.IsVisible)
+                    continue;
+
+                m_ParallelDraws.emplace_back();
+                auto& Item        = m_ParallelDraws.back();
+                Item.pNode        = pNode;
+                Item.pPrimitive   = pPrimitive.get();
+                Item.SubmissionId = SubmissionId;
+                Item.LOD          = Selection.LOD;
+            }
+        }
+
+        if (RenderParams.AlphaModes & RenderInfo::ALPHA_MODE_FLAG_BLEND)
+            AddTransparentPrimitives(m_ParallelTransparentQueue, GLTFModel, pSelection, RenderParams, RenderItem.SRBTypeId);
+    }
+
+    // Render masked primitives after all opaque ones
+    std::stable_sort(m_ParallelDraws.begin(), m_ParallelDraws.end(),
+                     [](const TransparentPrimitiveQueue::Item& Item0, const TransparentPrimitiveQueue::Item& Item1) {
+                         return Item0.pPrimitive->material.AlphaMode < Item1.pPrimitive->material.AlphaMode;
+                     });
+
+    // Append alpha-blended primitives of all models sorted back to front
+    {
+        auto& Queue = m_ParallelTransparentQueue;
+        SortTransparentPrimitives(Queue);
+
+        const auto FirstSubmissionId = static_cast<Uint32>(m_ParallelSubmissions.size());
+        m_ParallelSubmissions.insert(m_ParallelSubmissions.end(), Queue.Submissions.begin(), Queue.Submissions.end());
+        for (auto ItemIdx : Queue.Order)
+        {
+            m_ParallelDraws.push_back(Queue.Items[ItemIdx]);
+            m_ParallelDraws.back().SubmissionId += FirstSubmissionId;
+        }
+
+        Queue.Submissions.clear();
+        Queue.Items.clear();
+    }
+
+    const auto NumDraws = m_ParallelDraws.size();
+    if (NumDraws == 0)
+        return;
+
+    // Split the draw list into contiguous chunks. The first chunk is recorded into the immediate context.
+    const size_t MinDrawsPerChunk = std::max(Attribs.MinDrawsPerChunk, 1u);
+    const size_t NumChunks        = std::min(size_t{Attribs.NumDeferredContexts} + 1, (NumDraws + MinDrawsPerChunk - 1) / MinDrawsPerChunk);
+    const auto   GetChunkStart    = [NumDraws, NumChunks](size_t Chunk) {
+        return NumDraws * Chunk / NumChunks;
+    };
+
+    // Chunks are recorded by the thread pool. The calling thread blocks until all chunks are
+    // recorded, so the immediate context is never used by two threads at the same time.
+    auto& Pool = Attribs.pThreadPool != nullptr ? *Attribs.pThreadPool : ThreadPool::GetShared();
+
+    std::vector<RefCntAutoPtr<ICommandList>> CmdLists(NumChunks - 1);
+    Pool.ParallelFor(static_cast<Uint32>(NumChunks),
+                     [&](Uint32 Chunk) //
+                     {
+                         if (Chunk == 0)
+                         {
+                             RenderParallelChunk(pCtx, 0, GetChunkStart(1));
+                             return;
+                         }
+
+                         auto* pDeferredCtx = Attribs.ppDeferredContexts[Chunk - 1];
+                         VERIFY_EXPR(pDeferredCtx != nullptr);
+
+                         // Deferred contexts start in default state. Render targets must already be in correct states.
+                         pDeferredCtx->SetRenderTargets(Attribs.NumRenderTargets, Attribs.ppRTVs, Attribs.pDSV, RESOURCE_STATE_TRANSITION_MODE_VERIFY);
+                         RenderParallelChunk(pDeferredCtx, GetChunkStart(Chunk), GetChunkStart(Chunk + 1));
+                         pDeferredCtx->FinishCommandList(&CmdLists[Chunk - 1]);
+                     });
+
+    // Execute command lists in order
+    for (auto& pCmdList : CmdLists)
+        pCtx->ExecuteCommandList(pCmdList);
+}
+
+void GLTF_PBR_Renderer::Render(IDeviceContext*                                pCtx,
+                               GLTF::Model&                                   GLTFModel,
+                               const RenderInfo&                              RenderParams,
+                               std::function<void(const GLTFNodeRenderInfo&)> RenderNodeCallback,
+                               size_t                                         SRBTypeId)
+{
+    if (!CheckVertexLayout(GLTFModel))
+        return;
+
+    const auto* pSelection = CullAndSelectLODs(GLTFModel, RenderParams);
+
+    if (RenderNodeCallback == nullptr)
+    {
+        BindModelBuffers(pCtx, GLTFModel);
+    }
+    else
+    {
+        // An application should bind index buffers and PSOs
+    }
+
+    if (m_Settings.UseStructuredBuffers && RenderNodeCallback == nullptr)
+    {
+        RenderWithStructuredBuffers(pCtx, GLTFModel, pSelection, RenderParams, SRBTypeId);
+        return;
+    }
+
+    RenderAlphaModes(pCtx, GLTFModel, pSelection, RenderParams, RenderNodeCallback, SRBTypeId, 0);
+}
+
+void GLTF_PBR_Renderer::RenderInstanced(IDeviceContext*   pCtx,
+                                        GLTF::Model&      GLTFModel,
+                                        const RenderInfo& RenderParams,
+                                        const float4x4*   pInstanceTransforms,
+                                        Uint32            NumInstances,
+                                        size_t            SRBTypeId)
+{
+    if (!m_Settings.AllowInstancing || m_Settings.UseStructuredBuffers)
+    {
+        LOG_ERROR_MESSAGE("Instanced rendering requires GLTF_PBR_Renderer::CreateInfo::AllowInstancing to be enabled and UseStructuredBuffers to be disabled");
+        return;
+    }
+
+    if (NumInstances == 0)
+        return;
+
+    VERIFY_EXPR(pInstanceTransforms != nullptr);
+
+    if (!CheckVertexLayout(GLTFModel))
+        return;
+
+    // Select levels of detail for the instance closest to the camera
+    const PrimitiveSelection* pSelection = nullptr;
+    {
+        Uint32 ClosestInstance = 0;
+        float  MinDistSq       = std::numeric_limits<float>::max();
+        for (Uint32 i = 0; i < NumInstances; ++i)
+        {
+            const auto Offset = float3::MakeVector(pInstanceTransforms[i][3]) - RenderParams.CameraPosition;
+            const auto DistSq = dot(Offset, Offset);
+            if (DistSq < MinDistSq)
+            {
+                MinDistSq       = DistSq;
+                ClosestInstance = i;
+            }
+        }
+        auto LODParams           = RenderParams;
+        LODParams.ModelTransform = RenderParams.ModelTransform * pInstanceTransforms[ClosestInstance];
+        // Primitives are shared by all instances and can't be culled per instance
+        LODParams.FrustumCulling = false;
+        LODParams.MinPixelSize   = 0;
+        pSelection = CullAndSelectLODs(GLTFModel, LODParams);
+    }
+
+    const Uint32 DataSize = NumInstances * sizeof(float4x4);
+    if (!m_InstanceTransformsBuffer || m_InstanceTransformsBuffer->GetDesc().uiSizeInBytes < DataSize)
+    {
+        // Grow the buffer geometrically to avoid recreating it every time a few instances are added
+        const Uint32 BufferSize = std::max(DataSize, m_InstanceTransformsBuffer ? m_InstanceTransformsBuffer->GetDesc().uiSizeInBytes * 2 : Uint32{0});
+
+        BufferDesc BuffDesc;
+        BuffDesc.Name           = "GLTF instance transforms buffer";
+        BuffDesc.Usage          = USAGE_DYNAMIC;
+        BuffDesc.BindFlags      = BIND_VERTEX_BUFFER;
+        BuffDesc.CPUAccessFlags = CPU_ACCESS_WRITE;
+        BuffDesc.uiSizeInBytes  = BufferSize;
+        m_InstanceTransformsBuffer.Release();
+        m_pDevice->CreateBuffer(BuffDesc, nullptr, &m_InstanceTransformsBuffer);
+    }
+
+    {
+        MapHelper<float4x4> pInstanceData{pCtx, m_InstanceTransformsBuffer, MAP_WRITE, MAP_FLAG_DISCARD};
+        memcpy(pInstanceData, pInstanceTransforms, DataSize);
+    }
+
+    BindModelBuffers(pCtx, GLTFModel);
+
+    IBuffer* pInstanceVB[] = {m_InstanceTransformsBuffer};
+    Uint32   Offsets[]     = {0};
+    pCtx->SetVertexBuffers(3, _countof(pInstanceVB), pInstanceVB, Offsets, RESOURCE_STATE_TRANSITION_MODE_VERIFY, SET_VERTEX_BUFFERS_FLAG_NONE);
+
+    RenderAlphaModes(pCtx, GLTFModel, pSelection, RenderParams, nullptr, SRBTypeId, NumInstances);
+}
+
+void GLTF_PBR_Renderer::CreateIndirectDrawResources(IRenderDevice* pDevice)
+{
+    static constexpr Uint32 ThreadGroupSize = 64;
+
+    CreateUniformBuffer(pDevice, sizeof(GLTFIndirectCullingAttribs), "GLTF indirect culling attribs CB", &m_IndirectCullingAttribsCB);
+
+    ShaderCreateInfo ShaderCI;
+    ShaderCI.SourceLanguage             = SHADER_SOURCE_LANGUAGE_HLSL;
+    ShaderCI.UseCombinedTextureSamplers = true;
+    ShaderCI.pShaderSourceStreamFactory = &DiligentFXShaderSourceStreamFactory::GetInstance();
+
+    ShaderMacroHelper Macros;
+    Macros.AddShaderMacro("THREAD_GROUP_SIZE", static_cast<int>(ThreadGroupSize));
+    ShaderCI.Macros = Macros;
+
+    RefCntAutoPtr<IShader> pCS;
+    {
+        ShaderCI.Desc.ShaderType = SHADER_TYPE_COMPUTE;
+        ShaderCI.EntryPoint      = "main";
+        ShaderCI.Desc.Name       = "Cull GLTF indirect draws CS";
+        ShaderCI.FilePath        = "CullIndirectDraws.csh";
+        pDevice->CreateShader(ShaderCI, &pCS);
+    }
+
+    ComputePipelineStateCreateInfo PSOCreateInfo;
+    PipelineStateDesc&             PSODesc = PSOCreateInfo.PSODesc;
+
+    PSODesc.Name = "Cull GLTF indirect draws PSO";
+
+    PSOCreateInfo.pCS = pCS;
+
+    PSODesc.ResourceLayout.DefaultVariableType = SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE;
+    // clang-format off
+    ShaderResourceVariableDesc Vars[] = 
+    {
+        {SHADER_TYPE_COMPUTE, "cbCullingAttribs", SHADER_RESOURCE_VARIABLE_TYPE_STATIC}
+    };
+    // clang-format on
+    PSODesc.ResourceLayout.NumVariables = _countof(Vars);
+    PSODesc.ResourceLayout.Variables    = Vars;
+
+    pDevice->CreateComputePipelineState(PSOCreateInfo, &m_pCullIndirectDrawsPSO);
+    m_pCullIndirectDrawsPSO->GetStaticVariableByName(SHADER_TYPE_COMPUTE, "cbCullingAttribs")->Set(m_IndirectCullingAttribsCB);
+}
+
+void GLTF_PBR_Renderer::InitializeIndirectDraws(IDeviceContext*    pCtx,
+                                                const GLTF::Model& GLTFModel,
+                                                const float4x4&    ModelTransform,
+                                                size_t             SRBTypeId)
+{
+    if (!m_pCullIndirectDrawsPSO)
+    {
+        LOG_ERROR_MESSAGE("Indirect rendering requires GLTF_PBR_Renderer::CreateInfo::AllowIndirectDraws and UseStructuredBuffers to be enabled");
+        return;
+    }
+
+    if (!CheckVertexLayout(GLTFModel))
+        return;
+
+    ReleaseIndirectDraws(GLTFModel);
+
+    std::vector<GLTFNodeShaderTransformRecord> NodeTransforms;
+    std::vector<GLTFMaterialShaderInfo>        MaterialInfos(GLTFModel.Materials.size());
+    for (size_t mat = 0; mat < GLTFModel.Materials.size(); ++mat)
+        WriteMaterialShaderInfo(GLTFModel.Materials[mat], MaterialInfos[mat]);
+
+    // Draw records passed through the per-instance vertex stream: transform id and material id
+    std::vector<uint2> DrawRecords;
+
+    // Draws are grouped into buckets by pipeline state and SRB
+    struct BucketKey
+    {
+        IPipelineState*         pPSO;
+        IShaderResourceBinding* pSRB;
+
+        bool operator==(const BucketKey& RHS) const
+        {
+            return pPSO == RHS.pPSO && pSRB == RHS.pSRB;
+        }
+
+        struct Hasher
+        {
+            size_t operator()(const BucketKey& Key) const
+            {
+                return ComputeHash(Key.pPSO, Key.pSRB);
+            }
+        };
+    };
+    std::vector<IndirectDrawRecord>                          Draws;
+    std::vector<IndirectModelData::Bucket>                   Buckets;
+    std::unordered_map<BucketKey, Uint32, BucketKey::Hasher> BucketIds;
+
+    bool SkippedPrimitives = false;
+    for (const auto* pNode : GLTFModel.LinearNodes)
+    {
+        if (!pNode->_Mesh)
+            continue;
+
+        const auto& Mesh = *pNode->_Mesh;
+        if (Mesh.Transforms.jointcount > 0)
+        {
+            SkippedPrimitives = true;
+            continue;
+        }
+
+        const auto TransformId = static_cast<Uint32>(NodeTransforms.size());
+
+        NodeTransforms.emplace_back();
+        auto& Record         = NodeTransforms.back();
+        Record.NodeMatrix    = Mesh.Transforms.matrix * ModelTransform;
+        Record.JointCount    = 0;
+        Record.FirstJoint    = 0;
+        Record.PositionScale = float4{Mesh.PositionScale, 0};
+        Record.PositionBias  = float4{Mesh.PositionBias, 0};
+
+        for (const auto& pPrimitive : Mesh.Primitives)
+        {
+            const auto& Primitive = *pPrimitive;
+            const auto& Material  = Primitive.material;
+            if (!Primitive.hasIndices || Material.AlphaMode == GLTF::Material::ALPHAMODE_BLEND)
+            {
+                SkippedPrimitives = true;
+                continue;
+            }
+
+            auto* pSRB = GetMaterialSRB(&Material, SRBTypeId);
+            if (pSRB == nullptr)
+            {
+                LOG_ERROR_MESSAGE("Unable to find SRB for GLTF material. Please call GLTF_PBR_Renderer::InitializeResourceBindings()");
+                continue;
+            }
+            auto* pPSO = GetPSO(PSOKey{Material.AlphaMode, Material.DoubleSided});
+
+            auto bucket_it = BucketIds.emplace(BucketKey{pPSO, pSRB}, static_cast<Uint32>(Buckets.size())).first;
+            if (bucket_it->second == Buckets.size())
+            {
+                Buckets.emplace_back();
+                Buckets.back().pPSO = pPSO;
+                Buckets.back().pSRB = pSRB;
+            }
+            auto& Bucket = Buckets[bucket_it->second];
+
+            const auto& LOD = Primitive.LODs[0];
+
+            IndirectDrawRecord Draw;
+            Draw.BoundBoxMin   = Primitive.IsValidBB ? Primitive.BB.Min : float3{-FLT_MAX, -FLT_MAX, -FLT_MAX};
+            Draw.BoundBoxMax   = Primitive.IsValidBB ? Primitive.BB.Max : float3{+FLT_MAX, +FLT_MAX, +FLT_MAX};
+            Draw.TransformId   = TransformId;
+            Draw.BucketId      = bucket_it->second;
+            Draw.NumIndices    = LOD.IndexCount;
+            Draw.FirstIndex    = LOD.FirstIndex;
+            Draw.BaseVertex    = Primitive.BaseVertex;
+            Draw.FirstInstance = static_cast<Uint32>(Draws.size());
+            Draws.push_back(Draw);
+
+            DrawRecords.emplace_back(TransformId, static_cast<Uint32>(&Material - GLTFModel.Materials.data()));
+
+            ++Bucket.NumArgs;
+        }
+    }
+
+    if (SkippedPrimitives)
+        LOG_WARNING_MESSAGE("Non-indexed, alpha-blended and skinned primitives are not rendered by RenderIndirect(). Use Render() to render them.");
+
+    if (Draws.empty())
+        return;
+
+    std::vector<Uint32> InitialCounters(Buckets.size());
+    Uint32              NumArgs = 0;
+    for (size_t i = 0; i < Buckets.size(); ++i)
+    {
+        Buckets[i].FirstArg = NumArgs;
+        InitialCounters[i]  = NumArgs;
+        NumArgs += Buckets[i].NumArgs;
+    }
+
+    auto& ModelData = m_IndirectModels[&GLTFModel];
+
+    auto CreateBuffer = [&](const char* Name, BIND_FLAGS BindFlags, BUFFER_MODE Mode, Uint32 ElementSize, Uint32 NumElements, const void* pData, RefCntAutoPtr<IBuffer>& pBuffer) //
+    {
+        BufferDesc BuffDesc;
+        BuffDesc.Name              = Name;
+        BuffDesc.Usage             = pData != nullptr ? USAGE_IMMUTABLE : USAGE_DEFAULT;
+        BuffDesc.BindFlags         = BindFlags;
+        BuffDesc.Mode              = Mode;
+        BuffDesc.ElementByteStride = ElementSize;
+        BuffDesc.uiSizeInBytes     = ElementSize * NumElements;
+        BufferData InitData{pData, BuffDesc.uiSizeInBytes};
+        m_pDevice->CreateBuffer(BuffDesc, pData != nullptr ? &InitData : nullptr, &pBuffer);
+    };
+
+    // Copied to the draw arguments buffer before culling to clear the slots of culled draws
+    const std::vector<DrawIndexedIndirectArgs> ZeroArgs(NumArgs);
+
+    const auto NumDraws = static_cast<Uint32>(Draws.size());
+    // clang-format off
+    const auto NumTransforms = static_cast<Uint32>(NodeTransforms.size());
+    const auto NumMaterials  = static_cast<Uint32>(MaterialInfos.size());
+    const auto NumBuckets    = static_cast<Uint32>(Buckets.size());
+    CreateBuffer("GLTF indirect node transforms",  BIND_SHADER_RESOURCE,  BUFFER_MODE_STRUCTURED, sizeof(GLTFNodeShaderTransformRecord), NumTransforms, NodeTransforms.data(),  ModelData.pNodeTransforms);
+    CreateBuffer("GLTF indirect materials",        BIND_SHADER_RESOURCE,  BUFFER_MODE_STRUCTURED, sizeof(GLTFMaterialShaderInfo),        NumMaterials,  MaterialInfos.data(),   ModelData.pMaterials);
+    CreateBuffer("GLTF indirect draw records",     BIND_VERTEX_BUFFER,    BUFFER_MODE_UNDEFINED,  sizeof(uint2),                         NumDraws,      DrawRecords.data(),     ModelData.pDrawRecords);
+    CreateBuffer("GLTF indirect draws",            BIND_SHADER_RESOURCE,  BUFFER_MODE_STRUCTURED, sizeof(IndirectDrawRecord),            NumDraws,      Draws.data(),           ModelData.pIndirectDraws);
+    CreateBuffer("GLTF indirect initial counters", BIND_NONE,             BUFFER_MODE_UNDEFINED,  sizeof(Uint32),                        NumBuckets,    InitialCounters.data(), ModelData.pInitialCounters);
+    CreateBuffer("GLTF indirect bucket counters",  BIND_UNORDERED_ACCESS, BUFFER_MODE_FORMATTED,  sizeof(Uint32),                        NumBuckets,    nullptr,                ModelData.pBucketCounters);
+    CreateBuffer("GLTF indirect zero args",        BIND_NONE,             BUFFER_MODE_UNDEFINED,  sizeof(Uint32),                        NumArgs * 5,   ZeroArgs.data(),        ModelData.pZeroArgs);
+    CreateBuffer("GLTF indirect draw args",        BIND_UNORDERED_ACCESS | BIND_INDIRECT_DRAW_ARGS,
+                                                                          BUFFER_MODE_FORMATTED,  sizeof(Uint32),                        NumArgs * 5,   nullptr,                ModelData.pDrawArgs);
+    // clang-format on
+
+    auto CreateUAV = [](IBuffer* pBuffer) {
+        BufferViewDesc ViewDesc;
+        ViewDesc.ViewType = BUFFER_VIEW_UNORDERED_ACCESS;
+        ViewDesc.Format   = BufferFormat{VT_UINT32, 1};
+        RefCntAutoPtr<IBufferView> pUAV;
+        pBuffer->CreateView(ViewDesc, &pUAV);
+        return pUAV;
+    };
+
+    m_pCullIndirectDrawsPSO->CreateShaderResourceBinding(&ModelData.pCullSRB, true);
+    // clang-format off
+    ModelData.pCullSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_IndirectDraws")->Set(ModelData.pIndirectDraws->GetDefaultView(BUFFER_VIEW_SHADER_RESOURCE));
+    ModelData.pCullSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_NodeTransforms")->Set(ModelData.pNodeTransforms->GetDefaultView(BUFFER_VIEW_SHADER_RESOURCE));
+    ModelData.pCullSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_BucketCounters")->Set(CreateUAV(ModelData.pBucketCounters));
+    ModelData.pCullSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_DrawArgs")->Set(CreateUAV(ModelData.pDrawArgs));
+    // clang-format on
+
+    // clang-format off
+    StateTransitionDesc Barriers[] = 
+    {
+        {ModelData.pNodeTransforms,  RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_SHADER_RESOURCE | RESOURCE_STATE_COPY_SOURCE, true},
+        {ModelData.pMaterials,       RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_COPY_SOURCE,     true},
+        {ModelData.pDrawRecords,     RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_VERTEX_BUFFER,   true},
+        {ModelData.pIndirectDraws,   RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_SHADER_RESOURCE, true},
+        {ModelData.pInitialCounters, RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_COPY_SOURCE,     true},
+        {ModelData.pZeroArgs,        RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_COPY_SOURCE,     true}
+    };
+    // clang-format on
+    pCtx->TransitionResourceStates(_countof(Barriers), Barriers);
+
+    ModelData.Buckets  = std::move(Buckets);
+    ModelData.NumDraws = NumDraws;
+}
+
+void GLTF_PBR_Renderer::ReleaseIndirectDraws(const GLTF::Model& GLTFModel)
+{
+    m_IndirectModels.erase(&GLTFModel);
+}
+
+void GLTF_PBR_Renderer::RenderIndirect(IDeviceContext*    pCtx,
+                                       const GLTF::Model& GLTFModel,
+                                       const RenderInfo&  RenderParams)
+{
+    auto it = m_IndirectModels.find(&GLTFModel);
+    if (it == m_IndirectModels.end())
+    {
+        // The model has no primitives that can be rendered indirectly, or was not initialized
+        return;
+    }
+    auto& ModelData = it->second;
+
+    // Reset bucket counters and clear draw arguments
+    pCtx->CopyBuffer(ModelData.pInitialCounters, 0, RESOURCE_STATE_TRANSITION_MODE_VERIFY,
+                     ModelData.pBucketCounters, 0, ModelData.pBucketCounters->GetDesc().uiSizeInBytes, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    pCtx->CopyBuffer(ModelData.pZeroArgs, 0, RESOURCE_STATE_TRANSITION_MODE_VERIFY,
+                     ModelData.pDrawArgs, 0, ModelData.pDrawArgs->GetDesc().uiSizeInBytes, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+
+    {
+        MapHelper<GLTFIndirectCullingAttribs> pAttribs{pCtx, m_IndirectCullingAttribsCB, MAP_WRITE, MAP_FLAG_DISCARD};
+        for (Uint32 i = 0; i < ViewFrustum::NUM_PLANES; ++i)
+        {
+            // A plane that every point is in front of disables culling
+            const auto& Plane          = RenderParams.Frustum.GetPlane(static_cast<ViewFrustum::PLANE_IDX>(i));
+            pAttribs->FrustumPlanes[i] = RenderParams.FrustumCulling ? float4{Plane.Normal, Plane.Distance} : float4{0, 0, 0, 1};
+        }
+        pAttribs->NumDraws = ModelData.NumDraws;
+    }
+
+    {
+        static constexpr Uint32 ThreadGroupSize = 64;
+
+        pCtx->SetPipelineState(m_pCullIndirectDrawsPSO);
+        pCtx->CommitShaderResources(ModelData.pCullSRB, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+        DispatchComputeAttribs DispatchAttrs{(ModelData.NumDraws + ThreadGroupSize - 1) / ThreadGroupSize, 1, 1};
+        pCtx->DispatchCompute(DispatchAttrs);
+    }
+
+    // Copy node transforms and materials of the model to the buffers bound to the material SRBs
+    {
+        const auto TransformsSize = ModelData.pNodeTransforms->GetDesc().uiSizeInBytes;
+        const auto MaterialsSize  = ModelData.pMaterials->GetDesc().uiSizeInBytes;
+
+        bool StructuredBuffersRecreated = false;
+        StructuredBuffersRecreated |= ReserveStructuredBuffer(m_NodeTransformsBuffer, TransformsSize);
+        StructuredBuffersRecreated |= ReserveStructuredBuffer(m_MaterialsBuffer, MaterialsSize);
+        if (StructuredBuffersRecreated)
+        {
+            for (auto& srb_it : m_SharedSRBs)
+                BindStructuredBuffers(srb_it.second.pSRB);
+        }
+
+        pCtx->CopyBuffer(ModelData.pNodeTransforms, 0, RESOURCE_STATE_TRANSITION_MODE_TRANSITION,
+                         m_NodeTransformsBuffer, 0, TransformsSize, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+        pCtx->CopyBuffer(ModelData.pMaterials, 0, RESOURCE_STATE_TRANSITION_MODE_VERIFY,
+                         m_MaterialsBuffer, 0, MaterialsSize, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    }
+
+    // clang-format off
+    StateTransitionDesc Barriers[] = 
+    {
+        {ModelData.pDrawArgs,    RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_INDIRECT_ARGUMENT, true},
+        {m_NodeTransformsBuffer, RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_SHADER_RESOURCE,   true},
+        {m_JointMatricesBuffer,  RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_SHADER_RESOURCE,   true},
+        {m_MaterialsBuffer,      RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_SHADER_RESOURCE,   true}
+    };
+    // clang-format on
+    pCtx->TransitionResourceStates(_countof(Barriers), Barriers);
+
+    {
+        MapHelper<GLTFRendererShaderParameters> pRenderParams{pCtx, m_GLTFAttribsCB, MAP_WRITE, MAP_FLAG_DISCARD};
+        WriteRenderParameters(RenderParams, *pRenderParams);
+    }
+
+    BindModelBuffers(pCtx, GLTFModel);
+
+    IBuffer* pDrawRecordsVB[] = {ModelData.pDrawRecords};
+    Uint32   Offsets[]        = {0};
+    pCtx->SetVertexBuffers(2, _countof(pDrawRecordsVB), pDrawRecordsVB, Offsets, RESOURCE_STATE_TRANSITION_MODE_VERIFY, SET_VERTEX_BUFFERS_FLAG_NONE);
+
+    for (auto& Bucket : ModelData.Buckets)
+    {
+        pCtx->SetPipelineState(Bucket.pPSO);
+        pCtx->CommitShaderResources(Bucket.pSRB, RESOURCE_STATE_TRANSITION_MODE_VERIFY);
+
+        // Visible draws of the bucket are packed at the beginning of its range, and the remaining
+        // slots have zero arguments. Without multi-draw indirect support, every slot is a separate draw.
+        for (Uint32 arg = 0; arg < Bucket.NumArgs; ++arg)
         {
-            RenderGLTFNode(pCtx, node.get(), GLTF::Material::ALPHAMODE_BLEND, RenderParams.ModelTransform, RenderNodeCallback, SRBTypeId);
+            DrawIndexedIndirectAttribs DrawAttrs{GLTFModel.IndexType, DRAW_FLAG_VERIFY_ALL, RESOURCE_STATE_TRANSITION_MODE_VERIFY};
+            DrawAttrs.IndirectDrawArgsOffset = (Bucket.FirstArg + arg) * static_cast<Uint32>(sizeof(DrawIndexedIndirectArgs));
+            pCtx->DrawIndexedIndirect(DrawAttrs, ModelData.pDrawArgs);
         }
     }
 }
@@ -0,0 +1,117 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+#include "BasicMath.hpp"
+
+#include "gtest/gtest.h"
+
+using namespace Diligent;
+
+namespace
+{
+
+// Host-side definitions of the HLSL functions used by the shader code under test.
+// float4x4 is indexed as [row][column] both here and in HLSL.
+namespace HLSL
+{
+
+float4x4 MatrixFromRows(const float4& Row0, const float4& Row1, const float4& Row2, const float4& Row3)
+{
+    return float4x4{
+        Row0.x, Row0.y, Row0.z, Row0.w,
+        Row1.x, Row1.y, Row1.z, Row1.w,
+        Row2.x, Row2.y, Row2.z, Row2.w,
+        Row3.x, Row3.y, Row3.z, Row3.w};
+}
+
+float4x4 transpose(const float4x4& m)
+{
+    return m.Transpose();
+}
+
+float4x4 mul(const float4x4& m1, const float4x4& m2)
+{
+    return m1 * m2;
+}
+
+#include "Shaders/GLTF_PBR/public/GLTF_PBR_Instancing.fxh"
+
+} // namespace HLSL
+
+// Transforms the position the same way the vertex shader does when instancing is enabled
+float3 TransformInstancedVertex(const float3& Pos, const float4x4& NodeMatrix, const float4x4& InstanceMatrix)
+{
+    // Host-side matrices are written to the constant buffer as is and are read
+    // as column-major matrices, which transposes them.
+    const auto NodeTransform = NodeMatrix.Transpose();
+
+    // Instance matrix rows are read from the per-instance vertex attributes
+    const auto Transform = HLSL::GLTF_ApplyInstanceTransform(NodeTransform,
+                                                             float4::MakeVector(InstanceMatrix[0]),
+                                                             float4::MakeVector(InstanceMatrix[1]),
+                                                             float4::MakeVector(InstanceMatrix[2]),
+                                                             float4::MakeVector(InstanceMatrix[3]));
+
+    // GLTF_TransformVertex: mul(Transform, float4(Pos, 1.0))
+    const float4 WorldPos = Transform * float4{Pos.x, Pos.y, Pos.z, 1};
+    return float3{WorldPos.x / WorldPos.w, WorldPos.y / WorldPos.w, WorldPos.z / WorldPos.w};
+}
+
+void CheckPosition(const float3& Pos, const float3& RefPos)
+{
+    EXPECT_NEAR(Pos.x, RefPos.x, 1e-5f);
+    EXPECT_NEAR(Pos.y, RefPos.y, 1e-5f);
+    EXPECT_NEAR(Pos.z, RefPos.z, 1e-5f);
+}
+
+TEST(FX_GLTF_PBR_Renderer, InstanceTranslation)
+{
+    const auto NodeMatrix     = float4x4::Scale(2, 2, 2) * float4x4::Translation(1, 0, 0);
+    const auto InstanceMatrix = float4x4::Translation(10, 20, 30);
+
+    // The instance is moved by its translation
+    CheckPosition(TransformInstancedVertex(float3{0, 0, 0}, NodeMatrix, InstanceMatrix), float3{11, 20, 30});
+    CheckPosition(TransformInstancedVertex(float3{1, 1, 1}, NodeMatrix, InstanceMatrix), float3{13, 22, 32});
+
+    // Identity instance transform does not change the node transform
+    CheckPosition(TransformInstancedVertex(float3{1, 1, 1}, NodeMatrix, float4x4::Identity()), float3{3, 2, 2});
+}
+
+TEST(FX_GLTF_PBR_Renderer, InstanceTransformOrder)
+{
+    // The node is moved away from the origin, and the instance rotates it around the origin
+    // and then moves it. The instance transform must be applied after the node transform.
+    const auto NodeMatrix     = float4x4::Translation(1, 0, 0);
+    const auto InstanceMatrix = float4x4::RotationZ(PI_F / 2) * float4x4::Translation(0, 0, 5);
+
+    const float3 Pos{1, 0, 0};
+    const auto   RefPos = Pos * NodeMatrix * InstanceMatrix;
+    CheckPosition(TransformInstancedVertex(Pos, NodeMatrix, InstanceMatrix), RefPos);
+    CheckPosition(RefPos, float3{0, 2, 5});
+}
+
+} // namespace
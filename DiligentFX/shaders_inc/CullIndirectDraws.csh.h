@@ -0,0 +1,76 @@
+"#include \"GLTF_PBR_Structures.fxh\"\n"
+"\n"
+"#ifndef THREAD_GROUP_SIZE\n"
+"#   define THREAD_GROUP_SIZE 64\n"
+"#endif\n"
+"\n"
+"// Must match the layout of Diligent::IndirectDrawRecord (see IndirectDrawCulling.hpp)\n"
+"struct IndirectDrawRecord\n"
+"{\n"
+"    float3 BoundBoxMin;\n"
+"    uint   TransformId;\n"
+"    float3 BoundBoxMax;\n"
+"    uint   BucketId;\n"
+"\n"
+"    uint   NumIndices;\n"
+"    uint   FirstIndex;\n"
+"    uint   BaseVertex;\n"
+"    uint   FirstInstance;\n"
+"};\n"
+"\n"
+"cbuffer cbCullingAttribs\n"
+"{\n"
+"    GLTFIndirectCullingAttribs g_CullingAttribs;\n"
+"}\n"
+"\n"
+"StructuredBuffer<IndirectDrawRecord>            g_IndirectDraws;\n"
+"StructuredBuffer<GLTFNodeShaderTransformRecord> g_NodeTransforms;\n"
+"\n"
+"// Per-bucket append counters. They are initialized with the first argument slot of every bucket.\n"
+"RWBuffer<uint /*format=r32ui*/> g_BucketCounters;\n"
+"\n"
+"// DrawIndexedIndirect arguments, five values per draw\n"
+"RWBuffer<uint /*format=r32ui*/> g_DrawArgs;\n"
+"\n"
+"bool IsTransformedBoxVisible(float3 BoxMin, float3 BoxMax, float4x4 Transform)\n"
+"{\n"
+"    float3 Center  = (BoxMin + BoxMax) * 0.5;\n"
+"    float3 Extents = (BoxMax - BoxMin) * 0.5;\n"
+"\n"
+"    float3   WorldCenter  = mul(Transform, float4(Center, 1.0)).xyz;\n"
+"    float3x3 AbsTransform = float3x3(abs(Transform[0].xyz), abs(Transform[1].xyz), abs(Transform[2].xyz));\n"
+"    float3   WorldExtents = mul(AbsTransform, Extents);\n"
+"\n"
+"    for (int i = 0; i < 6; ++i)\n"
+"    {\n"
+"        float4 Plane  = g_CullingAttribs.FrustumPlanes[i];\n"
+"        float  Dist   = dot(WorldCenter, Plane.xyz) + Plane.w;\n"
+"        float  Radius = dot(WorldExtents, abs(Plane.xyz));\n"
+"        if (Dist + Radius < 0.0)\n"
+"            return false;\n"
+"    }\n"
+"\n"
+"    return true;\n"
+"}\n"
+"\n"
+"[numthreads(THREAD_GROUP_SIZE, 1, 1)]\n"
+"void main(uint3 DTid : SV_DispatchThreadID)\n"
+"{\n"
+"    uint DrawId = DTid.x;\n"
+"    if (DrawId >= g_CullingAttribs.NumDraws)\n"
+"        return;\n"
+"\n"
+"    IndirectDrawRecord Draw = g_IndirectDraws[DrawId];\n"
+"    if (!IsTransformedBoxVisible(Draw.BoundBoxMin, Draw.BoundBoxMax, g_NodeTransforms[Draw.TransformId].NodeMatrix))\n"
+"        return;\n"
+"\n"
+"    uint Slot;\n"
+"    InterlockedAdd(g_BucketCounters[Draw.BucketId], 1u, Slot);\n"
+"\n"
+"    uint Offset = Slot * 5u;\n"
+"    g_DrawArgs[Offset + 0u] = Draw.NumIndices;\n"
+"    g_DrawArgs[Offset + 1u] = 1u;\n"
+"    g_DrawArgs[Offset + 2u] = Draw.FirstIndex;\n"
+"    g_DrawArgs[Offset + 3u] = Draw.BaseVertex;\n"
+"    g_DrawArgs[Offset + 4u] = Draw.FirstInstance;\n"
+"}\n"
@@ -0,0 +1,17 @@
+"#ifndef _GLTF_PBR_INSTANCING_FXH_\n"
+"#define _GLTF_PBR_INSTANCING_FXH_\n"
+"\n"
+"// Applies per-instance world transform to the node transform.\n"
+"// Instance matrices are written to the vertex buffer as is, so Row0..Row3 are the rows of the\n"
+"// host-side matrix that transforms row vectors. The matrix is transposed to match the column-vector\n"
+"// convention of NodeTransform, and is applied after the node transform.\n"
+"float4x4 GLTF_ApplyInstanceTransform(float4x4 NodeTransform,\n"
+"                                     float4   Row0,\n"
+"                                     float4   Row1,\n"
+"                                     float4   Row2,\n"
+"                                     float4   Row3)\n"
+"{\n"
+"    return mul(transpose(MatrixFromRows(Row0, Row1, Row2, Row3)), NodeTransform);\n"
+"}\n"
+"\n"
+"#endif // _GLTF_PBR_INSTANCING_FXH_\n"
@@ -28,11 +28,49 @@
 "    float    Dummy0;\n"
 "    float    Dummy1;\n"
 "    float    Dummy2;\n"
+"\n"
+"#if defined(GLTF_PBR_COMPACT_VERTEX_LAYOUT) && GLTF_PBR_COMPACT_VERTEX_LAYOUT\n"
+"    // Only present with the compact vertex layout. The host writes\n"
+"    // GLTFNodePositionDequantization right after the structure.\n"
+"    float4   PositionScale;\n"
+"    float4   PositionBias;\n"
+"#endif\n"
 "};\n"
 "#ifdef CHECK_STRUCT_ALIGNMENT\n"
 "	CHECK_STRUCT_ALIGNMENT(GLTFNodeShaderTransforms);\n"
 "#endif\n"
 "\n"
+"// Position dequantization parameters for the compact vertex layout:\n"
+"// Pos = QuantizedPos * PositionScale + PositionBias\n"
+"struct GLTFNodePositionDequantization\n"
+"{\n"
+"    float4   PositionScale;\n"
+"    float4   PositionBias;\n"
+"};\n"
+"#ifdef CHECK_STRUCT_ALIGNMENT\n"
+"	CHECK_STRUCT_ALIGNMENT(GLTFNodePositionDequantization);\n"
+"#endif\n"
+"\n"
+"\n"
+"// Per-node transform record used when the renderer uploads all transforms of a model\n"
+"// into a structured buffer. Joint matrices of all nodes are stored in a separate buffer,\n"
+"// and the node\'s palette starts at FirstJoint.\n"
+"struct GLTFNodeShaderTransformRecord\n"
+"{\n"
+"    float4x4 NodeMatrix;\n"
+"\n"
+"    int      JointCount;\n"
+"    int      FirstJoint;\n"
+"    float    Dummy0;\n"
+"    float    Dummy1;\n"
+"\n"
+"    float4   PositionScale;\n"
+"    float4   PositionBias;\n"
+"};\n"
+"#ifdef CHECK_STRUCT_ALIGNMENT\n"
+"	CHECK_STRUCT_ALIGNMENT(GLTFNodeShaderTransformRecord);\n"
+"#endif\n"
+"\n"
 "\n"
 "struct GLTFRendererShaderParameters\n"
 "{\n"
@@ -75,4 +113,19 @@
 "	CHECK_STRUCT_ALIGNMENT(GLTFMaterialShaderInfo);\n"
 "#endif\n"
 "\n"
+"// Attributes of the compute pass that culls indirect draws of static models\n"
+"struct GLTFIndirectCullingAttribs\n"
+"{\n"
+"    // World-space frustum planes: a point is inside when dot(Plane.xyz, Pos) + Plane.w >= 0\n"
+"    float4 FrustumPlanes[6];\n"
+"\n"
+"    uint   NumDraws;\n"
+"    uint   Dummy0;\n"
+"    uint   Dummy1;\n"
+"    uint   Dummy2;\n"
+"};\n"
+"#ifdef CHECK_STRUCT_ALIGNMENT\n"
+"	CHECK_STRUCT_ALIGNMENT(GLTFIndirectCullingAttribs);\n"
+"#endif\n"
+"\n"
 "#endif // _GLTF_PBR_STRUCTURES_FXH_\n"
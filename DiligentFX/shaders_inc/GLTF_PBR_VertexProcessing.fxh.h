@@ -22,6 +22,17 @@
 "    return adjugate / det;\n"
 "}\n"
 "\n"
+"// Decodes octahedral-encoded unit vector, see\n"
+"// \"A Survey of Efficient Representations for Independent Unit Vectors\" (Cigolle et al. 2014)\n"
+"float3 GLTF_DecodeOctahedralNormal(float2 f)\n"
+"{\n"
+"    float3 n = float3(f.x, f.y, 1.0 - abs(f.x) - abs(f.y));\n"
+"    float  t = max(-n.z, 0.0);\n"
+"    n.x += n.x >= 0.0 ? -t : t;\n"
+"    n.y += n.y >= 0.0 ? -t : t;\n"
+"    return normalize(n);\n"
+"}\n"
+"\n"
 "GLTF_TransformedVertex GLTF_TransformVertex(in float3    Pos,\n"
 "                                            in float3    Normal,\n"
 "                                            in float4x4  Transform)\n"
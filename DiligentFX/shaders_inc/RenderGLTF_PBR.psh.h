@@ -10,6 +10,10 @@
 "#   define ALLOW_DEBUG_VIEW 0\n"
 "#endif\n"
 "\n"
+"#ifndef GLTF_PBR_USE_STRUCTURED_BUFFERS\n"
+"#   define GLTF_PBR_USE_STRUCTURED_BUFFERS 0\n"
+"#endif\n"
+"\n"
 "cbuffer cbCameraAttribs\n"
 "{\n"
 "    CameraAttribs g_CameraAttribs;\n"
@@ -20,11 +24,22 @@
 "    LightAttribs g_LightAttribs;\n"
 "}\n"
 "\n"
+"#if GLTF_PBR_USE_STRUCTURED_BUFFERS\n"
+"cbuffer cbGLTFAttribs\n"
+"{\n"
+"    GLTFRendererShaderParameters g_RenderParameters;\n"
+"}\n"
+"\n"
+"StructuredBuffer<GLTFMaterialShaderInfo> g_Materials;\n"
+"// Material index is passed from the vertex shader\n"
+"#   define g_MaterialInfo g_Materials[MaterialId]\n"
+"#else\n"
 "cbuffer cbGLTFAttribs\n"
 "{\n"
 "    GLTFRendererShaderParameters g_RenderParameters;\n"
 "    GLTFMaterialShaderInfo       g_MaterialInfo;\n"
 "}\n"
+"#endif\n"
 "\n"
 "#if GLTF_PBR_USE_IBL\n"
 "TextureCube  g_IrradianceMap;\n"
@@ -62,6 +77,9 @@
 "          in  float3 Normal      : NORMAL,\n"
 "          in  float2 UV0         : UV0,\n"
 "          in  float2 UV1         : UV1,\n"
+"#if GLTF_PBR_USE_STRUCTURED_BUFFERS\n"
+"          in  nointerpolation uint MaterialId : MATERIAL_ID,\n"
+"#endif\n"
 "          in  bool   IsFrontFace : SV_IsFrontFace,\n"
 "          out float4 OutColor    : SV_TARGET0,\n"
 "          out float  DepthZ      : SV_TARGET1)\n"
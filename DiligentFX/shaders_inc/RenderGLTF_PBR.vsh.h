@@ -1,14 +1,53 @@
 "#include \"BasicStructures.fxh\"\n"
 "#include \"GLTF_PBR_VertexProcessing.fxh\"\n"
+"#include \"GLTF_PBR_Instancing.fxh\"\n"
+"\n"
+"#ifndef GLTF_PBR_COMPACT_VERTEX_LAYOUT\n"
+"#   define GLTF_PBR_COMPACT_VERTEX_LAYOUT 0\n"
+"#endif\n"
+"\n"
+"#ifndef GLTF_PBR_USE_STRUCTURED_BUFFERS\n"
+"#   define GLTF_PBR_USE_STRUCTURED_BUFFERS 0\n"
+"#endif\n"
+"\n"
+"#ifndef GLTF_PBR_USE_DUAL_QUATERNION_SKINNING\n"
+"#   define GLTF_PBR_USE_DUAL_QUATERNION_SKINNING 0\n"
+"#endif\n"
+"\n"
+"#ifndef GLTF_PBR_USE_INSTANCING\n"
+"#   define GLTF_PBR_USE_INSTANCING 0\n"
+"#endif\n"
 "\n"
 "struct GLTF_VS_Input\n"
 "{\n"
+"#if GLTF_PBR_COMPACT_VERTEX_LAYOUT\n"
+"    float4 Pos     : ATTRIB0; // Quantized relative to the mesh bounding box\n"
+"    float2 Normal  : ATTRIB1; // Octahedral-encoded\n"
+"    float2 UV0     : ATTRIB2;\n"
+"    float2 UV1     : ATTRIB3;\n"
+"    uint4  Joint0  : ATTRIB4;\n"
+"    float4 Weight0 : ATTRIB5;\n"
+"#else\n"
 "    float3 Pos     : ATTRIB0;\n"
 "    float3 Normal  : ATTRIB1;\n"
 "    float2 UV0     : ATTRIB2;\n"
 "    float2 UV1     : ATTRIB3;\n"
 "    float4 Joint0  : ATTRIB4;\n"
 "    float4 Weight0 : ATTRIB5;\n"
+"#endif\n"
+"\n"
+"#if GLTF_PBR_USE_STRUCTURED_BUFFERS\n"
+"    // Per-instance draw record: x - node transform index, y - material index\n"
+"    uint2  DrawRecord : ATTRIB6;\n"
+"#endif\n"
+"\n"
+"#if GLTF_PBR_USE_INSTANCING\n"
+"    // Per-instance world transform\n"
+"    float4 InstanceRow0 : ATTRIB7;\n"
+"    float4 InstanceRow1 : ATTRIB8;\n"
+"    float4 InstanceRow2 : ATTRIB9;\n"
+"    float4 InstanceRow3 : ATTRIB10;\n"
+"#endif\n"
 "};\n"
 "\n"
 "cbuffer cbCameraAttribs\n"
@@ -16,18 +55,101 @@
 "    CameraAttribs g_CameraAttribs;\n"
 "}\n"
 "\n"
+"#if GLTF_PBR_USE_STRUCTURED_BUFFERS\n"
+"StructuredBuffer<GLTFNodeShaderTransformRecord> g_NodeTransforms;\n"
+"#   if GLTF_PBR_USE_DUAL_QUATERNION_SKINNING\n"
+"// Two elements per joint: rotation quaternion followed by the dual part\n"
+"StructuredBuffer<float4>                        g_JointMatrices;\n"
+"#   else\n"
+"StructuredBuffer<float4x4>                      g_JointMatrices;\n"
+"#   endif\n"
+"#else\n"
 "cbuffer cbTransforms\n"
 "{\n"
 "    GLTFNodeShaderTransforms g_Transforms;\n"
 "}\n"
-"    \n"
+"#endif\n"
+"\n"
+"#if GLTF_PBR_USE_STRUCTURED_BUFFERS && GLTF_PBR_USE_DUAL_QUATERNION_SKINNING\n"
+"// Converts unit dual quaternion to the rigid transform matrix\n"
+"float4x4 DualQuaternionToMatrix(float4 Real, float4 Dual)\n"
+"{\n"
+"    float3 t = 2.0 * (Real.w * Dual.xyz - Dual.w * Real.xyz + cross(Real.xyz, Dual.xyz));\n"
+"\n"
+"    float x2 = Real.x + Real.x;\n"
+"    float y2 = Real.y + Real.y;\n"
+"    float z2 = Real.z + Real.z;\n"
+"    float xx = Real.x * x2;\n"
+"    float yy = Real.y * y2;\n"
+"    float zz = Real.z * z2;\n"
+"    float xy = Real.x * y2;\n"
+"    float xz = Real.x * z2;\n"
+"    float yz = Real.y * z2;\n"
+"    float wx = Real.w * x2;\n"
+"    float wy = Real.w * y2;\n"
+"    float wz = Real.w * z2;\n"
+"\n"
+"    return MatrixFromRows(float4(1.0 - yy - zz, xy - wz,       xz + wy,       t.x),\n"
+"                          float4(xy + wz,       1.0 - xx - zz, yz - wx,       t.y),\n"
+"                          float4(xz - wy,       yz + wx,       1.0 - xx - yy, t.z),\n"
+"                          float4(0.0,           0.0,           0.0,           1.0));\n"
+"}\n"
+"#endif\n"
+"\n"
 "void main(in  GLTF_VS_Input  VSIn,\n"
 "          out float4 ClipPos  : SV_Position,\n"
 "          out float3 WorldPos : WORLD_POS,\n"
 "          out float3 Normal   : NORMAL,\n"
 "          out float2 UV0      : UV0,\n"
-"          out float2 UV1      : UV1) \n"
+"          out float2 UV1      : UV1\n"
+"#if GLTF_PBR_USE_STRUCTURED_BUFFERS\n"
+"        , out nointerpolation uint MaterialId : MATERIAL_ID\n"
+"#endif\n"
+"          ) \n"
 "{\n"
+"#if GLTF_PBR_USE_STRUCTURED_BUFFERS\n"
+"    GLTFNodeShaderTransformRecord NodeTransforms = g_NodeTransforms[VSIn.DrawRecord.x];\n"
+"    MaterialId = VSIn.DrawRecord.y;\n"
+"\n"
+"    float4x4 Transform = NodeTransforms.NodeMatrix;\n"
+"    if (NodeTransforms.JointCount > 0)\n"
+"    {\n"
+"        // Mesh is skinned\n"
+"        int FirstJoint = NodeTransforms.FirstJoint;\n"
+"#   if GLTF_PBR_USE_DUAL_QUATERNION_SKINNING\n"
+"        int4 Joints = (FirstJoint + int4(VSIn.Joint0)) * 2;\n"
+"        float4 Real0 = g_JointMatrices[Joints.x];\n"
+"        float4 Real1 = g_JointMatrices[Joints.y];\n"
+"        float4 Real2 = g_JointMatrices[Joints.z];\n"
+"        float4 Real3 = g_JointMatrices[Joints.w];\n"
+"        // Flip quaternions that lie in the other hemisphere than the first one\n"
+"        // to interpolate along the shortest path\n"
+"        float4 Weights = VSIn.Weight0 * float4(1.0,\n"
+"                                               sign(dot(Real0, Real1) + 1e-20),\n"
+"                                               sign(dot(Real0, Real2) + 1e-20),\n"
+"                                               sign(dot(Real0, Real3) + 1e-20));\n"
+"        float4 Real = Weights.x * Real0 + Weights.y * Real1 + Weights.z * Real2 + Weights.w * Real3;\n"
+"        float4 Dual =\n"
+"            Weights.x * g_JointMatrices[Joints.x + 1] +\n"
+"            Weights.y * g_JointMatrices[Joints.y + 1] +\n"
+"            Weights.z * g_JointMatrices[Joints.z + 1] +\n"
+"            Weights.w * g_JointMatrices[Joints.w + 1];\n"
+"        float InvLen = 1.0 / length(Real);\n"
+"        Real *= InvLen;\n"
+"        Dual *= InvLen;\n"
+"        Transform = mul(Transform, DualQuaternionToMatrix(Real, Dual));\n"
+"#   else\n"
+"        float4x4 SkinMat = \n"
+"            VSIn.Weight0.x * g_JointMatrices[FirstJoint + int(VSIn.Joint0.x)] +\n"
+"            VSIn.Weight0.y * g_JointMatrices[FirstJoint + int(VSIn.Joint0.y)] +\n"
+"            VSIn.Weight0.z * g_JointMatrices[FirstJoint + int(VSIn.Joint0.z)] +\n"
+"            VSIn.Weight0.w * g_JointMatrices[FirstJoint + int(VSIn.Joint0.w)];\n"
+"        Transform = mul(Transform, SkinMat);\n"
+"#   endif\n"
+"    }\n"
+"    float4 PositionScale = NodeTransforms.PositionScale;\n"
+"    float4 PositionBias  = NodeTransforms.PositionBias;\n"
+"#else\n"
 "    // Warning: moving this block into GLTF_TransformVertex() function causes huge\n"
 "    // performance degradation on Vulkan because glslang/SPIRV-Tools are apparently not able\n"
 "    // to eliminate the copy of g_Transforms structure.\n"
@@ -42,8 +164,23 @@
 "            VSIn.Weight0.w * g_Transforms.JointMatrix[int(VSIn.Joint0.w)];\n"
 "        Transform = mul(Transform, SkinMat);\n"
 "    }\n"
+"#   if GLTF_PBR_COMPACT_VERTEX_LAYOUT\n"
+"    float4 PositionScale = g_Transforms.PositionScale;\n"
+"    float4 PositionBias  = g_Transforms.PositionBias;\n"
+"#   endif\n"
+"#endif\n"
+"\n"
+"#if GLTF_PBR_USE_INSTANCING\n"
+"    Transform = GLTF_ApplyInstanceTransform(Transform, VSIn.InstanceRow0, VSIn.InstanceRow1, VSIn.InstanceRow2, VSIn.InstanceRow3);\n"
+"#endif\n"
 "\n"
+"#if GLTF_PBR_COMPACT_VERTEX_LAYOUT\n"
+"    float3 DecodedPos    = VSIn.Pos.xyz * PositionScale.xyz + PositionBias.xyz;\n"
+"    float3 DecodedNormal = GLTF_DecodeOctahedralNormal(VSIn.Normal);\n"
+"    GLTF_TransformedVertex TransformedVert = GLTF_TransformVertex(DecodedPos, DecodedNormal, Transform);\n"
+"#else\n"
 "    GLTF_TransformedVertex TransformedVert = GLTF_TransformVertex(VSIn.Pos, VSIn.Normal, Transform);\n"
+"#endif\n"
 "\n"
 "    ClipPos  = mul(float4(TransformedVert.WorldPos, 1.0), g_CameraAttribs.mViewProj);\n"
 "    WorldPos = TransformedVert.WorldPos;\n"
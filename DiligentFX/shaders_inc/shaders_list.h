@@ -38,6 +38,10 @@ static const ShaderIncInfo g_Shaders[] =
         "CubemapFace.vsh",
         #include "CubemapFace.vsh.h"
     },
+    {
+        "CullIndirectDraws.csh",
+        #include "CullIndirectDraws.csh.h"
+    },
     {
         "GLTF_PBR_PrecomputeCommon.fxh",
         #include "GLTF_PBR_PrecomputeCommon.fxh.h"
@@ -58,6 +62,10 @@ static const ShaderIncInfo g_Shaders[] =
         "RenderGLTF_PBR.vsh",
         #include "RenderGLTF_PBR.vsh.h"
     },
+    {
+        "GLTF_PBR_Instancing.fxh",
+        #include "GLTF_PBR_Instancing.fxh.h"
+    },
     {
         "GLTF_PBR_Shading.fxh",
         #include "GLTF_PBR_Shading.fxh.h"
@@ -30,6 +30,7 @@
 #include <vector>
 #include <string>
 #include <memory>
+#include <atomic>
 
 #include "NativeAppBase.hpp"
 #include "RefCntAutoPtr.hpp"
@@ -40,6 +41,7 @@
 #include "SampleBase.hpp"
 #include "ScreenCapture.hpp"
 #include "Image.h"
+#include "ImageEncodeQueue.hpp"
 
 namespace Diligent
 {
@@ -144,6 +146,10 @@ protected:
 
     } m_ScreenCaptureInfo;
     std::unique_ptr<ScreenCapture> m_pScreenCapture;
+    // Captured frames are encoded and written to files by worker threads
+    std::unique_ptr<ImageEncodeQueue> m_pEncodeQueue;
+    // Error code set by the worker threads when a capture file can't be written
+    std::atomic<int> m_ScreenCaptureErrorCode{0};
 
     std::unique_ptr<ImGuiImplDiligent> m_pImGui;
 
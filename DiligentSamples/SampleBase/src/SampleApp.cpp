@@ -73,6 +73,8 @@ SampleApp::SampleApp() :
 
 SampleApp::~SampleApp()
 {
+    // Wait until all captured frames are written
+    m_pEncodeQueue.reset();
     m_pImGui.reset();
     m_TheSample.reset();
 
@@ -406,6 +408,7 @@ void SampleApp::InitializeDiligentEngine(const NativeWindow* pWindow)
         }
 
         m_pScreenCapture.reset(new ScreenCapture(m_pDevice));
+        m_pEncodeQueue.reset(new ImageEncodeQueue{ImageEncodeQueue::CreateInfo{}});
     }
 }
 
@@ -911,26 +914,39 @@ void SampleApp::SaveScreenCapture(const std::string& FileName, ScreenCapture::Ca
     Info.FileFormat  = m_ScreenCaptureInfo.FileFormat;
     Info.JpegQuality = m_ScreenCaptureInfo.JpegQuality;
 
-    RefCntAutoPtr<IDataBlob> pEncodedImage;
-    Image::Encode(Info, &pEncodedImage);
+    // The queue copies the pixels, so the staging texture can be unmapped and recycled right away.
+    // If the encoding threads can't keep up, this call waits until one of them finishes a frame.
+    const bool Enqueued = m_pEncodeQueue->Enqueue(
+        Info,
+        [this, FileName](IDataBlob* pEncodedImage) {
+            if (pEncodedImage == nullptr)
+            {
+                LOG_ERROR_MESSAGE("Failed to encode screen capture '", FileName, "'.");
+                m_ScreenCaptureErrorCode = -5;
+                return;
+            }
+
+            FileWrapper pFile(FileName.c_str(), EFileAccessMode::Overwrite);
+            if (pFile)
+            {
+                auto res = pFile->Write(pEncodedImage->GetDataPtr(), pEncodedImage->GetSize());
+                if (!res)
+                {
+                    LOG_ERROR_MESSAGE("Failed to write screen capture file '", FileName, "'.");
+                    m_ScreenCaptureErrorCode = -5;
+                }
+                pFile.Close();
+            }
+            else
+            {
+                LOG_ERROR_MESSAGE("Failed to create screen capture file '", FileName, "'. Verify that the directory exists and the app has sufficient rights to write to this directory.");
+                m_ScreenCaptureErrorCode = -6;
+            }
+        });
     m_pImmediateContext->UnmapTextureSubresource(Capture.pTexture, 0, 0);
 
-    FileWrapper pFile(FileName.c_str(), EFileAccessMode::Overwrite);
-    if (pFile)
-    {
-        auto res = pFile->Write(pEncodedImage->GetDataPtr(), pEncodedImage->GetSize());
-        if (!res)
-        {
-            LOG_ERROR_MESSAGE("Failed to write screen capture file '", FileName, "'.");
-            m_ExitCode = -5;
-        }
-        pFile.Close();
-    }
-    else
-    {
-        LOG_ERROR_MESSAGE("Failed to create screen capture file '", FileName, "'. Verify that the directory exists and the app has sufficient rights to write to this directory.");
-        m_ExitCode = -6;
-    }
+    if (!Enqueued)
+        m_ExitCode = -5;
 }
 
 void SampleApp::Present()
@@ -1000,6 +1016,16 @@ void SampleApp::Present()
 
             m_pScreenCapture->RecycleStagingTexture(std::move(Capture.pTexture));
         }
+
+        if (m_GoldenImgMode != GoldenImageMode::None)
+        {
+            // The app exits after the golden image is processed, so the file must be written now
+            m_pEncodeQueue->WaitForIdle();
+        }
+
+        const auto ScreenCaptureErrorCode = m_ScreenCaptureErrorCode.load();
+        if (ScreenCaptureErrorCode != 0)
+            m_ExitCode = ScreenCaptureErrorCode;
     }
 }
 
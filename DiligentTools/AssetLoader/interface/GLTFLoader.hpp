@@ -31,11 +31,14 @@
 #include <memory>
 #include <cfloat>
 #include <unordered_map>
+#include <limits>
 
 #include "../../../DiligentCore/Graphics/GraphicsEngine/interface/RenderDevice.h"
 #include "../../../DiligentCore/Graphics/GraphicsEngine/interface/DeviceContext.h"
 #include "../../../DiligentCore/Common/interface/RefCntAutoPtr.hpp"
 #include "../../../DiligentCore/Common/interface/AdvancedMath.hpp"
+#include "MeshOptimizer.hpp"
+#include "GeometryPool.hpp"
 
 namespace tinygltf
 {
@@ -114,19 +117,56 @@ struct Primitive
     Material& material;
     bool      hasIndices;
 
+    /// For indexed primitives, the value that is added to every index before reading
+    /// a vertex from the vertex buffer. It is non-zero only when indices are stored
+    /// relative to the primitive (see Model::CreateInfo::UseCompactVertexLayout).
+    /// For non-indexed primitives, the first vertex of the primitive.
+    Uint32 BaseVertex = 0;
+
+    /// Level of detail of an indexed primitive
+    struct LOD
+    {
+        /// First index of the LOD in the index buffer
+        Uint32 FirstIndex = 0;
+
+        /// The number of indices in the LOD
+        Uint32 IndexCount = 0;
+
+        /// Maximum simplification error, in model space units
+        float Error = 0;
+    };
+
+    /// Levels of detail of an indexed primitive, from the finest to the coarsest.
+    /// LODs[0] is always the full-detail mesh defined by FirstIndex and IndexCount.
+    /// Coarser levels reference the same vertices (see Model::CreateInfo::LODCount).
+    /// The list is empty for non-indexed primitives.
+    std::vector<LOD> LODs;
+
+    /// Index of the primitive in the model, from 0 to Model::NumPrimitives - 1.
+    /// Renderers use it to store per-primitive data such as the selected LOD.
+    Uint32 Index = 0;
+
     BoundBox BB;
     bool     IsValidBB = false;
 
     Primitive(Uint32    _FirstIndex,
               Uint32    _IndexCount,
               Uint32    _VertexCount,
-              Material& _material) :
+              Material& _material,
+              Uint32    _BaseVertex = 0) :
         FirstIndex{_FirstIndex},
         IndexCount{_IndexCount},
         VertexCount{_VertexCount},
         material{_material},
-        hasIndices{_IndexCount > 0}
+        hasIndices{_IndexCount > 0},
+        BaseVertex{_BaseVertex}
     {
+        if (hasIndices)
+        {
+            LODs.emplace_back();
+            LODs.back().FirstIndex = FirstIndex;
+            LODs.back().IndexCount = IndexCount;
+        }
     }
 
     void SetBoundingBox(const float3& min, const float3& max)
@@ -149,15 +189,25 @@ struct Mesh
 
     struct TransformData
     {
+        /// The maximum number of joints that fit into a constant buffer.
+        /// Structured buffer palettes are not limited.
         static constexpr Uint32 MaxNumJoints = 128u;
 
-        float4x4 matrix;
-        float4x4 jointMatrix[MaxNumJoints] = {};
-        int      jointcount                = 0;
+        float4x4              matrix;
+        std::vector<float4x4> jointMatrix;
+        /// Dual quaternion palette, two float4 values (real and dual parts) per joint.
+        /// Only computed when SKINNING_PALETTE_FORMAT_DUAL_QUATERNION is requested.
+        std::vector<float4> jointDualQuats;
+        int                 jointcount = 0;
     };
 
     TransformData Transforms;
 
+    /// Position dequantization parameters used by the compact vertex layout:
+    /// Pos = QuantizedPos * PositionScale + PositionBias.
+    float3 PositionScale = float3{1, 1, 1};
+    float3 PositionBias  = float3{0, 0, 0};
+
     Mesh(IRenderDevice* pDevice, const float4x4& matrix);
     void SetBoundingBox(const float3& min, const float3& max);
 };
@@ -182,14 +232,15 @@ struct Node
     std::vector<std::unique_ptr<Node>> Children;
 
     float4x4              Matrix;
+    float4x4              GlobalMatrix; ///< Model-space matrix, updated by Model::UpdateTransforms()
     std::unique_ptr<Mesh> _Mesh;
     Skin*                 _Skin     = nullptr;
     Int32                 SkinIndex = -1;
     float3                Translation;
     float3                Scale = float3(1.0f, 1.0f, 1.0f);
     Quaternion            Rotation;
-    BoundBox              BVH;
-    BoundBox              AABB;
+    BoundBox              BVH;  ///< Bounding volume of the node and all its descendants, in model space
+    BoundBox              AABB; ///< Bounding box of the node's mesh, in model space
     bool                  IsValidBVH = false;
 
     float4x4 LocalMatrix() const;
@@ -252,10 +303,42 @@ struct Model
         float4 weight0;
     };
 
+    /// Vertex attributes 0 in compact layout
+    struct CompactVertexAttribs0
+    {
+        Uint16 pos[4];    ///< Position quantized relative to the mesh bounding box (UNORM16, w is unused)
+        Int16  normal[2]; ///< Octahedral-encoded normal (SNORM16)
+        Uint16 uv0[2];    ///< Texture coordinates set 0 (FLOAT16)
+        Uint16 uv1[2];    ///< Texture coordinates set 1 (FLOAT16)
+    };
+    static_assert(sizeof(CompactVertexAttribs0) == 20, "Unexpected size of CompactVertexAttribs0");
+
+    /// Vertex attributes 1 in compact layout
+    struct CompactVertexAttribs1
+    {
+        Uint16 joint0[4];  ///< Joint indices (UINT16)
+        Uint8  weight0[4]; ///< Joint weights (UNORM8)
+    };
+    static_assert(sizeof(CompactVertexAttribs1) == 12, "Unexpected size of CompactVertexAttribs1");
+
+    /// Vertex and index buffers owned by the model. They are null when the model
+    /// is placed in a geometry pool; use GetVertexBuffer() and GetIndexBuffer() instead.
     RefCntAutoPtr<IBuffer> pVertexBuffer[2];
     RefCntAutoPtr<IBuffer> pIndexBuffer;
     Uint32                 IndexCount = 0;
 
+    /// Index buffer value type, VT_UINT32 or VT_UINT16.
+    VALUE_TYPE IndexType = VT_UINT32;
+
+    /// Indicates if vertex buffers use CompactVertexAttribs0/CompactVertexAttribs1
+    /// layout rather than VertexAttribs0/VertexAttribs1.
+    bool CompactVertexLayout = false;
+
+    /// Post-transform vertex cache statistics of all optimized primitives before and after
+    /// the optimization (see CreateInfo::OptimizeMeshes).
+    VertexCacheStatistics VertexCacheStatsBefore;
+    VertexCacheStatistics VertexCacheStatsAfter;
+
     /// Transformation matrix that transforms unit cube [0,1]x[0,1]x[0,1] into
     /// axis-aligned bounding box in model space.
     float4x4 AABBTransform;
@@ -263,6 +346,9 @@ struct Model
     std::vector<std::unique_ptr<Node>> Nodes;
     std::vector<Node*>                 LinearNodes;
 
+    /// The total number of primitives in all meshes of the model (see Primitive::Index).
+    Uint32 NumPrimitives = 0;
+
     std::vector<std::unique_ptr<Skin>> Skins;
 
     std::vector<RefCntAutoPtr<ITexture>> Textures;
@@ -279,18 +365,150 @@ struct Model
 
     using TextureCacheType = std::unordered_map<std::string, RefCntWeakPtr<ITexture>>;
 
+    /// Model create information
+    struct CreateInfo
+    {
+        /// File name
+        const char* FileName = nullptr;
+
+        /// Optional texture cache to share textures between models
+        TextureCacheType* pTextureCache = nullptr;
+
+        /// Whether to store vertices in the compact layout (CompactVertexAttribs0/CompactVertexAttribs1)
+        /// that uses quantized positions, octahedral normals, half-float texture coordinates and
+        /// 8-bit weights. When all primitives are small enough, 16-bit indices are also used.
+        ///
+        /// \note  The model must be rendered with a renderer that is created with the matching
+        ///        vertex layout.
+        bool UseCompactVertexLayout = false;
+
+        /// Whether to optimize triangle list primitives at load time: reorder triangles
+        /// for post-transform vertex cache efficiency and reduced overdraw, and reorder
+        /// vertices in the order of first use. The resulting statistics are written to
+        /// Model::VertexCacheStatsBefore and Model::VertexCacheStatsAfter.
+        bool OptimizeMeshes = false;
+
+        /// The number of levels of detail to generate for every indexed triangle list
+        /// primitive, including the full-detail level. Coarser levels are generated by
+        /// mesh simplification and stored in the same index buffer (see Primitive::LODs).
+        Uint32 LODCount = 1;
+
+        /// The target ratio of the index count of every LOD to the index count of the previous one.
+        float LODReductionRatio = 0.5f;
+
+        /// Maximum simplification error of the coarsest LOD relative to the primitive size.
+        float LODMaxError = 0.05f;
+
+        /// Optional geometry pool to place vertex and index data to. When the pool is
+        /// given, the model does not create its own buffers and pVertexBuffer/pIndexBuffer
+        /// reference the pool buffers. Primitive base vertices and first indices are offset
+        /// by the location of the model data in the pool.
+        ///
+        /// \note  The pool must use the model vertex layout and must outlive the model.
+        GeometryPool* pGeometryPool = nullptr;
+
+        CreateInfo() = default;
+
+        explicit CreateInfo(const char*       _FileName,
+                            TextureCacheType* _pTextureCache = nullptr) :
+            FileName{_FileName},
+            pTextureCache{_pTextureCache}
+        {}
+    };
+
+    Model(IRenderDevice*    pDevice,
+          IDeviceContext*   pContext,
+          const CreateInfo& CI);
+
     Model(IRenderDevice*     pDevice,
           IDeviceContext*    pContext,
           const std::string& filename,
           TextureCacheType*  pTextureCache = nullptr);
 
-    void UpdateAnimation(Uint32 index, float time);
+    ~Model();
+
+    /// Applies the animation and updates node transforms.
+
+    /// \param [in] index               - Animation index.
+    /// \param [in] time                - Animation time.
+    /// \param [in] UpdateJointMatrices - Whether to compute skinning palettes. Set this to false
+    ///                                   when the palettes are computed by SkinningPaletteJob.
+    void UpdateAnimation(Uint32 index, float time, bool UpdateJointMatrices = true);
+
+    /// Updates model-space matrices of all nodes and, optionally, skinning palettes of all skinned meshes.
+    void UpdateTransforms(bool UpdateJointMatrices = true);
+
+    /// Returns the node with the given glTF node index, or null if the node is not
+    /// part of the loaded scene.
+    Node* GetNodeByIndex(Uint32 Index) const
+    {
+        return Index < NodeIndexMap.size() ? NodeIndexMap[Index] : nullptr;
+    }
+
+    /// Returns the first node with the given name, or null if there is no such node.
+    Node* GetNodeByName(const std::string& Name) const
+    {
+        auto it = NodeNameMap.find(Name);
+        return it != NodeNameMap.end() ? it->second : nullptr;
+    }
+
+    /// Geometry pool the model data are placed in, or null if the model owns its buffers.
+    GeometryPool* GetGeometryPool() const { return pGeometryPool; }
+
+    /// Returns the vertex buffer of the given stream, which is the pool buffer if the model is placed in a geometry pool.
+    IBuffer* GetVertexBuffer(Uint32 Stream) const
+    {
+        return pGeometryPool != nullptr ? pGeometryPool->GetVertexBuffer(Stream) : pVertexBuffer[Stream].RawPtr<IBuffer>();
+    }
+
+    /// Returns the index buffer, which is the pool buffer if the model is placed in a geometry pool.
+    IBuffer* GetIndexBuffer() const
+    {
+        return pGeometryPool != nullptr ? pGeometryPool->GetIndexBuffer() : pIndexBuffer.RawPtr<IBuffer>();
+    }
+
+    /// Returns true if both models are drawn from the same vertex and index buffers.
+    bool SharesBuffersWith(const Model& Other) const
+    {
+        return this == &Other || (pGeometryPool != nullptr && pGeometryPool == Other.pGeometryPool);
+    }
 
 private:
-    void LoadFromFile(IRenderDevice*     pDevice,
-                      IDeviceContext*    pContext,
-                      const std::string& filename,
-                      TextureCacheType*  pTextureCache);
+    void LoadFromFile(IRenderDevice*    pDevice,
+                      IDeviceContext*   pContext,
+                      const CreateInfo& CI);
+
+    void CreateBuffers(IRenderDevice*                     pDevice,
+                       IDeviceContext*                    pContext,
+                       const std::vector<Uint32>&         IndexData,
+                       const std::vector<VertexAttribs0>& VertexData0,
+                       const std::vector<VertexAttribs1>& VertexData1);
+
+    void CreateCompactBuffers(IRenderDevice*                     pDevice,
+                              IDeviceContext*                    pContext,
+                              const std::vector<Uint32>&         IndexData,
+                              const std::vector<VertexAttribs0>& VertexData0,
+                              const std::vector<VertexAttribs1>& VertexData1);
+
+    void InitBuffers(IRenderDevice*             pDevice,
+                     IDeviceContext*            pContext,
+                     const void* const          pVertexData[],
+                     const Uint32               VertexStrides[],
+                     Uint32                     VertexCount,
+                     const std::vector<Uint32>& IndexData);
+
+    void OptimizePrimitive(Uint32*         pIndices,
+                           Uint32          NumIndices,
+                           Uint32          IndexOffset,
+                           VertexAttribs0* pVertexData0,
+                           VertexAttribs1* pVertexData1,
+                           Uint32          VertexCount);
+
+    void GeneratePrimitiveLODs(Primitive&            Prim,
+                               Uint32                IndexOffset,
+                               std::vector<Uint32>&  IndexBuffer,
+                               const VertexAttribs0* pVertexData0,
+                               Uint32                VertexCount);
 
     void LoadNode(IRenderDevice*               pDevice,
                   Node*                        parent,
@@ -309,13 +527,24 @@ private:
                       const std::string&     BaseDir,
                       TextureCacheType*      pTextureCache);
 
-    void  LoadTextureSamplers(IRenderDevice* pDevice, const tinygltf::Model& gltf_model);
-    void  LoadMaterials(const tinygltf::Model& gltf_model);
-    void  LoadAnimations(const tinygltf::Model& gltf_model);
-    void  CalculateBoundingBox(Node* node, const Node* parent);
-    void  GetSceneDimensions();
-    Node* FindNode(Node* parent, Uint32 index);
-    Node* NodeFromIndex(uint32_t index);
+    void LoadTextureSamplers(IRenderDevice* pDevice, const tinygltf::Model& gltf_model);
+    void LoadMaterials(const tinygltf::Model& gltf_model);
+    void LoadAnimations(const tinygltf::Model& gltf_model);
+    void CalculateBoundingBox(Node* node);
+    void GetSceneDimensions();
+
+    // glTF node index -> node
+    std::vector<Node*> NodeIndexMap;
+    // Node name -> first node with this name
+    std::unordered_map<std::string, Node*> NodeNameMap;
+
+    bool   OptimizeMeshes    = false;
+    Uint32 LODCount          = 1;
+    float  LODReductionRatio = 0.5f;
+    float  LODMaxError       = 0.05f;
+
+    GeometryPool*            pGeometryPool = nullptr;
+    GeometryPool::Allocation GeometryAlloc;
 };
 
 } // namespace GLTF
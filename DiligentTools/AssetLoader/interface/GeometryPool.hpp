@@ -0,0 +1,185 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+/// \file
+/// Defines geometry pool that sub-allocates vertex and index ranges from shared buffers
+
+#include <mutex>
+
+#include "../../../DiligentCore/Graphics/GraphicsEngine/interface/RenderDevice.h"
+#include "../../../DiligentCore/Graphics/GraphicsEngine/interface/DeviceContext.h"
+#include "../../../DiligentCore/Graphics/GraphicsAccessories/interface/VariableSizeAllocationsManager.hpp"
+#include "../../../DiligentCore/Common/interface/RefCntAutoPtr.hpp"
+
+namespace Diligent
+{
+
+/// Geometry pool that keeps vertex and index data of multiple meshes in a few large buffers.
+
+/// Every allocation reserves a contiguous range of vertices in every vertex stream and a contiguous
+/// range of indices. Meshes that are placed in the same pool can be drawn without rebinding vertex
+/// and index buffers by using base vertex and first index offsets of their allocations.
+///
+/// If growth is enabled, the pool doubles its capacity when an allocation does not fit. Allocation only
+/// reserves the space; the buffers are recreated and their contents are copied by the next call to
+/// UpdateVertices() or UpdateIndices(), so buffer pointers must be queried after the data is written.
+/// Allocation and deallocation are thread-safe.
+class GeometryPool
+{
+public:
+    static constexpr Uint32 MaxVertexStreams = 4;
+
+    /// Geometry pool create information
+    struct CreateInfo
+    {
+        /// The number of vertex streams
+        Uint32 NumVertexStreams = 0;
+
+        /// Vertex stride, in bytes, of every stream
+        Uint32 VertexStrides[MaxVertexStreams] = {};
+
+        /// Index type, VT_UINT16 or VT_UINT32
+        VALUE_TYPE IndexType = VT_UINT32;
+
+        /// The initial number of vertices in the pool
+        Uint32 VertexCapacity = 0;
+
+        /// The initial number of indices in the pool
+        Uint32 IndexCapacity = 0;
+
+        /// Whether the pool may grow when there is not enough space for an allocation.
+        /// If false, allocations that do not fit fail.
+        bool AllowGrowth = false;
+    };
+
+    GeometryPool(IRenderDevice* pDevice, const CreateInfo& CI);
+
+    // clang-format off
+    GeometryPool           (const GeometryPool&)  = delete;
+    GeometryPool           (      GeometryPool&&) = delete;
+    GeometryPool& operator=(const GeometryPool&)  = delete;
+    GeometryPool& operator=(      GeometryPool&&) = delete;
+    // clang-format on
+
+    ~GeometryPool();
+
+    /// Geometry allocation
+    struct Allocation
+    {
+        /// First vertex of the allocation, which should be used as the base vertex.
+        Uint32 FirstVertex = 0;
+
+        /// The number of vertices in the allocation
+        Uint32 VertexCount = 0;
+
+        /// First index of the allocation
+        Uint32 FirstIndex = 0;
+
+        /// The number of indices in the allocation
+        Uint32 IndexCount = 0;
+
+        bool IsValid() const
+        {
+            return VertexCount > 0 || IndexCount > 0;
+        }
+    };
+
+    /// Allocates vertex and index ranges.
+
+    /// \return     Allocation description. If there is not enough space in the pool,
+    ///             an invalid allocation is returned.
+    Allocation Allocate(Uint32 VertexCount, Uint32 IndexCount);
+
+    /// Releases the allocation.
+    void Free(Allocation&& Alloc);
+
+    /// Writes vertex data of the given stream to the allocation.
+
+    /// \remarks   If the pool has grown since the last update, the buffers are recreated first.
+    void UpdateVertices(IDeviceContext*   pContext,
+                        const Allocation& Alloc,
+                        Uint32            Stream,
+                        const void*       pData);
+
+    /// Writes index data to the allocation. The data must use the pool index type.
+
+    /// \remarks   If the pool has grown since the last update, the buffers are recreated first.
+    void UpdateIndices(IDeviceContext*   pContext,
+                       const Allocation& Alloc,
+                       const void*       pData);
+
+    IBuffer* GetVertexBuffer(Uint32 Stream) const
+    {
+        VERIFY_EXPR(Stream < m_Desc.NumVertexStreams);
+        return m_pVertexBuffers[Stream].RawPtr<IBuffer>();
+    }
+
+    IBuffer* GetIndexBuffer() const
+    {
+        return m_pIndexBuffer.RawPtr<IBuffer>();
+    }
+
+    const CreateInfo& GetDesc() const
+    {
+        return m_Desc;
+    }
+
+    /// Returns the number of vertices and indices currently in use.
+    void GetUsage(Uint32& UsedVertices, Uint32& UsedIndices);
+
+    /// Returns the number of vertices and indices the pool can hold, including the growth
+    /// that has not yet been applied to the buffers.
+    void GetCapacity(Uint32& VertexCapacity, Uint32& IndexCapacity);
+
+private:
+    void CreateVertexBuffer(Uint32 Stream, Uint32 VertexCapacity, RefCntAutoPtr<IBuffer>& pBuffer);
+    void CreateIndexBuffer(Uint32 IndexCapacity, RefCntAutoPtr<IBuffer>& pBuffer);
+
+    // Recreates the buffers if the allocation managers have grown past their size
+    void CommitGrowth(IDeviceContext* pContext);
+
+    const CreateInfo m_Desc;
+
+    RefCntAutoPtr<IRenderDevice> m_pDevice;
+
+    RefCntAutoPtr<IBuffer> m_pVertexBuffers[MaxVertexStreams];
+    RefCntAutoPtr<IBuffer> m_pIndexBuffer;
+
+    // The capacities the buffers were created with
+    Uint32 m_BufferVertexCapacity = 0;
+    Uint32 m_BufferIndexCapacity  = 0;
+
+    // Allocation managers operate in units of vertices and indices rather than bytes.
+    // Methods of VariableSizeAllocationsManager class are not thread safe!
+    std::mutex                     m_AllocationMgrMtx;
+    VariableSizeAllocationsManager m_VertexAllocationsMgr;
+    VariableSizeAllocationsManager m_IndexAllocationsMgr;
+};
+
+} // namespace Diligent
@@ -0,0 +1,225 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+/// \file
+/// Mesh optimization and analysis tools
+
+#include <vector>
+
+#include "../../../DiligentCore/Primitives/interface/BasicTypes.h"
+#include "../../../DiligentCore/Common/interface/BasicMath.hpp"
+
+namespace Diligent
+{
+
+/// Post-transform vertex cache statistics, see AnalyzeVertexCache().
+struct VertexCacheStatistics
+{
+    /// The number of triangles in the index list.
+    Uint32 TriangleCount = 0;
+
+    /// The number of unique vertices referenced by the index list.
+    Uint32 VertexCount = 0;
+
+    /// The number of vertex shader invocations, i.e. post-transform cache misses.
+    Uint32 CacheMissCount = 0;
+
+    /// Average cache miss ratio: the number of cache misses per triangle.
+    /// The value is in [0.5, 3] range for a triangle list, the lower the better.
+    float ACMR = 0;
+
+    /// Average transform to vertex ratio: the number of cache misses per
+    /// referenced vertex. The optimal value is 1.
+    float ATVR = 0;
+
+    /// Accumulates statistics of another index list and recomputes the ratios.
+    VertexCacheStatistics& operator+=(const VertexCacheStatistics& Stats)
+    {
+        TriangleCount += Stats.TriangleCount;
+        VertexCount += Stats.VertexCount;
+        CacheMissCount += Stats.CacheMissCount;
+        ACMR = TriangleCount > 0 ? static_cast<float>(CacheMissCount) / static_cast<float>(TriangleCount) : 0.f;
+        ATVR = VertexCount > 0 ? static_cast<float>(CacheMissCount) / static_cast<float>(VertexCount) : 0.f;
+        return *this;
+    }
+};
+
+/// Vertex fetch statistics, see AnalyzeVertexFetch().
+struct VertexFetchStatistics
+{
+    /// The total number of bytes fetched from the vertex buffer.
+    Uint32 BytesFetched = 0;
+
+    /// The ratio of the fetched bytes to the size of the referenced vertices.
+    /// The optimal value is 1.
+    float Overfetch = 0;
+};
+
+/// Default size of the simulated post-transform vertex cache.
+static constexpr Uint32 DefaultVertexCacheSize = 16;
+
+
+/// Simulates a FIFO post-transform vertex cache and returns statistics for a triangle list.
+
+/// \param [in] pIndices    - Triangle list indices.
+/// \param [in] NumIndices  - The number of indices, must be a multiple of 3.
+/// \param [in] NumVertices - The number of vertices; all indices must be less than this value.
+/// \param [in] CacheSize   - The number of entries in the simulated cache.
+VertexCacheStatistics AnalyzeVertexCache(const Uint32* pIndices,
+                                         size_t        NumIndices,
+                                         Uint32        NumVertices,
+                                         Uint32        CacheSize = DefaultVertexCacheSize);
+
+
+/// Simulates a direct-mapped pre-transform vertex cache and returns statistics for a triangle list.
+
+/// \param [in] pIndices       - Triangle list indices.
+/// \param [in] NumIndices     - The number of indices, must be a multiple of 3.
+/// \param [in] NumVertices    - The number of vertices; all indices must be less than this value.
+/// \param [in] VertexSize     - The size of one vertex, in bytes.
+/// \param [in] CacheLineSize  - The size of one cache line, in bytes.
+/// \param [in] CacheLineCount - The number of lines in the simulated cache.
+VertexFetchStatistics AnalyzeVertexFetch(const Uint32* pIndices,
+                                         size_t        NumIndices,
+                                         Uint32        NumVertices,
+                                         Uint32        VertexSize,
+                                         Uint32        CacheLineSize  = 64,
+                                         Uint32        CacheLineCount = 64);
+
+
+/// Reorders triangles to improve the post-transform vertex cache hit rate.
+
+/// The function implements the Tipsify algorithm (Sander, Nehab, Barczak,
+/// "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw", 2007)
+/// that runs in linear time.
+///
+/// \param [out] pDstIndices - Reordered indices. Must not overlap with pIndices.
+/// \param [in]  pIndices    - Source triangle list indices.
+/// \param [in]  NumIndices  - The number of indices, must be a multiple of 3.
+/// \param [in]  NumVertices - The number of vertices; all indices must be less than this value.
+/// \param [in]  CacheSize   - The target cache size.
+void OptimizeVertexCache(Uint32*       pDstIndices,
+                         const Uint32* pIndices,
+                         size_t        NumIndices,
+                         Uint32        NumVertices,
+                         Uint32        CacheSize = DefaultVertexCacheSize);
+
+
+/// Reorders clusters of triangles to reduce overdraw while preserving vertex cache efficiency.
+
+/// The source indices are expected to be optimized by OptimizeVertexCache(). The triangles
+/// are split into clusters at the points where the cache is flushed or where the local
+/// cache miss ratio does not exceed Threshold times the ratio of the enclosing cluster.
+/// Clusters are then sorted so that those facing away from the mesh center are drawn first.
+///
+/// \param [out] pDstIndices     - Reordered indices. Must not overlap with pIndices.
+/// \param [in]  pIndices        - Source triangle list indices.
+/// \param [in]  NumIndices      - The number of indices, must be a multiple of 3.
+/// \param [in]  pPositions      - Vertex positions.
+/// \param [in]  PositionStride  - The stride between positions, in bytes.
+/// \param [in]  NumVertices     - The number of vertices; all indices must be less than this value.
+/// \param [in]  Threshold       - Allowed cache miss ratio degradation, e.g. 1.05 allows
+///                                ACMR to grow by up to 5%.
+/// \param [in]  CacheSize       - The target cache size.
+void OptimizeOverdraw(Uint32*       pDstIndices,
+                      const Uint32* pIndices,
+                      size_t        NumIndices,
+                      const float3* pPositions,
+                      size_t        PositionStride,
+                      Uint32        NumVertices,
+                      float         Threshold = 1.05f,
+                      Uint32        CacheSize = DefaultVertexCacheSize);
+
+
+/// Computes vertex remap table that makes vertices appear in the order they are first
+/// referenced by the index list, which improves the pre-transform vertex cache efficiency.
+
+/// \param [out] pRemap      - Remap table with NumVertices elements; pRemap[OldIndex] is the new
+///                            location of the vertex. Unreferenced vertices are moved to the end.
+/// \param [in]  pIndices    - Triangle list indices.
+/// \param [in]  NumIndices  - The number of indices.
+/// \param [in]  NumVertices - The number of vertices; all indices must be less than this value.
+///
+/// \return     The number of unique vertices referenced by the index list.
+Uint32 ComputeVertexFetchRemap(Uint32*       pRemap,
+                               const Uint32* pIndices,
+                               size_t        NumIndices,
+                               Uint32        NumVertices);
+
+
+/// Remaps indices in place using the table computed by ComputeVertexFetchRemap().
+void RemapIndices(Uint32*       pIndices,
+                  size_t        NumIndices,
+                  const Uint32* pRemap);
+
+
+/// Simplifies a triangle list using quadric error metrics.
+
+/// The function collapses edges in the order of increasing quadric error (Garland, Heckbert,
+/// "Surface Simplification Using Quadric Error Metrics", 1997) and only produces new
+/// indices: vertices are never moved, so the simplified index list can reference the
+/// original vertex buffer. Vertices on open edges (including texture seams) are never
+/// collapsed, which preserves the mesh borders.
+///
+/// \param [out] pDstIndices      - Simplified indices. Must have room for NumIndices elements.
+/// \param [in]  pIndices         - Source triangle list indices.
+/// \param [in]  NumIndices       - The number of indices, must be a multiple of 3.
+/// \param [in]  pPositions       - Vertex positions.
+/// \param [in]  PositionStride   - The stride between positions, in bytes.
+/// \param [in]  NumVertices      - The number of vertices; all indices must be less than this value.
+/// \param [in]  TargetIndexCount - The desired number of indices. Simplification stops when
+///                                 this number is reached or when the error exceeds TargetError.
+/// \param [in]  TargetError      - The maximum allowed error, in position units.
+/// \param [out] pResultError     - Optional pointer to the memory location where the
+///                                 resulting error, in position units, will be written.
+///
+/// \return     The number of indices in the simplified index list.
+size_t SimplifyMesh(Uint32*       pDstIndices,
+                    const Uint32* pIndices,
+                    size_t        NumIndices,
+                    const float3* pPositions,
+                    size_t        PositionStride,
+                    Uint32        NumVertices,
+                    size_t        TargetIndexCount,
+                    float         TargetError,
+                    float*        pResultError = nullptr);
+
+
+/// Reorders vertices in place using the table computed by ComputeVertexFetchRemap().
+template <typename VertexType>
+void RemapVertices(VertexType*   pVertices,
+                   Uint32        NumVertices,
+                   const Uint32* pRemap)
+{
+    std::vector<VertexType> SrcVertices{pVertices, pVertices + NumVertices};
+    for (Uint32 v = 0; v < NumVertices; ++v)
+        pVertices[pRemap[v]] = SrcVertices[v];
+}
+
+} // namespace Diligent
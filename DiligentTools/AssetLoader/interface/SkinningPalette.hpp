@@ -0,0 +1,149 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+/// \file
+/// Skinning palette computation
+
+#include <vector>
+
+#include "../../../DiligentCore/Primitives/interface/BasicTypes.h"
+#include "../../../DiligentCore/Common/interface/BasicMath.hpp"
+
+namespace Diligent
+{
+
+class ThreadPool;
+
+/// Computes joint matrices of a skinned mesh.
+
+/// \param [in]  pInverseBindMatrices - Inverse bind matrices of the joints.
+/// \param [in]  ppJointMatrices      - Pointers to model-space matrices of the joint nodes.
+/// \param [in]  InverseMeshMatrix    - Inverse of the model-space matrix of the skinned mesh node.
+/// \param [in]  NumJoints            - The number of joints.
+/// \param [out] pSkinMatrices        - Resulting skinning matrices:
+///                                     pSkinMatrices[i] = pInverseBindMatrices[i] * *ppJointMatrices[i] * InverseMeshMatrix.
+///
+/// \remarks    The function uses SSE instructions when they are available.
+void ComputeSkinningMatrices(const float4x4*        pInverseBindMatrices,
+                             const float4x4* const* ppJointMatrices,
+                             const float4x4&        InverseMeshMatrix,
+                             Uint32                 NumJoints,
+                             float4x4*              pSkinMatrices);
+
+/// Scalar reference implementation of ComputeSkinningMatrices().
+void ComputeSkinningMatricesRef(const float4x4*        pInverseBindMatrices,
+                                const float4x4* const* ppJointMatrices,
+                                const float4x4&        InverseMeshMatrix,
+                                Uint32                 NumJoints,
+                                float4x4*              pSkinMatrices);
+
+/// Inverts an affine matrix whose last column is (0, 0, 0, 1).
+float4x4 InverseAffineMatrix(const float4x4& Matrix);
+
+
+/// Converts rigid transform matrices to unit dual quaternions.
+
+/// \param [in]  pMatrices   - Matrices to convert. Every matrix must be a combination of rotation and translation,
+///                            scale is not supported by the dual quaternion representation and is ignored.
+/// \param [in]  NumMatrices - The number of matrices.
+/// \param [out] pDualQuats  - Dual quaternions, two float4 values per matrix: the real part (rotation
+///                            quaternion) followed by the dual part. Quaternions are stored as (x, y, z, w).
+void MatricesToDualQuaternions(const float4x4* pMatrices,
+                               Uint32          NumMatrices,
+                               float4*         pDualQuats);
+
+/// Converts a unit dual quaternion to a rigid transform matrix.
+float4x4 DualQuaternionToMatrix(const float4& Real, const float4& Dual);
+
+
+namespace GLTF
+{
+
+struct Model;
+struct Node;
+
+/// Skinning palette format
+enum SKINNING_PALETTE_FORMAT : Uint8
+{
+    /// Every joint is a float4x4 matrix stored in Mesh::TransformData::jointMatrix.
+    SKINNING_PALETTE_FORMAT_MATRIX = 0,
+
+    /// Every joint is a dual quaternion (two float4 values) stored in Mesh::TransformData::jointDualQuats.
+    /// The palette is twice as small as the matrix palette, but the joints must not be scaled.
+    SKINNING_PALETTE_FORMAT_DUAL_QUATERNION
+};
+
+/// Computes the skinning palette of the skinned mesh node.
+
+/// Model-space node matrices (Node::GlobalMatrix) of the node and its joints must be
+/// up to date, see Model::UpdateTransforms().
+void UpdateSkinningPalette(Node& SkinnedNode, SKINNING_PALETTE_FORMAT Format = SKINNING_PALETTE_FORMAT_MATRIX);
+
+
+/// Computes skinning palettes of all skinned meshes of multiple models on a thread pool.
+class SkinningPaletteJob
+{
+public:
+    struct CreateInfo
+    {
+        /// Thread pool that computes the palettes. If null, ThreadPool::GetShared() is used.
+        ThreadPool* pThreadPool = nullptr;
+
+        /// Palette format.
+        SKINNING_PALETTE_FORMAT Format = SKINNING_PALETTE_FORMAT_MATRIX;
+    };
+
+    explicit SkinningPaletteJob(const CreateInfo& CI);
+
+    /// Updates node transforms of the models and computes skinning palettes of all their
+    /// skinned meshes. The method returns when all palettes are computed.
+
+    /// \param [in] ppModels  - Models to update.
+    /// \param [in] NumModels - The number of models.
+    ///
+    /// \remarks    Node transforms are updated by the calling thread, so that joint matrices
+    ///             are shared by all meshes. Palettes of individual meshes are then computed
+    ///             in parallel by the thread pool, and the calling thread helps the workers.
+    ///             Use Model::UpdateAnimation() with UpdateJointMatrices set to false
+    ///             to animate the models without computing the palettes twice.
+    void Execute(Model* const* ppModels, Uint32 NumModels);
+
+    SKINNING_PALETTE_FORMAT GetFormat() const { return m_Format; }
+
+private:
+    const SKINNING_PALETTE_FORMAT m_Format;
+
+    ThreadPool& m_ThreadPool;
+
+    std::vector<Node*> m_SkinnedNodes;
+};
+
+} // namespace GLTF
+
+} // namespace Diligent
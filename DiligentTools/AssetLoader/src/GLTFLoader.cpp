@@ -28,8 +28,10 @@
 #include <vector>
 #include <memory>
 #include <cmath>
+#include <string>
 
 #include "GLTFLoader.hpp"
+#include "SkinningPalette.hpp"
 #include "MapHelper.hpp"
 #include "CommonlyUsedStates.h"
 #include "DataBlobImpl.hpp"
@@ -38,6 +40,8 @@
 #include "FileWrapper.hpp"
 #include "GraphicsAccessories.hpp"
 #include "TextureLoader.h"
+#include "MipGenerator.hpp"
+#include "ThreadPool.hpp"
 
 #define TINYGLTF_IMPLEMENTATION
 #define TINYGLTF_NO_STB_IMAGE
@@ -94,36 +98,6 @@ RefCntAutoPtr<ITexture> TextureFromGLTFImage(IRenderDevice*         pDevice,
     else if (gltfimage.component == 4)
     {
         pTextureData = gltfimage.image.data();
-        if (AlphaCutoff > 0)
-        {
-            // Remap alpha channel using the following formula to improve mip maps:
-            //
-            //      A_new = max(A_old; 1/3 * A_old + 2/3 * CutoffThreshold)
-            //
-            // https://asawicki.info/articles/alpha_test.php5
-
-            VERIFY_EXPR(AlphaCutoff > 0 && AlphaCutoff <= 1);
-            AlphaCutoff *= 255.f;
-
-            RGBA.resize(gltfimage.width * gltfimage.height * 4);
-            // Due to depressing performance of iterators in debug MSVC we have to use raw pointers here
-            const auto* src = gltfimage.image.data();
-            auto*       dst = RGBA.data();
-            for (int i = 0; i < gltfimage.width * gltfimage.height; ++i)
-            {
-                dst[0] = src[0];
-                dst[1] = src[1];
-                dst[2] = src[2];
-                dst[3] = std::max(src[3], static_cast<Uint8>(std::min(1.f / 3.f * src[3] + 2.f / 3.f * AlphaCutoff, 255.f)));
-
-                src += 4;
-                dst += 4;
-            }
-            VERIFY_EXPR(src == gltfimage.image.data() + gltfimage.image.size());
-            VERIFY_EXPR(dst == RGBA.data() + RGBA.size());
-
-            pTextureData = RGBA.data();
-        }
     }
     else
     {
@@ -138,16 +112,61 @@ RefCntAutoPtr<ITexture> TextureFromGLTFImage(IRenderDevice*         pDevice,
     TexDesc.Width     = gltfimage.width;
     TexDesc.Height    = gltfimage.height;
     TexDesc.Format    = TEX_FORMAT_RGBA8_UNORM;
-    TexDesc.MipLevels = 0;
-    TexDesc.MiscFlags = MISC_TEXTURE_FLAG_GENERATE_MIPS;
+    TexDesc.MipLevels = ComputeMipLevelsCount(TexDesc.Width, TexDesc.Height);
     RefCntAutoPtr<ITexture> pTexture;
 
-    pDevice->CreateTexture(TexDesc, nullptr, &pTexture);
-    Box UpdateBox;
-    UpdateBox.MaxX = TexDesc.Width;
-    UpdateBox.MaxY = TexDesc.Height;
-    TextureSubResData Level0Data(pTextureData, gltfimage.width * 4);
-    pCtx->UpdateTexture(pTexture, 0, 0, UpdateBox, Level0Data, RESOURCE_STATE_TRANSITION_MODE_NONE, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    if (AlphaCutoff > 0 && gltfimage.component == 4)
+    {
+        // Mip levels of textures that are used in alpha-cut materials are computed on the CPU.
+        // Alpha of every level is scaled so that the fraction of pixels that pass the alpha test
+        // is the same as in level 0, otherwise alpha-tested cutouts vanish in the distance.
+        VERIFY_EXPR(AlphaCutoff > 0 && AlphaCutoff <= 1);
+
+        std::vector<MappedTextureSubresource> Mips(TexDesc.MipLevels);
+        std::vector<size_t>                   MipOffsets(TexDesc.MipLevels + 1);
+        for (Uint32 mip = 1; mip < TexDesc.MipLevels; ++mip)
+        {
+            Mips[mip].Stride    = std::max(TexDesc.Width >> mip, 1u) * 4;
+            MipOffsets[mip + 1] = MipOffsets[mip] + size_t{Mips[mip].Stride} * std::max(TexDesc.Height >> mip, 1u);
+        }
+        std::vector<Uint8> MipData(MipOffsets.back());
+
+        // Level 0 is only read
+        Mips[0].pData  = const_cast<Uint8*>(pTextureData);
+        Mips[0].Stride = TexDesc.Width * 4;
+        for (Uint32 mip = 1; mip < TexDesc.MipLevels; ++mip)
+            Mips[mip].pData = MipData.data() + MipOffsets[mip];
+
+        ComputeMipChainAttribs MipChainAttribs;
+        MipChainAttribs.ComponentType = VT_UINT8;
+        MipChainAttribs.NumChannels   = 4;
+        MipChainAttribs.AlphaCutoff   = AlphaCutoff;
+        MipChainAttribs.Width         = TexDesc.Width;
+        MipChainAttribs.Height        = TexDesc.Height;
+        MipChainAttribs.pMips         = Mips.data();
+        MipChainAttribs.MipLevels     = TexDesc.MipLevels;
+        MipChainAttribs.pThreadPool   = &ThreadPool::GetShared();
+        ComputeMipChain(MipChainAttribs);
+
+        std::vector<TextureSubResData> SubResources(TexDesc.MipLevels);
+        for (Uint32 mip = 0; mip < TexDesc.MipLevels; ++mip)
+            SubResources[mip] = TextureSubResData{Mips[mip].pData, Mips[mip].Stride};
+
+        TextureData InitData{SubResources.data(), TexDesc.MipLevels};
+        pDevice->CreateTexture(TexDesc, &InitData, &pTexture);
+    }
+    else
+    {
+        TexDesc.MiscFlags = MISC_TEXTURE_FLAG_GENERATE_MIPS;
+
+        pDevice->CreateTexture(TexDesc, nullptr, &pTexture);
+        Box UpdateBox;
+        UpdateBox.MaxX = TexDesc.Width;
+        UpdateBox.MaxY = TexDesc.Height;
+        TextureSubResData Level0Data(pTextureData, gltfimage.width * 4);
+        pCtx->UpdateTexture(pTexture, 0, 0, UpdateBox, Level0Data, RESOURCE_STATE_TRANSITION_MODE_NONE, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+        pCtx->GenerateMips(pTexture->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE));
+    }
     pTexture->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE)->SetSampler(pSampler);
 
     return pTexture;
@@ -189,22 +208,15 @@ float4x4 Node::GetMatrix() const
 
 void Node::Update()
 {
+    GlobalMatrix = GetMatrix();
     if (_Mesh)
     {
-        _Mesh->Transforms.matrix = GetMatrix();
+        _Mesh->Transforms.matrix = GlobalMatrix;
         if (_Skin != nullptr)
         {
-            // Update join matrices
-            auto   InverseTransform = _Mesh->Transforms.matrix.Inverse(); // TODO: do not use inverse tranform here
-            size_t numJoints        = std::min((uint32_t)_Skin->Joints.size(), Uint32{Mesh::TransformData::MaxNumJoints});
-            for (size_t i = 0; i < numJoints; i++)
-            {
-                auto* JointNode = _Skin->Joints[i];
-                auto  JointMat  = _Skin->InverseBindMatrices[i] * JointNode->GetMatrix() * InverseTransform;
-
-                _Mesh->Transforms.jointMatrix[i] = JointMat;
-            }
-            _Mesh->Transforms.jointcount = static_cast<int>(numJoints);
+            for (auto* JointNode : _Skin->Joints)
+                JointNode->GlobalMatrix = JointNode->GetMatrix();
+            UpdateSkinningPalette(*this);
         }
     }
 
@@ -217,12 +229,25 @@ void Node::Update()
 
 
 
+Model::Model(IRenderDevice*    pDevice,
+             IDeviceContext*   pContext,
+             const CreateInfo& CI)
+{
+    LoadFromFile(pDevice, pContext, CI);
+}
+
 Model::Model(IRenderDevice*     pDevice,
              IDeviceContext*    pContext,
              const std::string& filename,
-             TextureCacheType*  pTextureCache)
+             TextureCacheType*  pTextureCache) :
+    Model{pDevice, pContext, CreateInfo{filename.c_str(), pTextureCache}}
+{
+}
+
+Model::~Model()
 {
-    LoadFromFile(pDevice, pContext, filename, pTextureCache);
+    if (pGeometryPool != nullptr)
+        pGeometryPool->Free(std::move(GeometryAlloc));
 }
 
 void Model::LoadNode(IRenderDevice*               pDevice,
@@ -285,6 +310,9 @@ void Model::LoadNode(IRenderDevice*               pDevice,
             uint32_t indexStart  = static_cast<uint32_t>(indexBuffer.size());
             uint32_t vertexStart = static_cast<uint32_t>(vertexData0.size());
             VERIFY_EXPR(vertexData1.empty() || vertexData0.size() == vertexData1.size());
+            // Compact layout stores indices relative to the primitive, which allows using
+            // 16-bit indices for models with large total vertex count.
+            uint32_t indexOffset = CompactVertexLayout ? 0 : vertexStart;
 
             uint32_t indexCount  = 0;
             uint32_t vertexCount = 0;
@@ -457,7 +485,7 @@ void Model::LoadNode(IRenderDevice*               pDevice,
                         const uint32_t* buf = static_cast<const uint32_t*>(dataPtr);
                         for (size_t index = 0; index < accessor.count; index++)
                         {
-                            indexBuffer.push_back(buf[index] + vertexStart);
+                            indexBuffer.push_back(buf[index] + indexOffset);
                         }
                         break;
                     }
@@ -466,7 +494,7 @@ void Model::LoadNode(IRenderDevice*               pDevice,
                         const uint16_t* buf = static_cast<const uint16_t*>(dataPtr);
                         for (size_t index = 0; index < accessor.count; index++)
                         {
-                            indexBuffer.push_back(buf[index] + vertexStart);
+                            indexBuffer.push_back(buf[index] + indexOffset);
                         }
                         break;
                     }
@@ -475,7 +503,7 @@ void Model::LoadNode(IRenderDevice*               pDevice,
                         const uint8_t* buf = static_cast<const uint8_t*>(dataPtr);
                         for (size_t index = 0; index < accessor.count; index++)
                         {
-                            indexBuffer.push_back(buf[index] + vertexStart);
+                            indexBuffer.push_back(buf[index] + indexOffset);
                         }
                         break;
                     }
@@ -483,6 +511,12 @@ void Model::LoadNode(IRenderDevice*               pDevice,
                         std::cerr << "Index component type " << accessor.componentType << " not supported!" << std::endl;
                         return;
                 }
+
+                if (OptimizeMeshes && primitive.mode == TINYGLTF_MODE_TRIANGLES)
+                {
+                    OptimizePrimitive(&indexBuffer[indexStart], indexCount, indexOffset,
+                                      &vertexData0[vertexStart], &vertexData1[vertexStart], vertexCount);
+                }
             }
             std::unique_ptr<Primitive> newPrimitive(
                 new Primitive //
@@ -490,11 +524,18 @@ void Model::LoadNode(IRenderDevice*               pDevice,
                     indexStart,
                     indexCount,
                     vertexCount,
-                    primitive.material > -1 ? Materials[primitive.material] : Materials.back() //
-                }                                                                              //
+                    primitive.material > -1 ? Materials[primitive.material] : Materials.back(),
+                    hasIndices ? vertexStart - indexOffset : vertexStart //
+                }                                                        //
             );
 
             newPrimitive->SetBoundingBox(PosMin, PosMax);
+            newPrimitive->Index = NumPrimitives++;
+
+            if (LODCount > 1 && hasIndices && primitive.mode == TINYGLTF_MODE_TRIANGLES)
+            {
+                GeneratePrimitiveLODs(*newPrimitive, indexOffset, indexBuffer, &vertexData0[vertexStart], vertexCount);
+            }
             NewMesh->Primitives.push_back(std::move(newPrimitive));
         }
 
@@ -514,6 +555,10 @@ void Model::LoadNode(IRenderDevice*               pDevice,
     }
 
     LinearNodes.push_back(NewNode.get());
+    if (nodeIndex < NodeIndexMap.size())
+        NodeIndexMap[nodeIndex] = NewNode.get();
+    if (!NewNode->Name.empty())
+        NodeNameMap.emplace(NewNode->Name, NewNode.get());
     if (parent)
     {
         parent->Children.push_back(std::move(NewNode));
@@ -535,16 +580,16 @@ void Model::LoadSkins(const tinygltf::Model& gltf_model)
         // Find skeleton root node
         if (source.skeleton > -1)
         {
-            NewSkin->pSkeletonRoot = NodeFromIndex(source.skeleton);
+            NewSkin->pSkeletonRoot = GetNodeByIndex(static_cast<Uint32>(source.skeleton));
         }
 
         // Find joint nodes
         for (int jointIndex : source.joints)
         {
-            Node* node = NodeFromIndex(jointIndex);
+            Node* node = GetNodeByIndex(static_cast<Uint32>(jointIndex));
             if (node)
             {
-                NewSkin->Joints.push_back(NodeFromIndex(jointIndex));
+                NewSkin->Joints.push_back(node);
             }
         }
 
@@ -692,7 +737,6 @@ void Model::LoadTextures(IRenderDevice*         pDevice,
             if (gltf_image.width > 0 && gltf_image.height > 0)
             {
                 pTexture = TextureFromGLTFImage(pDevice, pCtx, gltf_image, pSampler, AlphaCutoff);
-                pCtx->GenerateMips(pTexture->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE));
             }
             else if (gltf_image.pixel_type == IMAGE_FILE_FORMAT_DDS || gltf_image.pixel_type == IMAGE_FILE_FORMAT_KTX)
             {
@@ -1098,7 +1142,7 @@ void Model::LoadAnimations(const tinygltf::Model& gltf_model)
             }
 
             channel.SamplerIndex = source.sampler;
-            channel.node         = NodeFromIndex(source.target_node);
+            channel.node         = GetNodeByIndex(static_cast<Uint32>(source.target_node));
             if (!channel.node)
             {
                 continue;
@@ -1316,11 +1360,22 @@ bool ReadWholeFile(std::vector<unsigned char>* out,
 
 } // namespace Callbacks
 
-void Model::LoadFromFile(IRenderDevice*     pDevice,
-                         IDeviceContext*    pContext,
-                         const std::string& filename,
-                         TextureCacheType*  pTextureCache)
+void Model::LoadFromFile(IRenderDevice*    pDevice,
+                         IDeviceContext*   pContext,
+                         const CreateInfo& CI)
 {
+    if (CI.FileName == nullptr || *CI.FileName == 0)
+        LOG_ERROR_AND_THROW("File path must not be empty");
+
+    const std::string filename{CI.FileName};
+    auto* const       pTextureCache = CI.pTextureCache;
+
+    CompactVertexLayout = CI.UseCompactVertexLayout;
+    OptimizeMeshes      = CI.OptimizeMeshes;
+    LODCount            = CI.LODCount;
+    LODReductionRatio   = CI.LODReductionRatio;
+    LODMaxError         = CI.LODMaxError;
+
     tinygltf::Model    gltf_model;
     tinygltf::TinyGLTF gltf_context;
 
@@ -1379,6 +1434,7 @@ void Model::LoadFromFile(IRenderDevice*     pDevice,
 
     // TODO: scene handling with no default scene
     const tinygltf::Scene& scene = gltf_model.scenes[gltf_model.defaultScene > -1 ? gltf_model.defaultScene : 0];
+    NodeIndexMap.assign(gltf_model.nodes.size(), nullptr);
     for (size_t i = 0; i < scene.nodes.size(); i++)
     {
         const tinygltf::Node node = gltf_model.nodes[scene.nodes[i]];
@@ -1398,90 +1454,474 @@ void Model::LoadFromFile(IRenderDevice*     pDevice,
         {
             node->_Skin = Skins[node->SkinIndex].get();
         }
+    }
+    // Initial pose
+    UpdateTransforms();
+
+
+    Extensions = gltf_model.extensionsUsed;
 
-        // Initial pose
-        if (node->_Mesh)
+    if (VertexCacheStatsBefore.TriangleCount > 0)
+    {
+        LOG_INFO_MESSAGE("Optimized ", VertexCacheStatsBefore.TriangleCount, " triangles in ", filename,
+                         ". ACMR: ", VertexCacheStatsBefore.ACMR, " -> ", VertexCacheStatsAfter.ACMR,
+                         ", ATVR: ", VertexCacheStatsBefore.ATVR, " -> ", VertexCacheStatsAfter.ATVR);
+    }
+
+    pGeometryPool = CI.pGeometryPool;
+    if (CompactVertexLayout)
+        CreateCompactBuffers(pDevice, pContext, IndexBuffer, VertexData0, VertexData1);
+    else
+        CreateBuffers(pDevice, pContext, IndexBuffer, VertexData0, VertexData1);
+
+    GetSceneDimensions();
+}
+
+void Model::OptimizePrimitive(Uint32*         pIndices,
+                              Uint32          NumIndices,
+                              Uint32          IndexOffset,
+                              VertexAttribs0* pVertexData0,
+                              VertexAttribs1* pVertexData1,
+                              Uint32          VertexCount)
+{
+    if (NumIndices % 3 != 0)
+    {
+        LOG_WARNING_MESSAGE("Index count (", NumIndices, ") of a triangle list primitive is not a multiple of 3. The primitive will not be optimized.");
+        return;
+    }
+
+    // Optimization functions operate on indices relative to the primitive
+    std::vector<Uint32> Indices(pIndices, pIndices + NumIndices);
+    for (auto& Idx : Indices)
+    {
+        Idx -= IndexOffset;
+        if (Idx >= VertexCount)
         {
-            node->Update();
+            LOG_WARNING_MESSAGE("Primitive index (", Idx, ") exceeds the vertex count (", VertexCount, "). The primitive will not be optimized.");
+            return;
         }
     }
 
+    VertexCacheStatsBefore += AnalyzeVertexCache(Indices.data(), Indices.size(), VertexCount);
 
-    Extensions = gltf_model.extensionsUsed;
+    std::vector<Uint32> CacheOptimizedIndices(NumIndices);
+    OptimizeVertexCache(CacheOptimizedIndices.data(), Indices.data(), Indices.size(), VertexCount);
+    OptimizeOverdraw(Indices.data(), CacheOptimizedIndices.data(), Indices.size(),
+                     &pVertexData0->pos, sizeof(VertexAttribs0), VertexCount);
+
+    std::vector<Uint32> Remap(VertexCount);
+    ComputeVertexFetchRemap(Remap.data(), Indices.data(), Indices.size(), VertexCount);
+    RemapIndices(Indices.data(), Indices.size(), Remap.data());
+    RemapVertices(pVertexData0, VertexCount, Remap.data());
+    RemapVertices(pVertexData1, VertexCount, Remap.data());
+
+    VertexCacheStatsAfter += AnalyzeVertexCache(Indices.data(), Indices.size(), VertexCount);
 
+    for (Uint32 i = 0; i < NumIndices; ++i)
+        pIndices[i] = Indices[i] + IndexOffset;
+}
+
+void Model::GeneratePrimitiveLODs(Primitive&            Prim,
+                                  Uint32                IndexOffset,
+                                  std::vector<Uint32>&  IndexBuffer,
+                                  const VertexAttribs0* pVertexData0,
+                                  Uint32                VertexCount)
+{
+    VERIFY_EXPR(Prim.LODs.size() == 1 && Prim.FirstIndex + Prim.IndexCount == IndexBuffer.size());
+    if (Prim.IndexCount % 3 != 0 || !Prim.IsValidBB)
+        return;
+
+    std::vector<Uint32> SrcIndices{IndexBuffer.begin() + Prim.FirstIndex, IndexBuffer.end()};
+    for (auto& Idx : SrcIndices)
     {
-        VERIFY_EXPR(!VertexData0.empty());
-        BufferDesc VBDesc;
-        VBDesc.Name          = "GLTF vertex attribs 0 buffer";
-        VBDesc.uiSizeInBytes = static_cast<Uint32>(VertexData0.size() * sizeof(VertexData0[0]));
-        VBDesc.BindFlags     = BIND_VERTEX_BUFFER;
-        VBDesc.Usage         = USAGE_IMMUTABLE;
+        Idx -= IndexOffset;
+        if (Idx >= VertexCount)
+            return;
+    }
+
+    const auto PrimSize = length(Prim.BB.Max - Prim.BB.Min);
+
+    std::vector<Uint32> LODIndices(SrcIndices.size());
+    std::vector<Uint32> CacheOptimizedIndices;
+    for (Uint32 lod = 1; lod < LODCount; ++lod)
+    {
+        const auto PrevIndexCount   = Prim.LODs.back().IndexCount;
+        const auto TargetIndexCount = static_cast<size_t>(static_cast<float>(PrevIndexCount) * LODReductionRatio) / 3 * 3;
+        // The error budget grows linearly with the LOD index
+        const auto TargetError = LODMaxError * PrimSize * static_cast<float>(lod) / static_cast<float>(LODCount - 1);
+
+        // Always simplify the full-detail mesh so that the errors do not accumulate
+        float      Error         = 0;
+        const auto LODIndexCount = SimplifyMesh(LODIndices.data(), SrcIndices.data(), SrcIndices.size(),
+                                                &pVertexData0->pos, sizeof(VertexAttribs0), VertexCount,
+                                                TargetIndexCount, TargetError, &Error);
+        // Stop if the mesh can't be simplified any further
+        if (LODIndexCount == 0 || LODIndexCount > PrevIndexCount * 9 / 10)
+            break;
+
+        auto* pLODIndices = LODIndices.data();
+        if (OptimizeMeshes)
+        {
+            CacheOptimizedIndices.resize(LODIndexCount);
+            OptimizeVertexCache(CacheOptimizedIndices.data(), LODIndices.data(), LODIndexCount, VertexCount);
+            pLODIndices = CacheOptimizedIndices.data();
+        }
+
+        Primitive::LOD LOD;
+        LOD.FirstIndex = static_cast<Uint32>(IndexBuffer.size());
+        LOD.IndexCount = static_cast<Uint32>(LODIndexCount);
+        LOD.Error      = Error;
+        for (size_t i = 0; i < LODIndexCount; ++i)
+            IndexBuffer.push_back(pLODIndices[i] + IndexOffset);
+        Prim.LODs.push_back(LOD);
+    }
+}
+
+void Model::CreateBuffers(IRenderDevice*                     pDevice,
+                          IDeviceContext*                    pContext,
+                          const std::vector<Uint32>&         IndexData,
+                          const std::vector<VertexAttribs0>& VertexData0,
+                          const std::vector<VertexAttribs1>& VertexData1)
+{
+    VERIFY_EXPR(!VertexData0.empty() && VertexData0.size() == VertexData1.size());
+
+    IndexType = VT_UINT32;
+
+    const void*  pVertexData[]   = {VertexData0.data(), VertexData1.data()};
+    const Uint32 VertexStrides[] = {sizeof(VertexAttribs0), sizeof(VertexAttribs1)};
+    InitBuffers(pDevice, pContext, pVertexData, VertexStrides, static_cast<Uint32>(VertexData0.size()), IndexData);
+}
+
+void Model::InitBuffers(IRenderDevice*             pDevice,
+                        IDeviceContext*            pContext,
+                        const void* const          pVertexData[],
+                        const Uint32               VertexStrides[],
+                        Uint32                     VertexCount,
+                        const std::vector<Uint32>& IndexData)
+{
+    static constexpr Uint32 NumVertexStreams = _countof(pVertexBuffer);
+
+    if (pGeometryPool != nullptr)
+    {
+        const auto& PoolDesc = pGeometryPool->GetDesc();
+        if (PoolDesc.NumVertexStreams != NumVertexStreams)
+            LOG_ERROR_AND_THROW("Geometry pool has ", PoolDesc.NumVertexStreams, " vertex streams while ", NumVertexStreams, " are expected");
+        for (Uint32 s = 0; s < NumVertexStreams; ++s)
+        {
+            if (PoolDesc.VertexStrides[s] != VertexStrides[s])
+                LOG_ERROR_AND_THROW("Vertex stride (", PoolDesc.VertexStrides[s], ") of stream ", s, " of the geometry pool does not match the model vertex stride (", VertexStrides[s], ")");
+        }
 
-        BufferData BuffData(VertexData0.data(), VBDesc.uiSizeInBytes);
-        pDevice->CreateBuffer(VBDesc, &BuffData, &pVertexBuffer[0]);
+        // The model is placed in the pool as a whole, so that the indices remain valid
+        GeometryAlloc = pGeometryPool->Allocate(VertexCount, static_cast<Uint32>(IndexData.size()));
+        if (!GeometryAlloc.IsValid())
+            LOG_ERROR_AND_THROW("Not enough space in the geometry pool to allocate ", VertexCount, " vertices and ", IndexData.size(), " indices");
+
+        // The pool buffers may be recreated when the pool grows, so the model does not keep references to them
+        for (Uint32 s = 0; s < NumVertexStreams; ++s)
+            pGeometryPool->UpdateVertices(pContext, GeometryAlloc, s, pVertexData[s]);
+
+        IndexType = PoolDesc.IndexType;
+        if (!IndexData.empty())
+        {
+            if (IndexType == VT_UINT16)
+            {
+                std::vector<Uint16> IndexData16(IndexData.size());
+                for (size_t i = 0; i < IndexData.size(); ++i)
+                {
+                    if (IndexData[i] > 0xFFFFu)
+                        LOG_ERROR_AND_THROW("Index ", IndexData[i], " can't be stored in the 16-bit geometry pool");
+                    IndexData16[i] = static_cast<Uint16>(IndexData[i]);
+                }
+                pGeometryPool->UpdateIndices(pContext, GeometryAlloc, IndexData16.data());
+            }
+            else
+            {
+                pGeometryPool->UpdateIndices(pContext, GeometryAlloc, IndexData.data());
+            }
+        }
+
+        // Make primitives reference the pool ranges
+        for (auto* node : LinearNodes)
+        {
+            if (!node->_Mesh)
+                continue;
+            for (auto& prim : node->_Mesh->Primitives)
+            {
+                prim->BaseVertex += GeometryAlloc.FirstVertex;
+                if (prim->hasIndices)
+                {
+                    prim->FirstIndex += GeometryAlloc.FirstIndex;
+                    for (auto& LOD : prim->LODs)
+                        LOD.FirstIndex += GeometryAlloc.FirstIndex;
+                }
+            }
+        }
+        return;
     }
 
+    for (Uint32 s = 0; s < NumVertexStreams; ++s)
     {
-        VERIFY_EXPR(!VertexData1.empty());
+        const auto Name = std::string{CompactVertexLayout ? "GLTF compact vertex attribs " : "GLTF vertex attribs "} + std::to_string(s) + " buffer";
+
         BufferDesc VBDesc;
-        VBDesc.Name          = "GLTF vertex attribs 1 buffer";
-        VBDesc.uiSizeInBytes = static_cast<Uint32>(VertexData1.size() * sizeof(VertexData1[0]));
+        VBDesc.Name          = Name.c_str();
+        VBDesc.uiSizeInBytes = VertexCount * VertexStrides[s];
         VBDesc.BindFlags     = BIND_VERTEX_BUFFER;
         VBDesc.Usage         = USAGE_IMMUTABLE;
 
-        BufferData BuffData(VertexData1.data(), VBDesc.uiSizeInBytes);
-        pDevice->CreateBuffer(VBDesc, &BuffData, &pVertexBuffer[1]);
+        BufferData BuffData(pVertexData[s], VBDesc.uiSizeInBytes);
+        pDevice->CreateBuffer(VBDesc, &BuffData, &pVertexBuffer[s]);
     }
 
-
-    if (!IndexBuffer.empty())
+    if (!IndexData.empty())
     {
         BufferDesc IBDesc;
-        IBDesc.Name          = "GLTF inde buffer";
-        IBDesc.uiSizeInBytes = static_cast<Uint32>(IndexBuffer.size() * sizeof(IndexBuffer[0]));
-        IBDesc.BindFlags     = BIND_INDEX_BUFFER;
-        IBDesc.Usage         = USAGE_IMMUTABLE;
+        IBDesc.BindFlags = BIND_INDEX_BUFFER;
+        IBDesc.Usage     = USAGE_IMMUTABLE;
+        if (IndexType == VT_UINT16)
+        {
+            std::vector<Uint16> IndexData16(IndexData.size());
+            for (size_t i = 0; i < IndexData.size(); ++i)
+            {
+                VERIFY_EXPR(IndexData[i] <= 0xFFFFu);
+                IndexData16[i] = static_cast<Uint16>(IndexData[i]);
+            }
+
+            IBDesc.Name          = "GLTF 16-bit index buffer";
+            IBDesc.uiSizeInBytes = static_cast<Uint32>(IndexData16.size() * sizeof(IndexData16[0]));
+
+            BufferData BuffData(IndexData16.data(), IBDesc.uiSizeInBytes);
+            pDevice->CreateBuffer(IBDesc, &BuffData, &pIndexBuffer);
+        }
+        else
+        {
+            VERIFY_EXPR(IndexType == VT_UINT32);
+
+            IBDesc.Name          = "GLTF index buffer";
+            IBDesc.uiSizeInBytes = static_cast<Uint32>(IndexData.size() * sizeof(IndexData[0]));
 
-        BufferData BuffData(IndexBuffer.data(), IBDesc.uiSizeInBytes);
-        pDevice->CreateBuffer(IBDesc, &BuffData, &pIndexBuffer);
+            BufferData BuffData(IndexData.data(), IBDesc.uiSizeInBytes);
+            pDevice->CreateBuffer(IBDesc, &BuffData, &pIndexBuffer);
+        }
     }
+}
 
-    GetSceneDimensions();
+namespace
+{
+
+// Converts 32-bit float to 16-bit float using round-to-nearest-even
+Uint16 FloatToHalf(float f)
+{
+    Uint32 x;
+    memcpy(&x, &f, sizeof(x));
+
+    const Uint32 Sign = (x >> 16) & 0x8000u;
+    Uint32       Mant = x & 0x007FFFFFu;
+    Int32        Exp  = static_cast<Int32>((x >> 23) & 0xFFu);
+
+    if (Exp == 0xFF)
+    {
+        // Inf or NaN
+        return static_cast<Uint16>(Sign | 0x7C00u | (Mant != 0 ? 0x200u : 0u));
+    }
+
+    Exp = Exp - 127 + 15;
+    if (Exp >= 31)
+    {
+        // Overflow - convert to infinity
+        return static_cast<Uint16>(Sign | 0x7C00u);
+    }
+
+    if (Exp <= 0)
+    {
+        // Subnormal half or zero
+        if (Exp < -10)
+            return static_cast<Uint16>(Sign);
+
+        Mant |= 0x00800000u;
+        const Uint32 Shift    = static_cast<Uint32>(14 - Exp);
+        Uint32       HalfMant = Mant >> Shift;
+        const Uint32 Rem      = Mant & ((1u << Shift) - 1u);
+        const Uint32 Halfway  = 1u << (Shift - 1u);
+        if (Rem > Halfway || (Rem == Halfway && (HalfMant & 1u) != 0))
+            ++HalfMant;
+        return static_cast<Uint16>(Sign | HalfMant);
+    }
+
+    Uint32       Half = Sign | (static_cast<Uint32>(Exp) << 10) | (Mant >> 13);
+    const Uint32 Rem  = Mant & 0x1FFFu;
+    // Carry may propagate into the exponent, which correctly rounds up to the next power of two
+    if (Rem > 0x1000u || (Rem == 0x1000u && (Half & 1u) != 0))
+        ++Half;
+    return static_cast<Uint16>(Half);
+}
+
+Int16 FloatToSNorm16(float f)
+{
+    f = std::max(std::min(f, 1.f), -1.f);
+    return static_cast<Int16>(std::round(f * 32767.f));
 }
 
-void Model::CalculateBoundingBox(Node* node, const Node* parent)
+// Encodes unit vector using octahedral mapping, see
+// "A Survey of Efficient Representations for Independent Unit Vectors" (Cigolle et al. 2014)
+float2 OctahedralEncode(const float3& n)
 {
-    BoundBox parentBvh = parent ? parent->BVH : BoundBox{dimensions.min, dimensions.max};
+    const auto L1Norm = std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+    if (L1Norm == 0)
+        return float2{0, 0};
 
-    if (node->_Mesh)
+    float2 p{n.x / L1Norm, n.y / L1Norm};
+    if (n.z < 0)
     {
-        if (node->_Mesh->IsValidBB)
+        const auto SignX = p.x >= 0 ? 1.f : -1.f;
+        const auto SignY = p.y >= 0 ? 1.f : -1.f;
+        p                = float2{(1.f - std::abs(p.y)) * SignX, (1.f - std::abs(p.x)) * SignY};
+    }
+    return p;
+}
+
+} // namespace
+
+void Model::CreateCompactBuffers(IRenderDevice*                     pDevice,
+                                 IDeviceContext*                    pContext,
+                                 const std::vector<Uint32>&         IndexData,
+                                 const std::vector<VertexAttribs0>& VertexData0,
+                                 const std::vector<VertexAttribs1>& VertexData1)
+{
+    VERIFY_EXPR(!VertexData0.empty() && VertexData0.size() == VertexData1.size());
+
+    std::vector<CompactVertexAttribs0> CompactData0(VertexData0.size());
+    std::vector<CompactVertexAttribs1> CompactData1(VertexData1.size());
+
+    bool Use16BitIndices = true;
+    for (auto* node : LinearNodes)
+    {
+        if (!node->_Mesh)
+            continue;
+
+        auto& mesh = *node->_Mesh;
+        if (mesh.Primitives.empty())
+            continue;
+
+        // Primitives of a mesh occupy contiguous vertex range. Compute the actual bounds of
+        // this range as accessor min/max values are not always precise.
+        Uint32 FirstVertex = ~Uint32{0};
+        Uint32 LastVertex  = 0;
+        for (const auto& prim : mesh.Primitives)
         {
-            node->AABB = node->_Mesh->BB.Transform(node->GetMatrix());
-            if (node->Children.empty())
+            FirstVertex = std::min(FirstVertex, prim->BaseVertex);
+            LastVertex  = std::max(LastVertex, prim->BaseVertex + prim->VertexCount);
+            if (prim->hasIndices && prim->VertexCount > 0xFFFFu)
+                Use16BitIndices = false;
+        }
+        if (FirstVertex >= LastVertex)
+            continue;
+
+        float3 PosMin{+FLT_MAX, +FLT_MAX, +FLT_MAX};
+        float3 PosMax{-FLT_MAX, -FLT_MAX, -FLT_MAX};
+        for (Uint32 v = FirstVertex; v < LastVertex; ++v)
+        {
+            PosMin = std::min(PosMin, VertexData0[v].pos);
+            PosMax = std::max(PosMax, VertexData0[v].pos);
+        }
+
+        mesh.PositionBias  = PosMin;
+        mesh.PositionScale = PosMax - PosMin;
+        for (int c = 0; c < 3; ++c)
+        {
+            if (mesh.PositionScale[c] <= 0)
+                mesh.PositionScale[c] = 1;
+        }
+
+        for (Uint32 v = FirstVertex; v < LastVertex; ++v)
+        {
+            const auto& SrcVert0 = VertexData0[v];
+            auto&       DstVert0 = CompactData0[v];
+
+            for (int c = 0; c < 3; ++c)
             {
-                node->BVH.Min    = node->AABB.Min;
-                node->BVH.Max    = node->AABB.Max;
-                node->IsValidBVH = true;
+                const auto QuantPos = (SrcVert0.pos[c] - mesh.PositionBias[c]) / mesh.PositionScale[c];
+                DstVert0.pos[c]     = static_cast<Uint16>(std::round(std::max(std::min(QuantPos, 1.f), 0.f) * 65535.f));
+            }
+            DstVert0.pos[3] = 0;
+
+            const auto OctNormal = OctahedralEncode(SrcVert0.normal);
+            DstVert0.normal[0]   = FloatToSNorm16(OctNormal.x);
+            DstVert0.normal[1]   = FloatToSNorm16(OctNormal.y);
+
+            DstVert0.uv0[0] = FloatToHalf(SrcVert0.uv0.x);
+            DstVert0.uv0[1] = FloatToHalf(SrcVert0.uv0.y);
+            DstVert0.uv1[0] = FloatToHalf(SrcVert0.uv1.x);
+            DstVert0.uv1[1] = FloatToHalf(SrcVert0.uv1.y);
+
+            const auto& SrcVert1 = VertexData1[v];
+            auto&       DstVert1 = CompactData1[v];
+
+            int WeightSum   = 0;
+            int MaxWeightId = 0;
+            for (int c = 0; c < 4; ++c)
+            {
+                DstVert1.joint0[c] = static_cast<Uint16>(SrcVert1.joint0[c]);
+
+                const auto Weight   = std::max(std::min(SrcVert1.weight0[c], 1.f), 0.f);
+                DstVert1.weight0[c] = static_cast<Uint8>(std::round(Weight * 255.f));
+                WeightSum += DstVert1.weight0[c];
+                if (DstVert1.weight0[c] > DstVert1.weight0[MaxWeightId])
+                    MaxWeightId = c;
+            }
+            if (WeightSum > 0 && WeightSum != 255)
+            {
+                // Make quantized weights sum up to one to avoid shrinking or inflating skinned vertices
+                const auto Adjusted          = static_cast<int>(DstVert1.weight0[MaxWeightId]) + (255 - WeightSum);
+                DstVert1.weight0[MaxWeightId] = static_cast<Uint8>(std::max(std::min(Adjusted, 255), 0));
             }
         }
     }
 
-    parentBvh.Min = std::min(parentBvh.Min, node->BVH.Min);
-    parentBvh.Max = std::max(parentBvh.Max, node->BVH.Max);
+    IndexType = Use16BitIndices ? VT_UINT16 : VT_UINT32;
+
+    const void*  pVertexData[]   = {CompactData0.data(), CompactData1.data()};
+    const Uint32 VertexStrides[] = {sizeof(CompactVertexAttribs0), sizeof(CompactVertexAttribs1)};
+    InitBuffers(pDevice, pContext, pVertexData, VertexStrides, static_cast<Uint32>(CompactData0.size()), IndexData);
+}
+
+void Model::CalculateBoundingBox(Node* node)
+{
+    node->IsValidBVH = false;
+    if (node->_Mesh && node->_Mesh->IsValidBB)
+    {
+        node->AABB       = node->_Mesh->BB.Transform(node->GetMatrix());
+        node->BVH        = node->AABB;
+        node->IsValidBVH = true;
+    }
 
+    // The bounding volume of the node encloses the volumes of all its children
     for (auto& child : node->Children)
     {
-        CalculateBoundingBox(child.get(), node);
+        CalculateBoundingBox(child.get());
+        if (!child->IsValidBVH)
+            continue;
+
+        if (node->IsValidBVH)
+        {
+            node->BVH.Min = std::min(node->BVH.Min, child->BVH.Min);
+            node->BVH.Max = std::max(node->BVH.Max, child->BVH.Max);
+        }
+        else
+        {
+            node->BVH        = child->BVH;
+            node->IsValidBVH = true;
+        }
     }
 }
 
 void Model::GetSceneDimensions()
 {
-    // Calculate binary volume hierarchy for all nodes in the scene
-    for (auto* node : LinearNodes)
+    // Calculate bounding volume hierarchy for all nodes in the scene
+    for (auto& node : Nodes)
     {
-        CalculateBoundingBox(node, nullptr);
+        CalculateBoundingBox(node.get());
     }
 
     dimensions.min = float3{+FLT_MAX, +FLT_MAX, +FLT_MAX};
@@ -1503,7 +1943,30 @@ void Model::GetSceneDimensions()
     AABBTransform[3][2] = dimensions.min[2];
 }
 
-void Model::UpdateAnimation(Uint32 index, float time)
+void Model::UpdateTransforms(bool UpdateJointMatrices)
+{
+    // Parents precede their children in reverse order of LinearNodes
+    for (auto it = LinearNodes.rbegin(); it != LinearNodes.rend(); ++it)
+    {
+        auto* pNode         = *it;
+        pNode->GlobalMatrix = pNode->Parent != nullptr ?
+            pNode->LocalMatrix() * pNode->Parent->GlobalMatrix :
+            pNode->LocalMatrix();
+        if (pNode->_Mesh)
+            pNode->_Mesh->Transforms.matrix = pNode->GlobalMatrix;
+    }
+
+    if (UpdateJointMatrices)
+    {
+        for (auto* pNode : LinearNodes)
+        {
+            if (pNode->_Mesh && pNode->_Skin != nullptr)
+                UpdateSkinningPalette(*pNode);
+        }
+    }
+}
+
+void Model::UpdateAnimation(Uint32 index, float time, bool UpdateJointMatrices)
 {
     if (index > static_cast<Uint32>(Animations.size()) - 1)
     {
@@ -1570,48 +2033,10 @@ void Model::UpdateAnimation(Uint32 index, float time)
 
     if (updated)
     {
-        for (auto& node : Nodes)
-        {
-            node->Update();
-        }
+        UpdateTransforms(UpdateJointMatrices);
     }
 }
 
-
-Node* Model::FindNode(Node* parent, Uint32 index)
-{
-    Node* nodeFound = nullptr;
-    if (parent->Index == index)
-    {
-        return parent;
-    }
-    for (auto& child : parent->Children)
-    {
-        nodeFound = FindNode(child.get(), index);
-        if (nodeFound)
-        {
-            break;
-        }
-    }
-    return nodeFound;
-}
-
-
-Node* Model::NodeFromIndex(uint32_t index)
-{
-    Node* nodeFound = nullptr;
-    for (auto& node : Nodes)
-    {
-        nodeFound = FindNode(node.get(), index);
-        if (nodeFound)
-        {
-            break;
-        }
-    }
-    return nodeFound;
-}
-
-
 } // namespace GLTF
 
 } // namespace Diligent
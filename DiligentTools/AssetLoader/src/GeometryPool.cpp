@@ -0,0 +1,228 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+#include "GeometryPool.hpp"
+
+#include <string>
+#include <algorithm>
+
+#include "DefaultRawMemoryAllocator.hpp"
+#include "GraphicsAccessories.hpp"
+
+namespace Diligent
+{
+
+GeometryPool::GeometryPool(IRenderDevice* pDevice, const CreateInfo& CI) :
+    m_Desc{CI},
+    m_pDevice{pDevice},
+    m_VertexAllocationsMgr{CI.VertexCapacity, DefaultRawMemoryAllocator::GetAllocator()},
+    m_IndexAllocationsMgr{CI.IndexCapacity, DefaultRawMemoryAllocator::GetAllocator()}
+{
+    if (CI.NumVertexStreams == 0 || CI.NumVertexStreams > MaxVertexStreams)
+        LOG_ERROR_AND_THROW("The number of vertex streams (", CI.NumVertexStreams, ") must be between 1 and ", Uint32{MaxVertexStreams});
+    if (CI.IndexType != VT_UINT16 && CI.IndexType != VT_UINT32)
+        LOG_ERROR_AND_THROW("Index type must be VT_UINT16 or VT_UINT32");
+    if (CI.VertexCapacity == 0 || CI.IndexCapacity == 0)
+        LOG_ERROR_AND_THROW("Vertex and index capacities must not be zero");
+
+    for (Uint32 s = 0; s < CI.NumVertexStreams; ++s)
+    {
+        if (CI.VertexStrides[s] == 0)
+            LOG_ERROR_AND_THROW("Vertex stride of stream ", s, " must not be zero");
+
+        CreateVertexBuffer(s, CI.VertexCapacity, m_pVertexBuffers[s]);
+    }
+    CreateIndexBuffer(CI.IndexCapacity, m_pIndexBuffer);
+
+    m_BufferVertexCapacity = CI.VertexCapacity;
+    m_BufferIndexCapacity  = CI.IndexCapacity;
+}
+
+void GeometryPool::CreateVertexBuffer(Uint32 Stream, Uint32 VertexCapacity, RefCntAutoPtr<IBuffer>& pBuffer)
+{
+    const auto Name = std::string{"Geometry pool vertex buffer "} + std::to_string(Stream);
+
+    BufferDesc VBDesc;
+    VBDesc.Name          = Name.c_str();
+    VBDesc.uiSizeInBytes = VertexCapacity * m_Desc.VertexStrides[Stream];
+    VBDesc.BindFlags     = BIND_VERTEX_BUFFER;
+    VBDesc.Usage         = USAGE_DEFAULT;
+    m_pDevice->CreateBuffer(VBDesc, nullptr, &pBuffer);
+    if (!pBuffer)
+        LOG_ERROR_AND_THROW("Failed to create geometry pool vertex buffer");
+}
+
+void GeometryPool::CreateIndexBuffer(Uint32 IndexCapacity, RefCntAutoPtr<IBuffer>& pBuffer)
+{
+    BufferDesc IBDesc;
+    IBDesc.Name          = "Geometry pool index buffer";
+    IBDesc.uiSizeInBytes = IndexCapacity * GetValueSize(m_Desc.IndexType);
+    IBDesc.BindFlags     = BIND_INDEX_BUFFER;
+    IBDesc.Usage         = USAGE_DEFAULT;
+    m_pDevice->CreateBuffer(IBDesc, nullptr, &pBuffer);
+    if (!pBuffer)
+        LOG_ERROR_AND_THROW("Failed to create geometry pool index buffer");
+}
+
+GeometryPool::~GeometryPool()
+{
+    VERIFY(m_VertexAllocationsMgr.GetUsedSize() == 0 && m_IndexAllocationsMgr.GetUsedSize() == 0,
+           "Destroying geometry pool that still has allocations. All models that use the pool must be destroyed first.");
+}
+
+GeometryPool::Allocation GeometryPool::Allocate(Uint32 VertexCount, Uint32 IndexCount)
+{
+    VERIFY_EXPR(VertexCount > 0);
+
+    const auto AllowGrowth   = m_Desc.AllowGrowth;
+    auto       AllocateRange = [AllowGrowth](VariableSizeAllocationsManager& Mgr, Uint32 Count) {
+        auto Alloc = Mgr.Allocate(Count, 1);
+        if (!Alloc.IsValid() && AllowGrowth)
+        {
+            // Double the capacity, or grow by the allocation size if it is larger.
+            // The new space is merged with the free block at the end, so the allocation always fits.
+            Mgr.Extend(std::max(Mgr.GetMaxSize(), size_t{Count}));
+            Alloc = Mgr.Allocate(Count, 1);
+            VERIFY_EXPR(Alloc.IsValid());
+        }
+        return Alloc;
+    };
+
+    std::lock_guard<std::mutex> Lock{m_AllocationMgrMtx};
+
+    auto VertAlloc = AllocateRange(m_VertexAllocationsMgr, VertexCount);
+    if (!VertAlloc.IsValid())
+        return Allocation{};
+
+    VariableSizeAllocationsManager::Allocation IdxAlloc;
+    if (IndexCount > 0)
+    {
+        IdxAlloc = AllocateRange(m_IndexAllocationsMgr, IndexCount);
+        if (!IdxAlloc.IsValid())
+        {
+            m_VertexAllocationsMgr.Free(std::move(VertAlloc));
+            return Allocation{};
+        }
+    }
+
+    Allocation Alloc;
+    Alloc.FirstVertex = static_cast<Uint32>(VertAlloc.UnalignedOffset);
+    Alloc.VertexCount = VertexCount;
+    if (IndexCount > 0)
+    {
+        Alloc.FirstIndex = static_cast<Uint32>(IdxAlloc.UnalignedOffset);
+        Alloc.IndexCount = IndexCount;
+    }
+    return Alloc;
+}
+
+void GeometryPool::Free(Allocation&& Alloc)
+{
+    if (!Alloc.IsValid())
+        return;
+
+    {
+        std::lock_guard<std::mutex> Lock{m_AllocationMgrMtx};
+        m_VertexAllocationsMgr.Free(Alloc.FirstVertex, Alloc.VertexCount);
+        if (Alloc.IndexCount > 0)
+            m_IndexAllocationsMgr.Free(Alloc.FirstIndex, Alloc.IndexCount);
+    }
+    Alloc = Allocation{};
+}
+
+void GeometryPool::UpdateVertices(IDeviceContext*   pContext,
+                                  const Allocation& Alloc,
+                                  Uint32            Stream,
+                                  const void*       pData)
+{
+    VERIFY_EXPR(Stream < m_Desc.NumVertexStreams && Alloc.VertexCount > 0);
+
+    CommitGrowth(pContext);
+
+    const auto Stride = m_Desc.VertexStrides[Stream];
+    pContext->UpdateBuffer(m_pVertexBuffers[Stream], Alloc.FirstVertex * Stride, Alloc.VertexCount * Stride, pData, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+}
+
+void GeometryPool::UpdateIndices(IDeviceContext*   pContext,
+                                 const Allocation& Alloc,
+                                 const void*       pData)
+{
+    VERIFY_EXPR(Alloc.IndexCount > 0);
+
+    CommitGrowth(pContext);
+
+    const auto IndexSize = GetValueSize(m_Desc.IndexType);
+    pContext->UpdateBuffer(m_pIndexBuffer, Alloc.FirstIndex * IndexSize, Alloc.IndexCount * IndexSize, pData, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+}
+
+void GeometryPool::GetUsage(Uint32& UsedVertices, Uint32& UsedIndices)
+{
+    std::lock_guard<std::mutex> Lock{m_AllocationMgrMtx};
+
+    UsedVertices = static_cast<Uint32>(m_VertexAllocationsMgr.GetUsedSize());
+    UsedIndices  = static_cast<Uint32>(m_IndexAllocationsMgr.GetUsedSize());
+}
+
+void GeometryPool::GetCapacity(Uint32& VertexCapacity, Uint32& IndexCapacity)
+{
+    std::lock_guard<std::mutex> Lock{m_AllocationMgrMtx};
+
+    VertexCapacity = static_cast<Uint32>(m_VertexAllocationsMgr.GetMaxSize());
+    IndexCapacity  = static_cast<Uint32>(m_IndexAllocationsMgr.GetMaxSize());
+}
+
+void GeometryPool::CommitGrowth(IDeviceContext* pContext)
+{
+    std::lock_guard<std::mutex> Lock{m_AllocationMgrMtx};
+
+    const auto VertexCapacity = static_cast<Uint32>(m_VertexAllocationsMgr.GetMaxSize());
+    if (VertexCapacity > m_BufferVertexCapacity)
+    {
+        for (Uint32 s = 0; s < m_Desc.NumVertexStreams; ++s)
+        {
+            RefCntAutoPtr<IBuffer> pNewBuffer;
+            CreateVertexBuffer(s, VertexCapacity, pNewBuffer);
+            pContext->CopyBuffer(m_pVertexBuffers[s], 0, RESOURCE_STATE_TRANSITION_MODE_TRANSITION,
+                                 pNewBuffer, 0, m_BufferVertexCapacity * m_Desc.VertexStrides[s], RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+            m_pVertexBuffers[s] = std::move(pNewBuffer);
+        }
+        m_BufferVertexCapacity = VertexCapacity;
+    }
+
+    const auto IndexCapacity = static_cast<Uint32>(m_IndexAllocationsMgr.GetMaxSize());
+    if (IndexCapacity > m_BufferIndexCapacity)
+    {
+        RefCntAutoPtr<IBuffer> pNewBuffer;
+        CreateIndexBuffer(IndexCapacity, pNewBuffer);
+        pContext->CopyBuffer(m_pIndexBuffer, 0, RESOURCE_STATE_TRANSITION_MODE_TRANSITION,
+                             pNewBuffer, 0, m_BufferIndexCapacity * GetValueSize(m_Desc.IndexType), RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+        m_pIndexBuffer        = std::move(pNewBuffer);
+        m_BufferIndexCapacity = IndexCapacity;
+    }
+}
+
+} // namespace Diligent
@@ -0,0 +1,697 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+#include "MeshOptimizer.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "DebugUtilities.hpp"
+
+namespace Diligent
+{
+
+namespace
+{
+
+static constexpr Uint32 InvalidVertex = ~Uint32{0};
+
+// Simulates FIFO vertex cache using timestamps: a vertex is in the cache
+// if it was added to it less than CacheSize misses ago.
+class VertexCacheSimulator
+{
+public:
+    VertexCacheSimulator(Uint32 NumVertices, Uint32 CacheSize) :
+        m_CacheSize{CacheSize},
+        m_Timestamp{CacheSize + 1},
+        m_CacheTimestamps(NumVertices, 0)
+    {
+        VERIFY(CacheSize > 0, "Cache size must not be zero");
+    }
+
+    // Returns true if the vertex was not in the cache
+    bool Access(Uint32 Vertex)
+    {
+        VERIFY_EXPR(Vertex < m_CacheTimestamps.size());
+        if (m_Timestamp - m_CacheTimestamps[Vertex] > m_CacheSize)
+        {
+            m_CacheTimestamps[Vertex] = m_Timestamp++;
+            return true;
+        }
+        return false;
+    }
+
+    void Flush()
+    {
+        m_Timestamp += m_CacheSize + 1;
+    }
+
+private:
+    const Uint32        m_CacheSize;
+    Uint32              m_Timestamp;
+    std::vector<Uint32> m_CacheTimestamps;
+};
+
+const float3& GetPosition(const float3* pPositions, size_t PositionStride, Uint32 Vertex)
+{
+    return *reinterpret_cast<const float3*>(reinterpret_cast<const Uint8*>(pPositions) + Vertex * PositionStride);
+}
+
+// Symmetric 4x4 matrix that accumulates squared distances to a set of planes
+struct Quadric
+{
+    double a2 = 0, ab = 0, ac = 0, ad = 0;
+    double b2 = 0, bc = 0, bd = 0;
+    double c2 = 0, cd = 0;
+    double d2 = 0;
+
+    // The total weight of the accumulated planes
+    double w = 0;
+
+    Quadric() = default;
+
+    Quadric(const float3& N, double d, double Weight)
+    {
+        const double a = N.x;
+        const double b = N.y;
+        const double c = N.z;
+        // clang-format off
+        a2 = a * a * Weight; ab = a * b * Weight; ac = a * c * Weight; ad = a * d * Weight;
+                             b2 = b * b * Weight; bc = b * c * Weight; bd = b * d * Weight;
+                                                  c2 = c * c * Weight; cd = c * d * Weight;
+                                                                       d2 = d * d * Weight;
+        // clang-format on
+        w = Weight;
+    }
+
+    Quadric& operator+=(const Quadric& Q)
+    {
+        // clang-format off
+        a2 += Q.a2; ab += Q.ab; ac += Q.ac; ad += Q.ad;
+                    b2 += Q.b2; bc += Q.bc; bd += Q.bd;
+                                c2 += Q.c2; cd += Q.cd;
+                                            d2 += Q.d2;
+        // clang-format on
+        w += Q.w;
+        return *this;
+    }
+
+    // Returns the weighted sum of squared distances from the point to the planes
+    double Evaluate(const float3& P) const
+    {
+        const double x = P.x;
+        const double y = P.y;
+        const double z = P.z;
+
+        const double Err =
+            x * x * a2 + y * y * b2 + z * z * c2 +
+            2 * (x * y * ab + x * z * ac + y * z * bc) +
+            2 * (x * ad + y * bd + z * cd) +
+            d2;
+        return std::max(Err, 0.0);
+    }
+};
+
+// Returns the squared distance error of collapsing a vertex with quadric Q0 into a vertex with quadric Q1
+double GetCollapseError(const Quadric& Q0, const Quadric& Q1, const float3& P)
+{
+    Quadric Q = Q0;
+    Q += Q1;
+    return Q.w > 0 ? Q.Evaluate(P) / Q.w : 0;
+}
+
+} // namespace
+
+
+VertexCacheStatistics AnalyzeVertexCache(const Uint32* pIndices,
+                                         size_t        NumIndices,
+                                         Uint32        NumVertices,
+                                         Uint32        CacheSize)
+{
+    VERIFY(NumIndices % 3 == 0, "The number of indices (", NumIndices, ") is not a multiple of 3");
+
+    VertexCacheSimulator Cache{NumVertices, CacheSize};
+    std::vector<bool>    Referenced(NumVertices);
+
+    VertexCacheStatistics Stats;
+    for (size_t i = 0; i < NumIndices; ++i)
+    {
+        const auto v = pIndices[i];
+        if (Cache.Access(v))
+            ++Stats.CacheMissCount;
+        if (!Referenced[v])
+        {
+            Referenced[v] = true;
+            ++Stats.VertexCount;
+        }
+    }
+    Stats.TriangleCount = static_cast<Uint32>(NumIndices / 3);
+
+    // Recompute the ratios
+    return VertexCacheStatistics{} += Stats;
+}
+
+
+VertexFetchStatistics AnalyzeVertexFetch(const Uint32* pIndices,
+                                         size_t        NumIndices,
+                                         Uint32        NumVertices,
+                                         Uint32        VertexSize,
+                                         Uint32        CacheLineSize,
+                                         Uint32        CacheLineCount)
+{
+    VERIFY(VertexSize > 0 && CacheLineSize > 0 && CacheLineCount > 0, "Vertex size and cache parameters must not be zero");
+
+    std::vector<size_t> CacheTags(CacheLineCount, ~size_t{0});
+    std::vector<bool>   Referenced(NumVertices);
+
+    VertexFetchStatistics Stats;
+
+    Uint32 NumReferencedVertices = 0;
+    for (size_t i = 0; i < NumIndices; ++i)
+    {
+        const auto v = pIndices[i];
+        VERIFY_EXPR(v < NumVertices);
+        if (!Referenced[v])
+        {
+            Referenced[v] = true;
+            ++NumReferencedVertices;
+        }
+
+        const size_t StartLine = size_t{v} * VertexSize / CacheLineSize;
+        const size_t EndLine   = (size_t{v} * VertexSize + VertexSize - 1) / CacheLineSize;
+        for (auto Line = StartLine; Line <= EndLine; ++Line)
+        {
+            auto& Tag = CacheTags[Line % CacheLineCount];
+            if (Tag != Line)
+            {
+                Tag = Line;
+                Stats.BytesFetched += CacheLineSize;
+            }
+        }
+    }
+
+    if (NumReferencedVertices > 0)
+        Stats.Overfetch = static_cast<float>(Stats.BytesFetched) / static_cast<float>(NumReferencedVertices * VertexSize);
+
+    return Stats;
+}
+
+
+void OptimizeVertexCache(Uint32*       pDstIndices,
+                         const Uint32* pIndices,
+                         size_t        NumIndices,
+                         Uint32        NumVertices,
+                         Uint32        CacheSize)
+{
+    VERIFY(NumIndices % 3 == 0, "The number of indices (", NumIndices, ") is not a multiple of 3");
+    VERIFY(pDstIndices != pIndices, "In-place optimization is not supported");
+
+    const auto NumTriangles = NumIndices / 3;
+
+    // Vertex-triangle adjacency in compressed form: triangles adjacent to vertex v
+    // are AdjTriangles[AdjOffsets[v]] ... AdjTriangles[AdjOffsets[v+1]-1].
+    std::vector<Uint32> LiveTriangles(NumVertices);
+    for (size_t i = 0; i < NumIndices; ++i)
+    {
+        VERIFY_EXPR(pIndices[i] < NumVertices);
+        ++LiveTriangles[pIndices[i]];
+    }
+
+    std::vector<Uint32> AdjOffsets(size_t{NumVertices} + 1);
+    for (Uint32 v = 0; v < NumVertices; ++v)
+        AdjOffsets[v + 1] = AdjOffsets[v] + LiveTriangles[v];
+
+    std::vector<Uint32> AdjTriangles(NumIndices);
+    {
+        std::vector<Uint32> AdjCursors{AdjOffsets.begin(), AdjOffsets.end() - 1};
+        for (size_t i = 0; i < NumIndices; ++i)
+            AdjTriangles[AdjCursors[pIndices[i]]++] = static_cast<Uint32>(i / 3);
+    }
+
+    std::vector<Uint32> CacheTimestamps(NumVertices, 0);
+    std::vector<bool>   Emitted(NumTriangles);
+    std::vector<Uint32> DeadEndStack;
+    std::vector<Uint32> Candidates;
+    DeadEndStack.reserve(NumIndices);
+
+    Uint32 Timestamp  = CacheSize + 1;
+    Uint32 NextVertex = 0; // Input-order cursor used when dead-end stack is exhausted
+
+    auto SkipDeadEnd = [&]() {
+        while (!DeadEndStack.empty())
+        {
+            const auto v = DeadEndStack.back();
+            DeadEndStack.pop_back();
+            if (LiveTriangles[v] > 0)
+                return v;
+        }
+        for (; NextVertex < NumVertices; ++NextVertex)
+        {
+            if (LiveTriangles[NextVertex] > 0)
+                return NextVertex;
+        }
+        return InvalidVertex;
+    };
+
+    size_t DstIdx = 0;
+    for (auto FanningVertex = SkipDeadEnd(); FanningVertex != InvalidVertex;)
+    {
+        // Emit all live triangles adjacent to the fanning vertex
+        Candidates.clear();
+        for (auto a = AdjOffsets[FanningVertex]; a < AdjOffsets[FanningVertex + 1]; ++a)
+        {
+            const auto t = AdjTriangles[a];
+            if (Emitted[t])
+                continue;
+
+            for (Uint32 k = 0; k < 3; ++k)
+            {
+                const auto v = pIndices[t * 3 + k];
+
+                pDstIndices[DstIdx++] = v;
+                DeadEndStack.push_back(v);
+                Candidates.push_back(v);
+                --LiveTriangles[v];
+                if (Timestamp - CacheTimestamps[v] > CacheSize)
+                    CacheTimestamps[v] = Timestamp++;
+            }
+            Emitted[t] = true;
+        }
+
+        // Select the next fanning vertex among the vertices of the emitted triangles:
+        // prefer the oldest vertex that will still be in the cache after all its
+        // remaining triangles are emitted.
+        auto  NextFanningVertex = InvalidVertex;
+        Int64 BestPriority      = -1;
+        for (auto v : Candidates)
+        {
+            if (LiveTriangles[v] == 0)
+                continue;
+
+            Int64 Priority = 0;
+            if (Timestamp - CacheTimestamps[v] + 2 * LiveTriangles[v] <= CacheSize)
+                Priority = Timestamp - CacheTimestamps[v];
+            if (Priority > BestPriority)
+            {
+                BestPriority      = Priority;
+                NextFanningVertex = v;
+            }
+        }
+
+        FanningVertex = NextFanningVertex != InvalidVertex ? NextFanningVertex : SkipDeadEnd();
+    }
+    VERIFY_EXPR(DstIdx == NumIndices);
+}
+
+
+void OptimizeOverdraw(Uint32*       pDstIndices,
+                      const Uint32* pIndices,
+                      size_t        NumIndices,
+                      const float3* pPositions,
+                      size_t        PositionStride,
+                      Uint32        NumVertices,
+                      float         Threshold,
+                      Uint32        CacheSize)
+{
+    VERIFY(NumIndices % 3 == 0, "The number of indices (", NumIndices, ") is not a multiple of 3");
+    VERIFY(pDstIndices != pIndices, "In-place optimization is not supported");
+
+    const auto NumTriangles = static_cast<Uint32>(NumIndices / 3);
+    if (NumTriangles == 0)
+        return;
+
+    // Hard boundaries are the triangles where all three vertices miss the cache,
+    // which is where the cache optimizer hits a dead end.
+    std::vector<Uint32> HardBoundaries;
+    std::vector<Uint32> TriangleMisses(NumTriangles);
+    {
+        VertexCacheSimulator Cache{NumVertices, CacheSize};
+        for (Uint32 t = 0; t < NumTriangles; ++t)
+        {
+            for (Uint32 k = 0; k < 3; ++k)
+                TriangleMisses[t] += Cache.Access(pIndices[t * 3 + k]) ? 1 : 0;
+            if (t == 0 || TriangleMisses[t] == 3)
+                HardBoundaries.push_back(t);
+        }
+    }
+    HardBoundaries.push_back(NumTriangles);
+
+    // Split hard clusters further at the points where the local cache miss ratio
+    // of the current soft cluster is not worse than the ratio of the hard cluster.
+    std::vector<Uint32> Clusters;
+    {
+        VertexCacheSimulator Cache{NumVertices, CacheSize};
+        for (size_t h = 0; h + 1 < HardBoundaries.size(); ++h)
+        {
+            const auto HardStart = HardBoundaries[h];
+            const auto HardEnd   = HardBoundaries[h + 1];
+
+            Uint32 HardMisses = 0;
+            for (auto t = HardStart; t < HardEnd; ++t)
+                HardMisses += TriangleMisses[t];
+            const float TargetACMR = static_cast<float>(HardMisses) / static_cast<float>(HardEnd - HardStart) * Threshold;
+
+            Cache.Flush();
+            Clusters.push_back(HardStart);
+            Uint32 SoftStart  = HardStart;
+            Uint32 SoftMisses = 0;
+            for (auto t = HardStart; t < HardEnd; ++t)
+            {
+                for (Uint32 k = 0; k < 3; ++k)
+                    SoftMisses += Cache.Access(pIndices[t * 3 + k]) ? 1 : 0;
+
+                if (t + 1 < HardEnd && static_cast<float>(SoftMisses) <= TargetACMR * static_cast<float>(t + 1 - SoftStart))
+                {
+                    Cache.Flush();
+                    SoftStart  = t + 1;
+                    SoftMisses = 0;
+                    Clusters.push_back(SoftStart);
+                }
+            }
+        }
+    }
+    Clusters.push_back(NumTriangles);
+    const auto NumClusters = Clusters.size() - 1;
+
+    // Compute area-weighted centroid and normal of every cluster
+    std::vector<float3> ClusterCentroids(NumClusters);
+    std::vector<float3> ClusterNormals(NumClusters);
+    std::vector<float>  ClusterAreas(NumClusters);
+
+    float3 MeshCentroid;
+    float  MeshArea = 0;
+    for (size_t c = 0; c < NumClusters; ++c)
+    {
+        for (auto t = Clusters[c]; t < Clusters[c + 1]; ++t)
+        {
+            const auto& P0 = GetPosition(pPositions, PositionStride, pIndices[t * 3 + 0]);
+            const auto& P1 = GetPosition(pPositions, PositionStride, pIndices[t * 3 + 1]);
+            const auto& P2 = GetPosition(pPositions, PositionStride, pIndices[t * 3 + 2]);
+
+            const auto N    = cross(P1 - P0, P2 - P0);
+            const auto Area = length(N);
+
+            ClusterCentroids[c] += (P0 + P1 + P2) * (Area / 3.f);
+            ClusterNormals[c] += N;
+            ClusterAreas[c] += Area;
+        }
+        MeshCentroid += ClusterCentroids[c];
+        MeshArea += ClusterAreas[c];
+    }
+    if (MeshArea > 0)
+        MeshCentroid = MeshCentroid / MeshArea;
+
+    std::vector<float> SortKeys(NumClusters);
+    for (size_t c = 0; c < NumClusters; ++c)
+    {
+        if (ClusterAreas[c] > 0)
+        {
+            const auto Centroid = ClusterCentroids[c] / ClusterAreas[c];
+            const auto NormLen  = length(ClusterNormals[c]);
+            SortKeys[c]         = NormLen > 0 ? dot(Centroid - MeshCentroid, ClusterNormals[c] / NormLen) : 0.f;
+        }
+    }
+
+    // Draw the clusters that face away from the mesh center first as they are
+    // more likely to occlude the rest of the mesh.
+    std::vector<Uint32> ClusterOrder(NumClusters);
+    for (Uint32 c = 0; c < NumClusters; ++c)
+        ClusterOrder[c] = c;
+    std::stable_sort(ClusterOrder.begin(), ClusterOrder.end(),
+                     [&SortKeys](Uint32 c0, Uint32 c1) {
+                         return SortKeys[c0] > SortKeys[c1];
+                     });
+
+    size_t DstIdx = 0;
+    for (auto c : ClusterOrder)
+    {
+        for (auto i = Clusters[c] * 3; i < Clusters[c + 1] * 3; ++i)
+            pDstIndices[DstIdx++] = pIndices[i];
+    }
+    VERIFY_EXPR(DstIdx == NumIndices);
+}
+
+
+Uint32 ComputeVertexFetchRemap(Uint32*       pRemap,
+                               const Uint32* pIndices,
+                               size_t        NumIndices,
+                               Uint32        NumVertices)
+{
+    std::fill(pRemap, pRemap + NumVertices, InvalidVertex);
+
+    Uint32 NextVertex = 0;
+    for (size_t i = 0; i < NumIndices; ++i)
+    {
+        const auto v = pIndices[i];
+        VERIFY_EXPR(v < NumVertices);
+        if (pRemap[v] == InvalidVertex)
+            pRemap[v] = NextVertex++;
+    }
+
+    const auto NumReferencedVertices = NextVertex;
+    for (Uint32 v = 0; v < NumVertices; ++v)
+    {
+        if (pRemap[v] == InvalidVertex)
+            pRemap[v] = NextVertex++;
+    }
+
+    return NumReferencedVertices;
+}
+
+
+size_t SimplifyMesh(Uint32*       pDstIndices,
+                    const Uint32* pIndices,
+                    size_t        NumIndices,
+                    const float3* pPositions,
+                    size_t        PositionStride,
+                    Uint32        NumVertices,
+                    size_t        TargetIndexCount,
+                    float         TargetError,
+                    float*        pResultError)
+{
+    VERIFY(NumIndices % 3 == 0, "The number of indices (", NumIndices, ") is not a multiple of 3");
+
+    std::vector<Uint32> Indices{pIndices, pIndices + NumIndices};
+
+    auto GetPos = [&](Uint32 v) -> const float3& {
+        return GetPosition(pPositions, PositionStride, v);
+    };
+
+    // Accumulate area-weighted triangle plane quadrics at every vertex
+    std::vector<Quadric> Quadrics(NumVertices);
+    for (size_t i = 0; i < NumIndices; i += 3)
+    {
+        const auto& P0 = GetPos(Indices[i + 0]);
+        const auto& P1 = GetPos(Indices[i + 1]);
+        const auto& P2 = GetPos(Indices[i + 2]);
+
+        auto       N    = cross(P1 - P0, P2 - P0);
+        const auto Area = length(N);
+        if (Area == 0)
+            continue;
+        N = N / Area;
+
+        const Quadric Q{N, -dot(N, P0), Area};
+        for (Uint32 k = 0; k < 3; ++k)
+            Quadrics[Indices[i + k]] += Q;
+    }
+
+    // Lock vertices on open edges: an edge is open if it has no matching edge with the
+    // opposite direction. Edges are encoded as 64-bit keys and sorted to find the matches.
+    std::vector<bool> Locked(NumVertices);
+    {
+        std::vector<Uint64> Edges;
+        Edges.reserve(NumIndices);
+        for (size_t i = 0; i < NumIndices; i += 3)
+        {
+            for (Uint32 k = 0; k < 3; ++k)
+            {
+                const Uint64 v0 = Indices[i + k];
+                const Uint64 v1 = Indices[i + (k + 1) % 3];
+                Edges.push_back((v0 << 32u) | v1);
+            }
+        }
+        std::sort(Edges.begin(), Edges.end());
+        for (auto Edge : Edges)
+        {
+            const auto   v0       = static_cast<Uint32>(Edge >> 32u);
+            const auto   v1       = static_cast<Uint32>(Edge & 0xFFFFFFFFu);
+            const Uint64 Opposite = (Uint64{v1} << 32u) | v0;
+            if (!std::binary_search(Edges.begin(), Edges.end(), Opposite))
+                Locked[v0] = Locked[v1] = true;
+        }
+    }
+
+    struct Collapse
+    {
+        double Error;
+        Uint32 v0; // Vertex that is removed
+        Uint32 v1; // Vertex that v0 is collapsed into
+    };
+    std::vector<Collapse> Collapses;
+    std::vector<bool>     Touched(NumVertices);
+    std::vector<Uint32>   AdjOffsets(size_t{NumVertices} + 1);
+    std::vector<Uint32>   AdjTriangles;
+
+    const double MaxError    = static_cast<double>(TargetError) * static_cast<double>(TargetError);
+    double       ResultError = 0;
+
+    // Every pass collapses a set of independent edges in the order of increasing error
+    constexpr Uint32 MaxPasses = 64;
+    for (Uint32 Pass = 0; Pass < MaxPasses && Indices.size() > TargetIndexCount; ++Pass)
+    {
+        Collapses.clear();
+        for (size_t i = 0; i < Indices.size(); i += 3)
+        {
+            for (Uint32 k = 0; k < 3; ++k)
+            {
+                const auto v0 = Indices[i + k];
+                const auto v1 = Indices[i + (k + 1) % 3];
+                if (!Locked[v0])
+                    Collapses.push_back({GetCollapseError(Quadrics[v0], Quadrics[v1], GetPos(v1)), v0, v1});
+                if (!Locked[v1])
+                    Collapses.push_back({GetCollapseError(Quadrics[v1], Quadrics[v0], GetPos(v0)), v1, v0});
+            }
+        }
+        std::sort(Collapses.begin(), Collapses.end(),
+                  [](const Collapse& c0, const Collapse& c1) {
+                      return c0.Error < c1.Error;
+                  });
+
+        // Vertex-triangle adjacency used to check that collapses do not flip triangles
+        std::fill(AdjOffsets.begin(), AdjOffsets.end(), 0);
+        for (auto v : Indices)
+            ++AdjOffsets[v + 1];
+        for (Uint32 v = 0; v < NumVertices; ++v)
+            AdjOffsets[v + 1] += AdjOffsets[v];
+        AdjTriangles.resize(Indices.size());
+        {
+            std::vector<Uint32> AdjCursors{AdjOffsets.begin(), AdjOffsets.end() - 1};
+            for (size_t i = 0; i < Indices.size(); ++i)
+                AdjTriangles[AdjCursors[Indices[i]]++] = static_cast<Uint32>(i / 3);
+        }
+
+        std::fill(Touched.begin(), Touched.end(), false);
+
+        // Every collapse of an interior edge removes two triangles
+        const size_t MaxCollapses  = (Indices.size() - TargetIndexCount) / 6 + 1;
+        size_t       NumCollapses  = 0;
+        bool         ErrorExceeded = false;
+        for (const auto& c : Collapses)
+        {
+            if (NumCollapses >= MaxCollapses)
+                break;
+            if (c.Error > MaxError)
+            {
+                ErrorExceeded = true;
+                break;
+            }
+            if (Touched[c.v0] || Touched[c.v1])
+                continue;
+
+            // Reject the collapse if any remaining triangle adjacent to v0 flips
+            const auto& NewPos  = GetPos(c.v1);
+            bool        Flipped = false;
+            for (auto a = AdjOffsets[c.v0]; a < AdjOffsets[c.v0 + 1] && !Flipped; ++a)
+            {
+                const auto* Tri = &Indices[AdjTriangles[a] * 3];
+                if (Tri[0] == c.v1 || Tri[1] == c.v1 || Tri[2] == c.v1)
+                    continue; // The triangle becomes degenerate and is removed
+
+                float3 P[3]    = {GetPos(Tri[0]), GetPos(Tri[1]), GetPos(Tri[2])};
+                const auto N0  = cross(P[1] - P[0], P[2] - P[0]);
+                for (Uint32 k = 0; k < 3; ++k)
+                {
+                    if (Tri[k] == c.v0)
+                        P[k] = NewPos;
+                }
+                const auto N1 = cross(P[1] - P[0], P[2] - P[0]);
+                Flipped       = dot(N0, N1) <= 0;
+            }
+            if (Flipped)
+                continue;
+
+            // Do not allow other collapses in the neighborhood during this pass as they
+            // would invalidate the flip test.
+            for (auto a = AdjOffsets[c.v0]; a < AdjOffsets[c.v0 + 1]; ++a)
+            {
+                const auto* Tri = &Indices[AdjTriangles[a] * 3];
+                Touched[Tri[0]] = Touched[Tri[1]] = Touched[Tri[2]] = true;
+            }
+
+            Quadrics[c.v1] += Quadrics[c.v0];
+            for (auto a = AdjOffsets[c.v0]; a < AdjOffsets[c.v0 + 1]; ++a)
+            {
+                auto* Tri = &Indices[AdjTriangles[a] * 3];
+                for (Uint32 k = 0; k < 3; ++k)
+                {
+                    if (Tri[k] == c.v0)
+                        Tri[k] = c.v1;
+                }
+            }
+
+            ResultError = std::max(ResultError, c.Error);
+            ++NumCollapses;
+        }
+
+        // Remove degenerate triangles
+        size_t DstIdx = 0;
+        for (size_t i = 0; i < Indices.size(); i += 3)
+        {
+            const auto v0 = Indices[i + 0];
+            const auto v1 = Indices[i + 1];
+            const auto v2 = Indices[i + 2];
+            if (v0 != v1 && v1 != v2 && v2 != v0)
+            {
+                Indices[DstIdx++] = v0;
+                Indices[DstIdx++] = v1;
+                Indices[DstIdx++] = v2;
+            }
+        }
+        Indices.resize(DstIdx);
+
+        if (NumCollapses == 0 || ErrorExceeded)
+            break;
+    }
+
+    std::copy(Indices.begin(), Indices.end(), pDstIndices);
+    if (pResultError != nullptr)
+        *pResultError = static_cast<float>(std::sqrt(ResultError));
+
+    return Indices.size();
+}
+
+
+void RemapIndices(Uint32*       pIndices,
+                  size_t        NumIndices,
+                  const Uint32* pRemap)
+{
+    for (size_t i = 0; i < NumIndices; ++i)
+        pIndices[i] = pRemap[pIndices[i]];
+}
+
+} // namespace Diligent
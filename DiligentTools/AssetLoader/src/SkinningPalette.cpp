@@ -0,0 +1,285 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+#include "SkinningPalette.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#    include <xmmintrin.h>
+#    define DILIGENT_SKINNING_USE_SSE 1
+#else
+#    define DILIGENT_SKINNING_USE_SSE 0
+#endif
+
+#include "GLTFLoader.hpp"
+#include "DebugUtilities.hpp"
+#include "ThreadPool.hpp"
+
+namespace Diligent
+{
+
+namespace
+{
+
+#if DILIGENT_SKINNING_USE_SSE
+
+// Computes Row * M, where M is given by its four rows
+inline __m128 MulRow(__m128 Row, const __m128 (&M)[4])
+{
+    __m128 r = _mm_mul_ps(_mm_shuffle_ps(Row, Row, _MM_SHUFFLE(0, 0, 0, 0)), M[0]);
+    r        = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(Row, Row, _MM_SHUFFLE(1, 1, 1, 1)), M[1]));
+    r        = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(Row, Row, _MM_SHUFFLE(2, 2, 2, 2)), M[2]));
+    r        = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(Row, Row, _MM_SHUFFLE(3, 3, 3, 3)), M[3]));
+    return r;
+}
+
+inline void LoadMatrix(const float4x4& M, __m128 (&Rows)[4])
+{
+    Rows[0] = _mm_loadu_ps(&M._11);
+    Rows[1] = _mm_loadu_ps(&M._21);
+    Rows[2] = _mm_loadu_ps(&M._31);
+    Rows[3] = _mm_loadu_ps(&M._41);
+}
+
+#endif
+
+} // namespace
+
+void ComputeSkinningMatricesRef(const float4x4*        pInverseBindMatrices,
+                                const float4x4* const* ppJointMatrices,
+                                const float4x4&        InverseMeshMatrix,
+                                Uint32                 NumJoints,
+                                float4x4*              pSkinMatrices)
+{
+    for (Uint32 i = 0; i < NumJoints; ++i)
+    {
+        pSkinMatrices[i] = pInverseBindMatrices[i] * *ppJointMatrices[i] * InverseMeshMatrix;
+    }
+}
+
+void ComputeSkinningMatrices(const float4x4*        pInverseBindMatrices,
+                             const float4x4* const* ppJointMatrices,
+                             const float4x4&        InverseMeshMatrix,
+                             Uint32                 NumJoints,
+                             float4x4*              pSkinMatrices)
+{
+#if DILIGENT_SKINNING_USE_SSE
+    __m128 InvMesh[4];
+    LoadMatrix(InverseMeshMatrix, InvMesh);
+    for (Uint32 i = 0; i < NumJoints; ++i)
+    {
+        __m128 Joint[4];
+        LoadMatrix(*ppJointMatrices[i], Joint);
+
+        // Fold the mesh inverse into the joint matrix first: the inverse bind matrix then
+        // only needs to be multiplied by a single matrix.
+        __m128 JointInvMesh[4];
+        for (int r = 0; r < 4; ++r)
+            JointInvMesh[r] = MulRow(Joint[r], InvMesh);
+
+        const float* pInvBind = &pInverseBindMatrices[i]._11;
+        float*       pDst     = &pSkinMatrices[i]._11;
+        for (int r = 0; r < 4; ++r)
+            _mm_storeu_ps(pDst + r * 4, MulRow(_mm_loadu_ps(pInvBind + r * 4), JointInvMesh));
+    }
+#else
+    ComputeSkinningMatricesRef(pInverseBindMatrices, ppJointMatrices, InverseMeshMatrix, NumJoints, pSkinMatrices);
+#endif
+}
+
+float4x4 InverseAffineMatrix(const float4x4& M)
+{
+    // Row-vector convention: M = | A 0 |,  M^-1 = |  A^-1    0 |
+    //                            | t 1 |          | -t*A^-1  1 |
+    const float c00 = M._22 * M._33 - M._23 * M._32;
+    const float c01 = M._23 * M._31 - M._21 * M._33;
+    const float c02 = M._21 * M._32 - M._22 * M._31;
+
+    const float Det = M._11 * c00 + M._12 * c01 + M._13 * c02;
+    if (Det == 0)
+    {
+        return M.Inverse();
+    }
+    const float InvDet = 1.f / Det;
+
+    float4x4 Inv;
+    Inv._11 = c00 * InvDet;
+    Inv._12 = (M._13 * M._32 - M._12 * M._33) * InvDet;
+    Inv._13 = (M._12 * M._23 - M._13 * M._22) * InvDet;
+    Inv._14 = 0;
+
+    Inv._21 = c01 * InvDet;
+    Inv._22 = (M._11 * M._33 - M._13 * M._31) * InvDet;
+    Inv._23 = (M._13 * M._21 - M._11 * M._23) * InvDet;
+    Inv._24 = 0;
+
+    Inv._31 = c02 * InvDet;
+    Inv._32 = (M._12 * M._31 - M._11 * M._32) * InvDet;
+    Inv._33 = (M._11 * M._22 - M._12 * M._21) * InvDet;
+    Inv._34 = 0;
+
+    Inv._41 = -(M._41 * Inv._11 + M._42 * Inv._21 + M._43 * Inv._31);
+    Inv._42 = -(M._41 * Inv._12 + M._42 * Inv._22 + M._43 * Inv._32);
+    Inv._43 = -(M._41 * Inv._13 + M._42 * Inv._23 + M._43 * Inv._33);
+    Inv._44 = 1;
+
+    return Inv;
+}
+
+void MatricesToDualQuaternions(const float4x4* pMatrices,
+                               Uint32          NumMatrices,
+                               float4*         pDualQuats)
+{
+    for (Uint32 i = 0; i < NumMatrices; ++i)
+    {
+        const auto& M = pMatrices[i];
+
+        // Rows of the upper 3x3 block are the images of the basis vectors.
+        // Normalize them to remove the scale.
+        float3 Rows[3] = {
+            normalize(float3{M._11, M._12, M._13}),
+            normalize(float3{M._21, M._22, M._23}),
+            normalize(float3{M._31, M._32, M._33}) //
+        };
+        // Column-vector rotation matrix R[r][c] is the transpose of the row-vector matrix
+        auto R = [&](int r, int c) { return Rows[c][r]; };
+
+        float4      q;
+        const float Trace = R(0, 0) + R(1, 1) + R(2, 2);
+        if (Trace > 0)
+        {
+            const float s = std::sqrt(Trace + 1.f) * 2.f;
+            q             = float4{(R(2, 1) - R(1, 2)) / s, (R(0, 2) - R(2, 0)) / s, (R(1, 0) - R(0, 1)) / s, 0.25f * s};
+        }
+        else if (R(0, 0) > R(1, 1) && R(0, 0) > R(2, 2))
+        {
+            const float s = std::sqrt(1.f + R(0, 0) - R(1, 1) - R(2, 2)) * 2.f;
+            q             = float4{0.25f * s, (R(0, 1) + R(1, 0)) / s, (R(0, 2) + R(2, 0)) / s, (R(2, 1) - R(1, 2)) / s};
+        }
+        else if (R(1, 1) > R(2, 2))
+        {
+            const float s = std::sqrt(1.f + R(1, 1) - R(0, 0) - R(2, 2)) * 2.f;
+            q             = float4{(R(0, 1) + R(1, 0)) / s, 0.25f * s, (R(1, 2) + R(2, 1)) / s, (R(0, 2) - R(2, 0)) / s};
+        }
+        else
+        {
+            const float s = std::sqrt(1.f + R(2, 2) - R(0, 0) - R(1, 1)) * 2.f;
+            q             = float4{(R(0, 2) + R(2, 0)) / s, (R(1, 2) + R(2, 1)) / s, 0.25f * s, (R(1, 0) - R(0, 1)) / s};
+        }
+        q = normalize(q);
+
+        // Dual part: 0.5 * (t, 0) * q
+        const float3 t{M._41, M._42, M._43};
+        const float3 qv{q.x, q.y, q.z};
+        const float3 dv = 0.5f * (q.w * t + cross(t, qv));
+
+        pDualQuats[i * 2 + 0] = q;
+        pDualQuats[i * 2 + 1] = float4{dv, -0.5f * dot(t, qv)};
+    }
+}
+
+float4x4 DualQuaternionToMatrix(const float4& Real, const float4& Dual)
+{
+    const float3 rv{Real.x, Real.y, Real.z};
+    const float3 dv{Dual.x, Dual.y, Dual.z};
+    // Translation: 2 * Dual * conjugate(Real)
+    const float3 t = 2.f * (Real.w * dv - Dual.w * rv + cross(rv, dv));
+
+    auto M = Quaternion{Real}.ToMatrix();
+    M._41  = t.x;
+    M._42  = t.y;
+    M._43  = t.z;
+    return M;
+}
+
+namespace GLTF
+{
+
+void UpdateSkinningPalette(Node& SkinnedNode, SKINNING_PALETTE_FORMAT Format)
+{
+    auto* pMesh = SkinnedNode._Mesh.get();
+    auto* pSkin = SkinnedNode._Skin;
+    if (pMesh == nullptr || pSkin == nullptr)
+        return;
+
+    VERIFY(pSkin->InverseBindMatrices.size() >= pSkin->Joints.size(), "The number of inverse bind matrices is less than the number of joints");
+    const auto NumJoints = static_cast<Uint32>(std::min(pSkin->Joints.size(), pSkin->InverseBindMatrices.size()));
+
+    // Reuse the storage between calls on the same thread
+    static thread_local std::vector<const float4x4*> JointMatrices;
+    JointMatrices.resize(NumJoints);
+    for (Uint32 i = 0; i < NumJoints; ++i)
+        JointMatrices[i] = &pSkin->Joints[i]->GlobalMatrix;
+
+    auto& Transforms = pMesh->Transforms;
+    Transforms.jointMatrix.resize(NumJoints);
+    ComputeSkinningMatrices(pSkin->InverseBindMatrices.data(), JointMatrices.data(), InverseAffineMatrix(SkinnedNode.GlobalMatrix),
+                            NumJoints, Transforms.jointMatrix.data());
+    if (Format == SKINNING_PALETTE_FORMAT_DUAL_QUATERNION)
+    {
+        Transforms.jointDualQuats.resize(size_t{NumJoints} * 2);
+        MatricesToDualQuaternions(Transforms.jointMatrix.data(), NumJoints, Transforms.jointDualQuats.data());
+    }
+    Transforms.jointcount = static_cast<int>(NumJoints);
+}
+
+
+SkinningPaletteJob::SkinningPaletteJob(const CreateInfo& CI) :
+    m_Format{CI.Format},
+    m_ThreadPool{CI.pThreadPool != nullptr ? *CI.pThreadPool : ThreadPool::GetShared()}
+{
+}
+
+void SkinningPaletteJob::Execute(Model* const* ppModels, Uint32 NumModels)
+{
+    m_SkinnedNodes.clear();
+    for (Uint32 m = 0; m < NumModels; ++m)
+    {
+        auto& Model = *ppModels[m];
+        Model.UpdateTransforms(false);
+        for (auto* pNode : Model.LinearNodes)
+        {
+            if (pNode->_Mesh && pNode->_Skin != nullptr)
+                m_SkinnedNodes.push_back(pNode);
+        }
+    }
+
+    if (m_SkinnedNodes.empty())
+        return;
+
+    m_ThreadPool.ParallelFor(static_cast<Uint32>(m_SkinnedNodes.size()),
+                             [this](Uint32 i) //
+                             {
+                                 UpdateSkinningPalette(*m_SkinnedNodes[i], m_Format);
+                             });
+}
+
+} // namespace GLTF
+
+} // namespace Diligent
@@ -0,0 +1,469 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+#include "BCEncoder.hpp"
+#include "ThreadPool.hpp"
+#include "../include/TextureLoaderInternal.hpp"
+#include "RefCntAutoPtr.hpp"
+#include "DebugUtilities.hpp"
+
+#include <algorithm>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <thread>
+
+#include "gtest/gtest.h"
+
+using namespace Diligent;
+
+namespace
+{
+
+struct TestImage
+{
+    std::vector<Uint8> Data;
+    Uint32             Width       = 0;
+    Uint32             Height      = 0;
+    Uint32             NumChannels = 4;
+
+    Uint32 GetStride() const { return Width * NumChannels; }
+};
+
+TestImage CreateGradientImage(Uint32 Width, Uint32 Height)
+{
+    TestImage Img;
+    Img.Width  = Width;
+    Img.Height = Height;
+    Img.Data.resize(size_t{Width} * Height * 4);
+    for (Uint32 y = 0; y < Height; ++y)
+    {
+        for (Uint32 x = 0; x < Width; ++x)
+        {
+            auto* pPixel = &Img.Data[(size_t{y} * Width + x) * 4];
+            pPixel[0]    = static_cast<Uint8>(x * 255 / (Width - 1));
+            pPixel[1]    = static_cast<Uint8>(y * 255 / (Height - 1));
+            pPixel[2]    = static_cast<Uint8>(127.5 + 127.5 * std::sin(static_cast<double>(x + y) * 0.05));
+            pPixel[3]    = static_cast<Uint8>((x + y) * 255 / (Width + Height - 2));
+        }
+    }
+    return Img;
+}
+
+TestImage CreateNoiseImage(Uint32 Width, Uint32 Height)
+{
+    TestImage Img;
+    Img.Width  = Width;
+    Img.Height = Height;
+    Img.Data.resize(size_t{Width} * Height * 4);
+    std::mt19937                       Gen{0};
+    std::uniform_int_distribution<int> Dist{0, 255};
+    for (auto& Byte : Img.Data)
+        Byte = static_cast<Uint8>(Dist(Gen));
+    return Img;
+}
+
+void Unpack565(Uint16 Color, int (&RGB)[3])
+{
+    const int R = (Color >> 11) & 31;
+    const int G = (Color >> 5) & 63;
+    const int B = Color & 31;
+    RGB[0]      = (R << 3) | (R >> 2);
+    RGB[1]      = (G << 2) | (G >> 4);
+    RGB[2]      = (B << 3) | (B >> 2);
+}
+
+// Decodes the RGB channels of a BC1 block
+void DecodeBC1Block(const Uint8* pBlock, Uint8 (&RGBA)[64])
+{
+    Uint16 C0, C1;
+    Uint32 Indices;
+    memcpy(&C0, pBlock, 2);
+    memcpy(&C1, pBlock + 2, 2);
+    memcpy(&Indices, pBlock + 4, 4);
+
+    int Palette[4][3];
+    Unpack565(C0, Palette[0]);
+    Unpack565(C1, Palette[1]);
+    for (int c = 0; c < 3; ++c)
+    {
+        if (C0 > C1)
+        {
+            Palette[2][c] = (2 * Palette[0][c] + Palette[1][c] + 1) / 3;
+            Palette[3][c] = (Palette[0][c] + 2 * Palette[1][c] + 1) / 3;
+        }
+        else
+        {
+            Palette[2][c] = (Palette[0][c] + Palette[1][c]) / 2;
+            Palette[3][c] = 0;
+        }
+    }
+    for (int i = 0; i < 16; ++i)
+    {
+        const auto Idx = (Indices >> (i * 2)) & 3;
+        for (int c = 0; c < 3; ++c)
+            RGBA[i * 4 + c] = static_cast<Uint8>(Palette[Idx][c]);
+    }
+}
+
+// Decodes a BC4 block into the channel with the given offset
+void DecodeBC4Block(const Uint8* pBlock, Uint8 (&RGBA)[64], int Channel)
+{
+    const int A0 = pBlock[0];
+    const int A1 = pBlock[1];
+    int       Palette[8];
+    Palette[0] = A0;
+    Palette[1] = A1;
+    if (A0 > A1)
+    {
+        for (int i = 2; i < 8; ++i)
+            Palette[i] = ((8 - i) * A0 + (i - 1) * A1 + 3) / 7;
+    }
+    else
+    {
+        for (int i = 2; i < 6; ++i)
+            Palette[i] = ((6 - i) * A0 + (i - 1) * A1 + 2) / 5;
+        Palette[6] = 0;
+        Palette[7] = 255;
+    }
+
+    Uint64 Indices = 0;
+    for (int b = 0; b < 6; ++b)
+        Indices |= Uint64{pBlock[2 + b]} << (b * 8);
+    for (int i = 0; i < 16; ++i)
+        RGBA[i * 4 + Channel] = static_cast<Uint8>(Palette[(Indices >> (i * 3)) & 7]);
+}
+
+// Decodes a BC7 mode 6 block
+void DecodeBC7Block(const Uint8* pBlock, Uint8 (&RGBA)[64])
+{
+    Uint32 Pos      = 0;
+    auto   ReadBits = [&](Uint32 NumBits) {
+        Uint32 Value = 0;
+        for (Uint32 b = 0; b < NumBits; ++b, ++Pos)
+            Value |= ((pBlock[Pos >> 3] >> (Pos & 7)) & 1u) << b;
+        return Value;
+    };
+
+    ASSERT_EQ(ReadBits(7), 1u << 6) << "Only mode 6 is supported";
+    int E[2][4];
+    for (int c = 0; c < 4; ++c)
+    {
+        E[0][c] = static_cast<int>(ReadBits(7));
+        E[1][c] = static_cast<int>(ReadBits(7));
+    }
+    for (int e = 0; e < 2; ++e)
+    {
+        const auto P = static_cast<int>(ReadBits(1));
+        for (int c = 0; c < 4; ++c)
+            E[e][c] = (E[e][c] << 1) | P;
+    }
+
+    static constexpr int Weights[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+    for (int i = 0; i < 16; ++i)
+    {
+        const auto Idx = ReadBits(i == 0 ? 3 : 4);
+        for (int c = 0; c < 4; ++c)
+            RGBA[i * 4 + c] = static_cast<Uint8>(((64 - Weights[Idx]) * E[0][c] + Weights[Idx] * E[1][c] + 32) >> 6);
+    }
+    EXPECT_EQ(Pos, 128u);
+}
+
+Uint32 GetBlockSize(TEXTURE_FORMAT Format)
+{
+    return (Format == TEX_FORMAT_BC1_UNORM || Format == TEX_FORMAT_BC4_UNORM) ? 8 : 16;
+}
+
+std::vector<Uint8> Encode(const TestImage& Img, TEXTURE_FORMAT Format, TEXTURE_COMPRESS_QUALITY Quality, ThreadPool* pPool = nullptr)
+{
+    const auto NumBlocksX = (Img.Width + 3) / 4;
+    const auto NumBlocksY = (Img.Height + 3) / 4;
+
+    EncodeBCAttribs Attribs;
+    Attribs.Format         = Format;
+    Attribs.Quality        = Quality;
+    Attribs.pSrcData       = Img.Data.data();
+    Attribs.SrcStride      = Img.GetStride();
+    Attribs.NumSrcChannels = Img.NumChannels;
+    Attribs.Width          = Img.Width;
+    Attribs.Height         = Img.Height;
+    Attribs.DstStride      = NumBlocksX * GetBlockSize(Format);
+
+    std::vector<Uint8> Blocks(size_t{Attribs.DstStride} * NumBlocksY);
+    Attribs.pDstData = Blocks.data();
+    EncodeBC(Attribs, pPool);
+    return Blocks;
+}
+
+// Decodes the blocks and returns the PSNR of the channels stored in the format
+double ComputePSNR(const TestImage& Img, const std::vector<Uint8>& Blocks, TEXTURE_FORMAT Format)
+{
+    const auto BlockSize  = GetBlockSize(Format);
+    const auto NumBlocksX = (Img.Width + 3) / 4;
+
+    Uint32 FirstChannel = 0, NumChannels = 4;
+    switch (Format)
+    {
+        case TEX_FORMAT_BC1_UNORM: NumChannels = 3; break;
+        case TEX_FORMAT_BC4_UNORM: NumChannels = 1; break;
+        case TEX_FORMAT_BC5_UNORM: NumChannels = 2; break;
+        default: break;
+    }
+
+    double SqError    = 0;
+    size_t NumSamples = 0;
+    for (Uint32 y = 0; y < Img.Height; y += 4)
+    {
+        for (Uint32 x = 0; x < Img.Width; x += 4)
+        {
+            const auto* pBlock = &Blocks[(size_t{y / 4} * NumBlocksX + x / 4) * BlockSize];
+
+            Uint8 RGBA[64] = {};
+            switch (Format)
+            {
+                case TEX_FORMAT_BC1_UNORM:
+                    DecodeBC1Block(pBlock, RGBA);
+                    break;
+                case TEX_FORMAT_BC3_UNORM:
+                    DecodeBC4Block(pBlock, RGBA, 3);
+                    DecodeBC1Block(pBlock + 8, RGBA);
+                    break;
+                case TEX_FORMAT_BC4_UNORM:
+                    DecodeBC4Block(pBlock, RGBA, 0);
+                    break;
+                case TEX_FORMAT_BC5_UNORM:
+                    DecodeBC4Block(pBlock, RGBA, 0);
+                    DecodeBC4Block(pBlock + 8, RGBA, 1);
+                    break;
+                case TEX_FORMAT_BC7_UNORM:
+                    DecodeBC7Block(pBlock, RGBA);
+                    break;
+                default:
+                    ADD_FAILURE() << "Unexpected format";
+                    return 0;
+            }
+
+            for (Uint32 by = 0; by < 4 && y + by < Img.Height; ++by)
+            {
+                for (Uint32 bx = 0; bx < 4 && x + bx < Img.Width; ++bx)
+                {
+                    const auto* pSrc = &Img.Data[(size_t{y + by} * Img.Width + x + bx) * Img.NumChannels];
+                    for (Uint32 c = FirstChannel; c < NumChannels; ++c)
+                    {
+                        const auto d = static_cast<double>(pSrc[c]) - static_cast<double>(RGBA[(by * 4 + bx) * 4 + c]);
+                        SqError += d * d;
+                        ++NumSamples;
+                    }
+                }
+            }
+        }
+    }
+
+    const auto MSE = SqError / static_cast<double>(NumSamples);
+    return MSE > 0 ? 10.0 * std::log10(255.0 * 255.0 / MSE) : 100.0;
+}
+
+const char* GetFormatName(TEXTURE_FORMAT Format)
+{
+    switch (Format)
+    {
+        case TEX_FORMAT_BC1_UNORM: return "BC1";
+        case TEX_FORMAT_BC3_UNORM: return "BC3";
+        case TEX_FORMAT_BC4_UNORM: return "BC4";
+        case TEX_FORMAT_BC5_UNORM: return "BC5";
+        case TEX_FORMAT_BC7_UNORM: return "BC7";
+        default: return "unknown";
+    }
+}
+
+const char* GetQualityName(TEXTURE_COMPRESS_QUALITY Quality)
+{
+    switch (Quality)
+    {
+        case TEXTURE_COMPRESS_QUALITY_FAST: return "fast";
+        case TEXTURE_COMPRESS_QUALITY_NORMAL: return "normal";
+        case TEXTURE_COMPRESS_QUALITY_HIGH: return "high";
+        default: return "unknown";
+    }
+}
+
+void TestPSNR(TEXTURE_FORMAT Format, const double (&MinGradientPSNR)[3], const double (&MinNoisePSNR)[3])
+{
+    // Use odd size to test partial blocks
+    const auto Gradient = CreateGradientImage(67, 61);
+    const auto Noise    = CreateNoiseImage(32, 32);
+
+    double PrevPSNR = 0;
+    for (Uint32 q = 0; q < 3; ++q)
+    {
+        const auto Quality = static_cast<TEXTURE_COMPRESS_QUALITY>(q);
+
+        const auto GradientPSNR = ComputePSNR(Gradient, Encode(Gradient, Format, Quality), Format);
+        EXPECT_GE(GradientPSNR, MinGradientPSNR[q]) << GetQualityName(Quality) << " quality";
+        // Higher quality must not be noticeably worse
+        EXPECT_GE(GradientPSNR, PrevPSNR - 0.1) << GetQualityName(Quality) << " quality";
+        PrevPSNR = GradientPSNR;
+
+        const auto NoisePSNR = ComputePSNR(Noise, Encode(Noise, Format, Quality), Format);
+        EXPECT_GE(NoisePSNR, MinNoisePSNR[q]) << GetQualityName(Quality) << " quality";
+    }
+}
+
+TEST(Tools_TextureLoader, EncodeBC1)
+{
+    TestPSNR(TEX_FORMAT_BC1_UNORM, {33, 36, 36}, {11, 12.5, 12.5});
+}
+
+TEST(Tools_TextureLoader, EncodeBC3)
+{
+    TestPSNR(TEX_FORMAT_BC3_UNORM, {34, 37, 37}, {12, 13.5, 13.5});
+}
+
+TEST(Tools_TextureLoader, EncodeBC4)
+{
+    TestPSNR(TEX_FORMAT_BC4_UNORM, {50, 50, 50}, {27, 27, 27});
+}
+
+TEST(Tools_TextureLoader, EncodeBC5)
+{
+    TestPSNR(TEX_FORMAT_BC5_UNORM, {50, 50, 50}, {27, 27, 27});
+}
+
+TEST(Tools_TextureLoader, EncodeBC7)
+{
+    TestPSNR(TEX_FORMAT_BC7_UNORM, {34, 39, 39}, {11, 12, 12});
+}
+
+TEST(Tools_TextureLoader, EncodeBC_SolidColor)
+{
+    TestImage Img;
+    Img.Width  = 8;
+    Img.Height = 8;
+    Img.Data.resize(8 * 8 * 4);
+    for (size_t i = 0; i < Img.Data.size(); i += 4)
+    {
+        Img.Data[i + 0] = 200;
+        Img.Data[i + 1] = 100;
+        Img.Data[i + 2] = 50;
+        Img.Data[i + 3] = 128;
+    }
+
+    for (auto Format : {TEX_FORMAT_BC3_UNORM, TEX_FORMAT_BC4_UNORM, TEX_FORMAT_BC5_UNORM, TEX_FORMAT_BC7_UNORM})
+    {
+        for (Uint32 q = 0; q < 3; ++q)
+        {
+            const auto Blocks = Encode(Img, Format, static_cast<TEXTURE_COMPRESS_QUALITY>(q));
+            // BC3 color is limited by 565 quantization
+            const auto PSNR = ComputePSNR(Img, Blocks, Format);
+            EXPECT_GE(PSNR, Format == TEX_FORMAT_BC3_UNORM ? 40.0 : 48.0) << GetFormatName(Format);
+        }
+    }
+}
+
+TEST(Tools_TextureLoader, EncodeBC_Parallel)
+{
+    const auto Img = CreateGradientImage(129, 67);
+
+    ThreadPool Pool{4};
+    for (auto Format : {TEX_FORMAT_BC1_UNORM, TEX_FORMAT_BC3_UNORM, TEX_FORMAT_BC4_UNORM, TEX_FORMAT_BC5_UNORM, TEX_FORMAT_BC7_UNORM})
+    {
+        const auto Serial   = Encode(Img, Format, TEXTURE_COMPRESS_QUALITY_NORMAL);
+        const auto Parallel = Encode(Img, Format, TEXTURE_COMPRESS_QUALITY_NORMAL, &Pool);
+        EXPECT_EQ(Serial, Parallel);
+    }
+}
+
+TEST(Tools_TextureLoader, CompressImage_NonMultipleOf4)
+{
+    auto TestDimensions = [](Uint32 Width, Uint32 Height, bool ExpectCompressed) {
+        const auto Img = CreateGradientImage(Width, Height);
+
+        Image::EncodeInfo EncodeInfo;
+        EncodeInfo.Width      = Img.Width;
+        EncodeInfo.Height     = Img.Height;
+        EncodeInfo.TexFormat  = TEX_FORMAT_RGBA8_UNORM;
+        EncodeInfo.KeepAlpha  = true;
+        EncodeInfo.pData      = Img.Data.data();
+        EncodeInfo.Stride     = Img.GetStride();
+        EncodeInfo.FileFormat = IMAGE_FILE_FORMAT_PNG;
+        RefCntAutoPtr<IDataBlob> pPngData;
+        Image::Encode(EncodeInfo, &pPngData);
+        ASSERT_NE(pPngData, nullptr);
+
+        ImageLoadInfo ImgLoadInfo;
+        ImgLoadInfo.Format = IMAGE_FILE_FORMAT_PNG;
+        RefCntAutoPtr<Image> pImage;
+        Image::CreateFromDataBlob(pPngData, ImgLoadInfo, &pImage);
+        ASSERT_NE(pImage, nullptr);
+
+        TextureLoadInfo LoadInfo;
+        LoadInfo.CompressedFormat = TEX_FORMAT_BC1_UNORM;
+        PreparedTextureData Data;
+        // The device is only used when mips are generated on the GPU
+        PrepareTextureFromImage(pImage, LoadInfo, nullptr, Data);
+
+        EXPECT_EQ(Data.Desc.Width, Width);
+        EXPECT_EQ(Data.Desc.Height, Height);
+        EXPECT_EQ(Data.Desc.Format, ExpectCompressed ? TEX_FORMAT_BC1_UNORM : TEX_FORMAT_RGBA8_UNORM) << Width << "x" << Height;
+        ASSERT_EQ(Data.SubResources.size(), size_t{Data.Desc.MipLevels});
+        EXPECT_EQ(Data.SubResources[0].Stride, ExpectCompressed ? (Width / 4) * 8 : Width * 4);
+    };
+
+    TestDimensions(32, 16, true);
+    TestDimensions(30, 16, false);
+    TestDimensions(32, 17, false);
+    TestDimensions(5, 3, false);
+}
+
+TEST(Tools_TextureLoader, DISABLED_EncodeBC_Benchmark)
+{
+    const auto Img = CreateGradientImage(2048, 2048);
+
+    ThreadPool Pool{std::max(std::thread::hardware_concurrency(), 2u) - 1};
+    for (auto Format : {TEX_FORMAT_BC1_UNORM, TEX_FORMAT_BC3_UNORM, TEX_FORMAT_BC4_UNORM, TEX_FORMAT_BC5_UNORM, TEX_FORMAT_BC7_UNORM})
+    {
+        for (Uint32 q = 0; q < 3; ++q)
+        {
+            const auto Quality = static_cast<TEXTURE_COMPRESS_QUALITY>(q);
+            for (int Parallel = 0; Parallel <= 1; ++Parallel)
+            {
+                const auto Start  = std::chrono::high_resolution_clock::now();
+                const auto Blocks = Encode(Img, Format, Quality, Parallel ? &Pool : nullptr);
+                const auto End    = std::chrono::high_resolution_clock::now();
+
+                const auto Seconds = std::chrono::duration<double>(End - Start).count();
+                LOG_INFO_MESSAGE(GetFormatName(Format), ' ', GetQualityName(Quality), (Parallel ? " parallel: " : ": "),
+                                 static_cast<double>(Img.Width) * Img.Height / Seconds * 1e-6, " MPix/s, PSNR ",
+                                 ComputePSNR(Img, Blocks, Format), " dB");
+            }
+        }
+    }
+}
+
+} // namespace
@@ -0,0 +1,357 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+#include "GeometryPool.hpp"
+
+#include <vector>
+#include <numeric>
+#include <cstring>
+
+#include "ObjectBase.hpp"
+#include "RefCntAutoPtr.hpp"
+
+#include "gtest/gtest.h"
+
+using namespace Diligent;
+
+namespace
+{
+
+// The tests run without a GPU: the stub device creates buffers that keep their contents
+// in system memory, and the stub context implements the buffer update and copy commands.
+
+class StubBuffer final : public ObjectBase<IBuffer>
+{
+public:
+    StubBuffer(IReferenceCounters* pRefCounters, const BufferDesc& Desc) :
+        ObjectBase<IBuffer>{pRefCounters},
+        m_Desc{Desc},
+        m_Data(Desc.uiSizeInBytes)
+    {
+        // The name is not owned by the description
+        m_Desc.Name = nullptr;
+    }
+
+    // clang-format off
+    virtual const BufferDesc& DILIGENT_CALL_TYPE GetDesc() const override final { return m_Desc; }
+    virtual Int32 DILIGENT_CALL_TYPE GetUniqueID() const override final { return 1; }
+    virtual void DILIGENT_CALL_TYPE CreateView(const BufferViewDesc& ViewDesc, IBufferView** ppView) override final { *ppView = nullptr; }
+    virtual IBufferView* DILIGENT_CALL_TYPE GetDefaultView(BUFFER_VIEW_TYPE ViewType) override final { return nullptr; }
+    virtual void* DILIGENT_CALL_TYPE GetNativeHandle() override final { return m_Data.data(); }
+    virtual void DILIGENT_CALL_TYPE SetState(RESOURCE_STATE State) override final {}
+    virtual RESOURCE_STATE DILIGENT_CALL_TYPE GetState() const override final { return RESOURCE_STATE_UNKNOWN; }
+    // clang-format on
+
+    std::vector<Uint8>& GetData() { return m_Data; }
+
+private:
+    BufferDesc         m_Desc;
+    std::vector<Uint8> m_Data;
+};
+
+class StubRenderDevice final : public ObjectBase<IRenderDevice>
+{
+public:
+    StubRenderDevice(IReferenceCounters* pRefCounters) :
+        ObjectBase<IRenderDevice>{pRefCounters}
+    {}
+
+    virtual void DILIGENT_CALL_TYPE CreateBuffer(const BufferDesc& BuffDesc, const BufferData* pBuffData, IBuffer** ppBuffer) override final
+    {
+        auto* pBuffer = MakeNewRCObj<StubBuffer>()(BuffDesc);
+        pBuffer->QueryInterface(IID_Unknown, reinterpret_cast<IObject**>(ppBuffer));
+        ++NumBuffersCreated;
+    }
+
+    // clang-format off
+    virtual void DILIGENT_CALL_TYPE CreateShader(const ShaderCreateInfo&, IShader**) override final { UNEXPECTED("Not implemented"); }
+    virtual void DILIGENT_CALL_TYPE CreateTexture(const TextureDesc&, const TextureData*, ITexture**) override final { UNEXPECTED("Not implemented"); }
+    virtual void DILIGENT_CALL_TYPE CreateSampler(const SamplerDesc&, ISampler**) override final { UNEXPECTED("Not implemented"); }
+    virtual void DILIGENT_CALL_TYPE CreateResourceMapping(const ResourceMappingDesc&, IResourceMapping**) override final { UNEXPECTED("Not implemented"); }
+    virtual void DILIGENT_CALL_TYPE CreateGraphicsPipelineState(const GraphicsPipelineStateCreateInfo&, IPipelineState**) override final { UNEXPECTED("Not implemented"); }
+    virtual void DILIGENT_CALL_TYPE CreateComputePipelineState(const ComputePipelineStateCreateInfo&, IPipelineState**) override final { UNEXPECTED("Not implemented"); }
+    virtual void DILIGENT_CALL_TYPE CreateFence(const FenceDesc&, IFence**) override final { UNEXPECTED("Not implemented"); }
+    virtual void DILIGENT_CALL_TYPE CreateQuery(const QueryDesc&, IQuery**) override final { UNEXPECTED("Not implemented"); }
+    virtual void DILIGENT_CALL_TYPE CreateRenderPass(const RenderPassDesc&, IRenderPass**) override final { UNEXPECTED("Not implemented"); }
+    virtual void DILIGENT_CALL_TYPE CreateFramebuffer(const FramebufferDesc&, IFramebuffer**) override final { UNEXPECTED("Not implemented"); }
+    virtual const DeviceCaps& DILIGENT_CALL_TYPE GetDeviceCaps() const override final { return m_Caps; }
+    virtual const TextureFormatInfo& DILIGENT_CALL_TYPE GetTextureFormatInfo(TEXTURE_FORMAT) override final { return m_FmtInfo; }
+    virtual const TextureFormatInfoExt& DILIGENT_CALL_TYPE GetTextureFormatInfoExt(TEXTURE_FORMAT) override final { return m_FmtInfo; }
+    virtual void DILIGENT_CALL_TYPE ReleaseStaleResources(bool) override final {}
+    virtual void DILIGENT_CALL_TYPE IdleGPU() override final {}
+    virtual IEngineFactory* DILIGENT_CALL_TYPE GetEngineFactory() const override final { return nullptr; }
+    // clang-format on
+
+    Uint32 NumBuffersCreated = 0;
+
+private:
+    DeviceCaps           m_Caps;
+    TextureFormatInfoExt m_FmtInfo;
+};
+
+class StubDeviceContext final : public ObjectBase<IDeviceContext>
+{
+public:
+    StubDeviceContext(IReferenceCounters* pRefCounters) :
+        ObjectBase<IDeviceContext>{pRefCounters}
+    {}
+
+    virtual void DILIGENT_CALL_TYPE UpdateBuffer(IBuffer* pBuffer, Uint32 Offset, Uint32 Size, const void* pData, RESOURCE_STATE_TRANSITION_MODE) override final
+    {
+        auto& Data = static_cast<StubBuffer*>(pBuffer)->GetData();
+        ASSERT_LE(Offset + Size, Data.size());
+        memcpy(Data.data() + Offset, pData, Size);
+    }
+
+    virtual void DILIGENT_CALL_TYPE CopyBuffer(IBuffer* pSrcBuffer, Uint32 SrcOffset, RESOURCE_STATE_TRANSITION_MODE,
+                                               IBuffer* pDstBuffer, Uint32 DstOffset, Uint32 Size, RESOURCE_STATE_TRANSITION_MODE) override final
+    {
+        const auto& SrcData = static_cast<StubBuffer*>(pSrcBuffer)->GetData();
+        auto&       DstData = static_cast<StubBuffer*>(pDstBuffer)->GetData();
+        ASSERT_LE(SrcOffset + Size, SrcData.size());
+        ASSERT_LE(DstOffset + Size, DstData.size());
+        memcpy(DstData.data() + DstOffset, SrcData.data() + SrcOffset, Size);
+    }
+
+    // clang-format off
+    virtual void DILIGENT_CALL_TYPE SetPipelineState(IPipelineState*) override final { UNEXPECTED("Not implemented"); }
+    virtual void DILIGENT_CALL_TYPE TransitionShaderResources(IPipelineState*, IShaderResourceBinding*) override final { UNEXPECTED("Not implemented"); }
+    virtual void DILIGENT_CALL_TYPE CommitShaderResources(IShaderResourceBinding*, RESOURCE_STATE_TRANSITION_MODE) override final { UNEXPECTED("Not implemented"); }
+    virtual void DILIGENT_CALL_TYPE SetStencilRef(Uint32) override final { UNEXPECTED("Not implemented"); }
+    virtual void DILIGENT_CALL_TYPE SetBlendFactors(const float*) override final { UNEXPECTED("Not implemented"); }
+    virtual void DILIGENT_CALL_TYPE SetVertexBuffers(Uint32, Uint32, IBuffer**, Uint32*, RESOURCE_STATE_TRANSITION_MODE, SET_VERTEX_BUFFERS_FLAGS) override final { UNEXPECTED("Not implemented"); }
+    virtual void DILIGENT_CALL_TYPE InvalidateState() override final { UNEXPECTED("Not implemented"); }
+    virtual void DILIGENT_CALL_TYPE SetIndexBuffer(IBuffer*, Uint32, RESOURCE_STATE_TRANSITION_MODE) override final { UNEXPECTED("Not implemented"); }
+    virtual void DILIGENT_CALL_TYPE SetViewports(Uint32, const Viewport*, Uint32, Uint32) override final { UNEXPECTED("Not implemented"); }
+    virtual void DILIGENT_CALL_TYPE SetScissorRects(Uint32, const Rect*, Uint32, Uint32) override final { UNEXPECTED("Not implemented"); }
+    virtual void DILIGENT_CALL_TYPE SetRenderTargets(Uint32, ITextureView*[], ITextureView*, RESOURCE_STATE_TRANSITION_MODE) override final { UNEXPECTED("Not implemented"); }
+    virtual void DILIGENT_CALL_TYPE BeginRenderPass(const BeginRenderPassAttribs&) override final { UNEXPECTED("Not implemented"); }
+    virtual void DILIGENT_CALL_TYPE NextSubpass() override final { UNEXPECTED("Not implemented"); }
+    virtual void DILIGENT_CALL_TYPE EndRenderPass() override final { UNEXPECTED("Not implemented"); }
+    virtual void DILIGENT_CALL_TYPE Draw(const DrawAttribs&) override final { UNEXPECTED("Not implemented"); }
+    virtual void DILIGENT_CALL_TYPE DrawIndexed(const DrawIndexedAttribs&) override final { UNEXPECTED("Not implemented"); }
+    virtual void DILIGENT_CALL_TYPE DrawIndirect(const DrawIndirectAttribs&, IBuffer*) override final { UNEXPECTED("Not implemented"); }
+    virtual void DILIGENT_CALL_TYPE DrawIndexedIndirect(const DrawIndexedIndirectAttribs&, IBuffer*) override final { UNEXPECTED("Not implemented"); }
+    virtual void DILIGENT_CALL_TYPE DrawMesh(const DrawMeshAttribs&) override final { UNEXPECTED("Not implemented"); }
+    virtual void DILIGENT_CALL_TYPE DrawMeshIndirect(const DrawMeshIndirectAttribs&, IBuffer*) override final { UNEXPECTED("Not implemented"); }
+    virtual void DILIGENT_CALL_TYPE DispatchCompute(const DispatchComputeAttribs&) override final { UNEXPECTED("Not implemented"); }
+    virtual void DILIGENT_CALL_TYPE DispatchComputeIndirect(const DispatchComputeIndirectAttribs&, IBuffer*) override final { UNEXPECTED("Not implemented"); }
+    virtual void DILIGENT_CALL_TYPE ClearDepthStencil(ITextureView*, CLEAR_DEPTH_STENCIL_FLAGS, float, Uint8, RESOURCE_STATE_TRANSITION_MODE) override final { UNEXPECTED("Not implemented"); }
+    virtual void DILIGENT_CALL_TYPE ClearRenderTarget(ITextureView*, const float*, RESOURCE_STATE_TRANSITION_MODE) override final { UNEXPECTED("Not implemented"); }
+    virtual void DILIGENT_CALL_TYPE FinishCommandList(ICommandList**) override final { UNEXPECTED("Not implemented"); }
+    virtual void DILIGENT_CALL_TYPE ExecuteCommandList(ICommandList*) override final { UNEXPECTED("Not implemented"); }
+    virtual void DILIGENT_CALL_TYPE SignalFence(IFence*, Uint64) override final { UNEXPECTED("Not implemented"); }
+    virtual void DILIGENT_CALL_TYPE WaitForFence(IFence*, Uint64, bool) override final { UNEXPECTED("Not implemented"); }
+    virtual void DILIGENT_CALL_TYPE WaitForIdle() override final {}
+    virtual void DILIGENT_CALL_TYPE BeginQuery(IQuery*) override final { UNEXPECTED("Not implemented"); }
+    virtual void DILIGENT_CALL_TYPE EndQuery(IQuery*) override final { UNEXPECTED("Not implemented"); }
+    virtual void DILIGENT_CALL_TYPE Flush() override final {}
+    virtual void DILIGENT_CALL_TYPE MapBuffer(IBuffer*, MAP_TYPE, MAP_FLAGS, PVoid&) override final { UNEXPECTED("Not implemented"); }
+    virtual void DILIGENT_CALL_TYPE UnmapBuffer(IBuffer*, MAP_TYPE) override final { UNEXPECTED("Not implemented"); }
+    virtual void DILIGENT_CALL_TYPE UpdateTexture(ITexture*, Uint32, Uint32, const Box&, const TextureSubResData&, RESOURCE_STATE_TRANSITION_MODE, RESOURCE_STATE_TRANSITION_MODE) override final { UNEXPECTED("Not implemented"); }
+    virtual void DILIGENT_CALL_TYPE CopyTexture(const CopyTextureAttribs&) override final { UNEXPECTED("Not implemented"); }
+    virtual void DILIGENT_CALL_TYPE MapTextureSubresource(ITexture*, Uint32, Uint32, MAP_TYPE, MAP_FLAGS, const Box*, MappedTextureSubresource&) override final { UNEXPECTED("Not implemented"); }
+    virtual void DILIGENT_CALL_TYPE UnmapTextureSubresource(ITexture*, Uint32, Uint32) override final { UNEXPECTED("Not implemented"); }
+    virtual void DILIGENT_CALL_TYPE GenerateMips(ITextureView*) override final { UNEXPECTED("Not implemented"); }
+    virtual void DILIGENT_CALL_TYPE FinishFrame() override final {}
+    virtual void DILIGENT_CALL_TYPE TransitionResourceStates(Uint32, StateTransitionDesc*) override final { UNEXPECTED("Not implemented"); }
+    virtual void DILIGENT_CALL_TYPE ResolveTextureSubresource(ITexture*, ITexture*, const ResolveTextureSubresourceAttribs&) override final { UNEXPECTED("Not implemented"); }
+    // clang-format on
+};
+
+GeometryPool::CreateInfo GetPoolCI(Uint32 VertexCapacity, Uint32 IndexCapacity, bool AllowGrowth)
+{
+    GeometryPool::CreateInfo PoolCI;
+    PoolCI.NumVertexStreams = 2;
+    PoolCI.VertexStrides[0] = 12;
+    PoolCI.VertexStrides[1] = 4;
+    PoolCI.IndexType        = VT_UINT32;
+    PoolCI.VertexCapacity   = VertexCapacity;
+    PoolCI.IndexCapacity    = IndexCapacity;
+    PoolCI.AllowGrowth      = AllowGrowth;
+    return PoolCI;
+}
+
+std::vector<Uint32> MakeData(Uint32 Count, Uint32 Seed)
+{
+    std::vector<Uint32> Data(Count);
+    std::iota(Data.begin(), Data.end(), Seed);
+    return Data;
+}
+
+// Checks that the given range of the buffer contains the data
+void CheckBufferData(IBuffer* pBuffer, Uint32 Offset, const std::vector<Uint32>& Data)
+{
+    const auto& BufferData = static_cast<StubBuffer*>(pBuffer)->GetData();
+    ASSERT_LE(Offset + Data.size() * sizeof(Uint32), BufferData.size());
+    EXPECT_EQ(memcmp(BufferData.data() + Offset, Data.data(), Data.size() * sizeof(Uint32)), 0);
+}
+
+TEST(Tools_AssetLoader, GeometryPoolAllocation)
+{
+    RefCntAutoPtr<StubRenderDevice> pDevice{MakeNewRCObj<StubRenderDevice>()()};
+
+    GeometryPool Pool{pDevice, GetPoolCI(1024, 4096, false)};
+    EXPECT_EQ(pDevice->NumBuffersCreated, 3u);
+    EXPECT_EQ(Pool.GetVertexBuffer(0)->GetDesc().uiSizeInBytes, 1024u * 12u);
+    EXPECT_EQ(Pool.GetVertexBuffer(1)->GetDesc().uiSizeInBytes, 1024u * 4u);
+    EXPECT_EQ(Pool.GetIndexBuffer()->GetDesc().uiSizeInBytes, 4096u * 4u);
+
+    // Allocations are placed one after another
+    auto Alloc0 = Pool.Allocate(100, 300);
+    auto Alloc1 = Pool.Allocate(200, 600);
+    auto Alloc2 = Pool.Allocate(50, 0);
+    ASSERT_TRUE(Alloc0.IsValid() && Alloc1.IsValid() && Alloc2.IsValid());
+    EXPECT_EQ(Alloc0.FirstVertex, 0u);
+    EXPECT_EQ(Alloc0.FirstIndex, 0u);
+    EXPECT_EQ(Alloc1.FirstVertex, 100u);
+    EXPECT_EQ(Alloc1.FirstIndex, 300u);
+    EXPECT_EQ(Alloc2.FirstVertex, 300u);
+    EXPECT_EQ(Alloc2.IndexCount, 0u);
+
+    Uint32 UsedVertices = 0, UsedIndices = 0;
+    Pool.GetUsage(UsedVertices, UsedIndices);
+    EXPECT_EQ(UsedVertices, 350u);
+    EXPECT_EQ(UsedIndices, 900u);
+
+    // The pool does not grow, so an allocation that does not fit fails
+    auto Alloc3 = Pool.Allocate(1000, 10);
+    EXPECT_FALSE(Alloc3.IsValid());
+    Pool.GetUsage(UsedVertices, UsedIndices);
+    EXPECT_EQ(UsedVertices, 350u);
+    EXPECT_EQ(UsedIndices, 900u);
+
+    // Released space is reused
+    Pool.Free(std::move(Alloc0));
+    EXPECT_FALSE(Alloc0.IsValid());
+    auto Alloc4 = Pool.Allocate(80, 250);
+    ASSERT_TRUE(Alloc4.IsValid());
+    EXPECT_EQ(Alloc4.FirstVertex, 0u);
+    EXPECT_EQ(Alloc4.FirstIndex, 0u);
+
+    Pool.Free(std::move(Alloc1));
+    Pool.Free(std::move(Alloc2));
+    Pool.Free(std::move(Alloc4));
+    Pool.GetUsage(UsedVertices, UsedIndices);
+    EXPECT_EQ(UsedVertices, 0u);
+    EXPECT_EQ(UsedIndices, 0u);
+}
+
+TEST(Tools_AssetLoader, GeometryPoolUpdate)
+{
+    RefCntAutoPtr<StubRenderDevice>  pDevice{MakeNewRCObj<StubRenderDevice>()()};
+    RefCntAutoPtr<StubDeviceContext> pContext{MakeNewRCObj<StubDeviceContext>()()};
+
+    GeometryPool Pool{pDevice, GetPoolCI(256, 256, false)};
+
+    auto Alloc0 = Pool.Allocate(16, 32);
+    auto Alloc1 = Pool.Allocate(8, 24);
+    ASSERT_TRUE(Alloc0.IsValid() && Alloc1.IsValid());
+
+    // Stream 0 stores three Uint32 values per vertex, stream 1 stores one
+    const auto Verts0 = MakeData(Alloc1.VertexCount * 3, 1000);
+    const auto Verts1 = MakeData(Alloc1.VertexCount, 2000);
+    const auto Inds   = MakeData(Alloc1.IndexCount, 3000);
+    Pool.UpdateVertices(pContext, Alloc1, 0, Verts0.data());
+    Pool.UpdateVertices(pContext, Alloc1, 1, Verts1.data());
+    Pool.UpdateIndices(pContext, Alloc1, Inds.data());
+
+    // The data is written at the allocation offsets
+    CheckBufferData(Pool.GetVertexBuffer(0), Alloc1.FirstVertex * 12, Verts0);
+    CheckBufferData(Pool.GetVertexBuffer(1), Alloc1.FirstVertex * 4, Verts1);
+    CheckBufferData(Pool.GetIndexBuffer(), Alloc1.FirstIndex * 4, Inds);
+
+    Pool.Free(std::move(Alloc0));
+    Pool.Free(std::move(Alloc1));
+}
+
+TEST(Tools_AssetLoader, GeometryPoolGrowth)
+{
+    RefCntAutoPtr<StubRenderDevice>  pDevice{MakeNewRCObj<StubRenderDevice>()()};
+    RefCntAutoPtr<StubDeviceContext> pContext{MakeNewRCObj<StubDeviceContext>()()};
+
+    GeometryPool Pool{pDevice, GetPoolCI(64, 128, true)};
+
+    auto Alloc0 = Pool.Allocate(48, 96);
+    ASSERT_TRUE(Alloc0.IsValid());
+    const auto Verts0 = MakeData(Alloc0.VertexCount, 100);
+    const auto Inds0  = MakeData(Alloc0.IndexCount, 200);
+    Pool.UpdateVertices(pContext, Alloc0, 1, Verts0.data());
+    Pool.UpdateIndices(pContext, Alloc0, Inds0.data());
+
+    RefCntAutoPtr<IBuffer> pOldVertexBuffer{Pool.GetVertexBuffer(1)};
+    const auto             NumBuffersCreated = pDevice->NumBuffersCreated;
+
+    // The allocation does not fit and the pool doubles its capacity
+    auto Alloc1 = Pool.Allocate(40, 100);
+    ASSERT_TRUE(Alloc1.IsValid());
+    EXPECT_EQ(Alloc1.FirstVertex, 48u);
+    EXPECT_EQ(Alloc1.FirstIndex, 96u);
+
+    Uint32 VertexCapacity = 0, IndexCapacity = 0;
+    Pool.GetCapacity(VertexCapacity, IndexCapacity);
+    EXPECT_EQ(VertexCapacity, 128u);
+    EXPECT_EQ(IndexCapacity, 256u);
+
+    // Buffers are only recreated when the data is written
+    EXPECT_EQ(pDevice->NumBuffersCreated, NumBuffersCreated);
+    EXPECT_EQ(Pool.GetVertexBuffer(1), pOldVertexBuffer);
+
+    const auto Verts1 = MakeData(Alloc1.VertexCount, 300);
+    const auto Inds1  = MakeData(Alloc1.IndexCount, 400);
+    Pool.UpdateVertices(pContext, Alloc1, 1, Verts1.data());
+    Pool.UpdateIndices(pContext, Alloc1, Inds1.data());
+    EXPECT_EQ(pDevice->NumBuffersCreated, NumBuffersCreated + 3);
+    EXPECT_NE(Pool.GetVertexBuffer(1), pOldVertexBuffer);
+    EXPECT_EQ(Pool.GetVertexBuffer(0)->GetDesc().uiSizeInBytes, 128u * 12u);
+    EXPECT_EQ(Pool.GetVertexBuffer(1)->GetDesc().uiSizeInBytes, 128u * 4u);
+    EXPECT_EQ(Pool.GetIndexBuffer()->GetDesc().uiSizeInBytes, 256u * 4u);
+
+    // The data written before the growth is preserved
+    CheckBufferData(Pool.GetVertexBuffer(1), Alloc0.FirstVertex * 4, Verts0);
+    CheckBufferData(Pool.GetIndexBuffer(), Alloc0.FirstIndex * 4, Inds0);
+    CheckBufferData(Pool.GetVertexBuffer(1), Alloc1.FirstVertex * 4, Verts1);
+    CheckBufferData(Pool.GetIndexBuffer(), Alloc1.FirstIndex * 4, Inds1);
+
+    // An allocation larger than the pool grows it by the allocation size
+    auto Alloc2 = Pool.Allocate(1000, 16);
+    ASSERT_TRUE(Alloc2.IsValid());
+    Pool.GetCapacity(VertexCapacity, IndexCapacity);
+    EXPECT_GE(VertexCapacity, 1088u);
+    EXPECT_EQ(IndexCapacity, 256u);
+
+    Pool.Free(std::move(Alloc0));
+    Pool.Free(std::move(Alloc1));
+    Pool.Free(std::move(Alloc2));
+
+    Uint32 UsedVertices = 0, UsedIndices = 0;
+    Pool.GetUsage(UsedVertices, UsedIndices);
+    EXPECT_EQ(UsedVertices, 0u);
+    EXPECT_EQ(UsedIndices, 0u);
+}
+
+} // namespace
@@ -0,0 +1,241 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+#include "ImageEncodeQueue.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "RefCntAutoPtr.hpp"
+#include "ThreadPool.hpp"
+
+#include "gtest/gtest.h"
+
+using namespace Diligent;
+
+namespace
+{
+
+// Creates RGBA8 pixels with a seed-dependent pattern and Padding bytes at the end of every row
+std::vector<Uint8> CreateTestPixels(Uint32 Width, Uint32 Height, Uint32 Padding, Uint8 Seed)
+{
+    const auto         Stride = Width * 4 + Padding;
+    std::vector<Uint8> Pixels(size_t{Stride} * Height);
+    for (Uint32 y = 0; y < Height; ++y)
+    {
+        for (Uint32 x = 0; x < Width * 4; ++x)
+            Pixels[y * Stride + x] = static_cast<Uint8>(x * 7 + y * 13 + Seed);
+    }
+    return Pixels;
+}
+
+// Blocks the callbacks until Release() is called
+class CallbackGate
+{
+public:
+    void Wait()
+    {
+        std::unique_lock<std::mutex> Lock{m_Mtx};
+        m_CondVar.wait(Lock, [&]() { return m_Released; });
+    }
+
+    void Release()
+    {
+        {
+            std::lock_guard<std::mutex> Lock{m_Mtx};
+            m_Released = true;
+        }
+        m_CondVar.notify_all();
+    }
+
+private:
+    std::mutex              m_Mtx;
+    std::condition_variable m_CondVar;
+    bool                    m_Released = false;
+};
+
+TEST(Tools_TextureLoader, ImageEncodeQueue)
+{
+    constexpr Uint32 Width   = 67;
+    constexpr Uint32 Height  = 45;
+    constexpr Uint32 Padding = 12;
+
+    struct TestImage
+    {
+        IMAGE_FILE_FORMAT FileFormat;
+        bool              KeepAlpha;
+    };
+    const TestImage TestImages[] = {
+        {IMAGE_FILE_FORMAT_PNG, false},
+        {IMAGE_FILE_FORMAT_PNG, true},
+        {IMAGE_FILE_FORMAT_JPEG, false},
+        {IMAGE_FILE_FORMAT_PNG, false},
+        {IMAGE_FILE_FORMAT_PNG, true},
+    };
+    constexpr size_t NumImages = _countof(TestImages);
+
+    ThreadPool Pool{3};
+
+    ImageEncodeQueue::CreateInfo CI;
+    CI.pThreadPool       = &Pool;
+    CI.MaxImagesInFlight = 2;
+    ImageEncodeQueue Queue{CI};
+    EXPECT_EQ(Queue.GetMaxImagesInFlight(), 2u);
+
+    std::vector<RefCntAutoPtr<IDataBlob>> Expected(NumImages);
+    std::vector<RefCntAutoPtr<IDataBlob>> Encoded(NumImages);
+    for (size_t i = 0; i < NumImages; ++i)
+    {
+        auto Pixels = CreateTestPixels(Width, Height, Padding, static_cast<Uint8>(i * 31));
+
+        Image::EncodeInfo Info;
+        Info.Width      = Width;
+        Info.Height     = Height;
+        Info.TexFormat  = TEX_FORMAT_RGBA8_UNORM;
+        Info.KeepAlpha  = TestImages[i].KeepAlpha;
+        Info.pData      = Pixels.data();
+        Info.Stride     = Width * 4 + Padding;
+        Info.FileFormat = TestImages[i].FileFormat;
+        Image::Encode(Info, &Expected[i]);
+
+        // Every callback writes its own element, so no synchronization is required
+        EXPECT_TRUE(Queue.Enqueue(Info, [&Encoded, i](IDataBlob* pEncodedData) { Encoded[i] = pEncodedData; }));
+
+        // The queue must have copied the pixels
+        std::fill(Pixels.begin(), Pixels.end(), Uint8{0});
+    }
+    Queue.WaitForIdle();
+
+    for (size_t i = 0; i < NumImages; ++i)
+    {
+        ASSERT_TRUE(Encoded[i]) << "Image " << i;
+        ASSERT_EQ(Encoded[i]->GetSize(), Expected[i]->GetSize()) << "Image " << i;
+        EXPECT_EQ(memcmp(Encoded[i]->GetDataPtr(), Expected[i]->GetDataPtr(), Expected[i]->GetSize()), 0) << "Image " << i;
+    }
+
+    const auto Stats = Queue.GetStatistics();
+    EXPECT_EQ(Stats.NumImagesInFlight, 0u);
+    EXPECT_EQ(Stats.NumImagesEncoded, NumImages);
+    EXPECT_EQ(Stats.NumFailures, 0u);
+}
+
+TEST(Tools_TextureLoader, ImageEncodeQueue_BackPressure)
+{
+    constexpr Uint32 Width  = 16;
+    constexpr Uint32 Height = 8;
+
+    ThreadPool Pool{1};
+
+    ImageEncodeQueue::CreateInfo CI;
+    CI.pThreadPool       = &Pool;
+    CI.MaxImagesInFlight = 2;
+    ImageEncodeQueue Queue{CI};
+
+    const auto Pixels = CreateTestPixels(Width, Height, 0, 0);
+
+    Image::EncodeInfo Info;
+    Info.Width      = Width;
+    Info.Height     = Height;
+    Info.TexFormat  = TEX_FORMAT_RGBA8_UNORM;
+    Info.pData      = Pixels.data();
+    Info.Stride     = Width * 4;
+    Info.FileFormat = IMAGE_FILE_FORMAT_PNG;
+
+    CallbackGate        Gate;
+    std::atomic<Uint32> NumCallbacks{0};
+
+    auto Callback = [&](IDataBlob* pEncodedData) {
+        EXPECT_NE(pEncodedData, nullptr);
+        Gate.Wait();
+        ++NumCallbacks;
+    };
+
+    EXPECT_TRUE(Queue.TryEnqueue(Info, Callback));
+    EXPECT_TRUE(Queue.TryEnqueue(Info, Callback));
+    // Both slots are taken until the gate is released
+    EXPECT_FALSE(Queue.TryEnqueue(Info, Callback));
+    EXPECT_EQ(Queue.GetStatistics().NumImagesInFlight, 2u);
+
+    std::atomic<bool> Enqueued{false};
+    std::thread       ProducerThread{
+        [&]() {
+            EXPECT_TRUE(Queue.Enqueue(Info, Callback));
+            Enqueued = true;
+        }};
+
+    std::this_thread::sleep_for(std::chrono::milliseconds{50});
+    EXPECT_FALSE(Enqueued);
+
+    Gate.Release();
+    ProducerThread.join();
+    EXPECT_TRUE(Enqueued);
+
+    Queue.WaitForIdle();
+    EXPECT_EQ(NumCallbacks, 3u);
+
+    const auto Stats = Queue.GetStatistics();
+    EXPECT_EQ(Stats.NumImagesInFlight, 0u);
+    EXPECT_EQ(Stats.NumImagesEncoded, 3u);
+    EXPECT_EQ(Stats.NumStalls, 1u);
+    EXPECT_GT(Stats.StallTime, 0.0);
+}
+
+TEST(Tools_TextureLoader, ImageEncodeQueue_InvalidImage)
+{
+    ThreadPool Pool{1};
+
+    ImageEncodeQueue::CreateInfo CI;
+    CI.pThreadPool = &Pool;
+    ImageEncodeQueue Queue{CI};
+    EXPECT_EQ(Queue.GetMaxImagesInFlight(), 2u);
+
+    const float Pixels[4] = {};
+
+    Image::EncodeInfo Info;
+    Info.Width      = 1;
+    Info.Height     = 1;
+    Info.TexFormat  = TEX_FORMAT_RGBA32_FLOAT;
+    Info.pData      = Pixels;
+    Info.Stride     = sizeof(Pixels);
+    Info.FileFormat = IMAGE_FILE_FORMAT_PNG;
+    EXPECT_FALSE(Queue.Enqueue(Info, nullptr));
+
+    Info.TexFormat = TEX_FORMAT_RGBA8_UNORM;
+    Info.Stride    = 2;
+    EXPECT_FALSE(Queue.Enqueue(Info, nullptr));
+
+    Info.Stride     = 4;
+    Info.FileFormat = IMAGE_FILE_FORMAT_DDS;
+    EXPECT_FALSE(Queue.Enqueue(Info, nullptr));
+
+    EXPECT_EQ(Queue.GetStatistics().NumImagesInFlight, 0u);
+}
+
+} // namespace
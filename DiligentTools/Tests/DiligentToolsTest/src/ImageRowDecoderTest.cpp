@@ -0,0 +1,320 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+#include "ImageRowDecoder.hpp"
+#include "../include/PNGCodec.h"
+#include "../include/TextureLoaderInternal.hpp"
+#include "png.h"
+#include "tiffio.h"
+
+#include <cstring>
+#include <vector>
+#include <random>
+
+#include "DataBlobImpl.hpp"
+#include "RefCntAutoPtr.hpp"
+#include "FileSystem.hpp"
+
+#include "gtest/gtest.h"
+
+using namespace Diligent;
+
+namespace
+{
+
+std::vector<Uint8> CreateRandomPixels(size_t Size, unsigned int Seed)
+{
+    std::mt19937                       Gen{Seed};
+    std::uniform_int_distribution<int> Dist{0, 255};
+
+    std::vector<Uint8> Pixels(Size);
+    for (auto& Byte : Pixels)
+        Byte = static_cast<Uint8>(Dist(Gen));
+    return Pixels;
+}
+
+// Test images only have 8- and 16-bit channels
+Uint32 GetChannelSize(VALUE_TYPE ComponentType)
+{
+    return ComponentType == VT_UINT16 ? 2 : 1;
+}
+
+void PngWriteCallback(png_structp png_ptr, png_bytep data, png_size_t length)
+{
+    auto* pEncodedData = reinterpret_cast<std::vector<Uint8>*>(png_get_io_ptr(png_ptr));
+    pEncodedData->insert(pEncodedData->end(), data, data + length);
+}
+
+// Encodes an 8-bit image with the given color type and interlacing
+RefCntAutoPtr<IDataBlob> EncodeTestPng(const Uint8* pPixels, Uint32 Width, Uint32 Height, Uint32 Stride, int ColorType, int Interlace)
+{
+    std::vector<Uint8> EncodedData;
+
+    auto* png  = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+    auto* info = png_create_info_struct(png);
+
+    png_set_IHDR(png, info, Width, Height, 8, ColorType, Interlace, PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+
+    std::vector<png_bytep> RowPtrs(Height);
+    for (Uint32 y = 0; y < Height; ++y)
+        RowPtrs[y] = const_cast<Uint8*>(pPixels) + size_t{y} * Stride;
+    png_set_rows(png, info, RowPtrs.data());
+
+    png_set_write_fn(png, &EncodedData, PngWriteCallback, nullptr);
+    png_write_png(png, info, PNG_TRANSFORM_IDENTITY, nullptr);
+    png_destroy_write_struct(&png, &info);
+
+    RefCntAutoPtr<IDataBlob> pData{MakeNewRCObj<DataBlobImpl>()(EncodedData.size())};
+    memcpy(pData->GetDataPtr(), EncodedData.data(), EncodedData.size());
+    return pData;
+}
+
+// Decodes the image in bands and checks that the rows match the reference pixels
+void CheckDecodedRows(ImageRowDecoder& Decoder, const Uint8* pRefPixels, Uint32 RefStride, Uint32 RowsPerBand)
+{
+    const auto& Desc    = Decoder.GetDesc();
+    const auto  RowSize = Desc.Width * Desc.NumComponents * GetChannelSize(Desc.ComponentType);
+    ASSERT_GE(Desc.RowStride, RowSize);
+
+    std::vector<Uint8> Band(size_t{RowsPerBand} * Desc.RowStride);
+    while (Decoder.GetNextRow() < Desc.Height)
+    {
+        const auto FirstRow = Decoder.GetNextRow();
+        const auto NumRows  = Decoder.DecodeRows(Band.data(), Desc.RowStride, RowsPerBand);
+        ASSERT_EQ(NumRows, std::min(RowsPerBand, Desc.Height - FirstRow));
+        for (Uint32 row = 0; row < NumRows; ++row)
+        {
+            ASSERT_EQ(memcmp(&Band[size_t{row} * Desc.RowStride], pRefPixels + size_t{FirstRow + row} * RefStride, RowSize), 0)
+                << "row " << FirstRow + row << ", " << RowsPerBand << " rows per band";
+        }
+    }
+    EXPECT_EQ(Decoder.DecodeRows(Band.data(), Desc.RowStride, RowsPerBand), 0u);
+    EXPECT_FALSE(Decoder.HasFailed());
+}
+
+TEST(Tools_TextureLoader, ImageRowDecoder_PNG)
+{
+    constexpr Uint32 Width  = 75;
+    constexpr Uint32 Height = 41;
+
+    for (int ColorType : {PNG_COLOR_TYPE_GRAY, PNG_COLOR_TYPE_RGB, PNG_COLOR_TYPE_RGBA})
+    {
+        const Uint32 NumComponents = ColorType == PNG_COLOR_TYPE_GRAY ? 1 : (ColorType == PNG_COLOR_TYPE_RGB ? 3 : 4);
+        const auto   RefPixels     = CreateRandomPixels(size_t{Width} * NumComponents * Height, ColorType);
+        for (int Interlace : {PNG_INTERLACE_NONE, PNG_INTERLACE_ADAM7})
+        {
+            auto pPngData = EncodeTestPng(RefPixels.data(), Width, Height, Width * NumComponents, ColorType, Interlace);
+            for (Uint32 RowsPerBand : {1u, 7u, 64u})
+            {
+                auto pDecoder = ImageRowDecoder::Create(pPngData);
+                ASSERT_TRUE(pDecoder);
+
+                const auto& Desc = pDecoder->GetDesc();
+                EXPECT_EQ(Desc.Width, Width);
+                EXPECT_EQ(Desc.Height, Height);
+                EXPECT_EQ(Desc.NumComponents, NumComponents);
+                EXPECT_EQ(Desc.ComponentType, VT_UINT8);
+                CheckDecodedRows(*pDecoder, RefPixels.data(), Width * NumComponents, RowsPerBand);
+            }
+        }
+    }
+}
+
+TEST(Tools_TextureLoader, ImageRowDecoder_TruncatedPNG)
+{
+    constexpr Uint32 Width  = 64;
+    constexpr Uint32 Height = 64;
+
+    const auto RefPixels = CreateRandomPixels(size_t{Width} * 4 * Height, 0);
+    auto       pPngData  = EncodeTestPng(RefPixels.data(), Width, Height, Width * 4, PNG_COLOR_TYPE_RGBA, PNG_INTERLACE_NONE);
+    pPngData->Resize(pPngData->GetSize() / 2);
+
+    auto pDecoder = ImageRowDecoder::Create(pPngData);
+    ASSERT_TRUE(pDecoder);
+
+    std::vector<Uint8> Pixels(size_t{Width} * 4 * Height);
+    EXPECT_LT(pDecoder->DecodeRows(Pixels.data(), Width * 4, Height), Height);
+    EXPECT_TRUE(pDecoder->HasFailed());
+    EXPECT_EQ(pDecoder->DecodeRows(Pixels.data(), Width * 4, Height), 0u);
+}
+
+TEST(Tools_TextureLoader, ImageRowDecoder_TIFF)
+{
+    constexpr char   FileName[]   = "ImageRowDecoderTest.tif";
+    constexpr Uint32 Width        = 53;
+    constexpr Uint32 Height       = 37;
+    constexpr Uint32 RowsPerStrip = 8;
+
+    for (Uint16 BitsPerSample : {8, 16})
+    {
+        for (Uint16 NumComponents : {1, 3})
+        {
+            for (Uint16 Compression : {COMPRESSION_NONE, COMPRESSION_LZW})
+            {
+                const auto RefStride = Width * NumComponents * BitsPerSample / 8;
+                const auto RefPixels = CreateRandomPixels(size_t{RefStride} * Height, BitsPerSample + NumComponents);
+                {
+                    auto* pTiff = TIFFOpen(FileName, "w");
+                    ASSERT_NE(pTiff, nullptr);
+                    TIFFSetField(pTiff, TIFFTAG_IMAGEWIDTH, Width);
+                    TIFFSetField(pTiff, TIFFTAG_IMAGELENGTH, Height);
+                    TIFFSetField(pTiff, TIFFTAG_SAMPLESPERPIXEL, NumComponents);
+                    TIFFSetField(pTiff, TIFFTAG_BITSPERSAMPLE, BitsPerSample);
+                    TIFFSetField(pTiff, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG);
+                    TIFFSetField(pTiff, TIFFTAG_PHOTOMETRIC, NumComponents == 3 ? PHOTOMETRIC_RGB : PHOTOMETRIC_MINISBLACK);
+                    TIFFSetField(pTiff, TIFFTAG_COMPRESSION, Compression);
+                    TIFFSetField(pTiff, TIFFTAG_ROWSPERSTRIP, RowsPerStrip);
+                    for (Uint32 row = 0; row < Height; ++row)
+                        TIFFWriteScanline(pTiff, const_cast<Uint8*>(&RefPixels[size_t{row} * RefStride]), row);
+                    TIFFClose(pTiff);
+                }
+
+                auto pDecoder = ImageRowDecoder::CreateFromFile(FileName);
+                ASSERT_TRUE(pDecoder);
+
+                const auto& Desc = pDecoder->GetDesc();
+                EXPECT_EQ(Desc.Width, Width);
+                EXPECT_EQ(Desc.Height, Height);
+                EXPECT_EQ(Desc.NumComponents, NumComponents);
+                EXPECT_EQ(Desc.ComponentType, BitsPerSample == 8 ? VT_UINT8 : VT_UINT16);
+                CheckDecodedRows(*pDecoder, RefPixels.data(), RefStride, 5);
+
+                // The image must be the same when it is loaded as a whole
+                RefCntAutoPtr<Image> pImage;
+                CreateImageFromFile(FileName, &pImage);
+                ASSERT_TRUE(pImage);
+                const auto& ImgDesc = pImage->GetDesc();
+                ASSERT_EQ(ImgDesc.Height, Height);
+                const auto* pImgData = reinterpret_cast<const Uint8*>(pImage->GetData()->GetDataPtr());
+                for (Uint32 row = 0; row < Height; ++row)
+                    ASSERT_EQ(memcmp(pImgData + size_t{row} * ImgDesc.RowStride, &RefPixels[size_t{row} * RefStride], RefStride), 0) << row;
+            }
+        }
+    }
+
+    FileSystem::DeleteFile(FileName);
+}
+
+void CheckMipChain(IDataBlob* pFileData, const TextureLoadInfo& TexLoadInfo, Uint32 RowsPerBand)
+{
+    // Reference levels are computed from the complete image
+    ImageLoadInfo ImgLoadInfo;
+    ImgLoadInfo.Format = Image::GetFileFormat(reinterpret_cast<const Uint8*>(pFileData->GetDataPtr()), pFileData->GetSize());
+    RefCntAutoPtr<Image> pImage;
+    Image::CreateFromDataBlob(pFileData, ImgLoadInfo, &pImage);
+    ASSERT_TRUE(pImage);
+
+    PreparedTextureData RefData;
+    PrepareTextureFromImage(pImage, TexLoadInfo, nullptr, RefData);
+    const auto& TexDesc   = RefData.Desc;
+    const auto& ImgDesc   = pImage->GetDesc();
+    const auto  PixelSize = (ImgDesc.NumComponents == 3 ? 4 : ImgDesc.NumComponents) * GetChannelSize(ImgDesc.ComponentType);
+
+    std::vector<std::vector<Uint8>>       Mips(TexDesc.MipLevels);
+    std::vector<MappedTextureSubresource> DstMips(TexDesc.MipLevels);
+    for (Uint32 mip = 0; mip < TexDesc.MipLevels; ++mip)
+    {
+        DstMips[mip].Stride = std::max(TexDesc.Width >> mip, 1u) * PixelSize + 4;
+        Mips[mip].assign(size_t{DstMips[mip].Stride} * std::max(TexDesc.Height >> mip, 1u), 0xCD);
+        DstMips[mip].pData = Mips[mip].data();
+    }
+
+    auto pDecoder = ImageRowDecoder::Create(pFileData);
+    ASSERT_TRUE(pDecoder);
+
+    DecodeImageMipChainAttribs Attribs;
+    Attribs.pDstMips     = DstMips.data();
+    Attribs.MipLevels    = TexDesc.MipLevels;
+    Attribs.GenerateMips = TexLoadInfo.GenerateMips;
+    Attribs.IsSRGB       = TexLoadInfo.IsSRGB;
+    Attribs.MipFilter    = TexLoadInfo.MipFilter;
+    Attribs.AlphaCutoff  = TexLoadInfo.AlphaCutoff;
+    Attribs.RowsPerBand  = RowsPerBand;
+    ASSERT_TRUE(DecodeImageMipChain(*pDecoder, Attribs));
+
+    for (Uint32 mip = 0; mip < TexDesc.MipLevels; ++mip)
+    {
+        const auto& RefSubres = RefData.SubResources[mip];
+        const auto  RowSize   = std::max(TexDesc.Width >> mip, 1u) * PixelSize;
+        for (Uint32 row = 0; row < std::max(TexDesc.Height >> mip, 1u); ++row)
+        {
+            ASSERT_EQ(memcmp(&Mips[mip][size_t{row} * DstMips[mip].Stride],
+                             reinterpret_cast<const Uint8*>(RefSubres.pData) + size_t{row} * RefSubres.Stride,
+                             RowSize),
+                      0)
+                << "mip " << mip << ", row " << row << ", " << RowsPerBand << " rows per band";
+        }
+    }
+}
+
+TEST(Tools_TextureLoader, DecodeImageMipChain)
+{
+    constexpr Uint32 Width  = 97;
+    constexpr Uint32 Height = 70;
+
+    for (int ColorType : {PNG_COLOR_TYPE_GRAY_ALPHA, PNG_COLOR_TYPE_RGB, PNG_COLOR_TYPE_RGBA})
+    {
+        const Uint32 NumComponents = ColorType == PNG_COLOR_TYPE_GRAY_ALPHA ? 2 : (ColorType == PNG_COLOR_TYPE_RGB ? 3 : 4);
+        const auto   RefPixels     = CreateRandomPixels(size_t{Width} * NumComponents * Height, ColorType);
+        auto         pPngData      = EncodeTestPng(RefPixels.data(), Width, Height, Width * NumComponents, ColorType, PNG_INTERLACE_NONE);
+
+        for (int IsSRGB = 0; IsSRGB <= 1; ++IsSRGB)
+        {
+            for (int GenerateMips = 0; GenerateMips <= 1; ++GenerateMips)
+            {
+                TextureLoadInfo TexLoadInfo;
+                TexLoadInfo.IsSRGB       = IsSRGB != 0;
+                TexLoadInfo.GenerateMips = GenerateMips != 0;
+                for (Uint32 RowsPerBand : {1u, 6u, 128u})
+                    CheckMipChain(pPngData, TexLoadInfo, RowsPerBand);
+            }
+        }
+    }
+}
+
+TEST(Tools_TextureLoader, DecodeImageMipChain_Filters)
+{
+    constexpr Uint32 Width  = 61;
+    constexpr Uint32 Height = 90;
+
+    const auto RefPixels = CreateRandomPixels(size_t{Width} * 4 * Height, PNG_COLOR_TYPE_RGBA);
+    auto       pPngData  = EncodeTestPng(RefPixels.data(), Width, Height, Width * 4, PNG_COLOR_TYPE_RGBA, PNG_INTERLACE_NONE);
+
+    for (auto Filter : {MIP_FILTER_BOX, MIP_FILTER_KAISER, MIP_FILTER_LANCZOS})
+    {
+        for (float AlphaCutoff : {0.f, 0.5f})
+        {
+            TextureLoadInfo TexLoadInfo;
+            TexLoadInfo.IsSRGB      = true;
+            TexLoadInfo.MipFilter   = Filter;
+            TexLoadInfo.AlphaCutoff = AlphaCutoff;
+            for (Uint32 RowsPerBand : {1u, 16u})
+                CheckMipChain(pPngData, TexLoadInfo, RowsPerBand);
+        }
+    }
+}
+
+} // namespace
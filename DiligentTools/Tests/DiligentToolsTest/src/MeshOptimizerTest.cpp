@@ -0,0 +1,300 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+#include "MeshOptimizer.hpp"
+#include "PlatformDefinitions.h"
+
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <random>
+#include <cmath>
+
+#include "gtest/gtest.h"
+
+using namespace Diligent;
+
+namespace
+{
+
+// Creates a regular grid of GridSize x GridSize quads with triangles in random order
+void CreateShuffledGrid(Uint32 GridSize, std::vector<float3>& Positions, std::vector<Uint32>& Indices)
+{
+    const auto VertsPerRow = GridSize + 1;
+
+    Positions.clear();
+    for (Uint32 y = 0; y < VertsPerRow; ++y)
+    {
+        for (Uint32 x = 0; x < VertsPerRow; ++x)
+            Positions.emplace_back(static_cast<float>(x), static_cast<float>(y), 0.f);
+    }
+
+    std::vector<std::array<Uint32, 3>> Triangles;
+    for (Uint32 y = 0; y < GridSize; ++y)
+    {
+        for (Uint32 x = 0; x < GridSize; ++x)
+        {
+            const auto v0 = x + y * VertsPerRow;
+            const auto v1 = v0 + 1;
+            const auto v2 = v0 + VertsPerRow;
+            const auto v3 = v2 + 1;
+            Triangles.push_back({v0, v1, v2});
+            Triangles.push_back({v2, v1, v3});
+        }
+    }
+
+    std::mt19937 Gen{0};
+    std::shuffle(Triangles.begin(), Triangles.end(), Gen);
+
+    Indices.clear();
+    for (const auto& Tri : Triangles)
+        Indices.insert(Indices.end(), Tri.begin(), Tri.end());
+}
+
+// Returns the sorted list of triangles, each rotated so that its smallest index goes first
+std::vector<std::array<Uint32, 3>> GetCanonicalTriangles(const std::vector<Uint32>& Indices)
+{
+    std::vector<std::array<Uint32, 3>> Triangles;
+    for (size_t t = 0; t < Indices.size() / 3; ++t)
+    {
+        std::array<Uint32, 3> Tri{Indices[t * 3 + 0], Indices[t * 3 + 1], Indices[t * 3 + 2]};
+        std::rotate(Tri.begin(), std::min_element(Tri.begin(), Tri.end()), Tri.end());
+        Triangles.push_back(Tri);
+    }
+    std::sort(Triangles.begin(), Triangles.end());
+    return Triangles;
+}
+
+TEST(Tools_AssetLoader, AnalyzeVertexCache)
+{
+    {
+        const Uint32 Indices[] = {0, 1, 2};
+
+        const auto Stats = AnalyzeVertexCache(Indices, _countof(Indices), 3);
+        EXPECT_EQ(Stats.TriangleCount, 1u);
+        EXPECT_EQ(Stats.VertexCount, 3u);
+        EXPECT_EQ(Stats.CacheMissCount, 3u);
+        EXPECT_FLOAT_EQ(Stats.ACMR, 3.f);
+        EXPECT_FLOAT_EQ(Stats.ATVR, 1.f);
+    }
+
+    {
+        // Quad: the second triangle reuses two cached vertices
+        const Uint32 Indices[] = {0, 1, 2, 2, 1, 3};
+
+        const auto Stats = AnalyzeVertexCache(Indices, _countof(Indices), 4);
+        EXPECT_EQ(Stats.CacheMissCount, 4u);
+        EXPECT_FLOAT_EQ(Stats.ACMR, 2.f);
+        EXPECT_FLOAT_EQ(Stats.ATVR, 1.f);
+    }
+
+    {
+        // With a 3-entry FIFO cache, vertex 0 is evicted by vertex 3,
+        // and vertex 1 is then evicted by vertex 0.
+        const Uint32 Indices[] = {0, 1, 2, 1, 2, 3, 3, 0, 1};
+
+        const auto Stats = AnalyzeVertexCache(Indices, _countof(Indices), 4, 3);
+        EXPECT_EQ(Stats.CacheMissCount, 6u);
+        EXPECT_EQ(Stats.VertexCount, 4u);
+        EXPECT_FLOAT_EQ(Stats.ATVR, 6.f / 4.f);
+    }
+}
+
+TEST(Tools_AssetLoader, OptimizeVertexCache)
+{
+    std::vector<float3> Positions;
+    std::vector<Uint32> Indices;
+    CreateShuffledGrid(64, Positions, Indices);
+    const auto NumVertices = static_cast<Uint32>(Positions.size());
+
+    std::vector<Uint32> OptimizedIndices(Indices.size());
+    OptimizeVertexCache(OptimizedIndices.data(), Indices.data(), Indices.size(), NumVertices);
+
+    EXPECT_EQ(GetCanonicalTriangles(Indices), GetCanonicalTriangles(OptimizedIndices));
+
+    const auto StatsBefore = AnalyzeVertexCache(Indices.data(), Indices.size(), NumVertices);
+    const auto StatsAfter  = AnalyzeVertexCache(OptimizedIndices.data(), OptimizedIndices.size(), NumVertices);
+    EXPECT_GT(StatsBefore.ACMR, 2.f);
+    // The ideal ACMR for a regular grid is 0.5; Tipsify typically achieves 0.6-0.8
+    EXPECT_LT(StatsAfter.ACMR, 0.9f);
+    EXPECT_LT(StatsAfter.ATVR, 1.8f);
+}
+
+TEST(Tools_AssetLoader, OptimizeOverdraw)
+{
+    std::vector<float3> Positions;
+    std::vector<Uint32> Indices;
+    CreateShuffledGrid(64, Positions, Indices);
+    const auto NumVertices = static_cast<Uint32>(Positions.size());
+
+    std::vector<Uint32> CacheOptimizedIndices(Indices.size());
+    OptimizeVertexCache(CacheOptimizedIndices.data(), Indices.data(), Indices.size(), NumVertices);
+
+    constexpr float Threshold = 1.05f;
+
+    std::vector<Uint32> OptimizedIndices(Indices.size());
+    OptimizeOverdraw(OptimizedIndices.data(), CacheOptimizedIndices.data(), CacheOptimizedIndices.size(),
+                     Positions.data(), sizeof(float3), NumVertices, Threshold);
+
+    EXPECT_EQ(GetCanonicalTriangles(Indices), GetCanonicalTriangles(OptimizedIndices));
+
+    const auto CacheOptStats = AnalyzeVertexCache(CacheOptimizedIndices.data(), CacheOptimizedIndices.size(), NumVertices);
+    const auto OverdrawStats = AnalyzeVertexCache(OptimizedIndices.data(), OptimizedIndices.size(), NumVertices);
+    EXPECT_LT(OverdrawStats.ACMR, CacheOptStats.ACMR * Threshold * 1.1f);
+}
+
+TEST(Tools_AssetLoader, OptimizeVertexFetch)
+{
+    std::vector<float3> Positions;
+    std::vector<Uint32> Indices;
+    CreateShuffledGrid(64, Positions, Indices);
+    const auto NumVertices = static_cast<Uint32>(Positions.size());
+
+    // Shuffle vertices to make the fetch order random
+    {
+        std::vector<Uint32> Shuffle(NumVertices);
+        for (Uint32 v = 0; v < NumVertices; ++v)
+            Shuffle[v] = v;
+        std::mt19937 Gen{1};
+        std::shuffle(Shuffle.begin(), Shuffle.end(), Gen);
+        RemapIndices(Indices.data(), Indices.size(), Shuffle.data());
+        RemapVertices(Positions.data(), NumVertices, Shuffle.data());
+    }
+
+    std::vector<Uint32> OptimizedIndices(Indices.size());
+    OptimizeVertexCache(OptimizedIndices.data(), Indices.data(), Indices.size(), NumVertices);
+
+    // Add an unreferenced vertex that must be moved to the end
+    Positions.emplace_back(-1.f, -1.f, -1.f);
+    const auto NumVerticesWithUnused = NumVertices + 1;
+
+    const auto FetchBefore = AnalyzeVertexFetch(OptimizedIndices.data(), OptimizedIndices.size(), NumVerticesWithUnused, sizeof(float3));
+
+    std::vector<float3> OptimizedPositions = Positions;
+    std::vector<Uint32> Remap(NumVerticesWithUnused);
+
+    const auto NumReferenced = ComputeVertexFetchRemap(Remap.data(), OptimizedIndices.data(), OptimizedIndices.size(), NumVerticesWithUnused);
+    EXPECT_EQ(NumReferenced, NumVertices);
+    EXPECT_EQ(Remap[NumVertices], NumVertices);
+
+    // Remap must be a permutation
+    {
+        auto SortedRemap = Remap;
+        std::sort(SortedRemap.begin(), SortedRemap.end());
+        for (Uint32 v = 0; v < NumVerticesWithUnused; ++v)
+            EXPECT_EQ(SortedRemap[v], v);
+    }
+
+    auto RemappedIndices = OptimizedIndices;
+    RemapIndices(RemappedIndices.data(), RemappedIndices.size(), Remap.data());
+    RemapVertices(OptimizedPositions.data(), NumVerticesWithUnused, Remap.data());
+
+    // Vertices must appear in the order of first use
+    {
+        Uint32 MaxIndex = 0;
+        for (auto Idx : RemappedIndices)
+        {
+            EXPECT_LE(Idx, MaxIndex + 1);
+            MaxIndex = std::max(MaxIndex, Idx);
+        }
+    }
+
+    // Remapped triangles must reference the same positions
+    for (size_t i = 0; i < OptimizedIndices.size(); ++i)
+        EXPECT_EQ(Positions[OptimizedIndices[i]], OptimizedPositions[RemappedIndices[i]]);
+
+    const auto FetchAfter = AnalyzeVertexFetch(RemappedIndices.data(), RemappedIndices.size(), NumVerticesWithUnused, sizeof(float3));
+    EXPECT_LT(FetchAfter.Overfetch, FetchBefore.Overfetch);
+    EXPECT_LT(FetchAfter.Overfetch, 2.f);
+
+    // Post-transform cache efficiency must not change
+    const auto CacheBefore = AnalyzeVertexCache(OptimizedIndices.data(), OptimizedIndices.size(), NumVerticesWithUnused);
+    const auto CacheAfter  = AnalyzeVertexCache(RemappedIndices.data(), RemappedIndices.size(), NumVerticesWithUnused);
+    EXPECT_EQ(CacheBefore.CacheMissCount, CacheAfter.CacheMissCount);
+}
+
+TEST(Tools_AssetLoader, SimplifyMesh)
+{
+    std::vector<float3> Positions;
+    std::vector<Uint32> Indices;
+    CreateShuffledGrid(32, Positions, Indices);
+    const auto NumVertices = static_cast<Uint32>(Positions.size());
+
+    auto GetTotalArea = [&](const Uint32* pIndices, size_t NumIndices) {
+        float Area = 0;
+        for (size_t i = 0; i < NumIndices; i += 3)
+        {
+            const auto& P0 = Positions[pIndices[i + 0]];
+            const auto& P1 = Positions[pIndices[i + 1]];
+            const auto& P2 = Positions[pIndices[i + 2]];
+            // All triangles of the planar grid must keep facing +Z
+            const auto N = cross(P1 - P0, P2 - P0);
+            EXPECT_GT(N.z, 0.f);
+            Area += N.z * 0.5f;
+        }
+        return Area;
+    };
+
+    // Planar grid: interior vertices can be removed without any error
+    {
+        std::vector<Uint32> SimplifiedIndices(Indices.size());
+
+        float      Error      = -1;
+        const auto NumIndices = SimplifyMesh(SimplifiedIndices.data(), Indices.data(), Indices.size(),
+                                             Positions.data(), sizeof(float3), NumVertices,
+                                             Indices.size() / 10, 1e-3f, &Error);
+        EXPECT_EQ(NumIndices % 3, size_t{0});
+        EXPECT_LT(NumIndices, Indices.size() / 4);
+        EXPECT_LE(Error, 1e-3f);
+        for (size_t i = 0; i < NumIndices; ++i)
+            EXPECT_LT(SimplifiedIndices[i], NumVertices);
+
+        // Open edges are preserved, so the area of the grid must not change
+        EXPECT_NEAR(GetTotalArea(SimplifiedIndices.data(), NumIndices), 32.f * 32.f, 1e-2f);
+    }
+
+    // Curved surface: the error must not exceed the target
+    {
+        for (auto& Pos : Positions)
+            Pos.z = std::sin(Pos.x * 0.2f) * std::cos(Pos.y * 0.2f) * 2.f;
+
+        for (float TargetError : {0.01f, 0.1f})
+        {
+            std::vector<Uint32> SimplifiedIndices(Indices.size());
+
+            float      Error      = -1;
+            const auto NumIndices = SimplifyMesh(SimplifiedIndices.data(), Indices.data(), Indices.size(),
+                                                 Positions.data(), sizeof(float3), NumVertices,
+                                                 0, TargetError, &Error);
+            EXPECT_LT(NumIndices, Indices.size());
+            EXPECT_GT(NumIndices, size_t{0});
+            EXPECT_LE(Error, TargetError);
+        }
+    }
+}
+
+} // namespace
@@ -0,0 +1,532 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+#include "MipGenerator.hpp"
+#include "ThreadPool.hpp"
+#include "DebugUtilities.hpp"
+
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+
+#include "gtest/gtest.h"
+
+using namespace Diligent;
+
+namespace
+{
+
+struct TestMip
+{
+    std::vector<Uint8> Data;
+    Uint32             Width  = 0;
+    Uint32             Height = 0;
+    Uint32             Stride = 0;
+};
+
+TestMip CreateRandomMip(Uint32 Width, Uint32 Height, Uint32 PixelSize, std::mt19937& Gen)
+{
+    TestMip Mip;
+    Mip.Width  = Width;
+    Mip.Height = Height;
+    // Add padding to test the stride
+    Mip.Stride = (Width * PixelSize + 7) & ~3u;
+    Mip.Data.resize(size_t{Mip.Stride} * Height);
+    std::uniform_int_distribution<int> Dist{0, 255};
+    for (auto& Byte : Mip.Data)
+        Byte = static_cast<Uint8>(Dist(Gen));
+    return Mip;
+}
+
+ComputeCoarseMipAttribs GetAttribs(VALUE_TYPE ComponentType, Uint32 NumChannels, bool IsSRGB, const TestMip& FineMip, TestMip& CoarseMip, Uint32 PixelSize, MIP_FILTER Filter = MIP_FILTER_BOX)
+{
+    CoarseMip.Width  = std::max(FineMip.Width / 2u, 1u);
+    CoarseMip.Height = std::max(FineMip.Height / 2u, 1u);
+    CoarseMip.Stride = CoarseMip.Width * PixelSize;
+    CoarseMip.Data.assign(size_t{CoarseMip.Stride} * CoarseMip.Height, 0xCD);
+
+    ComputeCoarseMipAttribs Attribs;
+    Attribs.ComponentType   = ComponentType;
+    Attribs.NumChannels     = NumChannels;
+    Attribs.IsSRGB          = IsSRGB;
+    Attribs.pFineMipData    = FineMip.Data.data();
+    Attribs.FineMipStride   = FineMip.Stride;
+    Attribs.FineMipWidth    = FineMip.Width;
+    Attribs.FineMipHeight   = FineMip.Height;
+    Attribs.pCoarseMipData  = CoarseMip.Data.data();
+    Attribs.CoarseMipStride = CoarseMip.Stride;
+    Attribs.CoarseMipWidth  = CoarseMip.Width;
+    Attribs.CoarseMipHeight = CoarseMip.Height;
+    Attribs.Filter          = Filter;
+    return Attribs;
+}
+
+void TestComputeCoarseMip(VALUE_TYPE ComponentType, bool IsSRGB)
+{
+    std::mt19937 Gen{static_cast<unsigned int>(ComponentType)};
+
+    const Uint32 Sizes[][2] = {{1, 1}, {1, 8}, {7, 1}, {2, 2}, {33, 17}, {64, 64}, {129, 67}};
+    for (Uint32 NumChannels = 1; NumChannels <= 4; ++NumChannels)
+    {
+        const auto PixelSize = NumChannels * (ComponentType == VT_UINT8 ? 1 : 2);
+        for (const auto& Size : Sizes)
+        {
+            const auto FineMip = CreateRandomMip(Size[0], Size[1], PixelSize, Gen);
+
+            TestMip RefMip, Mip;
+            ComputeCoarseMipRef(GetAttribs(ComponentType, NumChannels, IsSRGB, FineMip, RefMip, PixelSize));
+            ComputeCoarseMip(GetAttribs(ComponentType, NumChannels, IsSRGB, FineMip, Mip, PixelSize));
+
+            if (!IsSRGB)
+            {
+                EXPECT_EQ(Mip.Data, RefMip.Data) << NumChannels << " channels, " << Size[0] << "x" << Size[1];
+                continue;
+            }
+
+            // Look-up tables use fixed-point math and may differ from the reference by one
+            size_t NumMismatches = 0;
+            for (size_t i = 0; i < Mip.Data.size(); ++i)
+            {
+                const auto Diff = std::abs(static_cast<int>(Mip.Data[i]) - static_cast<int>(RefMip.Data[i]));
+                EXPECT_LE(Diff, 1) << NumChannels << " channels, " << Size[0] << "x" << Size[1] << ", byte " << i;
+                if (Diff != 0)
+                    ++NumMismatches;
+            }
+            EXPECT_LE(NumMismatches, Mip.Data.size() / 100 + 1) << NumChannels << " channels, " << Size[0] << "x" << Size[1];
+        }
+    }
+}
+
+TEST(Tools_TextureLoader, ComputeCoarseMip_Linear8)
+{
+    TestComputeCoarseMip(VT_UINT8, false);
+}
+
+TEST(Tools_TextureLoader, ComputeCoarseMip_Linear16)
+{
+    TestComputeCoarseMip(VT_UINT16, false);
+}
+
+TEST(Tools_TextureLoader, ComputeCoarseMip_SRGB8)
+{
+    TestComputeCoarseMip(VT_UINT8, true);
+}
+
+TEST(Tools_TextureLoader, ComputeCoarseMip_UniformSRGB)
+{
+    // Averaging identical values must not change them
+    TestMip FineMip;
+    FineMip.Width  = 32;
+    FineMip.Height = 8;
+    FineMip.Stride = FineMip.Width * 4;
+    FineMip.Data.resize(size_t{FineMip.Stride} * FineMip.Height);
+    for (Uint32 v = 0; v < 256; ++v)
+    {
+        std::fill(FineMip.Data.begin(), FineMip.Data.end(), static_cast<Uint8>(v));
+        TestMip Mip;
+        ComputeCoarseMip(GetAttribs(VT_UINT8, 4, true, FineMip, Mip, 4));
+        for (auto Byte : Mip.Data)
+            ASSERT_EQ(Byte, v);
+    }
+}
+
+TEST(Tools_TextureLoader, ComputeCoarseMipParallel)
+{
+    std::mt19937 Gen{1};
+    ThreadPool   Pool{3};
+
+    for (int IsSRGB = 0; IsSRGB <= 1; ++IsSRGB)
+    {
+        // Levels must be large enough to be split into several bands
+        const auto FineMip = CreateRandomMip(1029, 1031, 4, Gen);
+        ASSERT_GT(FineMip.Height / 2, GetParallelMipRowsPerBand(FineMip.Width / 2 * 4));
+
+        TestMip RefMip, Mip;
+        ComputeCoarseMip(GetAttribs(VT_UINT8, 4, IsSRGB != 0, FineMip, RefMip, 4));
+        ComputeCoarseMipParallel(GetAttribs(VT_UINT8, 4, IsSRGB != 0, FineMip, Mip, 4), Pool);
+        EXPECT_EQ(Mip.Data, RefMip.Data);
+    }
+}
+
+void TestComputeCoarseMipFiltered(VALUE_TYPE ComponentType, MIP_FILTER Filter)
+{
+    std::mt19937 Gen{static_cast<unsigned int>(ComponentType) * 16 + Filter};
+
+    const Uint32 Sizes[][2] = {{1, 1}, {1, 8}, {7, 1}, {2, 2}, {33, 17}, {64, 64}, {129, 67}};
+    for (int IsSRGB = 0; IsSRGB <= 1; ++IsSRGB)
+    {
+        for (Uint32 NumChannels = 1; NumChannels <= 4; ++NumChannels)
+        {
+            const auto PixelSize = NumChannels * (ComponentType == VT_UINT8 ? 1 : 2);
+            for (const auto& Size : Sizes)
+            {
+                const auto FineMip = CreateRandomMip(Size[0], Size[1], PixelSize, Gen);
+
+                TestMip RefMip, Mip;
+                ComputeCoarseMipRef(GetAttribs(ComponentType, NumChannels, IsSRGB != 0, FineMip, RefMip, PixelSize, Filter));
+                ComputeCoarseMip(GetAttribs(ComponentType, NumChannels, IsSRGB != 0, FineMip, Mip, PixelSize, Filter));
+
+                // The separable filter accumulates in a different order and uses look-up tables
+                for (size_t i = 0; i < Mip.Data.size(); i += PixelSize / NumChannels)
+                {
+                    int Val    = Mip.Data[i];
+                    int RefVal = RefMip.Data[i];
+                    if (ComponentType == VT_UINT16)
+                    {
+                        Val    = Val | (int{Mip.Data[i + 1]} << 8);
+                        RefVal = RefVal | (int{RefMip.Data[i + 1]} << 8);
+                    }
+                    ASSERT_LE(std::abs(Val - RefVal), ComponentType == VT_UINT8 ? 1 : 4)
+                        << (IsSRGB ? "sRGB, " : "linear, ") << NumChannels << " channels, " << Size[0] << "x" << Size[1] << ", byte " << i;
+                }
+            }
+        }
+    }
+}
+
+TEST(Tools_TextureLoader, ComputeCoarseMip_Kaiser)
+{
+    TestComputeCoarseMipFiltered(VT_UINT8, MIP_FILTER_KAISER);
+    TestComputeCoarseMipFiltered(VT_UINT16, MIP_FILTER_KAISER);
+}
+
+TEST(Tools_TextureLoader, ComputeCoarseMip_Lanczos)
+{
+    TestComputeCoarseMipFiltered(VT_UINT8, MIP_FILTER_LANCZOS);
+    TestComputeCoarseMipFiltered(VT_UINT16, MIP_FILTER_LANCZOS);
+}
+
+TEST(Tools_TextureLoader, ComputeCoarseMip_UniformFiltered)
+{
+    // Normalized filters must not change uniform images
+    TestMip FineMip;
+    FineMip.Width  = 37;
+    FineMip.Height = 12;
+    FineMip.Stride = FineMip.Width * 4;
+    FineMip.Data.resize(size_t{FineMip.Stride} * FineMip.Height);
+    for (auto Filter : {MIP_FILTER_KAISER, MIP_FILTER_LANCZOS})
+    {
+        for (int IsSRGB = 0; IsSRGB <= 1; ++IsSRGB)
+        {
+            for (Uint32 v = 0; v < 256; ++v)
+            {
+                std::fill(FineMip.Data.begin(), FineMip.Data.end(), static_cast<Uint8>(v));
+                TestMip Mip;
+                ComputeCoarseMip(GetAttribs(VT_UINT8, 4, IsSRGB != 0, FineMip, Mip, 4, Filter));
+                for (auto Byte : Mip.Data)
+                    ASSERT_EQ(Byte, v) << (IsSRGB ? "sRGB" : "linear");
+            }
+        }
+    }
+}
+
+TEST(Tools_TextureLoader, ComputeCoarseMipParallel_Filtered)
+{
+    std::mt19937 Gen{3};
+    ThreadPool   Pool{3};
+
+    const auto FineMip = CreateRandomMip(1029, 1031, 4, Gen);
+    ASSERT_GT(FineMip.Height / 2, GetParallelMipRowsPerBand(FineMip.Width / 2 * 4));
+    for (auto Filter : {MIP_FILTER_KAISER, MIP_FILTER_LANCZOS})
+    {
+        TestMip RefMip, Mip;
+        ComputeCoarseMip(GetAttribs(VT_UINT8, 4, true, FineMip, RefMip, 4, Filter));
+        ComputeCoarseMipParallel(GetAttribs(VT_UINT8, 4, true, FineMip, Mip, 4, Filter), Pool);
+        EXPECT_EQ(Mip.Data, RefMip.Data);
+    }
+}
+
+// Creates an RGBA image whose alpha is mostly low with sparse opaque pixels, which is typical for foliage.
+// Averaging such alpha makes all pixels of coarse levels fail the alpha test.
+TestMip CreateAlphaTestedMip(Uint32 Width, Uint32 Height, VALUE_TYPE ComponentType, std::mt19937& Gen)
+{
+    const Uint32 ChannelSize = ComponentType == VT_UINT8 ? 1 : 2;
+    const Uint32 MaxVal      = ComponentType == VT_UINT8 ? 255 : 65535;
+
+    TestMip Mip;
+    Mip.Width  = Width;
+    Mip.Height = Height;
+    Mip.Stride = Width * 4 * ChannelSize;
+    Mip.Data.resize(size_t{Mip.Stride} * Height);
+
+    std::uniform_real_distribution<float> Dist{0, 1};
+    for (Uint32 y = 0; y < Height; ++y)
+    {
+        for (Uint32 x = 0; x < Width; ++x)
+        {
+            const auto r = Dist(Gen);
+            for (Uint32 c = 0; c < 4; ++c)
+            {
+                const auto Val  = c == 3 ? static_cast<Uint32>(r * r * r * static_cast<float>(MaxVal) + 0.5f) : (x * 5 + y * 3 + c * 50) % (MaxVal + 1);
+                auto*      pDst = &Mip.Data[size_t{y} * Mip.Stride + (x * 4 + c) * ChannelSize];
+                pDst[0]         = static_cast<Uint8>(Val);
+                if (ChannelSize == 2)
+                    pDst[1] = static_cast<Uint8>(Val >> 8);
+            }
+        }
+    }
+    return Mip;
+}
+
+TEST(Tools_TextureLoader, ComputeMipChain_AlphaCoverage)
+{
+    constexpr Uint32 Width  = 256;
+    constexpr Uint32 Height = 128;
+    constexpr float  Cutoff = 0.5f;
+
+    std::mt19937 Gen{4};
+
+    for (auto ComponentType : {VT_UINT8, VT_UINT16})
+    {
+        for (auto Filter : {MIP_FILTER_BOX, MIP_FILTER_KAISER})
+        {
+            for (int PreserveCoverage = 0; PreserveCoverage <= 1; ++PreserveCoverage)
+            {
+                const Uint32 PixelSize = ComponentType == VT_UINT8 ? 4 : 8;
+
+                // 256x128 image has 9 levels
+                std::vector<TestMip> Mips(9);
+                Mips[0] = CreateAlphaTestedMip(Width, Height, ComponentType, Gen);
+
+                std::vector<MappedTextureSubresource> MipData(Mips.size());
+                for (size_t mip = 0; mip < Mips.size(); ++mip)
+                {
+                    if (mip > 0)
+                    {
+                        Mips[mip].Width  = std::max(Width >> mip, 1u);
+                        Mips[mip].Height = std::max(Height >> mip, 1u);
+                        Mips[mip].Stride = Mips[mip].Width * PixelSize;
+                        Mips[mip].Data.assign(size_t{Mips[mip].Stride} * Mips[mip].Height, 0xCD);
+                    }
+                    MipData[mip].pData  = Mips[mip].Data.data();
+                    MipData[mip].Stride = Mips[mip].Stride;
+                }
+
+                ComputeMipChainAttribs Attribs;
+                Attribs.ComponentType = ComponentType;
+                Attribs.NumChannels   = 4;
+                Attribs.Filter        = Filter;
+                Attribs.AlphaCutoff   = PreserveCoverage ? Cutoff : 0.f;
+                Attribs.Width         = Width;
+                Attribs.Height        = Height;
+                Attribs.pMips         = MipData.data();
+                Attribs.MipLevels     = static_cast<Uint32>(Mips.size());
+                ComputeMipChain(Attribs);
+
+                const auto GetCoverage = [&](Uint32 mip) {
+                    AlphaCoverageAttribs CoverageAttribs;
+                    CoverageAttribs.ComponentType = ComponentType;
+                    CoverageAttribs.pData         = MipData[mip].pData;
+                    CoverageAttribs.Stride        = MipData[mip].Stride;
+                    CoverageAttribs.Width         = Mips[mip].Width;
+                    CoverageAttribs.Height        = Mips[mip].Height;
+                    CoverageAttribs.AlphaCutoff   = Cutoff;
+                    return ComputeAlphaCoverage(CoverageAttribs);
+                };
+
+                // Alpha is r^3, where r is uniformly distributed in [0, 1]
+                const auto TargetCoverage = GetCoverage(0);
+                EXPECT_NEAR(TargetCoverage, 1.f - std::pow(0.5f, 1.f / 3.f), 0.01f);
+
+                // Levels that have at least 512 pixels
+                for (Uint32 mip = 1; mip <= 3; ++mip)
+                {
+                    const auto Coverage = GetCoverage(mip);
+                    if (PreserveCoverage)
+                    {
+                        EXPECT_NEAR(Coverage, TargetCoverage, 0.01f) << "mip " << mip;
+                    }
+                    else if (mip == 3)
+                    {
+                        EXPECT_LT(Coverage, TargetCoverage / 4) << "mip " << mip;
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST(Tools_TextureLoader, ScaleAlphaToCoverage)
+{
+    // Alpha values 0, 1, ..., 255 in one row
+    std::vector<Uint8> Pixels(256 * 4);
+    for (Uint32 i = 0; i < 256; ++i)
+        Pixels[i * 4 + 3] = static_cast<Uint8>(i);
+
+    AlphaCoverageAttribs Attribs;
+    Attribs.pData       = Pixels.data();
+    Attribs.Stride      = static_cast<Uint32>(Pixels.size());
+    Attribs.Width       = 256;
+    Attribs.Height      = 1;
+    Attribs.AlphaCutoff = 0.5f;
+    EXPECT_FLOAT_EQ(ComputeAlphaCoverage(Attribs), 128.f / 256.f);
+
+    // The current coverage does not need scaling
+    EXPECT_EQ(ScaleAlphaToCoverage(Attribs, 0.5f), 1.f);
+
+    for (float TargetCoverage : {0.25f, 0.75f, 1.f / 256.f})
+    {
+        const auto Scale = ScaleAlphaToCoverage(Attribs, TargetCoverage);
+        EXPECT_FLOAT_EQ(ComputeAlphaCoverage(Attribs), TargetCoverage) << TargetCoverage;
+        EXPECT_EQ(Pixels[3], 0) << "Zero alpha must not change";
+        // Alpha must remain monotonic
+        for (Uint32 i = 1; i < 256; ++i)
+            ASSERT_LE(Pixels[(i - 1) * 4 + 3], Pixels[i * 4 + 3]);
+        // Restore the original alpha
+        for (Uint32 i = 0; i < 256; ++i)
+            Pixels[i * 4 + 3] = static_cast<Uint8>(i);
+        EXPECT_NE(Scale, 1.f);
+    }
+}
+
+TEST(Tools_TextureLoader, StreamingMipGenerator)
+{
+    std::mt19937 Gen{2};
+
+    const Uint32 Sizes[][2] = {{1, 1}, {5, 1}, {1, 9}, {37, 23}, {64, 64}, {130, 97}};
+    for (int IsSRGB = 0; IsSRGB <= 1; ++IsSRGB)
+    {
+        for (const auto& Size : Sizes)
+        {
+            // Compute the reference chain from complete levels
+            std::vector<TestMip> RefMips(1);
+            RefMips[0] = CreateRandomMip(Size[0], Size[1], 4, Gen);
+            while (RefMips.back().Width > 1 || RefMips.back().Height > 1)
+            {
+                TestMip Coarse;
+                ComputeCoarseMip(GetAttribs(VT_UINT8, 4, IsSRGB != 0, RefMips.back(), Coarse, 4));
+                RefMips.emplace_back(std::move(Coarse));
+            }
+
+            for (Uint32 RowsPerBand : {1u, 2u, 3u, 7u, 64u})
+            {
+                std::vector<std::vector<Uint8>> Mips(RefMips.size());
+                for (size_t mip = 0; mip < Mips.size(); ++mip)
+                    Mips[mip].assign(size_t{RefMips[mip].Width} * 4 * RefMips[mip].Height, 0xCD);
+
+                StreamingMipGenerator::CreateInfo CI;
+                CI.NumChannels = 4;
+                CI.IsSRGB      = IsSRGB != 0;
+                CI.Width       = Size[0];
+                CI.Height      = Size[1];
+
+                Uint32                NumReceivedRows = 0;
+                StreamingMipGenerator MipGen{
+                    CI,
+                    [&](Uint32 Mip, Uint32 FirstRow, Uint32 NumRows, const void* pData, Uint32 Stride) {
+                        const auto RowSize = RefMips[Mip].Width * 4;
+                        ASSERT_LE(FirstRow + NumRows, RefMips[Mip].Height);
+                        for (Uint32 row = 0; row < NumRows; ++row)
+                            memcpy(&Mips[Mip][size_t{FirstRow + row} * RowSize], reinterpret_cast<const Uint8*>(pData) + size_t{row} * Stride, RowSize);
+                        NumReceivedRows += NumRows;
+                    } //
+                };
+                ASSERT_EQ(MipGen.GetMipLevels(), RefMips.size());
+
+                for (Uint32 row = 0; row < Size[1]; row += RowsPerBand)
+                {
+                    const auto NumRows = std::min(RowsPerBand, Size[1] - row);
+                    MipGen.AddRows(&RefMips[0].Data[size_t{row} * RefMips[0].Stride], RefMips[0].Stride, NumRows);
+                }
+                EXPECT_EQ(MipGen.GetNumAddedRows(), Size[1]);
+
+                Uint32 NumExpectedRows = 0;
+                for (size_t mip = 0; mip < Mips.size(); ++mip)
+                {
+                    const auto& RefMip  = RefMips[mip];
+                    const auto  RowSize = RefMip.Width * 4;
+                    NumExpectedRows += RefMip.Height;
+                    for (Uint32 row = 0; row < RefMip.Height; ++row)
+                    {
+                        ASSERT_EQ(memcmp(&Mips[mip][size_t{row} * RowSize], &RefMip.Data[size_t{row} * RefMip.Stride], RowSize), 0)
+                            << Size[0] << "x" << Size[1] << ", " << RowsPerBand << " rows per band, mip " << mip << ", row " << row;
+                    }
+                }
+                EXPECT_EQ(NumReceivedRows, NumExpectedRows);
+            }
+        }
+    }
+}
+
+TEST(Tools_TextureLoader, StreamingMipGenerator_ScratchMemory)
+{
+    // The scratch memory must not depend on the image height
+    std::vector<Uint8> Band(size_t{512} * 4 * 16, 128);
+    for (Uint32 Height : {256u, 4096u})
+    {
+        StreamingMipGenerator::CreateInfo CI;
+        CI.NumChannels = 4;
+        CI.Width       = 512;
+        CI.Height      = Height;
+
+        StreamingMipGenerator MipGen{CI, [](Uint32, Uint32, Uint32, const void*, Uint32) {}};
+        for (Uint32 row = 0; row < Height; row += 16)
+            MipGen.AddRows(Band.data(), 512 * 4, 16);
+        EXPECT_LE(MipGen.GetScratchMemorySize(), size_t{512} * 4 * 16) << Height;
+    }
+}
+
+// Run with --gtest_also_run_disabled_tests
+TEST(Tools_TextureLoader, DISABLED_ComputeCoarseMip_Benchmark)
+{
+    std::mt19937 Gen{0};
+
+    const auto FineMip = CreateRandomMip(4096, 4096, 4, Gen);
+    for (auto Filter : {MIP_FILTER_BOX, MIP_FILTER_KAISER, MIP_FILTER_LANCZOS})
+    {
+        for (int IsSRGB = 0; IsSRGB <= 1; ++IsSRGB)
+        {
+            // The reference implementation of 12x12 filters is too slow for this size
+            for (int UseRef = 0; UseRef <= (Filter == MIP_FILTER_BOX ? 1 : 0); ++UseRef)
+            {
+                // Generate the full mip chain
+                std::vector<TestMip> Mips(1);
+                Mips[0]         = FineMip;
+                const auto Start = std::chrono::high_resolution_clock::now();
+                while (Mips.back().Width > 1 || Mips.back().Height > 1)
+                {
+                    TestMip Coarse;
+                    auto    Attribs = GetAttribs(VT_UINT8, 4, IsSRGB != 0, Mips.back(), Coarse, 4, Filter);
+                    if (UseRef)
+                        ComputeCoarseMipRef(Attribs);
+                    else
+                        ComputeCoarseMip(Attribs);
+                    Mips.emplace_back(std::move(Coarse));
+                }
+                const auto End = std::chrono::high_resolution_clock::now();
+                static const char* FilterNames[] = {"box", "Kaiser", "Lanczos"};
+                LOG_INFO_MESSAGE("4096x4096 RGBA8 ", (IsSRGB ? "sRGB " : "linear "), FilterNames[Filter], (UseRef ? " reference: " : ": "),
+                                 std::chrono::duration<double, std::milli>(End - Start).count(), " ms");
+            }
+        }
+    }
+}
+
+} // namespace
@@ -0,0 +1,267 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+#include "PixelConversion.hpp"
+#include "DebugUtilities.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace Diligent;
+
+namespace
+{
+
+template <typename T>
+std::vector<T> CreateRandomData(size_t Size, std::mt19937& Gen)
+{
+    std::uniform_int_distribution<Uint32> Distr{0, std::numeric_limits<T>::max()};
+
+    std::vector<T> Data(Size);
+    for (auto& Val : Data)
+        Val = static_cast<T>(Distr(Gen));
+    return Data;
+}
+
+// Runs the kernel and the reference kernel for different pixel counts, so that both
+// the vectorized loops and the scalar tails are tested, and compares the results.
+template <typename SrcType, typename DstType, typename KernelType, typename RefKernelType>
+void TestKernel(Uint32 SrcComponents, Uint32 DstComponents, KernelType Kernel, RefKernelType RefKernel)
+{
+    std::mt19937 Gen{SrcComponents * 10 + DstComponents};
+    for (size_t NumPixels : {0, 1, 3, 7, 8, 15, 16, 17, 31, 33, 64, 100, 1027})
+    {
+        const auto Src = CreateRandomData<SrcType>(NumPixels * SrcComponents, Gen);
+
+        std::vector<DstType> Dst(NumPixels * DstComponents + 1, 0xCD);
+        std::vector<DstType> RefDst(NumPixels * DstComponents + 1, 0xCD);
+        Kernel(Src.data(), Dst.data(), NumPixels);
+        RefKernel(Src.data(), RefDst.data(), NumPixels);
+        EXPECT_EQ(Dst, RefDst) << NumPixels << " pixels";
+        EXPECT_EQ(Dst.back(), DstType{0xCD}) << "Out of bounds write";
+    }
+}
+
+double GetBandwidth(size_t NumBytes, const std::function<void()>& Func)
+{
+    constexpr int NumRuns = 20;
+
+    const auto Start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < NumRuns; ++i)
+        Func();
+    const auto End = std::chrono::high_resolution_clock::now();
+
+    const auto Seconds = std::chrono::duration<double>(End - Start).count();
+    return static_cast<double>(NumBytes) * NumRuns / Seconds / (1 << 30);
+}
+
+TEST(Tools_TextureLoader, ExpandRGB8ToRGBA8)
+{
+    const Uint8 Src[] = {1, 2, 3, 4, 5, 6};
+    Uint8       Dst[8];
+    ExpandRGB8ToRGBA8Ref(Src, Dst, 2);
+    const Uint8 Expected[] = {1, 2, 3, 255, 4, 5, 6, 255};
+    EXPECT_EQ(memcmp(Dst, Expected, sizeof(Dst)), 0);
+
+    TestKernel<Uint8, Uint8>(3, 4, ExpandRGB8ToRGBA8, ExpandRGB8ToRGBA8Ref);
+}
+
+TEST(Tools_TextureLoader, ExpandRGB16ToRGBA16)
+{
+    const Uint16 Src[] = {1000, 2000, 3000, 40000, 50000, 60000};
+    Uint16       Dst[8];
+    ExpandRGB16ToRGBA16Ref(Src, Dst, 2);
+    const Uint16 Expected[] = {1000, 2000, 3000, 65535, 40000, 50000, 60000, 65535};
+    EXPECT_EQ(memcmp(Dst, Expected, sizeof(Dst)), 0);
+
+    TestKernel<Uint16, Uint16>(3, 4, ExpandRGB16ToRGBA16, ExpandRGB16ToRGBA16Ref);
+}
+
+TEST(Tools_TextureLoader, ExpandGray8ToRGBA8)
+{
+    const Uint8 Src[] = {7, 200};
+    Uint8       Dst[8];
+    ExpandGray8ToRGBA8Ref(Src, Dst, 2);
+    const Uint8 Expected[] = {7, 7, 7, 255, 200, 200, 200, 255};
+    EXPECT_EQ(memcmp(Dst, Expected, sizeof(Dst)), 0);
+
+    TestKernel<Uint8, Uint8>(1, 4, ExpandGray8ToRGBA8, ExpandGray8ToRGBA8Ref);
+}
+
+TEST(Tools_TextureLoader, SwapRB8)
+{
+    Uint8       Data[]     = {1, 2, 3, 4, 5, 6, 7, 8};
+    const Uint8 Expected[] = {3, 2, 1, 4, 7, 6, 5, 8};
+    SwapRB8Ref(Data, Data, 2);
+    EXPECT_EQ(memcmp(Data, Expected, sizeof(Data)), 0);
+
+    TestKernel<Uint8, Uint8>(4, 4, SwapRB8, SwapRB8Ref);
+
+    // In-place conversion
+    std::mt19937 Gen{0};
+    auto         InPlace = CreateRandomData<Uint8>(4 * 100, Gen);
+    auto         RefDst  = InPlace;
+    SwapRB8Ref(RefDst.data(), RefDst.data(), 100);
+    SwapRB8(InPlace.data(), InPlace.data(), 100);
+    EXPECT_EQ(InPlace, RefDst);
+}
+
+TEST(Tools_TextureLoader, PackRGBA8ToRGB8)
+{
+    const Uint8 Src[] = {1, 2, 3, 4, 5, 6, 7, 8};
+    Uint8       Dst[6];
+    PackRGBA8ToRGB8Ref(Src, Dst, 2, false);
+    const Uint8 Expected[] = {1, 2, 3, 5, 6, 7};
+    EXPECT_EQ(memcmp(Dst, Expected, sizeof(Dst)), 0);
+    PackRGBA8ToRGB8Ref(Src, Dst, 2, true);
+    const Uint8 ExpectedSwapped[] = {3, 2, 1, 7, 6, 5};
+    EXPECT_EQ(memcmp(Dst, ExpectedSwapped, sizeof(Dst)), 0);
+
+    for (bool SwapRB : {false, true})
+    {
+        TestKernel<Uint8, Uint8>(
+            4, 3,
+            [SwapRB](const Uint8* pSrc, Uint8* pDst, size_t NumPixels) { PackRGBA8ToRGB8(pSrc, pDst, NumPixels, SwapRB); },
+            [SwapRB](const Uint8* pSrc, Uint8* pDst, size_t NumPixels) { PackRGBA8ToRGB8Ref(pSrc, pDst, NumPixels, SwapRB); });
+    }
+}
+
+TEST(Tools_TextureLoader, ConvertFloatToHalf)
+{
+    const auto Inf = std::numeric_limits<float>::infinity();
+
+    // clang-format off
+    const std::pair<float, Uint16> TestValues[] =
+    {
+        {0.f,                       0x0000},
+        {-0.f,                      0x8000},
+        {1.f,                       0x3C00},
+        {-2.f,                      0xC000},
+        {0.1f,                      0x2E66},
+        {65504.f,                   0x7BFF},
+        {65519.f,                   0x7BFF},
+        {65520.f,                   0x7C00},
+        {1e10f,                     0x7C00},
+        {Inf,                       0x7C00},
+        {-Inf,                      0xFC00},
+        {std::ldexp(1.f, -14),      0x0400}, // Smallest normal
+        {std::ldexp(1.f, -24),      0x0001}, // Smallest denormal
+        {std::ldexp(1.f, -25),      0x0000}, // Tie rounds to even
+        {std::ldexp(1.5f, -25),     0x0001},
+        {std::ldexp(3.f, -25),      0x0002}, // Tie rounds to even
+        {std::ldexp(1023.5f, -24),  0x0400}, // Rounds up to the smallest normal
+        {1.f + std::ldexp(1.f, -11), 0x3C00}, // Tie rounds to even
+        {1.f + std::ldexp(3.f, -11), 0x3C02}, // Tie rounds to even
+    };
+    // clang-format on
+    for (const auto& Val : TestValues)
+    {
+        Uint16 Half = 0;
+        ConvertFloatToHalfRef(&Val.first, &Half, 1);
+        EXPECT_EQ(Half, Val.second) << Val.first;
+    }
+
+    Uint16      NaNHalf = 0;
+    const float NaN     = std::numeric_limits<float>::quiet_NaN();
+    ConvertFloatToHalfRef(&NaN, &NaNHalf, 1);
+    EXPECT_EQ(NaNHalf & 0x7C00, 0x7C00);
+    EXPECT_NE(NaNHalf & 0x3FF, 0);
+
+    // Random bit patterns cover all classes of values, including NaNs
+    TestKernel<Uint32, Uint16>(
+        1, 1,
+        [](const Uint32* pSrc, Uint16* pDst, size_t NumValues) { ConvertFloatToHalf(reinterpret_cast<const float*>(pSrc), pDst, NumValues); },
+        [](const Uint32* pSrc, Uint16* pDst, size_t NumValues) { ConvertFloatToHalfRef(reinterpret_cast<const float*>(pSrc), pDst, NumValues); });
+
+    // Values in the half range
+    std::mt19937                          Gen{0};
+    std::uniform_real_distribution<float> Distr{-70000.f, 70000.f};
+    std::vector<float>                    Src(1000);
+    for (size_t i = 0; i < Src.size(); ++i)
+        Src[i] = Distr(Gen) * std::ldexp(1.f, -static_cast<int>(i % 40));
+    std::vector<Uint16> Dst(Src.size()), RefDst(Src.size());
+    ConvertFloatToHalf(Src.data(), Dst.data(), Src.size());
+    ConvertFloatToHalfRef(Src.data(), RefDst.data(), Src.size());
+    EXPECT_EQ(Dst, RefDst);
+}
+
+TEST(Tools_TextureLoader, DISABLED_PixelConversion_Benchmark)
+{
+    constexpr size_t NumPixels = 4096 * 1024;
+
+    std::mt19937 Gen{0};
+
+    const auto Src8  = CreateRandomData<Uint8>(NumPixels * 4, Gen);
+    const auto Src16 = CreateRandomData<Uint16>(NumPixels * 3, Gen);
+
+    std::vector<float> SrcFloat(NumPixels);
+    for (size_t i = 0; i < NumPixels; ++i)
+        SrcFloat[i] = static_cast<float>(i % 10000) * 0.37f - 1000.f;
+
+    std::vector<Uint8>  Dst8(NumPixels * 4);
+    std::vector<Uint16> Dst16(NumPixels * 4);
+
+    LOG_INFO_MESSAGE("Instruction set: ", GetPixelConversionISA());
+
+    auto Report = [](const char* Name, size_t NumBytes, const std::function<void()>& Ref, const std::function<void()>& Func) {
+        LOG_INFO_MESSAGE(Name, ": ", GetBandwidth(NumBytes, Ref), " GB/s scalar, ",
+                         GetBandwidth(NumBytes, Func), " GB/s dispatched");
+    };
+
+    Report(
+        "RGB8 -> RGBA8", NumPixels * 3,
+        [&]() { ExpandRGB8ToRGBA8Ref(Src8.data(), Dst8.data(), NumPixels); },
+        [&]() { ExpandRGB8ToRGBA8(Src8.data(), Dst8.data(), NumPixels); });
+    Report(
+        "RGB16 -> RGBA16", NumPixels * 6,
+        [&]() { ExpandRGB16ToRGBA16Ref(Src16.data(), Dst16.data(), NumPixels); },
+        [&]() { ExpandRGB16ToRGBA16(Src16.data(), Dst16.data(), NumPixels); });
+    Report(
+        "Gray8 -> RGBA8", NumPixels,
+        [&]() { ExpandGray8ToRGBA8Ref(Src8.data(), Dst8.data(), NumPixels); },
+        [&]() { ExpandGray8ToRGBA8(Src8.data(), Dst8.data(), NumPixels); });
+    Report(
+        "BGRA8 -> RGBA8", NumPixels * 4,
+        [&]() { SwapRB8Ref(Src8.data(), Dst8.data(), NumPixels); },
+        [&]() { SwapRB8(Src8.data(), Dst8.data(), NumPixels); });
+    Report(
+        "BGRA8 -> RGB8", NumPixels * 4,
+        [&]() { PackRGBA8ToRGB8Ref(Src8.data(), Dst8.data(), NumPixels, true); },
+        [&]() { PackRGBA8ToRGB8(Src8.data(), Dst8.data(), NumPixels, true); });
+    Report(
+        "Float -> half", NumPixels * 4,
+        [&]() { ConvertFloatToHalfRef(SrcFloat.data(), Dst16.data(), NumPixels); },
+        [&]() { ConvertFloatToHalf(SrcFloat.data(), Dst16.data(), NumPixels); });
+}
+
+} // namespace
@@ -0,0 +1,173 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+#include "SkinningPalette.hpp"
+#include "GLTFLoader.hpp"
+
+#include <vector>
+#include <random>
+#include <memory>
+
+#include "gtest/gtest.h"
+
+using namespace Diligent;
+
+namespace
+{
+
+float4x4 MakeRigidTransform(std::mt19937& Gen)
+{
+    std::uniform_real_distribution<float> Dist{-1.f, 1.f};
+
+    const float3 Axis{Dist(Gen), Dist(Gen), Dist(Gen) + 2.f};
+    return Quaternion::RotationFromAxisAngle(Axis, Dist(Gen) * PI_F).ToMatrix() *
+        float4x4::Translation(Dist(Gen) * 10.f, Dist(Gen) * 10.f, Dist(Gen) * 10.f);
+}
+
+float4x4 MakeAffineTransform(std::mt19937& Gen)
+{
+    std::uniform_real_distribution<float> Dist{0.5f, 2.f};
+    return float4x4::Scale(Dist(Gen), Dist(Gen), Dist(Gen)) * MakeRigidTransform(Gen);
+}
+
+void ExpectMatricesNear(const float4x4& M0, const float4x4& M1, float Tolerance)
+{
+    for (int r = 0; r < 4; ++r)
+    {
+        for (int c = 0; c < 4; ++c)
+            EXPECT_NEAR(M0[r][c], M1[r][c], Tolerance) << "row " << r << ", column " << c;
+    }
+}
+
+TEST(Tools_AssetLoader, ComputeSkinningMatrices)
+{
+    std::mt19937 Gen{17};
+
+    constexpr Uint32      NumJoints = 300;
+    std::vector<float4x4> InvBindMatrices(NumJoints);
+    std::vector<float4x4> JointMatrices(NumJoints);
+    for (Uint32 i = 0; i < NumJoints; ++i)
+    {
+        InvBindMatrices[i] = MakeAffineTransform(Gen);
+        JointMatrices[i]   = MakeAffineTransform(Gen);
+    }
+    std::vector<const float4x4*> pJointMatrices(NumJoints);
+    for (Uint32 i = 0; i < NumJoints; ++i)
+        pJointMatrices[i] = &JointMatrices[i];
+
+    const auto InvMeshMatrix = MakeAffineTransform(Gen).Inverse();
+
+    std::vector<float4x4> Ref(NumJoints), Result(NumJoints);
+    ComputeSkinningMatricesRef(InvBindMatrices.data(), pJointMatrices.data(), InvMeshMatrix, NumJoints, Ref.data());
+    ComputeSkinningMatrices(InvBindMatrices.data(), pJointMatrices.data(), InvMeshMatrix, NumJoints, Result.data());
+    for (Uint32 i = 0; i < NumJoints; ++i)
+        ExpectMatricesNear(Result[i], Ref[i], 1e-3f);
+}
+
+TEST(Tools_AssetLoader, InverseAffineMatrix)
+{
+    std::mt19937 Gen{42};
+    for (int i = 0; i < 100; ++i)
+    {
+        const auto M = MakeAffineTransform(Gen);
+        ExpectMatricesNear(InverseAffineMatrix(M), M.Inverse(), 1e-4f);
+        ExpectMatricesNear(M * InverseAffineMatrix(M), float4x4::Identity(), 1e-4f);
+    }
+}
+
+TEST(Tools_AssetLoader, DualQuaternions)
+{
+    std::mt19937 Gen{7};
+
+    constexpr Uint32      NumMatrices = 100;
+    std::vector<float4x4> Matrices(NumMatrices);
+    for (auto& M : Matrices)
+        M = MakeRigidTransform(Gen);
+    // Rotations by 180 degrees have zero trace
+    Matrices[0] = float4x4::RotationX(PI_F) * float4x4::Translation(1, 2, 3);
+    Matrices[1] = float4x4::RotationY(PI_F);
+    Matrices[2] = float4x4::RotationZ(PI_F) * float4x4::Translation(-3, 0, 5);
+
+    std::vector<float4> DualQuats(NumMatrices * 2);
+    MatricesToDualQuaternions(Matrices.data(), NumMatrices, DualQuats.data());
+    for (Uint32 i = 0; i < NumMatrices; ++i)
+    {
+        const auto& Real = DualQuats[i * 2 + 0];
+        const auto& Dual = DualQuats[i * 2 + 1];
+        EXPECT_NEAR(length(Real), 1.f, 1e-5f);
+        // Unit dual quaternions satisfy Real . Dual = 0
+        EXPECT_NEAR(dot(Real, Dual), 0.f, 1e-4f);
+        ExpectMatricesNear(DualQuaternionToMatrix(Real, Dual), Matrices[i], 1e-4f);
+
+        const float3 Pos{1, -2, 3};
+        const auto   DQPos = Pos * DualQuaternionToMatrix(Real, Dual);
+        const auto   RefPos = Pos * Matrices[i];
+        EXPECT_NEAR(DQPos.x, RefPos.x, 1e-3f);
+        EXPECT_NEAR(DQPos.y, RefPos.y, 1e-3f);
+        EXPECT_NEAR(DQPos.z, RefPos.z, 1e-3f);
+    }
+}
+
+TEST(Tools_AssetLoader, UpdateSkinningPalette)
+{
+    std::mt19937 Gen{123};
+
+    // More joints than fit into the constant buffer
+    constexpr Uint32 NumJoints = GLTF::Mesh::TransformData::MaxNumJoints * 2;
+
+    std::vector<std::unique_ptr<GLTF::Node>> Joints;
+    GLTF::Skin                               Skin;
+    for (Uint32 i = 0; i < NumJoints; ++i)
+    {
+        Joints.emplace_back(new GLTF::Node{});
+        Joints.back()->GlobalMatrix = MakeRigidTransform(Gen);
+        Skin.Joints.push_back(Joints.back().get());
+        Skin.InverseBindMatrices.push_back(MakeRigidTransform(Gen));
+    }
+
+    GLTF::Node SkinnedNode;
+    SkinnedNode.GlobalMatrix = MakeRigidTransform(Gen);
+    SkinnedNode._Mesh.reset(new GLTF::Mesh{nullptr, SkinnedNode.GlobalMatrix});
+    SkinnedNode._Skin = &Skin;
+
+    GLTF::UpdateSkinningPalette(SkinnedNode, GLTF::SKINNING_PALETTE_FORMAT_DUAL_QUATERNION);
+
+    const auto& Transforms = SkinnedNode._Mesh->Transforms;
+    ASSERT_EQ(Transforms.jointcount, static_cast<int>(NumJoints));
+    ASSERT_EQ(Transforms.jointMatrix.size(), size_t{NumJoints});
+    ASSERT_EQ(Transforms.jointDualQuats.size(), size_t{NumJoints} * 2);
+
+    const auto InvMeshMatrix = SkinnedNode.GlobalMatrix.Inverse();
+    for (Uint32 i = 0; i < NumJoints; ++i)
+    {
+        const auto Ref = Skin.InverseBindMatrices[i] * Joints[i]->GlobalMatrix * InvMeshMatrix;
+        ExpectMatricesNear(Transforms.jointMatrix[i], Ref, 1e-3f);
+        ExpectMatricesNear(DualQuaternionToMatrix(Transforms.jointDualQuats[i * 2], Transforms.jointDualQuats[i * 2 + 1]), Ref, 1e-3f);
+    }
+}
+
+} // namespace
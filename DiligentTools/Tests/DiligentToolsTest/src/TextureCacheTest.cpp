@@ -0,0 +1,276 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+#include "TextureCache.hpp"
+
+#include <cstring>
+#include <vector>
+
+#include "FileSystem.hpp"
+#include "DataBlobImpl.hpp"
+#include "RefCntAutoPtr.hpp"
+
+#include "gtest/gtest.h"
+
+using namespace Diligent;
+
+namespace
+{
+
+static constexpr char TestCacheDirectory[] = "TextureCacheTest";
+
+// Deletes the cache files and the directory when the test ends
+class TestCacheDirectoryCleaner
+{
+public:
+    ~TestCacheDirectoryCleaner()
+    {
+        for (auto Key : Keys)
+        {
+            TextureCache::CreateInfo CI;
+            CI.Directory = TestCacheDirectory;
+            FileSystem::DeleteFile(TextureCache{CI}.GetFilePath(Key).c_str());
+        }
+        const auto IndexPath = std::string{TestCacheDirectory} + FileSystem::GetSlashSymbol() + "TextureCache.idx";
+        FileSystem::DeleteFile(IndexPath.c_str());
+        FileSystem::DeleteFile(TestCacheDirectory);
+    }
+
+    std::vector<Uint64> Keys;
+};
+
+struct TestTexture
+{
+    TextureDesc                    Desc;
+    std::vector<std::vector<Uint8>> Levels;
+    std::vector<TextureSubResData> SubResources;
+
+    TextureData GetData()
+    {
+        return TextureData{SubResources.data(), static_cast<Uint32>(SubResources.size())};
+    }
+};
+
+// Creates an R8 texture with tightly packed rows and a seed-dependent pattern
+TestTexture CreateTestTexture(Uint32 Width, Uint32 Height, Uint32 MipLevels, Uint8 Seed)
+{
+    TestTexture Tex;
+    Tex.Desc.Type      = RESOURCE_DIM_TEX_2D;
+    Tex.Desc.Width     = Width;
+    Tex.Desc.Height    = Height;
+    Tex.Desc.MipLevels = MipLevels;
+    Tex.Desc.Format    = TEX_FORMAT_R8_UNORM;
+
+    Tex.Levels.resize(MipLevels);
+    Tex.SubResources.resize(MipLevels);
+    for (Uint32 m = 0; m < MipLevels; ++m)
+    {
+        const auto MipWidth  = std::max(Width >> m, 1u);
+        const auto MipHeight = std::max(Height >> m, 1u);
+        auto&      Level     = Tex.Levels[m];
+        Level.resize(size_t{MipWidth} * MipHeight);
+        for (size_t i = 0; i < Level.size(); ++i)
+            Level[i] = static_cast<Uint8>(Seed + i * 7 + m);
+        Tex.SubResources[m].pData  = Level.data();
+        Tex.SubResources[m].Stride = MipWidth;
+    }
+    return Tex;
+}
+
+TEST(Tools_TextureLoader, TextureCache_ComputeKey)
+{
+    const Uint8 Data[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+
+    TextureLoadInfo LoadInfo;
+    const auto      Key = TextureCache::ComputeKey(Data, sizeof(Data), LoadInfo);
+    EXPECT_EQ(Key, TextureCache::ComputeKey(Data, sizeof(Data), LoadInfo));
+
+    // Parameters that don't affect texture data don't change the key
+    {
+        auto LoadInfo2      = LoadInfo;
+        LoadInfo2.Name      = "Test texture";
+        LoadInfo2.Usage     = USAGE_DEFAULT;
+        LoadInfo2.BindFlags = BIND_SHADER_RESOURCE | BIND_RENDER_TARGET;
+        EXPECT_EQ(Key, TextureCache::ComputeKey(Data, sizeof(Data), LoadInfo2));
+    }
+
+    {
+        auto LoadInfo2   = LoadInfo;
+        LoadInfo2.IsSRGB = !LoadInfo.IsSRGB;
+        EXPECT_NE(Key, TextureCache::ComputeKey(Data, sizeof(Data), LoadInfo2));
+    }
+    {
+        auto LoadInfo2             = LoadInfo;
+        LoadInfo2.CompressedFormat = TEX_FORMAT_BC7_UNORM;
+        EXPECT_NE(Key, TextureCache::ComputeKey(Data, sizeof(Data), LoadInfo2));
+    }
+
+    // Any change of the contents changes the key
+    for (size_t i = 0; i < sizeof(Data); ++i)
+    {
+        Uint8 Data2[sizeof(Data)];
+        memcpy(Data2, Data, sizeof(Data));
+        Data2[i] ^= 0x10;
+        EXPECT_NE(Key, TextureCache::ComputeKey(Data2, sizeof(Data2), LoadInfo)) << i;
+    }
+    EXPECT_NE(Key, TextureCache::ComputeKey(Data, sizeof(Data) - 1, LoadInfo));
+}
+
+TEST(Tools_TextureLoader, WriteTextureDataToKTX)
+{
+    // Rows of R8 data with odd width are padded to 4 bytes in KTX
+    auto Tex = CreateTestTexture(5, 3, 3, 10);
+
+    RefCntAutoPtr<IDataBlob> pKTXData{MakeNewRCObj<DataBlobImpl>()(0)};
+    WriteTextureDataToKTX(Tex.Desc, Tex.GetData(), pKTXData);
+
+    const auto* pData = reinterpret_cast<const Uint8*>(pKTXData->GetDataPtr());
+
+    static constexpr Uint8 KTX10FileIdentifier[12] = {0xAB, 0x4B, 0x54, 0x58, 0x20, 0x31, 0x31, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A};
+    ASSERT_GE(pKTXData->GetSize(), size_t{12 + 13 * 4});
+    EXPECT_EQ(memcmp(pData, KTX10FileIdentifier, sizeof(KTX10FileIdentifier)), 0);
+
+    Uint32 Header[13];
+    memcpy(Header, pData + 12, sizeof(Header));
+    EXPECT_EQ(Header[0], 0x04030201u);
+    EXPECT_EQ(Header[4], 0x8229u); // GL_R8
+    EXPECT_EQ(Header[6], 5u);
+    EXPECT_EQ(Header[7], 3u);
+    EXPECT_EQ(Header[10], 1u);
+    EXPECT_EQ(Header[11], 3u);
+    EXPECT_EQ(Header[12], 0u);
+
+    const auto* pMip = pData + 12 + sizeof(Header);
+    for (Uint32 m = 0; m < 3; ++m)
+    {
+        const auto MipWidth  = std::max(5u >> m, 1u);
+        const auto MipHeight = std::max(3u >> m, 1u);
+        const auto RowStride = (MipWidth + 3) & ~3u;
+
+        Uint32 ImageSize = 0;
+        memcpy(&ImageSize, pMip, sizeof(ImageSize));
+        EXPECT_EQ(ImageSize, RowStride * MipHeight);
+        pMip += sizeof(ImageSize);
+
+        for (Uint32 row = 0; row < MipHeight; ++row)
+            EXPECT_EQ(memcmp(pMip + row * RowStride, &Tex.Levels[m][row * MipWidth], MipWidth), 0) << "mip " << m << " row " << row;
+        pMip += (ImageSize + 3) & ~3u;
+    }
+    EXPECT_EQ(pMip, pData + pKTXData->GetSize());
+}
+
+TEST(Tools_TextureLoader, TextureCache_StoreFind)
+{
+    TestCacheDirectoryCleaner Cleaner;
+
+    auto       Tex = CreateTestTexture(16, 16, 5, 1);
+    const auto Key = Uint64{0x123456789ABCDEF0ull};
+    Cleaner.Keys.push_back(Key);
+
+    RefCntAutoPtr<IDataBlob> pExpectedKTX{MakeNewRCObj<DataBlobImpl>()(0)};
+    WriteTextureDataToKTX(Tex.Desc, Tex.GetData(), pExpectedKTX);
+
+    {
+        TextureCache::CreateInfo CI;
+        CI.Directory = TestCacheDirectory;
+        TextureCache Cache{CI};
+
+        RefCntAutoPtr<IDataBlob> pKTXData;
+        EXPECT_FALSE(Cache.Find(Key, &pKTXData));
+
+        ASSERT_TRUE(Cache.Store(Key, Tex.Desc, Tex.GetData()));
+        EXPECT_EQ(Cache.GetNumEntries(), 1u);
+        EXPECT_EQ(Cache.GetSize(), pExpectedKTX->GetSize());
+
+        ASSERT_TRUE(Cache.Find(Key, &pKTXData));
+        ASSERT_EQ(pKTXData->GetSize(), pExpectedKTX->GetSize());
+        EXPECT_EQ(memcmp(pKTXData->GetDataPtr(), pExpectedKTX->GetDataPtr(), pKTXData->GetSize()), 0);
+    }
+
+    // The index is persistent
+    {
+        TextureCache::CreateInfo CI;
+        CI.Directory = TestCacheDirectory;
+        TextureCache Cache{CI};
+        EXPECT_EQ(Cache.GetNumEntries(), 1u);
+        EXPECT_EQ(Cache.GetSize(), pExpectedKTX->GetSize());
+
+        RefCntAutoPtr<IDataBlob> pKTXData;
+        EXPECT_TRUE(Cache.Find(Key, &pKTXData));
+    }
+}
+
+TEST(Tools_TextureLoader, TextureCache_LRUEviction)
+{
+    TestCacheDirectoryCleaner Cleaner;
+
+    auto Tex0 = CreateTestTexture(32, 32, 1, 0);
+    auto Tex1 = CreateTestTexture(32, 32, 1, 1);
+    auto Tex2 = CreateTestTexture(32, 32, 1, 2);
+
+    RefCntAutoPtr<IDataBlob> pKTXData{MakeNewRCObj<DataBlobImpl>()(0)};
+    WriteTextureDataToKTX(Tex0.Desc, Tex0.GetData(), pKTXData);
+    const auto FileSize = pKTXData->GetSize();
+
+    const Uint64 Keys[] = {1, 2, 3};
+    Cleaner.Keys.assign(std::begin(Keys), std::end(Keys));
+
+    TextureCache::CreateInfo CI;
+    CI.Directory = TestCacheDirectory;
+    // Room for two files
+    CI.MaxSize = FileSize * 2 + FileSize / 2;
+    TextureCache Cache{CI};
+
+    ASSERT_TRUE(Cache.Store(Keys[0], Tex0.Desc, Tex0.GetData()));
+    ASSERT_TRUE(Cache.Store(Keys[1], Tex1.Desc, Tex1.GetData()));
+
+    // Make entry 0 the most recently used one
+    {
+        RefCntAutoPtr<IDataBlob> pData;
+        EXPECT_TRUE(Cache.Find(Keys[0], &pData));
+    }
+
+    ASSERT_TRUE(Cache.Store(Keys[2], Tex2.Desc, Tex2.GetData()));
+    EXPECT_EQ(Cache.GetNumEntries(), 2u);
+    EXPECT_LE(Cache.GetSize(), CI.MaxSize);
+
+    EXPECT_TRUE(FileSystem::FileExists(Cache.GetFilePath(Keys[0]).c_str()));
+    EXPECT_FALSE(FileSystem::FileExists(Cache.GetFilePath(Keys[1]).c_str()));
+    EXPECT_TRUE(FileSystem::FileExists(Cache.GetFilePath(Keys[2]).c_str()));
+
+    {
+        RefCntAutoPtr<IDataBlob> pData;
+        EXPECT_FALSE(Cache.Find(Keys[1], &pData));
+    }
+
+    // Reducing the limit evicts the least recently used entry
+    Cache.SetMaxSize(FileSize);
+    EXPECT_EQ(Cache.GetNumEntries(), 1u);
+    EXPECT_TRUE(FileSystem::FileExists(Cache.GetFilePath(Keys[2]).c_str()));
+}
+
+} // namespace
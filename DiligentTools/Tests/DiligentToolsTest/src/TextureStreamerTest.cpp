@@ -0,0 +1,260 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+#include "TextureStreamer.hpp"
+
+#include "gtest/gtest.h"
+
+using namespace Diligent;
+
+namespace
+{
+
+TextureDesc GetTestTextureDesc(Uint32 Size, TEXTURE_FORMAT Format = TEX_FORMAT_RGBA8_UNORM)
+{
+    TextureDesc Desc;
+    Desc.Name      = "Streamed texture";
+    Desc.Type      = RESOURCE_DIM_TEX_2D;
+    Desc.Width     = Size;
+    Desc.Height    = Size;
+    Desc.Format    = Format;
+    Desc.MipLevels = 0;
+    return Desc;
+}
+
+// Size of RGBA8 mip levels [FirstMip, ...) of a square texture
+Uint64 GetRGBA8MipChainSize(Uint32 Size, Uint32 FirstMip)
+{
+    Uint64 Bytes = 0;
+    for (auto Dim = Size >> FirstMip; Dim > 0; Dim >>= 1)
+        Bytes += Uint64{Dim} * Dim * 4;
+    return Bytes;
+}
+
+TEST(Tools_TextureLoader, TextureStreamer_ComputeRequiredMip)
+{
+    EXPECT_EQ(TextureStreamer::ComputeRequiredMip(1024, 1024, 11, 2000, 2000), 0u);
+    EXPECT_EQ(TextureStreamer::ComputeRequiredMip(1024, 1024, 11, 1024, 1024), 0u);
+    EXPECT_EQ(TextureStreamer::ComputeRequiredMip(1024, 1024, 11, 512, 512), 1u);
+    EXPECT_EQ(TextureStreamer::ComputeRequiredMip(1024, 1024, 11, 300, 300), 1u);
+    EXPECT_EQ(TextureStreamer::ComputeRequiredMip(1024, 512, 11, 128, 512), 3u);
+    EXPECT_EQ(TextureStreamer::ComputeRequiredMip(1024, 1024, 11, 0.25f, 0.25f), 10u);
+    EXPECT_EQ(TextureStreamer::ComputeRequiredMip(1024, 1024, 0, 0, 0), 10u);
+}
+
+TEST(Tools_TextureLoader, TextureStreamer_TailMips)
+{
+    TextureStreamer::CreateInfo CI;
+    CI.TailMipDimension = 64;
+    TextureStreamer Streamer{CI};
+
+    const auto Id = Streamer.AddSimulatedTexture(GetTestTextureDesc(1024));
+    ASSERT_NE(Id, TextureStreamer::InvalidTextureId);
+    EXPECT_EQ(Streamer.GetFullDesc(Id).MipLevels, 11u);
+    EXPECT_EQ(Streamer.GetResidentMip(Id), 4u);
+    EXPECT_EQ(Streamer.GetTexture(Id), nullptr);
+    EXPECT_EQ(Streamer.GetStatistics().ResidentBytes, GetRGBA8MipChainSize(1024, 4));
+
+    // Level 1 of a 100x100 BC1 texture is not block-aligned, so the whole chain is resident
+    const auto BCId = Streamer.AddSimulatedTexture(GetTestTextureDesc(100, TEX_FORMAT_BC1_UNORM));
+    EXPECT_EQ(Streamer.GetResidentMip(BCId), 0u);
+
+    // Cube maps are not streamed
+    auto CubeDesc      = GetTestTextureDesc(256);
+    CubeDesc.Type      = RESOURCE_DIM_TEX_CUBE;
+    CubeDesc.ArraySize = 6;
+    const auto CubeId  = Streamer.AddSimulatedTexture(CubeDesc);
+    EXPECT_EQ(Streamer.GetResidentMip(CubeId), 0u);
+    EXPECT_EQ(Streamer.GetStatistics().NumTextures, 3u);
+
+    const auto ResidentBytes = Streamer.GetStatistics().ResidentBytes;
+    Streamer.RemoveTexture(CubeId);
+    EXPECT_EQ(Streamer.GetStatistics().ResidentBytes, ResidentBytes - GetRGBA8MipChainSize(256, 0) * 6);
+    EXPECT_EQ(Streamer.GetStatistics().NumTextures, 2u);
+}
+
+TEST(Tools_TextureLoader, TextureStreamer_DemandLoads)
+{
+    TextureStreamer::CreateInfo CI;
+    CI.SimulatedLoadLatency = 2;
+    TextureStreamer Streamer{CI};
+
+    const auto Id = Streamer.AddSimulatedTexture(GetTestTextureDesc(1024));
+
+    // No demand - nothing is loaded
+    Streamer.Update(nullptr);
+    EXPECT_EQ(Streamer.GetResidentMip(Id), 4u);
+    EXPECT_FALSE(Streamer.IsLoading(Id));
+
+    Streamer.ReportScreenSize(Id, 200, 200);
+    Streamer.ReportScreenSize(Id, 400, 400);
+    Streamer.Update(nullptr);
+    EXPECT_TRUE(Streamer.IsLoading(Id));
+    auto Stats = Streamer.GetStatistics();
+    EXPECT_EQ(Stats.NumPendingLoads, 1u);
+    EXPECT_EQ(Stats.PendingBytes, GetRGBA8MipChainSize(1024, 1) - GetRGBA8MipChainSize(1024, 4));
+    EXPECT_EQ(Stats.ResidentBytes, GetRGBA8MipChainSize(1024, 1));
+
+    Streamer.Update(nullptr);
+    EXPECT_TRUE(Streamer.IsLoading(Id));
+    Streamer.Update(nullptr);
+    EXPECT_FALSE(Streamer.IsLoading(Id));
+    EXPECT_EQ(Streamer.GetResidentMip(Id), 1u);
+    Stats = Streamer.GetStatistics();
+    EXPECT_EQ(Stats.NumPendingLoads, 0u);
+    EXPECT_EQ(Stats.PendingBytes, 0u);
+    EXPECT_EQ(Stats.NumLoadsCompleted, 1u);
+    EXPECT_EQ(Stats.ResidentBytes, GetRGBA8MipChainSize(1024, 1));
+
+    // Levels stay resident while the budget allows
+    for (Uint32 i = 0; i < 4; ++i)
+        Streamer.Update(nullptr);
+    EXPECT_EQ(Streamer.GetResidentMip(Id), 1u);
+    EXPECT_EQ(Streamer.GetStatistics().NumEvictedMips, 0u);
+}
+
+TEST(Tools_TextureLoader, TextureStreamer_LRUEviction)
+{
+    const auto TailSize = GetRGBA8MipChainSize(1024, 4);
+    const auto FullSize = GetRGBA8MipChainSize(1024, 0);
+
+    TextureStreamer::CreateInfo CI;
+    CI.Budget = 2 * FullSize + TailSize;
+    TextureStreamer Streamer{CI};
+
+    TextureStreamer::TextureId Ids[3];
+    for (auto& Id : Ids)
+        Id = Streamer.AddSimulatedTexture(GetTestTextureDesc(1024));
+
+    // Load textures 0 and 1, then use texture 1 more recently
+    Streamer.ReportDemand(Ids[0], 0);
+    Streamer.Update(nullptr);
+    Streamer.ReportDemand(Ids[1], 0);
+    Streamer.Update(nullptr);
+    Streamer.ReportDemand(Ids[1], 0);
+    Streamer.Update(nullptr);
+    EXPECT_EQ(Streamer.GetResidentMip(Ids[0]), 0u);
+    EXPECT_EQ(Streamer.GetResidentMip(Ids[1]), 0u);
+    EXPECT_EQ(Streamer.GetStatistics().ResidentBytes, 2 * FullSize + TailSize);
+
+    // Texture 2 evicts the least recently used texture 0
+    Streamer.ReportDemand(Ids[2], 0);
+    Streamer.Update(nullptr);
+    EXPECT_EQ(Streamer.GetResidentMip(Ids[0]), 4u);
+    EXPECT_EQ(Streamer.GetResidentMip(Ids[1]), 0u);
+    EXPECT_TRUE(Streamer.IsLoading(Ids[2]));
+    auto Stats = Streamer.GetStatistics();
+    EXPECT_EQ(Stats.NumEvictedMips, 4u);
+    EXPECT_LE(Stats.ResidentBytes, CI.Budget);
+
+    Streamer.Update(nullptr);
+    EXPECT_EQ(Streamer.GetResidentMip(Ids[2]), 0u);
+
+    // Reducing the budget evicts finest levels first
+    Streamer.SetBudget(FullSize + GetRGBA8MipChainSize(1024, 1) + TailSize);
+    Streamer.Update(nullptr);
+    EXPECT_EQ(Streamer.GetResidentMip(Ids[1]), 1u);
+    EXPECT_EQ(Streamer.GetResidentMip(Ids[2]), 0u);
+    EXPECT_LE(Streamer.GetStatistics().ResidentBytes, Streamer.GetBudget());
+}
+
+TEST(Tools_TextureLoader, TextureStreamer_UsedLevelsAreNotEvicted)
+{
+    const auto TailSize = GetRGBA8MipChainSize(1024, 4);
+
+    TextureStreamer::CreateInfo CI;
+    CI.Budget = GetRGBA8MipChainSize(1024, 0) + GetRGBA8MipChainSize(1024, 2);
+    TextureStreamer Streamer{CI};
+
+    const auto Id0 = Streamer.AddSimulatedTexture(GetTestTextureDesc(1024));
+    const auto Id1 = Streamer.AddSimulatedTexture(GetTestTextureDesc(1024));
+    EXPECT_EQ(Streamer.GetStatistics().ResidentBytes, 2 * TailSize);
+
+    // Texture 0 needs more levels, so it is loaded first. Texture 1 only gets the levels that fit.
+    for (Uint32 i = 0; i < 4; ++i)
+    {
+        Streamer.ReportDemand(Id0, 0);
+        Streamer.ReportDemand(Id1, 1);
+        Streamer.Update(nullptr);
+        EXPECT_LE(Streamer.GetStatistics().ResidentBytes, CI.Budget);
+    }
+    EXPECT_EQ(Streamer.GetResidentMip(Id0), 0u);
+    EXPECT_EQ(Streamer.GetResidentMip(Id1), 2u);
+    EXPECT_EQ(Streamer.GetStatistics().NumEvictedMips, 0u);
+
+    // When texture 0 needs fewer levels, they are evicted for texture 1
+    for (Uint32 i = 0; i < 2; ++i)
+    {
+        Streamer.ReportDemand(Id0, 1);
+        Streamer.ReportDemand(Id1, 1);
+        Streamer.Update(nullptr);
+    }
+    EXPECT_EQ(Streamer.GetResidentMip(Id0), 1u);
+    EXPECT_EQ(Streamer.GetResidentMip(Id1), 1u);
+    EXPECT_EQ(Streamer.GetStatistics().NumEvictedMips, 1u);
+}
+
+TEST(Tools_TextureLoader, TextureStreamer_MaxLoadBytesPerUpdate)
+{
+    TextureStreamer::CreateInfo CI;
+    CI.MaxLoadBytesPerUpdate = GetRGBA8MipChainSize(1024, 1);
+    TextureStreamer Streamer{CI};
+
+    const auto Id0 = Streamer.AddSimulatedTexture(GetTestTextureDesc(1024));
+    const auto Id1 = Streamer.AddSimulatedTexture(GetTestTextureDesc(1024));
+    const auto Id2 = Streamer.AddSimulatedTexture(GetTestTextureDesc(1024));
+
+    auto ReportDemand = [&]() {
+        Streamer.ReportDemand(Id0, 0);
+        Streamer.ReportDemand(Id1, 1);
+        Streamer.ReportDemand(Id2, 0);
+    };
+
+    // The first load exceeds the limit, but is started anyway. Nothing else fits.
+    ReportDemand();
+    Streamer.Update(nullptr);
+    EXPECT_TRUE(Streamer.IsLoading(Id0));
+    EXPECT_FALSE(Streamer.IsLoading(Id1));
+    EXPECT_FALSE(Streamer.IsLoading(Id2));
+
+    ReportDemand();
+    Streamer.Update(nullptr);
+    EXPECT_EQ(Streamer.GetResidentMip(Id0), 0u);
+    EXPECT_FALSE(Streamer.IsLoading(Id1));
+    EXPECT_TRUE(Streamer.IsLoading(Id2));
+
+    ReportDemand();
+    Streamer.Update(nullptr);
+    EXPECT_EQ(Streamer.GetResidentMip(Id2), 0u);
+    EXPECT_TRUE(Streamer.IsLoading(Id1));
+    EXPECT_LE(Streamer.GetStatistics().PendingBytes, CI.MaxLoadBytesPerUpdate);
+
+    ReportDemand();
+    Streamer.Update(nullptr);
+    EXPECT_EQ(Streamer.GetResidentMip(Id1), 1u);
+}
+
+} // namespace
@@ -47,6 +47,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include "RenderDevice.h"
 #include "Texture.h"
 
@@ -73,3 +75,12 @@ void CreateDDSTextureFromMemoryEx(
     Diligent::ITexture**         texture /*,
     D2D1_ALPHA_MODE* alphaMode*/
 );
+
+/// Parses DDS data and returns the texture description and subresources that reference ddsData
+void GetDDSTextureData(
+    const Diligent::Uint8*                    ddsData,
+    size_t                                    ddsDataSize,
+    size_t                                    maxsize,
+    bool                                      forceSRGB,
+    Diligent::TextureDesc&                    desc,
+    std::vector<Diligent::TextureSubResData>& subResources);
@@ -79,6 +79,39 @@ DECODE_PNG_RESULT DILIGENT_GLOBAL_FUNCTION(DecodePng)(IDataBlob* pSrcPngBits,
                                                       IDataBlob* pDstPixels,
                                                       ImageDesc* pDstImgDesc);
 
+/// PNG decoder that decodes the image row by row.
+struct PNGRowDecoder;
+typedef struct PNGRowDecoder PNGRowDecoder;
+
+/// Creates a PNG row decoder and reads the image header.
+
+/// \param [in]  pSrcPngBits - PNG image encoded bits. The data must stay alive until the decoder is destroyed.
+/// \param [out] pDstImgDesc - Image description. RowStride is the size of the tightly packed row aligned to 4 bytes.
+/// \param [out] ppDecoder   - Memory location where pointer to the decoder is written.
+///                            The decoder must be destroyed with DestroyPngRowDecoder().
+/// \return                    Decoding result, see Diligent::DECODE_PNG_RESULT.
+DECODE_PNG_RESULT DILIGENT_GLOBAL_FUNCTION(CreatePngRowDecoder)(IDataBlob*      pSrcPngBits,
+                                                                ImageDesc*      pDstImgDesc,
+                                                                PNGRowDecoder** ppDecoder);
+
+/// Decodes the next rows of the image.
+
+/// \param [in]  pDecoder  - PNG row decoder.
+/// \param [out] pDstRows  - Destination memory for NumRows rows. The pixels are tightly packed.
+/// \param [in]  DstStride - Destination row stride, in bytes.
+/// \param [in]  NumRows   - The number of rows to decode.
+/// \return                  Decoding result, see Diligent::DECODE_PNG_RESULT.
+///
+/// \remarks    Interlaced images can't be decoded row by row, so the whole image is decoded into
+///             an internal buffer by the first call.
+DECODE_PNG_RESULT DILIGENT_GLOBAL_FUNCTION(DecodePngRows)(PNGRowDecoder* pDecoder,
+                                                          Uint8*         pDstRows,
+                                                          Uint32         DstStride,
+                                                          Uint32         NumRows);
+
+/// Destroys the PNG row decoder.
+void DILIGENT_GLOBAL_FUNCTION(DestroyPngRowDecoder)(PNGRowDecoder* pDecoder);
+
 /// Encodes an image into PNG format.
 
 /// \param [in] pSrcPixels    - Source pixels. The pixels must be tightly packed
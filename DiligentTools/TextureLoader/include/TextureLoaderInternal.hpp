@@ -0,0 +1,77 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "TextureLoader.h"
+#include "Image.h"
+
+namespace Diligent
+{
+
+/// Texture description and initial data computed on the CPU
+struct PreparedTextureData
+{
+    TextureDesc Desc;
+
+    /// Subresources of all mip levels. Level 0 may reference the source image data.
+    std::vector<TextureSubResData> SubResources;
+
+    /// Storage of the levels computed on the CPU
+    std::vector<Uint8> MipArena;
+    std::vector<Uint8> CompressedArena;
+
+    /// False if the mip levels are left to be generated on the GPU and
+    /// the subresources do not contain the final texture data.
+    bool AllLevelsOnCPU = true;
+};
+
+/// Returns the format of the texture created from the image: TexLoadInfo.Format if it is
+/// compatible with the image, or the format deduced from the image description.
+/// Throws an exception if the image can't be stored in a texture of the requested format.
+TEXTURE_FORMAT GetImageTextureFormat(const ImageDesc& ImgDesc, const TextureLoadInfo& TexLoadInfo);
+
+/// Computes the texture description and all levels that CreateTextureFromImage() uploads
+void PrepareTextureFromImage(Image*                 pSrcImage,
+                             const TextureLoadInfo& TexLoadInfo,
+                             IRenderDevice*         pDevice,
+                             PreparedTextureData&   Data);
+
+/// Maps the file into memory when the platform supports it, and reads the file otherwise.
+/// Returns false if the file can't be opened.
+bool ReadFileData(const Char* FilePath, IDataBlob** ppFileData);
+
+/// Parses KTX data and returns the texture description and subresources that reference the data
+void GetKTXTextureData(const Uint8*                    pKTXData,
+                       size_t                          DataSize,
+                       const TextureLoadInfo&          TexLoadInfo,
+                       TextureDesc&                    TexDesc,
+                       std::vector<TextureSubResData>& SubresData);
+
+} // namespace Diligent
@@ -0,0 +1,89 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+/// \file
+/// CPU block compression encoder
+
+#include "../../../DiligentCore/Primitives/interface/BasicTypes.h"
+#include "../../../DiligentCore/Graphics/GraphicsEngine/interface/GraphicsTypes.h"
+#include "TextureLoader.h"
+
+namespace Diligent
+{
+
+class ThreadPool;
+
+/// Attributes of the EncodeBC() function
+struct EncodeBCAttribs
+{
+    /// Block-compressed format: one of BC1, BC3, BC4, BC5 or BC7 UNORM/UNORM_SRGB formats.
+    TEXTURE_FORMAT Format = TEX_FORMAT_UNKNOWN;
+
+    /// Compression quality.
+    TEXTURE_COMPRESS_QUALITY Quality = TEXTURE_COMPRESS_QUALITY_NORMAL;
+
+    /// Source image with 8-bit channels. Missing green and blue channels are read as 0,
+    /// missing alpha channel is read as 255.
+    const void* pSrcData       = nullptr;
+    Uint32      SrcStride      = 0;
+    Uint32      NumSrcChannels = 0;
+    Uint32      Width          = 0;
+    Uint32      Height         = 0;
+
+    /// Destination buffer and the distance in bytes between rows of blocks.
+    /// The buffer must hold (Height + 3) / 4 rows of blocks.
+    void*  pDstData  = nullptr;
+    Uint32 DstStride = 0;
+};
+
+/// Encodes the image into the block-compressed format.
+
+/// \param [in] Attribs - Encoding attributes.
+/// \param [in] pPool   - Optional thread pool. When not null, rows of blocks are
+///                       encoded in parallel.
+///
+/// \remarks    BC1 blocks are always encoded in four-color mode, so alpha is ignored.
+///             BC3 alpha and BC4/BC5 channels use eight-value mode. BC7 blocks are encoded
+///             in mode 6 (single subset with RGBA endpoints).
+///             Partial blocks at the right and bottom edges replicate the edge pixels.
+void EncodeBC(const EncodeBCAttribs& Attribs, ThreadPool* pPool = nullptr);
+
+/// Returns true if EncodeBC() supports the format.
+bool IsBCEncoderFormatSupported(TEXTURE_FORMAT Format);
+
+/// Encodes a BC1 block from 16 RGBA8 pixels stored in row-major order.
+void EncodeBC1Block(const Uint8 RGBA[64], TEXTURE_COMPRESS_QUALITY Quality, void* pDstBlock);
+
+/// Encodes a BC4 block from 16 values read with the given stride in bytes.
+void EncodeBC4Block(const Uint8* pValues, Uint32 ValueStride, TEXTURE_COMPRESS_QUALITY Quality, void* pDstBlock);
+
+/// Encodes a BC7 block from 16 RGBA8 pixels stored in row-major order.
+void EncodeBC7Block(const Uint8 RGBA[64], TEXTURE_COMPRESS_QUALITY Quality, void* pDstBlock);
+
+} // namespace Diligent
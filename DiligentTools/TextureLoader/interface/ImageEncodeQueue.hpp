@@ -0,0 +1,148 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+#pragma once
+
+/// \file
+/// Image encoding on worker threads
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+
+#include "Image.h"
+
+namespace Diligent
+{
+
+class ThreadPool;
+
+/// Encodes images into PNG or JPEG files on worker threads.
+
+/// Enqueue() copies the pixels and returns, so that the caller (normally, the render thread) can
+/// immediately unmap and reuse the source memory. Worker threads of the thread pool then convert the
+/// pixels and encode them with Image::Encode(), and pass the encoded data to the callback.
+///
+/// At most CreateInfo::MaxImagesInFlight images are queued or being encoded at any time. When the
+/// limit is reached, Enqueue() waits until a worker thread finishes an image and TryEnqueue() fails.
+/// This bounds the memory used by the queue when the images are produced faster than they are encoded.
+///
+/// \remarks    Callbacks are executed on worker threads and may be called in any order.
+class ImageEncodeQueue
+{
+public:
+    struct CreateInfo
+    {
+        /// Thread pool that encodes the images. If null, ThreadPool::GetShared() is used.
+        ThreadPool* pThreadPool = nullptr;
+
+        /// Maximum number of images that are queued or being encoded. Zero means twice the number of worker threads of the pool.
+        Uint32 MaxImagesInFlight = 0;
+    };
+
+    /// Callback that receives the encoded image. pEncodedData is null if the image could not be encoded.
+    using CallbackType = std::function<void(IDataBlob* pEncodedData)>;
+
+    struct Statistics
+    {
+        /// The number of images that are queued or being encoded
+        Uint32 NumImagesInFlight = 0;
+
+        Uint64 NumImagesEncoded = 0;
+
+        /// The number of images that could not be encoded
+        Uint64 NumFailures = 0;
+
+        /// The number of times Enqueue() had to wait for a free slot
+        Uint64 NumStalls = 0;
+
+        /// Total time Enqueue() spent waiting for a free slot, in seconds
+        double StallTime = 0;
+    };
+
+    explicit ImageEncodeQueue(const CreateInfo& CI);
+
+    /// Waits until all enqueued images are encoded.
+    ~ImageEncodeQueue();
+
+    // clang-format off
+    ImageEncodeQueue           (const ImageEncodeQueue&) = delete;
+    ImageEncodeQueue& operator=(const ImageEncodeQueue&) = delete;
+    // clang-format on
+
+    /// Enqueues the image. If the number of images in flight has reached the limit,
+    /// waits until a worker thread finishes an image.
+
+    /// \param [in] Info     - Image encoding parameters. Pixel data is copied before the method returns.
+    /// \param [in] Callback - Callback that is called by a worker thread when the image is encoded.
+    ///
+    /// \return     false if the image format is not supported.
+    bool Enqueue(const Image::EncodeInfo& Info, CallbackType Callback);
+
+    /// Enqueues the image if the number of images in flight is below the limit, and returns false otherwise.
+    bool TryEnqueue(const Image::EncodeInfo& Info, CallbackType Callback);
+
+    /// Waits until all enqueued images are encoded and their callbacks have returned.
+    void WaitForIdle();
+
+    Uint32 GetMaxImagesInFlight() const { return m_MaxImagesInFlight; }
+
+    Statistics GetStatistics() const;
+
+private:
+    struct EncodeJob
+    {
+        Image::EncodeInfo  Info;
+        std::vector<Uint8> Pixels;
+        CallbackType       Callback;
+    };
+
+    bool EnqueueImpl(const Image::EncodeInfo& Info, CallbackType Callback, bool Wait);
+
+    // Encodes the oldest queued image. Executed by the thread pool once for every enqueued image.
+    void EncodeNextImage();
+
+    ThreadPool& m_ThreadPool;
+
+    Uint32 m_MaxImagesInFlight;
+
+    mutable std::mutex m_Mtx;
+    // Signaled when an image is finished
+    std::condition_variable m_SlotCondVar;
+
+    std::deque<std::unique_ptr<EncodeJob>> m_QueuedJobs;
+
+    // Pixel buffers of finished jobs that are reused by new jobs
+    std::vector<std::vector<Uint8>> m_FreeBuffers;
+
+    Uint32     m_NumImagesInFlight = 0;
+    Statistics m_Stats;
+};
+
+} // namespace Diligent
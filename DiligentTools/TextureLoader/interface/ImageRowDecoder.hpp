@@ -0,0 +1,154 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+#pragma once
+
+/// \file
+/// Row-by-row decoding of PNG and TIFF images
+
+#include <memory>
+
+#include "../../../DiligentCore/Common/interface/RefCntAutoPtr.hpp"
+#include "../../../DiligentCore/Graphics/GraphicsTools/interface/TextureUploader.hpp"
+#include "Image.h"
+#include "TextureLoader.h"
+
+namespace Diligent
+{
+
+class ThreadPool;
+
+/// Decodes PNG and TIFF images row by row.
+
+/// Large images can be processed in bands of rows without decoding the whole image into memory,
+/// see DecodeImageMipChain() and CreateTextureFromImageRows(). TIFF data is accessed through
+/// libtiff file mapping, so uncompressed strips are copied straight from the data blob, which
+/// itself is a memory-mapped file when the decoder is created by CreateFromFile().
+class ImageRowDecoder
+{
+public:
+    /// Creates a decoder for PNG or TIFF data.
+
+    /// \param [in] pFileData - Encoded image data. The decoder keeps a strong reference to the data blob.
+    /// \param [in] Format    - Image file format. When IMAGE_FILE_FORMAT_UNKNOWN, the format is detected from the data.
+    /// \return                 The decoder, or null if the data is not a PNG or TIFF image or the image header
+    ///                         can't be read.
+    static std::unique_ptr<ImageRowDecoder> Create(IDataBlob* pFileData, IMAGE_FILE_FORMAT Format = IMAGE_FILE_FORMAT_UNKNOWN);
+
+    /// Creates a decoder for a PNG or TIFF file. The file is mapped into memory when the platform supports it.
+    static std::unique_ptr<ImageRowDecoder> CreateFromFile(const Char* FilePath);
+
+    virtual ~ImageRowDecoder() {}
+
+    /// Returns the image description. RowStride is the size of a decoded row aligned to 4 bytes.
+    const ImageDesc& GetDesc() const { return m_Desc; }
+
+    /// Returns the index of the next row to decode.
+    Uint32 GetNextRow() const { return m_NextRow; }
+
+    /// Returns true if an error occurred while decoding the rows.
+    bool HasFailed() const { return m_Failed; }
+
+    /// Decodes the next rows.
+
+    /// \param [out] pDstRows  - Destination memory. The pixels are tightly packed.
+    /// \param [in]  DstStride - Destination row stride, in bytes.
+    /// \param [in]  NumRows   - The number of rows to decode. The value is clamped to the number of remaining rows.
+    /// \return                  The number of decoded rows, which is zero after the last row and after an error.
+    Uint32 DecodeRows(void* pDstRows, Uint32 DstStride, Uint32 NumRows);
+
+protected:
+    /// Decodes NumRows rows starting at GetNextRow(). Returns false if an error occurred.
+    virtual bool DecodeRowsImpl(Uint8* pDstRows, Uint32 DstStride, Uint32 NumRows) = 0;
+
+    ImageDesc m_Desc;
+
+private:
+    Uint32 m_NextRow = 0;
+    bool   m_Failed  = false;
+};
+
+
+/// Attributes of the DecodeImageMipChain() function
+struct DecodeImageMipChainAttribs
+{
+    /// Destination memory of every level. Rows of three-channel images are expanded to four channels.
+    const MappedTextureSubresource* pDstMips = nullptr;
+
+    /// The number of levels in pDstMips.
+    Uint32 MipLevels = 1;
+
+    /// Whether coarse levels are computed. When false, coarse levels are filled with zeros.
+    bool GenerateMips = true;
+
+    /// Whether color channels of 8-bit three- and four-channel images are sRGB-encoded.
+    bool IsSRGB = false;
+
+    /// Filter that computes coarse levels.
+    MIP_FILTER MipFilter = MIP_FILTER_BOX;
+
+    /// Alpha test threshold, see TextureLoadInfo::AlphaCutoff.
+    float AlphaCutoff = 0;
+
+    /// The number of level 0 rows that are decoded at a time.
+    Uint32 RowsPerBand = 64;
+
+    /// Thread pool that computes coarse levels of large bands in parallel. May be null.
+    ThreadPool* pThreadPool = nullptr;
+};
+
+/// Decodes the remaining rows of the image band by band and writes all mip levels to the destination memory.
+
+/// Besides the destination memory, only one band of decoded rows and one band of every coarse level
+/// are stored. The levels are identical to the levels that CreateTextureFromImage() computes.
+/// Kaiser and Lanczos filters and alpha coverage preservation need complete levels, so in this case
+/// coarse levels are computed by ComputeMipChain() from the destination memory after all rows are decoded.
+/// \return     true if all rows have been decoded, and false otherwise.
+bool DecodeImageMipChain(ImageRowDecoder& Decoder, const DecodeImageMipChainAttribs& Attribs);
+
+/// Creates a texture from an image that is decoded row by row.
+
+/// \param [in]  Decoder     - Image decoder. No rows must have been decoded.
+/// \param [in]  TexLoadInfo - Texture loading information. Mip levels are always computed on the CPU, and
+///                            block compression is not supported. USAGE_IMMUTABLE is replaced with USAGE_DEFAULT.
+/// \param [in]  pDevice     - Render device that will be used to create the texture.
+/// \param [in]  pContext    - Device context when the function is called by the render thread, or null when
+///                            it is called by a worker thread, see ITextureUploader::AllocateUploadBuffer().
+/// \param [in]  pUploader   - Texture uploader. When null, a temporary uploader is created, and pContext
+///                            must not be null.
+/// \param [out] ppTexture   - Memory location where pointer to the created texture will be stored.
+///
+/// \remarks    The rows are decoded in bands, and all levels are written directly to an upload buffer,
+///             so that the memory used by the function, besides the upload buffer, does not depend on
+///             the image height.
+void CreateTextureFromImageRows(ImageRowDecoder&       Decoder,
+                                const TextureLoadInfo& TexLoadInfo,
+                                IRenderDevice*         pDevice,
+                                IDeviceContext*        pContext,
+                                ITextureUploader*      pUploader,
+                                ITexture**             ppTexture);
+
+} // namespace Diligent
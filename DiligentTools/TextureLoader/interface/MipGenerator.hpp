@@ -0,0 +1,240 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+/// \file
+/// Mip level generation
+
+#include <functional>
+#include <vector>
+
+#include "../../../DiligentCore/Primitives/interface/BasicTypes.h"
+#include "../../../DiligentCore/Graphics/GraphicsEngine/interface/GraphicsTypes.h"
+#include "../../../DiligentCore/Graphics/GraphicsEngine/interface/Texture.h"
+#include "TextureLoader.h"
+
+namespace Diligent
+{
+
+class ThreadPool;
+
+/// Attributes of the ComputeCoarseMip() function
+struct ComputeCoarseMipAttribs
+{
+    /// Channel type, VT_UINT8 or VT_UINT16.
+    VALUE_TYPE ComponentType = VT_UINT8;
+
+    /// The number of channels in a pixel.
+    Uint32 NumChannels = 0;
+
+    /// Whether color channels are sRGB-encoded. Only 8-bit channels may be sRGB-encoded.
+    /// The fourth channel is treated as linear alpha.
+    bool IsSRGB = false;
+
+    const void* pFineMipData  = nullptr;
+    Uint32      FineMipStride = 0;
+    Uint32      FineMipWidth  = 0;
+    Uint32      FineMipHeight = 0;
+
+    void*  pCoarseMipData  = nullptr;
+    Uint32 CoarseMipStride = 0;
+    Uint32 CoarseMipWidth  = 0;
+    Uint32 CoarseMipHeight = 0;
+
+    /// Downsampling filter.
+    MIP_FILTER Filter = MIP_FILTER_BOX;
+};
+
+/// Computes the coarse mip level from the fine mip level.
+
+/// \remarks    The box filter averages 2x2 blocks of the fine level. Linear 8- and 16-bit images with 1, 2
+///             and 4 channels are processed with SSE2 instructions when they are available. sRGB images
+///             are averaged in linear space using look-up tables.
+///
+///             Kaiser and Lanczos filters are applied as separable 12-tap kernels: rows of the fine level
+///             are filtered horizontally into a ring of 12 rows, which is then filtered vertically. Pixels
+///             outside of the fine level are clamped to the edge. Four-channel rows and the vertical pass
+///             are processed with SSE2 instructions. sRGB channels are filtered in linear space.
+void ComputeCoarseMip(const ComputeCoarseMipAttribs& Attribs);
+
+/// Computes the coarse mip level on the thread pool.
+
+/// Large levels are split into bands of rows that are processed in parallel by ComputeCoarseMip().
+/// Small levels are processed by the calling thread.
+void ComputeCoarseMipParallel(const ComputeCoarseMipAttribs& Attribs, ThreadPool& Pool);
+
+/// Returns the number of rows in one band of a parallel loop over image rows with the given stride.
+Uint32 GetParallelMipRowsPerBand(Uint32 RowStride);
+
+/// Scalar reference implementation of ComputeCoarseMip() that computes sRGB conversions
+/// with floating-point math.
+void ComputeCoarseMipRef(const ComputeCoarseMipAttribs& Attribs);
+
+
+/// Attributes of the alpha coverage functions
+struct AlphaCoverageAttribs
+{
+    /// Channel type, VT_UINT8 or VT_UINT16.
+    VALUE_TYPE ComponentType = VT_UINT8;
+
+    /// The number of channels in a pixel. Alpha is the last channel.
+    Uint32 NumChannels = 4;
+
+    void*  pData  = nullptr;
+    Uint32 Stride = 0;
+    Uint32 Width  = 0;
+    Uint32 Height = 0;
+
+    /// Alpha test threshold, in [0, 1] range. A pixel passes the test when its alpha is not less than the threshold.
+    float AlphaCutoff = 0.5f;
+};
+
+/// Returns the fraction of pixels that pass the alpha test.
+float ComputeAlphaCoverage(const AlphaCoverageAttribs& Attribs);
+
+/// Scales alpha of all pixels so that the fraction of pixels that pass the alpha test is as close
+/// as possible to TargetCoverage, and returns the scale.
+float ScaleAlphaToCoverage(const AlphaCoverageAttribs& Attribs, float TargetCoverage);
+
+
+/// Attributes of the ComputeMipChain() function
+struct ComputeMipChainAttribs
+{
+    /// Channel type, VT_UINT8 or VT_UINT16.
+    VALUE_TYPE ComponentType = VT_UINT8;
+
+    /// The number of channels in a pixel.
+    Uint32 NumChannels = 0;
+
+    /// Whether color channels are sRGB-encoded, see ComputeCoarseMipAttribs::IsSRGB.
+    bool IsSRGB = false;
+
+    /// Downsampling filter.
+    MIP_FILTER Filter = MIP_FILTER_BOX;
+
+    /// Alpha test threshold, see TextureLoadInfo::AlphaCutoff. Only used for four-channel images.
+    float AlphaCutoff = 0;
+
+    /// Dimensions of level 0.
+    Uint32 Width  = 0;
+    Uint32 Height = 0;
+
+    /// Memory of every level. Level 0 is the source image, all coarser levels are written.
+    const MappedTextureSubresource* pMips = nullptr;
+
+    /// The number of levels in pMips.
+    Uint32 MipLevels = 0;
+
+    /// Thread pool that computes large levels in parallel. When null, the levels are
+    /// computed by the calling thread.
+    ThreadPool* pThreadPool = nullptr;
+};
+
+/// Computes all coarse mip levels from level 0, every level from the previous one.
+
+/// When alpha coverage is preserved, alpha of every coarse level is scaled with ScaleAlphaToCoverage()
+/// to match the coverage of level 0 before the next level is computed from it.
+void ComputeMipChain(const ComputeMipChainAttribs& Attribs);
+
+/// Generates mip levels of an image whose finest level arrives in bands of rows.
+
+/// Rows of every coarse level are computed by ComputeCoarseMip() with the box filter as soon as
+/// the finer rows they depend on have been added, so only the current band of every level is stored.
+/// The results are identical to computing every level from the complete finer level.
+class StreamingMipGenerator
+{
+public:
+    struct CreateInfo
+    {
+        /// Channel type, VT_UINT8 or VT_UINT16.
+        VALUE_TYPE ComponentType = VT_UINT8;
+
+        /// The number of channels in a pixel.
+        Uint32 NumChannels = 0;
+
+        /// Whether color channels are sRGB-encoded, see ComputeCoarseMipAttribs::IsSRGB.
+        bool IsSRGB = false;
+
+        /// Dimensions of level 0.
+        Uint32 Width  = 0;
+        Uint32 Height = 0;
+
+        /// The number of levels including level 0. Zero means the full mip chain.
+        Uint32 MipLevels = 0;
+
+        /// Thread pool that computes large bands in parallel. When null, the levels are
+        /// computed by the calling thread.
+        ThreadPool* pThreadPool = nullptr;
+    };
+
+    /// Receives rows [FirstRow, FirstRow + NumRows) of the level. The data is only valid during the call.
+    using RowsHandlerType = std::function<void(Uint32 Mip, Uint32 FirstRow, Uint32 NumRows, const void* pData, Uint32 Stride)>;
+
+    StreamingMipGenerator(const CreateInfo& CI, RowsHandlerType Handler);
+
+    /// Adds the next rows of level 0.
+
+    /// The rows are passed to the handler, followed by the rows of coarser levels that can be computed.
+    /// The last row of an odd-height level is not used by the coarser level, as in ComputeCoarseMip().
+    void AddRows(const void* pData, Uint32 Stride, Uint32 NumRows);
+
+    /// Returns the number of level 0 rows that have been added.
+    Uint32 GetNumAddedRows() const { return m_Levels[0].NumRows; }
+
+    Uint32 GetMipLevels() const { return static_cast<Uint32>(m_Levels.size()); }
+
+    /// Returns the size of the memory that stores intermediate rows, in bytes.
+    size_t GetScratchMemorySize() const;
+
+private:
+    void ProcessRows(Uint32 Mip, const Uint8* pData, Uint32 Stride, Uint32 NumRows);
+
+    struct MipLevel
+    {
+        Uint32 Width     = 0;
+        Uint32 Height    = 0;
+        Uint32 RowSize   = 0;
+        Uint32 RowStride = 0;
+
+        /// The number of rows received so far
+        Uint32 NumRows = 0;
+
+        /// Even row that waits for its odd pair, followed by space for the pair
+        std::vector<Uint8> PendingRows;
+        bool               HasPendingRow = false;
+
+        /// Rows of the next level computed from the current band
+        std::vector<Uint8> CoarseRows;
+    };
+
+    const CreateInfo      m_CI;
+    const RowsHandlerType m_Handler;
+    std::vector<MipLevel> m_Levels;
+};
+
+} // namespace Diligent
@@ -0,0 +1,75 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+#pragma once
+
+/// \file
+/// Pixel format conversion kernels
+
+#include <cstddef>
+
+#include "../../../DiligentCore/Primitives/interface/BasicTypes.h"
+
+namespace Diligent
+{
+
+/// Expands 8-bit RGB pixels to RGBA and sets alpha to 255.
+void ExpandRGB8ToRGBA8(const Uint8* pSrc, Uint8* pDst, size_t NumPixels);
+
+/// Expands 16-bit RGB pixels to RGBA and sets alpha to 65535.
+void ExpandRGB16ToRGBA16(const Uint16* pSrc, Uint16* pDst, size_t NumPixels);
+
+/// Expands 8-bit gray pixels to RGBA: red, green and blue are set to the gray value, and alpha is set to 255.
+void ExpandGray8ToRGBA8(const Uint8* pSrc, Uint8* pDst, size_t NumPixels);
+
+/// Swaps red and blue channels of 8-bit four-channel pixels, which converts BGRA to RGBA and vice versa.
+/// pSrc and pDst may point to the same memory.
+void SwapRB8(const Uint8* pSrc, Uint8* pDst, size_t NumPixels);
+
+/// Drops alpha channel of 8-bit four-channel pixels. If SwapRB is true, red and blue channels
+/// are swapped, which converts BGRA to RGB.
+void PackRGBA8ToRGB8(const Uint8* pSrc, Uint8* pDst, size_t NumPixels, bool SwapRB);
+
+/// Converts 32-bit floating-point values to 16-bit half-precision values with round-to-nearest-even.
+/// Values that are too large become infinities, and NaNs stay NaNs.
+void ConvertFloatToHalf(const float* pSrc, Uint16* pDst, size_t NumValues);
+
+/// Returns the name of the instruction set that the kernels above use on this CPU.
+
+/// \remarks    The instruction set is selected at run time when a kernel is called for the first time:
+///             shuffles use SSSE3 and half-precision conversion uses F16C when the CPU supports them.
+///             Other CPUs use the scalar reference implementations.
+const char* GetPixelConversionISA();
+
+/// Scalar reference implementations of the kernels.
+void ExpandRGB8ToRGBA8Ref(const Uint8* pSrc, Uint8* pDst, size_t NumPixels);
+void ExpandRGB16ToRGBA16Ref(const Uint16* pSrc, Uint16* pDst, size_t NumPixels);
+void ExpandGray8ToRGBA8Ref(const Uint8* pSrc, Uint8* pDst, size_t NumPixels);
+void SwapRB8Ref(const Uint8* pSrc, Uint8* pDst, size_t NumPixels);
+void PackRGBA8ToRGB8Ref(const Uint8* pSrc, Uint8* pDst, size_t NumPixels, bool SwapRB);
+void ConvertFloatToHalfRef(const float* pSrc, Uint16* pDst, size_t NumValues);
+
+} // namespace Diligent
@@ -0,0 +1,118 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+/// \file
+/// On-disk cache of texture data
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "TextureLoader.h"
+
+namespace Diligent
+{
+
+/// Content-addressed on-disk cache of texture data.
+
+/// Textures are stored as KTX files named by a 64-bit key that is computed from the
+/// source file contents and the loading parameters, so a modified file never hits a stale entry.
+/// The cache keeps an index of file sizes and last use order in the cache directory and deletes
+/// least recently used files when the total size exceeds the limit.
+///
+/// \remarks    All methods are thread-safe. The cache directory must not be used by several
+///             processes at the same time.
+class TextureCache
+{
+public:
+    struct CreateInfo
+    {
+        /// Cache directory. It is created if it does not exist.
+        const Char* Directory = nullptr;
+
+        /// Maximum total size of the cache files, in bytes. Zero means no limit.
+        Uint64 MaxSize = 0;
+    };
+
+    explicit TextureCache(const CreateInfo& CI);
+
+    // clang-format off
+    TextureCache           (const TextureCache&)  = delete;
+    TextureCache           (      TextureCache&&) = delete;
+    TextureCache& operator=(const TextureCache&)  = delete;
+    TextureCache& operator=(      TextureCache&&) = delete;
+    // clang-format on
+
+    /// Computes the cache key from the source file contents and the members of TextureLoadInfo
+    /// that affect texture data (MipLevels, IsSRGB, GenerateMips, Format, CompressedFormat and
+    /// CompressQuality).
+    static Uint64 ComputeKey(const void* pData, size_t Size, const TextureLoadInfo& TexLoadInfo);
+
+    /// Reads KTX data of the entry and marks the entry as most recently used.
+    /// Returns false if the entry is not in the cache.
+    bool Find(Uint64 Key, IDataBlob** ppKTXData);
+
+    /// Writes the texture data to the cache as a KTX file and deletes least recently used
+    /// files if the size limit is exceeded. Returns false if the data could not be written.
+    bool Store(Uint64 Key, const TextureDesc& TexDesc, const TextureData& TexData);
+
+    void SetMaxSize(Uint64 MaxSize);
+
+    /// Returns the total size of the cache files, in bytes
+    Uint64 GetSize() const;
+
+    Uint32 GetNumEntries() const;
+
+    /// Returns the path of the cache file for the key
+    std::string GetFilePath(Uint64 Key) const;
+
+private:
+    void LoadIndex();
+    void SaveIndex() const;
+    void AddEntry(Uint64 Key, Uint64 Size);
+    void RemoveEntry(Uint64 Key);
+    void EvictEntries(Uint64 KeepKey);
+
+    struct Entry
+    {
+        Uint64 Size    = 0;
+        Uint64 LastUse = 0;
+    };
+
+    const std::string m_Directory;
+
+    mutable std::mutex                m_Mtx;
+    std::unordered_map<Uint64, Entry> m_Entries;
+
+    Uint64 m_MaxSize    = 0;
+    Uint64 m_TotalSize  = 0;
+    Uint64 m_UseCounter = 0;
+};
+
+} // namespace Diligent
@@ -35,6 +35,31 @@ DILIGENT_BEGIN_NAMESPACE(Diligent)
 
 struct Image;
 
+/// Quality of texture block compression
+DILIGENT_TYPED_ENUM(TEXTURE_COMPRESS_QUALITY, Uint8){
+    /// Fastest compression: block endpoints are taken from the bounding box of block colors
+    TEXTURE_COMPRESS_QUALITY_FAST = 0,
+
+    /// Block endpoints are fitted along the principal axis of block colors and refined once
+    TEXTURE_COMPRESS_QUALITY_NORMAL,
+
+    /// Slowest compression: endpoints are refined several times, and all BC7 p-bit combinations are tried
+    TEXTURE_COMPRESS_QUALITY_HIGH};
+
+/// Filter that computes coarse mip levels on the CPU
+DILIGENT_TYPED_ENUM(MIP_FILTER, Uint8){
+    /// Averages 2x2 blocks of the finer level. This is the fastest filter, but it causes aliasing.
+    MIP_FILTER_BOX = 0,
+
+    /// Kaiser-windowed sinc filter (alpha = 4) with a radius of three coarse pixels.
+    /// Produces sharp levels with little ringing.
+    MIP_FILTER_KAISER,
+
+    /// Lanczos filter with three lobes. Sharper than the Kaiser filter, but causes more ringing.
+    MIP_FILTER_LANCZOS,
+
+    MIP_FILTER_COUNT};
+
 // clang-format off
 /// Texture loading information
 struct TextureLoadInfo
@@ -63,6 +88,45 @@ struct TextureLoadInfo
     /// Texture format
     TEXTURE_FORMAT Format               DEFAULT_VALUE(TEX_FORMAT_UNKNOWN);
 
+    /// Flag indicating that lower mip levels of images should be generated by the GPU
+    /// when the device can generate mips for the texture format.
+    /// The texture is then created with MISC_TEXTURE_FLAG_GENERATE_MIPS flag, BIND_RENDER_TARGET
+    /// bind flag and USAGE_DEFAULT usage in place of USAGE_IMMUTABLE, and the application must call
+    /// IDeviceContext::GenerateMips() for its shader resource view before using the texture.
+    Bool GenerateMipsOnGPU              DEFAULT_VALUE(False);
+
+    /// Block-compressed format that 8-bit images are encoded to when the texture is created
+    /// (BC1, BC3, BC4, BC5 or BC7 UNORM format). The sRGB version of BC1, BC3 and BC7 formats is
+    /// used when IsSRGB is true. TEX_FORMAT_UNKNOWN disables compression.
+    /// Images whose width or height is not a multiple of 4 are not compressed.
+    TEXTURE_FORMAT CompressedFormat     DEFAULT_VALUE(TEX_FORMAT_UNKNOWN);
+
+    /// Block compression quality
+    TEXTURE_COMPRESS_QUALITY CompressQuality DEFAULT_VALUE(TEXTURE_COMPRESS_QUALITY_NORMAL);
+
+    /// Filter that computes coarse mip levels. Mip levels that are computed with other filters
+    /// than MIP_FILTER_BOX are never generated on the GPU.
+    MIP_FILTER MipFilter                DEFAULT_VALUE(MIP_FILTER_BOX);
+
+    /// Alpha test threshold of the material that uses the texture, in [0, 1] range. When greater than
+    /// zero, alpha of every generated mip level of a four-channel image is scaled so that the fraction of
+    /// pixels that pass the alpha test is the same as in level 0. This keeps alpha-tested cutouts from
+    /// vanishing in the distance. Such mip levels are never generated on the GPU.
+    float AlphaCutoff                   DEFAULT_VALUE(0);
+
+    /// Maximum texture dimension. When a DDS or KTX file is loaded, the finest mip levels whose width,
+    /// height or depth exceed this value are skipped, and their data is never accessed. Zero means no limit.
+    Uint32 MaxDimension                 DEFAULT_VALUE(0);
+
+    /// Directory where CreateTextureFromFile() caches textures created from PNG, JPEG and TIFF files.
+    /// Cached textures are stored as KTX files with all mip levels and are found by the hash of the
+    /// file contents and the loading parameters that affect texture data, so changing the file
+    /// automatically invalidates its cached version. Null or empty string disables the cache.
+    const Char* CacheDirectory          DEFAULT_VALUE(nullptr);
+
+    /// Maximum total size of the cache files, in bytes. When the limit is exceeded,
+    /// least recently used files are deleted. Zero means no limit.
+    Uint64 MaxCacheSize                 DEFAULT_VALUE(0);
 
 #if DILIGENT_CPP_INTERFACE
     explicit TextureLoadInfo(const Char*         _Name,
@@ -125,6 +189,17 @@ void DILIGENT_GLOBAL_FUNCTION(CreateTextureFromKTX)(IDataBlob*                pK
                                                     IRenderDevice*            pDevice,
                                                     ITexture**                ppTexture);
 
+/// Writes texture data to a KTX 1.0 data blob
+
+/// \param [in] TexDesc     - Texture description. Only 2D textures, texture arrays and cube maps
+///                           with 8-bit, 16-bit and 32-bit color formats as well as BC1-BC5 and
+///                           BC7 formats are supported.
+/// \param [in] TexData     - Texture data. All subresources must be provided.
+/// \param [out] pKTXData   - Data blob where KTX data will be written.
+void DILIGENT_GLOBAL_FUNCTION(WriteTextureDataToKTX)(const TextureDesc REF TexDesc,
+                                                     const TextureData REF TexData,
+                                                     IDataBlob*            pKTXData);
+
 #include "../../../DiligentCore/Primitives/interface/UndefGlobalFuncHelperMacros.h"
 
 DILIGENT_END_NAMESPACE // namespace Diligent
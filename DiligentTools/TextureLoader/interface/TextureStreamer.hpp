@@ -0,0 +1,280 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+#pragma once
+
+/// \file
+/// Texture streaming with mip level residency and memory budget
+
+#include <vector>
+#include <deque>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+
+#include "../../../DiligentCore/Common/interface/RefCntAutoPtr.hpp"
+#include "../../../DiligentCore/Graphics/GraphicsTools/interface/TextureUploader.hpp"
+#include "TextureLoader.h"
+
+namespace Diligent
+{
+
+class ThreadPool;
+
+/// Streams mip levels of DDS and KTX textures according to the demand reported by the renderer.
+
+/// Every texture is created with only its tail mip levels (the levels whose dimensions do not exceed
+/// CreateInfo::TailMipDimension) resident. Finer levels are read from the file by tasks of the thread pool
+/// when the renderer reports that they are required, and are uploaded to the GPU through ITextureUploader.
+/// At most CreateInfo::MaxConcurrentLoads tasks read files at the same time, so that blocking file reads
+/// do not occupy all worker threads of a pool that is shared with other tools.
+/// The total size of the resident levels is kept under the memory budget: when a load does not fit,
+/// levels of the least recently used textures are evicted, finest levels first.
+///
+/// Without sparse textures, the resident levels of a texture are stored in a texture object that
+/// has exactly these levels. When residency changes, a new texture object is created and the levels
+/// that stay resident are copied from the old one on the GPU. The renderer must use the texture
+/// returned by GetTexture() and rebind it when GetTextureVersion() changes.
+///
+/// Only 2D textures are streamed. Other textures are fully resident and are only accounted in the budget.
+///
+/// When the render device is null, the streamer runs in CPU-only simulation mode: no textures are
+/// created and no files are read, but residency, memory and eviction are tracked exactly as in the
+/// normal mode. Simulated loads complete after CreateInfo::SimulatedLoadLatency calls to Update().
+///
+/// \remarks    All methods must be called from the same thread (normally, the render thread).
+class TextureStreamer
+{
+public:
+    using TextureId = Uint32;
+
+    static constexpr TextureId InvalidTextureId = ~Uint32{0};
+
+    struct CreateInfo
+    {
+        /// Render device. Null enables simulation mode.
+        IRenderDevice* pDevice = nullptr;
+
+        /// Texture uploader. If null, the streamer creates its own uploader.
+        ITextureUploader* pUploader = nullptr;
+
+        /// Memory budget for all textures of the streamer, in bytes.
+        Uint64 Budget = Uint64{256} << 20;
+
+        /// Mip levels whose width and height do not exceed this value are always resident.
+        Uint32 TailMipDimension = 64;
+
+        /// Thread pool that reads mip levels from files. If null, ThreadPool::GetShared() is used.
+        ThreadPool* pThreadPool = nullptr;
+
+        /// Maximum number of loads that are read from files simultaneously.
+        Uint32 MaxConcurrentLoads = 1;
+
+        /// Maximum number of bytes of new loads started by one call to Update(). Zero means no limit.
+        Uint64 MaxLoadBytesPerUpdate = Uint64{32} << 20;
+
+        /// The number of calls to Update() after which a load completes in simulation mode.
+        Uint32 SimulatedLoadLatency = 1;
+    };
+
+    struct Statistics
+    {
+        /// The number of registered textures
+        Uint32 NumTextures = 0;
+
+        /// Total size of the resident mip levels and of the levels being loaded, in bytes
+        Uint64 ResidentBytes = 0;
+
+        /// Size of the mip levels being loaded, in bytes
+        Uint64 PendingBytes = 0;
+
+        Uint32 NumPendingLoads = 0;
+
+        Uint64 NumLoadsCompleted = 0;
+
+        /// The number of mip levels evicted to stay under the budget
+        Uint64 NumEvictedMips = 0;
+    };
+
+    explicit TextureStreamer(const CreateInfo& CI);
+
+    /// Discards the loads that have not started and waits until the loads being read complete.
+    ~TextureStreamer();
+
+    // clang-format off
+    TextureStreamer           (const TextureStreamer&) = delete;
+    TextureStreamer& operator=(const TextureStreamer&) = delete;
+    // clang-format on
+
+    /// Registers a DDS or KTX texture file and creates the texture with its tail mip levels.
+
+    /// \param [in] FilePath    - Path to the file. The file must not change while the texture is registered.
+    /// \param [in] TexLoadInfo - Texture loading parameters. Name, BindFlags, IsSRGB and MaxDimension are used.
+    ///
+    /// \return     Texture id, or InvalidTextureId if the file could not be loaded.
+    TextureId AddTexture(const Char* FilePath, const TextureLoadInfo& TexLoadInfo);
+
+    /// Registers a texture in simulation mode.
+    TextureId AddSimulatedTexture(const TextureDesc& Desc);
+
+    /// Unregisters the texture and releases its memory. Pending loads of the texture are discarded.
+    void RemoveTexture(TextureId Id);
+
+    /// Reports that the texture is used in the current frame and that mip levels down to RequiredMip are needed.
+    /// If the demand is reported several times per frame, the finest level is used.
+    void ReportDemand(TextureId Id, Uint32 RequiredMip);
+
+    /// Reports that the texture is used in the current frame and covers the given screen-space size, in pixels.
+    void ReportScreenSize(TextureId Id, float ScreenWidth, float ScreenHeight);
+
+    /// Returns the finest mip level that is sampled when a texture of the given size covers
+    /// ScreenWidth x ScreenHeight pixels.
+    static Uint32 ComputeRequiredMip(Uint32 Width, Uint32 Height, Uint32 MipLevels, float ScreenWidth, float ScreenHeight);
+
+    /// Completes finished loads, evicts mip levels of least recently used textures to stay under
+    /// the budget, starts new loads, and begins the next frame.
+
+    /// \param [in] pContext - Device context that is used to copy and upload the mip levels. Ignored in simulation mode.
+    void Update(IDeviceContext* pContext);
+
+    /// Returns the texture that contains the resident mip levels. Level 0 of the texture is the
+    /// level GetResidentMip() of the full mip chain.
+    ITexture* GetTexture(TextureId Id);
+
+    /// Returns the number that is incremented every time the texture object is replaced.
+    Uint32 GetTextureVersion(TextureId Id) const;
+
+    /// Returns the finest resident mip level
+    Uint32 GetResidentMip(TextureId Id) const;
+
+    /// Returns the description of the full mip chain
+    const TextureDesc& GetFullDesc(TextureId Id) const;
+
+    bool IsLoading(TextureId Id) const;
+
+    void   SetBudget(Uint64 Budget) { m_Budget = Budget; }
+    Uint64 GetBudget() const { return m_Budget; }
+
+    Statistics GetStatistics() const;
+
+private:
+    struct MipRange
+    {
+        /// Offset of the level data in the file
+        size_t FileOffset = 0;
+        size_t Size       = 0;
+        Uint32 Stride     = 0;
+    };
+
+    struct LoadJob;
+
+    struct StreamedTexture
+    {
+        std::string Name;
+        std::string FilePath;
+        TextureDesc FullDesc;
+
+        /// File data location of every mip level
+        std::vector<MipRange> Mips;
+
+        /// GPU memory size of every mip level
+        std::vector<Uint64> MipSizes;
+
+        RefCntAutoPtr<ITexture> pTexture;
+
+        /// First level of the full chain that is stored in pTexture
+        Uint32 TextureFirstMip = 0;
+        Uint32 Version         = 0;
+
+        /// Levels [TailMip, MipLevels) are always resident
+        Uint32 TailMip     = 0;
+        Uint32 ResidentMip = 0;
+
+        Uint32 RequestedMip  = 0;
+        Uint64 LastUsedFrame = 0;
+
+        bool Loading    = false;
+        bool LoadFailed = false;
+
+        /// Completed load whose levels are not yet uploaded to the GPU
+        std::shared_ptr<LoadJob> pCompletedLoad;
+    };
+
+    StreamedTexture&       GetTex(TextureId Id);
+    const StreamedTexture& GetTex(TextureId Id) const;
+
+    void      InitMipLevels(StreamedTexture& Tex) const;
+    TextureId RegisterTexture(std::unique_ptr<StreamedTexture>&& pTex);
+
+    static Uint64 GetMipRangeSize(const StreamedTexture& Tex, Uint32 FirstMip, Uint32 EndMip);
+
+    Uint32 GetEvictionFloor(const StreamedTexture& Tex) const;
+
+    void CompleteLoads();
+    bool EvictMip(const std::vector<StreamedTexture*>& Victims, size_t& VictimIdx);
+    void StartLoad(TextureId Id, StreamedTexture& Tex, Uint32 FirstMip);
+    void UpdateTextureObject(IDeviceContext* pContext, StreamedTexture& Tex);
+
+    // Reads queued loads until the queue is empty. Executed by the thread pool.
+    void ReadQueuedLoads();
+
+    RefCntAutoPtr<IRenderDevice>    m_pDevice;
+    RefCntAutoPtr<ITextureUploader> m_pUploader;
+
+    const Uint32 m_TailMipDimension;
+    const Uint64 m_MaxLoadBytesPerUpdate;
+    const Uint32 m_SimulatedLoadLatency;
+
+    Uint64 m_Budget = 0;
+
+    std::vector<std::unique_ptr<StreamedTexture>> m_Textures;
+
+    /// Frame index of the demand that is currently reported
+    Uint64 m_FrameIndex = 1;
+
+    Uint64 m_ResidentBytes     = 0;
+    Uint64 m_PendingBytes      = 0;
+    Uint32 m_NumPendingLoads   = 0;
+    Uint64 m_NumLoadsCompleted = 0;
+    Uint64 m_NumEvictedMips    = 0;
+
+    ThreadPool*  m_pThreadPool = nullptr;
+    const Uint32 m_MaxConcurrentLoads;
+
+    std::mutex                            m_JobsMtx;
+    std::condition_variable               m_IdleCondVar;
+    std::deque<std::shared_ptr<LoadJob>>  m_QueuedJobs;
+    std::vector<std::shared_ptr<LoadJob>> m_CompletedJobs;
+    /// The number of thread pool tasks that execute ReadQueuedLoads()
+    Uint32 m_NumActiveTasks = 0;
+    bool   m_Stop           = false;
+
+    /// Loads of simulation mode
+    std::vector<std::shared_ptr<LoadJob>> m_SimulatedJobs;
+};
+
+} // namespace Diligent
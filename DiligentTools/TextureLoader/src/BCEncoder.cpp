@@ -0,0 +1,751 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+#include "BCEncoder.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include "ThreadPool.hpp"
+#include "DebugUtilities.hpp"
+
+namespace Diligent
+{
+
+namespace
+{
+
+template <typename T>
+T Clamp(T Val, T Min, T Max)
+{
+    return std::min(std::max(Val, Min), Max);
+}
+
+// Finds the principal axis of the point set with power iteration.
+// Returns false if all points are the same.
+template <Uint32 N>
+bool ComputePrincipalAxis(const float (*Points)[N], Uint32 NumPoints, float (&Mean)[N], float (&Axis)[N])
+{
+    for (Uint32 c = 0; c < N; ++c)
+    {
+        Mean[c] = 0;
+        for (Uint32 i = 0; i < NumPoints; ++i)
+            Mean[c] += Points[i][c];
+        Mean[c] /= static_cast<float>(NumPoints);
+    }
+
+    float Cov[N][N] = {};
+    for (Uint32 i = 0; i < NumPoints; ++i)
+    {
+        float d[N];
+        for (Uint32 c = 0; c < N; ++c)
+            d[c] = Points[i][c] - Mean[c];
+        for (Uint32 r = 0; r < N; ++r)
+            for (Uint32 c = r; c < N; ++c)
+                Cov[r][c] += d[r] * d[c];
+    }
+    for (Uint32 r = 0; r < N; ++r)
+        for (Uint32 c = 0; c < r; ++c)
+            Cov[r][c] = Cov[c][r];
+
+    // Start from the row with the largest diagonal element, which is never orthogonal to the principal axis
+    Uint32 MaxRow = 0;
+    for (Uint32 r = 1; r < N; ++r)
+    {
+        if (Cov[r][r] > Cov[MaxRow][MaxRow])
+            MaxRow = r;
+    }
+    if (Cov[MaxRow][MaxRow] <= 0)
+        return false;
+
+    for (Uint32 c = 0; c < N; ++c)
+        Axis[c] = Cov[MaxRow][c];
+
+    for (int Iter = 0; Iter < 8; ++Iter)
+    {
+        float NewAxis[N] = {};
+        float MaxComp    = 0;
+        for (Uint32 r = 0; r < N; ++r)
+        {
+            for (Uint32 c = 0; c < N; ++c)
+                NewAxis[r] += Cov[r][c] * Axis[c];
+            MaxComp = std::max(MaxComp, std::abs(NewAxis[r]));
+        }
+        if (MaxComp == 0)
+            return false;
+        for (Uint32 c = 0; c < N; ++c)
+            Axis[c] = NewAxis[c] / MaxComp;
+    }
+
+    float Len = 0;
+    for (Uint32 c = 0; c < N; ++c)
+        Len += Axis[c] * Axis[c];
+    Len = std::sqrt(Len);
+    for (Uint32 c = 0; c < N; ++c)
+        Axis[c] /= Len;
+    return true;
+}
+
+// Computes endpoints as the extreme projections of the points onto the principal axis
+template <Uint32 N>
+void ComputePrincipalAxisEndpoints(const float (*Points)[N], Uint32 NumPoints, float (&E0)[N], float (&E1)[N])
+{
+    float Mean[N], Axis[N];
+    if (!ComputePrincipalAxis(Points, NumPoints, Mean, Axis))
+    {
+        for (Uint32 c = 0; c < N; ++c)
+            E0[c] = E1[c] = Points[0][c];
+        return;
+    }
+
+    float MinT = +std::numeric_limits<float>::max();
+    float MaxT = -std::numeric_limits<float>::max();
+    for (Uint32 i = 0; i < NumPoints; ++i)
+    {
+        float t = 0;
+        for (Uint32 c = 0; c < N; ++c)
+            t += (Points[i][c] - Mean[c]) * Axis[c];
+        MinT = std::min(MinT, t);
+        MaxT = std::max(MaxT, t);
+    }
+    for (Uint32 c = 0; c < N; ++c)
+    {
+        E0[c] = Clamp(Mean[c] + Axis[c] * MinT, 0.f, 255.f);
+        E1[c] = Clamp(Mean[c] + Axis[c] * MaxT, 0.f, 255.f);
+    }
+}
+
+template <Uint32 N>
+void ComputeBoundingBoxEndpoints(const float (*Points)[N], Uint32 NumPoints, float (&E0)[N], float (&E1)[N])
+{
+    for (Uint32 c = 0; c < N; ++c)
+    {
+        E0[c] = E1[c] = Points[0][c];
+        for (Uint32 i = 1; i < NumPoints; ++i)
+        {
+            E0[c] = std::min(E0[c], Points[i][c]);
+            E1[c] = std::max(E1[c], Points[i][c]);
+        }
+        // Inset the box to reduce the error of the values in the middle
+        const auto Inset = (E1[c] - E0[c]) / 16.f;
+        E0[c] += Inset;
+        E1[c] -= Inset;
+    }
+}
+
+// Solves for endpoints that minimize the squared error given the interpolation
+// weights of the second endpoint. Returns false if the system is degenerate.
+template <Uint32 N>
+bool RefineEndpoints(const float (*Points)[N], const float* Weights, Uint32 NumPoints, float (&E0)[N], float (&E1)[N])
+{
+    float AA = 0, AB = 0, BB = 0;
+    float AX[N] = {}, BX[N] = {};
+    for (Uint32 i = 0; i < NumPoints; ++i)
+    {
+        const float b = Weights[i];
+        const float a = 1.f - b;
+        AA += a * a;
+        AB += a * b;
+        BB += b * b;
+        for (Uint32 c = 0; c < N; ++c)
+        {
+            AX[c] += a * Points[i][c];
+            BX[c] += b * Points[i][c];
+        }
+    }
+    const float Det = AA * BB - AB * AB;
+    if (std::abs(Det) < 1e-6f)
+        return false;
+
+    const float InvDet = 1.f / Det;
+    for (Uint32 c = 0; c < N; ++c)
+    {
+        E0[c] = Clamp((AX[c] * BB - BX[c] * AB) * InvDet, 0.f, 255.f);
+        E1[c] = Clamp((BX[c] * AA - AX[c] * AB) * InvDet, 0.f, 255.f);
+    }
+    return true;
+}
+
+
+// BC1
+
+Uint16 PackRGB565(const float (&Color)[3])
+{
+    const auto R = Clamp(static_cast<int>(Color[0] * (31.f / 255.f) + 0.5f), 0, 31);
+    const auto G = Clamp(static_cast<int>(Color[1] * (63.f / 255.f) + 0.5f), 0, 63);
+    const auto B = Clamp(static_cast<int>(Color[2] * (31.f / 255.f) + 0.5f), 0, 31);
+    return static_cast<Uint16>((R << 11) | (G << 5) | B);
+}
+
+void UnpackRGB565(Uint16 Color, int (&RGB)[3])
+{
+    const int R = (Color >> 11) & 31;
+    const int G = (Color >> 5) & 63;
+    const int B = Color & 31;
+    RGB[0]      = (R << 3) | (R >> 2);
+    RGB[1]      = (G << 2) | (G >> 4);
+    RGB[2]      = (B << 3) | (B >> 2);
+}
+
+struct BC1Block
+{
+    Uint16 Color0;
+    Uint16 Color1;
+    Uint32 Indices;
+};
+static_assert(sizeof(BC1Block) == 8, "Unexpected BC1 block size");
+
+// Computes four-color mode indices for the given endpoints (Color0 > Color1).
+// Returns the squared error.
+Uint32 ComputeBC1Indices(const float (&Points)[16][3], Uint16 Color0, Uint16 Color1, Uint32& Indices, float* Weights)
+{
+    int Palette[4][3];
+    UnpackRGB565(Color0, Palette[0]);
+    UnpackRGB565(Color1, Palette[1]);
+    for (int c = 0; c < 3; ++c)
+    {
+        Palette[2][c] = (2 * Palette[0][c] + Palette[1][c] + 1) / 3;
+        Palette[3][c] = (Palette[0][c] + 2 * Palette[1][c] + 1) / 3;
+    }
+    // Interpolation weights of Color1
+    static constexpr float IndexWeights[] = {0.f, 1.f, 1.f / 3.f, 2.f / 3.f};
+
+    Uint32 Error = 0;
+    Indices      = 0;
+    for (Uint32 i = 0; i < 16; ++i)
+    {
+        Uint32 BestDist = ~0u;
+        Uint32 BestIdx  = 0;
+        for (Uint32 idx = 0; idx < 4; ++idx)
+        {
+            Uint32 Dist = 0;
+            for (int c = 0; c < 3; ++c)
+            {
+                const auto d = static_cast<int>(Points[i][c]) - Palette[idx][c];
+                Dist += static_cast<Uint32>(d * d);
+            }
+            if (Dist < BestDist)
+            {
+                BestDist = Dist;
+                BestIdx  = idx;
+            }
+        }
+        Error += BestDist;
+        Indices |= BestIdx << (i * 2);
+        if (Weights != nullptr)
+            Weights[i] = IndexWeights[BestIdx];
+    }
+    return Error;
+}
+
+// Packs the endpoints and computes the indices. Returns the squared error.
+Uint32 EncodeBC1Endpoints(const float (&Points)[16][3], const float (&E0)[3], const float (&E1)[3], BC1Block& Block, float* Weights)
+{
+    Block.Color0 = PackRGB565(E0);
+    Block.Color1 = PackRGB565(E1);
+    // Four-color mode requires Color0 > Color1
+    if (Block.Color0 < Block.Color1)
+        std::swap(Block.Color0, Block.Color1);
+
+    if (Block.Color0 == Block.Color1)
+    {
+        // Three-color mode: index 0 is Color0
+        Block.Indices = 0;
+        int Color[3];
+        UnpackRGB565(Block.Color0, Color);
+        Uint32 Error = 0;
+        for (Uint32 i = 0; i < 16; ++i)
+        {
+            for (int c = 0; c < 3; ++c)
+            {
+                const auto d = static_cast<int>(Points[i][c]) - Color[c];
+                Error += static_cast<Uint32>(d * d);
+            }
+            if (Weights != nullptr)
+                Weights[i] = 0;
+        }
+        return Error;
+    }
+
+    return ComputeBC1Indices(Points, Block.Color0, Block.Color1, Block.Indices, Weights);
+}
+
+Uint32 GetNumRefinementIterations(TEXTURE_COMPRESS_QUALITY Quality)
+{
+    switch (Quality)
+    {
+        case TEXTURE_COMPRESS_QUALITY_FAST: return 0;
+        case TEXTURE_COMPRESS_QUALITY_NORMAL: return 1;
+        default: return 3;
+    }
+}
+
+
+// BC4
+
+Uint32 ComputeBC4Block(const int (&Values)[16], int A0, int A1, Uint8* pDst)
+{
+    VERIFY_EXPR(A0 > A1);
+    int Palette[8];
+    Palette[0] = A0;
+    Palette[1] = A1;
+    for (int i = 2; i < 8; ++i)
+        Palette[i] = ((8 - i) * A0 + (i - 1) * A1 + 3) / 7;
+
+    Uint32 Error   = 0;
+    Uint64 Indices = 0;
+    for (Uint32 i = 0; i < 16; ++i)
+    {
+        Uint32 BestDist = ~0u;
+        Uint64 BestIdx  = 0;
+        for (Uint32 idx = 0; idx < 8; ++idx)
+        {
+            const auto d    = Values[i] - Palette[idx];
+            const auto Dist = static_cast<Uint32>(d * d);
+            if (Dist < BestDist)
+            {
+                BestDist = Dist;
+                BestIdx  = idx;
+            }
+        }
+        Error += BestDist;
+        Indices |= BestIdx << (i * 3);
+    }
+
+    if (pDst != nullptr)
+    {
+        pDst[0] = static_cast<Uint8>(A0);
+        pDst[1] = static_cast<Uint8>(A1);
+        for (int b = 0; b < 6; ++b)
+            pDst[2 + b] = static_cast<Uint8>((Indices >> (b * 8)) & 0xFF);
+    }
+    return Error;
+}
+
+
+// BC7
+
+class BitWriter
+{
+public:
+    explicit BitWriter(Uint8* pDst) :
+        m_pDst{pDst}
+    {
+        memset(m_pDst, 0, 16);
+    }
+
+    void Write(Uint32 Value, Uint32 NumBits)
+    {
+        for (Uint32 b = 0; b < NumBits; ++b, ++m_Pos)
+        {
+            if ((Value >> b) & 1u)
+                m_pDst[m_Pos >> 3] |= static_cast<Uint8>(1u << (m_Pos & 7));
+        }
+    }
+
+    Uint32 GetPos() const { return m_Pos; }
+
+private:
+    Uint8* const m_pDst;
+    Uint32       m_Pos = 0;
+};
+
+static constexpr int BC7Weights4[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+struct BC7Mode6Endpoints
+{
+    // 7-bit endpoint values
+    int    Q[2][4];
+    Uint32 PBits[2];
+};
+
+void QuantizeBC7Mode6Endpoint(const float (&E)[4], Uint32 PBit, int (&Q)[4])
+{
+    for (int c = 0; c < 4; ++c)
+        Q[c] = Clamp(static_cast<int>((E[c] - static_cast<float>(PBit)) * 0.5f + 0.5f), 0, 127);
+}
+
+// Selects the p-bit that gives the smallest quantization error of the endpoint
+Uint32 SelectBC7PBit(const float (&E)[4])
+{
+    float Errors[2] = {};
+    for (Uint32 p = 0; p < 2; ++p)
+    {
+        int Q[4];
+        QuantizeBC7Mode6Endpoint(E, p, Q);
+        for (int c = 0; c < 4; ++c)
+        {
+            const auto d = E[c] - static_cast<float>(Q[c] * 2 + static_cast<int>(p));
+            Errors[p] += d * d;
+        }
+    }
+    return Errors[1] < Errors[0] ? 1 : 0;
+}
+
+// Computes the indices and returns the squared error
+Uint32 ComputeBC7Mode6Indices(const float (&Points)[16][4], const BC7Mode6Endpoints& Endpoints, Uint8 (&Indices)[16], float* Weights)
+{
+    int Palette[16][4];
+    for (int c = 0; c < 4; ++c)
+    {
+        const int E0 = Endpoints.Q[0][c] * 2 + static_cast<int>(Endpoints.PBits[0]);
+        const int E1 = Endpoints.Q[1][c] * 2 + static_cast<int>(Endpoints.PBits[1]);
+        for (int i = 0; i < 16; ++i)
+            Palette[i][c] = ((64 - BC7Weights4[i]) * E0 + BC7Weights4[i] * E1 + 32) >> 6;
+    }
+
+    Uint32 Error = 0;
+    for (Uint32 i = 0; i < 16; ++i)
+    {
+        Uint32 BestDist = ~0u;
+        Uint8  BestIdx  = 0;
+        for (Uint8 idx = 0; idx < 16; ++idx)
+        {
+            Uint32 Dist = 0;
+            for (int c = 0; c < 4; ++c)
+            {
+                const auto d = static_cast<int>(Points[i][c]) - Palette[idx][c];
+                Dist += static_cast<Uint32>(d * d);
+            }
+            if (Dist < BestDist)
+            {
+                BestDist = Dist;
+                BestIdx  = idx;
+            }
+        }
+        Error += BestDist;
+        Indices[i] = BestIdx;
+        if (Weights != nullptr)
+            Weights[i] = static_cast<float>(BC7Weights4[BestIdx]) / 64.f;
+    }
+    return Error;
+}
+
+void WriteBC7Mode6Block(BC7Mode6Endpoints Endpoints, Uint8 (&Indices)[16], Uint8* pDst)
+{
+    // The most significant bit of the first index is implicitly zero
+    if (Indices[0] >= 8)
+    {
+        std::swap(Endpoints.Q[0], Endpoints.Q[1]);
+        std::swap(Endpoints.PBits[0], Endpoints.PBits[1]);
+        for (auto& Idx : Indices)
+            Idx = static_cast<Uint8>(15 - Idx);
+    }
+
+    BitWriter Writer{pDst};
+    Writer.Write(1u << 6, 7); // Mode 6
+    for (int c = 0; c < 4; ++c)
+    {
+        Writer.Write(static_cast<Uint32>(Endpoints.Q[0][c]), 7);
+        Writer.Write(static_cast<Uint32>(Endpoints.Q[1][c]), 7);
+    }
+    Writer.Write(Endpoints.PBits[0], 1);
+    Writer.Write(Endpoints.PBits[1], 1);
+    Writer.Write(Indices[0], 3);
+    for (int i = 1; i < 16; ++i)
+        Writer.Write(Indices[i], 4);
+    VERIFY_EXPR(Writer.GetPos() == 128);
+}
+
+
+void FetchBlock(const EncodeBCAttribs& Attribs, Uint32 BlockX, Uint32 BlockY, Uint8 (&RGBA)[64])
+{
+    static constexpr Uint8 DefaultValues[4] = {0, 0, 0, 255};
+
+    const auto* pSrc = reinterpret_cast<const Uint8*>(Attribs.pSrcData);
+    for (Uint32 y = 0; y < 4; ++y)
+    {
+        const auto  SrcY    = std::min(BlockY * 4 + y, Attribs.Height - 1);
+        const auto* pSrcRow = pSrc + size_t{SrcY} * Attribs.SrcStride;
+        for (Uint32 x = 0; x < 4; ++x)
+        {
+            const auto  SrcX  = std::min(BlockX * 4 + x, Attribs.Width - 1);
+            const auto* pPixel = pSrcRow + SrcX * Attribs.NumSrcChannels;
+            auto*       pDst   = RGBA + (y * 4 + x) * 4;
+            for (Uint32 c = 0; c < 4; ++c)
+                pDst[c] = c < Attribs.NumSrcChannels ? pPixel[c] : DefaultValues[c];
+        }
+    }
+}
+
+Uint32 GetBCBlockSize(TEXTURE_FORMAT Format)
+{
+    switch (Format)
+    {
+        case TEX_FORMAT_BC1_UNORM:
+        case TEX_FORMAT_BC1_UNORM_SRGB:
+        case TEX_FORMAT_BC4_UNORM:
+            return 8;
+
+        case TEX_FORMAT_BC3_UNORM:
+        case TEX_FORMAT_BC3_UNORM_SRGB:
+        case TEX_FORMAT_BC5_UNORM:
+        case TEX_FORMAT_BC7_UNORM:
+        case TEX_FORMAT_BC7_UNORM_SRGB:
+            return 16;
+
+        default:
+            return 0;
+    }
+}
+
+} // namespace
+
+void EncodeBC1Block(const Uint8 RGBA[64], TEXTURE_COMPRESS_QUALITY Quality, void* pDstBlock)
+{
+    float Points[16][3];
+    for (Uint32 i = 0; i < 16; ++i)
+    {
+        for (Uint32 c = 0; c < 3; ++c)
+            Points[i][c] = static_cast<float>(RGBA[i * 4 + c]);
+    }
+
+    float E0[3], E1[3];
+    if (Quality == TEXTURE_COMPRESS_QUALITY_FAST)
+        ComputeBoundingBoxEndpoints(Points, 16, E0, E1);
+    else
+        ComputePrincipalAxisEndpoints(Points, 16, E0, E1);
+
+    float    Weights[16];
+    BC1Block Best;
+    auto     BestError = EncodeBC1Endpoints(Points, E0, E1, Best, Weights);
+
+    const auto NumIterations = GetNumRefinementIterations(Quality);
+    for (Uint32 Iter = 0; Iter < NumIterations && BestError > 0; ++Iter)
+    {
+        if (!RefineEndpoints(Points, Weights, 16, E0, E1))
+            break;
+
+        BC1Block Block;
+        float    NewWeights[16];
+        const auto Error = EncodeBC1Endpoints(Points, E0, E1, Block, NewWeights);
+        if (Error >= BestError)
+            break;
+
+        BestError = Error;
+        Best      = Block;
+        memcpy(Weights, NewWeights, sizeof(Weights));
+    }
+
+    memcpy(pDstBlock, &Best, sizeof(Best));
+}
+
+void EncodeBC4Block(const Uint8* pValues, Uint32 ValueStride, TEXTURE_COMPRESS_QUALITY Quality, void* pDstBlock)
+{
+    int Values[16];
+    int MinVal = 255, MaxVal = 0;
+    for (Uint32 i = 0; i < 16; ++i)
+    {
+        Values[i] = pValues[i * ValueStride];
+        MinVal    = std::min(MinVal, Values[i]);
+        MaxVal    = std::max(MaxVal, Values[i]);
+    }
+
+    auto* pDst = reinterpret_cast<Uint8*>(pDstBlock);
+    if (MinVal == MaxVal)
+    {
+        // Six-value mode: index 0 is the first endpoint
+        pDst[0] = pDst[1] = static_cast<Uint8>(MinVal);
+        memset(pDst + 2, 0, 6);
+        return;
+    }
+
+    if (Quality != TEXTURE_COMPRESS_QUALITY_HIGH)
+    {
+        ComputeBC4Block(Values, MaxVal, MinVal, pDst);
+        return;
+    }
+
+    // Try to move the endpoints inwards, which may reduce the error of the values in between
+    int    BestA0 = MaxVal, BestA1 = MinVal;
+    Uint32 BestError = ~0u;
+    for (int d0 = 0; d0 < 4; ++d0)
+    {
+        for (int d1 = 0; d1 < 4; ++d1)
+        {
+            const auto A0 = MaxVal - d0;
+            const auto A1 = MinVal + d1;
+            if (A0 <= A1)
+                continue;
+            const auto Error = ComputeBC4Block(Values, A0, A1, nullptr);
+            if (Error < BestError)
+            {
+                BestError = Error;
+                BestA0    = A0;
+                BestA1    = A1;
+            }
+        }
+    }
+    ComputeBC4Block(Values, BestA0, BestA1, pDst);
+}
+
+void EncodeBC7Block(const Uint8 RGBA[64], TEXTURE_COMPRESS_QUALITY Quality, void* pDstBlock)
+{
+    float Points[16][4];
+    for (Uint32 i = 0; i < 16; ++i)
+    {
+        for (Uint32 c = 0; c < 4; ++c)
+            Points[i][c] = static_cast<float>(RGBA[i * 4 + c]);
+    }
+
+    float E0[4], E1[4];
+    if (Quality == TEXTURE_COMPRESS_QUALITY_FAST)
+        ComputeBoundingBoxEndpoints(Points, 16, E0, E1);
+    else
+        ComputePrincipalAxisEndpoints(Points, 16, E0, E1);
+
+    BC7Mode6Endpoints Best;
+    Uint8             BestIndices[16];
+    float             BestWeights[16];
+    Uint32            BestError = ~0u;
+
+    auto TryEndpoints = [&](const float(&e0)[4], const float(&e1)[4], Uint32 P0, Uint32 P1) {
+        BC7Mode6Endpoints Endpoints;
+        Endpoints.PBits[0] = P0;
+        Endpoints.PBits[1] = P1;
+        QuantizeBC7Mode6Endpoint(e0, P0, Endpoints.Q[0]);
+        QuantizeBC7Mode6Endpoint(e1, P1, Endpoints.Q[1]);
+
+        Uint8      Indices[16];
+        float      Weights[16];
+        const auto Error = ComputeBC7Mode6Indices(Points, Endpoints, Indices, Weights);
+        if (Error < BestError)
+        {
+            BestError = Error;
+            Best      = Endpoints;
+            memcpy(BestIndices, Indices, sizeof(Indices));
+            memcpy(BestWeights, Weights, sizeof(Weights));
+            return true;
+        }
+        return false;
+    };
+
+    auto TryAllPBits = [&](const float(&e0)[4], const float(&e1)[4]) {
+        bool Improved = false;
+        if (Quality == TEXTURE_COMPRESS_QUALITY_HIGH)
+        {
+            for (Uint32 p = 0; p < 4; ++p)
+                Improved |= TryEndpoints(e0, e1, p & 1u, p >> 1u);
+        }
+        else
+        {
+            Improved = TryEndpoints(e0, e1, SelectBC7PBit(e0), SelectBC7PBit(e1));
+        }
+        return Improved;
+    };
+
+    TryAllPBits(E0, E1);
+
+    const auto NumIterations = GetNumRefinementIterations(Quality);
+    for (Uint32 Iter = 0; Iter < NumIterations && BestError > 0; ++Iter)
+    {
+        if (!RefineEndpoints(Points, BestWeights, 16, E0, E1))
+            break;
+        if (!TryAllPBits(E0, E1))
+            break;
+    }
+
+    WriteBC7Mode6Block(Best, BestIndices, reinterpret_cast<Uint8*>(pDstBlock));
+}
+
+bool IsBCEncoderFormatSupported(TEXTURE_FORMAT Format)
+{
+    return GetBCBlockSize(Format) != 0;
+}
+
+void EncodeBC(const EncodeBCAttribs& Attribs, ThreadPool* pPool)
+{
+    const auto BlockSize = GetBCBlockSize(Attribs.Format);
+    if (BlockSize == 0)
+    {
+        UNEXPECTED("Unsupported block-compressed format");
+        return;
+    }
+    VERIFY_EXPR(Attribs.pSrcData != nullptr && Attribs.pDstData != nullptr);
+    VERIFY_EXPR(Attribs.NumSrcChannels >= 1 && Attribs.NumSrcChannels <= 4);
+    VERIFY_EXPR(Attribs.Width > 0 && Attribs.Height > 0);
+
+    const auto NumBlocksX = (Attribs.Width + 3) / 4;
+    const auto NumBlocksY = (Attribs.Height + 3) / 4;
+    VERIFY_EXPR(Attribs.DstStride >= NumBlocksX * BlockSize);
+
+    auto EncodeBlockRow = [&](Uint32 BlockY) {
+        auto* pDstRow = reinterpret_cast<Uint8*>(Attribs.pDstData) + size_t{BlockY} * Attribs.DstStride;
+        for (Uint32 BlockX = 0; BlockX < NumBlocksX; ++BlockX)
+        {
+            Uint8 RGBA[64];
+            FetchBlock(Attribs, BlockX, BlockY, RGBA);
+
+            auto* pDst = pDstRow + BlockX * BlockSize;
+            switch (Attribs.Format)
+            {
+                case TEX_FORMAT_BC1_UNORM:
+                case TEX_FORMAT_BC1_UNORM_SRGB:
+                    EncodeBC1Block(RGBA, Attribs.Quality, pDst);
+                    break;
+
+                case TEX_FORMAT_BC3_UNORM:
+                case TEX_FORMAT_BC3_UNORM_SRGB:
+                    EncodeBC4Block(RGBA + 3, 4, Attribs.Quality, pDst);
+                    EncodeBC1Block(RGBA, Attribs.Quality, pDst + 8);
+                    break;
+
+                case TEX_FORMAT_BC4_UNORM:
+                    EncodeBC4Block(RGBA, 4, Attribs.Quality, pDst);
+                    break;
+
+                case TEX_FORMAT_BC5_UNORM:
+                    EncodeBC4Block(RGBA, 4, Attribs.Quality, pDst);
+                    EncodeBC4Block(RGBA + 1, 4, Attribs.Quality, pDst + 8);
+                    break;
+
+                case TEX_FORMAT_BC7_UNORM:
+                case TEX_FORMAT_BC7_UNORM_SRGB:
+                    EncodeBC7Block(RGBA, Attribs.Quality, pDst);
+                    break;
+
+                default:
+                    UNEXPECTED("Unexpected format");
+            }
+        }
+    };
+
+    if (pPool != nullptr)
+    {
+        pPool->ParallelFor(NumBlocksY, EncodeBlockRow);
+    }
+    else
+    {
+        for (Uint32 BlockY = 0; BlockY < NumBlocksY; ++BlockY)
+            EncodeBlockRow(BlockY);
+    }
+}
+
+} // namespace Diligent
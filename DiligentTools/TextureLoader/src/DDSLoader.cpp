@@ -50,6 +50,7 @@
 #include "pch.h"
 #include "dxgiformat.h"
 #include <memory>
+#include <vector>
 #include <algorithm>
 #include "DDSLoader.h"
 
@@ -944,10 +945,11 @@ static void CreateTexture(
     _In_ bool forceSRGB,
     _In_ bool isCubeMap,
     _In_ TextureSubResData* initData,
-    _Outptr_opt_ ITexture** texture
+    _Outptr_opt_ ITexture** texture,
+    _Out_opt_ TextureDesc* pDescOut
     )
 {
-    if (!pDevice || !initData)
+    if (!initData || (pDevice != nullptr) != (texture != nullptr))
     {
         LOG_ERROR_AND_THROW("Invalid arguments");
     }
@@ -978,7 +980,6 @@ static void CreateTexture(
         case D3D11_RESOURCE_DIMENSION_TEXTURE1D:
             {
                 desc.Type = arraySize > 1 ? RESOURCE_DIM_TEX_1D_ARRAY : RESOURCE_DIM_TEX_1D;
-                pDevice->CreateTexture( desc, &InitData, texture );
                 
             //    ID3D11Texture1D* tex = nullptr;
             //    hr = d3dDevice->CreateTexture1D(&desc, initData, &tex);
@@ -1040,7 +1041,6 @@ static void CreateTexture(
                 //    desc.MiscFlags = miscFlags & ~D3D11_RESOURCE_MISC_TEXTURECUBE;
                 //}
 
-                pDevice->CreateTexture( desc, &InitData, texture );
 
                 //ID3D11Texture2D* tex = nullptr;
                 //hr = d3dDevice->CreateTexture2D(&desc, initData, &tex);
@@ -1110,7 +1110,6 @@ static void CreateTexture(
 
                 //desc.MiscFlags = miscFlags & ~D3D11_RESOURCE_MISC_TEXTURECUBE;
 
-                pDevice->CreateTexture( desc, &InitData, texture );
 
                 //ID3D11Texture3D* tex = nullptr;
                 //hr = d3dDevice->CreateTexture3D(&desc, initData, &tex);
@@ -1149,6 +1148,13 @@ static void CreateTexture(
         default:
             LOG_ERROR_AND_THROW("Invalid resource dimension (", resDim, ")");
     }
+
+    if (pDescOut != nullptr)
+        *pDescOut = desc;
+
+    // Without the device, only the texture description is requested
+    if (pDevice != nullptr)
+        pDevice->CreateTexture(desc, &InitData, texture);
 }
 
 //--------------------------------------------------------------------------------------
@@ -1164,7 +1170,9 @@ static void CreateTextureFromDDS(
     _In_ CPU_ACCESS_FLAGS cpuAccessFlags,
     _In_ MISC_TEXTURE_FLAGS miscFlags,
     _In_ bool forceSRGB,
-    _Outptr_opt_ ITexture** texture
+    _Outptr_opt_ ITexture** texture,
+    _Out_opt_ TextureDesc* pDescOut = nullptr,
+    _Out_opt_ std::vector<TextureSubResData>* pSubResourcesOut = nullptr
     )
 {
     size_t width = header->width;
@@ -1329,7 +1337,10 @@ static void CreateTextureFromDDS(
     size_t tdepth = 0;
     FillInitData(width, height, depth, mipCount, arraySize, format, maxsize, bitSize, bitData, twidth, theight, tdepth, skipMip, initData.get());
 
-    CreateTexture(pDevice, resDim, twidth, theight, tdepth, mipCount - skipMip, arraySize, format, usage, name, bindFlags, cpuAccessFlags, miscFlags, forceSRGB, isCubeMap, initData.get(), texture/*, textureView*/);
+    CreateTexture(pDevice, resDim, twidth, theight, tdepth, mipCount - skipMip, arraySize, format, usage, name, bindFlags, cpuAccessFlags, miscFlags, forceSRGB, isCubeMap, initData.get(), texture/*, textureView*/, pDescOut);
+
+    if (pSubResourcesOut != nullptr)
+        pSubResourcesOut->assign(initData.get(), initData.get() + (mipCount - skipMip) * arraySize);
 
 #if 0
     if (FAILED(hr) && !maxsize && (mipCount > 1))
@@ -1407,6 +1418,52 @@ static D2D1_ALPHA_MODE GetAlphaMode(_In_ const DDS_HEADER* header)
 
 #endif
 
+//--------------------------------------------------------------------------------------
+// Validates the DDS file in memory and returns its header and the offset of the texture data
+static const DDS_HEADER* GetDDSHeader(
+    _In_ const Uint8* ddsData,
+    _In_ size_t ddsDataSize,
+    _Out_ ptrdiff_t& offset)
+{
+    // Validate DDS file in memory
+    if (ddsDataSize < (sizeof(Uint32) + sizeof(DDS_HEADER)))
+    {
+        LOG_ERROR_AND_THROW("Invalid dds file");
+    }
+
+    Uint32 dwMagicNumber = *(const Uint32*)(ddsData);
+    if (dwMagicNumber != DDS_MAGIC)
+    {
+        LOG_ERROR_AND_THROW("Invalid dds file");
+    }
+
+    auto header = reinterpret_cast<const DDS_HEADER*>(ddsData + sizeof(Uint32));
+
+    // Verify header to validate DDS file
+    if (header->size != sizeof(DDS_HEADER) ||
+        header->ddspf.size != sizeof(DDS_PIXELFORMAT))
+    {
+        LOG_ERROR_AND_THROW("Invalid dds file header");
+    }
+
+    // Check for DX10 extension
+    bool bDXT10Header = false;
+    if ((header->ddspf.flags & DDS_FOURCC) &&
+        (MAKEFOURCC('D', 'X', '1', '0') == header->ddspf.fourCC))
+    {
+        // Must be long enough for both headers and magic value
+        if (ddsDataSize < (sizeof(DDS_HEADER) + sizeof(Uint32) + sizeof(DDS_HEADER_DXT10)))
+        {
+            LOG_ERROR_AND_THROW("Invalid DX10 extension");
+        }
+
+        bDXT10Header = true;
+    }
+
+    offset = sizeof(Uint32) + sizeof(DDS_HEADER) + (bDXT10Header ? sizeof(DDS_HEADER_DXT10) : 0);
+    return header;
+}
+
 //--------------------------------------------------------------------------------------
 void CreateDDSTextureFromMemory(
     IRenderDevice* pDevice,
@@ -1456,45 +1513,32 @@ void CreateDDSTextureFromMemoryEx(
         LOG_ERROR_AND_THROW("Invalid arguments");
     }
 
-    // Validate DDS file in memory
-    if (ddsDataSize < (sizeof(Uint32) + sizeof(DDS_HEADER)))
-    {
-        LOG_ERROR_AND_THROW("Invalid dds file");
-    }
+    ptrdiff_t offset = 0;
+    auto header = GetDDSHeader(ddsData, ddsDataSize, offset);
 
-    Uint32 dwMagicNumber = *(const Uint32*)(ddsData);
-    if (dwMagicNumber != DDS_MAGIC)
-    {
-        LOG_ERROR_AND_THROW("Invalid dds file");
-    }
+    CreateTextureFromDDS(pDevice, header, ddsData + offset, ddsDataSize - offset, maxsize, usage, name, bindFlags, cpuAccessFlags, miscFlags, forceSRGB, texture/*, textureView*/);
 
-    auto header = reinterpret_cast<const DDS_HEADER*>(ddsData + sizeof(Uint32));
+    //if (alphaMode)
+    //    *alphaMode = GetAlphaMode(header);
+}
 
-    // Verify header to validate DDS file
-    if (header->size != sizeof(DDS_HEADER) ||
-        header->ddspf.size != sizeof(DDS_PIXELFORMAT))
-    {
-        LOG_ERROR_AND_THROW("Invalid dds file header");
-    }
 
-    // Check for DX10 extension
-    bool bDXT10Header = false;
-    if ((header->ddspf.flags & DDS_FOURCC) &&
-        (MAKEFOURCC('D', 'X', '1', '0') == header->ddspf.fourCC))
+//--------------------------------------------------------------------------------------
+void GetDDSTextureData(
+    const Uint8* ddsData,
+    size_t ddsDataSize,
+    size_t maxsize,
+    bool forceSRGB,
+    TextureDesc& desc,
+    std::vector<TextureSubResData>& subResources)
+{
+    if (!ddsData)
     {
-        // Must be long enough for both headers and magic value
-        if (ddsDataSize < (sizeof(DDS_HEADER) + sizeof(Uint32) + sizeof(DDS_HEADER_DXT10)))
-        {
-            LOG_ERROR_AND_THROW("Invalid DX10 extension");
-        }
-
-        bDXT10Header = true;
+        LOG_ERROR_AND_THROW("Invalid arguments");
     }
 
-    ptrdiff_t offset = sizeof(Uint32) + sizeof(DDS_HEADER) + (bDXT10Header ? sizeof(DDS_HEADER_DXT10) : 0);
-
-    CreateTextureFromDDS(pDevice, header, ddsData + offset, ddsDataSize - offset, maxsize, usage, name, bindFlags, cpuAccessFlags, miscFlags, forceSRGB, texture/*, textureView*/);
+    ptrdiff_t offset = 0;
+    auto header = GetDDSHeader(ddsData, ddsDataSize, offset);
 
-    //if (alphaMode)
-    //    *alphaMode = GetAlphaMode(header);
+    CreateTextureFromDDS(nullptr, header, ddsData + offset, ddsDataSize - offset, maxsize, USAGE_DEFAULT, nullptr, BIND_SHADER_RESOURCE, CPU_ACCESS_NONE, MISC_TEXTURE_FLAG_NONE, forceSRGB, nullptr, &desc, &subResources);
 }
@@ -33,7 +33,6 @@
 #include "Image.h"
 #include "Errors.hpp"
 
-#include "tiffio.h"
 #include "png.h"
 #include "PNGCodec.h"
 #include "JPEGCodec.h"
@@ -44,177 +43,25 @@
 #include "Align.hpp"
 #include "GraphicsAccessories.hpp"
 #include "BasicFileStream.hpp"
+#include "MappedFileDataBlob.hpp"
+#include "PixelConversion.hpp"
+#include "ImageRowDecoder.hpp"
+#include "TextureLoaderInternal.hpp"
 #include "StringTools.hpp"
 
 namespace Diligent
 {
 
-class TIFFClientOpenWrapper
-{
-public:
-    explicit TIFFClientOpenWrapper(IDataBlob* pData) noexcept :
-        m_Offset{0},
-        m_Size{pData->GetSize()},
-        m_pData{pData}
-    {
-    }
-
-    static tmsize_t TIFFReadProc(thandle_t pClientData, void* pBuffer, tmsize_t Size)
-    {
-        auto* pThis   = reinterpret_cast<TIFFClientOpenWrapper*>(pClientData);
-        auto* pSrcPtr = reinterpret_cast<Uint8*>(pThis->m_pData->GetDataPtr()) + pThis->m_Offset;
-        memcpy(pBuffer, pSrcPtr, Size);
-        pThis->m_Offset += Size;
-        return Size;
-    }
-
-    static tmsize_t TIFFWriteProc(thandle_t pClientData, void* pBuffer, tmsize_t Size)
-    {
-        auto* pThis = reinterpret_cast<TIFFClientOpenWrapper*>(pClientData);
-        if (pThis->m_Offset + Size > pThis->m_Size)
-        {
-            pThis->m_Size = pThis->m_Offset + Size;
-            pThis->m_pData->Resize(pThis->m_Size);
-        }
-        auto* pDstPtr = reinterpret_cast<Uint8*>(pThis->m_pData->GetDataPtr()) + pThis->m_Offset;
-        memcpy(pDstPtr, pBuffer, Size);
-        pThis->m_Offset += Size;
-        return Size;
-    }
-
-    static toff_t TIFFSeekProc(thandle_t pClientData, toff_t Offset, int Whence)
-    {
-        auto* pThis = reinterpret_cast<TIFFClientOpenWrapper*>(pClientData);
-        switch (Whence)
-        {
-            case SEEK_SET: pThis->m_Offset = static_cast<size_t>(Offset); break;
-            case SEEK_CUR: pThis->m_Offset += static_cast<size_t>(Offset); break;
-            case SEEK_END: pThis->m_Offset = pThis->m_Size + static_cast<size_t>(Offset); break;
-            default: UNEXPECTED("Unexpected whence");
-        }
-
-        return pThis->m_Offset;
-    }
-
-    static int TIFFCloseProc(thandle_t pClientData)
-    {
-        auto* pThis = reinterpret_cast<TIFFClientOpenWrapper*>(pClientData);
-        pThis->m_pData.Release();
-        pThis->m_Size   = 0;
-        pThis->m_Offset = 0;
-        return 0;
-    }
-
-    static toff_t TIFFSizeProc(thandle_t pClientData)
-    {
-        auto* pThis = reinterpret_cast<TIFFClientOpenWrapper*>(pClientData);
-        return pThis->m_Size;
-    }
-
-    static int TIFFMapFileProc(thandle_t pClientData, void** base, toff_t* size)
-    {
-        UNEXPECTED("Client file mapping is not implemented. Use \'m\' when opening TIFF file to disable file mapping.");
-        return 0;
-    }
-
-    static void TIFFUnmapFileProc(thandle_t pClientData, void* base, toff_t size)
-    {
-        UNEXPECTED("Client file mapping is not implemented. Use \'m\' when opening TIFF file to disable file mapping.");
-    }
-
-private:
-    size_t                   m_Offset;
-    size_t                   m_Size;
-    RefCntAutoPtr<IDataBlob> m_pData;
-};
-
 void Image::LoadTiffFile(IDataBlob* pFileData, const ImageLoadInfo& LoadInfo)
 {
-    TIFFClientOpenWrapper TiffClientOpenWrpr(pFileData);
-
-    auto TiffFile = TIFFClientOpen("", "rm", &TiffClientOpenWrpr,
-                                   TIFFClientOpenWrapper::TIFFReadProc,
-                                   TIFFClientOpenWrapper::TIFFWriteProc,
-                                   TIFFClientOpenWrapper::TIFFSeekProc,
-                                   TIFFClientOpenWrapper::TIFFCloseProc,
-                                   TIFFClientOpenWrapper::TIFFSizeProc,
-                                   TIFFClientOpenWrapper::TIFFMapFileProc,
-                                   TIFFClientOpenWrapper::TIFFUnmapFileProc);
-
-    TIFFGetField(TiffFile, TIFFTAG_IMAGEWIDTH, &m_Desc.Width);
-    TIFFGetField(TiffFile, TIFFTAG_IMAGELENGTH, &m_Desc.Height);
-
-    Uint16 SamplesPerPixel = 0;
-    // SamplesPerPixel is usually 1 for bilevel, grayscale, and palette-color images.
-    // SamplesPerPixel is usually 3 for RGB images. If this value is higher, ExtraSamples
-    // should give an indication of the meaning of the additional channels.
-    TIFFGetField(TiffFile, TIFFTAG_SAMPLESPERPIXEL, &SamplesPerPixel);
-    m_Desc.NumComponents = SamplesPerPixel;
-
-    Uint16 BitsPerSample = 0;
-    TIFFGetField(TiffFile, TIFFTAG_BITSPERSAMPLE, &BitsPerSample);
-
-    Uint16 SampleFormat = 0;
-    TIFFGetField(TiffFile, TIFFTAG_SAMPLEFORMAT, &SampleFormat);
-    if (SampleFormat == 0)
-        SampleFormat = SAMPLEFORMAT_UINT;
-
-    switch (SampleFormat)
-    {
-        case SAMPLEFORMAT_UINT:
-            switch (BitsPerSample)
-            {
-                case 8: m_Desc.ComponentType = VT_UINT8; break;
-                case 16: m_Desc.ComponentType = VT_UINT16; break;
-                case 32: m_Desc.ComponentType = VT_UINT32; break;
-                default: LOG_ERROR_AND_THROW(BitsPerSample, " is not a valid UINT component bit depth. Only 8, 16 and 32 are allowed");
-            }
-            break;
-
-        case SAMPLEFORMAT_INT:
-            switch (BitsPerSample)
-            {
-                case 8: m_Desc.ComponentType = VT_INT8; break;
-                case 16: m_Desc.ComponentType = VT_INT16; break;
-                case 32: m_Desc.ComponentType = VT_INT32; break;
-                default: LOG_ERROR_AND_THROW(BitsPerSample, " is not a valid INT component bit depth. Only 8, 16 and 32 are allowed");
-            }
-            break;
+    auto pDecoder = ImageRowDecoder::Create(pFileData, IMAGE_FILE_FORMAT_TIFF);
+    if (!pDecoder)
+        LOG_ERROR_AND_THROW("Failed to open tiff image");
 
-        case SAMPLEFORMAT_IEEEFP:
-            switch (BitsPerSample)
-            {
-                case 16: m_Desc.ComponentType = VT_FLOAT16; break;
-                case 32: m_Desc.ComponentType = VT_FLOAT32; break;
-                default: LOG_ERROR_AND_THROW(BitsPerSample, " is not a valid FLOAT component bit depth. Only 16 and 32 are allowed");
-            }
-            break;
-
-        case SAMPLEFORMAT_VOID:
-            LOG_ERROR_AND_THROW("Untyped tif images are not supported");
-            break;
-
-        case SAMPLEFORMAT_COMPLEXINT:
-            LOG_ERROR_AND_THROW("Complex int tif images are not supported");
-            break;
-
-        case SAMPLEFORMAT_COMPLEXIEEEFP:
-            LOG_ERROR_AND_THROW("Complex floating point tif images are not supported");
-            break;
-
-        default:
-            LOG_ERROR_AND_THROW("Unknown sample format: ", Uint32{SampleFormat});
-    }
-
-    auto ScanlineSize = TIFFScanlineSize(TiffFile);
-    m_Desc.RowStride  = Align(static_cast<Uint32>(ScanlineSize), 4u);
+    m_Desc = pDecoder->GetDesc();
     m_pData->Resize(size_t{m_Desc.Height} * size_t{m_Desc.RowStride});
-    auto* pDataPtr = reinterpret_cast<Uint8*>(m_pData->GetDataPtr());
-    for (Uint32 row = 0; row < m_Desc.Height; row++, pDataPtr += m_Desc.RowStride)
-    {
-        TIFFReadScanline(TiffFile, pDataPtr, row);
-    }
-    TIFFClose(TiffFile);
+    if (pDecoder->DecodeRows(m_pData->GetDataPtr(), m_Desc.RowStride, m_Desc.Height) != m_Desc.Height)
+        LOG_ERROR_MESSAGE("Failed to decode tiff image");
 }
 
 
@@ -298,6 +145,25 @@ std::vector<Uint8> Image::ConvertImageData(Uint32         Width,
 
     std::vector<Uint8> ConvertedData(DstFmtAttribs.ComponentSize * NumDstComponents * Width * Height);
 
+    const auto DstStride = size_t{Width} * NumDstComponents;
+    if (SrcFmtAttribs.NumComponents == 4 && (NumDstComponents == 4 || NumDstComponents == 3))
+    {
+        // Four-channel formats only differ by the order of red and blue channels
+        const bool SwapRB = SrcOffsets[0] != DstOffsets[0];
+        for (Uint32 j = 0; j < Height; ++j)
+        {
+            const auto* pSrcRow = pData + size_t{j} * Stride;
+            auto*       pDstRow = ConvertedData.data() + j * DstStride;
+            if (NumDstComponents == 3)
+                PackRGBA8ToRGB8(pSrcRow, pDstRow, Width, SwapRB);
+            else if (SwapRB)
+                SwapRB8(pSrcRow, pDstRow, Width);
+            else
+                memcpy(pDstRow, pSrcRow, DstStride);
+        }
+        return ConvertedData;
+    }
+
     for (Uint32 j = 0; j < Height; ++j)
     {
         for (Uint32 i = 0; i < Width; ++i)
@@ -379,6 +245,22 @@ IMAGE_FILE_FORMAT Image::GetFileFormat(const Uint8* pData, size_t Size)
 }
 
 
+bool ReadFileData(const Char* FilePath, IDataBlob** ppFileData)
+{
+    MappedFileDataBlob::Create(FilePath, ppFileData);
+    if (*ppFileData != nullptr)
+        return true;
+
+    RefCntAutoPtr<BasicFileStream> pFileStream(MakeNewRCObj<BasicFileStream>()(FilePath, EFileAccessMode::Read));
+    if (!pFileStream->IsValid())
+        return false;
+
+    RefCntAutoPtr<IDataBlob> pFileData(MakeNewRCObj<DataBlobImpl>()(0));
+    pFileStream->ReadBlob(pFileData);
+    *ppFileData = pFileData.Detach();
+    return true;
+}
+
 IMAGE_FILE_FORMAT CreateImageFromFile(const Char* FilePath,
                                       Image**     ppImage,
                                       IDataBlob** ppRawData)
@@ -386,13 +268,10 @@ IMAGE_FILE_FORMAT CreateImageFromFile(const Char* FilePath,
     auto ImgFileFormat = IMAGE_FILE_FORMAT_UNKNOWN;
     try
     {
-        RefCntAutoPtr<BasicFileStream> pFileStream(MakeNewRCObj<BasicFileStream>()(FilePath, EFileAccessMode::Read));
-        if (!pFileStream->IsValid())
+        RefCntAutoPtr<IDataBlob> pFileData;
+        if (!ReadFileData(FilePath, &pFileData))
             LOG_ERROR_AND_THROW("Failed to open image file \"", FilePath, '\"');
 
-        RefCntAutoPtr<IDataBlob> pFileData(MakeNewRCObj<DataBlobImpl>()(0));
-        pFileStream->ReadBlob(pFileData);
-
         ImgFileFormat = Image::GetFileFormat(reinterpret_cast<Uint8*>(pFileData->GetDataPtr()), pFileData->GetSize());
         if (ImgFileFormat == IMAGE_FILE_FORMAT_UNKNOWN)
         {
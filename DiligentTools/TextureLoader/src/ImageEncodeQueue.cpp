@@ -0,0 +1,187 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+#include "pch.h"
+
+#include "ImageEncodeQueue.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#include "GraphicsAccessories.hpp"
+#include "RefCntAutoPtr.hpp"
+#include "DebugUtilities.hpp"
+#include "Errors.hpp"
+#include "ThreadPool.hpp"
+
+namespace Diligent
+{
+
+ImageEncodeQueue::ImageEncodeQueue(const CreateInfo& CI) :
+    m_ThreadPool{CI.pThreadPool != nullptr ? *CI.pThreadPool : ThreadPool::GetShared()},
+    m_MaxImagesInFlight{CI.MaxImagesInFlight}
+{
+    if (m_MaxImagesInFlight == 0)
+        m_MaxImagesInFlight = std::max(m_ThreadPool.GetNumWorkerThreads(), 1u) * 2;
+}
+
+ImageEncodeQueue::~ImageEncodeQueue()
+{
+    WaitForIdle();
+}
+
+bool ImageEncodeQueue::Enqueue(const Image::EncodeInfo& Info, CallbackType Callback)
+{
+    return EnqueueImpl(Info, std::move(Callback), true);
+}
+
+bool ImageEncodeQueue::TryEnqueue(const Image::EncodeInfo& Info, CallbackType Callback)
+{
+    return EnqueueImpl(Info, std::move(Callback), false);
+}
+
+bool ImageEncodeQueue::EnqueueImpl(const Image::EncodeInfo& Info, CallbackType Callback, bool Wait)
+{
+    if (Info.pData == nullptr || Info.Width == 0 || Info.Height == 0)
+    {
+        LOG_ERROR_MESSAGE("Image data must not be null and image dimensions must not be zero");
+        return false;
+    }
+    if (Info.FileFormat != IMAGE_FILE_FORMAT_PNG && Info.FileFormat != IMAGE_FILE_FORMAT_JPEG)
+    {
+        LOG_ERROR_MESSAGE("Only PNG and JPEG images can be encoded");
+        return false;
+    }
+
+    const auto& FmtAttribs = GetTextureFormatAttribs(Info.TexFormat);
+    if (FmtAttribs.ComponentType == COMPONENT_TYPE_COMPRESSED || FmtAttribs.ComponentSize != 1)
+    {
+        LOG_ERROR_MESSAGE("Unable to encode image of format ", FmtAttribs.Name, ": only 8-bit uncompressed formats are supported");
+        return false;
+    }
+
+    const size_t RowSize = size_t{Info.Width} * FmtAttribs.NumComponents;
+    if (Info.Stride < RowSize)
+    {
+        LOG_ERROR_MESSAGE("Image stride (", Info.Stride, ") is smaller than the row size (", RowSize, ")");
+        return false;
+    }
+
+    std::unique_ptr<EncodeJob> pJob{new EncodeJob{}};
+    {
+        std::unique_lock<std::mutex> Lock{m_Mtx};
+        if (m_NumImagesInFlight >= m_MaxImagesInFlight)
+        {
+            if (!Wait)
+                return false;
+
+            const auto StallStart = std::chrono::high_resolution_clock::now();
+            m_SlotCondVar.wait(Lock, [&]() { return m_NumImagesInFlight < m_MaxImagesInFlight; });
+            const auto StallEnd = std::chrono::high_resolution_clock::now();
+
+            ++m_Stats.NumStalls;
+            m_Stats.StallTime += std::chrono::duration_cast<std::chrono::duration<double>>(StallEnd - StallStart).count();
+        }
+        // Reserve the slot before releasing the lock so that the limit is never exceeded
+        ++m_NumImagesInFlight;
+
+        if (!m_FreeBuffers.empty())
+        {
+            pJob->Pixels = std::move(m_FreeBuffers.back());
+            m_FreeBuffers.pop_back();
+        }
+    }
+
+    // Copy the pixels without holding the lock to let the worker threads proceed
+    pJob->Pixels.resize(RowSize * Info.Height);
+    for (Uint32 row = 0; row < Info.Height; ++row)
+    {
+        memcpy(&pJob->Pixels[RowSize * row], reinterpret_cast<const Uint8*>(Info.pData) + size_t{Info.Stride} * row, RowSize);
+    }
+
+    pJob->Info        = Info;
+    pJob->Info.pData  = pJob->Pixels.data();
+    pJob->Info.Stride = static_cast<Uint32>(RowSize);
+    pJob->Callback    = std::move(Callback);
+
+    {
+        std::lock_guard<std::mutex> Lock{m_Mtx};
+        m_QueuedJobs.emplace_back(std::move(pJob));
+    }
+    m_ThreadPool.EnqueueTask([this]() { EncodeNextImage(); });
+
+    return true;
+}
+
+void ImageEncodeQueue::EncodeNextImage()
+{
+    std::unique_ptr<EncodeJob> pJob;
+    {
+        std::lock_guard<std::mutex> Lock{m_Mtx};
+        VERIFY_EXPR(!m_QueuedJobs.empty());
+        pJob = std::move(m_QueuedJobs.front());
+        m_QueuedJobs.pop_front();
+    }
+
+    RefCntAutoPtr<IDataBlob> pEncodedData;
+    Image::Encode(pJob->Info, &pEncodedData);
+    // Image::Encode() logs the error and returns an empty blob if the image could not be encoded
+    const bool Succeeded = pEncodedData && pEncodedData->GetSize() > 0;
+
+    if (pJob->Callback)
+        pJob->Callback(Succeeded ? pEncodedData.RawPtr() : nullptr);
+
+    std::lock_guard<std::mutex> Lock{m_Mtx};
+    if (Succeeded)
+        ++m_Stats.NumImagesEncoded;
+    else
+        ++m_Stats.NumFailures;
+
+    m_FreeBuffers.emplace_back(std::move(pJob->Pixels));
+    VERIFY_EXPR(m_NumImagesInFlight > 0);
+    --m_NumImagesInFlight;
+    // Wake up both Enqueue() and WaitForIdle(). The notification is sent under the lock because
+    // the queue may be destroyed as soon as WaitForIdle() observes that no images are in flight.
+    m_SlotCondVar.notify_all();
+}
+
+void ImageEncodeQueue::WaitForIdle()
+{
+    std::unique_lock<std::mutex> Lock{m_Mtx};
+    m_SlotCondVar.wait(Lock, [&]() { return m_NumImagesInFlight == 0; });
+}
+
+ImageEncodeQueue::Statistics ImageEncodeQueue::GetStatistics() const
+{
+    std::lock_guard<std::mutex> Lock{m_Mtx};
+
+    auto Stats              = m_Stats;
+    Stats.NumImagesInFlight = m_NumImagesInFlight;
+    return Stats;
+}
+
+} // namespace Diligent
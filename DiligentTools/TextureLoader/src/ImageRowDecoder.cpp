@@ -0,0 +1,549 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+#include "pch.h"
+
+#include "ImageRowDecoder.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "tiffio.h"
+#include "PNGCodec.h"
+
+#include "Errors.hpp"
+#include "DebugUtilities.hpp"
+#include "Align.hpp"
+#include "GraphicsAccessories.hpp"
+#include "MipGenerator.hpp"
+#include "PixelConversion.hpp"
+#include "ThreadPool.hpp"
+#include "TextureLoaderInternal.hpp"
+
+namespace Diligent
+{
+
+namespace
+{
+
+class TIFFClientOpenWrapper
+{
+public:
+    explicit TIFFClientOpenWrapper(IDataBlob* pData) noexcept :
+        m_Offset{0},
+        m_Size{pData->GetSize()},
+        m_pData{pData}
+    {
+    }
+
+    static tmsize_t TIFFReadProc(thandle_t pClientData, void* pBuffer, tmsize_t Size)
+    {
+        auto* pThis = reinterpret_cast<TIFFClientOpenWrapper*>(pClientData);
+        if (pThis->m_Offset >= pThis->m_Size)
+            return 0;
+        Size          = std::min(Size, static_cast<tmsize_t>(pThis->m_Size - pThis->m_Offset));
+        auto* pSrcPtr = reinterpret_cast<Uint8*>(pThis->m_pData->GetDataPtr()) + pThis->m_Offset;
+        memcpy(pBuffer, pSrcPtr, Size);
+        pThis->m_Offset += Size;
+        return Size;
+    }
+
+    static tmsize_t TIFFWriteProc(thandle_t pClientData, void* pBuffer, tmsize_t Size)
+    {
+        auto* pThis = reinterpret_cast<TIFFClientOpenWrapper*>(pClientData);
+        if (pThis->m_Offset + Size > pThis->m_Size)
+        {
+            pThis->m_Size = pThis->m_Offset + Size;
+            pThis->m_pData->Resize(pThis->m_Size);
+        }
+        auto* pDstPtr = reinterpret_cast<Uint8*>(pThis->m_pData->GetDataPtr()) + pThis->m_Offset;
+        memcpy(pDstPtr, pBuffer, Size);
+        pThis->m_Offset += Size;
+        return Size;
+    }
+
+    static toff_t TIFFSeekProc(thandle_t pClientData, toff_t Offset, int Whence)
+    {
+        auto* pThis = reinterpret_cast<TIFFClientOpenWrapper*>(pClientData);
+        switch (Whence)
+        {
+            case SEEK_SET: pThis->m_Offset = static_cast<size_t>(Offset); break;
+            case SEEK_CUR: pThis->m_Offset += static_cast<size_t>(Offset); break;
+            case SEEK_END: pThis->m_Offset = pThis->m_Size + static_cast<size_t>(Offset); break;
+            default: UNEXPECTED("Unexpected whence");
+        }
+
+        return pThis->m_Offset;
+    }
+
+    static int TIFFCloseProc(thandle_t pClientData)
+    {
+        auto* pThis = reinterpret_cast<TIFFClientOpenWrapper*>(pClientData);
+        pThis->m_pData.Release();
+        pThis->m_Size   = 0;
+        pThis->m_Offset = 0;
+        return 0;
+    }
+
+    static toff_t TIFFSizeProc(thandle_t pClientData)
+    {
+        auto* pThis = reinterpret_cast<TIFFClientOpenWrapper*>(pClientData);
+        return pThis->m_Size;
+    }
+
+    // The data blob is already in memory, so it is exposed to libtiff as a mapped file.
+    // libtiff then references strip data in the blob instead of reading it into its own buffer.
+    static int TIFFMapFileProc(thandle_t pClientData, void** base, toff_t* size)
+    {
+        auto* pThis = reinterpret_cast<TIFFClientOpenWrapper*>(pClientData);
+        if (!pThis->m_pData)
+            return 0;
+
+        *base = pThis->m_pData->GetDataPtr();
+        *size = pThis->m_Size;
+        return 1;
+    }
+
+    static void TIFFUnmapFileProc(thandle_t pClientData, void* base, toff_t size)
+    {
+        // The data is owned by the data blob
+    }
+
+private:
+    size_t                   m_Offset;
+    size_t                   m_Size;
+    RefCntAutoPtr<IDataBlob> m_pData;
+};
+
+
+class TIFFImageRowDecoder final : public ImageRowDecoder
+{
+public:
+    explicit TIFFImageRowDecoder(IDataBlob* pFileData) :
+        m_TiffClientOpenWrpr{pFileData}
+    {
+        // File mapping is enabled as 'm' is not in the mode string
+        m_TiffFile = TIFFClientOpen("", "r", &m_TiffClientOpenWrpr,
+                                    TIFFClientOpenWrapper::TIFFReadProc,
+                                    TIFFClientOpenWrapper::TIFFWriteProc,
+                                    TIFFClientOpenWrapper::TIFFSeekProc,
+                                    TIFFClientOpenWrapper::TIFFCloseProc,
+                                    TIFFClientOpenWrapper::TIFFSizeProc,
+                                    TIFFClientOpenWrapper::TIFFMapFileProc,
+                                    TIFFClientOpenWrapper::TIFFUnmapFileProc);
+        if (m_TiffFile == nullptr)
+            LOG_ERROR_AND_THROW("Failed to open tiff image");
+
+        try
+        {
+            ReadDesc();
+        }
+        catch (...)
+        {
+            TIFFClose(m_TiffFile);
+            throw;
+        }
+    }
+
+    ~TIFFImageRowDecoder()
+    {
+        TIFFClose(m_TiffFile);
+    }
+
+private:
+    void ReadDesc()
+    {
+        TIFFGetField(m_TiffFile, TIFFTAG_IMAGEWIDTH, &m_Desc.Width);
+        TIFFGetField(m_TiffFile, TIFFTAG_IMAGELENGTH, &m_Desc.Height);
+
+        Uint16 SamplesPerPixel = 0;
+        // SamplesPerPixel is usually 1 for bilevel, grayscale, and palette-color images.
+        // SamplesPerPixel is usually 3 for RGB images. If this value is higher, ExtraSamples
+        // should give an indication of the meaning of the additional channels.
+        TIFFGetField(m_TiffFile, TIFFTAG_SAMPLESPERPIXEL, &SamplesPerPixel);
+        m_Desc.NumComponents = SamplesPerPixel;
+
+        Uint16 BitsPerSample = 0;
+        TIFFGetField(m_TiffFile, TIFFTAG_BITSPERSAMPLE, &BitsPerSample);
+
+        Uint16 SampleFormat = 0;
+        TIFFGetField(m_TiffFile, TIFFTAG_SAMPLEFORMAT, &SampleFormat);
+        if (SampleFormat == 0)
+            SampleFormat = SAMPLEFORMAT_UINT;
+
+        switch (SampleFormat)
+        {
+            case SAMPLEFORMAT_UINT:
+                switch (BitsPerSample)
+                {
+                    case 8: m_Desc.ComponentType = VT_UINT8; break;
+                    case 16: m_Desc.ComponentType = VT_UINT16; break;
+                    case 32: m_Desc.ComponentType = VT_UINT32; break;
+                    default: LOG_ERROR_AND_THROW(BitsPerSample, " is not a valid UINT component bit depth. Only 8, 16 and 32 are allowed");
+                }
+                break;
+
+            case SAMPLEFORMAT_INT:
+                switch (BitsPerSample)
+                {
+                    case 8: m_Desc.ComponentType = VT_INT8; break;
+                    case 16: m_Desc.ComponentType = VT_INT16; break;
+                    case 32: m_Desc.ComponentType = VT_INT32; break;
+                    default: LOG_ERROR_AND_THROW(BitsPerSample, " is not a valid INT component bit depth. Only 8, 16 and 32 are allowed");
+                }
+                break;
+
+            case SAMPLEFORMAT_IEEEFP:
+                switch (BitsPerSample)
+                {
+                    case 16: m_Desc.ComponentType = VT_FLOAT16; break;
+                    case 32: m_Desc.ComponentType = VT_FLOAT32; break;
+                    default: LOG_ERROR_AND_THROW(BitsPerSample, " is not a valid FLOAT component bit depth. Only 16 and 32 are allowed");
+                }
+                break;
+
+            case SAMPLEFORMAT_VOID:
+                LOG_ERROR_AND_THROW("Untyped tif images are not supported");
+                break;
+
+            case SAMPLEFORMAT_COMPLEXINT:
+                LOG_ERROR_AND_THROW("Complex int tif images are not supported");
+                break;
+
+            case SAMPLEFORMAT_COMPLEXIEEEFP:
+                LOG_ERROR_AND_THROW("Complex floating point tif images are not supported");
+                break;
+
+            default:
+                LOG_ERROR_AND_THROW("Unknown sample format: ", Uint32{SampleFormat});
+        }
+
+        m_Desc.RowStride = Align(static_cast<Uint32>(TIFFScanlineSize(m_TiffFile)), 4u);
+    }
+
+    virtual bool DecodeRowsImpl(Uint8* pDstRows, Uint32 DstStride, Uint32 NumRows) override final
+    {
+        const auto FirstRow = GetNextRow();
+        for (Uint32 row = 0; row < NumRows; ++row)
+        {
+            if (TIFFReadScanline(m_TiffFile, pDstRows + size_t{row} * DstStride, FirstRow + row) < 0)
+                return false;
+        }
+        return true;
+    }
+
+    TIFFClientOpenWrapper m_TiffClientOpenWrpr;
+    TIFF*                 m_TiffFile = nullptr;
+};
+
+
+class PNGImageRowDecoder final : public ImageRowDecoder
+{
+public:
+    explicit PNGImageRowDecoder(IDataBlob* pFileData) :
+        m_pFileData{pFileData}
+    {
+        if (CreatePngRowDecoder(pFileData, &m_Desc, &m_pDecoder) != DECODE_PNG_RESULT_OK)
+            LOG_ERROR_AND_THROW("Failed to read png image header");
+    }
+
+    ~PNGImageRowDecoder()
+    {
+        DestroyPngRowDecoder(m_pDecoder);
+    }
+
+private:
+    virtual bool DecodeRowsImpl(Uint8* pDstRows, Uint32 DstStride, Uint32 NumRows) override final
+    {
+        return DecodePngRows(m_pDecoder, pDstRows, DstStride, NumRows) == DECODE_PNG_RESULT_OK;
+    }
+
+    RefCntAutoPtr<IDataBlob> m_pFileData;
+    PNGRowDecoder*           m_pDecoder = nullptr;
+};
+
+} // namespace
+
+
+std::unique_ptr<ImageRowDecoder> ImageRowDecoder::Create(IDataBlob* pFileData, IMAGE_FILE_FORMAT Format)
+{
+    DEV_CHECK_ERR(pFileData != nullptr, "File data must not be null");
+
+    if (Format == IMAGE_FILE_FORMAT_UNKNOWN)
+        Format = Image::GetFileFormat(reinterpret_cast<const Uint8*>(pFileData->GetDataPtr()), pFileData->GetSize());
+
+    try
+    {
+        switch (Format)
+        {
+            case IMAGE_FILE_FORMAT_PNG: return std::unique_ptr<ImageRowDecoder>{new PNGImageRowDecoder{pFileData}};
+            case IMAGE_FILE_FORMAT_TIFF: return std::unique_ptr<ImageRowDecoder>{new TIFFImageRowDecoder{pFileData}};
+
+            default:
+                LOG_ERROR_MESSAGE("Only PNG and TIFF images can be decoded row by row");
+                return nullptr;
+        }
+    }
+    catch (const std::exception&)
+    {
+        return nullptr;
+    }
+}
+
+std::unique_ptr<ImageRowDecoder> ImageRowDecoder::CreateFromFile(const Char* FilePath)
+{
+    RefCntAutoPtr<IDataBlob> pFileData;
+    if (!ReadFileData(FilePath, &pFileData))
+    {
+        LOG_ERROR_MESSAGE("Failed to open image file ", FilePath);
+        return nullptr;
+    }
+
+    return Create(pFileData);
+}
+
+Uint32 ImageRowDecoder::DecodeRows(void* pDstRows, Uint32 DstStride, Uint32 NumRows)
+{
+    NumRows = std::min(NumRows, m_Desc.Height - m_NextRow);
+    if (m_Failed || NumRows == 0)
+        return 0;
+
+    DEV_CHECK_ERR(pDstRows != nullptr, "Destination must not be null");
+
+    if (!DecodeRowsImpl(reinterpret_cast<Uint8*>(pDstRows), DstStride, NumRows))
+    {
+        LOG_ERROR_MESSAGE("Failed to decode rows ", m_NextRow, " to ", m_NextRow + NumRows - 1, " of the image");
+        m_Failed = true;
+        return 0;
+    }
+
+    m_NextRow += NumRows;
+    return NumRows;
+}
+
+
+bool DecodeImageMipChain(ImageRowDecoder& Decoder, const DecodeImageMipChainAttribs& Attribs)
+{
+    DEV_CHECK_ERR(Attribs.pDstMips != nullptr && Attribs.MipLevels > 0, "Destination mip levels must not be empty");
+
+    const auto& ImgDesc      = Decoder.GetDesc();
+    const auto  ChannelDepth = GetValueSize(ImgDesc.ComponentType) * 8;
+    if (ImgDesc.ComponentType != VT_UINT8 && ImgDesc.ComponentType != VT_UINT16)
+    {
+        LOG_ERROR_MESSAGE("Only images with 8- and 16-bit unsigned channels are supported");
+        return false;
+    }
+
+    const Uint32 NumComponents = ImgDesc.NumComponents == 3 ? 4 : ImgDesc.NumComponents;
+    if (NumComponents != 1 && NumComponents != 2 && NumComponents != 4)
+    {
+        LOG_ERROR_MESSAGE("Unexpected number of color channels (", ImgDesc.NumComponents, ")");
+        return false;
+    }
+    const auto PixelSize = NumComponents * ChannelDepth / 8;
+
+    const auto RowsPerBand = std::max(Attribs.RowsPerBand, 1u);
+
+    std::vector<Uint8> DecodedBand(size_t{RowsPerBand} * ImgDesc.RowStride);
+    std::vector<Uint8> ExpandedBand;
+    Uint32             ExpandedStride = 0;
+    if (ImgDesc.NumComponents == 3)
+    {
+        ExpandedStride = Align(ImgDesc.Width * PixelSize, 4u);
+        ExpandedBand.resize(size_t{RowsPerBand} * ExpandedStride);
+    }
+
+    // Only the box filter can be applied to bands of rows as they are decoded
+    const auto ComputeMipsAfterDecoding = Attribs.GenerateMips && Attribs.MipLevels > 1 &&
+        (Attribs.MipFilter != MIP_FILTER_BOX || (Attribs.AlphaCutoff > 0 && NumComponents == 4));
+
+    StreamingMipGenerator::CreateInfo MipGenCI;
+    MipGenCI.ComponentType = ImgDesc.ComponentType;
+    MipGenCI.NumChannels   = NumComponents;
+    MipGenCI.IsSRGB        = Attribs.IsSRGB && ImgDesc.NumComponents >= 3 && ChannelDepth == 8;
+    MipGenCI.Width         = ImgDesc.Width;
+    MipGenCI.Height        = ImgDesc.Height;
+    MipGenCI.MipLevels     = Attribs.GenerateMips && !ComputeMipsAfterDecoding ? Attribs.MipLevels : 1;
+    MipGenCI.pThreadPool   = Attribs.pThreadPool;
+
+    StreamingMipGenerator MipGen{
+        MipGenCI,
+        [&](Uint32 Mip, Uint32 FirstRow, Uint32 NumRows, const void* pData, Uint32 Stride) {
+            const auto& Dst     = Attribs.pDstMips[Mip];
+            const auto  RowSize = std::max(ImgDesc.Width >> Mip, 1u) * PixelSize;
+            for (Uint32 row = 0; row < NumRows; ++row)
+            {
+                memcpy(reinterpret_cast<Uint8*>(Dst.pData) + size_t{FirstRow + row} * Dst.Stride,
+                       reinterpret_cast<const Uint8*>(pData) + size_t{row} * Stride,
+                       RowSize);
+            }
+        } //
+    };
+    DEV_CHECK_ERR(!Attribs.GenerateMips || ComputeMipsAfterDecoding || MipGen.GetMipLevels() == Attribs.MipLevels,
+                  "The number of mip levels is inconsistent with the image size");
+
+    for (Uint32 mip = ComputeMipsAfterDecoding ? Attribs.MipLevels : MipGen.GetMipLevels(); mip < Attribs.MipLevels; ++mip)
+    {
+        const auto& Dst = Attribs.pDstMips[mip];
+        memset(Dst.pData, 0, size_t{Dst.Stride} * std::max(ImgDesc.Height >> mip, 1u));
+    }
+
+    while (Decoder.GetNextRow() < ImgDesc.Height)
+    {
+        const auto NumRows = Decoder.DecodeRows(DecodedBand.data(), ImgDesc.RowStride, RowsPerBand);
+        if (NumRows == 0)
+            return false;
+
+        if (ImgDesc.NumComponents == 3)
+        {
+            for (Uint32 row = 0; row < NumRows; ++row)
+            {
+                const auto* pSrcRow = DecodedBand.data() + size_t{row} * ImgDesc.RowStride;
+                auto*       pDstRow = ExpandedBand.data() + size_t{row} * ExpandedStride;
+                if (ChannelDepth == 8)
+                    ExpandRGB8ToRGBA8(pSrcRow, pDstRow, ImgDesc.Width);
+                else
+                    ExpandRGB16ToRGBA16(reinterpret_cast<const Uint16*>(pSrcRow), reinterpret_cast<Uint16*>(pDstRow), ImgDesc.Width);
+            }
+            MipGen.AddRows(ExpandedBand.data(), ExpandedStride, NumRows);
+        }
+        else
+        {
+            MipGen.AddRows(DecodedBand.data(), ImgDesc.RowStride, NumRows);
+        }
+    }
+
+    if (ComputeMipsAfterDecoding)
+    {
+        ComputeMipChainAttribs MipChainAttribs;
+        MipChainAttribs.ComponentType = ImgDesc.ComponentType;
+        MipChainAttribs.NumChannels   = NumComponents;
+        MipChainAttribs.IsSRGB        = MipGenCI.IsSRGB;
+        MipChainAttribs.Filter        = Attribs.MipFilter;
+        MipChainAttribs.AlphaCutoff   = Attribs.AlphaCutoff;
+        MipChainAttribs.Width         = ImgDesc.Width;
+        MipChainAttribs.Height        = ImgDesc.Height;
+        MipChainAttribs.pMips         = Attribs.pDstMips;
+        MipChainAttribs.MipLevels     = Attribs.MipLevels;
+        MipChainAttribs.pThreadPool   = Attribs.pThreadPool;
+        ComputeMipChain(MipChainAttribs);
+    }
+
+    return true;
+}
+
+
+void CreateTextureFromImageRows(ImageRowDecoder&       Decoder,
+                                const TextureLoadInfo& TexLoadInfo,
+                                IRenderDevice*         pDevice,
+                                IDeviceContext*        pContext,
+                                ITextureUploader*      pUploader,
+                                ITexture**             ppTexture)
+{
+    DEV_CHECK_ERR(pDevice != nullptr, "Render device must not be null");
+    DEV_CHECK_ERR(pUploader != nullptr || pContext != nullptr, "Device context must not be null when no texture uploader is provided");
+    DEV_CHECK_ERR(ppTexture != nullptr && *ppTexture == nullptr, "Texture pointer must not be null and must not point to an existing texture");
+    DEV_CHECK_ERR(Decoder.GetNextRow() == 0, "Rows of the image have already been decoded");
+
+    const auto& ImgDesc = Decoder.GetDesc();
+
+    TextureDesc TexDesc;
+    TexDesc.Name      = TexLoadInfo.Name;
+    TexDesc.Type      = RESOURCE_DIM_TEX_2D;
+    TexDesc.Width     = ImgDesc.Width;
+    TexDesc.Height    = ImgDesc.Height;
+    TexDesc.MipLevels = ComputeMipLevelsCount(TexDesc.Width, TexDesc.Height);
+    if (TexLoadInfo.MipLevels > 0)
+        TexDesc.MipLevels = std::min(TexDesc.MipLevels, TexLoadInfo.MipLevels);
+    // Immutable textures can't be initialized by a copy
+    TexDesc.Usage          = TexLoadInfo.Usage == USAGE_IMMUTABLE ? USAGE_DEFAULT : TexLoadInfo.Usage;
+    TexDesc.BindFlags      = TexLoadInfo.BindFlags;
+    TexDesc.Format         = GetImageTextureFormat(ImgDesc, TexLoadInfo);
+    TexDesc.CPUAccessFlags = TexLoadInfo.CPUAccessFlags;
+
+    if (TexLoadInfo.CompressedFormat != TEX_FORMAT_UNKNOWN)
+    {
+        LOG_WARNING_MESSAGE("Block compression is not supported when textures are created from image rows. Texture '",
+                            (TexDesc.Name != nullptr ? TexDesc.Name : ""), "' will not be compressed.");
+    }
+
+    RefCntAutoPtr<ITextureUploader> pTmpUploader;
+    if (pUploader == nullptr)
+    {
+        CreateTextureUploader(pDevice, TextureUploaderDesc{}, &pTmpUploader);
+        if (!pTmpUploader)
+        {
+            LOG_ERROR_MESSAGE("Failed to create texture uploader");
+            return;
+        }
+        pUploader = pTmpUploader;
+    }
+
+    RefCntAutoPtr<ITexture> pTexture;
+    pDevice->CreateTexture(TexDesc, nullptr, &pTexture);
+    if (!pTexture)
+        return;
+
+    UploadBufferDesc UploadDesc;
+    UploadDesc.Width     = TexDesc.Width;
+    UploadDesc.Height    = TexDesc.Height;
+    UploadDesc.MipLevels = TexDesc.MipLevels;
+    UploadDesc.Format    = TexDesc.Format;
+
+    RefCntAutoPtr<IUploadBuffer> pUploadBuffer;
+    pUploader->AllocateUploadBuffer(pContext, UploadDesc, &pUploadBuffer);
+    if (!pUploadBuffer)
+    {
+        LOG_ERROR_MESSAGE("Failed to allocate upload buffer for texture '", (TexDesc.Name != nullptr ? TexDesc.Name : ""), "'");
+        return;
+    }
+
+    std::vector<MappedTextureSubresource> DstMips(TexDesc.MipLevels);
+    for (Uint32 mip = 0; mip < TexDesc.MipLevels; ++mip)
+        DstMips[mip] = pUploadBuffer->GetMappedData(mip, 0);
+
+    DecodeImageMipChainAttribs DecodeAttribs;
+    DecodeAttribs.pDstMips     = DstMips.data();
+    DecodeAttribs.MipLevels    = TexDesc.MipLevels;
+    DecodeAttribs.GenerateMips = TexLoadInfo.GenerateMips;
+    DecodeAttribs.IsSRGB       = TexLoadInfo.IsSRGB;
+    DecodeAttribs.MipFilter    = TexLoadInfo.MipFilter;
+    DecodeAttribs.AlphaCutoff  = TexLoadInfo.AlphaCutoff;
+    DecodeAttribs.pThreadPool  = &ThreadPool::GetShared();
+    if (!DecodeImageMipChain(Decoder, DecodeAttribs))
+    {
+        pUploader->RecycleBuffer(pUploadBuffer);
+        return;
+    }
+
+    pUploader->ScheduleGPUCopy(pContext, pTexture, 0, 0, pUploadBuffer);
+    pUploader->RecycleBuffer(pUploadBuffer);
+
+    *ppTexture = pTexture.Detach();
+}
+
+} // namespace Diligent
@@ -26,9 +26,11 @@
  */
 
 #include <algorithm>
+#include <cstring>
 #include <vector>
 
 #include "TextureLoader.h"
+#include "TextureLoaderInternal.hpp"
 #include "GraphicsAccessories.hpp"
 #include "Align.hpp"
 
@@ -51,6 +53,7 @@
 #define GL_RGB10_A2UI         0x906F
 #define GL_R11F_G11F_B10F     0x8C3A
 #define GL_RGBA8              0x8058
+#define GL_SRGB8_ALPHA8       0x8C43
 #define GL_RGBA8UI            0x8D7C
 #define GL_RGBA8_SNORM        0x8F97
 #define GL_RGBA8I             0x8D8E
@@ -81,6 +84,16 @@
 #define GL_RGB9_E5            0x8C3D
 
 
+#define GL_UNSIGNED_BYTE  0x1401
+#define GL_UNSIGNED_SHORT 0x1403
+#define GL_FLOAT          0x1406
+#define GL_HALF_FLOAT     0x140B
+
+#define GL_RED  0x1903
+#define GL_RG   0x8227
+#define GL_RGB  0x1907
+#define GL_RGBA 0x1908
+
 #define GL_COMPRESSED_RGB_S3TC_DXT1_EXT        0x83F0
 #define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT       0x83F1
 #define GL_COMPRESSED_RGBA_S3TC_DXT3_EXT       0x83F2
@@ -134,6 +147,7 @@ TEXTURE_FORMAT FindDiligentTextureFormat(std::uint32_t GLInternalFormat)
         case GL_R11F_G11F_B10F: return TEX_FORMAT_R11G11B10_FLOAT;
     
         case GL_RGBA8:          return TEX_FORMAT_RGBA8_UNORM;
+        case GL_SRGB8_ALPHA8:   return TEX_FORMAT_RGBA8_UNORM_SRGB;
         case GL_RGBA8UI:        return TEX_FORMAT_RGBA8_UINT;
         case GL_RGBA8_SNORM:    return TEX_FORMAT_RGBA8_SNORM;
         case GL_RGBA8I:         return TEX_FORMAT_RGBA8_SINT;
@@ -192,6 +206,59 @@ TEXTURE_FORMAT FindDiligentTextureFormat(std::uint32_t GLInternalFormat)
     }
 }
 
+struct GLFormatAttribs
+{
+    std::uint32_t GLType;
+    std::uint32_t GLTypeSize;
+    std::uint32_t GLFormat;
+    std::uint32_t GLInternalFormat;
+    std::uint32_t GLBaseInternalFormat;
+};
+
+// Returns the attributes of the KTX header for the formats supported by WriteTextureDataToKTX()
+bool FindGLFormatAttribs(TEXTURE_FORMAT Format, GLFormatAttribs& Attribs)
+{
+    switch (Format)
+    {
+        // clang-format off
+        case TEX_FORMAT_R8_UNORM:         Attribs = {GL_UNSIGNED_BYTE,  1, GL_RED,  GL_R8,            GL_RED};  return true;
+        case TEX_FORMAT_RG8_UNORM:        Attribs = {GL_UNSIGNED_BYTE,  1, GL_RG,   GL_RG8,           GL_RG};   return true;
+        case TEX_FORMAT_RGBA8_UNORM:      Attribs = {GL_UNSIGNED_BYTE,  1, GL_RGBA, GL_RGBA8,         GL_RGBA}; return true;
+        case TEX_FORMAT_RGBA8_UNORM_SRGB: Attribs = {GL_UNSIGNED_BYTE,  1, GL_RGBA, GL_SRGB8_ALPHA8,  GL_RGBA}; return true;
+        case TEX_FORMAT_R16_UNORM:        Attribs = {GL_UNSIGNED_SHORT, 2, GL_RED,  GL_R16,           GL_RED};  return true;
+        case TEX_FORMAT_RG16_UNORM:       Attribs = {GL_UNSIGNED_SHORT, 2, GL_RG,   GL_RG16,          GL_RG};   return true;
+        case TEX_FORMAT_RGBA16_UNORM:     Attribs = {GL_UNSIGNED_SHORT, 2, GL_RGBA, GL_RGBA16,        GL_RGBA}; return true;
+        case TEX_FORMAT_R16_FLOAT:        Attribs = {GL_HALF_FLOAT,     2, GL_RED,  GL_R16F,          GL_RED};  return true;
+        case TEX_FORMAT_RG16_FLOAT:       Attribs = {GL_HALF_FLOAT,     2, GL_RG,   GL_RG16F,         GL_RG};   return true;
+        case TEX_FORMAT_RGBA16_FLOAT:     Attribs = {GL_HALF_FLOAT,     2, GL_RGBA, GL_RGBA16F,       GL_RGBA}; return true;
+        case TEX_FORMAT_R32_FLOAT:        Attribs = {GL_FLOAT,          4, GL_RED,  GL_R32F,          GL_RED};  return true;
+        case TEX_FORMAT_RG32_FLOAT:       Attribs = {GL_FLOAT,          4, GL_RG,   GL_RG32F,         GL_RG};   return true;
+        case TEX_FORMAT_RGBA32_FLOAT:     Attribs = {GL_FLOAT,          4, GL_RGBA, GL_RGBA32F,       GL_RGBA}; return true;
+
+        case TEX_FORMAT_BC1_UNORM:        Attribs = {0, 1, 0, GL_COMPRESSED_RGB_S3TC_DXT1_EXT,        GL_RGB};  return true;
+        case TEX_FORMAT_BC1_UNORM_SRGB:   Attribs = {0, 1, 0, GL_COMPRESSED_SRGB_S3TC_DXT1_EXT,       GL_RGB};  return true;
+        case TEX_FORMAT_BC2_UNORM:        Attribs = {0, 1, 0, GL_COMPRESSED_RGBA_S3TC_DXT3_EXT,       GL_RGBA}; return true;
+        case TEX_FORMAT_BC2_UNORM_SRGB:   Attribs = {0, 1, 0, GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT, GL_RGBA}; return true;
+        case TEX_FORMAT_BC3_UNORM:        Attribs = {0, 1, 0, GL_COMPRESSED_RGBA_S3TC_DXT5_EXT,       GL_RGBA}; return true;
+        case TEX_FORMAT_BC3_UNORM_SRGB:   Attribs = {0, 1, 0, GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT, GL_RGBA}; return true;
+        case TEX_FORMAT_BC4_UNORM:        Attribs = {0, 1, 0, GL_COMPRESSED_RED_RGTC1,                GL_RED};  return true;
+        case TEX_FORMAT_BC5_UNORM:        Attribs = {0, 1, 0, GL_COMPRESSED_RG_RGTC2,                 GL_RG};   return true;
+        case TEX_FORMAT_BC7_UNORM:        Attribs = {0, 1, 0, GL_COMPRESSED_RGBA_BPTC_UNORM,          GL_RGBA}; return true;
+        case TEX_FORMAT_BC7_UNORM_SRGB:   Attribs = {0, 1, 0, GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM,    GL_RGBA}; return true;
+        // clang-format on
+        default:
+            return false;
+    }
+}
+
+// Rows of uncompressed KTX images are aligned to 4 bytes (GL_UNPACK_ALIGNMENT)
+Uint32 GetKTXRowStride(const TextureFormatAttribs& FmtAttribs, const MipLevelProperties& MipInfo)
+{
+    return FmtAttribs.ComponentType == COMPONENT_TYPE_COMPRESSED ? MipInfo.RowSize : Align(MipInfo.RowSize, 4u);
+}
+
+static constexpr Uint8 KTX10FileIdentifier[12] = {0xAB, 0x4B, 0x54, 0x58, 0x20, 0x31, 0x31, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A};
+
 } // namespace
 
 
@@ -212,14 +279,13 @@ struct KTX10Header
     std::uint32_t BytesOfKeyValueData;
 };
 
-void CreateTextureFromKTX(IDataBlob*             pKTXData,
-                          const TextureLoadInfo& TexLoadInfo,
-                          IRenderDevice*         pDevice,
-                          ITexture**             ppTexture)
+void GetKTXTextureData(const Uint8*                    pKTXData,
+                       size_t                          DataSize,
+                       const TextureLoadInfo&          TexLoadInfo,
+                       TextureDesc&                    TexDesc,
+                       std::vector<TextureSubResData>& SubresData)
 {
-    static constexpr Uint8 KTX10FileIdentifier[12] = {0xAB, 0x4B, 0x54, 0x58, 0x20, 0x31, 0x31, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A};
-    const Uint8*           pData                   = reinterpret_cast<const Uint8*>(pKTXData->GetDataPtr());
-    const auto             DataSize                = pKTXData->GetSize();
+    const Uint8* pData = pKTXData;
     if (DataSize >= 12 && memcmp(pData, KTX10FileIdentifier, sizeof(KTX10FileIdentifier)) == 0)
     {
         pData += sizeof(KTX10FileIdentifier);
@@ -228,18 +294,19 @@ void CreateTextureFromKTX(IDataBlob*             pKTXData,
         // Skip key value data
         pData += Header.BytesOfKeyValueData;
 
-        TextureDesc TexDesc;
+        TexDesc        = TextureDesc{};
         TexDesc.Name   = TexLoadInfo.Name;
         TexDesc.Format = FindDiligentTextureFormat(Header.GLInternalFormat);
         if (TexDesc.Format == TEX_FORMAT_UNKNOWN)
             LOG_ERROR_AND_THROW("Failed to find appropriate Diligent format for internal gl format ", Header.GLInternalFormat);
-        TexDesc.Width     = Header.Width;
-        TexDesc.Height    = std::max(Header.Height, 1u);
-        TexDesc.Depth     = std::max(Header.Depth, 1u);
-        TexDesc.MipLevels = std::max(Header.NumberOfMipmapLevels, 1u);
-        TexDesc.BindFlags = TexLoadInfo.BindFlags;
-        TexDesc.Usage     = TexLoadInfo.Usage;
-        auto NumFaces     = std::max(Header.NumberOfFaces, 1u);
+        TexDesc.Width          = Header.Width;
+        TexDesc.Height         = std::max(Header.Height, 1u);
+        TexDesc.Depth          = std::max(Header.Depth, 1u);
+        TexDesc.MipLevels      = std::max(Header.NumberOfMipmapLevels, 1u);
+        TexDesc.BindFlags      = TexLoadInfo.BindFlags;
+        TexDesc.Usage          = TexLoadInfo.Usage;
+        TexDesc.CPUAccessFlags = TexLoadInfo.CPUAccessFlags;
+        auto NumFaces          = std::max(Header.NumberOfFaces, 1u);
         if (NumFaces == 6)
         {
             TexDesc.ArraySize = std::max(Header.NumberOfArrayElements, 1u) * NumFaces;
@@ -259,24 +326,52 @@ void CreateTextureFromKTX(IDataBlob*             pKTXData,
             }
         }
 
-        auto                           ArraySize = (TexDesc.Type != RESOURCE_DIM_TEX_3D ? TexDesc.ArraySize : 1);
-        std::vector<TextureSubResData> SubresData(TexDesc.MipLevels * ArraySize);
+        // Skip the levels that are larger than the maximum dimension
+        Uint32 SkipMips = 0;
+        if (TexLoadInfo.MaxDimension != 0)
+        {
+            for (; SkipMips + 1 < TexDesc.MipLevels; ++SkipMips)
+            {
+                const auto MipInfo = GetMipLevelProperties(TexDesc, SkipMips);
+                if (std::max(std::max(MipInfo.LogicalWidth, MipInfo.LogicalHeight), MipInfo.Depth) <= TexLoadInfo.MaxDimension)
+                    break;
+            }
+        }
+        const auto NumMips = TexDesc.MipLevels - SkipMips;
+
+        const auto& FmtAttribs = GetTextureFormatAttribs(TexDesc.Format);
+        auto        ArraySize  = (TexDesc.Type != RESOURCE_DIM_TEX_3D ? TexDesc.ArraySize : 1);
+        SubresData.resize(NumMips * ArraySize);
         for (Uint32 mip = 0; mip < TexDesc.MipLevels; ++mip)
         {
             pData += sizeof(std::uint32_t);
             auto MipInfo = GetMipLevelProperties(TexDesc, mip);
 
+            const auto RowStride   = GetKTXRowStride(FmtAttribs, MipInfo);
+            const auto SliceStride = RowStride * MipInfo.StorageHeight;
             for (Uint32 layer = 0; layer < ArraySize; ++layer)
             {
-                SubresData[mip + layer * TexDesc.MipLevels] =
-                    TextureSubResData{pData, MipInfo.RowSize, MipInfo.DepthSliceSize};
-                pData += Align(MipInfo.MipSize, 4u);
+                if (mip >= SkipMips)
+                {
+                    SubresData[(mip - SkipMips) + layer * NumMips] =
+                        TextureSubResData{pData, RowStride, SliceStride};
+                }
+                pData += Align(SliceStride * MipInfo.Depth, 4u);
             }
         }
-        VERIFY(pData - reinterpret_cast<const Uint8*>(pKTXData->GetDataPtr()) == static_cast<ptrdiff_t>(DataSize), "Unexpected data size");
 
-        TextureData InitData(SubresData.data(), static_cast<Uint32>(SubresData.size()));
-        pDevice->CreateTexture(TexDesc, &InitData, ppTexture);
+        if (SkipMips > 0)
+        {
+            const auto TopMipInfo = GetMipLevelProperties(TexDesc, SkipMips);
+            TexDesc.Width         = TopMipInfo.LogicalWidth;
+            TexDesc.Height        = TopMipInfo.LogicalHeight;
+            if (TexDesc.Type == RESOURCE_DIM_TEX_3D)
+                TexDesc.Depth = TopMipInfo.Depth;
+            TexDesc.MipLevels = NumMips;
+        }
+        if (pData - pKTXData > static_cast<ptrdiff_t>(DataSize))
+            LOG_ERROR_AND_THROW("KTX data is truncated");
+        VERIFY(pData - pKTXData == static_cast<ptrdiff_t>(DataSize), "Unexpected data size");
     }
     else
     {
@@ -284,6 +379,93 @@ void CreateTextureFromKTX(IDataBlob*             pKTXData,
     }
 }
 
+void CreateTextureFromKTX(IDataBlob*             pKTXData,
+                          const TextureLoadInfo& TexLoadInfo,
+                          IRenderDevice*         pDevice,
+                          ITexture**             ppTexture)
+{
+    TextureDesc                    TexDesc;
+    std::vector<TextureSubResData> SubresData;
+    GetKTXTextureData(reinterpret_cast<const Uint8*>(pKTXData->GetDataPtr()), pKTXData->GetSize(), TexLoadInfo, TexDesc, SubresData);
+
+    TextureData InitData(SubresData.data(), static_cast<Uint32>(SubresData.size()));
+    pDevice->CreateTexture(TexDesc, &InitData, ppTexture);
+}
+
+void WriteTextureDataToKTX(const TextureDesc& TexDesc,
+                           const TextureData& TexData,
+                           IDataBlob*         pKTXData)
+{
+    GLFormatAttribs GLAttribs;
+    if (!FindGLFormatAttribs(TexDesc.Format, GLAttribs))
+        LOG_ERROR_AND_THROW("Format ", GetTextureFormatAttribs(TexDesc.Format).Name, " is not supported by the KTX writer");
+    if (TexDesc.Type != RESOURCE_DIM_TEX_2D && TexDesc.Type != RESOURCE_DIM_TEX_2D_ARRAY &&
+        TexDesc.Type != RESOURCE_DIM_TEX_CUBE && TexDesc.Type != RESOURCE_DIM_TEX_CUBE_ARRAY)
+        LOG_ERROR_AND_THROW("Only 2D textures, texture arrays and cube maps can be written to KTX");
+    if (TexData.NumSubresources != TexDesc.MipLevels * TexDesc.ArraySize)
+        LOG_ERROR_AND_THROW("Incorrect number of subresources");
+
+    const auto IsCube    = TexDesc.Type == RESOURCE_DIM_TEX_CUBE || TexDesc.Type == RESOURCE_DIM_TEX_CUBE_ARRAY;
+    const auto NumFaces  = IsCube ? 6u : 1u;
+    const auto NumLayers = TexDesc.ArraySize / NumFaces;
+
+    KTX10Header Header;
+    Header.Endianness            = 0x04030201;
+    Header.GLType                = GLAttribs.GLType;
+    Header.GLTypeSize            = GLAttribs.GLTypeSize;
+    Header.GLFormat              = GLAttribs.GLFormat;
+    Header.GLInternalFormat      = GLAttribs.GLInternalFormat;
+    Header.GLBaseInternalFormat  = GLAttribs.GLBaseInternalFormat;
+    Header.Width                 = TexDesc.Width;
+    Header.Height                = TexDesc.Height;
+    Header.Depth                 = 0;
+    Header.NumberOfArrayElements = TexDesc.Type == RESOURCE_DIM_TEX_2D_ARRAY || TexDesc.Type == RESOURCE_DIM_TEX_CUBE_ARRAY ? NumLayers : 0;
+    Header.NumberOfFaces         = NumFaces;
+    Header.NumberOfMipmapLevels  = TexDesc.MipLevels;
+    Header.BytesOfKeyValueData   = 0;
+
+    const auto& FmtAttribs = GetTextureFormatAttribs(TexDesc.Format);
+
+    size_t DataSize = sizeof(KTX10FileIdentifier) + sizeof(Header);
+    for (Uint32 mip = 0; mip < TexDesc.MipLevels; ++mip)
+    {
+        const auto MipInfo    = GetMipLevelProperties(TexDesc, mip);
+        const auto SliceSize  = GetKTXRowStride(FmtAttribs, MipInfo) * MipInfo.StorageHeight;
+        const auto SliceAlign = Align(SliceSize, 4u);
+        DataSize += sizeof(std::uint32_t) + size_t{SliceAlign} * TexDesc.ArraySize;
+    }
+    pKTXData->Resize(DataSize);
+
+    auto* pDst = reinterpret_cast<Uint8*>(pKTXData->GetDataPtr());
+    memset(pDst, 0, DataSize);
+    memcpy(pDst, KTX10FileIdentifier, sizeof(KTX10FileIdentifier));
+    pDst += sizeof(KTX10FileIdentifier);
+    memcpy(pDst, &Header, sizeof(Header));
+    pDst += sizeof(Header);
+
+    for (Uint32 mip = 0; mip < TexDesc.MipLevels; ++mip)
+    {
+        const auto MipInfo   = GetMipLevelProperties(TexDesc, mip);
+        const auto RowStride = GetKTXRowStride(FmtAttribs, MipInfo);
+        const auto SliceSize = RowStride * MipInfo.StorageHeight;
+
+        // For non-array cube maps, the image size is the size of one face
+        const std::uint32_t ImageSize = (IsCube && NumLayers == 1) ? SliceSize : SliceSize * TexDesc.ArraySize;
+        memcpy(pDst, &ImageSize, sizeof(ImageSize));
+        pDst += sizeof(ImageSize);
+
+        for (Uint32 slice = 0; slice < TexDesc.ArraySize; ++slice)
+        {
+            const auto& SubRes = TexData.pSubResources[mip + slice * TexDesc.MipLevels];
+            VERIFY_EXPR(SubRes.pData != nullptr);
+            for (Uint32 row = 0; row < MipInfo.StorageHeight; ++row)
+                memcpy(pDst + size_t{row} * RowStride, reinterpret_cast<const Uint8*>(SubRes.pData) + size_t{row} * SubRes.Stride, MipInfo.RowSize);
+            pDst += Align(SliceSize, 4u);
+        }
+    }
+    VERIFY_EXPR(pDst == reinterpret_cast<Uint8*>(pKTXData->GetDataPtr()) + DataSize);
+}
+
 } // namespace Diligent
 
 extern "C"
@@ -295,4 +477,11 @@ extern "C"
     {
         Diligent::CreateTextureFromKTX(pKTXData, TexLoadInfo, pDevice, ppTexture);
     }
-}
\ No newline at end of file
+
+    void Diligent_WriteTextureDataToKTX(const Diligent::TextureDesc& TexDesc,
+                                        const Diligent::TextureData& TexData,
+                                        Diligent::IDataBlob*         pKTXData)
+    {
+        Diligent::WriteTextureDataToKTX(TexDesc, TexData, pKTXData);
+    }
+}
@@ -0,0 +1,1191 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+#include "MipGenerator.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#    include <emmintrin.h>
+#    define DILIGENT_MIP_GENERATOR_USE_SSE2 1
+#else
+#    define DILIGENT_MIP_GENERATOR_USE_SSE2 0
+#endif
+
+#include "ColorConversion.h"
+#include "ThreadPool.hpp"
+#include "DebugUtilities.hpp"
+#include "GraphicsAccessories.hpp"
+#include "Align.hpp"
+#include "BasicMath.hpp"
+
+namespace Diligent
+{
+
+namespace
+{
+
+template <typename ChannelType>
+ChannelType SRGBAverage(ChannelType c0, ChannelType c1, ChannelType c2, ChannelType c3)
+{
+    static constexpr float NormVal = static_cast<float>(std::numeric_limits<ChannelType>::max());
+
+    float fc0 = static_cast<float>(c0) / NormVal;
+    float fc1 = static_cast<float>(c1) / NormVal;
+    float fc2 = static_cast<float>(c2) / NormVal;
+    float fc3 = static_cast<float>(c3) / NormVal;
+
+    float fLinearAverage = (SRGBToLinear(fc0) + SRGBToLinear(fc1) + SRGBToLinear(fc2) + SRGBToLinear(fc3)) / 4.f;
+    float fSRGBAverage   = LinearToSRGB(fLinearAverage) * NormVal + 0.5f;
+
+    static constexpr float MinVal = static_cast<float>(std::numeric_limits<ChannelType>::min());
+    static constexpr float MaxVal = static_cast<float>(std::numeric_limits<ChannelType>::max());
+
+    fSRGBAverage = std::max(fSRGBAverage, MinVal);
+    fSRGBAverage = std::min(fSRGBAverage, MaxVal);
+
+    return static_cast<ChannelType>(fSRGBAverage);
+}
+
+template <typename ChannelType>
+ChannelType LinearAverage(ChannelType c0, ChannelType c1, ChannelType c2, ChannelType c3)
+{
+    static_assert(std::numeric_limits<ChannelType>::is_integer && !std::numeric_limits<ChannelType>::is_signed, "Unsigned integers are expected");
+    return static_cast<ChannelType>((static_cast<Uint32>(c0) + static_cast<Uint32>(c1) + static_cast<Uint32>(c2) + static_cast<Uint32>(c3)) / 4);
+}
+
+// Returns true if the channel is sRGB-encoded. The fourth channel of RGBA images is alpha.
+inline bool IsSRGBChannel(const ComputeCoarseMipAttribs& Attribs, Uint32 c)
+{
+    return Attribs.IsSRGB && (Attribs.NumChannels != 4 || c != 3);
+}
+
+struct MipRowPointers
+{
+    const Uint8* pSrcRow0;
+    const Uint8* pSrcRow1;
+    Uint8*       pDstRow;
+};
+
+inline MipRowPointers GetMipRowPointers(const ComputeCoarseMipAttribs& Attribs, Uint32 row)
+{
+    const auto src_row0 = row * 2;
+    const auto src_row1 = std::min(row * 2 + 1, Attribs.FineMipHeight - 1);
+
+    const auto* pFineMip = reinterpret_cast<const Uint8*>(Attribs.pFineMipData);
+    return MipRowPointers{
+        pFineMip + size_t{src_row0} * Attribs.FineMipStride,
+        pFineMip + size_t{src_row1} * Attribs.FineMipStride,
+        reinterpret_cast<Uint8*>(Attribs.pCoarseMipData) + size_t{row} * Attribs.CoarseMipStride //
+    };
+}
+
+template <typename ChannelType>
+void ComputeCoarseMipRowRef(const ComputeCoarseMipAttribs& Attribs, const MipRowPointers& Row, Uint32 StartCol)
+{
+    const auto  NumChannels = Attribs.NumChannels;
+    const auto* pSrcRow0    = reinterpret_cast<const ChannelType*>(Row.pSrcRow0);
+    const auto* pSrcRow1    = reinterpret_cast<const ChannelType*>(Row.pSrcRow1);
+    auto*       pDstRow     = reinterpret_cast<ChannelType*>(Row.pDstRow);
+
+    for (Uint32 col = StartCol; col < Attribs.CoarseMipWidth; ++col)
+    {
+        auto src_col0 = col * 2;
+        auto src_col1 = std::min(col * 2 + 1, Attribs.FineMipWidth - 1);
+
+        for (Uint32 c = 0; c < NumChannels; ++c)
+        {
+            auto Chnl00 = pSrcRow0[src_col0 * NumChannels + c];
+            auto Chnl01 = pSrcRow0[src_col1 * NumChannels + c];
+            auto Chnl10 = pSrcRow1[src_col0 * NumChannels + c];
+            auto Chnl11 = pSrcRow1[src_col1 * NumChannels + c];
+
+            auto& DstCol = pDstRow[col * NumChannels + c];
+            if (IsSRGBChannel(Attribs, c))
+                DstCol = SRGBAverage(Chnl00, Chnl01, Chnl10, Chnl11);
+            else
+                DstCol = LinearAverage(Chnl00, Chnl01, Chnl10, Chnl11);
+        }
+    }
+}
+
+template <typename ChannelType>
+void ComputeCoarseMipRef(const ComputeCoarseMipAttribs& Attribs)
+{
+    for (Uint32 row = 0; row < Attribs.CoarseMipHeight; ++row)
+        ComputeCoarseMipRowRef<ChannelType>(Attribs, GetMipRowPointers(Attribs, row), 0);
+}
+
+
+// Look-up tables that average sRGB values in linear space without floating-point math
+class SRGBAverageLUT
+{
+public:
+    // Linear values are stored as 16-bit fixed-point numbers
+    static constexpr Uint32 LinearScale = 65535;
+    // Linear values are mapped to the sRGB table with this shift
+    static constexpr Uint32 CoarseShift = 4;
+
+    SRGBAverageLUT() noexcept
+    {
+        for (Uint32 i = 0; i < 256; ++i)
+            m_ToLinear[i] = static_cast<Uint16>(SRGBToLinear(static_cast<float>(i) / 255.f) * LinearScale + 0.5f);
+
+        // Linear value that is rounded to sRGB value k is not less than m_Thresholds[k]
+        m_Thresholds[0] = 0;
+        for (Uint32 k = 1; k < 256; ++k)
+            m_Thresholds[k] = static_cast<Uint32>(std::ceil(SRGBToLinear((static_cast<float>(k) - 0.5f) / 255.f) * LinearScale));
+
+        Uint32 k = 0;
+        for (Uint32 i = 0; i < m_ToSRGB.size(); ++i)
+        {
+            const Uint32 Linear = i << CoarseShift;
+            while (k < 255 && Linear >= m_Thresholds[k + 1])
+                ++k;
+            m_ToSRGB[i] = static_cast<Uint8>(k);
+        }
+    }
+
+    Uint8 Average(Uint8 c0, Uint8 c1, Uint8 c2, Uint8 c3) const
+    {
+        const Uint32 Linear = (Uint32{m_ToLinear[c0]} + Uint32{m_ToLinear[c1]} + Uint32{m_ToLinear[c2]} + Uint32{m_ToLinear[c3]} + 2) >> 2;
+        return ToSRGB(Linear);
+    }
+
+    // Converts linear value in [0, LinearScale] range to sRGB
+    Uint8 ToSRGB(Uint32 Linear) const
+    {
+        VERIFY_EXPR(Linear <= LinearScale);
+        // The coarse table gives the lower bound; at most a few thresholds fall into one cell
+        Uint32 k = m_ToSRGB[Linear >> CoarseShift];
+        while (k < 255 && Linear >= m_Thresholds[k + 1])
+            ++k;
+        return static_cast<Uint8>(k);
+    }
+
+private:
+    std::array<Uint16, 256>                           m_ToLinear;
+    std::array<Uint32, 256>                           m_Thresholds;
+    std::array<Uint8, (LinearScale >> CoarseShift) + 1> m_ToSRGB;
+};
+
+template <Uint32 NumChannels>
+void ComputeCoarseMipSRGB8(const ComputeCoarseMipAttribs& Attribs, const SRGBAverageLUT& LUT)
+{
+    // Coarse mip width is half the fine mip width, so all columns except
+    // the one of 1-pixel wide mips have two source pixels
+    const Uint32 Offset1 = Attribs.FineMipWidth > 1 ? NumChannels : 0;
+    for (Uint32 row = 0; row < Attribs.CoarseMipHeight; ++row)
+    {
+        const auto Row = GetMipRowPointers(Attribs, row);
+        for (Uint32 col = 0; col < Attribs.CoarseMipWidth; ++col)
+        {
+            const auto* pSrc0 = Row.pSrcRow0 + col * 2 * NumChannels;
+            const auto* pSrc1 = Row.pSrcRow1 + col * 2 * NumChannels;
+            auto*       pDst  = Row.pDstRow + col * NumChannels;
+            for (Uint32 c = 0; c < NumChannels; ++c)
+            {
+                // The fourth channel is linear alpha
+                pDst[c] = (NumChannels != 4 || c != 3) ?
+                    LUT.Average(pSrc0[c], pSrc0[c + Offset1], pSrc1[c], pSrc1[c + Offset1]) :
+                    LinearAverage(pSrc0[c], pSrc0[c + Offset1], pSrc1[c], pSrc1[c + Offset1]);
+            }
+        }
+    }
+}
+
+const SRGBAverageLUT& GetSRGBAverageLUT()
+{
+    static const SRGBAverageLUT LUT;
+    return LUT;
+}
+
+void ComputeCoarseMipSRGB8(const ComputeCoarseMipAttribs& Attribs)
+{
+    const auto& LUT = GetSRGBAverageLUT();
+    switch (Attribs.NumChannels)
+    {
+        case 1: ComputeCoarseMipSRGB8<1>(Attribs, LUT); break;
+        case 2: ComputeCoarseMipSRGB8<2>(Attribs, LUT); break;
+        case 3: ComputeCoarseMipSRGB8<3>(Attribs, LUT); break;
+        case 4: ComputeCoarseMipSRGB8<4>(Attribs, LUT); break;
+        default: ComputeCoarseMipRef<Uint8>(Attribs);
+    }
+}
+
+
+#if DILIGENT_MIP_GENERATOR_USE_SSE2
+
+// Sums horizontally adjacent pixels. a and b contain 16-bit channel sums of
+// consecutive source pixels; the result contains 8 channel sums of coarse pixels.
+template <Uint32 NumChannels>
+__m128i SumAdjacentPixels16(__m128i a, __m128i b);
+
+template <>
+inline __m128i SumAdjacentPixels16<1>(__m128i a, __m128i b)
+{
+    const auto LoMask = _mm_set1_epi32(0xFFFF);
+
+    const auto SumA = _mm_add_epi32(_mm_and_si128(a, LoMask), _mm_srli_epi32(a, 16));
+    const auto SumB = _mm_add_epi32(_mm_and_si128(b, LoMask), _mm_srli_epi32(b, 16));
+    return _mm_packs_epi32(SumA, SumB);
+}
+
+template <>
+inline __m128i SumAdjacentPixels16<2>(__m128i a, __m128i b)
+{
+    const auto Even = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b), _MM_SHUFFLE(2, 0, 2, 0)));
+    const auto Odd  = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b), _MM_SHUFFLE(3, 1, 3, 1)));
+    return _mm_add_epi16(Even, Odd);
+}
+
+template <>
+inline __m128i SumAdjacentPixels16<4>(__m128i a, __m128i b)
+{
+    return _mm_add_epi16(_mm_unpacklo_epi64(a, b), _mm_unpackhi_epi64(a, b));
+}
+
+// Same as SumAdjacentPixels16, but for 32-bit channel sums
+template <Uint32 NumChannels>
+__m128i SumAdjacentPixels32(__m128i a, __m128i b);
+
+template <>
+inline __m128i SumAdjacentPixels32<1>(__m128i a, __m128i b)
+{
+    const auto Even = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b), _MM_SHUFFLE(2, 0, 2, 0)));
+    const auto Odd  = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b), _MM_SHUFFLE(3, 1, 3, 1)));
+    return _mm_add_epi32(Even, Odd);
+}
+
+template <>
+inline __m128i SumAdjacentPixels32<2>(__m128i a, __m128i b)
+{
+    return _mm_add_epi32(_mm_unpacklo_epi64(a, b), _mm_unpackhi_epi64(a, b));
+}
+
+template <>
+inline __m128i SumAdjacentPixels32<4>(__m128i a, __m128i b)
+{
+    return _mm_add_epi32(a, b);
+}
+
+template <Uint32 NumChannels>
+void ComputeCoarseMipLinear8SSE2(const ComputeCoarseMipAttribs& Attribs)
+{
+    // Every iteration reads 32 bytes from both source rows and writes 16 bytes
+    constexpr Uint32 ColsPerIteration = 16 / NumChannels;
+
+    const auto Zero = _mm_setzero_si128();
+    for (Uint32 row = 0; row < Attribs.CoarseMipHeight; ++row)
+    {
+        const auto Row = GetMipRowPointers(Attribs, row);
+
+        Uint32 col = 0;
+        for (; col + ColsPerIteration <= Attribs.CoarseMipWidth; col += ColsPerIteration)
+        {
+            const auto* pSrc0 = Row.pSrcRow0 + col * 2 * NumChannels;
+            const auto* pSrc1 = Row.pSrcRow1 + col * 2 * NumChannels;
+
+            const auto Row0a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc0));
+            const auto Row0b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc0 + 16));
+            const auto Row1a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc1));
+            const auto Row1b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc1 + 16));
+
+            // Vertical sums of source bytes 0-7, 8-15, 16-23 and 24-31
+            const auto Sum0 = _mm_add_epi16(_mm_unpacklo_epi8(Row0a, Zero), _mm_unpacklo_epi8(Row1a, Zero));
+            const auto Sum1 = _mm_add_epi16(_mm_unpackhi_epi8(Row0a, Zero), _mm_unpackhi_epi8(Row1a, Zero));
+            const auto Sum2 = _mm_add_epi16(_mm_unpacklo_epi8(Row0b, Zero), _mm_unpacklo_epi8(Row1b, Zero));
+            const auto Sum3 = _mm_add_epi16(_mm_unpackhi_epi8(Row0b, Zero), _mm_unpackhi_epi8(Row1b, Zero));
+
+            const auto Avg0 = _mm_srli_epi16(SumAdjacentPixels16<NumChannels>(Sum0, Sum1), 2);
+            const auto Avg1 = _mm_srli_epi16(SumAdjacentPixels16<NumChannels>(Sum2, Sum3), 2);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(Row.pDstRow + col * NumChannels), _mm_packus_epi16(Avg0, Avg1));
+        }
+        ComputeCoarseMipRowRef<Uint8>(Attribs, Row, col);
+    }
+}
+
+template <Uint32 NumChannels>
+void ComputeCoarseMipLinear16SSE2(const ComputeCoarseMipAttribs& Attribs)
+{
+    // Every iteration reads 16 channels from both source rows and writes 8 channels
+    constexpr Uint32 ColsPerIteration = 8 / NumChannels;
+
+    const auto Zero   = _mm_setzero_si128();
+    const auto Bias   = _mm_set1_epi32(0x8000);
+    const auto Bias16 = _mm_set1_epi16(static_cast<short>(0x8000));
+    for (Uint32 row = 0; row < Attribs.CoarseMipHeight; ++row)
+    {
+        const auto Row = GetMipRowPointers(Attribs, row);
+
+        Uint32 col = 0;
+        for (; col + ColsPerIteration <= Attribs.CoarseMipWidth; col += ColsPerIteration)
+        {
+            const auto* pSrc0 = Row.pSrcRow0 + col * 2 * NumChannels * sizeof(Uint16);
+            const auto* pSrc1 = Row.pSrcRow1 + col * 2 * NumChannels * sizeof(Uint16);
+
+            const auto Row0a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc0));
+            const auto Row0b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc0 + 16));
+            const auto Row1a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc1));
+            const auto Row1b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc1 + 16));
+
+            // Vertical sums of source channels 0-3, 4-7, 8-11 and 12-15
+            const auto Sum0 = _mm_add_epi32(_mm_unpacklo_epi16(Row0a, Zero), _mm_unpacklo_epi16(Row1a, Zero));
+            const auto Sum1 = _mm_add_epi32(_mm_unpackhi_epi16(Row0a, Zero), _mm_unpackhi_epi16(Row1a, Zero));
+            const auto Sum2 = _mm_add_epi32(_mm_unpacklo_epi16(Row0b, Zero), _mm_unpacklo_epi16(Row1b, Zero));
+            const auto Sum3 = _mm_add_epi32(_mm_unpackhi_epi16(Row0b, Zero), _mm_unpackhi_epi16(Row1b, Zero));
+
+            const auto Avg0 = _mm_srli_epi32(SumAdjacentPixels32<NumChannels>(Sum0, Sum1), 2);
+            const auto Avg1 = _mm_srli_epi32(SumAdjacentPixels32<NumChannels>(Sum2, Sum3), 2);
+            // SSE2 has no unsigned 32->16 bit pack, so pack biased signed values instead
+            const auto Packed = _mm_packs_epi32(_mm_sub_epi32(Avg0, Bias), _mm_sub_epi32(Avg1, Bias));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(Row.pDstRow + col * NumChannels * sizeof(Uint16)), _mm_xor_si128(Packed, Bias16));
+        }
+        ComputeCoarseMipRowRef<Uint16>(Attribs, Row, col);
+    }
+}
+
+#endif
+
+void ComputeCoarseMipLinear8(const ComputeCoarseMipAttribs& Attribs)
+{
+#if DILIGENT_MIP_GENERATOR_USE_SSE2
+    switch (Attribs.NumChannels)
+    {
+        case 1: ComputeCoarseMipLinear8SSE2<1>(Attribs); return;
+        case 2: ComputeCoarseMipLinear8SSE2<2>(Attribs); return;
+        case 4: ComputeCoarseMipLinear8SSE2<4>(Attribs); return;
+        default: break;
+    }
+#endif
+    ComputeCoarseMipRef<Uint8>(Attribs);
+}
+
+void ComputeCoarseMipLinear16(const ComputeCoarseMipAttribs& Attribs)
+{
+#if DILIGENT_MIP_GENERATOR_USE_SSE2
+    switch (Attribs.NumChannels)
+    {
+        case 1: ComputeCoarseMipLinear16SSE2<1>(Attribs); return;
+        case 2: ComputeCoarseMipLinear16SSE2<2>(Attribs); return;
+        case 4: ComputeCoarseMipLinear16SSE2<4>(Attribs); return;
+        default: break;
+    }
+#endif
+    ComputeCoarseMipRef<Uint16>(Attribs);
+}
+
+// Kaiser and Lanczos filters compute coarse pixel i from fine pixels 2i-5 ... 2i+6
+constexpr Uint32 MipFilterTaps     = 12;
+constexpr int    MipFilterFirstTap = -5;
+
+double Sinc(double x)
+{
+    if (std::abs(x) < 1e-6)
+        return 1;
+    x *= PI;
+    return std::sin(x) / x;
+}
+
+// Zero-order modified Bessel function of the first kind
+double BesselI0(double x)
+{
+    double Sum  = 1;
+    double Term = 1;
+    for (int k = 1; k < 32; ++k)
+    {
+        const auto t = x / (2 * k);
+        Term *= t * t;
+        Sum += Term;
+    }
+    return Sum;
+}
+
+struct MipFilterKernel
+{
+    // The kernel is symmetric: Weights[k] == Weights[MipFilterTaps - 1 - k]
+    std::array<float, MipFilterTaps> Weights;
+
+    explicit MipFilterKernel(MIP_FILTER Filter)
+    {
+        // Filter radius in coarse pixels
+        constexpr double Radius = 3;
+        // Kaiser window shape parameter
+        constexpr double Alpha = 4;
+
+        std::array<double, MipFilterTaps> W;
+
+        double Sum = 0;
+        for (Uint32 k = 0; k < MipFilterTaps; ++k)
+        {
+            // Distance between the centers of the fine pixel and the coarse pixel, in coarse pixels
+            const auto x = (static_cast<double>(k) + MipFilterFirstTap - 0.5) / 2;
+            switch (Filter)
+            {
+                case MIP_FILTER_KAISER:
+                {
+                    const auto t = x / Radius;
+                    W[k]         = Sinc(x) * BesselI0(Alpha * std::sqrt(std::max(1 - t * t, 0.0))) / BesselI0(Alpha);
+                    break;
+                }
+
+                case MIP_FILTER_LANCZOS:
+                    W[k] = Sinc(x) * Sinc(x / Radius);
+                    break;
+
+                default:
+                    UNEXPECTED("Unexpected mip filter");
+                    W[k] = 1;
+            }
+            Sum += W[k];
+        }
+
+        for (Uint32 k = 0; k < MipFilterTaps; ++k)
+            Weights[k] = static_cast<float>(W[k] / Sum);
+    }
+};
+
+const MipFilterKernel& GetMipFilterKernel(MIP_FILTER Filter)
+{
+    static const MipFilterKernel Kaiser{MIP_FILTER_KAISER};
+    static const MipFilterKernel Lanczos{MIP_FILTER_LANCZOS};
+    return Filter == MIP_FILTER_LANCZOS ? Lanczos : Kaiser;
+}
+
+template <typename ChannelType>
+void ComputeCoarseMipFilteredRef(const ComputeCoarseMipAttribs& Attribs)
+{
+    const auto& Weights = GetMipFilterKernel(Attribs.Filter).Weights;
+
+    static constexpr float NormVal = static_cast<float>(std::numeric_limits<ChannelType>::max());
+
+    const auto NumChannels = Attribs.NumChannels;
+    const auto* pFineMip   = reinterpret_cast<const Uint8*>(Attribs.pFineMipData);
+    for (Uint32 row = 0; row < Attribs.CoarseMipHeight; ++row)
+    {
+        auto* pDstRow = reinterpret_cast<ChannelType*>(reinterpret_cast<Uint8*>(Attribs.pCoarseMipData) + size_t{row} * Attribs.CoarseMipStride);
+        for (Uint32 col = 0; col < Attribs.CoarseMipWidth; ++col)
+        {
+            for (Uint32 c = 0; c < NumChannels; ++c)
+            {
+                const auto IsSRGB = IsSRGBChannel(Attribs, c);
+
+                float Sum = 0;
+                for (Uint32 ky = 0; ky < MipFilterTaps; ++ky)
+                {
+                    const auto  y       = std::min(std::max(static_cast<int>(row * 2) + MipFilterFirstTap + static_cast<int>(ky), 0), static_cast<int>(Attribs.FineMipHeight) - 1);
+                    const auto* pSrcRow = reinterpret_cast<const ChannelType*>(pFineMip + size_t(y) * Attribs.FineMipStride);
+                    for (Uint32 kx = 0; kx < MipFilterTaps; ++kx)
+                    {
+                        const auto x = std::min(std::max(static_cast<int>(col * 2) + MipFilterFirstTap + static_cast<int>(kx), 0), static_cast<int>(Attribs.FineMipWidth) - 1);
+
+                        auto Val = static_cast<float>(pSrcRow[x * NumChannels + c]) / NormVal;
+                        if (IsSRGB)
+                            Val = SRGBToLinear(Val);
+                        Sum += Weights[ky] * Weights[kx] * Val;
+                    }
+                }
+
+                Sum = std::min(std::max(Sum, 0.f), 1.f);
+                if (IsSRGB)
+                    Sum = LinearToSRGB(Sum);
+                pDstRow[col * NumChannels + c] = static_cast<ChannelType>(Sum * NormVal + 0.5f);
+            }
+        }
+    }
+}
+
+
+#if DILIGENT_MIP_GENERATOR_USE_SSE2
+
+void FilterRowHorizontallyRGBASSE2(const float* pSrc, float* pDst, Uint32 NumPixels, const MipFilterKernel& Kernel)
+{
+    __m128 Weights[MipFilterTaps / 2];
+    for (Uint32 k = 0; k < MipFilterTaps / 2; ++k)
+        Weights[k] = _mm_set1_ps(Kernel.Weights[k]);
+
+    for (Uint32 x = 0; x < NumPixels; ++x)
+    {
+        // Coarse pixel x starts at fine pixel 2x of the padded row
+        const auto* pSrcPixels = pSrc + x * 8;
+
+        auto Sum = _mm_setzero_ps();
+        for (Uint32 k = 0; k < MipFilterTaps / 2; ++k)
+        {
+            const auto Pair = _mm_add_ps(_mm_loadu_ps(pSrcPixels + k * 4), _mm_loadu_ps(pSrcPixels + (MipFilterTaps - 1 - k) * 4));
+            Sum             = _mm_add_ps(Sum, _mm_mul_ps(Weights[k], Pair));
+        }
+        _mm_storeu_ps(pDst + x * 4, Sum);
+    }
+}
+
+#endif
+
+void FilterRowsVertically(const float* const* ppSrcRows, float* pDst, size_t NumElements, const MipFilterKernel& Kernel)
+{
+    size_t i = 0;
+#if DILIGENT_MIP_GENERATOR_USE_SSE2
+    __m128 Weights[MipFilterTaps / 2];
+    for (Uint32 k = 0; k < MipFilterTaps / 2; ++k)
+        Weights[k] = _mm_set1_ps(Kernel.Weights[k]);
+
+    for (; i + 4 <= NumElements; i += 4)
+    {
+        auto Sum = _mm_setzero_ps();
+        for (Uint32 k = 0; k < MipFilterTaps / 2; ++k)
+        {
+            const auto Pair = _mm_add_ps(_mm_loadu_ps(ppSrcRows[k] + i), _mm_loadu_ps(ppSrcRows[MipFilterTaps - 1 - k] + i));
+            Sum             = _mm_add_ps(Sum, _mm_mul_ps(Weights[k], Pair));
+        }
+        _mm_storeu_ps(pDst + i, Sum);
+    }
+#endif
+    for (; i < NumElements; ++i)
+    {
+        float Sum = 0;
+        for (Uint32 k = 0; k < MipFilterTaps / 2; ++k)
+            Sum += Kernel.Weights[k] * (ppSrcRows[k][i] + ppSrcRows[MipFilterTaps - 1 - k][i]);
+        pDst[i] = Sum;
+    }
+}
+
+// Applies Kaiser and Lanczos filters as separable kernels. Rows of the fine level are filtered
+// horizontally into a ring of MipFilterTaps rows that is then filtered vertically.
+// Linear channels are filtered in their original range, and sRGB channels are filtered in
+// linear space that is scaled to [0, SRGBAverageLUT::LinearScale] range.
+template <typename ChannelType>
+class SeparableMipFilter
+{
+public:
+    explicit SeparableMipFilter(const ComputeCoarseMipAttribs& Attribs) :
+        m_Attribs{Attribs},
+        m_Kernel{GetMipFilterKernel(Attribs.Filter)},
+        m_RowSize{size_t{Attribs.CoarseMipWidth} * Attribs.NumChannels},
+        // Coarse pixel x reads padded pixels 2x ... 2x + MipFilterTaps - 1
+        m_PaddedWidth{std::max(Attribs.CoarseMipWidth * 2 + MipFilterTaps - 2, Attribs.FineMipWidth + LeftPadding)},
+        m_PaddedRow(size_t{m_PaddedWidth} * Attribs.NumChannels),
+        m_RingRows(m_RowSize * MipFilterTaps),
+        m_CoarseRow(m_RowSize),
+        m_IsSRGBChannel(Attribs.NumChannels),
+        m_MaxValue(Attribs.NumChannels)
+    {
+        for (Uint32 c = 0; c < Attribs.NumChannels; ++c)
+        {
+            m_IsSRGBChannel[c] = IsSRGBChannel(Attribs, c);
+            m_MaxValue[c]      = m_IsSRGBChannel[c] ? static_cast<float>(SRGBAverageLUT::LinearScale) : static_cast<float>(std::numeric_limits<ChannelType>::max());
+        }
+    }
+
+    // Computes coarse rows [FirstRow, FirstRow + NumRows)
+    void ComputeRows(Uint32 FirstRow, Uint32 NumRows)
+    {
+        const float* pSrcRows[MipFilterTaps];
+
+        // Rows outside of the fine level are clamped to the edge, but
+        // are stored in the ring by their unclamped index
+        int NextFineRow = static_cast<int>(FirstRow * 2) + MipFilterFirstTap;
+        for (Uint32 row = FirstRow; row < FirstRow + NumRows; ++row)
+        {
+            const int StartFineRow = static_cast<int>(row * 2) + MipFilterFirstTap;
+            for (; NextFineRow < StartFineRow + static_cast<int>(MipFilterTaps); ++NextFineRow)
+            {
+                const auto FineRow = std::min(std::max(NextFineRow, 0), static_cast<int>(m_Attribs.FineMipHeight) - 1);
+                FilterRowHorizontally(static_cast<Uint32>(FineRow), GetRingRow(NextFineRow));
+            }
+
+            for (Uint32 k = 0; k < MipFilterTaps; ++k)
+                pSrcRows[k] = GetRingRow(StartFineRow + static_cast<int>(k));
+            FilterRowsVertically(pSrcRows, m_CoarseRow.data(), m_RowSize, m_Kernel);
+
+            StoreRow(reinterpret_cast<ChannelType*>(reinterpret_cast<Uint8*>(m_Attribs.pCoarseMipData) + size_t{row} * m_Attribs.CoarseMipStride));
+        }
+    }
+
+private:
+    static constexpr Uint32 LeftPadding = static_cast<Uint32>(-MipFilterFirstTap);
+
+    float* GetRingRow(int FineRow)
+    {
+        constexpr int NumRingRows = static_cast<int>(MipFilterTaps);
+        return m_RingRows.data() + static_cast<size_t>((FineRow % NumRingRows + NumRingRows) % NumRingRows) * m_RowSize;
+    }
+
+    float ToFloat(Uint8 Val, Uint32 Channel) const
+    {
+        return GetToFloatTables()[m_IsSRGBChannel[Channel]][Val];
+    }
+
+    float ToFloat(Uint16 Val, Uint32 Channel) const
+    {
+        return m_IsSRGBChannel[Channel] ?
+            SRGBToLinear(static_cast<float>(Val) / 65535.f) * static_cast<float>(SRGBAverageLUT::LinearScale) :
+            static_cast<float>(Val);
+    }
+
+    void FromFloat(float Val, Uint32 Channel, Uint8& Dst) const
+    {
+        const auto Int = static_cast<Uint32>(std::min(std::max(Val, 0.f), m_MaxValue[Channel]) + 0.5f);
+        Dst            = m_IsSRGBChannel[Channel] ? GetSRGBAverageLUT().ToSRGB(Int) : static_cast<Uint8>(Int);
+    }
+
+    void FromFloat(float Val, Uint32 Channel, Uint16& Dst) const
+    {
+        Val = std::min(std::max(Val, 0.f), m_MaxValue[Channel]);
+        if (m_IsSRGBChannel[Channel])
+            Val = LinearToSRGB(Val / static_cast<float>(SRGBAverageLUT::LinearScale)) * 65535.f;
+        Dst = static_cast<Uint16>(Val + 0.5f);
+    }
+
+    // Tables that convert linear and sRGB 8-bit values to floats
+    using ToFloatTablesType = std::array<std::array<float, 256>, 2>;
+    static const ToFloatTablesType& GetToFloatTables()
+    {
+        static const ToFloatTablesType Tables = []() {
+            ToFloatTablesType Tbl;
+            for (Uint32 i = 0; i < 256; ++i)
+            {
+                Tbl[0][i] = static_cast<float>(i);
+                Tbl[1][i] = SRGBToLinear(static_cast<float>(i) / 255.f) * static_cast<float>(SRGBAverageLUT::LinearScale);
+            }
+            return Tbl;
+        }();
+        return Tables;
+    }
+
+    void FilterRowHorizontally(Uint32 FineRow, float* pDst)
+    {
+        const auto NumChannels = m_Attribs.NumChannels;
+        const auto FineWidth   = m_Attribs.FineMipWidth;
+        const auto* pSrc       = reinterpret_cast<const ChannelType*>(reinterpret_cast<const Uint8*>(m_Attribs.pFineMipData) + size_t{FineRow} * m_Attribs.FineMipStride);
+
+        // Convert the row to floats and replicate the edge pixels to the padding
+        auto* pPaddedRow = m_PaddedRow.data();
+        auto* pPixels    = pPaddedRow + LeftPadding * NumChannels;
+        for (Uint32 x = 0; x < FineWidth; ++x)
+        {
+            for (Uint32 c = 0; c < NumChannels; ++c)
+                pPixels[x * NumChannels + c] = ToFloat(pSrc[x * NumChannels + c], c);
+        }
+        const auto PixelSize = NumChannels * sizeof(float);
+        for (Uint32 x = 0; x < LeftPadding; ++x)
+            memcpy(pPaddedRow + x * NumChannels, pPixels, PixelSize);
+        for (Uint32 x = LeftPadding + FineWidth; x < m_PaddedWidth; ++x)
+            memcpy(pPaddedRow + x * NumChannels, pPixels + (FineWidth - 1) * NumChannels, PixelSize);
+
+        const auto CoarseWidth = m_Attribs.CoarseMipWidth;
+#if DILIGENT_MIP_GENERATOR_USE_SSE2
+        if (NumChannels == 4)
+        {
+            FilterRowHorizontallyRGBASSE2(pPaddedRow, pDst, CoarseWidth, m_Kernel);
+            return;
+        }
+#endif
+        for (Uint32 x = 0; x < CoarseWidth; ++x)
+        {
+            for (Uint32 c = 0; c < NumChannels; ++c)
+            {
+                const auto* pSrcChannel = pPaddedRow + x * 2 * NumChannels + c;
+
+                float Sum = 0;
+                for (Uint32 k = 0; k < MipFilterTaps / 2; ++k)
+                    Sum += m_Kernel.Weights[k] * (pSrcChannel[k * NumChannels] + pSrcChannel[(MipFilterTaps - 1 - k) * NumChannels]);
+                pDst[x * NumChannels + c] = Sum;
+            }
+        }
+    }
+
+    void StoreRow(ChannelType* pDst) const
+    {
+        const auto NumChannels = m_Attribs.NumChannels;
+        for (Uint32 x = 0; x < m_Attribs.CoarseMipWidth; ++x)
+        {
+            for (Uint32 c = 0; c < NumChannels; ++c)
+                FromFloat(m_CoarseRow[x * NumChannels + c], c, pDst[x * NumChannels + c]);
+        }
+    }
+
+    const ComputeCoarseMipAttribs& m_Attribs;
+    const MipFilterKernel&         m_Kernel;
+
+    // The number of floats in a row of the coarse level
+    const size_t m_RowSize;
+    // The number of pixels in the padded fine row
+    const Uint32 m_PaddedWidth;
+
+    std::vector<float> m_PaddedRow;
+    std::vector<float> m_RingRows;
+    std::vector<float> m_CoarseRow;
+
+    std::vector<Uint8> m_IsSRGBChannel;
+    std::vector<float> m_MaxValue;
+};
+
+template <typename ChannelType>
+constexpr Uint32 SeparableMipFilter<ChannelType>::LeftPadding;
+
+// Computes coarse rows [FirstRow, FirstRow + NumRows) with the Kaiser or Lanczos filter
+void ComputeCoarseMipFiltered(const ComputeCoarseMipAttribs& Attribs, Uint32 FirstRow, Uint32 NumRows)
+{
+    if (Attribs.ComponentType == VT_UINT8)
+        SeparableMipFilter<Uint8>{Attribs}.ComputeRows(FirstRow, NumRows);
+    else if (Attribs.ComponentType == VT_UINT16)
+        SeparableMipFilter<Uint16>{Attribs}.ComputeRows(FirstRow, NumRows);
+    else
+        UNEXPECTED("Unsupported component type");
+}
+
+void VerifyComputeCoarseMipAttribs(const ComputeCoarseMipAttribs& Attribs)
+{
+    VERIFY_EXPR(Attribs.ComponentType == VT_UINT8 || Attribs.ComponentType == VT_UINT16);
+    VERIFY_EXPR(Attribs.NumChannels > 0);
+    VERIFY_EXPR(Attribs.Filter < MIP_FILTER_COUNT);
+    VERIFY_EXPR(Attribs.pFineMipData != nullptr && Attribs.pCoarseMipData != nullptr);
+    VERIFY_EXPR(Attribs.FineMipWidth > 0 && Attribs.FineMipHeight > 0 && Attribs.FineMipStride > 0);
+    VERIFY_EXPR(Attribs.CoarseMipWidth > 0 && Attribs.CoarseMipHeight > 0 && Attribs.CoarseMipStride > 0);
+    VERIFY(Attribs.CoarseMipWidth == std::max(Attribs.FineMipWidth / 2u, 1u) && Attribs.CoarseMipHeight == std::max(Attribs.FineMipHeight / 2u, 1u),
+           "Coarse mip size is inconsistent with the fine mip size");
+    (void)Attribs;
+}
+
+template <typename ChannelType>
+const ChannelType* GetAlphaRow(const AlphaCoverageAttribs& Attribs, Uint32 row)
+{
+    return reinterpret_cast<const ChannelType*>(reinterpret_cast<const Uint8*>(Attribs.pData) + size_t{row} * Attribs.Stride);
+}
+
+// Returns the smallest alpha value that passes the alpha test
+template <typename ChannelType>
+Uint32 GetAlphaThreshold(float AlphaCutoff)
+{
+    static constexpr float MaxVal = static_cast<float>(std::numeric_limits<ChannelType>::max());
+    // The bias prevents thresholds like 0.2 * 255 from being rounded up to the next value
+    return static_cast<Uint32>(std::max(std::ceil(std::min(std::max(AlphaCutoff, 0.f), 1.f) * MaxVal - 1e-3f), 0.f));
+}
+
+template <typename ChannelType>
+float ComputeAlphaCoverage(const AlphaCoverageAttribs& Attribs)
+{
+    const auto Threshold = GetAlphaThreshold<ChannelType>(Attribs.AlphaCutoff);
+    const auto AlphaChnl = Attribs.NumChannels - 1;
+
+    size_t NumPassed = 0;
+    for (Uint32 row = 0; row < Attribs.Height; ++row)
+    {
+        const auto* pRow = GetAlphaRow<ChannelType>(Attribs, row);
+        for (Uint32 x = 0; x < Attribs.Width; ++x)
+        {
+            if (pRow[x * Attribs.NumChannels + AlphaChnl] >= Threshold)
+                ++NumPassed;
+        }
+    }
+    return static_cast<float>(static_cast<double>(NumPassed) / ((static_cast<double>(Attribs.Width) * static_cast<double>(Attribs.Height))));
+}
+
+template <typename ChannelType>
+float ScaleAlphaToCoverage(const AlphaCoverageAttribs& Attribs, float TargetCoverage)
+{
+    static constexpr Uint32 MaxVal = std::numeric_limits<ChannelType>::max();
+
+    const auto Threshold = GetAlphaThreshold<ChannelType>(Attribs.AlphaCutoff);
+    if (Threshold == 0)
+    {
+        // All pixels pass the test regardless of the scale
+        return 1;
+    }
+
+    const auto AlphaChnl = Attribs.NumChannels - 1;
+
+    // NumPassed[v] is the number of pixels whose alpha is not less than v
+    std::vector<size_t> NumPassed(size_t{MaxVal} + 2);
+    for (Uint32 row = 0; row < Attribs.Height; ++row)
+    {
+        const auto* pRow = GetAlphaRow<ChannelType>(Attribs, row);
+        for (Uint32 x = 0; x < Attribs.Width; ++x)
+            ++NumPassed[pRow[x * Attribs.NumChannels + AlphaChnl]];
+    }
+    for (Uint32 v = MaxVal + 1; v > 0; --v)
+        NumPassed[v - 1] += NumPassed[v];
+
+    // The scaled alpha min(round(v * Scale), MaxVal) passes the test when v is not less than some value
+    // MinPassed. Find MinPassed whose coverage is the closest to the target; zero alpha never passes.
+    // When several values give the same coverage, take the one closest to the threshold to keep the
+    // scale close to one.
+    const auto TargetCount = static_cast<double>(TargetCoverage) * (static_cast<double>(Attribs.Width) * static_cast<double>(Attribs.Height));
+
+    Uint32 MinPassed = Threshold;
+    auto   MinDiff   = std::abs(static_cast<double>(NumPassed[Threshold]) - TargetCount);
+    for (Uint32 v = 1; v <= MaxVal + 1; ++v)
+    {
+        const auto Diff = std::abs(static_cast<double>(NumPassed[v]) - TargetCount);
+        if (Diff < MinDiff || (Diff == MinDiff && std::abs(static_cast<int>(v) - static_cast<int>(Threshold)) < std::abs(static_cast<int>(MinPassed) - static_cast<int>(Threshold))))
+        {
+            MinDiff   = Diff;
+            MinPassed = v;
+        }
+    }
+    if (MinPassed == Threshold)
+        return 1;
+
+    // round(v * Scale) >= Threshold  <=>  v * Scale >= Threshold - 0.5
+    // The scale puts MinPassed - 1 and MinPassed on different sides of the rounding boundary.
+    const auto Scale = (static_cast<float>(Threshold) - 0.5f) / (static_cast<float>(MinPassed) - 0.5f);
+
+    const auto ScaleAlpha = [Scale](Uint32 Alpha) {
+        return static_cast<ChannelType>(std::min(static_cast<float>(Alpha) * Scale + 0.5f, static_cast<float>(MaxVal)));
+    };
+
+    std::vector<ChannelType> ScaledAlpha;
+    if (sizeof(ChannelType) == 1)
+    {
+        ScaledAlpha.resize(MaxVal + 1);
+        for (Uint32 v = 0; v <= MaxVal; ++v)
+            ScaledAlpha[v] = ScaleAlpha(v);
+    }
+
+    for (Uint32 row = 0; row < Attribs.Height; ++row)
+    {
+        auto* pRow = const_cast<ChannelType*>(GetAlphaRow<ChannelType>(Attribs, row));
+        for (Uint32 x = 0; x < Attribs.Width; ++x)
+        {
+            auto& Alpha = pRow[x * Attribs.NumChannels + AlphaChnl];
+            Alpha       = ScaledAlpha.empty() ? ScaleAlpha(Alpha) : ScaledAlpha[Alpha];
+        }
+    }
+
+    return Scale;
+}
+
+void VerifyAlphaCoverageAttribs(const AlphaCoverageAttribs& Attribs)
+{
+    VERIFY_EXPR(Attribs.ComponentType == VT_UINT8 || Attribs.ComponentType == VT_UINT16);
+    VERIFY_EXPR(Attribs.NumChannels > 0);
+    VERIFY_EXPR(Attribs.pData != nullptr && Attribs.Width > 0 && Attribs.Height > 0 && Attribs.Stride > 0);
+    (void)Attribs;
+}
+
+} // namespace
+
+void ComputeCoarseMipRef(const ComputeCoarseMipAttribs& Attribs)
+{
+    VerifyComputeCoarseMipAttribs(Attribs);
+    if (Attribs.Filter != MIP_FILTER_BOX)
+    {
+        if (Attribs.ComponentType == VT_UINT8)
+            ComputeCoarseMipFilteredRef<Uint8>(Attribs);
+        else if (Attribs.ComponentType == VT_UINT16)
+            ComputeCoarseMipFilteredRef<Uint16>(Attribs);
+        else
+            UNEXPECTED("Unsupported component type");
+        return;
+    }
+
+    if (Attribs.ComponentType == VT_UINT8)
+        ComputeCoarseMipRef<Uint8>(Attribs);
+    else if (Attribs.ComponentType == VT_UINT16)
+        ComputeCoarseMipRef<Uint16>(Attribs);
+    else
+        UNEXPECTED("Unsupported component type");
+}
+
+void ComputeCoarseMip(const ComputeCoarseMipAttribs& Attribs)
+{
+    VerifyComputeCoarseMipAttribs(Attribs);
+    if (Attribs.Filter != MIP_FILTER_BOX)
+    {
+        ComputeCoarseMipFiltered(Attribs, 0, Attribs.CoarseMipHeight);
+        return;
+    }
+
+    if (Attribs.ComponentType == VT_UINT8)
+    {
+        if (Attribs.IsSRGB)
+            ComputeCoarseMipSRGB8(Attribs);
+        else
+            ComputeCoarseMipLinear8(Attribs);
+    }
+    else if (Attribs.ComponentType == VT_UINT16)
+    {
+        // 16-bit sRGB data is rare and is averaged with floating-point math
+        if (Attribs.IsSRGB)
+            ComputeCoarseMipRef<Uint16>(Attribs);
+        else
+            ComputeCoarseMipLinear16(Attribs);
+    }
+    else
+    {
+        UNEXPECTED("Unsupported component type");
+    }
+}
+
+Uint32 GetParallelMipRowsPerBand(Uint32 RowStride)
+{
+    // Bands smaller than this are not worth the synchronization overhead
+    constexpr Uint32 MinBandSize = 256 << 10;
+    return std::max(MinBandSize / std::max(RowStride, 1u), 1u);
+}
+
+void ComputeCoarseMipParallel(const ComputeCoarseMipAttribs& Attribs, ThreadPool& Pool)
+{
+    VerifyComputeCoarseMipAttribs(Attribs);
+
+    const auto RowsPerBand = GetParallelMipRowsPerBand(Attribs.CoarseMipStride);
+    const auto NumBands    = (Attribs.CoarseMipHeight + RowsPerBand - 1) / RowsPerBand;
+    if (NumBands <= 1)
+    {
+        ComputeCoarseMip(Attribs);
+        return;
+    }
+
+    if (Attribs.Filter != MIP_FILTER_BOX)
+    {
+        // Every band reads the fine rows it depends on from the complete fine level
+        Pool.ParallelFor(NumBands,
+                         [&](Uint32 Band) {
+                             const auto StartRow = Band * RowsPerBand;
+                             ComputeCoarseMipFiltered(Attribs, StartRow, std::min(RowsPerBand, Attribs.CoarseMipHeight - StartRow));
+                         });
+        return;
+    }
+
+    Pool.ParallelFor(NumBands,
+                     [&](Uint32 Band) {
+                         const auto StartRow = Band * RowsPerBand;
+
+                         auto BandAttribs{Attribs};
+                         BandAttribs.CoarseMipHeight = std::min(RowsPerBand, Attribs.CoarseMipHeight - StartRow);
+                         BandAttribs.pCoarseMipData  = reinterpret_cast<Uint8*>(Attribs.pCoarseMipData) + size_t{StartRow} * Attribs.CoarseMipStride;
+                         // The last row of odd-height fine levels is ignored, as in ComputeCoarseMip()
+                         BandAttribs.FineMipHeight = BandAttribs.CoarseMipHeight * 2;
+                         BandAttribs.pFineMipData  = reinterpret_cast<const Uint8*>(Attribs.pFineMipData) + size_t{StartRow} * 2 * Attribs.FineMipStride;
+                         ComputeCoarseMip(BandAttribs);
+                     });
+}
+
+float ComputeAlphaCoverage(const AlphaCoverageAttribs& Attribs)
+{
+    VerifyAlphaCoverageAttribs(Attribs);
+    if (Attribs.ComponentType == VT_UINT8)
+        return ComputeAlphaCoverage<Uint8>(Attribs);
+    else if (Attribs.ComponentType == VT_UINT16)
+        return ComputeAlphaCoverage<Uint16>(Attribs);
+
+    UNEXPECTED("Unsupported component type");
+    return 0;
+}
+
+float ScaleAlphaToCoverage(const AlphaCoverageAttribs& Attribs, float TargetCoverage)
+{
+    VerifyAlphaCoverageAttribs(Attribs);
+    if (Attribs.ComponentType == VT_UINT8)
+        return ScaleAlphaToCoverage<Uint8>(Attribs, TargetCoverage);
+    else if (Attribs.ComponentType == VT_UINT16)
+        return ScaleAlphaToCoverage<Uint16>(Attribs, TargetCoverage);
+
+    UNEXPECTED("Unsupported component type");
+    return 1;
+}
+
+void ComputeMipChain(const ComputeMipChainAttribs& Attribs)
+{
+    DEV_CHECK_ERR(Attribs.pMips != nullptr || Attribs.MipLevels == 0, "Mip levels must not be null");
+    VERIFY(Attribs.MipLevels <= ComputeMipLevelsCount(Attribs.Width, Attribs.Height), "Too many mip levels");
+
+    const auto PreserveAlphaCoverage = Attribs.AlphaCutoff > 0 && Attribs.NumChannels == 4;
+
+    AlphaCoverageAttribs CoverageAttribs;
+    CoverageAttribs.ComponentType = Attribs.ComponentType;
+    CoverageAttribs.NumChannels   = Attribs.NumChannels;
+    CoverageAttribs.AlphaCutoff   = Attribs.AlphaCutoff;
+
+    float TargetCoverage = 0;
+    if (PreserveAlphaCoverage && Attribs.MipLevels > 1)
+    {
+        CoverageAttribs.pData  = Attribs.pMips[0].pData;
+        CoverageAttribs.Stride = Attribs.pMips[0].Stride;
+        CoverageAttribs.Width  = Attribs.Width;
+        CoverageAttribs.Height = Attribs.Height;
+        TargetCoverage         = ComputeAlphaCoverage(CoverageAttribs);
+    }
+
+    ComputeCoarseMipAttribs MipAttribs;
+    MipAttribs.ComponentType = Attribs.ComponentType;
+    MipAttribs.NumChannels   = Attribs.NumChannels;
+    MipAttribs.IsSRGB        = Attribs.IsSRGB;
+    MipAttribs.Filter        = Attribs.Filter;
+    for (Uint32 mip = 1; mip < Attribs.MipLevels; ++mip)
+    {
+        MipAttribs.pFineMipData    = Attribs.pMips[mip - 1].pData;
+        MipAttribs.FineMipStride   = Attribs.pMips[mip - 1].Stride;
+        MipAttribs.FineMipWidth    = std::max(Attribs.Width >> (mip - 1), 1u);
+        MipAttribs.FineMipHeight   = std::max(Attribs.Height >> (mip - 1), 1u);
+        MipAttribs.pCoarseMipData  = Attribs.pMips[mip].pData;
+        MipAttribs.CoarseMipStride = Attribs.pMips[mip].Stride;
+        MipAttribs.CoarseMipWidth  = std::max(Attribs.Width >> mip, 1u);
+        MipAttribs.CoarseMipHeight = std::max(Attribs.Height >> mip, 1u);
+        if (Attribs.pThreadPool != nullptr)
+            ComputeCoarseMipParallel(MipAttribs, *Attribs.pThreadPool);
+        else
+            ComputeCoarseMip(MipAttribs);
+
+        if (PreserveAlphaCoverage)
+        {
+            CoverageAttribs.pData  = MipAttribs.pCoarseMipData;
+            CoverageAttribs.Stride = MipAttribs.CoarseMipStride;
+            CoverageAttribs.Width  = MipAttribs.CoarseMipWidth;
+            CoverageAttribs.Height = MipAttribs.CoarseMipHeight;
+            ScaleAlphaToCoverage(CoverageAttribs, TargetCoverage);
+        }
+    }
+}
+
+StreamingMipGenerator::StreamingMipGenerator(const CreateInfo& CI, RowsHandlerType Handler) :
+    m_CI{CI},
+    m_Handler{std::move(Handler)}
+{
+    VERIFY_EXPR(CI.ComponentType == VT_UINT8 || CI.ComponentType == VT_UINT16);
+    VERIFY_EXPR(CI.NumChannels > 0 && CI.Width > 0 && CI.Height > 0);
+
+    auto MipLevels = ComputeMipLevelsCount(CI.Width, CI.Height);
+    if (CI.MipLevels > 0)
+        MipLevels = std::min(MipLevels, CI.MipLevels);
+
+    const auto PixelSize = CI.NumChannels * GetValueSize(CI.ComponentType);
+
+    m_Levels.resize(MipLevels);
+    for (Uint32 mip = 0; mip < MipLevels; ++mip)
+    {
+        auto& Level     = m_Levels[mip];
+        Level.Width     = std::max(CI.Width >> mip, 1u);
+        Level.Height    = std::max(CI.Height >> mip, 1u);
+        Level.RowSize   = Level.Width * PixelSize;
+        Level.RowStride = Align(Level.RowSize, 4u);
+        if (mip + 1 < MipLevels)
+            Level.PendingRows.resize(size_t{Level.RowStride} * 2);
+    }
+}
+
+size_t StreamingMipGenerator::GetScratchMemorySize() const
+{
+    size_t Size = 0;
+    for (const auto& Level : m_Levels)
+        Size += Level.PendingRows.size() + Level.CoarseRows.size();
+    return Size;
+}
+
+void StreamingMipGenerator::AddRows(const void* pData, Uint32 Stride, Uint32 NumRows)
+{
+    DEV_CHECK_ERR(m_Levels[0].NumRows + NumRows <= m_Levels[0].Height, "Too many rows are added");
+    if (NumRows > 0)
+        ProcessRows(0, reinterpret_cast<const Uint8*>(pData), Stride, NumRows);
+}
+
+void StreamingMipGenerator::ProcessRows(Uint32 Mip, const Uint8* pData, Uint32 Stride, Uint32 NumRows)
+{
+    auto& Level = m_Levels[Mip];
+
+    const auto FirstRow = Level.NumRows;
+    m_Handler(Mip, FirstRow, NumRows, pData, Stride);
+    Level.NumRows += NumRows;
+
+    if (Mip + 1 == m_Levels.size())
+        return;
+
+    auto& CoarseLevel = m_Levels[Mip + 1];
+
+    // The last row of an odd-height level is not used, unless the level has only one row
+    const auto NumUsedRows = Level.Height == 1 ? 1 : CoarseLevel.Height * 2;
+    if (FirstRow >= NumUsedRows)
+        return;
+    NumRows = std::min(NumRows, NumUsedRows - FirstRow);
+
+    const auto MaxCoarseRows = (NumRows + 1) / 2;
+    if (Level.CoarseRows.size() < size_t{MaxCoarseRows} * CoarseLevel.RowStride)
+        Level.CoarseRows.resize(size_t{MaxCoarseRows} * CoarseLevel.RowStride);
+
+    ComputeCoarseMipAttribs Attribs;
+    Attribs.ComponentType   = m_CI.ComponentType;
+    Attribs.NumChannels     = m_CI.NumChannels;
+    Attribs.IsSRGB          = m_CI.IsSRGB;
+    Attribs.FineMipWidth    = Level.Width;
+    Attribs.CoarseMipWidth  = CoarseLevel.Width;
+    Attribs.CoarseMipStride = CoarseLevel.RowStride;
+
+    Uint32     NumCoarseRows = 0;
+    const auto ComputeRows   = [&](const Uint8* pFineRows, Uint32 FineStride, Uint32 NumFineRows) {
+        Attribs.pFineMipData    = pFineRows;
+        Attribs.FineMipStride   = FineStride;
+        Attribs.FineMipHeight   = NumFineRows;
+        Attribs.pCoarseMipData  = Level.CoarseRows.data() + size_t{NumCoarseRows} * CoarseLevel.RowStride;
+        Attribs.CoarseMipHeight = std::max(NumFineRows / 2, 1u);
+        if (m_CI.pThreadPool != nullptr)
+            ComputeCoarseMipParallel(Attribs, *m_CI.pThreadPool);
+        else
+            ComputeCoarseMip(Attribs);
+        NumCoarseRows += Attribs.CoarseMipHeight;
+    };
+
+    if (Level.HasPendingRow)
+    {
+        // Complete the pair that was started by the previous band
+        memcpy(Level.PendingRows.data() + Level.RowStride, pData, Level.RowSize);
+        ComputeRows(Level.PendingRows.data(), Level.RowStride, 2);
+        Level.HasPendingRow = false;
+        pData += Stride;
+        --NumRows;
+    }
+
+    const auto NumPairs = NumRows / 2;
+    if (NumPairs > 0)
+    {
+        ComputeRows(pData, Stride, NumPairs * 2);
+        pData += size_t{NumPairs} * 2 * Stride;
+        NumRows -= NumPairs * 2;
+    }
+
+    if (NumRows > 0)
+    {
+        VERIFY_EXPR(NumRows == 1);
+        if (Level.Height == 1)
+        {
+            ComputeRows(pData, Stride, 1);
+        }
+        else
+        {
+            memcpy(Level.PendingRows.data(), pData, Level.RowSize);
+            Level.HasPendingRow = true;
+        }
+    }
+
+    if (NumCoarseRows > 0)
+        ProcessRows(Mip + 1, Level.CoarseRows.data(), CoarseLevel.RowStride, NumCoarseRows);
+}
+
+} // namespace Diligent
@@ -42,60 +42,18 @@ typedef struct PNGReadFnState PNGReadFnState;
 
 static void PngReadCallback(png_structp pngPtr, png_bytep data, png_size_t length)
 {
-    PNGReadFnState* pState  = (PNGReadFnState*)(png_get_io_ptr(pngPtr));
-    Uint8*          pDstPtr = (Uint8*)IDataBlob_GetDataPtr(pState->pPngBits) + pState->Offset;
+    PNGReadFnState* pState = (PNGReadFnState*)(png_get_io_ptr(pngPtr));
+    if (length > IDataBlob_GetSize(pState->pPngBits) - pState->Offset)
+        png_error(pngPtr, "Unexpected end of PNG data");
+
+    Uint8* pDstPtr = (Uint8*)IDataBlob_GetDataPtr(pState->pPngBits) + pState->Offset;
     memcpy(data, pDstPtr, length);
     pState->Offset += length;
 }
 
-DECODE_PNG_RESULT Diligent_DecodePng(IDataBlob* pSrcPngBits,
-                                     IDataBlob* pDstPixels,
-                                     ImageDesc* pDstImgDesc)
+// Sets up the transformations, reads the image header and returns the description of the decoded image
+static DECODE_PNG_RESULT ReadPngInfo(png_structp png, png_infop info, ImageDesc* pDstImgDesc)
 {
-    if (!pSrcPngBits || !pDstPixels || !pDstImgDesc)
-        return DECODE_PNG_RESULT_INVALID_ARGUMENTS;
-
-    // http://www.piko3d.net/tutorials/libpng-tutorial-loading-png-files-from-streams/
-    // http://www.libpng.org/pub/png/book/chapter13.html#png.ch13.div.10
-    // https://gist.github.com/niw/5963798
-
-    const size_t    PngSigSize = 8;
-    png_const_bytep pngsig     = (png_const_bytep)IDataBlob_GetDataPtr(pSrcPngBits);
-    //Let LibPNG check the signature. If this function returns 0, everything is OK.
-    if (png_sig_cmp(pngsig, 0, PngSigSize) != 0)
-    {
-        return DECODE_PNG_RESULT_INVALID_SIGNATURE;
-    }
-
-    png_structp png = png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
-    if (!png)
-    {
-        return DECODE_PNG_RESULT_INITIALIZATION_FAILED;
-    }
-
-    png_infop info = png_create_info_struct(png);
-    if (!info)
-    {
-        png_destroy_read_struct(&png, &info, (png_infopp)0);
-        return DECODE_PNG_RESULT_INITIALIZATION_FAILED;
-    }
-
-    png_bytep* rowPtrs = NULL;
-    if (setjmp(png_jmpbuf(png)))
-    {
-        if (rowPtrs)
-            free(rowPtrs);
-        // When an error occurs during parsing, libPNG will jump to here
-        png_destroy_read_struct(&png, &info, (png_infopp)0);
-        return DECODE_PNG_RESULT_DECODING_ERROR;
-    }
-
-    PNGReadFnState ReadState;
-    ReadState.pPngBits = pSrcPngBits;
-    ReadState.Offset   = 0;
-
-    png_set_read_fn(png, (png_voidp)&ReadState, PngReadCallback);
-
     png_read_info(png, info);
 
     png_byte bit_depth = png_get_bit_depth(png, info);
@@ -126,6 +84,9 @@ DECODE_PNG_RESULT Diligent_DecodePng(IDataBlob* pSrcPngBits,
     if (png_get_valid(png, info, PNG_INFO_tRNS))
         png_set_tRNS_to_alpha(png);
 
+    // Interlace handling must be enabled before png_read_update_info()
+    png_set_interlace_handling(png);
+
 #if 0
     // These color_type don't have an alpha channel then fill it with 0xff.
     if( color_type == PNG_COLOR_TYPE_RGB ||
@@ -149,22 +110,76 @@ DECODE_PNG_RESULT Diligent_DecodePng(IDataBlob* pSrcPngBits,
         case 8: pDstImgDesc->ComponentType = VT_UINT8; break;
         case 16: pDstImgDesc->ComponentType = VT_UINT16; break;
         case 32: pDstImgDesc->ComponentType = VT_UINT32; break;
-        default:
-        {
-            png_destroy_read_struct(&png, &info, (png_infopp)0);
-            return DECODE_PNG_RESULT_INVALID_BIT_DEPTH;
-        }
+        default: return DECODE_PNG_RESULT_INVALID_BIT_DEPTH;
     }
 
-    //Array of row pointers. One for every row.
-    rowPtrs = malloc(sizeof(png_bytep) * pDstImgDesc->Height);
-
-    //Alocate a buffer with enough space.
     pDstImgDesc->RowStride = pDstImgDesc->Width * (Uint32)bit_depth * pDstImgDesc->NumComponents / 8u;
     // Align stride to 4 bytes
     pDstImgDesc->RowStride = (pDstImgDesc->RowStride + 3u) & ~3u;
 
-    IDataBlob_Resize(pDstPixels, pDstImgDesc->Height * pDstImgDesc->RowStride);
+    return DECODE_PNG_RESULT_OK;
+}
+
+DECODE_PNG_RESULT Diligent_DecodePng(IDataBlob* pSrcPngBits,
+                                     IDataBlob* pDstPixels,
+                                     ImageDesc* pDstImgDesc)
+{
+    if (!pSrcPngBits || !pDstPixels || !pDstImgDesc)
+        return DECODE_PNG_RESULT_INVALID_ARGUMENTS;
+
+    // http://www.piko3d.net/tutorials/libpng-tutorial-loading-png-files-from-streams/
+    // http://www.libpng.org/pub/png/book/chapter13.html#png.ch13.div.10
+    // https://gist.github.com/niw/5963798
+
+    const size_t    PngSigSize = 8;
+    png_const_bytep pngsig     = (png_const_bytep)IDataBlob_GetDataPtr(pSrcPngBits);
+    //Let LibPNG check the signature. If this function returns 0, everything is OK.
+    if (IDataBlob_GetSize(pSrcPngBits) < PngSigSize || png_sig_cmp(pngsig, 0, PngSigSize) != 0)
+    {
+        return DECODE_PNG_RESULT_INVALID_SIGNATURE;
+    }
+
+    png_structp png = png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+    if (!png)
+    {
+        return DECODE_PNG_RESULT_INITIALIZATION_FAILED;
+    }
+
+    png_infop info = png_create_info_struct(png);
+    if (!info)
+    {
+        png_destroy_read_struct(&png, &info, (png_infopp)0);
+        return DECODE_PNG_RESULT_INITIALIZATION_FAILED;
+    }
+
+    png_bytep* rowPtrs = NULL;
+    if (setjmp(png_jmpbuf(png)))
+    {
+        if (rowPtrs)
+            free(rowPtrs);
+        // When an error occurs during parsing, libPNG will jump to here
+        png_destroy_read_struct(&png, &info, (png_infopp)0);
+        return DECODE_PNG_RESULT_DECODING_ERROR;
+    }
+
+    PNGReadFnState ReadState;
+    ReadState.pPngBits = pSrcPngBits;
+    ReadState.Offset   = 0;
+
+    png_set_read_fn(png, (png_voidp)&ReadState, PngReadCallback);
+
+    DECODE_PNG_RESULT Res = ReadPngInfo(png, info, pDstImgDesc);
+    if (Res != DECODE_PNG_RESULT_OK)
+    {
+        png_destroy_read_struct(&png, &info, (png_infopp)0);
+        return Res;
+    }
+
+    //Array of row pointers. One for every row.
+    rowPtrs = malloc(sizeof(png_bytep) * pDstImgDesc->Height);
+
+    //Alocate a buffer with enough space.
+    IDataBlob_Resize(pDstPixels, (size_t)pDstImgDesc->Height * pDstImgDesc->RowStride);
     png_bytep pRow0 = IDataBlob_GetDataPtr(pDstPixels);
     for (size_t i = 0; i < pDstImgDesc->Height; i++)
         rowPtrs[i] = pRow0 + i * pDstImgDesc->RowStride;
@@ -179,6 +194,130 @@ DECODE_PNG_RESULT Diligent_DecodePng(IDataBlob* pSrcPngBits,
     return DECODE_PNG_RESULT_OK;
 }
 
+struct PNGRowDecoder
+{
+    png_structp    png;
+    png_infop      info;
+    PNGReadFnState ReadState;
+
+    Uint32 Height;
+    Uint32 RowSize;
+    Uint32 NextRow;
+    int    Interlaced;
+
+    // The whole image when the image is interlaced
+    png_bytep pImage;
+};
+
+DECODE_PNG_RESULT Diligent_CreatePngRowDecoder(IDataBlob*      pSrcPngBits,
+                                               ImageDesc*      pDstImgDesc,
+                                               PNGRowDecoder** ppDecoder)
+{
+    if (!pSrcPngBits || !pDstImgDesc || !ppDecoder)
+        return DECODE_PNG_RESULT_INVALID_ARGUMENTS;
+
+    *ppDecoder = NULL;
+
+    const size_t    PngSigSize = 8;
+    png_const_bytep pngsig     = (png_const_bytep)IDataBlob_GetDataPtr(pSrcPngBits);
+    if (IDataBlob_GetSize(pSrcPngBits) < PngSigSize || png_sig_cmp(pngsig, 0, PngSigSize) != 0)
+        return DECODE_PNG_RESULT_INVALID_SIGNATURE;
+
+    PNGRowDecoder* pDecoder = calloc(1, sizeof(PNGRowDecoder));
+    if (!pDecoder)
+        return DECODE_PNG_RESULT_INITIALIZATION_FAILED;
+
+    pDecoder->png = png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+    if (pDecoder->png)
+        pDecoder->info = png_create_info_struct(pDecoder->png);
+    if (!pDecoder->png || !pDecoder->info)
+    {
+        Diligent_DestroyPngRowDecoder(pDecoder);
+        return DECODE_PNG_RESULT_INITIALIZATION_FAILED;
+    }
+
+    if (setjmp(png_jmpbuf(pDecoder->png)))
+    {
+        Diligent_DestroyPngRowDecoder(pDecoder);
+        return DECODE_PNG_RESULT_DECODING_ERROR;
+    }
+
+    pDecoder->ReadState.pPngBits = pSrcPngBits;
+    pDecoder->ReadState.Offset   = 0;
+    png_set_read_fn(pDecoder->png, (png_voidp)&pDecoder->ReadState, PngReadCallback);
+
+    DECODE_PNG_RESULT Res = ReadPngInfo(pDecoder->png, pDecoder->info, pDstImgDesc);
+    if (Res != DECODE_PNG_RESULT_OK)
+    {
+        Diligent_DestroyPngRowDecoder(pDecoder);
+        return Res;
+    }
+
+    pDecoder->Interlaced = png_get_interlace_type(pDecoder->png, pDecoder->info) != PNG_INTERLACE_NONE;
+    pDecoder->Height     = pDstImgDesc->Height;
+    pDecoder->RowSize    = (Uint32)png_get_rowbytes(pDecoder->png, pDecoder->info);
+
+    *ppDecoder = pDecoder;
+    return DECODE_PNG_RESULT_OK;
+}
+
+DECODE_PNG_RESULT Diligent_DecodePngRows(PNGRowDecoder* pDecoder,
+                                         Uint8*         pDstRows,
+                                         Uint32         DstStride,
+                                         Uint32         NumRows)
+{
+    if (!pDecoder || !pDstRows || NumRows > pDecoder->Height - pDecoder->NextRow)
+        return DECODE_PNG_RESULT_INVALID_ARGUMENTS;
+
+    png_bytep* volatile rowPtrs = NULL;
+    if (setjmp(png_jmpbuf(pDecoder->png)))
+    {
+        if (rowPtrs)
+            free(rowPtrs);
+        return DECODE_PNG_RESULT_DECODING_ERROR;
+    }
+
+    if (pDecoder->Interlaced)
+    {
+        if (!pDecoder->pImage)
+        {
+            // Every pass updates all rows, so the whole image has to be decoded
+            pDecoder->pImage = malloc((size_t)pDecoder->Height * pDecoder->RowSize);
+            rowPtrs          = malloc(sizeof(png_bytep) * pDecoder->Height);
+            if (!pDecoder->pImage || !rowPtrs)
+                png_error(pDecoder->png, "Failed to allocate memory for the interlaced image");
+            for (size_t i = 0; i < pDecoder->Height; ++i)
+                rowPtrs[i] = pDecoder->pImage + i * pDecoder->RowSize;
+            png_read_image(pDecoder->png, rowPtrs);
+            free(rowPtrs);
+            rowPtrs = NULL;
+        }
+
+        for (Uint32 i = 0; i < NumRows; ++i)
+            memcpy(pDstRows + (size_t)i * DstStride, pDecoder->pImage + (size_t)(pDecoder->NextRow + i) * pDecoder->RowSize, pDecoder->RowSize);
+    }
+    else
+    {
+        for (Uint32 i = 0; i < NumRows; ++i)
+            png_read_row(pDecoder->png, pDstRows + (size_t)i * DstStride, NULL);
+    }
+    pDecoder->NextRow += NumRows;
+
+    return DECODE_PNG_RESULT_OK;
+}
+
+void Diligent_DestroyPngRowDecoder(PNGRowDecoder* pDecoder)
+{
+    if (!pDecoder)
+        return;
+
+    if (pDecoder->png)
+        png_destroy_read_struct(&pDecoder->png, pDecoder->info ? &pDecoder->info : (png_infopp)0, (png_infopp)0);
+    if (pDecoder->pImage)
+        free(pDecoder->pImage);
+    free(pDecoder);
+}
+
 static void PngWriteCallback(png_structp png_ptr, png_bytep data, png_size_t length)
 {
     IDataBlob* pEncodedData = (IDataBlob*)png_get_io_ptr(png_ptr);
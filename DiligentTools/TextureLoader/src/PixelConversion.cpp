@@ -0,0 +1,425 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+#include "pch.h"
+
+#include "PixelConversion.hpp"
+
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#    define DILIGENT_PIXEL_CONVERSION_X86 1
+#    include <immintrin.h>
+#    if defined(_MSC_VER)
+#        include <intrin.h>
+// MSVC allows intrinsics of any instruction set in any function
+#        define DILIGENT_TARGET_SSSE3
+#        define DILIGENT_TARGET_F16C
+#    else
+#        include <cpuid.h>
+#        define DILIGENT_TARGET_SSSE3 __attribute__((target("ssse3")))
+#        define DILIGENT_TARGET_F16C  __attribute__((target("avx,f16c")))
+#    endif
+#else
+#    define DILIGENT_PIXEL_CONVERSION_X86 0
+#endif
+
+namespace Diligent
+{
+
+void ExpandRGB8ToRGBA8Ref(const Uint8* pSrc, Uint8* pDst, size_t NumPixels)
+{
+    for (size_t i = 0; i < NumPixels; ++i, pSrc += 3, pDst += 4)
+    {
+        pDst[0] = pSrc[0];
+        pDst[1] = pSrc[1];
+        pDst[2] = pSrc[2];
+        pDst[3] = 255;
+    }
+}
+
+void ExpandRGB16ToRGBA16Ref(const Uint16* pSrc, Uint16* pDst, size_t NumPixels)
+{
+    for (size_t i = 0; i < NumPixels; ++i, pSrc += 3, pDst += 4)
+    {
+        pDst[0] = pSrc[0];
+        pDst[1] = pSrc[1];
+        pDst[2] = pSrc[2];
+        pDst[3] = 65535;
+    }
+}
+
+void ExpandGray8ToRGBA8Ref(const Uint8* pSrc, Uint8* pDst, size_t NumPixels)
+{
+    for (size_t i = 0; i < NumPixels; ++i, pDst += 4)
+    {
+        const auto Gray = pSrc[i];
+
+        pDst[0] = Gray;
+        pDst[1] = Gray;
+        pDst[2] = Gray;
+        pDst[3] = 255;
+    }
+}
+
+void SwapRB8Ref(const Uint8* pSrc, Uint8* pDst, size_t NumPixels)
+{
+    for (size_t i = 0; i < NumPixels; ++i, pSrc += 4, pDst += 4)
+    {
+        const auto R = pSrc[0];
+        const auto B = pSrc[2];
+
+        pDst[0] = B;
+        pDst[1] = pSrc[1];
+        pDst[2] = R;
+        pDst[3] = pSrc[3];
+    }
+}
+
+void PackRGBA8ToRGB8Ref(const Uint8* pSrc, Uint8* pDst, size_t NumPixels, bool SwapRB)
+{
+    const size_t R = SwapRB ? 2 : 0;
+    const size_t B = SwapRB ? 0 : 2;
+    for (size_t i = 0; i < NumPixels; ++i, pSrc += 4, pDst += 3)
+    {
+        pDst[0] = pSrc[R];
+        pDst[1] = pSrc[1];
+        pDst[2] = pSrc[B];
+    }
+}
+
+namespace
+{
+
+Uint16 FloatToHalf(float Value)
+{
+    Uint32 Bits;
+    memcpy(&Bits, &Value, sizeof(Bits));
+
+    const Uint32 Sign = (Bits >> 16) & 0x8000u;
+    const Uint32 Abs  = Bits & 0x7FFFFFFFu;
+
+    if (Abs >= 0x7F800000u)
+    {
+        // Infinity or NaN. NaNs are made quiet and keep the upper bits of the payload.
+        return static_cast<Uint16>(Sign | (Abs > 0x7F800000u ? 0x7E00u | ((Abs >> 13) & 0x3FFu) : 0x7C00u));
+    }
+
+    // Values from 65520 up round to infinity
+    if (Abs >= 0x477FF000u)
+        return static_cast<Uint16>(Sign | 0x7C00u);
+
+    Uint32 Half;
+    Uint32 Rem;
+    Uint32 HalfUlp;
+    if (Abs < 0x38800000u)
+    {
+        // The result is a denormal: Mantissa * 2^(Exp - 150) = Half * 2^-24
+        const Uint32 Exp   = Abs >> 23;
+        const Uint32 Shift = 126 - Exp;
+        if (Shift > 24)
+            return static_cast<Uint16>(Sign);
+
+        const Uint32 Mantissa = (Abs & 0x7FFFFFu) | 0x800000u;
+
+        Half    = Mantissa >> Shift;
+        Rem     = Mantissa & ((1u << Shift) - 1u);
+        HalfUlp = 1u << (Shift - 1);
+    }
+    else
+    {
+        // Rebias the exponent from 127 to 15 and drop 13 mantissa bits
+        Half    = (Abs - 0x38000000u) >> 13;
+        Rem     = Abs & 0x1FFFu;
+        HalfUlp = 0x1000u;
+    }
+
+    // Round to nearest even. Carry into the exponent gives the correct result.
+    if (Rem > HalfUlp || (Rem == HalfUlp && (Half & 1u) != 0))
+        ++Half;
+
+    return static_cast<Uint16>(Sign | Half);
+}
+
+} // namespace
+
+void ConvertFloatToHalfRef(const float* pSrc, Uint16* pDst, size_t NumValues)
+{
+    for (size_t i = 0; i < NumValues; ++i)
+        pDst[i] = FloatToHalf(pSrc[i]);
+}
+
+
+namespace
+{
+
+#if DILIGENT_PIXEL_CONVERSION_X86
+
+struct CPUFeatures
+{
+    bool SSSE3 = false;
+    bool F16C  = false;
+};
+
+CPUFeatures GetCPUFeatures()
+{
+    CPUFeatures Features;
+
+    Uint32 Regs[4] = {}; // eax, ebx, ecx, edx
+#    if defined(_MSC_VER)
+    __cpuid(reinterpret_cast<int*>(Regs), 1);
+#    else
+    if (!__get_cpuid(1, &Regs[0], &Regs[1], &Regs[2], &Regs[3]))
+        return Features;
+#    endif
+
+    const auto ECX = Regs[2];
+
+    Features.SSSE3 = (ECX & (1u << 9)) != 0;
+
+    // F16C instructions are VEX-encoded, so the OS must save AVX registers
+    const bool OSXSAVE = (ECX & (1u << 27)) != 0;
+    const bool AVX     = (ECX & (1u << 28)) != 0;
+    const bool F16C    = (ECX & (1u << 29)) != 0;
+    if (OSXSAVE && AVX && F16C)
+    {
+#    if defined(_MSC_VER)
+        const auto XCR0 = _xgetbv(0);
+#    else
+        Uint32 XCR0Lo = 0, XCR0Hi = 0;
+        __asm__ volatile("xgetbv"
+                         : "=a"(XCR0Lo), "=d"(XCR0Hi)
+                         : "c"(0));
+        const auto XCR0 = XCR0Lo;
+#    endif
+        Features.F16C = (XCR0 & 0x6) == 0x6;
+    }
+
+    return Features;
+}
+
+// Every iteration converts 16 pixels: 48 source bytes make four groups of four pixels
+DILIGENT_TARGET_SSSE3 void ExpandRGB8ToRGBA8SSSE3(const Uint8* pSrc, Uint8* pDst, size_t NumPixels)
+{
+    const auto Shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    const auto Alpha   = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+
+    size_t i = 0;
+    for (; i + 16 <= NumPixels; i += 16, pSrc += 48, pDst += 64)
+    {
+        const auto In0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc));
+        const auto In1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + 16));
+        const auto In2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + 32));
+
+        const auto Px0 = In0;
+        const auto Px1 = _mm_alignr_epi8(In1, In0, 12);
+        const auto Px2 = _mm_alignr_epi8(In2, In1, 8);
+        const auto Px3 = _mm_srli_si128(In2, 4);
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDst), _mm_or_si128(_mm_shuffle_epi8(Px0, Shuffle), Alpha));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + 16), _mm_or_si128(_mm_shuffle_epi8(Px1, Shuffle), Alpha));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + 32), _mm_or_si128(_mm_shuffle_epi8(Px2, Shuffle), Alpha));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + 48), _mm_or_si128(_mm_shuffle_epi8(Px3, Shuffle), Alpha));
+    }
+    ExpandRGB8ToRGBA8Ref(pSrc, pDst, NumPixels - i);
+}
+
+// Every iteration converts 8 pixels: 48 source bytes make four groups of two pixels
+DILIGENT_TARGET_SSSE3 void ExpandRGB16ToRGBA16SSSE3(const Uint16* pSrc, Uint16* pDst, size_t NumPixels)
+{
+    const auto Shuffle = _mm_setr_epi8(0, 1, 2, 3, 4, 5, -1, -1, 6, 7, 8, 9, 10, 11, -1, -1);
+    const auto Alpha   = _mm_set1_epi64x(static_cast<long long>(0xFFFF000000000000ull));
+
+    size_t i = 0;
+    for (; i + 8 <= NumPixels; i += 8, pSrc += 24, pDst += 32)
+    {
+        const auto In0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc));
+        const auto In1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + 8));
+        const auto In2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + 16));
+
+        const auto Px0 = In0;
+        const auto Px1 = _mm_alignr_epi8(In1, In0, 12);
+        const auto Px2 = _mm_alignr_epi8(In2, In1, 8);
+        const auto Px3 = _mm_srli_si128(In2, 4);
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDst), _mm_or_si128(_mm_shuffle_epi8(Px0, Shuffle), Alpha));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + 8), _mm_or_si128(_mm_shuffle_epi8(Px1, Shuffle), Alpha));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + 16), _mm_or_si128(_mm_shuffle_epi8(Px2, Shuffle), Alpha));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + 24), _mm_or_si128(_mm_shuffle_epi8(Px3, Shuffle), Alpha));
+    }
+    ExpandRGB16ToRGBA16Ref(pSrc, pDst, NumPixels - i);
+}
+
+DILIGENT_TARGET_SSSE3 void ExpandGray8ToRGBA8SSSE3(const Uint8* pSrc, Uint8* pDst, size_t NumPixels)
+{
+    const auto Shuffle0 = _mm_setr_epi8(0, 0, 0, -1, 1, 1, 1, -1, 2, 2, 2, -1, 3, 3, 3, -1);
+    const auto Shuffle1 = _mm_setr_epi8(4, 4, 4, -1, 5, 5, 5, -1, 6, 6, 6, -1, 7, 7, 7, -1);
+    const auto Shuffle2 = _mm_setr_epi8(8, 8, 8, -1, 9, 9, 9, -1, 10, 10, 10, -1, 11, 11, 11, -1);
+    const auto Shuffle3 = _mm_setr_epi8(12, 12, 12, -1, 13, 13, 13, -1, 14, 14, 14, -1, 15, 15, 15, -1);
+    const auto Alpha    = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+
+    size_t i = 0;
+    for (; i + 16 <= NumPixels; i += 16, pSrc += 16, pDst += 64)
+    {
+        const auto In = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDst), _mm_or_si128(_mm_shuffle_epi8(In, Shuffle0), Alpha));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + 16), _mm_or_si128(_mm_shuffle_epi8(In, Shuffle1), Alpha));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + 32), _mm_or_si128(_mm_shuffle_epi8(In, Shuffle2), Alpha));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + 48), _mm_or_si128(_mm_shuffle_epi8(In, Shuffle3), Alpha));
+    }
+    ExpandGray8ToRGBA8Ref(pSrc, pDst, NumPixels - i);
+}
+
+DILIGENT_TARGET_SSSE3 void SwapRB8SSSE3(const Uint8* pSrc, Uint8* pDst, size_t NumPixels)
+{
+    const auto Shuffle = _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+
+    size_t i = 0;
+    for (; i + 8 <= NumPixels; i += 8, pSrc += 32, pDst += 32)
+    {
+        const auto In0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc));
+        const auto In1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + 16));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDst), _mm_shuffle_epi8(In0, Shuffle));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + 16), _mm_shuffle_epi8(In1, Shuffle));
+    }
+    SwapRB8Ref(pSrc, pDst, NumPixels - i);
+}
+
+// Every iteration packs 16 pixels: four groups of 12 bytes are merged into three 16-byte stores
+DILIGENT_TARGET_SSSE3 void PackRGBA8ToRGB8SSSE3(const Uint8* pSrc, Uint8* pDst, size_t NumPixels, bool SwapRB)
+{
+    const auto Shuffle = SwapRB ?
+        _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1) :
+        _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+
+    size_t i = 0;
+    for (; i + 16 <= NumPixels; i += 16, pSrc += 64, pDst += 48)
+    {
+        const auto Px0 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc)), Shuffle);
+        const auto Px1 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + 16)), Shuffle);
+        const auto Px2 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + 32)), Shuffle);
+        const auto Px3 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + 48)), Shuffle);
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDst), _mm_or_si128(Px0, _mm_slli_si128(Px1, 12)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + 16), _mm_or_si128(_mm_srli_si128(Px1, 4), _mm_slli_si128(Px2, 8)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + 32), _mm_or_si128(_mm_srli_si128(Px2, 8), _mm_slli_si128(Px3, 4)));
+    }
+    PackRGBA8ToRGB8Ref(pSrc, pDst, NumPixels - i, SwapRB);
+}
+
+DILIGENT_TARGET_F16C void ConvertFloatToHalfF16C(const float* pSrc, Uint16* pDst, size_t NumValues)
+{
+    size_t i = 0;
+    for (; i + 8 <= NumValues; i += 8)
+    {
+        const auto Half = _mm256_cvtps_ph(_mm256_loadu_ps(pSrc + i), _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + i), Half);
+    }
+    ConvertFloatToHalfRef(pSrc + i, pDst + i, NumValues - i);
+}
+
+#endif
+
+struct PixelConversionFunctions
+{
+    decltype(&ExpandRGB8ToRGBA8Ref)   ExpandRGB8ToRGBA8   = ExpandRGB8ToRGBA8Ref;
+    decltype(&ExpandRGB16ToRGBA16Ref) ExpandRGB16ToRGBA16 = ExpandRGB16ToRGBA16Ref;
+    decltype(&ExpandGray8ToRGBA8Ref)  ExpandGray8ToRGBA8  = ExpandGray8ToRGBA8Ref;
+    decltype(&SwapRB8Ref)             SwapRB8             = SwapRB8Ref;
+    decltype(&PackRGBA8ToRGB8Ref)     PackRGBA8ToRGB8     = PackRGBA8ToRGB8Ref;
+    decltype(&ConvertFloatToHalfRef)  ConvertFloatToHalf  = ConvertFloatToHalfRef;
+
+    const char* ISA = "Scalar";
+};
+
+PixelConversionFunctions SelectFunctions()
+{
+    PixelConversionFunctions Funcs;
+#if DILIGENT_PIXEL_CONVERSION_X86
+    const auto Features = GetCPUFeatures();
+    if (Features.SSSE3)
+    {
+        Funcs.ExpandRGB8ToRGBA8   = ExpandRGB8ToRGBA8SSSE3;
+        Funcs.ExpandRGB16ToRGBA16 = ExpandRGB16ToRGBA16SSSE3;
+        Funcs.ExpandGray8ToRGBA8  = ExpandGray8ToRGBA8SSSE3;
+        Funcs.SwapRB8             = SwapRB8SSSE3;
+        Funcs.PackRGBA8ToRGB8     = PackRGBA8ToRGB8SSSE3;
+        Funcs.ISA                 = "SSSE3";
+    }
+    if (Features.F16C)
+    {
+        Funcs.ConvertFloatToHalf = ConvertFloatToHalfF16C;
+        Funcs.ISA                = Features.SSSE3 ? "SSSE3, F16C" : "F16C";
+    }
+#endif
+    return Funcs;
+}
+
+const PixelConversionFunctions& GetFunctions()
+{
+    static const PixelConversionFunctions Funcs = SelectFunctions();
+    return Funcs;
+}
+
+} // namespace
+
+void ExpandRGB8ToRGBA8(const Uint8* pSrc, Uint8* pDst, size_t NumPixels)
+{
+    GetFunctions().ExpandRGB8ToRGBA8(pSrc, pDst, NumPixels);
+}
+
+void ExpandRGB16ToRGBA16(const Uint16* pSrc, Uint16* pDst, size_t NumPixels)
+{
+    GetFunctions().ExpandRGB16ToRGBA16(pSrc, pDst, NumPixels);
+}
+
+void ExpandGray8ToRGBA8(const Uint8* pSrc, Uint8* pDst, size_t NumPixels)
+{
+    GetFunctions().ExpandGray8ToRGBA8(pSrc, pDst, NumPixels);
+}
+
+void SwapRB8(const Uint8* pSrc, Uint8* pDst, size_t NumPixels)
+{
+    GetFunctions().SwapRB8(pSrc, pDst, NumPixels);
+}
+
+void PackRGBA8ToRGB8(const Uint8* pSrc, Uint8* pDst, size_t NumPixels, bool SwapRB)
+{
+    GetFunctions().PackRGBA8ToRGB8(pSrc, pDst, NumPixels, SwapRB);
+}
+
+void ConvertFloatToHalf(const float* pSrc, Uint16* pDst, size_t NumValues)
+{
+    GetFunctions().ConvertFloatToHalf(pSrc, pDst, NumValues);
+}
+
+const char* GetPixelConversionISA()
+{
+    return GetFunctions().ISA;
+}
+
+} // namespace Diligent
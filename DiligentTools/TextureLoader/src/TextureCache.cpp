@@ -0,0 +1,344 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+
+#include "pch.h"
+
+#include "TextureCache.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+
+#include "FileSystem.hpp"
+#include "FileWrapper.hpp"
+#include "DataBlobImpl.hpp"
+#include "RefCntAutoPtr.hpp"
+
+namespace Diligent
+{
+
+namespace
+{
+
+// Incremented when the format of the cached data changes
+static constexpr Uint32 TextureCacheVersion = 1;
+
+static constexpr char TextureCacheIndexFileName[] = "TextureCache.idx";
+
+// MurmurHash64A by Austin Appleby
+Uint64 MurmurHash64A(const void* pData, size_t Size, Uint64 Seed)
+{
+    static constexpr Uint64 m = 0xc6a4a7935bd1e995ull;
+    static constexpr int    r = 47;
+
+    Uint64 h = Seed ^ (Size * m);
+
+    const auto* pBytes   = reinterpret_cast<const Uint8*>(pData);
+    const auto  NumWords = Size / 8;
+    for (size_t i = 0; i < NumWords; ++i)
+    {
+        Uint64 k;
+        memcpy(&k, pBytes + i * 8, sizeof(k));
+
+        k *= m;
+        k ^= k >> r;
+        k *= m;
+
+        h ^= k;
+        h *= m;
+    }
+
+    const auto* pTail = pBytes + NumWords * 8;
+    switch (Size & 7)
+    {
+        // clang-format off
+        case 7: h ^= Uint64{pTail[6]} << 48; // fall through
+        case 6: h ^= Uint64{pTail[5]} << 40; // fall through
+        case 5: h ^= Uint64{pTail[4]} << 32; // fall through
+        case 4: h ^= Uint64{pTail[3]} << 24; // fall through
+        case 3: h ^= Uint64{pTail[2]} << 16; // fall through
+        case 2: h ^= Uint64{pTail[1]} << 8;  // fall through
+        case 1: h ^= Uint64{pTail[0]};
+                h *= m;
+        // clang-format on
+    }
+
+    h ^= h >> r;
+    h *= m;
+    h ^= h >> r;
+    return h;
+}
+
+} // namespace
+
+TextureCache::TextureCache(const CreateInfo& CI) :
+    m_Directory{CI.Directory != nullptr ? CI.Directory : ""},
+    m_MaxSize{CI.MaxSize}
+{
+    if (m_Directory.empty())
+        LOG_ERROR_AND_THROW("Texture cache directory must not be empty");
+
+    if (!FileSystem::PathExists(m_Directory.c_str()))
+    {
+        if (!FileSystem::CreateDirectory(m_Directory.c_str()))
+            LOG_ERROR_AND_THROW("Failed to create texture cache directory '", m_Directory, "'");
+    }
+
+    LoadIndex();
+}
+
+Uint64 TextureCache::ComputeKey(const void* pData, size_t Size, const TextureLoadInfo& TexLoadInfo)
+{
+    Uint32 AlphaCutoffBits = 0;
+    static_assert(sizeof(AlphaCutoffBits) == sizeof(TexLoadInfo.AlphaCutoff), "Unexpected float size");
+    memcpy(&AlphaCutoffBits, &TexLoadInfo.AlphaCutoff, sizeof(AlphaCutoffBits));
+
+    const Uint32 Params[] =
+        {
+            TextureCacheVersion,
+            TexLoadInfo.MipLevels,
+            TexLoadInfo.IsSRGB ? 1u : 0u,
+            TexLoadInfo.GenerateMips ? 1u : 0u,
+            static_cast<Uint32>(TexLoadInfo.Format),
+            static_cast<Uint32>(TexLoadInfo.CompressedFormat),
+            static_cast<Uint32>(TexLoadInfo.CompressQuality),
+            static_cast<Uint32>(TexLoadInfo.MipFilter),
+            AlphaCutoffBits,
+        };
+    return MurmurHash64A(Params, sizeof(Params), MurmurHash64A(pData, Size, 0));
+}
+
+std::string TextureCache::GetFilePath(Uint64 Key) const
+{
+    std::stringstream ss;
+    ss << m_Directory << FileSystem::GetSlashSymbol() << std::hex << std::setw(16) << std::setfill('0') << Key << ".ktx";
+    return ss.str();
+}
+
+bool TextureCache::Find(Uint64 Key, IDataBlob** ppKTXData)
+{
+    DEV_CHECK_ERR(ppKTXData != nullptr && *ppKTXData == nullptr, "ppKTXData must not be null and must point to null");
+
+    const auto Path = GetFilePath(Key);
+
+    // The file is read under the lock so that it can't be observed while Store() is overwriting it
+    std::lock_guard<std::mutex> Lock{m_Mtx};
+    if (!FileSystem::FileExists(Path.c_str()))
+    {
+        if (m_Entries.find(Key) != m_Entries.end())
+        {
+            // The file was deleted externally
+            RemoveEntry(Key);
+            SaveIndex();
+        }
+        return false;
+    }
+
+    RefCntAutoPtr<IDataBlob> pData{MakeNewRCObj<DataBlobImpl>()(0)};
+    {
+        FileWrapper pFile{Path.c_str(), EFileAccessMode::Read};
+        if (!pFile)
+            return false;
+        pFile->Read(pData);
+    }
+
+    auto it = m_Entries.find(Key);
+    if (it == m_Entries.end())
+    {
+        // The file is not in the index, e.g. because the index was deleted
+        AddEntry(Key, pData->GetSize());
+        EvictEntries(Key);
+    }
+    else
+    {
+        it->second.LastUse = ++m_UseCounter;
+    }
+    SaveIndex();
+
+    *ppKTXData = pData.Detach();
+    return true;
+}
+
+bool TextureCache::Store(Uint64 Key, const TextureDesc& TexDesc, const TextureData& TexData)
+{
+    RefCntAutoPtr<IDataBlob> pKTXData{MakeNewRCObj<DataBlobImpl>()(0)};
+    try
+    {
+        WriteTextureDataToKTX(TexDesc, TexData, pKTXData);
+    }
+    catch (const std::exception&)
+    {
+        LOG_WARNING_MESSAGE("Texture '", (TexDesc.Name != nullptr ? TexDesc.Name : ""), "' can't be stored in the cache");
+        return false;
+    }
+
+    const auto Path = GetFilePath(Key);
+
+    std::lock_guard<std::mutex> Lock{m_Mtx};
+    {
+        FileWrapper pFile{Path.c_str(), EFileAccessMode::Overwrite};
+        if (!pFile || !pFile->Write(pKTXData->GetDataPtr(), pKTXData->GetSize()))
+        {
+            LOG_WARNING_MESSAGE("Failed to write texture cache file '", Path, "'");
+            pFile.Close();
+            FileSystem::DeleteFile(Path.c_str());
+            return false;
+        }
+    }
+
+    RemoveEntry(Key);
+    AddEntry(Key, pKTXData->GetSize());
+    EvictEntries(Key);
+    SaveIndex();
+
+    return true;
+}
+
+void TextureCache::SetMaxSize(Uint64 MaxSize)
+{
+    std::lock_guard<std::mutex> Lock{m_Mtx};
+    if (m_MaxSize == MaxSize)
+        return;
+
+    m_MaxSize = MaxSize;
+    EvictEntries(0);
+    SaveIndex();
+}
+
+Uint64 TextureCache::GetSize() const
+{
+    std::lock_guard<std::mutex> Lock{m_Mtx};
+    return m_TotalSize;
+}
+
+Uint32 TextureCache::GetNumEntries() const
+{
+    std::lock_guard<std::mutex> Lock{m_Mtx};
+    return static_cast<Uint32>(m_Entries.size());
+}
+
+void TextureCache::AddEntry(Uint64 Key, Uint64 Size)
+{
+    VERIFY_EXPR(m_Entries.find(Key) == m_Entries.end());
+    auto& NewEntry   = m_Entries[Key];
+    NewEntry.Size    = Size;
+    NewEntry.LastUse = ++m_UseCounter;
+    m_TotalSize += Size;
+}
+
+void TextureCache::RemoveEntry(Uint64 Key)
+{
+    auto it = m_Entries.find(Key);
+    if (it == m_Entries.end())
+        return;
+
+    VERIFY_EXPR(m_TotalSize >= it->second.Size);
+    m_TotalSize -= it->second.Size;
+    m_Entries.erase(it);
+}
+
+void TextureCache::EvictEntries(Uint64 KeepKey)
+{
+    if (m_MaxSize == 0 || m_TotalSize <= m_MaxSize)
+        return;
+
+    std::vector<std::pair<Uint64, Uint64>> LastUseOrder; // {LastUse, Key}
+    LastUseOrder.reserve(m_Entries.size());
+    for (const auto& it : m_Entries)
+    {
+        if (it.first != KeepKey)
+            LastUseOrder.emplace_back(it.second.LastUse, it.first);
+    }
+    std::sort(LastUseOrder.begin(), LastUseOrder.end());
+
+    for (size_t i = 0; i < LastUseOrder.size() && m_TotalSize > m_MaxSize; ++i)
+    {
+        const auto Key = LastUseOrder[i].second;
+        FileSystem::DeleteFile(GetFilePath(Key).c_str());
+        RemoveEntry(Key);
+    }
+}
+
+void TextureCache::LoadIndex()
+{
+    const auto IndexPath = m_Directory + FileSystem::GetSlashSymbol() + TextureCacheIndexFileName;
+    if (!FileSystem::FileExists(IndexPath.c_str()))
+        return;
+
+    RefCntAutoPtr<IDataBlob> pData{MakeNewRCObj<DataBlobImpl>()(0)};
+    {
+        FileWrapper pFile{IndexPath.c_str(), EFileAccessMode::Read};
+        if (!pFile)
+            return;
+        pFile->Read(pData);
+    }
+
+    std::stringstream ss{std::string{reinterpret_cast<const char*>(pData->GetDataPtr()), pData->GetSize()}};
+
+    Uint32 Version = 0;
+    ss >> Version;
+    if (Version != TextureCacheVersion)
+    {
+        LOG_INFO_MESSAGE("Texture cache index version mismatch. The cache will be rebuilt.");
+        return;
+    }
+
+    Uint64 Key = 0, Size = 0, LastUse = 0;
+    while (ss >> std::hex >> Key >> std::dec >> Size >> LastUse)
+    {
+        // Skip entries whose files were deleted externally
+        if (!FileSystem::FileExists(GetFilePath(Key).c_str()))
+            continue;
+
+        auto& NewEntry   = m_Entries[Key];
+        NewEntry.Size    = Size;
+        NewEntry.LastUse = LastUse;
+        m_TotalSize += Size;
+        m_UseCounter = std::max(m_UseCounter, LastUse);
+    }
+
+    EvictEntries(0);
+}
+
+void TextureCache::SaveIndex() const
+{
+    std::stringstream ss;
+    ss << TextureCacheVersion << '\n';
+    for (const auto& it : m_Entries)
+        ss << std::hex << it.first << ' ' << std::dec << it.second.Size << ' ' << it.second.LastUse << '\n';
+
+    const auto IndexPath = m_Directory + FileSystem::GetSlashSymbol() + TextureCacheIndexFileName;
+    const auto Index     = ss.str();
+
+    FileWrapper pFile{IndexPath.c_str(), EFileAccessMode::Overwrite};
+    if (!pFile || !pFile->Write(Index.data(), Index.size()))
+        LOG_WARNING_MESSAGE("Failed to write texture cache index '", IndexPath, "'");
+}
+
+} // namespace Diligent
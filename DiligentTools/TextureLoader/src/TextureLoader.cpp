@@ -27,17 +27,20 @@
 
 #include "pch.h"
 #include <algorithm>
-#include <limits>
 #include <math.h>
 #include <vector>
 
 #include "TextureLoader.h"
+#include "TextureLoaderInternal.hpp"
 #include "GraphicsAccessories.hpp"
 #include "DDSLoader.h"
 #include "PNGCodec.h"
 #include "JPEGCodec.h"
-#include "ColorConversion.h"
 #include "Image.h"
+#include "MipGenerator.hpp"
+#include "PixelConversion.hpp"
+#include "BCEncoder.hpp"
+#include "ThreadPool.hpp"
 
 extern "C"
 {
@@ -45,6 +48,17 @@ extern "C"
                                                    Diligent::IDataBlob* pDstPixels,
                                                    Diligent::ImageDesc* pDstImgDesc);
 
+    Diligent::DECODE_PNG_RESULT Diligent_CreatePngRowDecoder(Diligent::IDataBlob*      pSrcPngBits,
+                                                             Diligent::ImageDesc*      pDstImgDesc,
+                                                             Diligent::PNGRowDecoder** ppDecoder);
+
+    Diligent::DECODE_PNG_RESULT Diligent_DecodePngRows(Diligent::PNGRowDecoder* pDecoder,
+                                                       Diligent::Uint8*         pDstRows,
+                                                       Diligent::Uint32         DstStride,
+                                                       Diligent::Uint32         NumRows);
+
+    void Diligent_DestroyPngRowDecoder(Diligent::PNGRowDecoder* pDecoder);
+
     Diligent::ENCODE_PNG_RESULT Diligent_EncodePng(const Diligent::Uint8* pSrcPixels,
                                                    Diligent::Uint32       Width,
                                                    Diligent::Uint32       Height,
@@ -66,107 +80,96 @@ extern "C"
 namespace Diligent
 {
 
-template <typename ChannelType>
-ChannelType SRGBAverage(ChannelType c0, ChannelType c1, ChannelType c2, ChannelType c3)
+namespace
 {
-    static constexpr float NormVal = static_cast<float>(std::numeric_limits<ChannelType>::max());
-
-    float fc0 = static_cast<float>(c0) / NormVal;
-    float fc1 = static_cast<float>(c1) / NormVal;
-    float fc2 = static_cast<float>(c2) / NormVal;
-    float fc3 = static_cast<float>(c3) / NormVal;
 
-    float fLinearAverage = (SRGBToLinear(fc0) + SRGBToLinear(fc1) + SRGBToLinear(fc2) + SRGBToLinear(fc3)) / 4.f;
-    float fSRGBAverage   = LinearToSRGB(fLinearAverage) * NormVal;
-
-    static constexpr float MinVal = static_cast<float>(std::numeric_limits<ChannelType>::min());
-    static constexpr float MaxVal = static_cast<float>(std::numeric_limits<ChannelType>::max());
-
-    fSRGBAverage = std::max(fSRGBAverage, MinVal);
-    fSRGBAverage = std::min(fSRGBAverage, MaxVal);
-
-    return static_cast<ChannelType>(fSRGBAverage);
+void RGBToRGBA(const Uint8* pRGBData,
+               Uint32       RGBStride,
+               Uint8*       pRGBAData,
+               Uint32       RGBAStride,
+               Uint32       Width,
+               Uint32       Height,
+               Uint32       ChannelDepth)
+{
+    for (size_t row = 0; row < size_t{Height}; ++row)
+    {
+        const auto* pSrcRow = pRGBData + size_t{RGBStride} * row;
+        auto*       pDstRow = pRGBAData + size_t{RGBAStride} * row;
+        if (ChannelDepth == 8)
+            ExpandRGB8ToRGBA8(pSrcRow, pDstRow, Width);
+        else if (ChannelDepth == 16)
+            ExpandRGB16ToRGBA16(reinterpret_cast<const Uint16*>(pSrcRow), reinterpret_cast<Uint16*>(pDstRow), Width);
+        else
+            UNEXPECTED("Unexpected channel depth");
+    }
 }
 
-template <typename ChannelType>
-ChannelType LinearAverage(ChannelType c0, ChannelType c1, ChannelType c2, ChannelType c3)
+Uint32 GetMipStride(Uint32 Width, Uint32 MipLevel, Uint32 PixelSize)
 {
-    static_assert(std::numeric_limits<ChannelType>::is_integer && !std::numeric_limits<ChannelType>::is_signed, "Unsigned integers are expected");
-    return static_cast<ChannelType>((static_cast<Uint32>(c0) + static_cast<Uint32>(c1) + static_cast<Uint32>(c2) + static_cast<Uint32>(c3)) / 4);
+    const auto Stride = std::max(Width >> MipLevel, 1u) * PixelSize;
+    return (Stride + 3) & ~3u;
 }
 
-template <typename ChannelType>
-void ComputeCoarseMip(Uint32      NumChannels,
-                      bool        IsSRGB,
-                      const void* pFineMip,
-                      Uint32      FineMipStride,
-                      Uint32      FineMipWidth,
-                      Uint32      FineMipHeight,
-                      void*       pCoarseMip,
-                      Uint32      CoarseMipStride,
-                      Uint32      CoarseMipWidth,
-                      Uint32      CoarseMipHeight)
+bool CanGenerateMipsOnGPU(IRenderDevice* pDevice, TEXTURE_FORMAT Format)
 {
-    VERIFY_EXPR(FineMipWidth > 0 && FineMipHeight > 0 && FineMipStride > 0);
-    VERIFY_EXPR(CoarseMipWidth > 0 && CoarseMipHeight > 0 && CoarseMipStride > 0);
+    const auto& FmtInfo = pDevice->GetTextureFormatInfoExt(Format);
+    return FmtInfo.Supported && FmtInfo.Filterable && (FmtInfo.BindFlags & BIND_RENDER_TARGET) != 0;
+}
 
-    for (Uint32 row = 0; row < CoarseMipHeight; ++row)
-    {
-        auto src_row0 = row * 2;
-        auto src_row1 = std::min(row * 2 + 1, FineMipHeight - 1);
+} // namespace
 
-        auto pSrcRow0 = reinterpret_cast<const ChannelType*>(reinterpret_cast<const Uint8*>(pFineMip) + src_row0 * FineMipStride);
-        auto pSrcRow1 = reinterpret_cast<const ChannelType*>(reinterpret_cast<const Uint8*>(pFineMip) + src_row1 * FineMipStride);
+TEXTURE_FORMAT GetImageTextureFormat(const ImageDesc& ImgDesc, const TextureLoadInfo& TexLoadInfo)
+{
+    const auto   ChannelDepth  = GetValueSize(ImgDesc.ComponentType) * 8;
+    const Uint32 NumComponents = ImgDesc.NumComponents == 3 ? 4 : ImgDesc.NumComponents;
+    const bool   IsSRGB        = (ImgDesc.NumComponents >= 3 && ChannelDepth == 8) ? TexLoadInfo.IsSRGB : false;
 
-        for (Uint32 col = 0; col < CoarseMipWidth; ++col)
+    auto Format = TexLoadInfo.Format;
+    if (Format == TEX_FORMAT_UNKNOWN)
+    {
+        if (ChannelDepth == 8)
         {
-            auto src_col0 = col * 2;
-            auto src_col1 = std::min(col * 2 + 1, FineMipWidth - 1);
-
-            for (Uint32 c = 0; c < NumChannels; ++c)
+            switch (NumComponents)
             {
-                auto Chnl00 = pSrcRow0[src_col0 * NumChannels + c];
-                auto Chnl01 = pSrcRow0[src_col1 * NumChannels + c];
-                auto Chnl10 = pSrcRow1[src_col0 * NumChannels + c];
-                auto Chnl11 = pSrcRow1[src_col1 * NumChannels + c];
-
-                auto& DstCol = reinterpret_cast<ChannelType*>(reinterpret_cast<Uint8*>(pCoarseMip) + row * CoarseMipStride)[col * NumChannels + c];
-                if (IsSRGB)
-                    DstCol = SRGBAverage(Chnl00, Chnl01, Chnl10, Chnl11);
-                else
-                    DstCol = LinearAverage(Chnl00, Chnl01, Chnl10, Chnl11);
+                case 1: Format = TEX_FORMAT_R8_UNORM; break;
+                case 2: Format = TEX_FORMAT_RG8_UNORM; break;
+                case 4: Format = IsSRGB ? TEX_FORMAT_RGBA8_UNORM_SRGB : TEX_FORMAT_RGBA8_UNORM; break;
+                default: LOG_ERROR_AND_THROW("Unexpected number of color channels (", ImgDesc.NumComponents, ")");
             }
         }
-    }
-}
-
-template <typename ChannelType>
-void RGBToRGBA(const void* pRGBData,
-               Uint32      RGBStride,
-               void*       pRGBAData,
-               Uint32      RGBAStride,
-               Uint32      Width,
-               Uint32      Height)
-{
-    for (size_t row = 0; row < size_t{Height}; ++row)
-        for (size_t col = 0; col < size_t{Width}; ++col)
+        else if (ChannelDepth == 16)
         {
-            for (int c = 0; c < 3; ++c)
+            switch (NumComponents)
             {
-                reinterpret_cast<ChannelType*>((reinterpret_cast<Uint8*>(pRGBAData) + size_t{RGBAStride} * row))[col * 4 + c] =
-                    reinterpret_cast<const ChannelType*>((reinterpret_cast<const Uint8*>(pRGBData) + size_t{RGBStride} * row))[col * 3 + c];
+                case 1: Format = TEX_FORMAT_R16_UNORM; break;
+                case 2: Format = TEX_FORMAT_RG16_UNORM; break;
+                case 4: Format = TEX_FORMAT_RGBA16_UNORM; break;
+                default: LOG_ERROR_AND_THROW("Unexpected number of color channels (", ImgDesc.NumComponents, ")");
             }
-            reinterpret_cast<ChannelType*>((reinterpret_cast<Uint8*>(pRGBAData) + size_t{RGBAStride} * row))[col * 4 + 3] = std::numeric_limits<ChannelType>::max();
         }
+        else
+            LOG_ERROR_AND_THROW("Unsupported color channel depth (", ChannelDepth, ")");
+    }
+    else
+    {
+        const auto& TexFmtDesc = GetTextureFormatAttribs(Format);
+        if (TexFmtDesc.NumComponents != NumComponents)
+            LOG_ERROR_AND_THROW("Incorrect number of components ", ImgDesc.NumComponents, ") for texture format ", TexFmtDesc.Name);
+        if (TexFmtDesc.ComponentSize != ChannelDepth / 8)
+            LOG_ERROR_AND_THROW("Incorrect channel size ", ChannelDepth, ") for texture format ", TexFmtDesc.Name);
+    }
+
+    return Format;
 }
 
-void CreateTextureFromImage(Image*                 pSrcImage,
-                            const TextureLoadInfo& TexLoadInfo,
-                            IRenderDevice*         pDevice,
-                            ITexture**             ppTexture)
+void PrepareTextureFromImage(Image*                 pSrcImage,
+                             const TextureLoadInfo& TexLoadInfo,
+                             IRenderDevice*         pDevice,
+                             PreparedTextureData&   Data)
 {
     const auto& ImgDesc = pSrcImage->GetDesc();
-    TextureDesc TexDesc;
+    auto&       TexDesc = Data.Desc;
+
     TexDesc.Name      = TexLoadInfo.Name;
     TexDesc.Type      = RESOURCE_DIM_TEX_2D;
     TexDesc.Width     = ImgDesc.Width;
@@ -176,70 +179,106 @@ void CreateTextureFromImage(Image*                 pSrcImage,
         TexDesc.MipLevels = std::min(TexDesc.MipLevels, TexLoadInfo.MipLevels);
     TexDesc.Usage          = TexLoadInfo.Usage;
     TexDesc.BindFlags      = TexLoadInfo.BindFlags;
-    TexDesc.Format         = TexLoadInfo.Format;
+    TexDesc.Format         = GetImageTextureFormat(ImgDesc, TexLoadInfo);
     TexDesc.CPUAccessFlags = TexLoadInfo.CPUAccessFlags;
     auto ChannelDepth      = GetValueSize(ImgDesc.ComponentType) * 8;
 
     Uint32 NumComponents = ImgDesc.NumComponents == 3 ? 4 : ImgDesc.NumComponents;
     bool   IsSRGB        = (ImgDesc.NumComponents >= 3 && ChannelDepth == 8) ? TexLoadInfo.IsSRGB : false;
-    if (TexDesc.Format == TEX_FORMAT_UNKNOWN)
+
+    auto CompressedFormat = TEX_FORMAT_UNKNOWN;
+    if (TexLoadInfo.CompressedFormat != TEX_FORMAT_UNKNOWN)
     {
-        if (ChannelDepth == 8)
+        if (!IsBCEncoderFormatSupported(TexLoadInfo.CompressedFormat))
         {
-            switch (NumComponents)
-            {
-                case 1: TexDesc.Format = TEX_FORMAT_R8_UNORM; break;
-                case 2: TexDesc.Format = TEX_FORMAT_RG8_UNORM; break;
-                case 4: TexDesc.Format = IsSRGB ? TEX_FORMAT_RGBA8_UNORM_SRGB : TEX_FORMAT_RGBA8_UNORM; break;
-                default: LOG_ERROR_AND_THROW("Unexpected number of color channels (", ImgDesc.NumComponents, ")");
-            }
+            LOG_WARNING_MESSAGE("Block compression to format ", GetTextureFormatAttribs(TexLoadInfo.CompressedFormat).Name,
+                                " is not supported. Texture '", (TexDesc.Name != nullptr ? TexDesc.Name : ""), "' will not be compressed.");
         }
-        else if (ChannelDepth == 16)
+        else if (ChannelDepth != 8)
         {
-            switch (NumComponents)
+            LOG_WARNING_MESSAGE("Block compression is only supported for images with 8-bit channels. Texture '",
+                                (TexDesc.Name != nullptr ? TexDesc.Name : ""), "' will not be compressed.");
+        }
+        else if (TexDesc.Width % 4 != 0 || TexDesc.Height % 4 != 0)
+        {
+            // Graphics APIs require the dimensions of the top level of a block-compressed texture to be
+            // multiples of the block size. Padding would change the texture size and thus the texel mapping.
+            LOG_WARNING_MESSAGE("Block compression requires image dimensions to be multiples of 4, but texture '",
+                                (TexDesc.Name != nullptr ? TexDesc.Name : ""), "' is ", TexDesc.Width, "x", TexDesc.Height,
+                                ". The texture will not be compressed.");
+        }
+        else
+        {
+            CompressedFormat = TexLoadInfo.CompressedFormat;
+            if (IsSRGB)
             {
-                case 1: TexDesc.Format = TEX_FORMAT_R16_UNORM; break;
-                case 2: TexDesc.Format = TEX_FORMAT_RG16_UNORM; break;
-                case 4: TexDesc.Format = TEX_FORMAT_RGBA16_UNORM; break;
-                default: LOG_ERROR_AND_THROW("Unexpected number of color channels (", ImgDesc.NumComponents, ")");
+                switch (CompressedFormat)
+                {
+                    case TEX_FORMAT_BC1_UNORM: CompressedFormat = TEX_FORMAT_BC1_UNORM_SRGB; break;
+                    case TEX_FORMAT_BC3_UNORM: CompressedFormat = TEX_FORMAT_BC3_UNORM_SRGB; break;
+                    case TEX_FORMAT_BC7_UNORM: CompressedFormat = TEX_FORMAT_BC7_UNORM_SRGB; break;
+                    default: break;
+                }
             }
         }
-        else
-            LOG_ERROR_AND_THROW("Unsupported color channel depth (", ChannelDepth, ")");
     }
-    else
+
+    // Block-compressed textures can't be render targets, so their mips are always computed on the CPU.
+    // The GPU only implements the box filter and does not preserve alpha coverage.
+    const auto PreserveAlphaCoverage = TexLoadInfo.AlphaCutoff > 0 && NumComponents == 4;
+    const auto UseGPUMips            = TexLoadInfo.GenerateMips && TexLoadInfo.GenerateMipsOnGPU && TexDesc.MipLevels > 1 &&
+        CompressedFormat == TEX_FORMAT_UNKNOWN && TexLoadInfo.MipFilter == MIP_FILTER_BOX && !PreserveAlphaCoverage &&
+        CanGenerateMipsOnGPU(pDevice, TexDesc.Format);
+    if (UseGPUMips)
     {
-        const auto& TexFmtDesc = GetTextureFormatAttribs(TexDesc.Format);
-        if (TexFmtDesc.NumComponents != NumComponents)
-            LOG_ERROR_AND_THROW("Incorrect number of components ", ImgDesc.NumComponents, ") for texture format ", TexFmtDesc.Name);
-        if (TexFmtDesc.ComponentSize != ChannelDepth / 8)
-            LOG_ERROR_AND_THROW("Incorrect channel size ", ChannelDepth, ") for texture format ", TexFmtDesc.Name);
+        TexDesc.MiscFlags |= MISC_TEXTURE_FLAG_GENERATE_MIPS;
+        TexDesc.BindFlags |= BIND_RENDER_TARGET;
+        if (TexDesc.Usage == USAGE_IMMUTABLE)
+            TexDesc.Usage = USAGE_DEFAULT;
     }
 
+    const auto PixelSize = NumComponents * ChannelDepth / 8;
 
-    std::vector<TextureSubResData>  pSubResources(TexDesc.MipLevels);
-    std::vector<std::vector<Uint8>> Mips(TexDesc.MipLevels);
+    // All levels that are computed on the CPU are stored in one allocation
+    std::vector<size_t> MipOffsets(TexDesc.MipLevels + 1);
+    {
+        size_t Offset = 0;
+        for (Uint32 m = 0; m < TexDesc.MipLevels; ++m)
+        {
+            MipOffsets[m] = Offset;
+            // Level 0 only needs storage when RGB data is converted to RGBA
+            const auto HasStorage = m == 0 ? ImgDesc.NumComponents == 3 : !UseGPUMips;
+            if (HasStorage)
+                Offset += size_t{GetMipStride(TexDesc.Width, m, PixelSize)} * size_t{std::max(TexDesc.Height >> m, 1u)};
+        }
+        MipOffsets[TexDesc.MipLevels] = Offset;
+    }
+    auto& MipArena = Data.MipArena;
+    MipArena.assign(MipOffsets.back(), 0);
+
+    auto& Pool = ThreadPool::GetShared();
 
+    auto& pSubResources = Data.SubResources;
+    pSubResources.assign(TexDesc.MipLevels, TextureSubResData{});
     if (ImgDesc.NumComponents == 3)
     {
         VERIFY_EXPR(NumComponents == 4);
-        auto RGBAStride = ImgDesc.Width * NumComponents * ChannelDepth / 8;
-        RGBAStride      = (RGBAStride + 3) & (-4);
-        Mips[0].resize(size_t{RGBAStride} * size_t{ImgDesc.Height});
-        pSubResources[0].pData  = Mips[0].data();
+        const auto RGBAStride = GetMipStride(ImgDesc.Width, 0, PixelSize);
+        auto*      pRGBAData  = MipArena.data() + MipOffsets[0];
+        pSubResources[0].pData  = pRGBAData;
         pSubResources[0].Stride = RGBAStride;
-        if (ChannelDepth == 8)
-        {
-            RGBToRGBA<Uint8>(pSrcImage->GetData()->GetDataPtr(), ImgDesc.RowStride,
-                             Mips[0].data(), RGBAStride,
-                             ImgDesc.Width, ImgDesc.Height);
-        }
-        else if (ChannelDepth == 16)
-        {
-            RGBToRGBA<Uint16>(pSrcImage->GetData()->GetDataPtr(), ImgDesc.RowStride,
-                              Mips[0].data(), RGBAStride,
-                              ImgDesc.Width, ImgDesc.Height);
-        }
+
+        const auto* pRGBData = reinterpret_cast<const Uint8*>(pSrcImage->GetData()->GetDataPtr());
+
+        const auto RowsPerBand = GetParallelMipRowsPerBand(RGBAStride);
+        Pool.ParallelFor((ImgDesc.Height + RowsPerBand - 1) / RowsPerBand,
+                         [&](Uint32 Band) {
+                             const auto StartRow = Band * RowsPerBand;
+                             const auto NumRows  = std::min(RowsPerBand, ImgDesc.Height - StartRow);
+                             const auto* pSrc    = pRGBData + size_t{StartRow} * ImgDesc.RowStride;
+                             auto*       pDst    = pRGBAData + size_t{StartRow} * RGBAStride;
+                             RGBToRGBA(pSrc, ImgDesc.RowStride, pDst, RGBAStride, ImgDesc.Width, NumRows, ChannelDepth);
+                         });
     }
     else
     {
@@ -247,48 +286,99 @@ void CreateTextureFromImage(Image*                 pSrcImage,
         pSubResources[0].Stride = ImgDesc.RowStride;
     }
 
-    auto MipWidth  = TexDesc.Width;
-    auto MipHeight = TexDesc.Height;
     for (Uint32 m = 1; m < TexDesc.MipLevels; ++m)
     {
-        auto CoarseMipWidth  = std::max(MipWidth / 2u, 1u);
-        auto CoarseMipHeight = std::max(MipHeight / 2u, 1u);
-        auto CoarseMipStride = CoarseMipWidth * NumComponents * ChannelDepth / 8;
-        CoarseMipStride      = (CoarseMipStride + 3) & (-4);
-        Mips[m].resize(size_t{CoarseMipStride} * size_t{CoarseMipHeight});
+        if (UseGPUMips)
+        {
+            // Initial data must be provided for every level. Level 0 data is large enough
+            // for any coarser level; the contents are overwritten by IDeviceContext::GenerateMips().
+            pSubResources[m] = pSubResources[0];
+        }
+        else
+        {
+            pSubResources[m].pData  = MipArena.data() + MipOffsets[m];
+            pSubResources[m].Stride = GetMipStride(TexDesc.Width, m, PixelSize);
+        }
+    }
 
-        if (TexLoadInfo.GenerateMips)
+    if (TexLoadInfo.GenerateMips && !UseGPUMips)
+    {
+        std::vector<MappedTextureSubresource> Mips(TexDesc.MipLevels);
+        for (Uint32 m = 0; m < TexDesc.MipLevels; ++m)
         {
-            if (ChannelDepth == 8)
-            {
-                ComputeCoarseMip<Uint8>(NumComponents, IsSRGB,
-                                        pSubResources[m - 1].pData, pSubResources[m - 1].Stride,
-                                        MipWidth, MipHeight,
-                                        Mips[m].data(), CoarseMipStride,
-                                        CoarseMipWidth, CoarseMipHeight);
-            }
-            else if (ChannelDepth == 16)
-            {
-                ComputeCoarseMip<Uint16>(NumComponents, IsSRGB,
-                                         pSubResources[m - 1].pData, pSubResources[m - 1].Stride,
-                                         MipWidth, MipHeight,
-                                         Mips[m].data(), CoarseMipStride,
-                                         CoarseMipWidth, CoarseMipHeight);
-            }
+            // Level 0 is only read
+            Mips[m].pData  = const_cast<void*>(pSubResources[m].pData);
+            Mips[m].Stride = pSubResources[m].Stride;
         }
 
-        pSubResources[m].pData  = Mips[m].data();
-        pSubResources[m].Stride = CoarseMipStride;
+        ComputeMipChainAttribs MipChainAttribs;
+        MipChainAttribs.ComponentType = ChannelDepth == 8 ? VT_UINT8 : VT_UINT16;
+        MipChainAttribs.NumChannels   = NumComponents;
+        MipChainAttribs.IsSRGB        = IsSRGB;
+        MipChainAttribs.Filter        = TexLoadInfo.MipFilter;
+        MipChainAttribs.AlphaCutoff   = TexLoadInfo.AlphaCutoff;
+        MipChainAttribs.Width         = TexDesc.Width;
+        MipChainAttribs.Height        = TexDesc.Height;
+        MipChainAttribs.pMips         = Mips.data();
+        MipChainAttribs.MipLevels     = TexDesc.MipLevels;
+        MipChainAttribs.pThreadPool   = &Pool;
+        ComputeMipChain(MipChainAttribs);
+    }
+
+    // The compressed chain is also stored in one allocation
+    auto& CompressedArena = Data.CompressedArena;
+    CompressedArena.clear();
+    if (CompressedFormat != TEX_FORMAT_UNKNOWN)
+    {
+        const auto& FmtAttribs = GetTextureFormatAttribs(CompressedFormat);
+        const auto  BlockSize  = Uint32{FmtAttribs.ComponentSize};
 
-        MipWidth  = CoarseMipWidth;
-        MipHeight = CoarseMipHeight;
+        std::vector<size_t> CompressedOffsets(TexDesc.MipLevels + 1);
+        for (Uint32 m = 0; m < TexDesc.MipLevels; ++m)
+        {
+            const auto NumBlocksX    = (std::max(TexDesc.Width >> m, 1u) + 3) / 4;
+            const auto NumBlocksY    = (std::max(TexDesc.Height >> m, 1u) + 3) / 4;
+            CompressedOffsets[m + 1] = CompressedOffsets[m] + size_t{NumBlocksX} * BlockSize * NumBlocksY;
+        }
+        CompressedArena.resize(CompressedOffsets.back());
+
+        for (Uint32 m = 0; m < TexDesc.MipLevels; ++m)
+        {
+            EncodeBCAttribs EncodeAttribs;
+            EncodeAttribs.Format         = CompressedFormat;
+            EncodeAttribs.Quality        = TexLoadInfo.CompressQuality;
+            EncodeAttribs.pSrcData       = pSubResources[m].pData;
+            EncodeAttribs.SrcStride      = pSubResources[m].Stride;
+            EncodeAttribs.NumSrcChannels = NumComponents;
+            EncodeAttribs.Width          = std::max(TexDesc.Width >> m, 1u);
+            EncodeAttribs.Height         = std::max(TexDesc.Height >> m, 1u);
+            EncodeAttribs.pDstData       = CompressedArena.data() + CompressedOffsets[m];
+            EncodeAttribs.DstStride      = (EncodeAttribs.Width + 3) / 4 * BlockSize;
+            EncodeBC(EncodeAttribs, &Pool);
+
+            pSubResources[m].pData  = EncodeAttribs.pDstData;
+            pSubResources[m].Stride = EncodeAttribs.DstStride;
+        }
+
+        TexDesc.Format = CompressedFormat;
     }
 
+    Data.AllLevelsOnCPU = !UseGPUMips;
+}
+
+void CreateTextureFromImage(Image*                 pSrcImage,
+                            const TextureLoadInfo& TexLoadInfo,
+                            IRenderDevice*         pDevice,
+                            ITexture**             ppTexture)
+{
+    PreparedTextureData Data;
+    PrepareTextureFromImage(pSrcImage, TexLoadInfo, pDevice, Data);
+
     TextureData TexData;
-    TexData.pSubResources   = pSubResources.data();
-    TexData.NumSubresources = TexDesc.MipLevels;
+    TexData.pSubResources   = Data.SubResources.data();
+    TexData.NumSubresources = static_cast<Uint32>(Data.SubResources.size());
 
-    pDevice->CreateTexture(TexDesc, &TexData, ppTexture);
+    pDevice->CreateTexture(Data.Desc, &TexData, ppTexture);
 }
 
 void CreateTextureFromDDS(IDataBlob*             pDDSData,
@@ -299,7 +389,7 @@ void CreateTextureFromDDS(IDataBlob*             pDDSData,
     CreateDDSTextureFromMemoryEx(pDevice,
                                  reinterpret_cast<const Uint8*>(pDDSData->GetDataPtr()),
                                  static_cast<size_t>(pDDSData->GetSize()),
-                                 0, // maxSize
+                                 TexLoadInfo.MaxDimension, // maxSize
                                  TexLoadInfo.Usage,
                                  TexLoadInfo.Name,
                                  TexLoadInfo.BindFlags,
@@ -316,6 +406,26 @@ DECODE_PNG_RESULT DecodePng(IDataBlob* pSrcPngBits,
     return Diligent_DecodePng(pSrcPngBits, pDstPixels, pDstImgDesc);
 }
 
+DECODE_PNG_RESULT CreatePngRowDecoder(IDataBlob*      pSrcPngBits,
+                                      ImageDesc*      pDstImgDesc,
+                                      PNGRowDecoder** ppDecoder)
+{
+    return Diligent_CreatePngRowDecoder(pSrcPngBits, pDstImgDesc, ppDecoder);
+}
+
+DECODE_PNG_RESULT DecodePngRows(PNGRowDecoder* pDecoder,
+                                Uint8*         pDstRows,
+                                Uint32         DstStride,
+                                Uint32         NumRows)
+{
+    return Diligent_DecodePngRows(pDecoder, pDstRows, DstStride, NumRows);
+}
+
+void DestroyPngRowDecoder(PNGRowDecoder* pDecoder)
+{
+    Diligent_DestroyPngRowDecoder(pDecoder);
+}
+
 ENCODE_PNG_RESULT EncodePng(const Uint8* pSrcPixels,
                             Uint32       Width,
                             Uint32       Height,
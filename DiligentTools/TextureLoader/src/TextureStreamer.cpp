@@ -0,0 +1,670 @@
+/*
+ *  Copyright 2019-2020 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *  
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *  
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence), 
+ *  contract, or otherwise, unless required by applicable law (such as deliberate 
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental, 
+ *  or consequential damages of any character arising as a result of this License or 
+ *  out of the use or inability to use the software (including but not limited to damages 
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and 
+ *  all other commercial damages or losses), even if such Contributor has been advised 
+ *  of the possibility of such damages.
+ */
+#include "pch.h"
+
+#include "TextureStreamer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "Image.h"
+#include "DDSLoader.h"
+#include "TextureLoaderInternal.hpp"
+#include "GraphicsAccessories.hpp"
+#include "FileWrapper.hpp"
+#include "ThreadPool.hpp"
+
+namespace Diligent
+{
+
+constexpr TextureStreamer::TextureId TextureStreamer::InvalidTextureId;
+
+struct TextureStreamer::LoadJob
+{
+    TextureId   Id = InvalidTextureId;
+    std::string FilePath;
+
+    /// Levels [FirstMip, EndMip) of the full chain are loaded
+    Uint32 FirstMip = 0;
+    Uint32 EndMip   = 0;
+
+    /// GPU memory reserved for the levels
+    Uint64 Size = 0;
+
+    /// File data location of the levels. After the load, offsets are relative to Data.
+    std::vector<MipRange> Mips;
+    std::vector<Uint8>    Data;
+
+    Uint64 ReadyFrame = 0;
+    bool   Succeeded  = false;
+};
+
+namespace
+{
+
+Uint32 GetNumStorageRows(const TextureFormatAttribs& FmtAttribs, const MipLevelProperties& MipProps)
+{
+    return FmtAttribs.ComponentType == COMPONENT_TYPE_COMPRESSED ?
+        MipProps.StorageHeight / FmtAttribs.BlockHeight :
+        MipProps.StorageHeight;
+}
+
+} // namespace
+
+TextureStreamer::TextureStreamer(const CreateInfo& CI) :
+    m_pDevice{CI.pDevice},
+    m_pUploader{CI.pUploader},
+    m_TailMipDimension{std::max(CI.TailMipDimension, 1u)},
+    m_MaxLoadBytesPerUpdate{CI.MaxLoadBytesPerUpdate},
+    m_SimulatedLoadLatency{CI.SimulatedLoadLatency},
+    m_Budget{CI.Budget},
+    m_MaxConcurrentLoads{std::max(CI.MaxConcurrentLoads, 1u)}
+{
+    if (!m_pDevice)
+        return;
+
+    if (!m_pUploader)
+    {
+        CreateTextureUploader(m_pDevice, TextureUploaderDesc{}, &m_pUploader);
+        if (!m_pUploader)
+            LOG_ERROR_AND_THROW("Failed to create texture uploader");
+    }
+
+    m_pThreadPool = CI.pThreadPool != nullptr ? CI.pThreadPool : &ThreadPool::GetShared();
+}
+
+TextureStreamer::~TextureStreamer()
+{
+    // Tasks of the pool reference the streamer, so wait until they exit
+    std::unique_lock<std::mutex> Lock{m_JobsMtx};
+    m_Stop = true;
+    m_IdleCondVar.wait(Lock, [&]() { return m_NumActiveTasks == 0; });
+}
+
+TextureStreamer::StreamedTexture& TextureStreamer::GetTex(TextureId Id)
+{
+    VERIFY(Id < m_Textures.size() && m_Textures[Id], "Invalid texture id ", Id);
+    return *m_Textures[Id];
+}
+
+const TextureStreamer::StreamedTexture& TextureStreamer::GetTex(TextureId Id) const
+{
+    VERIFY(Id < m_Textures.size() && m_Textures[Id], "Invalid texture id ", Id);
+    return *m_Textures[Id];
+}
+
+Uint64 TextureStreamer::GetMipRangeSize(const StreamedTexture& Tex, Uint32 FirstMip, Uint32 EndMip)
+{
+    Uint64 Size = 0;
+    for (Uint32 mip = FirstMip; mip < EndMip; ++mip)
+        Size += Tex.MipSizes[mip];
+    return Size;
+}
+
+void TextureStreamer::InitMipLevels(StreamedTexture& Tex) const
+{
+    auto& Desc = Tex.FullDesc;
+    if (Desc.MipLevels == 0)
+        Desc.MipLevels = ComputeMipLevelsCount(Desc.Width, Desc.Height);
+
+    const auto& FmtAttribs = GetTextureFormatAttribs(Desc.Format);
+    const auto  ArraySize  = Desc.Type != RESOURCE_DIM_TEX_3D ? Desc.ArraySize : 1;
+
+    Tex.MipSizes.resize(Desc.MipLevels);
+    for (Uint32 mip = 0; mip < Desc.MipLevels; ++mip)
+        Tex.MipSizes[mip] = Uint64{GetMipLevelProperties(Desc, mip).MipSize} * ArraySize;
+
+    Tex.TailMip = 0;
+    if (Desc.Type == RESOURCE_DIM_TEX_2D)
+    {
+        while (Tex.TailMip + 1 < Desc.MipLevels &&
+               std::max(Desc.Width >> Tex.TailMip, Desc.Height >> Tex.TailMip) > m_TailMipDimension)
+            ++Tex.TailMip;
+
+        if (FmtAttribs.ComponentType == COMPONENT_TYPE_COMPRESSED)
+        {
+            // The top level of a block-compressed texture must consist of whole blocks.
+            // If a level is block-aligned, all finer levels are block-aligned too.
+            while (Tex.TailMip > 0 &&
+                   ((Desc.Width >> Tex.TailMip) % FmtAttribs.BlockWidth != 0 ||
+                    (Desc.Height >> Tex.TailMip) % FmtAttribs.BlockHeight != 0))
+                --Tex.TailMip;
+        }
+    }
+
+    Tex.ResidentMip     = Tex.TailMip;
+    Tex.TextureFirstMip = Tex.TailMip;
+    Tex.RequestedMip    = Tex.TailMip;
+}
+
+TextureStreamer::TextureId TextureStreamer::RegisterTexture(std::unique_ptr<StreamedTexture>&& pTex)
+{
+    m_ResidentBytes += GetMipRangeSize(*pTex, pTex->ResidentMip, pTex->FullDesc.MipLevels);
+    m_Textures.emplace_back(std::move(pTex));
+    return static_cast<TextureId>(m_Textures.size() - 1);
+}
+
+TextureStreamer::TextureId TextureStreamer::AddTexture(const Char* FilePath, const TextureLoadInfo& TexLoadInfo)
+{
+    if (!m_pDevice)
+    {
+        LOG_ERROR_MESSAGE("Textures can't be loaded from files in simulation mode");
+        return InvalidTextureId;
+    }
+
+    std::unique_ptr<StreamedTexture> pTex{new StreamedTexture};
+    pTex->FilePath = FilePath;
+    pTex->Name     = TexLoadInfo.Name != nullptr ? TexLoadInfo.Name : FilePath;
+
+    RefCntAutoPtr<IDataBlob>       pFileData;
+    std::vector<TextureSubResData> SubResources;
+    try
+    {
+        // Only the tail levels of the mapped file are accessed
+        if (!ReadFileData(FilePath, &pFileData))
+            LOG_ERROR_AND_THROW("Failed to open file '", FilePath, "'");
+
+        const auto* pData    = reinterpret_cast<const Uint8*>(pFileData->GetDataPtr());
+        const auto  DataSize = pFileData->GetSize();
+        switch (Image::GetFileFormat(pData, DataSize))
+        {
+            case IMAGE_FILE_FORMAT_DDS:
+                GetDDSTextureData(pData, DataSize, TexLoadInfo.MaxDimension, TexLoadInfo.IsSRGB, pTex->FullDesc, SubResources);
+                break;
+
+            case IMAGE_FILE_FORMAT_KTX:
+                GetKTXTextureData(pData, DataSize, TexLoadInfo, pTex->FullDesc, SubResources);
+                break;
+
+            default:
+                LOG_ERROR_AND_THROW("File '", FilePath, "' is not a DDS or KTX file");
+        }
+    }
+    catch (...)
+    {
+        LOG_ERROR_MESSAGE("Failed to add streamed texture '", FilePath, "'");
+        return InvalidTextureId;
+    }
+
+    auto& Desc          = pTex->FullDesc;
+    Desc.Name           = pTex->Name.c_str();
+    Desc.BindFlags      = TexLoadInfo.BindFlags;
+    Desc.Usage          = USAGE_DEFAULT;
+    Desc.CPUAccessFlags = CPU_ACCESS_NONE;
+    InitMipLevels(*pTex);
+
+    if (pTex->TailMip > 0)
+    {
+        const auto& FmtAttribs = GetTextureFormatAttribs(Desc.Format);
+        const auto* pFileStart = reinterpret_cast<const Uint8*>(pFileData->GetDataPtr());
+
+        pTex->Mips.resize(Desc.MipLevels);
+        for (Uint32 mip = 0; mip < Desc.MipLevels; ++mip)
+        {
+            const auto& SubRes = SubResources[mip];
+            auto&       Range  = pTex->Mips[mip];
+            Range.FileOffset   = static_cast<size_t>(reinterpret_cast<const Uint8*>(SubRes.pData) - pFileStart);
+            Range.Stride       = SubRes.Stride;
+            Range.Size         = size_t{SubRes.Stride} * GetNumStorageRows(FmtAttribs, GetMipLevelProperties(Desc, mip));
+        }
+    }
+
+    TextureDesc TailDesc = Desc;
+    TailDesc.Width       = std::max(Desc.Width >> pTex->TailMip, 1u);
+    TailDesc.Height      = std::max(Desc.Height >> pTex->TailMip, 1u);
+    TailDesc.MipLevels   = Desc.MipLevels - pTex->TailMip;
+
+    // 2D textures store subresources in mip order, so the tail levels are at the end
+    TextureData InitData{SubResources.data() + pTex->TailMip, static_cast<Uint32>(SubResources.size() - pTex->TailMip)};
+    m_pDevice->CreateTexture(TailDesc, &InitData, &pTex->pTexture);
+    if (!pTex->pTexture)
+    {
+        LOG_ERROR_MESSAGE("Failed to create streamed texture '", FilePath, "'");
+        return InvalidTextureId;
+    }
+
+    return RegisterTexture(std::move(pTex));
+}
+
+TextureStreamer::TextureId TextureStreamer::AddSimulatedTexture(const TextureDesc& Desc)
+{
+    if (m_pDevice)
+    {
+        LOG_ERROR_MESSAGE("Simulated textures can only be added in simulation mode");
+        return InvalidTextureId;
+    }
+
+    std::unique_ptr<StreamedTexture> pTex{new StreamedTexture};
+    pTex->Name          = Desc.Name != nullptr ? Desc.Name : "";
+    pTex->FullDesc      = Desc;
+    pTex->FullDesc.Name = pTex->Name.c_str();
+    InitMipLevels(*pTex);
+
+    return RegisterTexture(std::move(pTex));
+}
+
+void TextureStreamer::RemoveTexture(TextureId Id)
+{
+    auto& Tex = GetTex(Id);
+    // Memory reserved by a pending load is released when the load completes
+    m_ResidentBytes -= GetMipRangeSize(Tex, Tex.ResidentMip, Tex.FullDesc.MipLevels);
+    m_Textures[Id].reset();
+}
+
+void TextureStreamer::ReportDemand(TextureId Id, Uint32 RequiredMip)
+{
+    auto& Tex   = GetTex(Id);
+    RequiredMip = std::min(RequiredMip, Tex.FullDesc.MipLevels - 1);
+    if (Tex.LastUsedFrame != m_FrameIndex)
+    {
+        Tex.LastUsedFrame = m_FrameIndex;
+        Tex.RequestedMip  = RequiredMip;
+    }
+    else
+    {
+        Tex.RequestedMip = std::min(Tex.RequestedMip, RequiredMip);
+    }
+}
+
+void TextureStreamer::ReportScreenSize(TextureId Id, float ScreenWidth, float ScreenHeight)
+{
+    const auto& Desc = GetTex(Id).FullDesc;
+    ReportDemand(Id, ComputeRequiredMip(Desc.Width, Desc.Height, Desc.MipLevels, ScreenWidth, ScreenHeight));
+}
+
+Uint32 TextureStreamer::ComputeRequiredMip(Uint32 Width, Uint32 Height, Uint32 MipLevels, float ScreenWidth, float ScreenHeight)
+{
+    if (MipLevels == 0)
+        MipLevels = ComputeMipLevelsCount(Width, Height);
+    if (ScreenWidth <= 0 || ScreenHeight <= 0)
+        return MipLevels - 1;
+
+    // The sampler selects the level whose texel size matches the pixel size and blends it
+    // with the next coarser level, so the finer of the two levels is required.
+    const auto TexelsPerPixel = std::max(static_cast<float>(Width) / ScreenWidth, static_cast<float>(Height) / ScreenHeight);
+    if (TexelsPerPixel <= 1.f)
+        return 0;
+
+    const auto Mip = static_cast<Uint32>(std::floor(std::log2(TexelsPerPixel)));
+    return std::min(Mip, MipLevels - 1);
+}
+
+Uint32 TextureStreamer::GetEvictionFloor(const StreamedTexture& Tex) const
+{
+    // Levels that the texture needs in the current frame are never evicted
+    return Tex.LastUsedFrame == m_FrameIndex ?
+        std::min(Tex.RequestedMip, Tex.TailMip) :
+        Tex.TailMip;
+}
+
+void TextureStreamer::StartLoad(TextureId Id, StreamedTexture& Tex, Uint32 FirstMip)
+{
+    VERIFY_EXPR(!Tex.Loading && FirstMip < Tex.ResidentMip);
+
+    std::shared_ptr<LoadJob> pJob{new LoadJob};
+    pJob->Id       = Id;
+    pJob->FirstMip = FirstMip;
+    pJob->EndMip   = Tex.ResidentMip;
+    pJob->Size     = GetMipRangeSize(Tex, FirstMip, Tex.ResidentMip);
+
+    Tex.Loading = true;
+    m_ResidentBytes += pJob->Size;
+    m_PendingBytes += pJob->Size;
+    ++m_NumPendingLoads;
+
+    if (!m_pDevice)
+    {
+        pJob->ReadyFrame = m_FrameIndex + m_SimulatedLoadLatency;
+        m_SimulatedJobs.emplace_back(std::move(pJob));
+        return;
+    }
+
+    pJob->FilePath = Tex.FilePath;
+    pJob->Mips.assign(Tex.Mips.begin() + FirstMip, Tex.Mips.begin() + Tex.ResidentMip);
+
+    bool StartTask = false;
+    {
+        std::lock_guard<std::mutex> Lock{m_JobsMtx};
+        m_QueuedJobs.emplace_back(std::move(pJob));
+        // Running tasks pick up the new load when they finish their current one
+        if (m_NumActiveTasks < m_MaxConcurrentLoads)
+        {
+            ++m_NumActiveTasks;
+            StartTask = true;
+        }
+    }
+    if (StartTask)
+        m_pThreadPool->EnqueueTask([this]() { ReadQueuedLoads(); });
+}
+
+void TextureStreamer::ReadQueuedLoads()
+{
+    for (;;)
+    {
+        std::shared_ptr<LoadJob> pJob;
+        {
+            std::lock_guard<std::mutex> Lock{m_JobsMtx};
+            if (m_Stop || m_QueuedJobs.empty())
+            {
+                VERIFY_EXPR(m_NumActiveTasks > 0);
+                --m_NumActiveTasks;
+                // Notify under the lock because the streamer may be destroyed as soon as
+                // the destructor observes that no tasks are active.
+                m_IdleCondVar.notify_all();
+                return;
+            }
+            pJob = std::move(m_QueuedJobs.front());
+            m_QueuedJobs.pop_front();
+        }
+
+        // The levels of a 2D texture are stored contiguously in both DDS and KTX files,
+        // so all levels are read at once.
+        const auto Start = pJob->Mips.front().FileOffset;
+        const auto End   = pJob->Mips.back().FileOffset + pJob->Mips.back().Size;
+
+        FileWrapper File{pJob->FilePath.c_str(), EFileAccessMode::Read};
+        if (File && File->GetSize() >= End)
+        {
+            pJob->Data.resize(End - Start);
+            File->SetPos(Start, FilePosOrigin::Start);
+            pJob->Succeeded = File->Read(pJob->Data.data(), pJob->Data.size());
+            for (auto& Mip : pJob->Mips)
+                Mip.FileOffset -= Start;
+        }
+
+        {
+            std::lock_guard<std::mutex> Lock{m_JobsMtx};
+            m_CompletedJobs.emplace_back(std::move(pJob));
+        }
+    }
+}
+
+void TextureStreamer::CompleteLoads()
+{
+    std::vector<std::shared_ptr<LoadJob>> CompletedJobs;
+    if (m_pDevice)
+    {
+        std::lock_guard<std::mutex> Lock{m_JobsMtx};
+        CompletedJobs.swap(m_CompletedJobs);
+    }
+    else
+    {
+        auto ReadyEnd = std::stable_partition(m_SimulatedJobs.begin(), m_SimulatedJobs.end(),
+                                              [&](const std::shared_ptr<LoadJob>& pJob) { return pJob->ReadyFrame <= m_FrameIndex; });
+        for (auto it = m_SimulatedJobs.begin(); it != ReadyEnd; ++it)
+            (*it)->Succeeded = true;
+        CompletedJobs.assign(m_SimulatedJobs.begin(), ReadyEnd);
+        m_SimulatedJobs.erase(m_SimulatedJobs.begin(), ReadyEnd);
+    }
+
+    for (auto& pJob : CompletedJobs)
+    {
+        VERIFY_EXPR(m_PendingBytes >= pJob->Size && m_NumPendingLoads > 0);
+        m_PendingBytes -= pJob->Size;
+        --m_NumPendingLoads;
+
+        auto* pTex = m_Textures[pJob->Id].get();
+        if (pTex == nullptr || !pJob->Succeeded)
+        {
+            m_ResidentBytes -= pJob->Size;
+            if (pTex != nullptr)
+            {
+                LOG_ERROR_MESSAGE("Failed to load mip levels ", pJob->FirstMip, "..", pJob->EndMip - 1, " of texture '", pTex->FilePath, "'");
+                pTex->LoadFailed = true;
+                pTex->Loading    = false;
+            }
+            continue;
+        }
+
+        VERIFY_EXPR(pTex->Loading && pTex->ResidentMip == pJob->EndMip);
+        pTex->Loading     = false;
+        pTex->ResidentMip = pJob->FirstMip;
+        if (m_pDevice)
+            pTex->pCompletedLoad = std::move(pJob);
+        ++m_NumLoadsCompleted;
+    }
+}
+
+bool TextureStreamer::EvictMip(const std::vector<StreamedTexture*>& Victims, size_t& VictimIdx)
+{
+    for (; VictimIdx < Victims.size(); ++VictimIdx)
+    {
+        auto& Tex = *Victims[VictimIdx];
+        if (!Tex.Loading && Tex.ResidentMip < GetEvictionFloor(Tex))
+        {
+            m_ResidentBytes -= Tex.MipSizes[Tex.ResidentMip];
+            ++Tex.ResidentMip;
+            ++m_NumEvictedMips;
+            return true;
+        }
+    }
+    return false;
+}
+
+void TextureStreamer::UpdateTextureObject(IDeviceContext* pContext, StreamedTexture& Tex)
+{
+    const auto& FullDesc = Tex.FullDesc;
+    const auto  FirstMip = Tex.ResidentMip;
+
+    TextureDesc Desc = FullDesc;
+    Desc.Width       = std::max(FullDesc.Width >> FirstMip, 1u);
+    Desc.Height      = std::max(FullDesc.Height >> FirstMip, 1u);
+    Desc.MipLevels   = FullDesc.MipLevels - FirstMip;
+
+    RefCntAutoPtr<ITexture> pNewTexture;
+    m_pDevice->CreateTexture(Desc, nullptr, &pNewTexture);
+    if (!pNewTexture)
+    {
+        LOG_ERROR_MESSAGE("Failed to create texture '", Tex.Name, "' with ", Desc.MipLevels, " mip levels");
+        return;
+    }
+
+    const auto& FmtAttribs = GetTextureFormatAttribs(FullDesc.Format);
+    for (Uint32 mip = FirstMip; mip < FullDesc.MipLevels; ++mip)
+    {
+        if (mip >= Tex.TextureFirstMip)
+        {
+            // The level is already resident
+            CopyTextureAttribs CopyAttribs{Tex.pTexture, RESOURCE_STATE_TRANSITION_MODE_TRANSITION,
+                                           pNewTexture, RESOURCE_STATE_TRANSITION_MODE_TRANSITION};
+            CopyAttribs.SrcMipLevel = mip - Tex.TextureFirstMip;
+            CopyAttribs.DstMipLevel = mip - FirstMip;
+            pContext->CopyTexture(CopyAttribs);
+            continue;
+        }
+
+        const auto* pLoad = Tex.pCompletedLoad.get();
+        VERIFY(pLoad != nullptr && mip >= pLoad->FirstMip && mip < pLoad->EndMip, "Mip level ", mip, " has not been loaded");
+
+        const auto MipProps = GetMipLevelProperties(FullDesc, mip);
+
+        UploadBufferDesc UploadDesc;
+        UploadDesc.Width  = MipProps.LogicalWidth;
+        UploadDesc.Height = MipProps.LogicalHeight;
+        UploadDesc.Format = FullDesc.Format;
+
+        RefCntAutoPtr<IUploadBuffer> pUploadBuffer;
+        m_pUploader->AllocateUploadBuffer(pContext, UploadDesc, &pUploadBuffer);
+
+        const auto& Src     = pLoad->Mips[mip - pLoad->FirstMip];
+        const auto  DstData = pUploadBuffer->GetMappedData(0, 0);
+        const auto  NumRows = GetNumStorageRows(FmtAttribs, MipProps);
+        for (Uint32 row = 0; row < NumRows; ++row)
+        {
+            memcpy(reinterpret_cast<Uint8*>(DstData.pData) + size_t{row} * DstData.Stride,
+                   pLoad->Data.data() + Src.FileOffset + size_t{row} * Src.Stride,
+                   MipProps.RowSize);
+        }
+
+        m_pUploader->ScheduleGPUCopy(pContext, pNewTexture, 0, mip - FirstMip, pUploadBuffer);
+        m_pUploader->RecycleBuffer(pUploadBuffer);
+    }
+
+    Tex.pTexture        = std::move(pNewTexture);
+    Tex.TextureFirstMip = FirstMip;
+    ++Tex.Version;
+    Tex.pCompletedLoad.reset();
+}
+
+void TextureStreamer::Update(IDeviceContext* pContext)
+{
+    if (m_pDevice)
+    {
+        DEV_CHECK_ERR(pContext != nullptr, "Device context must not be null");
+        m_pUploader->RenderThreadUpdate(pContext);
+    }
+
+    CompleteLoads();
+
+    // Textures that have levels that can be evicted, least recently used first
+    std::vector<StreamedTexture*> Victims;
+    for (auto& pTex : m_Textures)
+    {
+        if (pTex && !pTex->Loading && pTex->ResidentMip < GetEvictionFloor(*pTex))
+            Victims.push_back(pTex.get());
+    }
+    std::sort(Victims.begin(), Victims.end(), [](const StreamedTexture* pTex0, const StreamedTexture* pTex1) {
+        if (pTex0->LastUsedFrame != pTex1->LastUsedFrame)
+            return pTex0->LastUsedFrame < pTex1->LastUsedFrame;
+        return pTex0->ResidentMip < pTex1->ResidentMip;
+    });
+    size_t VictimIdx = 0;
+
+    // The budget may have been reduced
+    while (m_ResidentBytes > m_Budget)
+    {
+        if (!EvictMip(Victims, VictimIdx))
+            break;
+    }
+
+    struct LoadRequest
+    {
+        TextureId Id;
+        Uint32    TargetMip;
+        Uint32    NumMissingMips;
+    };
+    std::vector<LoadRequest> Requests;
+    for (TextureId Id = 0; Id < m_Textures.size(); ++Id)
+    {
+        const auto* pTex = m_Textures[Id].get();
+        if (pTex == nullptr || pTex->LastUsedFrame != m_FrameIndex || pTex->Loading || pTex->LoadFailed)
+            continue;
+
+        const auto TargetMip = std::min(pTex->RequestedMip, pTex->TailMip);
+        if (TargetMip < pTex->ResidentMip)
+            Requests.push_back({Id, TargetMip, pTex->ResidentMip - TargetMip});
+    }
+    // Textures that miss most levels are loaded first
+    std::stable_sort(Requests.begin(), Requests.end(), [](const LoadRequest& Req0, const LoadRequest& Req1) {
+        return Req0.NumMissingMips > Req1.NumMissingMips;
+    });
+
+    Uint64 LoadBytes = 0;
+    for (const auto& Req : Requests)
+    {
+        auto& Tex = *m_Textures[Req.Id];
+
+        // If all requested levels do not fit, load as many coarse levels as possible
+        auto FirstMip = Req.TargetMip;
+        for (; FirstMip < Tex.ResidentMip; ++FirstMip)
+        {
+            const auto Size = GetMipRangeSize(Tex, FirstMip, Tex.ResidentMip);
+            // The first load is always started, so that levels larger than the limit are loaded too
+            if (m_MaxLoadBytesPerUpdate != 0 && LoadBytes > 0 && LoadBytes + Size > m_MaxLoadBytesPerUpdate)
+                continue;
+
+            while (m_ResidentBytes + Size > m_Budget)
+            {
+                if (!EvictMip(Victims, VictimIdx))
+                    break;
+            }
+            if (m_ResidentBytes + Size <= m_Budget)
+                break;
+        }
+
+        if (FirstMip < Tex.ResidentMip)
+        {
+            LoadBytes += GetMipRangeSize(Tex, FirstMip, Tex.ResidentMip);
+            StartLoad(Req.Id, Tex, FirstMip);
+        }
+    }
+
+    if (m_pDevice)
+    {
+        for (auto& pTex : m_Textures)
+        {
+            if (pTex && pTex->TextureFirstMip != pTex->ResidentMip)
+                UpdateTextureObject(pContext, *pTex);
+        }
+    }
+
+    ++m_FrameIndex;
+}
+
+ITexture* TextureStreamer::GetTexture(TextureId Id)
+{
+    return GetTex(Id).pTexture;
+}
+
+Uint32 TextureStreamer::GetTextureVersion(TextureId Id) const
+{
+    return GetTex(Id).Version;
+}
+
+Uint32 TextureStreamer::GetResidentMip(TextureId Id) const
+{
+    return GetTex(Id).ResidentMip;
+}
+
+const TextureDesc& TextureStreamer::GetFullDesc(TextureId Id) const
+{
+    return GetTex(Id).FullDesc;
+}
+
+bool TextureStreamer::IsLoading(TextureId Id) const
+{
+    return GetTex(Id).Loading;
+}
+
+TextureStreamer::Statistics TextureStreamer::GetStatistics() const
+{
+    Statistics Stats;
+    for (const auto& pTex : m_Textures)
+    {
+        if (pTex)
+            ++Stats.NumTextures;
+    }
+    Stats.ResidentBytes     = m_ResidentBytes;
+    Stats.PendingBytes      = m_PendingBytes;
+    Stats.NumPendingLoads   = m_NumPendingLoads;
+    Stats.NumLoadsCompleted = m_NumLoadsCompleted;
+    Stats.NumEvictedMips    = m_NumEvictedMips;
+    return Stats;
+}
+
+} // namespace Diligent
@@ -32,15 +32,107 @@
 #include "Image.h"
 #include "RefCntAutoPtr.hpp"
 #include "DataBlobImpl.hpp"
+#include "TextureCache.hpp"
+#include "TextureLoaderInternal.hpp"
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
 
 namespace Diligent
 {
 
+namespace
+{
+
+TextureCache& GetTextureCache(const Char* Directory, Uint64 MaxSize)
+{
+    static std::mutex                                                     CachesMtx;
+    static std::unordered_map<std::string, std::unique_ptr<TextureCache>> Caches;
+
+    std::lock_guard<std::mutex> Lock{CachesMtx};
+
+    auto& pCache = Caches[Directory];
+    if (!pCache)
+    {
+        TextureCache::CreateInfo CacheCI;
+        CacheCI.Directory = Directory;
+        CacheCI.MaxSize   = MaxSize;
+        pCache.reset(new TextureCache{CacheCI});
+    }
+    else
+    {
+        pCache->SetMaxSize(MaxSize);
+    }
+    return *pCache;
+}
+
+// Creates the texture using the cache. Returns false if the file is not an image that can be cached.
+bool CreateTextureFromFileCached(const Char*            FilePath,
+                                 const TextureLoadInfo& TexLoadInfo,
+                                 IRenderDevice*         pDevice,
+                                 ITexture**             ppTexture)
+{
+    RefCntAutoPtr<IDataBlob> pFileData;
+    if (!ReadFileData(FilePath, &pFileData))
+        return false;
+
+    const auto ImgFmt = Image::GetFileFormat(reinterpret_cast<const Uint8*>(pFileData->GetDataPtr()), pFileData->GetSize());
+    if (ImgFmt != IMAGE_FILE_FORMAT_PNG && ImgFmt != IMAGE_FILE_FORMAT_JPEG && ImgFmt != IMAGE_FILE_FORMAT_TIFF)
+        return false;
+
+    auto&      Cache = GetTextureCache(TexLoadInfo.CacheDirectory, TexLoadInfo.MaxCacheSize);
+    const auto Key   = TextureCache::ComputeKey(pFileData->GetDataPtr(), pFileData->GetSize(), TexLoadInfo);
+
+    RefCntAutoPtr<IDataBlob> pKTXData;
+    if (Cache.Find(Key, &pKTXData))
+    {
+        try
+        {
+            CreateTextureFromKTX(pKTXData, TexLoadInfo, pDevice, ppTexture);
+        }
+        catch (const std::exception&)
+        {
+            LOG_WARNING_MESSAGE("Failed to load cached texture '", Cache.GetFilePath(Key), "'. The texture will be recreated.");
+        }
+        if (*ppTexture != nullptr)
+            return true;
+    }
+
+    ImageLoadInfo ImgLoadInfo;
+    ImgLoadInfo.Format = ImgFmt;
+    RefCntAutoPtr<Image> pImage;
+    Image::CreateFromDataBlob(pFileData, ImgLoadInfo, &pImage);
+
+    PreparedTextureData Data;
+    PrepareTextureFromImage(pImage, TexLoadInfo, pDevice, Data);
+
+    TextureData TexData;
+    TexData.pSubResources   = Data.SubResources.data();
+    TexData.NumSubresources = static_cast<Uint32>(Data.SubResources.size());
+    pDevice->CreateTexture(Data.Desc, &TexData, ppTexture);
+
+    // Textures whose mips are generated on the GPU are not cached as the data is incomplete
+    if (*ppTexture != nullptr && Data.AllLevelsOnCPU)
+        Cache.Store(Key, Data.Desc, TexData);
+
+    return true;
+}
+
+} // namespace
+
 void CreateTextureFromFile(const Char*            FilePath,
                            const TextureLoadInfo& TexLoadInfo,
                            IRenderDevice*         pDevice,
                            ITexture**             ppTexture)
 {
+    if (TexLoadInfo.CacheDirectory != nullptr && TexLoadInfo.CacheDirectory[0] != '\0')
+    {
+        if (CreateTextureFromFileCached(FilePath, TexLoadInfo, pDevice, ppTexture))
+            return;
+    }
+
     RefCntAutoPtr<Image>     pImage;
     RefCntAutoPtr<IDataBlob> pRawData;
 
@@ -80,7 +80,11 @@ void GLTFObject::LoadModel(const char* Path)
         m_AnimationTimers.clear();
     }
 
-    m_Model.reset(new GLTF::Model(m_pDevice, m_pImmediateContext, Path));
+    GLTF::Model::CreateInfo ModelCI{Path};
+    ModelCI.OptimizeMeshes = true;
+    // Distant objects are rendered with coarser levels of detail
+    ModelCI.LODCount = 4;
+    m_Model.reset(new GLTF::Model(m_pDevice, m_pImmediateContext, ModelCI));
     m_GLTFRenderer->InitializeResourceBindings(*m_Model, m_VertexBuffer, m_VSConstants);
 
     // Center and scale model
@@ -170,6 +174,8 @@ void GLTFObject::RenderActor(const Camera& camera, bool IsShadowPass)
         auto CameraViewProj = CameraView * Proj;
 
         m_RenderParams.ModelTransform = m_WorldMatrix;
+        m_RenderParams.CameraPosition = CameraWorldPos;
+        m_RenderParams.ProjScale      = Proj._22;
 
         {
             MapHelper<CameraAttribs> CamAttribs(m_pImmediateContext, m_VertexBuffer, MAP_WRITE, MAP_FLAG_DISCARD);